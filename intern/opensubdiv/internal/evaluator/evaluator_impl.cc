@@ -747,6 +747,17 @@ void CpuEvalOutputAPI::evaluatePatchesLimit(const OpenSubdiv_PatchCoord *patch_c
   }
 }
 
+void CpuEvalOutputAPI::evaluatePatchesFaceVarying(const int face_varying_channel,
+                                                  const OpenSubdiv_PatchCoord *patch_coords,
+                                                  const int num_patch_coords,
+                                                  float *face_varying)
+{
+  StackOrHeapPatchCoordArray patch_coords_array;
+  convertPatchCoordsToArray(patch_coords, num_patch_coords, patch_map_, &patch_coords_array);
+  implementation_->evalPatchesFaceVarying(
+      face_varying_channel, patch_coords_array.data(), num_patch_coords, face_varying);
+}
+
 }  // namespace opensubdiv
 }  // namespace blender
 
@@ -122,6 +122,15 @@ typedef struct OpenSubdiv_Evaluator {
                                float *dPdu,
                                float *dPdv);
 
+  // Evaluate face-varying data of given channel.
+  //
+  // NOTE: Output array must point to a memory of size float[2]*num_patch_coords.
+  void (*evaluatePatchesFaceVarying)(struct OpenSubdiv_Evaluator *evaluator,
+                                     const int face_varying_channel,
+                                     const struct OpenSubdiv_PatchCoord *patch_coords,
+                                     const int num_patch_coords,
+                                     float *face_varying);
+
   // Implementation of the evaluator.
   struct OpenSubdiv_EvaluatorImpl *impl;
 } OpenSubdiv_Evaluator;
@@ -645,9 +645,12 @@ class NODE_PT_quality(bpy.types.Panel):
         tree = snode.node_tree
 
         col = layout.column()
+        col.prop(tree, "execution_mode")
         col.prop(tree, "render_quality", text="Render")
         col.prop(tree, "edit_quality", text="Edit")
-        col.prop(tree, "chunk_size")
+        sub = col.column()
+        sub.active = tree.execution_mode == 'TILED'
+        sub.prop(tree, "chunk_size")
 
         col = layout.column()
         col.prop(tree, "use_opencl")
@@ -395,6 +395,7 @@ void CustomData_set_layer_stencil_index(struct CustomData *data, int type, int n
 void CustomData_set_layer_flag(struct CustomData *data, int type, int flag);
 void CustomData_clear_layer_flag(struct CustomData *data, int type, int flag);
 
+void CustomData_bmesh_alloc_block(struct CustomData *data, void **block);
 void CustomData_bmesh_set_default(struct CustomData *data, void **block);
 void CustomData_bmesh_free_block(struct CustomData *data, void **block);
 void CustomData_bmesh_free_block_data(struct CustomData *data, void *block);
@@ -413,6 +414,13 @@ void CustomData_from_bmesh_block(const struct CustomData *source,
                                  struct CustomData *dest,
                                  void *src_block,
                                  int dest_index);
+void CustomData_from_bmesh_block_ex(const struct CustomData *source,
+                                    struct CustomData *dest,
+                                    void *src_block,
+                                    int dest_index,
+                                    const bool use_move);
+void CustomData_bmesh_moved_layers_nofree(struct CustomData *source,
+                                          const struct CustomData *dest);
 
 /* query info over types */
 void CustomData_file_write_info(int type, const char **r_struct_name, int *r_struct_num);
@@ -156,6 +156,9 @@ enum {
   G_DEBUG_XR_TIME = (1 << 22),               /* XR/OpenXR timing messages */
 
   G_DEBUG_GHOST = (1 << 23), /* Debug GHOST module. */
+
+  G_DEBUG_DEPSGRAPH_PRIORITY = (1 << 24), /* critical path priority depsgraph scheduling */
+  G_DEBUG_BMESH_NO_EVAL_ONLY = (1 << 25), /* copy custom-data of modifier BMeshes, for timing */
 };
 
 #define G_DEBUG_ALL \
@@ -423,6 +423,27 @@ void BKE_mesh_normals_loop_split(const struct MVert *mverts,
                                  short (*clnors_data)[2],
                                  int *r_loop_to_poly);
 
+/** Topology data of split normals, which can be kept while only vertex positions change. */
+typedef struct MLoopSplitCache MLoopSplitCache;
+
+void BKE_mesh_normals_loop_split_ex(const struct MVert *mverts,
+                                    const int numVerts,
+                                    struct MEdge *medges,
+                                    const int numEdges,
+                                    struct MLoop *mloops,
+                                    float (*r_loopnors)[3],
+                                    const int numLoops,
+                                    struct MPoly *mpolys,
+                                    const float (*polynors)[3],
+                                    const int numPolys,
+                                    const bool use_split_normals,
+                                    const float split_angle,
+                                    MLoopNorSpaceArray *r_lnors_spacearr,
+                                    short (*clnors_data)[2],
+                                    int *r_loop_to_poly,
+                                    MLoopSplitCache **cache_p);
+void BKE_mesh_loop_split_cache_free(MLoopSplitCache *cache);
+
 void BKE_mesh_normals_loop_custom_set(const struct MVert *mverts,
                                       const int numVerts,
                                       struct MEdge *medges,
@@ -456,6 +477,7 @@ void BKE_mesh_normals_loop_to_vertex(const int numVerts,
 bool BKE_mesh_has_custom_loop_normals(struct Mesh *me);
 
 void BKE_mesh_calc_normals_split(struct Mesh *mesh);
+void BKE_mesh_calc_normals_split_cached(struct Mesh *mesh, const struct Mesh *mesh_src);
 void BKE_mesh_calc_normals_split_ex(struct Mesh *mesh,
                                     struct MLoopNorSpaceArray *r_lnors_spacearr);
 
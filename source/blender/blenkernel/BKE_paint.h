@@ -483,6 +483,9 @@ typedef struct SculptSession {
 
   /* PBVH acceleration structure */
   struct PBVH *pbvh;
+  /* PBVH from before the last geometry update,
+   * updated in place when the topology didn't change. */
+  struct PBVH *pbvh_prev;
   bool show_mask;
   bool show_face_sets;
 
@@ -113,6 +113,17 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
                          struct CustomData *pdata,
                          const struct MLoopTri *looptri,
                          int looptri_num);
+bool BKE_pbvh_mesh_update(PBVH *pbvh,
+                          const struct Mesh *mesh,
+                          const struct MPoly *mpoly,
+                          const struct MLoop *mloop,
+                          struct MVert *verts,
+                          int totvert,
+                          struct CustomData *vdata,
+                          struct CustomData *ldata,
+                          struct CustomData *pdata,
+                          const struct MLoopTri *looptri,
+                          int looptri_num);
 void BKE_pbvh_build_grids(PBVH *pbvh,
                           struct CCGElem **grids,
                           int totgrid,
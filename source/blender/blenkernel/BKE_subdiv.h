@@ -36,6 +36,7 @@ struct OpenSubdiv_Converter;
 struct OpenSubdiv_Evaluator;
 struct OpenSubdiv_TopologyRefiner;
 struct Subdiv;
+struct SubdivMeshTopologyCache;
 
 typedef enum eSubdivVtxBoundaryInterpolation {
   /* Do not interpolate boundaries. */
@@ -190,6 +191,9 @@ typedef struct Subdiv {
     /* Indexed by base face index, element indicates total number of ptex
      * faces created for preceding base faces. */
     int *face_ptex_offset;
+    /* Subdivided edges, loops and polygons of the last BKE_subdiv_to_mesh()
+     * result, re-used while the coarse topology doesn't change. */
+    struct SubdivMeshTopologyCache *mesh_topology;
   } cache_;
 } Subdiv;
 
@@ -30,6 +30,7 @@ extern "C" {
 #endif
 
 struct Mesh;
+struct OpenSubdiv_PatchCoord;
 struct Subdiv;
 
 /* Returns true if evaluator is ready for use. */
@@ -102,6 +103,37 @@ void BKE_subdiv_eval_displacement(struct Subdiv *subdiv,
 void BKE_subdiv_eval_final_point(
     struct Subdiv *subdiv, const int ptex_face_index, const float u, const float v, float r_P[3]);
 
+/* Batched queries.
+ *
+ * Evaluate an array of (ptex face, u, v) coordinates at once. Outputs are arrays with an element
+ * per coordinate. Coordinates of the same ptex face are best kept next to each other, which is
+ * how the evaluator finds them the fastest. */
+
+void BKE_subdiv_eval_limit_points(struct Subdiv *subdiv,
+                                  const struct OpenSubdiv_PatchCoord *patch_coords,
+                                  const int num_patch_coords,
+                                  float (*r_P)[3]);
+void BKE_subdiv_eval_limit_points_and_derivatives(struct Subdiv *subdiv,
+                                                  const struct OpenSubdiv_PatchCoord *patch_coords,
+                                                  const int num_patch_coords,
+                                                  float (*r_P)[3],
+                                                  float (*r_dPdu)[3],
+                                                  float (*r_dPdv)[3]);
+void BKE_subdiv_eval_limit_points_and_normals(struct Subdiv *subdiv,
+                                              const struct OpenSubdiv_PatchCoord *patch_coords,
+                                              const int num_patch_coords,
+                                              float (*r_P)[3],
+                                              float (*r_N)[3]);
+void BKE_subdiv_eval_final_points(struct Subdiv *subdiv,
+                                  const struct OpenSubdiv_PatchCoord *patch_coords,
+                                  const int num_patch_coords,
+                                  float (*r_P)[3]);
+void BKE_subdiv_eval_face_varying_points(struct Subdiv *subdiv,
+                                         const int face_varying_channel,
+                                         const struct OpenSubdiv_PatchCoord *patch_coords,
+                                         const int num_patch_coords,
+                                         float (*r_face_varying)[2]);
+
 /* Patch queries at given resolution.
  *
  * Will evaluate patch at uniformly distributed (u, v) coordinates on a grid
@@ -30,6 +30,7 @@ extern "C" {
 #endif
 
 struct Mesh;
+struct OpenSubdiv_PatchCoord;
 struct Subdiv;
 struct SubdivForeachContext;
 struct SubdivToMeshSettings;
@@ -69,6 +70,16 @@ typedef void (*SubdivForeachVertexInnerCb)(const struct SubdivForeachContext *co
                                            const int coarse_corner,
                                            const int subdiv_vertex_index);
 
+/* Maximum number of vertices passed to SubdivForeachVerticesInnerCb at once. */
+#define SUBDIV_FOREACH_VERTICES_INNER_CHUNK_SIZE 256
+
+typedef void (*SubdivForeachVerticesInnerCb)(const struct SubdivForeachContext *context,
+                                             void *tls,
+                                             const int coarse_poly_index,
+                                             const struct OpenSubdiv_PatchCoord *patch_coords,
+                                             const int num_vertices,
+                                             const int start_subdiv_vertex_index);
+
 typedef void (*SubdivForeachEdgeCb)(const struct SubdivForeachContext *context,
                                     void *tls,
                                     const int coarse_edge_index,
@@ -127,6 +138,11 @@ typedef struct SubdivForeachContext {
   SubdivForeachVertexFromEdgeCb vertex_edge;
   /* Called exactly once, always corresponds to a single ptex face. */
   SubdivForeachVertexInnerCb vertex_inner;
+  /* Same vertices as vertex_inner, but passed in batches of consecutive subdivision vertices of
+   * the same coarse polygon, so they can be evaluated at once. Called after vertex_inner was
+   * called for all vertices of the batch.
+   */
+  SubdivForeachVerticesInnerCb vertices_inner;
   /* Called once for each loose vertex. One loose coarse vertexcorresponds
    * to a single subdivision vertex.
    */
@@ -49,6 +49,9 @@ struct Mesh *BKE_subdiv_to_mesh(struct Subdiv *subdiv,
                                 const SubdivToMeshSettings *settings,
                                 const struct Mesh *coarse_mesh);
 
+/* Free the subdivided topology kept on the descriptor by BKE_subdiv_to_mesh(). */
+void BKE_subdiv_mesh_topology_cache_free(struct Subdiv *subdiv);
+
 #ifdef __cplusplus
 }
 #endif
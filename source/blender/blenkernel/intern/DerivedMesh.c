@@ -812,8 +812,11 @@ static void mesh_calc_modifier_final_normals(const Mesh *mesh_input,
   }
 
   if (do_loop_normals) {
-    /* Compute loop normals (note: will compute poly and vert normals as well, if needed!) */
-    BKE_mesh_calc_normals_split(mesh_final);
+    /* Compute loop normals (note: will compute poly and vert normals as well, if needed!)
+     * Their topology data is kept in the runtime data of the input mesh, so that it's re-used
+     * across evaluations when modifiers only deform the mesh. Objects sharing the input mesh are
+     * evaluated in parallel, it's only accessed with the evaluation mutex of the mesh held. */
+    BKE_mesh_calc_normals_split_cached(mesh_final, mesh_input);
     BKE_mesh_tessface_clear(mesh_final);
   }
 
@@ -1767,6 +1770,14 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
    * they aren't cleaned up properly on mode switch, causing crashes, e.g T58150. */
   BLI_assert(ob->id.tag & LIB_TAG_COPIED_ON_WRITE);
 
+  /* Keep the BVH trees of the previous evaluation, they can be refit when only the positions
+   * changed. */
+  struct BVHCache *bvh_cache_prev = NULL;
+  if (ob->runtime.is_data_eval_owned && ob->runtime.data_eval != NULL &&
+      GS(ob->runtime.data_eval->name) == ID_ME) {
+    bvh_cache_prev = bvhcache_detach_for_refit((Mesh *)ob->runtime.data_eval);
+  }
+
   BKE_object_free_derived_caches(ob);
   if (DEG_is_active(depsgraph)) {
     BKE_sculpt_update_object_before_eval(ob);
@@ -1804,6 +1815,15 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
   const bool is_mesh_eval_owned = (mesh_eval != mesh->runtime.mesh_eval);
   BKE_object_eval_assign_data(ob, &mesh_eval->id, is_mesh_eval_owned);
 
+  if (bvh_cache_prev != NULL) {
+    if (is_mesh_eval_owned) {
+      bvhcache_attach_for_refit(mesh_eval, bvh_cache_prev);
+    }
+    else {
+      bvhcache_free(bvh_cache_prev);
+    }
+  }
+
   ob->runtime.mesh_deform_eval = mesh_deform_eval;
   ob->runtime.last_data_mask = *dataMask;
   ob->runtime.last_need_mapping = need_mapping;
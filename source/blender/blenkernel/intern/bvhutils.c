@@ -28,8 +28,10 @@
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 
+#include "BLI_hash_mm2a.h"
 #include "BLI_linklist.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -44,9 +46,21 @@
 /** \name BVHCache
  * \{ */
 
+/* Refit trees are rebuilt when their cost grew more than this since they were balanced. */
+#define BVHCACHE_REFIT_COST_MAX 1.5f
+
 typedef struct BVHCacheItem {
   bool is_filled;
   BVHTree *tree;
+
+  /* Tree of the previous evaluation of the mesh, refit when the topology is the same. */
+  BVHTree *tree_prev;
+  /* Hash of the topology of the previous mesh, see #bvhcache_topology_hash. */
+  uint topology_hash;
+  /* Number of elements of the previous mesh, checked with the hash to avoid collisions. */
+  int elem_len;
+  /* Cost of the tree when it was balanced, zero when it wasn't computed yet. */
+  float balanced_cost;
 } BVHCacheItem;
 
 typedef struct BVHCache {
@@ -143,6 +157,12 @@ static void bvhcache_insert(BVHCache *bvh_cache, BVHTree *tree, BVHCacheType typ
   BLI_assert(!item->is_filled);
   item->tree = tree;
   item->is_filled = true;
+  item->balanced_cost = 0.0f;
+
+  if (item->tree_prev) {
+    BLI_bvhtree_free(item->tree_prev);
+    item->tree_prev = NULL;
+  }
 }
 
 /**
@@ -154,11 +174,264 @@ void bvhcache_free(BVHCache *bvh_cache)
     BVHCacheItem *item = &bvh_cache->items[index];
     BLI_bvhtree_free(item->tree);
     item->tree = NULL;
+    if (item->tree_prev) {
+      BLI_bvhtree_free(item->tree_prev);
+      item->tree_prev = NULL;
+    }
   }
   BLI_mutex_end(&bvh_cache->mutex);
   MEM_freeN(bvh_cache);
 }
 
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name BVHCache Refit
+ *
+ * Evaluated meshes are created again on every evaluation of the object, but when only the
+ * positions changed, the trees of the previous evaluation can be refit instead of built again.
+ * \{ */
+
+static bool bvhcache_refit_supported(BVHCacheType type)
+{
+  /* Trees built with a mask don't store the elements at their index. */
+  return ELEM(type, BVHTREE_FROM_VERTS, BVHTREE_FROM_EDGES, BVHTREE_FROM_FACES,
+              BVHTREE_FROM_LOOPTRI);
+}
+
+/**
+ * Number of elements used by a type of tree, one leaf of the tree for every element.
+ */
+static int bvhcache_elem_len(const Mesh *mesh, BVHCacheType type)
+{
+  switch (type) {
+    case BVHTREE_FROM_VERTS:
+      return mesh->totvert;
+    case BVHTREE_FROM_EDGES:
+      return mesh->totedge;
+    case BVHTREE_FROM_FACES:
+      return mesh->totface;
+    case BVHTREE_FROM_LOOPTRI:
+      return BKE_mesh_runtime_looptri_len(mesh);
+    default:
+      BLI_assert(0);
+      return -1;
+  }
+}
+
+/**
+ * Hash of the elements used by a type of tree, trees can be refit when it doesn't change.
+ */
+static uint bvhcache_topology_hash(const Mesh *mesh, BVHCacheType type)
+{
+  BLI_HashMurmur2A mm2;
+  BLI_hash_mm2a_init(&mm2, (uint32_t)type);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totvert);
+
+  switch (type) {
+    case BVHTREE_FROM_EDGES:
+      BLI_hash_mm2a_add_int(&mm2, mesh->totedge);
+      for (int i = 0; i < mesh->totedge; i++) {
+        BLI_hash_mm2a_add_int(&mm2, (int)mesh->medge[i].v1);
+        BLI_hash_mm2a_add_int(&mm2, (int)mesh->medge[i].v2);
+      }
+      break;
+    case BVHTREE_FROM_FACES:
+      BLI_hash_mm2a_add_int(&mm2, mesh->totface);
+      for (int i = 0; i < mesh->totface; i++) {
+        BLI_hash_mm2a_add(&mm2, (const uchar *)&mesh->mface[i].v1, sizeof(uint[4]));
+      }
+      break;
+    case BVHTREE_FROM_LOOPTRI:
+      BLI_hash_mm2a_add_int(&mm2, mesh->totpoly);
+      BLI_hash_mm2a_add_int(&mm2, mesh->totloop);
+      for (int i = 0; i < mesh->totpoly; i++) {
+        BLI_hash_mm2a_add_int(&mm2, mesh->mpoly[i].loopstart);
+        BLI_hash_mm2a_add_int(&mm2, mesh->mpoly[i].totloop);
+      }
+      for (int i = 0; i < mesh->totloop; i++) {
+        BLI_hash_mm2a_add_int(&mm2, (int)mesh->mloop[i].v);
+      }
+      break;
+    default:
+      break;
+  }
+  return BLI_hash_mm2a_end(&mm2);
+}
+
+/**
+ * Take the cache of an evaluated mesh that is about to be freed,
+ * to refit its trees for the next evaluation with #bvhcache_attach_for_refit.
+ * Returns NULL when there are no trees that can be refit.
+ */
+BVHCache *bvhcache_detach_for_refit(Mesh *mesh)
+{
+  BVHCache *bvh_cache = mesh->runtime.bvh_cache;
+  if (bvh_cache == NULL) {
+    return NULL;
+  }
+  mesh->runtime.bvh_cache = NULL;
+
+  bool has_tree_prev = false;
+  for (BVHCacheType type = 0; type < BVHTREE_MAX_ITEM; type++) {
+    BVHCacheItem *item = &bvh_cache->items[type];
+    if (item->tree_prev) {
+      BLI_bvhtree_free(item->tree_prev);
+      item->tree_prev = NULL;
+    }
+    if (item->tree && bvhcache_refit_supported(type)) {
+      item->tree_prev = item->tree;
+      item->topology_hash = bvhcache_topology_hash(mesh, type);
+      item->elem_len = bvhcache_elem_len(mesh, type);
+      /* Trees that weren't refit yet are still balanced for the positions of this mesh. */
+      if (item->balanced_cost == 0.0f) {
+        item->balanced_cost = BLI_bvhtree_get_cost(item->tree);
+      }
+      has_tree_prev = true;
+    }
+    else {
+      BLI_bvhtree_free(item->tree);
+    }
+    item->tree = NULL;
+    item->is_filled = false;
+  }
+
+  if (!has_tree_prev) {
+    bvhcache_free(bvh_cache);
+    return NULL;
+  }
+  return bvh_cache;
+}
+
+/**
+ * Give the cache taken with #bvhcache_detach_for_refit to the next evaluated mesh,
+ * its trees are refit when they are requested.
+ */
+void bvhcache_attach_for_refit(Mesh *mesh, BVHCache *bvh_cache)
+{
+  if (mesh->runtime.bvh_cache != NULL) {
+    bvhcache_free(bvh_cache);
+    return;
+  }
+  mesh->runtime.bvh_cache = bvh_cache;
+}
+
+typedef struct BVHCacheRefitData {
+  BVHTree *tree;
+  const Mesh *mesh;
+  const MLoopTri *looptri;
+  BVHCacheType type;
+} BVHCacheRefitData;
+
+static void bvhcache_refit_node_cb(void *__restrict userdata,
+                                   const int i,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHCacheRefitData *data = userdata;
+  const Mesh *mesh = data->mesh;
+  const MVert *vert = mesh->mvert;
+  float co[4][3];
+
+  switch (data->type) {
+    case BVHTREE_FROM_VERTS:
+      BLI_bvhtree_update_node(data->tree, i, vert[i].co, NULL, 1);
+      break;
+    case BVHTREE_FROM_EDGES:
+      copy_v3_v3(co[0], vert[mesh->medge[i].v1].co);
+      copy_v3_v3(co[1], vert[mesh->medge[i].v2].co);
+      BLI_bvhtree_update_node(data->tree, i, co[0], NULL, 2);
+      break;
+    case BVHTREE_FROM_FACES: {
+      const MFace *face = &mesh->mface[i];
+      copy_v3_v3(co[0], vert[face->v1].co);
+      copy_v3_v3(co[1], vert[face->v2].co);
+      copy_v3_v3(co[2], vert[face->v3].co);
+      if (face->v4) {
+        copy_v3_v3(co[3], vert[face->v4].co);
+      }
+      BLI_bvhtree_update_node(data->tree, i, co[0], NULL, face->v4 ? 4 : 3);
+      break;
+    }
+    case BVHTREE_FROM_LOOPTRI: {
+      const MLoopTri *lt = &data->looptri[i];
+      copy_v3_v3(co[0], vert[mesh->mloop[lt->tri[0]].v].co);
+      copy_v3_v3(co[1], vert[mesh->mloop[lt->tri[1]].v].co);
+      copy_v3_v3(co[2], vert[mesh->mloop[lt->tri[2]].v].co);
+      BLI_bvhtree_update_node(data->tree, i, co[0], NULL, 3);
+      break;
+    }
+    default:
+      BLI_assert(0);
+      break;
+  }
+}
+
+/**
+ * Refit the tree of the previous evaluation to the positions of the mesh and store it in the
+ * cache, when the topology didn't change and the refit tree is still good for queries.
+ */
+static bool bvhcache_refit_from_mesh(BVHCache **bvh_cache_p,
+                                     Mesh *mesh,
+                                     BVHCacheType type,
+                                     ThreadMutex *mesh_eval_mutex,
+                                     BVHTree **r_tree)
+{
+  if (*bvh_cache_p == NULL || (*bvh_cache_p)->items[type].tree_prev == NULL) {
+    return false;
+  }
+
+  bool lock_started = false;
+  if (bvhcache_find(bvh_cache_p, type, r_tree, &lock_started, mesh_eval_mutex)) {
+    return true;
+  }
+  BVHCache *bvh_cache = *bvh_cache_p;
+  BVHCacheItem *item = &bvh_cache->items[type];
+
+  /* Another thread may have used it already. */
+  BVHTree *tree = item->tree_prev;
+  item->tree_prev = NULL;
+
+  /* The element counts are compared as well, every leaf must be updated from a valid element,
+   * even when the hashes of different topologies are the same. */
+  const int elem_len = tree ? bvhcache_elem_len(mesh, type) : -1;
+
+  if (tree && item->elem_len == elem_len && BLI_bvhtree_get_len(tree) == elem_len &&
+      item->topology_hash == bvhcache_topology_hash(mesh, type)) {
+    BVHCacheRefitData data = {
+        .tree = tree,
+        .mesh = mesh,
+        .looptri = (type == BVHTREE_FROM_LOOPTRI) ? BKE_mesh_runtime_looptri_ensure(mesh) : NULL,
+        .type = type,
+    };
+    const int tree_len = elem_len;
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 1024;
+    BLI_task_parallel_range(0, tree_len, &data, bvhcache_refit_node_cb, &settings);
+    BLI_bvhtree_update_tree(tree);
+
+    if (BLI_bvhtree_get_cost(tree) > item->balanced_cost * BVHCACHE_REFIT_COST_MAX) {
+      BLI_bvhtree_free(tree);
+      tree = NULL;
+    }
+  }
+  else if (tree) {
+    BLI_bvhtree_free(tree);
+    tree = NULL;
+  }
+
+  if (tree) {
+    /* Not #bvhcache_insert, the balanced cost is kept. */
+    item->tree = tree;
+    item->is_filled = true;
+  }
+  bvhcache_unlock(bvh_cache, lock_started);
+
+  *r_tree = tree;
+  return tree != NULL;
+}
+
 /** \} */
 /* -------------------------------------------------------------------- */
 /** \name Local Callbacks
@@ -1419,6 +1692,10 @@ BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
   ThreadMutex *mesh_eval_mutex = (ThreadMutex *)mesh->runtime.eval_mutex;
 
   bool is_cached = bvhcache_find(bvh_cache_p, bvh_cache_type, &tree, NULL, NULL);
+  if (!is_cached) {
+    is_cached = bvhcache_refit_from_mesh(
+        bvh_cache_p, mesh, bvh_cache_type, mesh_eval_mutex, &tree);
+  }
 
   if (is_cached && tree == NULL) {
     memset(data, 0, sizeof(*data));
@@ -0,0 +1,170 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "BKE_bvhutils.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "BLI_kdopbvh.h"
+#include "BLI_math.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+namespace blender::bke::tests {
+
+#define GRID_SIZE 32
+
+/* The first tree is built with this type, rebuilt trees get #TREE_TYPE_REBUILD. Refit trees keep
+ * the type they were built with. */
+#define TREE_TYPE_FIRST 2
+#define TREE_TYPE_REBUILD 4
+
+/* Grid of quads in the XY plane, `rotate_first_quad` changes the triangulation of the first quad
+ * without changing the number of any elements. */
+static Mesh *grid_create(const float z, const bool rotate_first_quad)
+{
+  const int verts_len = (GRID_SIZE + 1) * (GRID_SIZE + 1);
+  const int polys_len = GRID_SIZE * GRID_SIZE;
+  Mesh *mesh = BKE_mesh_new_nomain(verts_len, 0, 0, polys_len * 4, polys_len);
+
+  for (int y = 0; y <= GRID_SIZE; y++) {
+    for (int x = 0; x <= GRID_SIZE; x++) {
+      MVert *mv = &mesh->mvert[y * (GRID_SIZE + 1) + x];
+      mv->co[0] = (float)x;
+      mv->co[1] = (float)y;
+      mv->co[2] = z;
+    }
+  }
+  for (int y = 0; y < GRID_SIZE; y++) {
+    for (int x = 0; x < GRID_SIZE; x++) {
+      const int i = y * GRID_SIZE + x;
+      const int v = y * (GRID_SIZE + 1) + x;
+      const int quad[4] = {v, v + 1, v + GRID_SIZE + 2, v + GRID_SIZE + 1};
+      const int offset = (rotate_first_quad && i == 0) ? 1 : 0;
+      mesh->mpoly[i].loopstart = i * 4;
+      mesh->mpoly[i].totloop = 4;
+      for (int j = 0; j < 4; j++) {
+        mesh->mloop[i * 4 + j].v = (uint)quad[(j + offset) % 4];
+      }
+    }
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+  return mesh;
+}
+
+/* Move the trees of `mesh_prev` to `mesh` like the evaluation of an object does, and free
+ * `mesh_prev`. Returns the tree of `mesh`. */
+static BVHTree *tree_get_after_evaluation(Mesh *mesh_prev, Mesh *mesh)
+{
+  BVHCache *bvh_cache = bvhcache_detach_for_refit(mesh_prev);
+  EXPECT_NE(bvh_cache, nullptr);
+  BKE_id_free(nullptr, mesh_prev);
+  bvhcache_attach_for_refit(mesh, bvh_cache);
+
+  BVHTreeFromMesh data;
+  BVHTree *tree = BKE_bvhtree_from_mesh_get(&data, mesh, BVHTREE_FROM_LOOPTRI, TREE_TYPE_REBUILD);
+  free_bvhtree_from_mesh(&data);
+  return tree;
+}
+
+/* The tree must still find the surface of the mesh. */
+static void tree_ray_cast_check(Mesh *mesh, BVHTree *tree, const float z)
+{
+  BVHTreeFromMesh data;
+  BKE_bvhtree_from_mesh_get(&data, mesh, BVHTREE_FROM_LOOPTRI, TREE_TYPE_REBUILD);
+  EXPECT_EQ(data.tree, tree);
+
+  const float co[3] = {GRID_SIZE * 0.5f + 0.25f, GRID_SIZE * 0.5f + 0.25f, z + 10.0f};
+  const float dir[3] = {0.0f, 0.0f, -1.0f};
+  BVHTreeRayHit hit;
+  hit.index = -1;
+  hit.dist = BVH_RAYCAST_DIST_MAX;
+  BLI_bvhtree_ray_cast(tree, co, dir, 0.0f, &hit, data.raycast_callback, &data);
+  EXPECT_NE(hit.index, -1);
+  EXPECT_FLOAT_EQ(hit.dist, 10.0f);
+
+  free_bvhtree_from_mesh(&data);
+}
+
+class BVHCacheRefitTest : public testing::Test {
+ public:
+  Mesh *mesh;
+  BVHTree *tree;
+
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+
+  void SetUp() override
+  {
+    mesh = grid_create(0.0f, false);
+    BVHTreeFromMesh data;
+    tree = BKE_bvhtree_from_mesh_get(&data, mesh, BVHTREE_FROM_LOOPTRI, TREE_TYPE_FIRST);
+    free_bvhtree_from_mesh(&data);
+    ASSERT_NE(tree, nullptr);
+  }
+};
+
+TEST_F(BVHCacheRefitTest, RefitAfterDeform)
+{
+  Mesh *mesh_deformed = grid_create(1.0f, false);
+  BVHTree *tree_deformed = tree_get_after_evaluation(mesh, mesh_deformed);
+
+  EXPECT_EQ(tree_deformed, tree);
+  EXPECT_EQ(BLI_bvhtree_get_tree_type(tree_deformed), TREE_TYPE_FIRST);
+  tree_ray_cast_check(mesh_deformed, tree_deformed, 1.0f);
+
+  BKE_id_free(nullptr, mesh_deformed);
+}
+
+TEST_F(BVHCacheRefitTest, RebuildAfterTopologyChange)
+{
+  /* Same number of vertices, polygons, loops and triangles, but different triangles. */
+  Mesh *mesh_changed = grid_create(0.0f, true);
+  EXPECT_EQ(mesh_changed->totloop, mesh->totloop);
+  BVHTree *tree_changed = tree_get_after_evaluation(mesh, mesh_changed);
+
+  ASSERT_NE(tree_changed, nullptr);
+  EXPECT_EQ(BLI_bvhtree_get_tree_type(tree_changed), TREE_TYPE_REBUILD);
+  tree_ray_cast_check(mesh_changed, tree_changed, 0.0f);
+
+  BKE_id_free(nullptr, mesh_changed);
+}
+
+TEST_F(BVHCacheRefitTest, RebuildAfterScramble)
+{
+  /* Every vertex moves to the position of another one, far away. The refit tree is much worse
+   * than a balanced one, so it's built again. */
+  Mesh *mesh_scrambled = grid_create(0.0f, false);
+  const int verts_len = mesh_scrambled->totvert;
+  for (int i = 0; i < verts_len; i++) {
+    copy_v3_v3(mesh_scrambled->mvert[i].co, mesh->mvert[(i * 97) % verts_len].co);
+  }
+  BVHTree *tree_scrambled = tree_get_after_evaluation(mesh, mesh_scrambled);
+
+  ASSERT_NE(tree_scrambled, nullptr);
+  EXPECT_EQ(BLI_bvhtree_get_tree_type(tree_scrambled), TREE_TYPE_REBUILD);
+
+  BKE_id_free(nullptr, mesh_scrambled);
+}
+
+}  // namespace blender::bke::tests
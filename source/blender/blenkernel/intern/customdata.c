@@ -3624,7 +3624,10 @@ void CustomData_bmesh_free_block_data(CustomData *data, void *block)
   }
 }
 
-static void CustomData_bmesh_alloc_block(CustomData *data, void **block)
+/**
+ * Allocate a block without initializing it, freeing the existing block.
+ */
+void CustomData_bmesh_alloc_block(CustomData *data, void **block)
 {
   if (*block) {
     CustomData_bmesh_free_block(data, block);
@@ -4144,6 +4147,20 @@ void CustomData_from_bmesh_block(const CustomData *source,
                                  CustomData *dest,
                                  void *src_block,
                                  int dest_index)
+{
+  CustomData_from_bmesh_block_ex(source, dest, src_block, dest_index, false);
+}
+
+/**
+ * \param use_move: Move the data of layers with a free callback into \a dest
+ * instead of copying it, the source layers must be tagged with
+ * #CustomData_bmesh_moved_layers_nofree afterwards so the data isn't freed twice.
+ */
+void CustomData_from_bmesh_block_ex(const CustomData *source,
+                                    CustomData *dest,
+                                    void *src_block,
+                                    int dest_index,
+                                    const bool use_move)
 {
   /* copies a layer at a time */
   int dest_i = 0;
@@ -4169,7 +4186,10 @@ void CustomData_from_bmesh_block(const CustomData *source,
       void *dst_data = POINTER_OFFSET(dest->layers[dest_i].data,
                                       (size_t)dest_index * typeInfo->size);
 
-      if (typeInfo->copy) {
+      if (use_move && typeInfo->free) {
+        memcpy(dst_data, src_data, typeInfo->size);
+      }
+      else if (typeInfo->copy) {
         typeInfo->copy(src_data, dst_data, 1);
       }
       else {
@@ -4185,6 +4205,32 @@ void CustomData_from_bmesh_block(const CustomData *source,
   }
 }
 
+/**
+ * Tag the layers of \a source which had their data moved into \a dest by
+ * #CustomData_from_bmesh_block_ex so freeing the BMesh doesn't have to loop over
+ * its elements to free data it no longer owns.
+ */
+void CustomData_bmesh_moved_layers_nofree(CustomData *source, const CustomData *dest)
+{
+  int dest_i = 0;
+  for (int src_i = 0; src_i < source->totlayer; src_i++) {
+    while (dest_i < dest->totlayer && dest->layers[dest_i].type < source->layers[src_i].type) {
+      dest_i++;
+    }
+
+    if (dest_i >= dest->totlayer) {
+      return;
+    }
+
+    if (dest->layers[dest_i].type == source->layers[src_i].type) {
+      if (layerType_getInfo(source->layers[src_i].type)->free) {
+        source->layers[src_i].flag |= CD_FLAG_NOFREE;
+      }
+      dest_i++;
+    }
+  }
+}
+
 void CustomData_file_write_info(int type, const char **r_struct_name, int *r_struct_num)
 {
   const LayerTypeInfo *typeInfo = layerType_getInfo(type);
@@ -490,6 +490,8 @@ void BKE_image_free_buffers_ex(Image *ima, bool do_lock)
     tile->ok = IMA_OK;
   }
 
+  ima->reload_counter++;
+
   if (do_lock) {
     BLI_mutex_unlock(image_mutex);
   }
@@ -3593,6 +3595,11 @@ void BKE_image_signal(Main *bmain, Image *ima, ImageUser *iuser, int signal)
 
   BLI_mutex_unlock(image_mutex);
 
+  if (signal == IMA_SIGNAL_RELOAD) {
+    /* Compositor results of the old image buffers are never used again. */
+    ntreeCompositClearCaches();
+  }
+
   /* don't use notifiers because they are not 100% sure to succeeded
    * this also makes sure all scenes are accounted for. */
   {
@@ -5639,6 +5646,7 @@ bool BKE_image_is_dirty(Image *image)
 void BKE_image_mark_dirty(Image *UNUSED(image), ImBuf *ibuf)
 {
   ibuf->userflags |= IB_BITMAPDIRTY;
+  ibuf->change_counter++;
 }
 
 bool BKE_image_buffer_format_writable(ImBuf *ibuf)
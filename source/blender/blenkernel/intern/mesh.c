@@ -42,6 +42,7 @@
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_string.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -1778,6 +1779,7 @@ void BKE_mesh_vert_coords_apply(Mesh *mesh, const float (*vert_coords)[3])
     copy_v3_v3(mv->co, vert_coords[i]);
   }
   mesh->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+  mesh->runtime.vert_normals_valid = false;
 }
 
 void BKE_mesh_vert_coords_apply_with_mat4(Mesh *mesh,
@@ -1791,6 +1793,7 @@ void BKE_mesh_vert_coords_apply_with_mat4(Mesh *mesh,
     mul_v3_m4v3(mv->co, mat, vert_coords[i]);
   }
   mesh->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+  mesh->runtime.vert_normals_valid = false;
 }
 
 void BKE_mesh_vert_normals_apply(Mesh *mesh, const short (*vert_normals)[3])
@@ -1802,6 +1805,7 @@ void BKE_mesh_vert_normals_apply(Mesh *mesh, const short (*vert_normals)[3])
     copy_v3_v3_short(mv->no, vert_normals[i]);
   }
   mesh->runtime.cd_dirty_vert &= ~CD_MASK_NORMAL;
+  mesh->runtime.vert_normals_valid = true;
 }
 
 /**
@@ -1811,7 +1815,9 @@ void BKE_mesh_vert_normals_apply(Mesh *mesh, const short (*vert_normals)[3])
  * That data, among other things, contains 'smooth fan' info, useful e.g.
  * to split geometry along sharp edges...
  */
-void BKE_mesh_calc_normals_split_ex(Mesh *mesh, MLoopNorSpaceArray *r_lnors_spacearr)
+static void mesh_calc_normals_split(Mesh *mesh,
+                                    MLoopNorSpaceArray *r_lnors_spacearr,
+                                    MLoopSplitCache **cache_p)
 {
   float(*r_loopnors)[3];
   float(*polynors)[3];
@@ -1856,21 +1862,22 @@ void BKE_mesh_calc_normals_split_ex(Mesh *mesh, MLoopNorSpaceArray *r_lnors_spac
     free_polynors = true;
   }
 
-  BKE_mesh_normals_loop_split(mesh->mvert,
-                              mesh->totvert,
-                              mesh->medge,
-                              mesh->totedge,
-                              mesh->mloop,
-                              r_loopnors,
-                              mesh->totloop,
-                              mesh->mpoly,
-                              (const float(*)[3])polynors,
-                              mesh->totpoly,
-                              use_split_normals,
-                              split_angle,
-                              r_lnors_spacearr,
-                              clnors,
-                              NULL);
+  BKE_mesh_normals_loop_split_ex(mesh->mvert,
+                                 mesh->totvert,
+                                 mesh->medge,
+                                 mesh->totedge,
+                                 mesh->mloop,
+                                 r_loopnors,
+                                 mesh->totloop,
+                                 mesh->mpoly,
+                                 (const float(*)[3])polynors,
+                                 mesh->totpoly,
+                                 use_split_normals,
+                                 split_angle,
+                                 r_lnors_spacearr,
+                                 clnors,
+                                 NULL,
+                                 cache_p);
 
   if (free_polynors) {
     MEM_freeN(polynors);
@@ -1879,6 +1886,50 @@ void BKE_mesh_calc_normals_split_ex(Mesh *mesh, MLoopNorSpaceArray *r_lnors_spac
   mesh->runtime.cd_dirty_vert &= ~CD_MASK_NORMAL;
 }
 
+void BKE_mesh_calc_normals_split_ex(Mesh *mesh, MLoopNorSpaceArray *r_lnors_spacearr)
+{
+  mesh_calc_normals_split(mesh, r_lnors_spacearr, NULL);
+}
+
+/**
+ * Same as #BKE_mesh_calc_normals_split, but keeps the topology data of split normals in the
+ * runtime data of \a mesh_src. It is re-used as long as the loops and polygons of \a mesh have
+ * the same topology as when it was computed, e.g. when the modifier stack only deformed it.
+ */
+void BKE_mesh_calc_normals_split_cached(Mesh *mesh, const Mesh *mesh_src)
+{
+  /* Only the cache in the runtime data is changed, while holding the evaluation mutex. */
+  Mesh_Runtime *runtime_src = (Mesh_Runtime *)&mesh_src->runtime;
+
+  const bool use_cache = (mesh->totedge == mesh_src->totedge &&
+                          mesh->totloop == mesh_src->totloop &&
+                          mesh->totpoly == mesh_src->totpoly);
+  if (!use_cache) {
+    mesh_calc_normals_split(mesh, NULL, NULL);
+    return;
+  }
+
+  /* Take the cache out of the source mesh while using it,
+   * since the source mesh may be shared by objects being evaluated in parallel. */
+  BLI_mutex_lock(runtime_src->eval_mutex);
+  MLoopSplitCache *cache = runtime_src->loop_split_cache;
+  runtime_src->loop_split_cache = NULL;
+  BLI_mutex_unlock(runtime_src->eval_mutex);
+
+  mesh_calc_normals_split(mesh, NULL, &cache);
+
+  BLI_mutex_lock(runtime_src->eval_mutex);
+  if (runtime_src->loop_split_cache == NULL) {
+    runtime_src->loop_split_cache = cache;
+    cache = NULL;
+  }
+  BLI_mutex_unlock(runtime_src->eval_mutex);
+
+  if (cache != NULL) {
+    BKE_mesh_loop_split_cache_free(cache);
+  }
+}
+
 void BKE_mesh_calc_normals_split(Mesh *mesh)
 {
   BKE_mesh_calc_normals_split_ex(mesh, NULL);
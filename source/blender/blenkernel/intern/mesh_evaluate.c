@@ -36,6 +36,7 @@
 #include "BLI_alloca.h"
 #include "BLI_bitmap.h"
 #include "BLI_edgehash.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_linklist.h"
 #include "BLI_linklist_stack.h"
 #include "BLI_math.h"
@@ -213,6 +214,9 @@ typedef struct MeshCalcNormalsData {
   float (*pnors)[3];
   float (*lnors_weighted)[3];
   float (*vnors)[3];
+  /** Vertex to loop adjacency, loops of vertex `i` are in `[offsets[i], offsets[i + 1])`. */
+  int *vert_loop_offsets;
+  int *vert_loop_indices;
 } MeshCalcNormalsData;
 
 static void mesh_calc_normals_poly_cb(void *__restrict userdata,
@@ -268,7 +272,7 @@ static void mesh_calc_normals_poly_prepare_cb(void *__restrict userdata,
 
   /* accumulate angle weighted face normal */
   /* inline version of #accumulate_vertex_normals_poly_v3,
-   * split between this threaded callback and #mesh_calc_normals_poly_accum_cb. */
+   * split between this threaded callback and #mesh_calc_normals_poly_finalize_cb. */
   {
     const float *prev_edge = edgevecbuf[nverts - 1];
 
@@ -297,6 +301,28 @@ static void mesh_calc_normals_poly_finalize_cb(void *__restrict userdata,
   MVert *mv = &data->mverts[vidx];
   float *no = data->vnors[vidx];
 
+  /* Gather the weighted normals of all loops using this vertex. Each vertex is only written by
+   * its own task, so no atomics or locks are needed. The adjacency is filled in parallel, sort the
+   * few loops of the vertex so they are summed in increasing order, the result then matches the
+   * serial accumulation exactly. */
+  int *vert_loops = &data->vert_loop_indices[data->vert_loop_offsets[vidx]];
+  const int vert_loops_num = data->vert_loop_offsets[vidx + 1] - data->vert_loop_offsets[vidx];
+  for (int i = 1; i < vert_loops_num; i++) {
+    const int lidx = vert_loops[i];
+    int j = i;
+    for (; j > 0 && vert_loops[j - 1] > lidx; j--) {
+      vert_loops[j] = vert_loops[j - 1];
+    }
+    vert_loops[j] = lidx;
+  }
+
+  const float(*lnors_weighted)[3] = (const float(*)[3])data->lnors_weighted;
+  float no_accum[3] = {0.0f, 0.0f, 0.0f};
+  for (int i = 0; i < vert_loops_num; i++) {
+    add_v3_v3(no_accum, lnors_weighted[vert_loops[i]]);
+  }
+  copy_v3_v3(no, no_accum);
+
   if (UNLIKELY(normalize_v3(no) == 0.0f)) {
     /* following Mesh convention; we use vertex coordinate itself for normal in this case */
     normalize_v3_v3(no, mv->co);
@@ -305,6 +331,67 @@ static void mesh_calc_normals_poly_finalize_cb(void *__restrict userdata,
   normal_float_to_short_v3(mv->no, no);
 }
 
+typedef struct MeshVertLoopMapData {
+  const MLoop *mloop;
+  int *offsets;
+  int *indices;
+} MeshVertLoopMapData;
+
+static void mesh_calc_normals_vert_loop_count_cb(void *__restrict userdata,
+                                                 const int lidx,
+                                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshVertLoopMapData *data = userdata;
+  atomic_add_and_fetch_int32(&data->offsets[data->mloop[lidx].v + 1], 1);
+}
+
+static void mesh_calc_normals_vert_loop_fill_cb(void *__restrict userdata,
+                                                const int lidx,
+                                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshVertLoopMapData *data = userdata;
+  const int index = atomic_fetch_and_add_int32(&data->offsets[data->mloop[lidx].v], 1);
+  data->indices[index] = lidx;
+}
+
+/**
+ * Build vertex to loop adjacency with a counting sort over the loops.
+ *
+ * Counting and filling are threaded over the loops, only the prefix sum of the counts is serial,
+ * it reads the offsets once sequentially. Vertices only share a counter with the loops around
+ * them, so there is hardly any contention on the atomics. The order of the loops of a vertex is
+ * arbitrary, see #mesh_calc_normals_poly_finalize_cb.
+ */
+static void mesh_calc_normals_vert_loop_map_create(const MLoop *mloop,
+                                                   const int numVerts,
+                                                   const int numLoops,
+                                                   const TaskParallelSettings *settings,
+                                                   int **r_offsets,
+                                                   int **r_indices)
+{
+  MeshVertLoopMapData data = {
+      .mloop = mloop,
+      .offsets = MEM_calloc_arrayN((size_t)numVerts + 1, sizeof(int), __func__),
+      .indices = MEM_malloc_arrayN((size_t)numLoops, sizeof(int), __func__),
+  };
+  int *offsets = data.offsets;
+
+  /* Count the loops of `v` in `offsets[v + 1]`. */
+  BLI_task_parallel_range(0, numLoops, &data, mesh_calc_normals_vert_loop_count_cb, settings);
+  /* Prefix sum, `offsets[v]` is the start of the loops of `v`. */
+  for (int vidx = 0; vidx < numVerts; vidx++) {
+    offsets[vidx + 1] += offsets[vidx];
+  }
+  /* Fill using `offsets[v]` as cursor. After this `offsets[v]` is the end of the loops of `v`,
+   * which is the start of the loops of `v + 1`. */
+  BLI_task_parallel_range(0, numLoops, &data, mesh_calc_normals_vert_loop_fill_cb, settings);
+  memmove(offsets + 1, offsets, sizeof(int) * (size_t)numVerts);
+  offsets[0] = 0;
+
+  *r_offsets = data.offsets;
+  *r_indices = data.indices;
+}
+
 void BKE_mesh_calc_normals_poly(MVert *mverts,
                                 float (*r_vertnors)[3],
                                 int numVerts,
@@ -343,12 +430,13 @@ void BKE_mesh_calc_normals_poly(MVert *mverts,
 
   /* first go through and calculate normals for all the polys */
   if (vnors == NULL) {
-    vnors = MEM_calloc_arrayN((size_t)numVerts, sizeof(*vnors), __func__);
+    vnors = MEM_malloc_arrayN((size_t)numVerts, sizeof(*vnors), __func__);
     free_vnors = true;
   }
-  else {
-    memset(vnors, 0, sizeof(*vnors) * (size_t)numVerts);
-  }
+
+  int *vert_loop_offsets, *vert_loop_indices;
+  mesh_calc_normals_vert_loop_map_create(
+      mloop, numVerts, numLoops, &settings, &vert_loop_offsets, &vert_loop_indices);
 
   MeshCalcNormalsData data = {
       .mpolys = mpolys,
@@ -357,25 +445,23 @@ void BKE_mesh_calc_normals_poly(MVert *mverts,
       .pnors = pnors,
       .lnors_weighted = lnors_weighted,
       .vnors = vnors,
+      .vert_loop_offsets = vert_loop_offsets,
+      .vert_loop_indices = vert_loop_indices,
   };
 
   /* Compute poly normals, and prepare weighted loop normals. */
   BLI_task_parallel_range(0, numPolys, &data, mesh_calc_normals_poly_prepare_cb, &settings);
 
-  /* Actually accumulate weighted loop normals into vertex ones. */
-  /* Unfortunately, not possible to thread that
-   * (not in a reasonable, totally lock- and barrier-free fashion),
-   * since several loops will point to the same vertex... */
-  for (int lidx = 0; lidx < numLoops; lidx++) {
-    add_v3_v3(vnors[mloop[lidx].v], data.lnors_weighted[lidx]);
-  }
-
-  /* Normalize and validate computed vertex normals. */
+  /* Gather weighted loop normals into vertex ones, then normalize and validate them.
+   * Threaded over vertices using the vertex to loop adjacency, so that every vertex normal is
+   * only written once and no atomics are needed. */
   BLI_task_parallel_range(0, numVerts, &data, mesh_calc_normals_poly_finalize_cb, &settings);
 
   if (free_vnors) {
     MEM_freeN(vnors);
   }
+  MEM_freeN(vert_loop_offsets);
+  MEM_freeN(vert_loop_indices);
   MEM_freeN(lnors_weighted);
 }
 
@@ -457,6 +543,7 @@ void BKE_mesh_calc_normals(Mesh *mesh)
   TIMEIT_END_AVERAGED(BKE_mesh_calc_normals);
 #endif
   mesh->runtime.cd_dirty_vert &= ~CD_MASK_NORMAL;
+  mesh->runtime.vert_normals_valid = true;
 }
 
 void BKE_mesh_calc_normals_looptri(MVert *mverts,
@@ -798,133 +885,254 @@ typedef struct LoopSplitTaskDataCommon {
   MLoopNorSpaceArray *lnors_spacearr;
   float (*loopnors)[3];
   short (*clnors_data)[2];
+  int (*edge_to_loops)[2];
+  /** One of #eLoopSplitEntry for each loop. */
+  char *loop_entries;
+  /** Smallest loop (in polygon order) from which a cyclic fan walk passed each loop, or -1. */
+  int *loop_fan_claims;
 
   /* Read-only. */
   const MVert *mverts;
   const MEdge *medges;
   const MLoop *mloops;
   const MPoly *mpolys;
-  int (*edge_to_loops)[2];
-  int *loop_to_poly;
+  const int (*edge_loops)[2];
+  const BLI_bitmap *edge_nonmanifold;
+  const int *loop_to_poly;
   const float (*polynors)[3];
 
+  /** Loops from which each smooth fan is walked, and their (pre-allocated) spaces. */
+  const int *fan_entries;
+  MLoopNorSpace *lnor_spaces;
+
   int numEdges;
   int numLoops;
   int numPolys;
 } LoopSplitTaskDataCommon;
 
-#define INDEX_UNSET INT_MIN
-#define INDEX_INVALID -1
-/* See comment about edge_to_loops below. */
-#define IS_EDGE_SHARP(_e2l) (ELEM((_e2l)[1], INDEX_UNSET, INDEX_INVALID))
+/** How a loop is handled when computing split normals. */
+typedef enum eLoopSplitEntry {
+  /** Loop is handled by the fan of another loop. */
+  LOOP_SPLIT_ENTRY_NONE = 0,
+  /** Both edges of the loop are sharp, it just takes the poly normal. */
+  LOOP_SPLIT_ENTRY_SINGLE = 1,
+  /** Loop is the start of a smooth fan around its vertex. */
+  LOOP_SPLIT_ENTRY_FAN = 2,
+} eLoopSplitEntry;
 
-static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
-                                 const bool check_angle,
-                                 const float split_angle,
-                                 const bool do_sharp_edges_tag)
-{
-  const MVert *mverts = data->mverts;
-  const MEdge *medges = data->medges;
-  const MLoop *mloops = data->mloops;
+/**
+ * Topology data of split normals computation.
+ *
+ * It only depends on the loops and polygons of the mesh, not on vertex positions or on sharp and
+ * smooth flags, so it can be kept across evaluations when only vertex positions change.
+ */
+struct MLoopSplitCache {
+  /** Topology this cache was computed from, to check whether it can be re-used. Arrays pointers
+   * are not enough, loops may be edited in-place or re-allocated at the same address. */
+  uint topology_hash;
+  int numEdges;
+  int numLoops;
+  int numPolys;
 
-  const MPoly *mpolys = data->mpolys;
+  /** First two loops using each edge, -1 if unused. */
+  int (*edge_loops)[2];
+  /** Edges used by more than two loops. */
+  BLI_bitmap *edge_nonmanifold;
+  int *loop_to_poly;
 
-  const int numEdges = data->numEdges;
-  const int numPolys = data->numPolys;
+  /** Storage of the loop normal spaces, cleared and re-used instead of re-allocated. */
+  MLoopNorSpaceArray lnors_spacearr;
+};
 
-  float(*loopnors)[3] = data->loopnors; /* Note: loopnors may be NULL here. */
-  const float(*polynors)[3] = data->polynors;
+/**
+ * Hash of the vertex and edge indices of the loops, and of the loop ranges of the polygons.
+ * Everything else the cache depends on is covered by the element counts.
+ */
+static uint loop_split_cache_topology_hash(const MLoop *mloops,
+                                           const MPoly *mpolys,
+                                           const int numLoops,
+                                           const int numPolys)
+{
+  BLI_STATIC_ASSERT(sizeof(MLoop) == sizeof(uint[2]), "MLoop is expected to only hold indices");
 
-  int(*edge_to_loops)[2] = data->edge_to_loops;
-  int *loop_to_poly = data->loop_to_poly;
+  BLI_HashMurmur2A mm2;
+  BLI_hash_mm2a_init(&mm2, 0);
+  BLI_hash_mm2a_add(&mm2, (const uchar *)mloops, sizeof(*mloops) * (size_t)numLoops);
+  for (int mp_index = 0; mp_index < numPolys; mp_index++) {
+    BLI_hash_mm2a_add_int(&mm2, mpolys[mp_index].loopstart);
+    BLI_hash_mm2a_add_int(&mm2, mpolys[mp_index].totloop);
+  }
+  return BLI_hash_mm2a_end(&mm2);
+}
+
+static MLoopSplitCache *loop_split_cache_create(const MLoop *mloops,
+                                                const MPoly *mpolys,
+                                                const uint topology_hash,
+                                                const int numEdges,
+                                                const int numLoops,
+                                                const int numPolys)
+{
+  MLoopSplitCache *cache = MEM_callocN(sizeof(*cache), __func__);
+  cache->topology_hash = topology_hash;
+  cache->numEdges = numEdges;
+  cache->numLoops = numLoops;
+  cache->numPolys = numPolys;
+
+  int(*edge_loops)[2] = MEM_malloc_arrayN((size_t)numEdges, sizeof(*edge_loops), __func__);
+  BLI_bitmap *edge_nonmanifold = BLI_BITMAP_NEW(numEdges, __func__);
+  int *loop_to_poly = MEM_malloc_arrayN((size_t)numLoops, sizeof(*loop_to_poly), __func__);
 
-  BLI_bitmap *sharp_edges = do_sharp_edges_tag ? BLI_BITMAP_NEW(numEdges, __func__) : NULL;
+  copy_vn_i((int *)edge_loops, numEdges * 2, -1);
 
+  /* Only integer bookkeeping here, sharpness is evaluated in parallel by #mesh_edges_sharp_tag. */
   const MPoly *mp;
   int mp_index;
-
-  const float split_angle_cos = check_angle ? cosf(split_angle) : -1.0f;
-
   for (mp = mpolys, mp_index = 0; mp_index < numPolys; mp++, mp_index++) {
-    const MLoop *ml_curr;
-    int *e2l;
-    int ml_curr_index = mp->loopstart;
-    const int ml_last_index = (ml_curr_index + mp->totloop) - 1;
-
-    ml_curr = &mloops[ml_curr_index];
-
-    for (; ml_curr_index <= ml_last_index; ml_curr++, ml_curr_index++) {
-      e2l = edge_to_loops[ml_curr->e];
-
-      loop_to_poly[ml_curr_index] = mp_index;
+    const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+    for (int ml_index = mp->loopstart; ml_index <= ml_last_index; ml_index++) {
+      const uint e_index = mloops[ml_index].e;
+      int *e2l = edge_loops[e_index];
 
-      /* Pre-populate all loop normals as if their verts were all-smooth,
-       * this way we don't have to compute those later!
-       */
-      if (loopnors) {
-        normal_short_to_float_v3(loopnors[ml_curr_index], mverts[ml_curr->v].no);
-      }
+      loop_to_poly[ml_index] = mp_index;
 
-      /* Check whether current edge might be smooth or sharp */
-      if ((e2l[0] | e2l[1]) == 0) {
-        /* 'Empty' edge until now, set e2l[0] (and e2l[1] to INDEX_UNSET to tag it as unset). */
-        e2l[0] = ml_curr_index;
-        /* We have to check this here too, else we might miss some flat faces!!! */
-        e2l[1] = (mp->flag & ME_SMOOTH) ? INDEX_UNSET : INDEX_INVALID;
+      if (e2l[0] == -1) {
+        e2l[0] = ml_index;
       }
-      else if (e2l[1] == INDEX_UNSET) {
-        const bool is_angle_sharp = (check_angle &&
-                                     dot_v3v3(polynors[loop_to_poly[e2l[0]]], polynors[mp_index]) <
-                                         split_angle_cos);
-
-        /* Second loop using this edge, time to test its sharpness.
-         * An edge is sharp if it is tagged as such, or its face is not smooth,
-         * or both poly have opposed (flipped) normals, i.e. both loops on the same edge share the
-         * same vertex, or angle between both its polys' normals is above split_angle value.
-         */
-        if (!(mp->flag & ME_SMOOTH) || (medges[ml_curr->e].flag & ME_SHARP) ||
-            ml_curr->v == mloops[e2l[0]].v || is_angle_sharp) {
-          /* Note: we are sure that loop != 0 here ;) */
-          e2l[1] = INDEX_INVALID;
-
-          /* We want to avoid tagging edges as sharp when it is already defined as such by
-           * other causes than angle threshold... */
-          if (do_sharp_edges_tag && is_angle_sharp) {
-            BLI_BITMAP_SET(sharp_edges, ml_curr->e, true);
-          }
-        }
-        else {
-          e2l[1] = ml_curr_index;
-        }
+      else if (e2l[1] == -1) {
+        e2l[1] = ml_index;
       }
-      else if (!IS_EDGE_SHARP(e2l)) {
-        /* More than two loops using this edge, tag as sharp if not yet done. */
-        e2l[1] = INDEX_INVALID;
-
-        /* We want to avoid tagging edges as sharp when it is already defined as such by
-         * other causes than angle threshold... */
-        if (do_sharp_edges_tag) {
-          BLI_BITMAP_SET(sharp_edges, ml_curr->e, false);
-        }
+      else {
+        BLI_BITMAP_ENABLE(edge_nonmanifold, e_index);
       }
-      /* Else, edge is already 'disqualified' (i.e. sharp)! */
     }
   }
 
-  /* If requested, do actual tagging of edges as sharp in another loop. */
-  if (do_sharp_edges_tag) {
-    MEdge *me;
-    int me_index;
-    for (me = (MEdge *)medges, me_index = 0; me_index < numEdges; me++, me_index++) {
-      if (BLI_BITMAP_TEST(sharp_edges, me_index)) {
-        me->flag |= ME_SHARP;
-      }
-    }
+  cache->edge_loops = edge_loops;
+  cache->edge_nonmanifold = edge_nonmanifold;
+  cache->loop_to_poly = loop_to_poly;
+
+  return cache;
+}
+
+static bool loop_split_cache_is_valid(const MLoopSplitCache *cache,
+                                      const uint topology_hash,
+                                      const int numEdges,
+                                      const int numLoops,
+                                      const int numPolys)
+{
+  return (cache->topology_hash == topology_hash && cache->numEdges == numEdges &&
+          cache->numLoops == numLoops && cache->numPolys == numPolys);
+}
+
+void BKE_mesh_loop_split_cache_free(MLoopSplitCache *cache)
+{
+  if (cache->lnors_spacearr.mem != NULL) {
+    BKE_lnor_spacearr_free(&cache->lnors_spacearr);
+  }
+  MEM_freeN(cache->edge_loops);
+  MEM_freeN(cache->edge_nonmanifold);
+  MEM_freeN(cache->loop_to_poly);
+  MEM_freeN(cache);
+}
+
+#define INDEX_UNSET INT_MIN
+#define INDEX_INVALID -1
+/* See comment about edge_to_loops below. */
+#define IS_EDGE_SHARP(_e2l) (ELEM((_e2l)[1], INDEX_UNSET, INDEX_INVALID))
+
+typedef struct MeshEdgesSharpTagData {
+  LoopSplitTaskDataCommon *common_data;
+  float split_angle_cos;
+  bool check_angle;
+  bool do_sharp_edges_tag;
+} MeshEdgesSharpTagData;
+
+static void mesh_edges_sharp_tag_cb(void *__restrict userdata,
+                                    const int me_index,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const MeshEdgesSharpTagData *tag_data = userdata;
+  const LoopSplitTaskDataCommon *data = tag_data->common_data;
+
+  const MLoop *mloops = data->mloops;
+  const MPoly *mpolys = data->mpolys;
+  const int *loop_to_poly = data->loop_to_poly;
+  const float(*polynors)[3] = data->polynors;
+
+  const int *e_loops = data->edge_loops[me_index];
+  int *e2l = data->edge_to_loops[me_index];
+
+  if (e_loops[0] == -1) {
+    /* Loose edge. */
+    e2l[0] = e2l[1] = 0;
+    return;
+  }
+
+  const int mp_first_index = loop_to_poly[e_loops[0]];
+  e2l[0] = e_loops[0];
+
+  if (!(mpolys[mp_first_index].flag & ME_SMOOTH)) {
+    e2l[1] = INDEX_INVALID;
+    return;
+  }
+  if (e_loops[1] == -1) {
+    /* Only one loop, tag as unset. */
+    e2l[1] = INDEX_UNSET;
+    return;
+  }
 
-    MEM_freeN(sharp_edges);
+  const int mp_index = loop_to_poly[e_loops[1]];
+  const bool is_angle_sharp = (tag_data->check_angle &&
+                               dot_v3v3(polynors[mp_first_index], polynors[mp_index]) <
+                                   tag_data->split_angle_cos);
+
+  /* An edge is sharp if it is tagged as such, or its face is not smooth,
+   * or both poly have opposed (flipped) normals, i.e. both loops on the same edge share the
+   * same vertex, or angle between both its polys' normals is above split_angle value.
+   */
+  if (!(mpolys[mp_index].flag & ME_SMOOTH) || (data->medges[me_index].flag & ME_SHARP) ||
+      mloops[e_loops[1]].v == mloops[e_loops[0]].v || is_angle_sharp) {
+    e2l[1] = INDEX_INVALID;
+
+    /* We want to avoid tagging edges as sharp when it is already defined as such by
+     * other causes than angle threshold... Each edge is only handled by one task,
+     * so it's safe to write its flag here. */
+    if (tag_data->do_sharp_edges_tag && is_angle_sharp) {
+      ((MEdge *)data->medges)[me_index].flag |= ME_SHARP;
+    }
+  }
+  else if (BLI_BITMAP_TEST(data->edge_nonmanifold, me_index)) {
+    /* More than two loops using this edge, always sharp. */
+    e2l[1] = INDEX_INVALID;
+  }
+  else {
+    e2l[1] = e_loops[1];
   }
 }
 
+/**
+ * Fill `edge_to_loops` from the cached edge loops, checking which edges are actually smooth.
+ * Threaded over edges, since the result of each edge only depends on its own loops.
+ */
+static void mesh_edges_sharp_tag(LoopSplitTaskDataCommon *data,
+                                 const bool check_angle,
+                                 const float split_angle,
+                                 const bool do_sharp_edges_tag)
+{
+  MeshEdgesSharpTagData tag_data = {
+      .common_data = data,
+      .split_angle_cos = check_angle ? cosf(split_angle) : -1.0f,
+      .check_angle = check_angle,
+      .do_sharp_edges_tag = do_sharp_edges_tag,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = LOOP_SPLIT_TASK_BLOCK_SIZE;
+
+  BLI_task_parallel_range(0, data->numEdges, &tag_data, mesh_edges_sharp_tag_cb, &settings);
+}
+
 /**
  * Define sharp edges as needed to mimic 'autosmooth' from angle threshold.
  *
@@ -947,11 +1155,11 @@ void BKE_edges_sharp_from_angle_set(const struct MVert *mverts,
     return;
   }
 
-  /* Mapping edge -> loops. See BKE_mesh_normals_loop_split() for details. */
-  int(*edge_to_loops)[2] = MEM_calloc_arrayN((size_t)numEdges, sizeof(*edge_to_loops), __func__);
+  MLoopSplitCache *cache = loop_split_cache_create(
+      mloops, mpolys, 0, numEdges, numLoops, numPolys);
 
-  /* Simple mapping from a loop to its polygon index. */
-  int *loop_to_poly = MEM_malloc_arrayN((size_t)numLoops, sizeof(*loop_to_poly), __func__);
+  /* Mapping edge -> loops. See BKE_mesh_normals_loop_split() for details. */
+  int(*edge_to_loops)[2] = MEM_malloc_arrayN((size_t)numEdges, sizeof(*edge_to_loops), __func__);
 
   LoopSplitTaskDataCommon common_data = {
       .mverts = mverts,
@@ -959,7 +1167,9 @@ void BKE_edges_sharp_from_angle_set(const struct MVert *mverts,
       .mloops = mloops,
       .mpolys = mpolys,
       .edge_to_loops = edge_to_loops,
-      .loop_to_poly = loop_to_poly,
+      .edge_loops = (const int(*)[2])cache->edge_loops,
+      .edge_nonmanifold = cache->edge_nonmanifold,
+      .loop_to_poly = cache->loop_to_poly,
       .polynors = polynors,
       .numEdges = numEdges,
       .numPolys = numPolys,
@@ -968,7 +1178,7 @@ void BKE_edges_sharp_from_angle_set(const struct MVert *mverts,
   mesh_edges_sharp_tag(&common_data, true, split_angle, true);
 
   MEM_freeN(edge_to_loops);
-  MEM_freeN(loop_to_poly);
+  BKE_mesh_loop_split_cache_free(cache);
 }
 
 void BKE_mesh_loop_manifold_fan_around_vert_next(const MLoop *mloops,
@@ -1310,56 +1520,64 @@ static void loop_split_worker_do(LoopSplitTaskDataCommon *common_data,
   }
 }
 
-static void loop_split_worker(TaskPool *__restrict pool, void *taskdata)
+/** Polygon order of loops, a loop comes before another when its polygon comes first. */
+BLI_INLINE bool loop_split_loop_is_before(const int *loop_to_poly,
+                                          const int ml_a_index,
+                                          const int ml_b_index)
 {
-  LoopSplitTaskDataCommon *common_data = BLI_task_pool_user_data(pool);
-  LoopSplitTaskData *data = taskdata;
-
-  /* Temp edge vectors stack, only used when computing lnor spacearr. */
-  BLI_Stack *edge_vectors = common_data->lnors_spacearr ?
-                                BLI_stack_new(sizeof(float[3]), __func__) :
-                                NULL;
-
-#ifdef DEBUG_TIME
-  TIMEIT_START_AVERAGED(loop_split_worker);
-#endif
+  const int mp_a_index = loop_to_poly[ml_a_index];
+  const int mp_b_index = loop_to_poly[ml_b_index];
+  return (mp_a_index < mp_b_index) || (mp_a_index == mp_b_index && ml_a_index < ml_b_index);
+}
 
-  for (int i = 0; i < LOOP_SPLIT_TASK_BLOCK_SIZE; i++, data++) {
-    /* A NULL ml_curr is used to tag ended data! */
-    if (data->ml_curr == NULL) {
-      break;
+/**
+ * Claim a loop for the fan walk started at \a ml_walk_index, unless a walk started at a loop
+ * coming earlier already passed it. Returns false in that case.
+ */
+static bool loop_split_fan_claim(int *loop_fan_claims,
+                                 const int *loop_to_poly,
+                                 const int ml_index,
+                                 const int ml_walk_index)
+{
+  int ml_claim_index = loop_fan_claims[ml_index];
+  while (ml_claim_index == -1 ||
+         loop_split_loop_is_before(loop_to_poly, ml_walk_index, ml_claim_index)) {
+    const int ml_claim_index_prev = atomic_cas_int32(
+        &loop_fan_claims[ml_index], ml_claim_index, ml_walk_index);
+    if (ml_claim_index_prev == ml_claim_index) {
+      return true;
     }
-
-    loop_split_worker_do(common_data, data, edge_vectors);
+    ml_claim_index = ml_claim_index_prev;
   }
-
-  if (edge_vectors) {
-    BLI_stack_free(edge_vectors);
-  }
-
-#ifdef DEBUG_TIME
-  TIMEIT_END_AVERAGED(loop_split_worker);
-#endif
+  return ml_claim_index == ml_walk_index;
 }
 
 /**
- * Check whether given loop is part of an unknown-so-far cyclic smooth fan, or not.
+ * Check whether given loop is the entry point of a cyclic smooth fan.
  * Needed because cyclic smooth fans have no obvious 'entry point',
  * and yet we need to walk them once, and only once.
+ *
+ * The first loop of the fan in polygon order is used, so that every loop can be checked
+ * independently (and the result matches the former serial evaluation order).
+ *
+ * Every walk claims the loops it passes. A walk stops as soon as it reaches a loop claimed by a
+ * walk started from an earlier loop, since that walk covers the rest of the fan. Most loops of a
+ * fan are therefore only passed once, instead of every loop walking the fan up to the first loop.
  */
-static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
-                                                         const MPoly *mpolys,
-                                                         const int (*edge_to_loops)[2],
-                                                         const int *loop_to_poly,
-                                                         const int *e2l_prev,
-                                                         BLI_bitmap *skip_loops,
-                                                         const MLoop *ml_curr,
-                                                         const MLoop *ml_prev,
-                                                         const int ml_curr_index,
-                                                         const int ml_prev_index,
-                                                         const int mp_curr_index)
+static bool loop_split_cyclic_smooth_fan_is_entry(const MLoop *mloops,
+                                                  const MPoly *mpolys,
+                                                  const int (*edge_to_loops)[2],
+                                                  const int *loop_to_poly,
+                                                  int *loop_fan_claims,
+                                                  const int *e2l_prev,
+                                                  const MLoop *ml_prev,
+                                                  const int ml_curr_index,
+                                                  const int ml_prev_index,
+                                                  const int mp_curr_index,
+                                                  const int numLoops)
 {
-  const unsigned int mv_pivot_index = ml_curr->v; /* The vertex we are "fanning" around! */
+  /* The vertex we are "fanning" around! */
+  const unsigned int mv_pivot_index = mloops[ml_curr_index].v;
   const int *e2lfan_curr;
   const MLoop *mlfan_curr;
   /* mlfan_vert_index: the loop of our current edge might not be the loop of our current vertex! */
@@ -1371,6 +1589,11 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
     return false;
   }
 
+  if (!loop_split_fan_claim(loop_fan_claims, loop_to_poly, ml_curr_index, ml_curr_index)) {
+    /* A walk from an earlier loop already passed this one. */
+    return false;
+  }
+
   mlfan_curr = ml_prev;
   mlfan_curr_index = ml_prev_index;
   mlfan_vert_index = ml_curr_index;
@@ -1380,10 +1603,9 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
   BLI_assert(mlfan_vert_index >= 0);
   BLI_assert(mpfan_curr_index >= 0);
 
-  BLI_assert(!BLI_BITMAP_TEST(skip_loops, mlfan_vert_index));
-  BLI_BITMAP_ENABLE(skip_loops, mlfan_vert_index);
-
-  while (true) {
+  /* A fan can never be longer than the number of loops, this only guards against looping
+   * forever on invalid topology. */
+  for (int i = 0; i < numLoops; i++) {
     /* Find next loop of the smooth fan. */
     BKE_mesh_loop_manifold_fan_around_vert_next(mloops,
                                                 mpolys,
@@ -1401,196 +1623,220 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
       /* Sharp loop/edge, so not a cyclic smooth fan... */
       return false;
     }
-    /* Smooth loop/edge... */
-    if (BLI_BITMAP_TEST(skip_loops, mlfan_vert_index)) {
-      if (mlfan_vert_index == ml_curr_index) {
-        /* We walked around a whole cyclic smooth fan without finding any already-processed loop,
-         * means we can use initial ml_curr/ml_prev edge as start for this smooth fan. */
-        return true;
-      }
-      /* ... already checked in some previous looping, we can abort. */
+    if (mlfan_vert_index == ml_curr_index) {
+      /* We walked around a whole cyclic smooth fan without finding any loop coming first,
+       * means we can use initial ml_curr/ml_prev edge as start for this smooth fan. */
+      return true;
+    }
+    if (mpfan_curr_index < mp_curr_index ||
+        (mpfan_curr_index == mp_curr_index && mlfan_vert_index < ml_curr_index)) {
+      /* ... this fan is handled from another loop. */
+      return false;
+    }
+    if (!loop_split_fan_claim(loop_fan_claims, loop_to_poly, mlfan_vert_index, ml_curr_index)) {
+      /* ... the rest of this fan is walked from an earlier loop. */
       return false;
     }
-
-    /* ... we can skip it in future, and keep checking the smooth fan. */
-    BLI_BITMAP_ENABLE(skip_loops, mlfan_vert_index);
   }
+  return false;
 }
 
-static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common_data)
+static void loop_split_entries_cb(void *__restrict userdata,
+                                  const int mp_index,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
+  LoopSplitTaskDataCommon *common_data = userdata;
+
   float(*loopnors)[3] = common_data->loopnors;
+  char *loop_entries = common_data->loop_entries;
 
+  const MVert *mverts = common_data->mverts;
   const MLoop *mloops = common_data->mloops;
   const MPoly *mpolys = common_data->mpolys;
   const int *loop_to_poly = common_data->loop_to_poly;
-  const int(*edge_to_loops)[2] = common_data->edge_to_loops;
-  const int numLoops = common_data->numLoops;
-  const int numPolys = common_data->numPolys;
-
-  const MPoly *mp;
-  int mp_index;
-
-  const MLoop *ml_curr;
-  const MLoop *ml_prev;
-  int ml_curr_index;
-  int ml_prev_index;
+  const int(*edge_to_loops)[2] = (const int(*)[2])common_data->edge_to_loops;
 
-  BLI_bitmap *skip_loops = BLI_BITMAP_NEW(numLoops, __func__);
+  const MPoly *mp = &mpolys[mp_index];
+  const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+  int ml_curr_index = mp->loopstart;
+  int ml_prev_index = ml_last_index;
 
-  LoopSplitTaskData *data_buff = NULL;
-  int data_idx = 0;
+  for (; ml_curr_index <= ml_last_index; ml_prev_index = ml_curr_index, ml_curr_index++) {
+    const MLoop *ml_curr = &mloops[ml_curr_index];
+    const MLoop *ml_prev = &mloops[ml_prev_index];
+    const int *e2l_curr = edge_to_loops[ml_curr->e];
+    const int *e2l_prev = edge_to_loops[ml_prev->e];
 
-  /* Temp edge vectors stack, only used when computing lnor spacearr
-   * (and we are not multi-threading). */
-  BLI_Stack *edge_vectors = NULL;
-
-#ifdef DEBUG_TIME
-  TIMEIT_START_AVERAGED(loop_split_generator);
-#endif
-
-  if (!pool) {
-    if (lnors_spacearr) {
-      edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
+    /* Pre-populate all loop normals as if their verts were all-smooth,
+     * this way we don't have to compute those later!
+     */
+    normal_short_to_float_v3(loopnors[ml_curr_index], mverts[ml_curr->v].no);
+
+    /* We *do not need* to check/tag loops as already computed!
+     * Due to the fact a loop only links to one of its two edges,
+     * a same fan *will never be walked more than once!*
+     * Since we consider edges having neighbor polys with inverted
+     * (flipped) normals as sharp, we are sure that no fan will be skipped,
+     * even only considering the case (sharp curr_edge, smooth prev_edge),
+     * and not the alternative (smooth curr_edge, sharp prev_edge).
+     * All this due/thanks to link between normals and loop ordering (i.e. winding).
+     */
+    char entry;
+    if (IS_EDGE_SHARP(e2l_curr)) {
+      entry = IS_EDGE_SHARP(e2l_prev) ? LOOP_SPLIT_ENTRY_SINGLE : LOOP_SPLIT_ENTRY_FAN;
+    }
+    else {
+      /* A smooth edge, we have to check for cyclic smooth fan case. */
+      entry = loop_split_cyclic_smooth_fan_is_entry(mloops,
+                                                    mpolys,
+                                                    edge_to_loops,
+                                                    loop_to_poly,
+                                                    common_data->loop_fan_claims,
+                                                    e2l_prev,
+                                                    ml_prev,
+                                                    ml_curr_index,
+                                                    ml_prev_index,
+                                                    mp_index,
+                                                    common_data->numLoops) ?
+                  LOOP_SPLIT_ENTRY_FAN :
+                  LOOP_SPLIT_ENTRY_NONE;
     }
+    loop_entries[ml_curr_index] = entry;
   }
+}
 
-  /* We now know edges that can be smoothed (with their vector, and their two loops),
-   * and edges that will be hard! Now, time to generate the normals.
-   */
-  for (mp = mpolys, mp_index = 0; mp_index < numPolys; mp++, mp_index++) {
-    float(*lnors)[3];
-    const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
-    ml_curr_index = mp->loopstart;
-    ml_prev_index = ml_last_index;
+typedef struct LoopSplitTLS {
+  /** Temp edge vectors stack, only used when computing lnor spacearr. */
+  BLI_Stack *edge_vectors;
+} LoopSplitTLS;
 
-    ml_curr = &mloops[ml_curr_index];
-    ml_prev = &mloops[ml_prev_index];
-    lnors = &loopnors[ml_curr_index];
+static void loop_split_fan_cb(void *__restrict userdata,
+                              const int fan_index,
+                              const TaskParallelTLS *__restrict tls)
+{
+  LoopSplitTaskDataCommon *common_data = userdata;
+  LoopSplitTLS *tls_data = tls->userdata_chunk;
 
-    for (; ml_curr_index <= ml_last_index; ml_curr++, ml_curr_index++, lnors++) {
-      const int *e2l_curr = edge_to_loops[ml_curr->e];
-      const int *e2l_prev = edge_to_loops[ml_prev->e];
+  const MLoop *mloops = common_data->mloops;
+  const int ml_curr_index = common_data->fan_entries[fan_index];
+  const int mp_index = common_data->loop_to_poly[ml_curr_index];
+  const MPoly *mp = &common_data->mpolys[mp_index];
+  const int ml_prev_index = (ml_curr_index == mp->loopstart) ?
+                                (mp->loopstart + mp->totloop) - 1 :
+                                ml_curr_index - 1;
+
+  LoopSplitTaskData data = {
+      .lnor_space = common_data->lnor_spaces ? &common_data->lnor_spaces[fan_index] : NULL,
+      .ml_curr = &mloops[ml_curr_index],
+      .ml_prev = &mloops[ml_prev_index],
+      .ml_curr_index = ml_curr_index,
+      .mp_index = mp_index,
+  };
 
-#if 0
-      printf("Checking loop %d / edge %u / vert %u (sharp edge: %d, skiploop: %d)...",
-             ml_curr_index,
-             ml_curr->e,
-             ml_curr->v,
-             IS_EDGE_SHARP(e2l_curr),
-             BLI_BITMAP_TEST_BOOL(skip_loops, ml_curr_index));
-#endif
+  if (common_data->loop_entries[ml_curr_index] == LOOP_SPLIT_ENTRY_SINGLE) {
+    data.lnor = &common_data->loopnors[ml_curr_index];
+  }
+  else {
+    data.ml_prev_index = ml_prev_index;
+    data.e2l_prev = common_data->edge_to_loops[data.ml_prev->e]; /* Also tag as 'fan' task. */
 
-      /* A smooth edge, we have to check for cyclic smooth fan case.
-       * If we find a new, never-processed cyclic smooth fan, we can do it now using that loop/edge
-       * as 'entry point', otherwise we can skip it. */
-
-      /* Note: In theory, we could make loop_split_generator_check_cyclic_smooth_fan() store
-       * mlfan_vert_index'es and edge indexes in two stacks, to avoid having to fan again around
-       * the vert during actual computation of clnor & clnorspace. However, this would complicate
-       * the code, add more memory usage, and despite its logical complexity,
-       * loop_manifold_fan_around_vert_next() is quite cheap in term of CPU cycles,
-       * so really think it's not worth it. */
-      if (!IS_EDGE_SHARP(e2l_curr) && (BLI_BITMAP_TEST(skip_loops, ml_curr_index) ||
-                                       !loop_split_generator_check_cyclic_smooth_fan(mloops,
-                                                                                     mpolys,
-                                                                                     edge_to_loops,
-                                                                                     loop_to_poly,
-                                                                                     e2l_prev,
-                                                                                     skip_loops,
-                                                                                     ml_curr,
-                                                                                     ml_prev,
-                                                                                     ml_curr_index,
-                                                                                     ml_prev_index,
-                                                                                     mp_index))) {
-        //              printf("SKIPPING!\n");
-      }
-      else {
-        LoopSplitTaskData *data, data_local;
+    if (common_data->lnors_spacearr && tls_data->edge_vectors == NULL) {
+      tls_data->edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
+    }
+  }
 
-        //              printf("PROCESSING!\n");
+  loop_split_worker_do(common_data, &data, tls_data->edge_vectors);
+}
 
-        if (pool) {
-          if (data_idx == 0) {
-            data_buff = MEM_calloc_arrayN(
-                LOOP_SPLIT_TASK_BLOCK_SIZE, sizeof(*data_buff), __func__);
-          }
-          data = &data_buff[data_idx];
-        }
-        else {
-          data = &data_local;
-          memset(data, 0, sizeof(*data));
-        }
+static void loop_split_fan_free(const void *__restrict UNUSED(userdata), void *__restrict chunk)
+{
+  LoopSplitTLS *tls_data = chunk;
+  if (tls_data->edge_vectors) {
+    BLI_stack_free(tls_data->edge_vectors);
+  }
+}
 
-        if (IS_EDGE_SHARP(e2l_curr) && IS_EDGE_SHARP(e2l_prev)) {
-          data->lnor = lnors;
-          data->ml_curr = ml_curr;
-          data->ml_prev = ml_prev;
-          data->ml_curr_index = ml_curr_index;
-#if 0 /* Not needed for 'single' loop. */
-          data->ml_prev_index = ml_prev_index;
-          data->e2l_prev = NULL; /* Tag as 'single' task. */
-#endif
-          data->mp_index = mp_index;
-          if (lnors_spacearr) {
-            data->lnor_space = BKE_lnor_space_create(lnors_spacearr);
-          }
-        }
-        /* We *do not need* to check/tag loops as already computed!
-         * Due to the fact a loop only links to one of its two edges,
-         * a same fan *will never be walked more than once!*
-         * Since we consider edges having neighbor polys with inverted
-         * (flipped) normals as sharp, we are sure that no fan will be skipped,
-         * even only considering the case (sharp curr_edge, smooth prev_edge),
-         * and not the alternative (smooth curr_edge, sharp prev_edge).
-         * All this due/thanks to link between normals and loop ordering (i.e. winding).
-         */
-        else {
-#if 0 /* Not needed for 'fan' loops. */
-          data->lnor = lnors;
+/**
+ * Compute the normals of all smooth fans.
+ *
+ * This is done in three data-parallel steps: edges sharpness (see #mesh_edges_sharp_tag),
+ * then finding the loop from which each fan is walked, then walking all fans.
+ * Only the (cheap) gathering of fan entry points in between is done serially,
+ * since lnor spaces are allocated from a memarena, which is not thread-safe.
+ */
+static void loop_split_fans_compute(LoopSplitTaskDataCommon *common_data)
+{
+  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
+  const MPoly *mpolys = common_data->mpolys;
+  const int numLoops = common_data->numLoops;
+  const int numPolys = common_data->numPolys;
+
+#ifdef DEBUG_TIME
+  TIMEIT_START_AVERAGED(loop_split_fans_compute);
 #endif
-          data->ml_curr = ml_curr;
-          data->ml_prev = ml_prev;
-          data->ml_curr_index = ml_curr_index;
-          data->ml_prev_index = ml_prev_index;
-          data->e2l_prev = e2l_prev; /* Also tag as 'fan' task. */
-          data->mp_index = mp_index;
-          if (lnors_spacearr) {
-            data->lnor_space = BKE_lnor_space_create(lnors_spacearr);
-          }
-        }
 
-        if (pool) {
-          data_idx++;
-          if (data_idx == LOOP_SPLIT_TASK_BLOCK_SIZE) {
-            BLI_task_pool_push(pool, loop_split_worker, data_buff, true, NULL);
-            data_idx = 0;
-          }
-        }
-        else {
-          loop_split_worker_do(common_data, data, edge_vectors);
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  /* Not enough loops to be worth the whole threading overhead... */
+  settings.use_threading = (numLoops >= LOOP_SPLIT_TASK_BLOCK_SIZE * 8);
+
+  char *loop_entries = MEM_malloc_arrayN((size_t)numLoops, sizeof(*loop_entries), __func__);
+  common_data->loop_entries = loop_entries;
+  int *loop_fan_claims = MEM_malloc_arrayN((size_t)numLoops, sizeof(*loop_fan_claims), __func__);
+  copy_vn_i(loop_fan_claims, numLoops, -1);
+  common_data->loop_fan_claims = loop_fan_claims;
+
+  settings.min_iter_per_thread = LOOP_SPLIT_TASK_BLOCK_SIZE / 4;
+  BLI_task_parallel_range(0, numPolys, common_data, loop_split_entries_cb, &settings);
+
+  MEM_freeN(loop_fan_claims);
+  common_data->loop_fan_claims = NULL;
+
+  /* Gather fan entry points, in the same order as polygons and their loops. */
+  int fans_num = 0;
+  for (int ml_index = 0; ml_index < numLoops; ml_index++) {
+    if (loop_entries[ml_index] != LOOP_SPLIT_ENTRY_NONE) {
+      fans_num++;
+    }
+  }
+  int *fan_entries = MEM_malloc_arrayN((size_t)fans_num, sizeof(*fan_entries), __func__);
+  {
+    const MPoly *mp;
+    int mp_index, fan_index = 0;
+    for (mp = mpolys, mp_index = 0; mp_index < numPolys; mp++, mp_index++) {
+      const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+      for (int ml_index = mp->loopstart; ml_index <= ml_last_index; ml_index++) {
+        if (loop_entries[ml_index] != LOOP_SPLIT_ENTRY_NONE) {
+          fan_entries[fan_index++] = ml_index;
         }
       }
-
-      ml_prev = ml_curr;
-      ml_prev_index = ml_curr_index;
     }
+    BLI_assert(fan_index == fans_num);
   }
+  common_data->fan_entries = fan_entries;
 
-  /* Last block of data... Since it is calloc'ed and we use first NULL item as stopper,
-   * everything is fine. */
-  if (pool && data_idx) {
-    BLI_task_pool_push(pool, loop_split_worker, data_buff, true, NULL);
+  if (lnors_spacearr) {
+    /* Equivalent to calling #BKE_lnor_space_create for each fan, with a single allocation. */
+    common_data->lnor_spaces = BLI_memarena_calloc(lnors_spacearr->mem,
+                                                   sizeof(MLoopNorSpace) * (size_t)fans_num);
+    lnors_spacearr->num_spaces += fans_num;
   }
 
-  if (edge_vectors) {
-    BLI_stack_free(edge_vectors);
-  }
-  MEM_freeN(skip_loops);
+  LoopSplitTLS tls_data = {NULL};
+  settings.min_iter_per_thread = LOOP_SPLIT_TASK_BLOCK_SIZE / 4;
+  settings.userdata_chunk = &tls_data;
+  settings.userdata_chunk_size = sizeof(tls_data);
+  settings.func_free = loop_split_fan_free;
+  BLI_task_parallel_range(0, fans_num, common_data, loop_split_fan_cb, &settings);
+
+  MEM_freeN(loop_entries);
+  MEM_freeN(fan_entries);
+  common_data->loop_entries = NULL;
+  common_data->fan_entries = NULL;
+  common_data->lnor_spaces = NULL;
 
 #ifdef DEBUG_TIME
-  TIMEIT_END_AVERAGED(loop_split_generator);
+  TIMEIT_END_AVERAGED(loop_split_fans_compute);
 #endif
 }
 
@@ -1600,7 +1846,7 @@ static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common
  * (splitting edges).
  */
 void BKE_mesh_normals_loop_split(const MVert *mverts,
-                                 const int UNUSED(numVerts),
+                                 const int numVerts,
                                  MEdge *medges,
                                  const int numEdges,
                                  MLoop *mloops,
@@ -1614,6 +1860,47 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
                                  MLoopNorSpaceArray *r_lnors_spacearr,
                                  short (*clnors_data)[2],
                                  int *r_loop_to_poly)
+{
+  BKE_mesh_normals_loop_split_ex(mverts,
+                                 numVerts,
+                                 medges,
+                                 numEdges,
+                                 mloops,
+                                 r_loopnors,
+                                 numLoops,
+                                 mpolys,
+                                 polynors,
+                                 numPolys,
+                                 use_split_normals,
+                                 split_angle,
+                                 r_lnors_spacearr,
+                                 clnors_data,
+                                 r_loop_to_poly,
+                                 NULL);
+}
+
+/**
+ * \param cache_p: When not NULL, topology data is re-used from and stored into this cache.
+ * The caller is responsible for freeing it with #BKE_mesh_loop_split_cache_free.
+ * It is validated against a hash of the loops and polygons topology, so it can be passed for any
+ * mesh, it is rebuilt when it does not match.
+ */
+void BKE_mesh_normals_loop_split_ex(const MVert *mverts,
+                                    const int UNUSED(numVerts),
+                                    MEdge *medges,
+                                    const int numEdges,
+                                    MLoop *mloops,
+                                    float (*r_loopnors)[3],
+                                    const int numLoops,
+                                    MPoly *mpolys,
+                                    const float (*polynors)[3],
+                                    const int numPolys,
+                                    const bool use_split_normals,
+                                    const float split_angle,
+                                    MLoopNorSpaceArray *r_lnors_spacearr,
+                                    short (*clnors_data)[2],
+                                    int *r_loop_to_poly,
+                                    MLoopSplitCache **cache_p)
 {
   /* For now this is not supported.
    * If we do not use split normals, we do not generate anything fancy! */
@@ -1650,6 +1937,25 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
     return;
   }
 
+#ifdef DEBUG_TIME
+  TIMEIT_START_AVERAGED(BKE_mesh_normals_loop_split);
+#endif
+
+  MLoopSplitCache *cache = cache_p ? *cache_p : NULL;
+  const uint topology_hash = (cache_p != NULL) ? loop_split_cache_topology_hash(
+                                                    mloops, mpolys, numLoops, numPolys) :
+                                                0;
+  if (cache && !loop_split_cache_is_valid(cache, topology_hash, numEdges, numLoops, numPolys)) {
+    BKE_mesh_loop_split_cache_free(cache);
+    cache = NULL;
+  }
+  if (cache == NULL) {
+    cache = loop_split_cache_create(mloops, mpolys, topology_hash, numEdges, numLoops, numPolys);
+    if (cache_p) {
+      *cache_p = cache;
+    }
+  }
+
   /**
    * Mapping edge -> loops.
    * If that edge is used by more than two loops (polys),
@@ -1664,25 +1970,30 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
    * However, if needed, we can store the negated value of loop index instead of INDEX_INVALID
    * to retrieve the real value later in code).
    * Note also that lose edges always have both values set to 0! */
-  int(*edge_to_loops)[2] = MEM_calloc_arrayN((size_t)numEdges, sizeof(*edge_to_loops), __func__);
+  int(*edge_to_loops)[2] = MEM_malloc_arrayN((size_t)numEdges, sizeof(*edge_to_loops), __func__);
 
   /* Simple mapping from a loop to its polygon index. */
-  int *loop_to_poly = r_loop_to_poly ?
-                          r_loop_to_poly :
-                          MEM_malloc_arrayN((size_t)numLoops, sizeof(*loop_to_poly), __func__);
+  if (r_loop_to_poly) {
+    memcpy(r_loop_to_poly, cache->loop_to_poly, sizeof(*r_loop_to_poly) * (size_t)numLoops);
+  }
 
   /* When using custom loop normals, disable the angle feature! */
   const bool check_angle = (split_angle < (float)M_PI) && (clnors_data == NULL);
 
   MLoopNorSpaceArray _lnors_spacearr = {NULL};
 
-#ifdef DEBUG_TIME
-  TIMEIT_START_AVERAGED(BKE_mesh_normals_loop_split);
-#endif
-
   if (!r_lnors_spacearr && clnors_data) {
-    /* We need to compute lnor spacearr if some custom lnor data are given to us! */
-    r_lnors_spacearr = &_lnors_spacearr;
+    /* We need to compute lnor spacearr if some custom lnor data are given to us!
+     * When caching, its memory is kept for next evaluation. */
+    if (cache_p) {
+      r_lnors_spacearr = &cache->lnors_spacearr;
+      if (r_lnors_spacearr->mem != NULL) {
+        BKE_lnor_spacearr_clear(r_lnors_spacearr);
+      }
+    }
+    else {
+      r_lnors_spacearr = &_lnors_spacearr;
+    }
   }
   if (r_lnors_spacearr) {
     BKE_lnor_spacearr_init(r_lnors_spacearr, numLoops, MLNOR_SPACEARR_LOOP_INDEX);
@@ -1693,45 +2004,35 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
       .lnors_spacearr = r_lnors_spacearr,
       .loopnors = r_loopnors,
       .clnors_data = clnors_data,
+      .edge_to_loops = edge_to_loops,
       .mverts = mverts,
       .medges = medges,
       .mloops = mloops,
       .mpolys = mpolys,
-      .edge_to_loops = edge_to_loops,
-      .loop_to_poly = loop_to_poly,
+      .edge_loops = (const int(*)[2])cache->edge_loops,
+      .edge_nonmanifold = cache->edge_nonmanifold,
+      .loop_to_poly = cache->loop_to_poly,
       .polynors = polynors,
       .numEdges = numEdges,
       .numLoops = numLoops,
       .numPolys = numPolys,
   };
 
-  /* This first loop check which edges are actually smooth, and compute edge vectors. */
+  /* This first loop check which edges are actually smooth. */
   mesh_edges_sharp_tag(&common_data, check_angle, split_angle, false);
 
-  if (numLoops < LOOP_SPLIT_TASK_BLOCK_SIZE * 8) {
-    /* Not enough loops to be worth the whole threading overhead... */
-    loop_split_generator(NULL, &common_data);
-  }
-  else {
-    TaskPool *task_pool = BLI_task_pool_create(&common_data, TASK_PRIORITY_HIGH);
-
-    loop_split_generator(task_pool, &common_data);
-
-    BLI_task_pool_work_and_wait(task_pool);
-
-    BLI_task_pool_free(task_pool);
-  }
+  loop_split_fans_compute(&common_data);
 
   MEM_freeN(edge_to_loops);
-  if (!r_loop_to_poly) {
-    MEM_freeN(loop_to_poly);
-  }
 
   if (r_lnors_spacearr) {
     if (r_lnors_spacearr == &_lnors_spacearr) {
       BKE_lnor_spacearr_free(r_lnors_spacearr);
     }
   }
+  if (cache_p == NULL) {
+    BKE_mesh_loop_split_cache_free(cache);
+  }
 
 #ifdef DEBUG_TIME
   TIMEIT_END_AVERAGED(BKE_mesh_normals_loop_split);
@@ -0,0 +1,440 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <cstring>
+#include <vector>
+
+#include "BKE_mesh.h"
+
+#include "BLI_math.h"
+
+#include "DNA_meshdata_types.h"
+
+namespace blender::bke::tests {
+
+/* Epsilon for floating point comparisons. */
+static const float EPSILON = 1e-6f;
+
+/* Unit cube with outward facing quads, plus one loose vertex. */
+static const float cube_coords[9][3] = {
+    {-1.0f, -1.0f, -1.0f},
+    {-1.0f, -1.0f, 1.0f},
+    {-1.0f, 1.0f, -1.0f},
+    {-1.0f, 1.0f, 1.0f},
+    {1.0f, -1.0f, -1.0f},
+    {1.0f, -1.0f, 1.0f},
+    {1.0f, 1.0f, -1.0f},
+    {1.0f, 1.0f, 1.0f},
+    {0.0f, 0.0f, 3.0f},
+};
+static const int cube_quads[6][4] = {
+    {0, 1, 3, 2},
+    {2, 3, 7, 6},
+    {6, 7, 5, 4},
+    {4, 5, 1, 0},
+    {2, 6, 4, 0},
+    {7, 3, 1, 5},
+};
+
+struct CubeMesh {
+  MVert mverts[9] = {{{0}}};
+  MEdge medges[12] = {{0}};
+  MLoop mloop[24] = {{0}};
+  MPoly mpolys[6] = {{0}};
+  int totedge = 0;
+
+  CubeMesh()
+  {
+    for (int i = 0; i < 9; i++) {
+      copy_v3_v3(mverts[i].co, cube_coords[i]);
+    }
+    for (int i = 0; i < 6; i++) {
+      mpolys[i].loopstart = i * 4;
+      mpolys[i].totloop = 4;
+      mpolys[i].flag = ME_SMOOTH;
+      for (int j = 0; j < 4; j++) {
+        mloop[i * 4 + j].v = cube_quads[i][j];
+        mloop[i * 4 + j].e = edge_ensure(cube_quads[i][j], cube_quads[i][(j + 1) % 4]);
+      }
+    }
+  }
+
+  uint edge_ensure(const uint v1, const uint v2)
+  {
+    for (int i = 0; i < totedge; i++) {
+      if ((medges[i].v1 == v1 && medges[i].v2 == v2) ||
+          (medges[i].v1 == v2 && medges[i].v2 == v1)) {
+        return i;
+      }
+    }
+    medges[totedge].v1 = v1;
+    medges[totedge].v2 = v2;
+    return totedge++;
+  }
+};
+
+TEST(mesh_calc_normals_poly, Cube)
+{
+  CubeMesh cube;
+  MVert *mverts = cube.mverts;
+  float vert_normals[9][3];
+  float poly_normals[6][3];
+
+  BKE_mesh_calc_normals_poly(
+      mverts, vert_normals, 9, cube.mloop, cube.mpolys, 24, 6, poly_normals, false);
+
+  for (int i = 0; i < 6; i++) {
+    EXPECT_NEAR(len_v3(poly_normals[i]), 1.0f, EPSILON);
+  }
+
+  /* Corner normals point away from the center. */
+  for (int i = 0; i < 8; i++) {
+    float expected[3];
+    normalize_v3_v3(expected, cube_coords[i]);
+    EXPECT_NEAR(vert_normals[i][0], expected[0], EPSILON);
+    EXPECT_NEAR(vert_normals[i][1], expected[1], EPSILON);
+    EXPECT_NEAR(vert_normals[i][2], expected[2], EPSILON);
+
+    float no_short[3];
+    normal_short_to_float_v3(no_short, mverts[i].no);
+    EXPECT_NEAR(dot_v3v3(no_short, expected), 1.0f, 1e-4f);
+  }
+
+  /* Loose vertices use their coordinate as normal. */
+  EXPECT_NEAR(vert_normals[8][0], 0.0f, EPSILON);
+  EXPECT_NEAR(vert_normals[8][1], 0.0f, EPSILON);
+  EXPECT_NEAR(vert_normals[8][2], 1.0f, EPSILON);
+}
+
+/* Grid of quads with a wave displacement, so that vertex normals differ. */
+struct GridMesh {
+  std::vector<MVert> mverts;
+  std::vector<MLoop> mloop;
+  std::vector<MPoly> mpolys;
+
+  GridMesh(const int size)
+  {
+    mverts.resize(size * size, MVert{{0}});
+    for (int y = 0; y < size; y++) {
+      for (int x = 0; x < size; x++) {
+        MVert &mv = mverts[y * size + x];
+        mv.co[0] = (float)x;
+        mv.co[1] = (float)y;
+        mv.co[2] = sinf((float)x * 0.3f) * cosf((float)y * 0.2f);
+      }
+    }
+    for (int y = 0; y < size - 1; y++) {
+      for (int x = 0; x < size - 1; x++) {
+        MPoly mp = {0};
+        mp.loopstart = (int)mloop.size();
+        mp.totloop = 4;
+        mpolys.push_back(mp);
+        const int quad[4] = {
+            y * size + x, y * size + x + 1, (y + 1) * size + x + 1, (y + 1) * size + x};
+        for (int j = 0; j < 4; j++) {
+          MLoop ml = {0};
+          ml.v = (uint)quad[j];
+          mloop.push_back(ml);
+        }
+      }
+    }
+  }
+
+  void calc_normals(float (*r_vert_normals)[3])
+  {
+    std::vector<float> poly_normals(mpolys.size() * 3);
+    BKE_mesh_calc_normals_poly(mverts.data(),
+                               r_vert_normals,
+                               (int)mverts.size(),
+                               mloop.data(),
+                               mpolys.data(),
+                               (int)mloop.size(),
+                               (int)mpolys.size(),
+                               (float(*)[3])poly_normals.data(),
+                               false);
+  }
+};
+
+/* Large enough for the adjacency and the vertex normals to be calculated in parallel. */
+TEST(mesh_calc_normals_poly, GridThreaded)
+{
+  GridMesh grid(128);
+  const int verts_num = (int)grid.mverts.size();
+  std::vector<float> vert_normals(verts_num * 3);
+  std::vector<float> vert_normals_ref(verts_num * 3, 0.0f);
+
+  /* Serial accumulation of the angle weighted face normals. */
+  for (const MPoly &mp : grid.mpolys) {
+    const MLoop *ml = &grid.mloop[mp.loopstart];
+    float poly_normal[3];
+    BKE_mesh_calc_poly_normal(&mp, ml, grid.mverts.data(), poly_normal);
+    float *vertnos[4];
+    const float *vertcos[4];
+    float vdiffs[4][3];
+    for (int j = 0; j < 4; j++) {
+      vertnos[j] = &vert_normals_ref[ml[j].v * 3];
+      vertcos[j] = grid.mverts[ml[j].v].co;
+    }
+    accumulate_vertex_normals_poly_v3(vertnos, poly_normal, vertcos, vdiffs, 4);
+  }
+
+  grid.calc_normals((float(*)[3])vert_normals.data());
+  for (int i = 0; i < verts_num; i++) {
+    float *expected = &vert_normals_ref[i * 3];
+    normalize_v3(expected);
+    EXPECT_NEAR(vert_normals[i * 3 + 0], expected[0], EPSILON);
+    EXPECT_NEAR(vert_normals[i * 3 + 1], expected[1], EPSILON);
+    EXPECT_NEAR(vert_normals[i * 3 + 2], expected[2], EPSILON);
+  }
+
+  /* Loops are summed in the same order regardless of threading, results are bit-exact. */
+  std::vector<float> vert_normals_again(verts_num * 3);
+  grid.calc_normals((float(*)[3])vert_normals_again.data());
+  EXPECT_EQ(memcmp(vert_normals.data(), vert_normals_again.data(), sizeof(float) * 3 * verts_num),
+            0);
+}
+
+static void cube_loop_normals_calc(CubeMesh &cube,
+                                   const float split_angle,
+                                   short (*clnors)[2],
+                                   MLoopSplitCache **cache_p,
+                                   float r_loop_normals[24][3])
+{
+  float poly_normals[6][3];
+  BKE_mesh_calc_normals_poly(
+      cube.mverts, nullptr, 9, cube.mloop, cube.mpolys, 24, 6, poly_normals, false);
+  BKE_mesh_normals_loop_split_ex(cube.mverts,
+                                 9,
+                                 cube.medges,
+                                 12,
+                                 cube.mloop,
+                                 r_loop_normals,
+                                 24,
+                                 cube.mpolys,
+                                 poly_normals,
+                                 6,
+                                 true,
+                                 split_angle,
+                                 nullptr,
+                                 clnors,
+                                 nullptr,
+                                 cache_p);
+}
+
+TEST(mesh_normals_loop_split, SharpCube)
+{
+  CubeMesh cube;
+  float loop_normals[24][3];
+  cube_loop_normals_calc(cube, DEG2RADF(30.0f), nullptr, nullptr, loop_normals);
+
+  /* All edges are sharp, loops use the normal of their face. */
+  for (int i = 0; i < 24; i++) {
+    float expected[3];
+    BKE_mesh_calc_poly_normal(&cube.mpolys[i / 4], &cube.mloop[i / 4 * 4], cube.mverts, expected);
+    EXPECT_NEAR(dot_v3v3(loop_normals[i], expected), 1.0f, EPSILON);
+  }
+}
+
+TEST(mesh_normals_loop_split, SmoothCube)
+{
+  CubeMesh cube;
+  float loop_normals[24][3];
+  cube_loop_normals_calc(cube, (float)M_PI, nullptr, nullptr, loop_normals);
+
+  /* All edges are smooth (cyclic fans around each vertex), loops use the vertex normal. */
+  for (int i = 0; i < 24; i++) {
+    float expected[3];
+    normalize_v3_v3(expected, cube_coords[cube.mloop[i].v]);
+    EXPECT_NEAR(dot_v3v3(loop_normals[i], expected), 1.0f, EPSILON);
+  }
+}
+
+TEST(mesh_normals_loop_split, CachedCustomNormals)
+{
+  CubeMesh cube;
+  /* One sharp edge, so there are both cyclic and non-cyclic fans. */
+  cube.medges[0].flag |= ME_SHARP;
+
+  short clnors[24][2] = {{0}};
+  float loop_normals_ref[24][3], loop_normals[24][3];
+  cube_loop_normals_calc(cube, (float)M_PI, clnors, nullptr, loop_normals_ref);
+
+  MLoopSplitCache *cache = nullptr;
+  for (int iter = 0; iter < 2; iter++) {
+    cube_loop_normals_calc(cube, (float)M_PI, clnors, &cache, loop_normals);
+    EXPECT_NE(cache, nullptr);
+    for (int i = 0; i < 24; i++) {
+      EXPECT_NEAR(loop_normals[i][0], loop_normals_ref[i][0], EPSILON);
+      EXPECT_NEAR(loop_normals[i][1], loop_normals_ref[i][1], EPSILON);
+      EXPECT_NEAR(loop_normals[i][2], loop_normals_ref[i][2], EPSILON);
+    }
+  }
+
+  /* Only vertex positions change, the cache is re-used. */
+  MLoopSplitCache *cache_prev = cache;
+  mul_v3_fl(cube.mverts[7].co, 2.0f);
+  cube_loop_normals_calc(cube, (float)M_PI, clnors, nullptr, loop_normals_ref);
+  cube_loop_normals_calc(cube, (float)M_PI, clnors, &cache, loop_normals);
+  EXPECT_EQ(cache, cache_prev);
+  for (int i = 0; i < 24; i++) {
+    EXPECT_NEAR(loop_normals[i][0], loop_normals_ref[i][0], EPSILON);
+    EXPECT_NEAR(loop_normals[i][1], loop_normals_ref[i][1], EPSILON);
+    EXPECT_NEAR(loop_normals[i][2], loop_normals_ref[i][2], EPSILON);
+  }
+
+  /* Loops are edited in-place, flipping the first face. Arrays and counts stay the same, the cache
+   * must not be used for the new topology. */
+  MLoop loops_prev[4];
+  memcpy(loops_prev, cube.mloop, sizeof(loops_prev));
+  for (int j = 0; j < 4; j++) {
+    cube.mloop[j].v = loops_prev[(4 - j) % 4].v;
+    cube.mloop[j].e = loops_prev[3 - j].e;
+  }
+  cube_loop_normals_calc(cube, (float)M_PI, clnors, nullptr, loop_normals_ref);
+  cube_loop_normals_calc(cube, (float)M_PI, clnors, &cache, loop_normals);
+  for (int i = 0; i < 24; i++) {
+    EXPECT_NEAR(loop_normals[i][0], loop_normals_ref[i][0], EPSILON);
+    EXPECT_NEAR(loop_normals[i][1], loop_normals_ref[i][1], EPSILON);
+    EXPECT_NEAR(loop_normals[i][2], loop_normals_ref[i][2], EPSILON);
+  }
+
+  BKE_mesh_loop_split_cache_free(cache);
+}
+
+
+/* Two pyramids on a ring of vertices, all faces smooth. Every vertex has one cyclic fan, the
+ * apexes have a very high valence. */
+struct BipyramidMesh {
+  std::vector<MVert> mverts;
+  std::vector<MEdge> medges;
+  std::vector<MLoop> mloop;
+  std::vector<MPoly> mpolys;
+
+  BipyramidMesh(const int ring_size)
+  {
+    const int top = ring_size, bottom = ring_size + 1;
+    mverts.resize(ring_size + 2, MVert{{0}});
+    for (int i = 0; i < ring_size; i++) {
+      const float angle = 2.0f * (float)M_PI * i / ring_size;
+      mverts[i].co[0] = cosf(angle);
+      mverts[i].co[1] = sinf(angle);
+    }
+    mverts[top].co[2] = 1.0f;
+    mverts[bottom].co[2] = -1.0f;
+
+    /* Ring edges, then edges to the top, then edges to the bottom. */
+    medges.resize(ring_size * 3, MEdge{0});
+    for (int i = 0; i < ring_size; i++) {
+      medges[i].v1 = i;
+      medges[i].v2 = (i + 1) % ring_size;
+      medges[ring_size + i].v1 = i;
+      medges[ring_size + i].v2 = top;
+      medges[ring_size * 2 + i].v1 = i;
+      medges[ring_size * 2 + i].v2 = bottom;
+    }
+
+    for (int i = 0; i < ring_size; i++) {
+      const int next = (i + 1) % ring_size;
+      const int top_tri[3][2] = {{i, i}, {next, ring_size + next}, {top, ring_size + i}};
+      const int bottom_tri[3][2] = {
+          {next, i}, {i, ring_size * 2 + i}, {bottom, ring_size * 2 + next}};
+      tri_add(top_tri);
+      tri_add(bottom_tri);
+    }
+  }
+
+  /* Vertex and edge of every corner. */
+  void tri_add(const int corners[3][2])
+  {
+    MPoly mp = {0};
+    mp.loopstart = (int)mloop.size();
+    mp.totloop = 3;
+    mp.flag = ME_SMOOTH;
+    mpolys.push_back(mp);
+    for (int j = 0; j < 3; j++) {
+      MLoop ml = {0};
+      ml.v = (uint)corners[j][0];
+      ml.e = (uint)corners[j][1];
+      mloop.push_back(ml);
+    }
+  }
+};
+
+/* Large enough for the fan entries to be found in parallel, every fan must be walked exactly
+ * once. */
+TEST(mesh_normals_loop_split, HighValenceFans)
+{
+  const int ring_size = 4096;
+  BipyramidMesh mesh(ring_size);
+  const int verts_num = (int)mesh.mverts.size();
+  const int loops_num = (int)mesh.mloop.size();
+  const int polys_num = (int)mesh.mpolys.size();
+
+  std::vector<float> poly_normals(polys_num * 3), loop_normals(loops_num * 3);
+  BKE_mesh_calc_normals_poly(mesh.mverts.data(),
+                             nullptr,
+                             verts_num,
+                             mesh.mloop.data(),
+                             mesh.mpolys.data(),
+                             loops_num,
+                             polys_num,
+                             (float(*)[3])poly_normals.data(),
+                             false);
+  MLoopNorSpaceArray lnors_spacearr = {nullptr};
+  BKE_mesh_normals_loop_split_ex(mesh.mverts.data(),
+                                 verts_num,
+                                 mesh.medges.data(),
+                                 (int)mesh.medges.size(),
+                                 mesh.mloop.data(),
+                                 (float(*)[3])loop_normals.data(),
+                                 loops_num,
+                                 mesh.mpolys.data(),
+                                 (const float(*)[3])poly_normals.data(),
+                                 polys_num,
+                                 true,
+                                 (float)M_PI,
+                                 &lnors_spacearr,
+                                 nullptr,
+                                 nullptr,
+                                 nullptr);
+
+  EXPECT_EQ(lnors_spacearr.num_spaces, verts_num);
+  /* All loops of a vertex are in the space of its fan. */
+  std::vector<MLoopNorSpace *> vert_spaces(verts_num, nullptr);
+  for (int i = 0; i < loops_num; i++) {
+    MLoopNorSpace *lnor_space = lnors_spacearr.lspacearr[i];
+    ASSERT_NE(lnor_space, nullptr);
+    MLoopNorSpace *&vert_space = vert_spaces[mesh.mloop[i].v];
+    if (vert_space == nullptr) {
+      vert_space = lnor_space;
+    }
+    EXPECT_EQ(lnor_space, vert_space);
+  }
+
+  /* The apexes are smooth, their loops use the vertex normal. */
+  for (int i = 0; i < loops_num; i++) {
+    if (mesh.mloop[i].v == (uint)ring_size) {
+      EXPECT_NEAR(loop_normals[i * 3 + 2], 1.0f, EPSILON);
+    }
+  }
+
+  BKE_lnor_spacearr_free(&lnors_spacearr);
+}
+
+}  // namespace blender::bke::tests
@@ -59,7 +59,9 @@ Mesh *BKE_mesh_mirror_bisect_on_mirror_plane(MirrorModifierData *mmd,
   BMVert *v, *v_next;
 
   bm = BKE_mesh_to_bmesh_ex(mesh,
-                            &(struct BMeshCreateParams){0},
+                            &(struct BMeshCreateParams){
+                                .use_eval_only = true,
+                            },
                             &(struct BMeshFromMeshParams){
                                 .calc_face_normal = true,
                                 .cd_mask_extra = {.vmask = CD_MASK_ORIGINDEX,
@@ -115,6 +115,117 @@ static bool mesh_remap_bvhtree_query_raycast(BVHTreeFromMesh *treedata,
   return false;
 }
 
+/**
+ * Batched version of #mesh_remap_bvhtree_query_nearest for all \a verts_dst,
+ * their coordinates in tree space are returned in \a r_cos.
+ */
+static BVHTreeNearest *mesh_remap_bvhtree_query_nearest_verts(
+    BVHTreeFromMesh *treedata,
+    const MVert *verts_dst,
+    const int numverts_dst,
+    const SpaceTransform *space_transform,
+    const float max_dist_sq,
+    float (**r_cos)[3])
+{
+  BVHTreeNearest *nearest = MEM_malloc_arrayN((size_t)numverts_dst, sizeof(*nearest), __func__);
+  float(*cos)[3] = MEM_malloc_arrayN((size_t)numverts_dst, sizeof(*cos), __func__);
+
+  for (int i = 0; i < numverts_dst; i++) {
+    copy_v3_v3(cos[i], verts_dst[i].co);
+
+    /* Convert the vertex to tree coordinates, if needed. */
+    if (space_transform) {
+      BLI_space_transform_apply(space_transform, cos[i]);
+    }
+    nearest[i].index = -1;
+    nearest[i].dist_sq = max_dist_sq;
+  }
+
+  BLI_bvhtree_find_nearest_batch(treedata->tree,
+                                 (const float(*)[3])cos,
+                                 numverts_dst,
+                                 nearest,
+                                 treedata->nearest_callback,
+                                 treedata,
+                                 BVH_NEAREST_USE_THREADING);
+
+  *r_cos = cos;
+  return nearest;
+}
+
+static bool mesh_remap_bvhtree_nearest_is_hit(const BVHTreeNearest *nearest,
+                                              const float max_dist_sq,
+                                              float *r_hit_dist)
+{
+  if ((nearest->index != -1) && (nearest->dist_sq <= max_dist_sq)) {
+    *r_hit_dist = sqrtf(nearest->dist_sq);
+    return true;
+  }
+
+  return false;
+}
+
+/**
+ * Batched version of #mesh_remap_bvhtree_query_raycast along the normals of all \a verts_dst,
+ * their coordinates in tree space are returned in \a r_cos.
+ */
+static BVHTreeRayHit *mesh_remap_bvhtree_query_raycast_verts(
+    BVHTreeFromMesh *treedata,
+    const MVert *verts_dst,
+    const int numverts_dst,
+    const SpaceTransform *space_transform,
+    const float radius,
+    const float max_dist,
+    float (**r_cos)[3])
+{
+  /* Cast in both directions, the first half of the rays along the normals. */
+  BVHTreeRay *rays = MEM_malloc_arrayN((size_t)numverts_dst * 2, sizeof(*rays), __func__);
+  BVHTreeRayHit *rayhits = MEM_malloc_arrayN((size_t)numverts_dst * 2, sizeof(*rayhits), __func__);
+  float(*cos)[3] = MEM_malloc_arrayN((size_t)numverts_dst, sizeof(*cos), __func__);
+
+  for (int i = 0; i < numverts_dst; i++) {
+    BVHTreeRay *ray = &rays[i];
+    BVHTreeRay *ray_inv = &rays[numverts_dst + i];
+
+    copy_v3_v3(cos[i], verts_dst[i].co);
+    normal_short_to_float_v3(ray->direction, verts_dst[i].no);
+
+    /* Convert the vertex to tree coordinates, if needed. */
+    if (space_transform) {
+      BLI_space_transform_apply(space_transform, cos[i]);
+      BLI_space_transform_apply_normal(space_transform, ray->direction);
+    }
+    copy_v3_v3(ray->origin, cos[i]);
+    ray->radius = radius;
+
+    copy_v3_v3(ray_inv->origin, cos[i]);
+    negate_v3_v3(ray_inv->direction, ray->direction);
+    ray_inv->radius = radius;
+  }
+  for (int i = 0; i < numverts_dst * 2; i++) {
+    rayhits[i].index = -1;
+    rayhits[i].dist = max_dist;
+  }
+
+  BLI_bvhtree_ray_cast_batch(treedata->tree,
+                             rays,
+                             numverts_dst * 2,
+                             rayhits,
+                             treedata->raycast_callback,
+                             treedata,
+                             BVH_RAYCAST_DEFAULT | BVH_RAYCAST_USE_THREADING);
+
+  for (int i = 0; i < numverts_dst; i++) {
+    if (rayhits[numverts_dst + i].dist < rayhits[i].dist) {
+      rayhits[i] = rayhits[numverts_dst + i];
+    }
+  }
+
+  MEM_freeN(rays);
+  *r_cos = cos;
+  return rayhits;
+}
+
 /** \} */
 
 /**
@@ -522,26 +633,18 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
   }
   else {
     BVHTreeFromMesh treedata = {NULL};
-    BVHTreeNearest nearest = {0};
-    BVHTreeRayHit rayhit = {0};
+    BVHTreeNearest *nearest_dst = NULL;
+    float(*vcos_dst)[3] = NULL;
     float hit_dist;
-    float tmp_co[3], tmp_no[3];
 
     if (mode == MREMAP_MODE_VERT_NEAREST) {
       BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_VERTS, 2);
-      nearest.index = -1;
+      nearest_dst = mesh_remap_bvhtree_query_nearest_verts(
+          &treedata, verts_dst, numverts_dst, space_transform, max_dist_sq, &vcos_dst);
 
       for (i = 0; i < numverts_dst; i++) {
-        copy_v3_v3(tmp_co, verts_dst[i].co);
-
-        /* Convert the vertex to tree coordinates, if needed. */
-        if (space_transform) {
-          BLI_space_transform_apply(space_transform, tmp_co);
-        }
-
-        if (mesh_remap_bvhtree_query_nearest(
-                &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
-          mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &nearest.index, &full_weight);
+        if (mesh_remap_bvhtree_nearest_is_hit(&nearest_dst[i], max_dist_sq, &hit_dist)) {
+          mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &nearest_dst[i].index, &full_weight);
         }
         else {
           /* No source for this dest vertex! */
@@ -554,19 +657,14 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
       float(*vcos_src)[3] = BKE_mesh_vert_coords_alloc(me_src, NULL);
 
       BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_EDGES, 2);
-      nearest.index = -1;
+      nearest_dst = mesh_remap_bvhtree_query_nearest_verts(
+          &treedata, verts_dst, numverts_dst, space_transform, max_dist_sq, &vcos_dst);
 
       for (i = 0; i < numverts_dst; i++) {
-        copy_v3_v3(tmp_co, verts_dst[i].co);
+        const float *tmp_co = vcos_dst[i];
 
-        /* Convert the vertex to tree coordinates, if needed. */
-        if (space_transform) {
-          BLI_space_transform_apply(space_transform, tmp_co);
-        }
-
-        if (mesh_remap_bvhtree_query_nearest(
-                &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
-          MEdge *me = &edges_src[nearest.index];
+        if (mesh_remap_bvhtree_nearest_is_hit(&nearest_dst[i], max_dist_sq, &hit_dist)) {
+          MEdge *me = &edges_src[nearest_dst[i].index];
           const float *v1cos = vcos_src[me->v1];
           const float *v2cos = vcos_src[me->v2];
 
@@ -615,24 +713,19 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
       BKE_bvhtree_from_mesh_get(&treedata, me_src, BVHTREE_FROM_LOOPTRI, 2);
 
       if (mode == MREMAP_MODE_VERT_POLYINTERP_VNORPROJ) {
-        for (i = 0; i < numverts_dst; i++) {
-          copy_v3_v3(tmp_co, verts_dst[i].co);
-          normal_short_to_float_v3(tmp_no, verts_dst[i].no);
+        BVHTreeRayHit *rayhit_dst = mesh_remap_bvhtree_query_raycast_verts(
+            &treedata, verts_dst, numverts_dst, space_transform, ray_radius, max_dist, &vcos_dst);
 
-          /* Convert the vertex to tree coordinates, if needed. */
-          if (space_transform) {
-            BLI_space_transform_apply(space_transform, tmp_co);
-            BLI_space_transform_apply_normal(space_transform, tmp_no);
-          }
+        for (i = 0; i < numverts_dst; i++) {
+          const BVHTreeRayHit *rayhit = &rayhit_dst[i];
 
-          if (mesh_remap_bvhtree_query_raycast(
-                  &treedata, &rayhit, tmp_co, tmp_no, ray_radius, max_dist, &hit_dist)) {
-            const MLoopTri *lt = &treedata.looptri[rayhit.index];
+          if ((rayhit->index != -1) && (rayhit->dist <= max_dist)) {
+            const MLoopTri *lt = &treedata.looptri[rayhit->index];
             MPoly *mp_src = &polys_src[lt->poly];
             const int sources_num = mesh_remap_interp_poly_data_get(mp_src,
                                                                     loops_src,
                                                                     (const float(*)[3])vcos_src,
-                                                                    rayhit.co,
+                                                                    rayhit->co,
                                                                     &tmp_buff_size,
                                                                     &vcos,
                                                                     false,
@@ -641,28 +734,25 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
                                                                     true,
                                                                     NULL);
 
-            mesh_remap_item_define(r_map, i, hit_dist, 0, sources_num, indices, weights);
+            mesh_remap_item_define(r_map, i, rayhit->dist, 0, sources_num, indices, weights);
           }
           else {
             /* No source for this dest vertex! */
             BKE_mesh_remap_item_define_invalid(r_map, i);
           }
         }
+
+        MEM_freeN(rayhit_dst);
       }
       else {
-        nearest.index = -1;
+        nearest_dst = mesh_remap_bvhtree_query_nearest_verts(
+            &treedata, verts_dst, numverts_dst, space_transform, max_dist_sq, &vcos_dst);
 
         for (i = 0; i < numverts_dst; i++) {
-          copy_v3_v3(tmp_co, verts_dst[i].co);
-
-          /* Convert the vertex to tree coordinates, if needed. */
-          if (space_transform) {
-            BLI_space_transform_apply(space_transform, tmp_co);
-          }
+          const BVHTreeNearest *nearest = &nearest_dst[i];
 
-          if (mesh_remap_bvhtree_query_nearest(
-                  &treedata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
-            const MLoopTri *lt = &treedata.looptri[nearest.index];
+          if (mesh_remap_bvhtree_nearest_is_hit(nearest, max_dist_sq, &hit_dist)) {
+            const MLoopTri *lt = &treedata.looptri[nearest->index];
             MPoly *mp = &polys_src[lt->poly];
 
             if (mode == MREMAP_MODE_VERT_POLY_NEAREST) {
@@ -670,7 +760,7 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
               mesh_remap_interp_poly_data_get(mp,
                                               loops_src,
                                               (const float(*)[3])vcos_src,
-                                              nearest.co,
+                                              nearest->co,
                                               &tmp_buff_size,
                                               &vcos,
                                               false,
@@ -685,7 +775,7 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
               const int sources_num = mesh_remap_interp_poly_data_get(mp,
                                                                       loops_src,
                                                                       (const float(*)[3])vcos_src,
-                                                                      nearest.co,
+                                                                      nearest->co,
                                                                       &tmp_buff_size,
                                                                       &vcos,
                                                                       false,
@@ -714,6 +804,8 @@ void BKE_mesh_remap_calc_verts_from_mesh(const int mode,
       memset(r_map->items, 0, sizeof(*r_map->items) * (size_t)numverts_dst);
     }
 
+    MEM_SAFE_FREE(nearest_dst);
+    MEM_SAFE_FREE(vcos_dst);
     free_bvhtree_from_mesh(&treedata);
   }
 }
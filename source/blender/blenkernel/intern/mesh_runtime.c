@@ -68,6 +68,9 @@ void BKE_mesh_runtime_reset_on_copy(Mesh *mesh, const int UNUSED(flag))
   memset(&runtime->looptris, 0, sizeof(runtime->looptris));
   runtime->bvh_cache = NULL;
   runtime->shrinkwrap_data = NULL;
+  runtime->loop_split_cache = NULL;
+  /* Vertex coordinates may be shared with the source mesh and modified in-place. */
+  runtime->vert_normals_valid = false;
 
   mesh->runtime.eval_mutex = MEM_mallocN(sizeof(ThreadMutex), "mesh runtime eval_mutex");
   BLI_mutex_init(mesh->runtime.eval_mutex);
@@ -240,6 +243,10 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
     mesh->runtime.subdiv_ccg = NULL;
   }
   BKE_shrinkwrap_discard_boundary_data(mesh);
+  if (mesh->runtime.loop_split_cache != NULL) {
+    BKE_mesh_loop_split_cache_free(mesh->runtime.loop_split_cache);
+    mesh->runtime.loop_split_cache = NULL;
+  }
 }
 
 /** \} */
@@ -969,7 +969,11 @@ static void modwrap_dependsOnNormals(Mesh *me)
       break;
     }
     case ME_WRAPPER_TYPE_MDATA:
-      BKE_mesh_calc_normals(me);
+      /* Chains of modifiers depending on normals only calculate them once,
+       * as long as the vertex coordinates don't change in between. */
+      if (!me->runtime.vert_normals_valid) {
+        BKE_mesh_calc_normals(me);
+      }
       break;
   }
 }
@@ -992,7 +996,12 @@ struct Mesh *BKE_modifier_modify_mesh(ModifierData *md,
   if (mti->dependsOnNormals && mti->dependsOnNormals(md)) {
     modwrap_dependsOnNormals(me);
   }
-  return mti->modifyMesh(md, ctx, me);
+  Mesh *result = mti->modifyMesh(md, ctx, me);
+  /* The modifier may have moved vertices in-place without updating the normals. */
+  if (result != NULL) {
+    result->runtime.vert_normals_valid = false;
+  }
+  return result;
 }
 
 void BKE_modifier_deform_verts(ModifierData *md,
@@ -1021,7 +1030,9 @@ void BKE_modifier_deform_vertsEM(ModifierData *md,
   BLI_assert(!me || CustomData_has_layer(&me->pdata, CD_NORMAL) == false);
 
   if (me && mti->dependsOnNormals && mti->dependsOnNormals(md)) {
-    BKE_mesh_calc_normals(me);
+    if (!me->runtime.vert_normals_valid) {
+      BKE_mesh_calc_normals(me);
+    }
   }
   mti->deformVertsEM(md, ctx, em, me, vertexCos, numVerts);
 }
@@ -1348,6 +1348,10 @@ static void sculptsession_free_pbvh(Object *object)
     BKE_pbvh_free(ss->pbvh);
     ss->pbvh = NULL;
   }
+  if (ss->pbvh_prev) {
+    BKE_pbvh_free(ss->pbvh_prev);
+    ss->pbvh_prev = NULL;
+  }
 
   MEM_SAFE_FREE(ss->pmap);
   MEM_SAFE_FREE(ss->pmap_mem);
@@ -1684,8 +1688,16 @@ void BKE_sculpt_update_object_before_eval(Object *ob)
     if (!ss->cache && !ss->filter_cache) {
       /* We free pbvh on changes, except in the middle of drawing a stroke
        * since it can't deal with changing PVBH node organization, we hope
-       * topology does not change in the meantime .. weak. */
+       * topology does not change in the meantime .. weak.
+       * A regular mesh PBVH is kept so it can be updated in place when the
+       * topology did not change, see #build_pbvh_from_regular_mesh. */
+      PBVH *pbvh_prev = NULL;
+      if (ss->pbvh && BKE_pbvh_type(ss->pbvh) == PBVH_FACES) {
+        pbvh_prev = ss->pbvh;
+        ss->pbvh = NULL;
+      }
       sculptsession_free_pbvh(ob);
+      ss->pbvh_prev = pbvh_prev;
 
       BKE_sculptsession_free_deformMats(ob->sculpt);
 
@@ -1982,10 +1994,9 @@ static PBVH *build_pbvh_for_dynamic_topology(Object *ob)
 
 static PBVH *build_pbvh_from_regular_mesh(Object *ob, Mesh *me_eval_deform, bool respect_hide)
 {
+  SculptSession *ss = ob->sculpt;
   Mesh *me = BKE_object_get_original_mesh(ob);
   const int looptris_num = poly_to_tri_count(me->totpoly, me->totloop);
-  PBVH *pbvh = BKE_pbvh_new();
-  BKE_pbvh_respect_hide_set(pbvh, respect_hide);
 
   MLoopTri *looptri = MEM_malloc_arrayN(looptris_num, sizeof(*looptri), __func__);
 
@@ -1993,20 +2004,45 @@ static PBVH *build_pbvh_from_regular_mesh(Object *ob, Mesh *me_eval_deform, bool
 
   BKE_sculpt_sync_face_set_visibility(me, NULL);
 
-  BKE_pbvh_build_mesh(pbvh,
-                      me,
-                      me->mpoly,
-                      me->mloop,
-                      me->mvert,
-                      me->totvert,
-                      &me->vdata,
-                      &me->ldata,
-                      &me->pdata,
-                      looptri,
-                      looptris_num);
+  /* Reuse the nodes of the previous PBVH when only coordinates or attributes changed. */
+  PBVH *pbvh = ss->pbvh_prev;
+  ss->pbvh_prev = NULL;
+  if (pbvh != NULL) {
+    BKE_pbvh_respect_hide_set(pbvh, respect_hide);
+    if (!BKE_pbvh_mesh_update(pbvh,
+                              me,
+                              me->mpoly,
+                              me->mloop,
+                              me->mvert,
+                              me->totvert,
+                              &me->vdata,
+                              &me->ldata,
+                              &me->pdata,
+                              looptri,
+                              looptris_num)) {
+      BKE_pbvh_free(pbvh);
+      pbvh = NULL;
+    }
+  }
 
-  pbvh_show_mask_set(pbvh, ob->sculpt->show_mask);
-  pbvh_show_face_sets_set(pbvh, ob->sculpt->show_face_sets);
+  if (pbvh == NULL) {
+    pbvh = BKE_pbvh_new();
+    BKE_pbvh_respect_hide_set(pbvh, respect_hide);
+    BKE_pbvh_build_mesh(pbvh,
+                        me,
+                        me->mpoly,
+                        me->mloop,
+                        me->mvert,
+                        me->totvert,
+                        &me->vdata,
+                        &me->ldata,
+                        &me->pdata,
+                        looptri,
+                        looptris_num);
+  }
+
+  pbvh_show_mask_set(pbvh, ss->show_mask);
+  pbvh_show_face_sets_set(pbvh, ss->show_face_sets);
 
   const bool is_deformed = check_sculpt_object_deformed(ob, true);
   if (is_deformed && me_eval_deform != NULL) {
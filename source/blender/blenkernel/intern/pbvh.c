@@ -253,15 +253,14 @@ void pbvh_grow_nodes(PBVH *pbvh, int totnode)
 /* Add a vertex to the map, with a positive value for unique vertices and
  * a negative value for additional vertices */
 static int map_insert_vert(
-    PBVH *pbvh, GHash *map, unsigned int *face_verts, unsigned int *uniq_verts, int vertex)
+    GHash *map, unsigned int *face_verts, unsigned int *uniq_verts, int vertex, bool is_unique)
 {
   void *key, **value_p;
 
   key = POINTER_FROM_INT(vertex);
   if (!BLI_ghash_ensure_p(map, key, &value_p)) {
     int value_i;
-    if (BLI_BITMAP_TEST(pbvh->vert_bitmap, vertex) == 0) {
-      BLI_BITMAP_ENABLE(pbvh->vert_bitmap, vertex);
+    if (is_unique) {
       value_i = *uniq_verts;
       (*uniq_verts)++;
     }
@@ -276,8 +275,28 @@ static int map_insert_vert(
   return POINTER_AS_INT(*value_p);
 }
 
+/* Vertices are unique in the leaf with the lowest node index that uses them. This doesn't depend
+ * on the order in which leafs are processed, so they can be assigned in parallel. */
+static void build_mesh_leaf_vert_owners(PBVH *pbvh, const PBVHNode *node, int leaf_index)
+{
+  for (int i = 0; i < node->totprim; i++) {
+    const MLoopTri *lt = &pbvh->looptri[node->prim_indices[i]];
+    for (int j = 0; j < 3; j++) {
+      int *owner = &pbvh->vert_owner[pbvh->mloop[lt->tri[j]].v];
+      int owner_prev = *owner;
+      while (leaf_index < owner_prev) {
+        const int owner_orig = atomic_cas_int32(owner, owner_prev, leaf_index);
+        if (owner_orig == owner_prev) {
+          break;
+        }
+        owner_prev = owner_orig;
+      }
+    }
+  }
+}
+
 /* Find vertices used by the faces in this node and update the draw buffers */
-static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
+static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node, int leaf_index)
 {
   bool has_visible = false;
 
@@ -298,8 +317,12 @@ static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
   for (int i = 0; i < totface; i++) {
     const MLoopTri *lt = &pbvh->looptri[node->prim_indices[i]];
     for (int j = 0; j < 3; j++) {
-      face_vert_indices[i][j] = map_insert_vert(
-          pbvh, map, &node->face_verts, &node->uniq_verts, pbvh->mloop[lt->tri[j]].v);
+      const int vertex = pbvh->mloop[lt->tri[j]].v;
+      face_vert_indices[i][j] = map_insert_vert(map,
+                                                &node->face_verts,
+                                                &node->uniq_verts,
+                                                vertex,
+                                                pbvh->vert_owner[vertex] == leaf_index);
     }
 
     if (has_visible == false) {
@@ -413,21 +436,19 @@ static void build_grid_leaf_node(PBVH *pbvh, PBVHNode *node)
   BKE_pbvh_node_mark_rebuild_draw(node);
 }
 
-static void build_leaf(PBVH *pbvh, int node_index, BBC *prim_bbc, int offset, int count)
+static void build_leaf(PBVH *pbvh, int node_index, BBC *prim_bbc)
 {
-  pbvh->nodes[node_index].flag |= PBVH_Leaf;
-
-  pbvh->nodes[node_index].prim_indices = pbvh->prim_indices + offset;
-  pbvh->nodes[node_index].totprim = count;
+  PBVHNode *node = &pbvh->nodes[node_index];
+  const int offset = (int)(node->prim_indices - pbvh->prim_indices);
 
   /* Still need vb for searches */
-  update_vb(pbvh, &pbvh->nodes[node_index], prim_bbc, offset, count);
+  update_vb(pbvh, node, prim_bbc, offset, node->totprim);
 
   if (pbvh->looptri) {
-    build_mesh_leaf_node(pbvh, pbvh->nodes + node_index);
+    build_mesh_leaf_node(pbvh, node, node_index);
   }
   else {
-    build_grid_leaf_node(pbvh, pbvh->nodes + node_index);
+    build_grid_leaf_node(pbvh, node);
   }
 }
 
@@ -465,70 +486,292 @@ static bool leaf_needs_material_split(PBVH *pbvh, int offset, int count)
   return false;
 }
 
+/* Ranges with more primitives than this are partitioned with multiple threads. */
+#define PARTITION_THREAD_LIMIT 100000
+#define PARTITION_CHUNK_SIZE 16384
+
+/* Subtrees with more primitives than this are built in their own task. */
+#define BUILD_TASK_LIMIT (LEAF_LIMIT * 4)
+
+/* Range of primitives, the tree is built from these before the nodes are
+ * numbered, so that the subtrees can be built in parallel. */
+typedef struct PBVHBuildNode {
+  struct PBVHBuildNode *children[2];
+  int offset, count;
+} PBVHBuildNode;
+
+typedef struct PBVHBuildData {
+  PBVH *pbvh;
+  BBC *prim_bbc;
+  /* Same size as prim_indices, for the parallel partition. */
+  int *prim_indices_tmp;
+  TaskPool *task_pool;
+} PBVHBuildData;
+
+typedef struct PBVHBuildTask {
+  PBVHBuildNode *node;
+  BB cb;
+  bool use_cb;
+} PBVHBuildTask;
+
+typedef struct PBVHPartitionChunk {
+  int left_count;
+  int left_start, right_start;
+  /* Bounding boxes around the centroids on the left and the right. */
+  BB cb[2];
+} PBVHPartitionChunk;
+
+typedef struct PBVHPartitionData {
+  const PBVHBuildData *build_data;
+  int offset, count;
+  int axis;
+  float mid;
+  PBVHPartitionChunk *chunks;
+} PBVHPartitionData;
+
+static void partition_chunk_count_cb(void *__restrict userdata,
+                                     const int n,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHPartitionData *data = userdata;
+  const int *prim_indices = data->build_data->pbvh->prim_indices;
+  const BBC *prim_bbc = data->build_data->prim_bbc;
+  PBVHPartitionChunk *chunk = &data->chunks[n];
+  const int start = data->offset + n * PARTITION_CHUNK_SIZE;
+  const int end = min_ii(start + PARTITION_CHUNK_SIZE, data->offset + data->count);
+
+  chunk->left_count = 0;
+  BB_reset(&chunk->cb[0]);
+  BB_reset(&chunk->cb[1]);
+
+  for (int i = start; i < end; i++) {
+    const float *co = prim_bbc[prim_indices[i]].bcentroid;
+    const bool is_left = co[data->axis] < data->mid;
+    chunk->left_count += is_left;
+    BB_expand(&chunk->cb[is_left ? 0 : 1], co);
+  }
+}
+
+static void partition_chunk_scatter_cb(void *__restrict userdata,
+                                       const int n,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHPartitionData *data = userdata;
+  const int *prim_indices = data->build_data->pbvh->prim_indices;
+  const BBC *prim_bbc = data->build_data->prim_bbc;
+  int *prim_indices_tmp = data->build_data->prim_indices_tmp;
+  const PBVHPartitionChunk *chunk = &data->chunks[n];
+  const int start = data->offset + n * PARTITION_CHUNK_SIZE;
+  const int end = min_ii(start + PARTITION_CHUNK_SIZE, data->offset + data->count);
+
+  int left = chunk->left_start;
+  int right = chunk->right_start;
+  for (int i = start; i < end; i++) {
+    const int prim = prim_indices[i];
+    if (prim_bbc[prim].bcentroid[data->axis] < data->mid) {
+      prim_indices_tmp[left++] = prim;
+    }
+    else {
+      prim_indices_tmp[right++] = prim;
+    }
+  }
+}
+
+/* Stable version of #partition_indices that runs over chunks of the range in parallel.
+ * Also returns the centroid bounding boxes of both sides in r_cb.
+ * Returns the index of the first element on the right of the partition */
+static int partition_indices_parallel(const PBVHBuildData *build_data,
+                                      int offset,
+                                      int count,
+                                      const BB *cb,
+                                      BB r_cb[2])
+{
+  PBVH *pbvh = build_data->pbvh;
+  const int axis = BB_widest_axis(cb);
+  const int chunks_num = (count + PARTITION_CHUNK_SIZE - 1) / PARTITION_CHUNK_SIZE;
+
+  PBVHPartitionData data = {
+      .build_data = build_data,
+      .offset = offset,
+      .count = count,
+      .axis = axis,
+      .mid = (cb->bmax[axis] + cb->bmin[axis]) * 0.5f,
+      .chunks = MEM_mallocN(sizeof(PBVHPartitionChunk) * chunks_num, __func__),
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0, chunks_num, &data, partition_chunk_count_cb, &settings);
+
+  int left_count = 0;
+  BB_reset(&r_cb[0]);
+  BB_reset(&r_cb[1]);
+  for (int n = 0; n < chunks_num; n++) {
+    left_count += data.chunks[n].left_count;
+    BB_expand_with_bb(&r_cb[0], &data.chunks[n].cb[0]);
+    BB_expand_with_bb(&r_cb[1], &data.chunks[n].cb[1]);
+  }
+
+  int end;
+  if (ELEM(left_count, 0, count)) {
+    /* All centroids are at the same position along the axis, split in the middle. */
+    r_cb[0] = r_cb[1] = *cb;
+    end = offset + count / 2;
+  }
+  else {
+    int left = offset, right = offset + left_count;
+    for (int n = 0; n < chunks_num; n++) {
+      PBVHPartitionChunk *chunk = &data.chunks[n];
+      const int chunk_count = min_ii(PARTITION_CHUNK_SIZE, count - n * PARTITION_CHUNK_SIZE);
+      chunk->left_start = left;
+      chunk->right_start = right;
+      left += chunk->left_count;
+      right += chunk_count - chunk->left_count;
+    }
+
+    BLI_task_parallel_range(0, chunks_num, &data, partition_chunk_scatter_cb, &settings);
+    memcpy(pbvh->prim_indices + offset,
+           build_data->prim_indices_tmp + offset,
+           sizeof(int) * (size_t)count);
+    end = offset + left_count;
+  }
+
+  MEM_freeN(data.chunks);
+  return end;
+}
+
+static void build_sub(PBVHBuildData *build_data, PBVHBuildNode *node, const BB *cb);
+
+static void build_sub_task_cb(TaskPool *__restrict pool, void *taskdata)
+{
+  PBVHBuildData *build_data = BLI_task_pool_user_data(pool);
+  PBVHBuildTask *task = taskdata;
+
+  build_sub(build_data, task->node, task->use_cb ? &task->cb : NULL);
+}
+
 /* Recursively build a node in the tree
- *
- * vb is the voxel box around all of the primitives contained in
- * this node.
  *
  * cb is the bounding box around all the centroids of the primitives
- * contained in this node
+ * contained in this node, computed when NULL
  *
- * offset and start indicate a range in the array of primitive indices
+ * node->offset and node->count indicate a range in the array of primitive indices
  */
 
-static void build_sub(PBVH *pbvh, int node_index, BB *cb, BBC *prim_bbc, int offset, int count)
+static void build_sub(PBVHBuildData *build_data, PBVHBuildNode *node, const BB *cb)
 {
-  int end;
+  PBVH *pbvh = build_data->pbvh;
+  const int offset = node->offset;
+  const int count = node->count;
   BB cb_backing;
+  BB cb_children[2];
+  bool use_cb_children = false;
+  int end;
+
+  node->children[0] = node->children[1] = NULL;
 
   /* Decide whether this is a leaf or not */
   const bool below_leaf_limit = count <= pbvh->leaf_limit;
   if (below_leaf_limit) {
     if (!leaf_needs_material_split(pbvh, offset, count)) {
-      build_leaf(pbvh, node_index, prim_bbc, offset, count);
       return;
     }
   }
 
-  /* Add two child nodes */
-  pbvh->nodes[node_index].children_offset = pbvh->totnode;
-  pbvh_grow_nodes(pbvh, pbvh->totnode + 2);
-
-  /* Update parent node bounding box */
-  update_vb(pbvh, &pbvh->nodes[node_index], prim_bbc, offset, count);
-
   if (!below_leaf_limit) {
     /* Find axis with widest range of primitive centroids */
     if (!cb) {
-      cb = &cb_backing;
-      BB_reset(cb);
+      BB_reset(&cb_backing);
       for (int i = offset + count - 1; i >= offset; i--) {
-        BB_expand(cb, prim_bbc[pbvh->prim_indices[i]].bcentroid);
+        BB_expand(&cb_backing, build_data->prim_bbc[pbvh->prim_indices[i]].bcentroid);
       }
+      cb = &cb_backing;
     }
-    const int axis = BB_widest_axis(cb);
 
     /* Partition primitives along that axis */
-    end = partition_indices(pbvh->prim_indices,
-                            offset,
-                            offset + count - 1,
-                            axis,
-                            (cb->bmax[axis] + cb->bmin[axis]) * 0.5f,
-                            prim_bbc);
+    if (count > PARTITION_THREAD_LIMIT) {
+      end = partition_indices_parallel(build_data, offset, count, cb, cb_children);
+      use_cb_children = true;
+    }
+    else {
+      const int axis = BB_widest_axis(cb);
+      end = partition_indices(pbvh->prim_indices,
+                              offset,
+                              offset + count - 1,
+                              axis,
+                              (cb->bmax[axis] + cb->bmin[axis]) * 0.5f,
+                              build_data->prim_bbc);
+    }
   }
   else {
     /* Partition primitives by material */
     end = partition_indices_material(pbvh, offset, offset + count - 1);
   }
 
-  /* Build children */
-  build_sub(pbvh, pbvh->nodes[node_index].children_offset, NULL, prim_bbc, offset, end - offset);
-  build_sub(pbvh,
-            pbvh->nodes[node_index].children_offset + 1,
-            NULL,
-            prim_bbc,
-            end,
-            offset + count - end);
+  /* Add two child nodes */
+  for (int i = 0; i < 2; i++) {
+    PBVHBuildNode *child = MEM_mallocN(sizeof(*child), __func__);
+    child->offset = (i == 0) ? offset : end;
+    child->count = (i == 0) ? end - offset : offset + count - end;
+    node->children[i] = child;
+  }
+
+  /* Build children, the first one in another task when it's large enough */
+  if (build_data->task_pool && node->children[0]->count > BUILD_TASK_LIMIT) {
+    PBVHBuildTask *task = MEM_mallocN(sizeof(*task), __func__);
+    task->node = node->children[0];
+    task->use_cb = use_cb_children;
+    task->cb = cb_children[0];
+    BLI_task_pool_push(build_data->task_pool, build_sub_task_cb, task, true, NULL);
+  }
+  else {
+    build_sub(build_data, node->children[0], use_cb_children ? &cb_children[0] : NULL);
+  }
+  build_sub(build_data, node->children[1], use_cb_children ? &cb_children[1] : NULL);
+}
+
+/* Number the nodes in the same order as a recursive build would, and free the build nodes. */
+static void build_nodes_store(PBVH *pbvh, PBVHBuildNode *build_node, int node_index)
+{
+  if (build_node->children[0] == NULL) {
+    PBVHNode *node = &pbvh->nodes[node_index];
+    node->flag |= PBVH_Leaf;
+    node->prim_indices = pbvh->prim_indices + build_node->offset;
+    node->totprim = build_node->count;
+  }
+  else {
+    const int children_offset = pbvh->totnode;
+    pbvh->nodes[node_index].children_offset = children_offset;
+    pbvh_grow_nodes(pbvh, pbvh->totnode + 2);
+
+    build_nodes_store(pbvh, build_node->children[0], children_offset);
+    build_nodes_store(pbvh, build_node->children[1], children_offset + 1);
+  }
+
+  MEM_freeN(build_node);
+}
+
+static void build_leaf_vert_owners_cb(void *__restrict userdata,
+                                      const int n,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildData *build_data = userdata;
+  PBVHNode *node = &build_data->pbvh->nodes[n];
+
+  if (node->flag & PBVH_Leaf) {
+    build_mesh_leaf_vert_owners(build_data->pbvh, node, n);
+  }
+}
+
+static void build_leaf_cb(void *__restrict userdata,
+                          const int n,
+                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildData *build_data = userdata;
+
+  if (build_data->pbvh->nodes[n].flag & PBVH_Leaf) {
+    build_leaf(build_data->pbvh, n, build_data->prim_bbc);
+  }
 }
 
 static void pbvh_build(PBVH *pbvh, BB *cb, BBC *prim_bbc, int totprim)
@@ -552,8 +795,120 @@ static void pbvh_build(PBVH *pbvh, BB *cb, BBC *prim_bbc, int totprim)
     }
   }
 
+  PBVHBuildData build_data = {
+      .pbvh = pbvh,
+      .prim_bbc = prim_bbc,
+  };
+  if (totprim > PARTITION_THREAD_LIMIT) {
+    build_data.prim_indices_tmp = MEM_mallocN(sizeof(int) * totprim, "bvh prim indices tmp");
+  }
+  if (totprim > BUILD_TASK_LIMIT) {
+    build_data.task_pool = BLI_task_pool_create(&build_data, TASK_PRIORITY_HIGH);
+  }
+
+  /* Split the primitives into leafs. */
+  PBVHBuildNode *root = MEM_mallocN(sizeof(*root), __func__);
+  root->offset = 0;
+  root->count = totprim;
+  build_sub(&build_data, root, cb);
+
+  if (build_data.task_pool) {
+    BLI_task_pool_work_and_wait(build_data.task_pool);
+    BLI_task_pool_free(build_data.task_pool);
+  }
+  MEM_SAFE_FREE(build_data.prim_indices_tmp);
+
   pbvh->totnode = 1;
-  build_sub(pbvh, 0, cb, prim_bbc, 0, totprim);
+  build_nodes_store(pbvh, root, 0);
+
+  /* Build the leafs, vertices have to be assigned to a leaf first. */
+  TaskParallelSettings settings;
+  BKE_pbvh_parallel_range_settings(&settings, true, pbvh->totnode);
+  if (pbvh->looptri) {
+    BLI_task_parallel_range(0, pbvh->totnode, &build_data, build_leaf_vert_owners_cb, &settings);
+  }
+  BLI_task_parallel_range(0, pbvh->totnode, &build_data, build_leaf_cb, &settings);
+
+  /* Update parent node bounding boxes, children are always stored after their parent. */
+  for (int i = pbvh->totnode - 1; i >= 0; i--) {
+    PBVHNode *node = &pbvh->nodes[i];
+    if (!(node->flag & PBVH_Leaf)) {
+      update_node_vb(pbvh, node);
+      node->orig_vb = node->vb;
+    }
+  }
+}
+
+typedef struct PBVHBuildBBCData {
+  PBVH *pbvh;
+  BBC *prim_bbc;
+} PBVHBuildBBCData;
+
+static void build_mesh_prim_bbc_cb(void *__restrict userdata,
+                                   const int i,
+                                   const TaskParallelTLS *__restrict tls)
+{
+  PBVHBuildBBCData *data = userdata;
+  const PBVH *pbvh = data->pbvh;
+  const MLoopTri *lt = &pbvh->looptri[i];
+  const int sides = 3;
+  BBC *bbc = data->prim_bbc + i;
+
+  BB_reset((BB *)bbc);
+
+  for (int j = 0; j < sides; j++) {
+    BB_expand((BB *)bbc, pbvh->verts[pbvh->mloop[lt->tri[j]].v].co);
+  }
+
+  BBC_update_centroid(bbc);
+
+  BB_expand(tls->userdata_chunk, bbc->bcentroid);
+}
+
+static void build_grids_prim_bbc_cb(void *__restrict userdata,
+                                    const int i,
+                                    const TaskParallelTLS *__restrict tls)
+{
+  PBVHBuildBBCData *data = userdata;
+  const CCGKey *key = &data->pbvh->gridkey;
+  CCGElem *grid = data->pbvh->grids[i];
+  BBC *bbc = data->prim_bbc + i;
+
+  BB_reset((BB *)bbc);
+
+  for (int j = 0; j < key->grid_size * key->grid_size; j++) {
+    BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
+  }
+
+  BBC_update_centroid(bbc);
+
+  BB_expand(tls->userdata_chunk, bbc->bcentroid);
+}
+
+static void build_prim_bbc_reduce(const void *__restrict UNUSED(userdata),
+                                  void *__restrict chunk_join,
+                                  void *__restrict chunk)
+{
+  BB_expand_with_bb(chunk_join, chunk);
+}
+
+/* For each primitive, store the AABB and the AABB centroid, and expand cb with the centroids. */
+static BBC *build_prim_bbc(PBVH *pbvh, int totprim, TaskParallelRangeFunc func, BB *cb)
+{
+  PBVHBuildBBCData data = {
+      .pbvh = pbvh,
+      .prim_bbc = MEM_mallocN(sizeof(BBC) * totprim, "prim_bbc"),
+  };
+
+  TaskParallelSettings settings;
+  BKE_pbvh_parallel_range_settings(&settings, true, totprim);
+  settings.min_iter_per_thread = 1024;
+  settings.userdata_chunk = cb;
+  settings.userdata_chunk_size = sizeof(*cb);
+  settings.func_reduce = build_prim_bbc_reduce;
+  BLI_task_parallel_range(0, totprim, &data, func, &settings);
+
+  return data.prim_bbc;
 }
 
 /**
@@ -574,7 +929,6 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
                          const MLoopTri *looptri,
                          int looptri_num)
 {
-  BBC *prim_bbc = NULL;
   BB cb;
 
   pbvh->mesh = mesh;
@@ -583,7 +937,8 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
   pbvh->mloop = mloop;
   pbvh->looptri = looptri;
   pbvh->verts = verts;
-  pbvh->vert_bitmap = BLI_BITMAP_NEW(totvert, "bvh->vert_bitmap");
+  pbvh->vert_owner = MEM_malloc_arrayN((size_t)totvert, sizeof(int), "bvh->vert_owner");
+  copy_vn_i(pbvh->vert_owner, totvert, INT_MAX);
   pbvh->totvert = totvert;
   pbvh->leaf_limit = LEAF_LIMIT;
   pbvh->vdata = vdata;
@@ -595,31 +950,153 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
 
   BB_reset(&cb);
 
-  /* For each face, store the AABB and the AABB centroid */
-  prim_bbc = MEM_mallocN(sizeof(BBC) * looptri_num, "prim_bbc");
+  BBC *prim_bbc = build_prim_bbc(pbvh, looptri_num, build_mesh_prim_bbc_cb, &cb);
 
-  for (int i = 0; i < looptri_num; i++) {
-    const MLoopTri *lt = &looptri[i];
-    const int sides = 3;
-    BBC *bbc = prim_bbc + i;
+  if (looptri_num) {
+    pbvh_build(pbvh, &cb, prim_bbc, looptri_num);
+  }
 
-    BB_reset((BB *)bbc);
+  MEM_freeN(prim_bbc);
+  MEM_SAFE_FREE(pbvh->vert_owner);
+}
 
-    for (int j = 0; j < sides; j++) {
-      BB_expand((BB *)bbc, verts[pbvh->mloop[lt->tri[j]].v].co);
+typedef struct PBVHMeshUpdateData {
+  PBVH *pbvh;
+  const MPoly *mpoly;
+  const MLoop *mloop;
+  const MLoopTri *looptri;
+  const MVert *verts;
+} PBVHMeshUpdateData;
+
+static void pbvh_mesh_update_check_cb(void *__restrict userdata,
+                                      const int n,
+                                      const TaskParallelTLS *__restrict tls)
+{
+  PBVHMeshUpdateData *data = userdata;
+  const PBVHNode *node = &data->pbvh->nodes[n];
+  bool *is_invalid = tls->userdata_chunk;
+
+  if (!(node->flag & PBVH_Leaf) || node->totprim == 0 || *is_invalid) {
+    return;
+  }
+
+  const MPoly *mp_first = &data->mpoly[data->looptri[node->prim_indices[0]].poly];
+  for (int i = 0; i < node->totprim; i++) {
+    const MLoopTri *lt = &data->looptri[node->prim_indices[i]];
+    for (int j = 0; j < 3; j++) {
+      const int vertex = node->vert_indices[node->face_vert_indices[i][j]];
+      if (vertex != (int)data->mloop[lt->tri[j]].v) {
+        *is_invalid = true;
+        return;
+      }
+    }
+    /* The node would have been split if the materials don't match. */
+    if (!face_materials_match(mp_first, &data->mpoly[lt->poly])) {
+      *is_invalid = true;
+      return;
+    }
+  }
+}
+
+static void pbvh_mesh_update_check_reduce(const void *__restrict UNUSED(userdata),
+                                          void *__restrict chunk_join,
+                                          void *__restrict chunk)
+{
+  *(bool *)chunk_join |= *(bool *)chunk;
+}
+
+static void pbvh_mesh_update_node_cb(void *__restrict userdata,
+                                     const int n,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHMeshUpdateData *data = userdata;
+  PBVH *pbvh = data->pbvh;
+  PBVHNode *node = &pbvh->nodes[n];
+
+  if (node->flag & PBVH_Leaf) {
+    bool has_visible = (pbvh->respect_hide == false);
+    for (int i = 0; i < node->totprim && !has_visible; i++) {
+      const MLoopTri *lt = &pbvh->looptri[node->prim_indices[i]];
+      if (!paint_is_face_hidden(lt, pbvh->verts, pbvh->mloop)) {
+        has_visible = true;
+      }
     }
+    BKE_pbvh_node_fully_hidden_set(node, !has_visible);
+    BKE_pbvh_node_mark_rebuild_draw(node);
+  }
 
-    BBC_update_centroid(bbc);
+  BKE_pbvh_node_mark_update(node);
+}
 
-    BB_expand(&cb, bbc->bcentroid);
+/**
+ * Update a PBVH built with #BKE_pbvh_build_mesh in place for a mesh with the same topology,
+ * keeping the node partition and only updating the bounding boxes, visibility and draw buffers.
+ *
+ * Returns false and leaves the PBVH unchanged when the topology or the materials changed,
+ * a full rebuild is needed then. On success, looptri is owned by the PBVH.
+ */
+bool BKE_pbvh_mesh_update(PBVH *pbvh,
+                          const Mesh *mesh,
+                          const MPoly *mpoly,
+                          const MLoop *mloop,
+                          MVert *verts,
+                          int totvert,
+                          struct CustomData *vdata,
+                          struct CustomData *ldata,
+                          struct CustomData *pdata,
+                          const MLoopTri *looptri,
+                          int looptri_num)
+{
+  if (pbvh->type != PBVH_FACES || pbvh->totvert != totvert || pbvh->totprim != looptri_num ||
+      looptri_num == 0) {
+    return false;
   }
 
-  if (looptri_num) {
-    pbvh_build(pbvh, &cb, prim_bbc, looptri_num);
+  PBVHMeshUpdateData data = {
+      .pbvh = pbvh,
+      .mpoly = mpoly,
+      .mloop = mloop,
+      .looptri = looptri,
+      .verts = verts,
+  };
+
+  /* Each thread checks its own flag, they are combined in the reduce step. */
+  bool is_invalid = false;
+  TaskParallelSettings settings;
+  BKE_pbvh_parallel_range_settings(&settings, true, pbvh->totnode);
+  settings.userdata_chunk = &is_invalid;
+  settings.userdata_chunk_size = sizeof(is_invalid);
+  settings.func_reduce = pbvh_mesh_update_check_reduce;
+  BLI_task_parallel_range(0, pbvh->totnode, &data, pbvh_mesh_update_check_cb, &settings);
+
+  if (is_invalid) {
+    return false;
   }
 
-  MEM_freeN(prim_bbc);
-  MEM_freeN(pbvh->vert_bitmap);
+  if (pbvh->deformed) {
+    MEM_freeN((void *)pbvh->verts);
+    pbvh->deformed = false;
+  }
+  MEM_freeN((void *)pbvh->looptri);
+
+  pbvh->mesh = mesh;
+  pbvh->mpoly = mpoly;
+  pbvh->mloop = mloop;
+  pbvh->looptri = looptri;
+  pbvh->verts = verts;
+  pbvh->vdata = vdata;
+  pbvh->ldata = ldata;
+  pbvh->pdata = pdata;
+
+  pbvh->face_sets_color_seed = mesh->face_sets_color_seed;
+  pbvh->face_sets_color_default = mesh->face_sets_color_default;
+
+  BKE_pbvh_parallel_range_settings(&settings, true, pbvh->totnode);
+  BLI_task_parallel_range(0, pbvh->totnode, &data, pbvh_mesh_update_node_cb, &settings);
+
+  BKE_pbvh_update_bounds(pbvh, PBVH_UpdateBB | PBVH_UpdateOriginalBB);
+
+  return true;
 }
 
 /* Do a full rebuild with on Grids data structure */
@@ -645,23 +1122,7 @@ void BKE_pbvh_build_grids(PBVH *pbvh,
   BB cb;
   BB_reset(&cb);
 
-  /* For each grid, store the AABB and the AABB centroid */
-  BBC *prim_bbc = MEM_mallocN(sizeof(BBC) * totgrid, "prim_bbc");
-
-  for (int i = 0; i < totgrid; i++) {
-    CCGElem *grid = grids[i];
-    BBC *bbc = prim_bbc + i;
-
-    BB_reset((BB *)bbc);
-
-    for (int j = 0; j < gridsize * gridsize; j++) {
-      BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
-    }
-
-    BBC_update_centroid(bbc);
-
-    BB_expand(&cb, bbc->bcentroid);
-  }
+  BBC *prim_bbc = build_prim_bbc(pbvh, totgrid, build_grids_prim_bbc_cb, &cb);
 
   if (totgrid) {
     pbvh_build(pbvh, &cb, prim_bbc, totgrid);
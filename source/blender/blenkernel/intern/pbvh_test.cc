@@ -0,0 +1,322 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <climits>
+#include <cmath>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_bitmap.h"
+#include "BLI_ghash.h"
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_ccg.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_pbvh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "bmesh.h"
+
+extern "C" {
+#include "pbvh_intern.h"
+}
+
+namespace blender::bke::tests {
+
+/* Enough triangles for the threaded partition and the build tasks. */
+#define GRID_SIZE 230
+
+/* Grid of quads with a wave displacement of `height`, `rotate_first_quad` changes the
+ * triangulation of the first quad without changing the number of any elements. */
+static Mesh *grid_create(const float height, const bool rotate_first_quad)
+{
+  const int verts_len = (GRID_SIZE + 1) * (GRID_SIZE + 1);
+  const int polys_len = GRID_SIZE * GRID_SIZE;
+  Mesh *mesh = BKE_mesh_new_nomain(verts_len, 0, 0, polys_len * 4, polys_len);
+
+  for (int y = 0; y <= GRID_SIZE; y++) {
+    for (int x = 0; x <= GRID_SIZE; x++) {
+      MVert *mv = &mesh->mvert[y * (GRID_SIZE + 1) + x];
+      mv->co[0] = (float)x;
+      mv->co[1] = (float)y;
+      mv->co[2] = height * sinf((float)x * 0.1f) * cosf((float)y * 0.07f);
+    }
+  }
+  for (int y = 0; y < GRID_SIZE; y++) {
+    for (int x = 0; x < GRID_SIZE; x++) {
+      const int i = y * GRID_SIZE + x;
+      const int v = y * (GRID_SIZE + 1) + x;
+      const int quad[4] = {v, v + 1, v + GRID_SIZE + 2, v + GRID_SIZE + 1};
+      const int offset = (rotate_first_quad && i == 0) ? 1 : 0;
+      mesh->mpoly[i].loopstart = i * 4;
+      mesh->mpoly[i].totloop = 4;
+      for (int j = 0; j < 4; j++) {
+        mesh->mloop[i * 4 + j].v = (uint)quad[(j + offset) % 4];
+      }
+    }
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+  return mesh;
+}
+
+/* Triangles of the mesh, allocated like the PBVH expects, it takes ownership of them. */
+static MLoopTri *looptri_create(const Mesh *mesh, int *r_looptri_len)
+{
+  *r_looptri_len = poly_to_tri_count(mesh->totpoly, mesh->totloop);
+  MLoopTri *looptri = (MLoopTri *)MEM_malloc_arrayN(
+      (size_t)*r_looptri_len, sizeof(*looptri), __func__);
+  BKE_mesh_recalc_looptri(
+      mesh->mloop, mesh->mpoly, mesh->mvert, mesh->totloop, mesh->totpoly, looptri);
+  return looptri;
+}
+
+static PBVH *pbvh_build(Mesh *mesh)
+{
+  int looptri_len;
+  MLoopTri *looptri = looptri_create(mesh, &looptri_len);
+  PBVH *pbvh = BKE_pbvh_new();
+  BKE_pbvh_build_mesh(pbvh,
+                      mesh,
+                      mesh->mpoly,
+                      mesh->mloop,
+                      mesh->mvert,
+                      mesh->totvert,
+                      &mesh->vdata,
+                      &mesh->ldata,
+                      &mesh->pdata,
+                      looptri,
+                      looptri_len);
+  return pbvh;
+}
+
+static bool pbvh_update(PBVH *pbvh, Mesh *mesh)
+{
+  int looptri_len;
+  MLoopTri *looptri = looptri_create(mesh, &looptri_len);
+  const bool is_updated = BKE_pbvh_mesh_update(pbvh,
+                                               mesh,
+                                               mesh->mpoly,
+                                               mesh->mloop,
+                                               mesh->mvert,
+                                               mesh->totvert,
+                                               &mesh->vdata,
+                                               &mesh->ldata,
+                                               &mesh->pdata,
+                                               looptri,
+                                               looptri_len);
+  if (!is_updated) {
+    MEM_freeN(looptri);
+  }
+  return is_updated;
+}
+
+static void bb_expand(BB *bb, const float co[3])
+{
+  for (int i = 0; i < 3; i++) {
+    bb->bmin[i] = min_ff(bb->bmin[i], co[i]);
+    bb->bmax[i] = max_ff(bb->bmax[i], co[i]);
+  }
+}
+
+static void bb_reset(BB *bb)
+{
+  copy_v3_fl(bb->bmin, FLT_MAX);
+  copy_v3_fl(bb->bmax, -FLT_MAX);
+}
+
+static void bb_expect_eq(const BB &a, const BB &b, const int node_index)
+{
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(a.bmin[i], b.bmin[i]) << "node " << node_index;
+    EXPECT_EQ(a.bmax[i], b.bmax[i]) << "node " << node_index;
+  }
+}
+
+/* Compute the bounds of all nodes one by one from the triangles in the leafs, children are
+ * always stored after their parent. */
+static std::vector<BB> reference_bounds(const PBVH *pbvh)
+{
+  std::vector<BB> bounds(pbvh->totnode);
+  for (int n = pbvh->totnode - 1; n >= 0; n--) {
+    const PBVHNode *node = &pbvh->nodes[n];
+    bb_reset(&bounds[n]);
+    if (node->flag & PBVH_Leaf) {
+      for (uint i = 0; i < node->totprim; i++) {
+        const MLoopTri *lt = &pbvh->looptri[node->prim_indices[i]];
+        for (int j = 0; j < 3; j++) {
+          bb_expand(&bounds[n], pbvh->verts[pbvh->mloop[lt->tri[j]].v].co);
+        }
+      }
+    }
+    else {
+      for (int c = 0; c < 2; c++) {
+        const BB &child = bounds[node->children_offset + c];
+        bb_expand(&bounds[n], child.bmin);
+        bb_expand(&bounds[n], child.bmax);
+      }
+    }
+  }
+  return bounds;
+}
+
+/* Check the leafs against a serial pass over the nodes: every triangle is in exactly one leaf,
+ * the corners of the triangles point to their vertices, and every vertex is unique in the leaf
+ * with the lowest node index that uses it. */
+static void leafs_check(const PBVH *pbvh)
+{
+  std::vector<int> prim_leaf(pbvh->totprim, -1);
+  std::vector<int> vert_owner(pbvh->totvert, INT_MAX);
+
+  for (int n = 0; n < pbvh->totnode; n++) {
+    const PBVHNode *node = &pbvh->nodes[n];
+    if (!(node->flag & PBVH_Leaf)) {
+      continue;
+    }
+    for (uint i = 0; i < node->totprim; i++) {
+      const int prim = node->prim_indices[i];
+      EXPECT_EQ(prim_leaf[prim], -1) << "triangle " << prim;
+      prim_leaf[prim] = n;
+
+      const MLoopTri *lt = &pbvh->looptri[prim];
+      for (int j = 0; j < 3; j++) {
+        const int vertex = (int)pbvh->mloop[lt->tri[j]].v;
+        EXPECT_EQ(node->vert_indices[node->face_vert_indices[i][j]], vertex);
+        vert_owner[vertex] = min_ii(vert_owner[vertex], n);
+      }
+    }
+  }
+
+  std::vector<int> vert_unique_leaf(pbvh->totvert, -1);
+  for (int n = 0; n < pbvh->totnode; n++) {
+    const PBVHNode *node = &pbvh->nodes[n];
+    if (!(node->flag & PBVH_Leaf)) {
+      continue;
+    }
+    for (uint i = 0; i < node->uniq_verts + node->face_verts; i++) {
+      const int vertex = node->vert_indices[i];
+      if (i < node->uniq_verts) {
+        EXPECT_EQ(vert_unique_leaf[vertex], -1) << "vertex " << vertex;
+        vert_unique_leaf[vertex] = n;
+        EXPECT_EQ(vert_owner[vertex], n) << "vertex " << vertex;
+      }
+      else {
+        EXPECT_NE(vert_owner[vertex], n) << "vertex " << vertex;
+      }
+    }
+  }
+
+  for (int prim = 0; prim < pbvh->totprim; prim++) {
+    EXPECT_NE(prim_leaf[prim], -1) << "triangle " << prim;
+  }
+  for (int vertex = 0; vertex < pbvh->totvert; vertex++) {
+    EXPECT_EQ(vert_unique_leaf[vertex], vert_owner[vertex] == INT_MAX ? -1 : vert_owner[vertex])
+        << "vertex " << vertex;
+  }
+}
+
+static void bounds_check(const PBVH *pbvh)
+{
+  const std::vector<BB> bounds = reference_bounds(pbvh);
+  for (int n = 0; n < pbvh->totnode; n++) {
+    bb_expect_eq(pbvh->nodes[n].vb, bounds[n], n);
+    bb_expect_eq(pbvh->nodes[n].orig_vb, bounds[n], n);
+  }
+}
+
+class PBVHMeshTest : public testing::Test {
+ public:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+};
+
+TEST_F(PBVHMeshTest, ParallelBuild)
+{
+  Mesh *mesh = grid_create(1.0f, false);
+  PBVH *pbvh = pbvh_build(mesh);
+
+  ASSERT_GT(pbvh->totprim, 100000);
+  EXPECT_GT(pbvh->totnode, 1);
+  bounds_check(pbvh);
+  leafs_check(pbvh);
+
+  /* Leafs are numbered the same way and contain the same triangles every time. */
+  PBVH *pbvh_again = pbvh_build(mesh);
+  ASSERT_EQ(pbvh_again->totnode, pbvh->totnode);
+  for (int n = 0; n < pbvh->totnode; n++) {
+    const PBVHNode *node = &pbvh->nodes[n];
+    const PBVHNode *node_again = &pbvh_again->nodes[n];
+    EXPECT_EQ(node->flag & PBVH_Leaf, node_again->flag & PBVH_Leaf);
+    EXPECT_EQ(node->totprim, node_again->totprim);
+    EXPECT_EQ(node->uniq_verts, node_again->uniq_verts);
+    bb_expect_eq(node->vb, node_again->vb, n);
+  }
+
+  BKE_pbvh_free(pbvh_again);
+  BKE_pbvh_free(pbvh);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(PBVHMeshTest, UpdateAfterDeform)
+{
+  Mesh *mesh = grid_create(1.0f, false);
+  Mesh *mesh_deformed = grid_create(5.0f, false);
+  PBVH *pbvh = pbvh_build(mesh);
+  const int totnode = pbvh->totnode;
+
+  EXPECT_TRUE(pbvh_update(pbvh, mesh_deformed));
+  EXPECT_EQ(pbvh->totnode, totnode);
+  EXPECT_EQ(pbvh->verts, mesh_deformed->mvert);
+  bounds_check(pbvh);
+  leafs_check(pbvh);
+
+  /* The partition is kept, but the mesh is covered the same way as by a full rebuild. */
+  PBVH *pbvh_rebuilt = pbvh_build(mesh_deformed);
+  bb_expect_eq(pbvh->nodes[0].vb, pbvh_rebuilt->nodes[0].vb, 0);
+
+  BKE_pbvh_free(pbvh_rebuilt);
+  BKE_pbvh_free(pbvh);
+  BKE_id_free(nullptr, mesh_deformed);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(PBVHMeshTest, UpdateAfterTopologyChange)
+{
+  Mesh *mesh = grid_create(1.0f, false);
+  Mesh *mesh_changed = grid_create(1.0f, true);
+  PBVH *pbvh = pbvh_build(mesh);
+
+  /* Same number of vertices and triangles, but different triangles, a rebuild is needed. */
+  EXPECT_FALSE(pbvh_update(pbvh, mesh_changed));
+  EXPECT_EQ(pbvh->verts, mesh->mvert);
+  bounds_check(pbvh);
+
+  BKE_pbvh_free(pbvh);
+  BKE_id_free(nullptr, mesh_changed);
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::bke::tests
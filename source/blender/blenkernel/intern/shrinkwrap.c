@@ -99,6 +99,10 @@ typedef struct ShrinkwrapCalcCBData {
 
   float *proj_axis;
   SpaceTransform *local2aux;
+
+  /* Vertices in target space and their nearest points, for batched searches. */
+  float (*tree_co)[3];
+  BVHTreeNearest *nearest;
 } ShrinkwrapCalcCBData;
 
 /* Checks if the modifier needs target normals with these settings. */
@@ -345,59 +349,99 @@ void BKE_shrinkwrap_compute_boundary_data(struct Mesh *mesh)
   mesh->runtime.shrinkwrap_data = shrinkwrap_build_boundary_data(mesh);
 }
 
+static float shrinkwrap_vertex_weight(const ShrinkwrapCalcData *calc, const int i)
+{
+  const float weight = BKE_defvert_array_find_weight_safe(calc->dvert, i, calc->vgroup);
+  return calc->invert_vgroup ? 1.0f - weight : weight;
+}
+
 /**
- * Shrink-wrap to the nearest vertex
- *
- * it builds a #BVHTree of vertices we can attach to and then
- * for each vertex performs a nearest vertex search on the tree
+ * Convert the vertices to tree coordinates for #BLI_bvhtree_find_nearest_batch,
+ * vertices without weight aren't searched.
  */
-static void shrinkwrap_calc_nearest_vertex_cb_ex(void *__restrict userdata,
-                                                 const int i,
-                                                 const TaskParallelTLS *__restrict tls)
+static void shrinkwrap_calc_nearest_init_cb_ex(void *__restrict userdata,
+                                               const int i,
+                                               const TaskParallelTLS *__restrict UNUSED(tls))
 {
   ShrinkwrapCalcCBData *data = userdata;
-
   ShrinkwrapCalcData *calc = data->calc;
-  BVHTreeFromMesh *treeData = &data->tree->treeData;
-  BVHTreeNearest *nearest = tls->userdata_chunk;
+  BVHTreeNearest *nearest = &data->nearest[i];
+  float *tmp_co = data->tree_co[i];
 
-  float *co = calc->vertexCos[i];
-  float tmp_co[3];
-  float weight = BKE_defvert_array_find_weight_safe(calc->dvert, i, calc->vgroup);
-
-  if (calc->invert_vgroup) {
-    weight = 1.0f - weight;
-  }
+  nearest->index = -1;
 
-  if (weight == 0.0f) {
+  if (shrinkwrap_vertex_weight(calc, i) == 0.0f) {
+    /* Nothing is nearer than zero. */
+    nearest->dist_sq = 0.0f;
+    zero_v3(tmp_co);
     return;
   }
+  nearest->dist_sq = FLT_MAX;
 
   /* Convert the vertex to tree coordinates */
   if (calc->vert) {
     copy_v3_v3(tmp_co, calc->vert[i].co);
   }
   else {
-    copy_v3_v3(tmp_co, co);
+    copy_v3_v3(tmp_co, calc->vertexCos[i]);
   }
   BLI_space_transform_apply(&calc->local2target, tmp_co);
+}
 
-  /* Use local proximity heuristics (to reduce the nearest search)
-   *
-   * If we already had an hit before.. we assume this vertex is going to have a close hit to that
-   * other vertex so we can initiate the "nearest.dist" with the expected value to that last hit.
-   * This will lead in pruning of the search tree. */
-  if (nearest->index != -1) {
-    nearest->dist_sq = len_squared_v3v3(tmp_co, nearest->co);
-  }
-  else {
-    nearest->dist_sq = FLT_MAX;
-  }
+/**
+ * Find the nearest point on the tree for all vertices, coherent searches are faster when
+ * they're done together.
+ */
+static void shrinkwrap_calc_nearest_batch(ShrinkwrapCalcData *calc,
+                                          ShrinkwrapCalcCBData *data,
+                                          BVHTree *tree,
+                                          TaskParallelRangeFunc func)
+{
+  BVHTreeFromMesh *treeData = &data->tree->treeData;
+
+  data->tree_co = MEM_malloc_arrayN((size_t)calc->numVerts, sizeof(*data->tree_co), __func__);
+  data->nearest = MEM_malloc_arrayN((size_t)calc->numVerts, sizeof(*data->nearest), __func__);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (calc->numVerts > BKE_MESH_OMP_LIMIT);
+  BLI_task_parallel_range(0, calc->numVerts, data, shrinkwrap_calc_nearest_init_cb_ex, &settings);
+
+  BLI_bvhtree_find_nearest_batch(tree,
+                                 (const float(*)[3])data->tree_co,
+                                 calc->numVerts,
+                                 data->nearest,
+                                 treeData->nearest_callback,
+                                 treeData,
+                                 settings.use_threading ? BVH_NEAREST_USE_THREADING : 0);
+
+  BLI_task_parallel_range(0, calc->numVerts, data, func, &settings);
+
+  MEM_freeN(data->tree_co);
+  MEM_freeN(data->nearest);
+}
+
+/**
+ * Shrink-wrap to the nearest vertex
+ *
+ * it builds a #BVHTree of vertices we can attach to and then
+ * for each vertex performs a nearest vertex search on the tree
+ */
+static void shrinkwrap_calc_nearest_vertex_cb_ex(void *__restrict userdata,
+                                                 const int i,
+                                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ShrinkwrapCalcCBData *data = userdata;
 
-  BLI_bvhtree_find_nearest(treeData->tree, tmp_co, nearest, treeData->nearest_callback, treeData);
+  ShrinkwrapCalcData *calc = data->calc;
+  const BVHTreeNearest *nearest = &data->nearest[i];
 
   /* Found the nearest vertex */
   if (nearest->index != -1) {
+    float *co = calc->vertexCos[i];
+    float tmp_co[3];
+    float weight = shrinkwrap_vertex_weight(calc, i);
+
     /* Adjusting the vertex weight,
      * so that after interpolating it keeps a certain distance from the nearest position */
     if (nearest->dist_sq > FLT_EPSILON) {
@@ -415,23 +459,12 @@ static void shrinkwrap_calc_nearest_vertex_cb_ex(void *__restrict userdata,
 
 static void shrinkwrap_calc_nearest_vertex(ShrinkwrapCalcData *calc)
 {
-  BVHTreeNearest nearest = NULL_BVHTreeNearest;
-
-  /* Setup nearest */
-  nearest.index = -1;
-  nearest.dist_sq = FLT_MAX;
-
   ShrinkwrapCalcCBData data = {
       .calc = calc,
       .tree = calc->tree,
   };
-  TaskParallelSettings settings;
-  BLI_parallel_range_settings_defaults(&settings);
-  settings.use_threading = (calc->numVerts > BKE_MESH_OMP_LIMIT);
-  settings.userdata_chunk = &nearest;
-  settings.userdata_chunk_size = sizeof(nearest);
-  BLI_task_parallel_range(
-      0, calc->numVerts, &data, shrinkwrap_calc_nearest_vertex_cb_ex, &settings);
+  shrinkwrap_calc_nearest_batch(
+      calc, &data, calc->tree->treeData.tree, shrinkwrap_calc_nearest_vertex_cb_ex);
 }
 
 /*
@@ -1196,6 +1229,39 @@ static void shrinkwrap_calc_nearest_surface_point_cb_ex(void *__restrict userdat
   }
 }
 
+/**
+ * Version of #shrinkwrap_calc_nearest_surface_point_cb_ex for the results of
+ * #shrinkwrap_calc_nearest_batch, which isn't used with #MOD_SHRINKWRAP_TARGET_PROJECT.
+ */
+static void shrinkwrap_calc_nearest_surface_point_batch_cb_ex(
+    void *__restrict userdata, const int i, const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ShrinkwrapCalcCBData *data = userdata;
+
+  ShrinkwrapCalcData *calc = data->calc;
+  const BVHTreeNearest *nearest = &data->nearest[i];
+
+  /* Found the nearest vertex */
+  if (nearest->index != -1) {
+    float *co = calc->vertexCos[i];
+    float *tmp_co = data->tree_co[i];
+
+    BKE_shrinkwrap_snap_point_to_surface(data->tree,
+                                         NULL,
+                                         calc->smd->shrinkMode,
+                                         nearest->index,
+                                         nearest->co,
+                                         nearest->no,
+                                         calc->keepDist,
+                                         tmp_co,
+                                         tmp_co);
+
+    /* Convert the coordinates back to mesh coordinates */
+    BLI_space_transform_invert(&calc->local2target, tmp_co);
+    interp_v3_v3v3(co, co, tmp_co, shrinkwrap_vertex_weight(calc, i)); /* linear interpolation */
+  }
+}
+
 /**
  * Compute a smooth normal of the target (if applicable) at the hit location.
  *
@@ -1384,6 +1450,16 @@ void BKE_shrinkwrap_snap_point_to_surface(const struct ShrinkwrapTreeData *tree,
 
 static void shrinkwrap_calc_nearest_surface_point(ShrinkwrapCalcData *calc)
 {
+  if (calc->smd->shrinkType != MOD_SHRINKWRAP_TARGET_PROJECT) {
+    ShrinkwrapCalcCBData data = {
+        .calc = calc,
+        .tree = calc->tree,
+    };
+    shrinkwrap_calc_nearest_batch(
+        calc, &data, calc->tree->bvh, shrinkwrap_calc_nearest_surface_point_batch_cb_ex);
+    return;
+  }
+
   BVHTreeNearest nearest = NULL_BVHTreeNearest;
 
   /* Setup nearest */
@@ -22,6 +22,7 @@
  */
 
 #include "BKE_subdiv.h"
+#include "BKE_subdiv_mesh.h"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -198,6 +199,7 @@ void BKE_subdiv_free(Subdiv *subdiv)
   if (subdiv->cache_.face_ptex_offset != NULL) {
     MEM_freeN(subdiv->cache_.face_ptex_offset);
   }
+  BKE_subdiv_mesh_topology_cache_free(subdiv);
   MEM_freeN(subdiv);
 }
 
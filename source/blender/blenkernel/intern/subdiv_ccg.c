@@ -38,6 +38,7 @@
 #include "BKE_subdiv.h"
 #include "BKE_subdiv_eval.h"
 
+#include "opensubdiv_capi_type.h"
 #include "opensubdiv_topology_refiner_capi.h"
 
 /* -------------------------------------------------------------------- */
@@ -176,57 +177,73 @@ typedef struct CCGEvalGridsData {
   SubdivCCGMaterialFlagsEvaluator *material_flags_evaluator;
 } CCGEvalGridsData;
 
-static void subdiv_ccg_eval_grid_element_limit(CCGEvalGridsData *data,
-                                               const int ptex_face_index,
-                                               const float u,
-                                               const float v,
-                                               unsigned char *element)
+/* Number of grid elements which are evaluated in one batch. */
+#define EVAL_GRID_CHUNK_SIZE 256
+
+static void subdiv_ccg_eval_grid_elements_limit(CCGEvalGridsData *data,
+                                                const OpenSubdiv_PatchCoord *patch_coords,
+                                                const int num_elements,
+                                                unsigned char *elements)
 {
   Subdiv *subdiv = data->subdiv;
   SubdivCCG *subdiv_ccg = data->subdiv_ccg;
+  const int element_size = element_size_bytes_get(subdiv_ccg);
+  float P[EVAL_GRID_CHUNK_SIZE][3], N[EVAL_GRID_CHUNK_SIZE][3];
+  bool use_normals = false;
   if (subdiv->displacement_evaluator != NULL) {
-    BKE_subdiv_eval_final_point(subdiv, ptex_face_index, u, v, (float *)element);
+    BKE_subdiv_eval_final_points(subdiv, patch_coords, num_elements, P);
   }
   else if (subdiv_ccg->has_normal) {
-    BKE_subdiv_eval_limit_point_and_normal(subdiv,
-                                           ptex_face_index,
-                                           u,
-                                           v,
-                                           (float *)element,
-                                           (float *)(element + subdiv_ccg->normal_offset));
+    BKE_subdiv_eval_limit_points_and_normals(subdiv, patch_coords, num_elements, P, N);
+    use_normals = true;
   }
   else {
-    BKE_subdiv_eval_limit_point(subdiv, ptex_face_index, u, v, (float *)element);
+    BKE_subdiv_eval_limit_points(subdiv, patch_coords, num_elements, P);
+  }
+  for (int i = 0; i < num_elements; i++) {
+    unsigned char *element = elements + (size_t)i * element_size;
+    copy_v3_v3((float *)element, P[i]);
+    if (use_normals) {
+      copy_v3_v3((float *)(element + subdiv_ccg->normal_offset), N[i]);
+    }
   }
 }
 
-static void subdiv_ccg_eval_grid_element_mask(CCGEvalGridsData *data,
-                                              const int ptex_face_index,
-                                              const float u,
-                                              const float v,
-                                              unsigned char *element)
+static void subdiv_ccg_eval_grid_elements_mask(CCGEvalGridsData *data,
+                                               const OpenSubdiv_PatchCoord *patch_coords,
+                                               const int num_elements,
+                                               unsigned char *elements)
 {
   SubdivCCG *subdiv_ccg = data->subdiv_ccg;
   if (!subdiv_ccg->has_mask) {
     return;
   }
-  float *mask_value_ptr = (float *)(element + subdiv_ccg->mask_offset);
-  if (data->mask_evaluator != NULL) {
-    *mask_value_ptr = data->mask_evaluator->eval_mask(data->mask_evaluator, ptex_face_index, u, v);
-  }
-  else {
-    *mask_value_ptr = 0.0f;
+  const int element_size = element_size_bytes_get(subdiv_ccg);
+  for (int i = 0; i < num_elements; i++) {
+    const OpenSubdiv_PatchCoord *patch_coord = &patch_coords[i];
+    float *mask_value_ptr = (float *)(elements + (size_t)i * element_size +
+                                      subdiv_ccg->mask_offset);
+    if (data->mask_evaluator != NULL) {
+      *mask_value_ptr = data->mask_evaluator->eval_mask(
+          data->mask_evaluator, patch_coord->ptex_face, patch_coord->u, patch_coord->v);
+    }
+    else {
+      *mask_value_ptr = 0.0f;
+    }
   }
 }
 
-static void subdiv_ccg_eval_grid_element(CCGEvalGridsData *data,
-                                         const int ptex_face_index,
-                                         const float u,
-                                         const float v,
-                                         unsigned char *element)
+/* Evaluate consecutive grid elements, starting with the given one. */
+static void subdiv_ccg_eval_grid_elements(CCGEvalGridsData *data,
+                                          const OpenSubdiv_PatchCoord *patch_coords,
+                                          const int num_elements,
+                                          unsigned char *grid,
+                                          const size_t start_element_index)
 {
-  subdiv_ccg_eval_grid_element_limit(data, ptex_face_index, u, v, element);
-  subdiv_ccg_eval_grid_element_mask(data, ptex_face_index, u, v, element);
+  const int element_size = element_size_bytes_get(data->subdiv_ccg);
+  unsigned char *elements = grid + start_element_index * element_size;
+  subdiv_ccg_eval_grid_elements_limit(data, patch_coords, num_elements, elements);
+  subdiv_ccg_eval_grid_elements_mask(data, patch_coords, num_elements, elements);
 }
 
 static void subdiv_ccg_eval_regular_grid(CCGEvalGridsData *data, const int face_index)
@@ -235,24 +252,34 @@ static void subdiv_ccg_eval_regular_grid(CCGEvalGridsData *data, const int face_
   const int ptex_face_index = data->face_ptex_offset[face_index];
   const int grid_size = subdiv_ccg->grid_size;
   const float grid_size_1_inv = 1.0f / (grid_size - 1);
-  const int element_size = element_size_bytes_get(subdiv_ccg);
   SubdivCCGFace *faces = subdiv_ccg->faces;
   SubdivCCGFace **grid_faces = subdiv_ccg->grid_faces;
   const SubdivCCGFace *face = &faces[face_index];
+  OpenSubdiv_PatchCoord patch_coords[EVAL_GRID_CHUNK_SIZE];
   for (int corner = 0; corner < face->num_grids; corner++) {
     const int grid_index = face->start_grid_index + corner;
     unsigned char *grid = (unsigned char *)subdiv_ccg->grids[grid_index];
+    size_t chunk_start_element_index = 0;
+    int num_chunk_elements = 0;
     for (int y = 0; y < grid_size; y++) {
       const float grid_v = y * grid_size_1_inv;
       for (int x = 0; x < grid_size; x++) {
         const float grid_u = x * grid_size_1_inv;
-        float u, v;
-        BKE_subdiv_rotate_grid_to_quad(corner, grid_u, grid_v, &u, &v);
-        const size_t grid_element_index = (size_t)y * grid_size + x;
-        const size_t grid_element_offset = grid_element_index * element_size;
-        subdiv_ccg_eval_grid_element(data, ptex_face_index, u, v, &grid[grid_element_offset]);
+        OpenSubdiv_PatchCoord *patch_coord = &patch_coords[num_chunk_elements++];
+        patch_coord->ptex_face = ptex_face_index;
+        BKE_subdiv_rotate_grid_to_quad(corner, grid_u, grid_v, &patch_coord->u, &patch_coord->v);
+        if (num_chunk_elements == EVAL_GRID_CHUNK_SIZE) {
+          subdiv_ccg_eval_grid_elements(
+              data, patch_coords, num_chunk_elements, grid, chunk_start_element_index);
+          chunk_start_element_index += num_chunk_elements;
+          num_chunk_elements = 0;
+        }
       }
     }
+    if (num_chunk_elements != 0) {
+      subdiv_ccg_eval_grid_elements(
+          data, patch_coords, num_chunk_elements, grid, chunk_start_element_index);
+    }
     /* Assign grid's face. */
     grid_faces[grid_index] = &faces[face_index];
     /* Assign material flags. */
@@ -266,23 +293,36 @@ static void subdiv_ccg_eval_special_grid(CCGEvalGridsData *data, const int face_
   SubdivCCG *subdiv_ccg = data->subdiv_ccg;
   const int grid_size = subdiv_ccg->grid_size;
   const float grid_size_1_inv = 1.0f / (grid_size - 1);
-  const int element_size = element_size_bytes_get(subdiv_ccg);
   SubdivCCGFace *faces = subdiv_ccg->faces;
   SubdivCCGFace **grid_faces = subdiv_ccg->grid_faces;
   const SubdivCCGFace *face = &faces[face_index];
+  OpenSubdiv_PatchCoord patch_coords[EVAL_GRID_CHUNK_SIZE];
   for (int corner = 0; corner < face->num_grids; corner++) {
     const int grid_index = face->start_grid_index + corner;
     const int ptex_face_index = data->face_ptex_offset[face_index] + corner;
     unsigned char *grid = (unsigned char *)subdiv_ccg->grids[grid_index];
+    size_t chunk_start_element_index = 0;
+    int num_chunk_elements = 0;
     for (int y = 0; y < grid_size; y++) {
       const float u = 1.0f - (y * grid_size_1_inv);
       for (int x = 0; x < grid_size; x++) {
         const float v = 1.0f - (x * grid_size_1_inv);
-        const size_t grid_element_index = (size_t)y * grid_size + x;
-        const size_t grid_element_offset = grid_element_index * element_size;
-        subdiv_ccg_eval_grid_element(data, ptex_face_index, u, v, &grid[grid_element_offset]);
+        OpenSubdiv_PatchCoord *patch_coord = &patch_coords[num_chunk_elements++];
+        patch_coord->ptex_face = ptex_face_index;
+        patch_coord->u = u;
+        patch_coord->v = v;
+        if (num_chunk_elements == EVAL_GRID_CHUNK_SIZE) {
+          subdiv_ccg_eval_grid_elements(
+              data, patch_coords, num_chunk_elements, grid, chunk_start_element_index);
+          chunk_start_element_index += num_chunk_elements;
+          num_chunk_elements = 0;
+        }
       }
     }
+    if (num_chunk_elements != 0) {
+      subdiv_ccg_eval_grid_elements(
+          data, patch_coords, num_chunk_elements, grid, chunk_start_element_index);
+    }
     /* Assign grid's face. */
     grid_faces[grid_index] = &faces[face_index];
     /* Assign material flags. */
@@ -27,6 +27,7 @@
 #include "DNA_meshdata_types.h"
 
 #include "BLI_bitmap.h"
+#include "BLI_math_base.h"
 #include "BLI_math_vector.h"
 #include "BLI_utildefines.h"
 
@@ -35,6 +36,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "opensubdiv_capi_type.h"
 #include "opensubdiv_evaluator_capi.h"
 #include "opensubdiv_topology_refiner_capi.h"
 
@@ -168,6 +170,11 @@ void BKE_subdiv_eval_init_displacement(Subdiv *subdiv)
 
 /* ========================== Single point queries ========================== */
 
+static bool eval_derivatives_are_degenerate(const float dPdu[3], const float dPdv[3])
+{
+  return (is_zero_v3(dPdu) || is_zero_v3(dPdv)) || equals_v3v3(dPdu, dPdv);
+}
+
 void BKE_subdiv_eval_limit_point(
     Subdiv *subdiv, const int ptex_face_index, const float u, const float v, float r_P[3])
 {
@@ -196,7 +203,7 @@ void BKE_subdiv_eval_limit_point_and_derivatives(Subdiv *subdiv,
    * that giving totally unusable derivatives. */
 
   if (r_dPdu != NULL && r_dPdv != NULL) {
-    if ((is_zero_v3(r_dPdu) || is_zero_v3(r_dPdv)) || equals_v3v3(r_dPdu, r_dPdv)) {
+    if (eval_derivatives_are_degenerate(r_dPdu, r_dPdv)) {
       subdiv->evaluator->evaluateLimit(subdiv->evaluator,
                                        ptex_face_index,
                                        u * 0.999f + 0.0005f,
@@ -274,6 +281,104 @@ void BKE_subdiv_eval_final_point(
   }
 }
 
+/* ============================ Batched queries ============================= */
+
+/* Number of coordinates evaluated at once when temporary buffers are needed. */
+#define EVAL_CHUNK_SIZE 256
+
+void BKE_subdiv_eval_limit_points(Subdiv *subdiv,
+                                  const OpenSubdiv_PatchCoord *patch_coords,
+                                  const int num_patch_coords,
+                                  float (*r_P)[3])
+{
+  subdiv->evaluator->evaluatePatchesLimit(
+      subdiv->evaluator, patch_coords, num_patch_coords, (float *)r_P, NULL, NULL);
+}
+
+void BKE_subdiv_eval_limit_points_and_derivatives(Subdiv *subdiv,
+                                                  const OpenSubdiv_PatchCoord *patch_coords,
+                                                  const int num_patch_coords,
+                                                  float (*r_P)[3],
+                                                  float (*r_dPdu)[3],
+                                                  float (*r_dPdv)[3])
+{
+  subdiv->evaluator->evaluatePatchesLimit(subdiv->evaluator,
+                                          patch_coords,
+                                          num_patch_coords,
+                                          (float *)r_P,
+                                          (float *)r_dPdu,
+                                          (float *)r_dPdv);
+  /* Same as BKE_subdiv_eval_limit_point_and_derivatives(), step inside of the face for the rare
+   * points with unusable derivatives. */
+  for (int i = 0; i < num_patch_coords; i++) {
+    if (eval_derivatives_are_degenerate(r_dPdu[i], r_dPdv[i])) {
+      const OpenSubdiv_PatchCoord *patch_coord = &patch_coords[i];
+      subdiv->evaluator->evaluateLimit(subdiv->evaluator,
+                                       patch_coord->ptex_face,
+                                       patch_coord->u * 0.999f + 0.0005f,
+                                       patch_coord->v * 0.999f + 0.0005f,
+                                       r_P[i],
+                                       r_dPdu[i],
+                                       r_dPdv[i]);
+    }
+  }
+}
+
+void BKE_subdiv_eval_limit_points_and_normals(Subdiv *subdiv,
+                                              const OpenSubdiv_PatchCoord *patch_coords,
+                                              const int num_patch_coords,
+                                              float (*r_P)[3],
+                                              float (*r_N)[3])
+{
+  float dPdu[EVAL_CHUNK_SIZE][3], dPdv[EVAL_CHUNK_SIZE][3];
+  for (int start = 0; start < num_patch_coords; start += EVAL_CHUNK_SIZE) {
+    const int num_chunk_coords = min_ii(EVAL_CHUNK_SIZE, num_patch_coords - start);
+    BKE_subdiv_eval_limit_points_and_derivatives(
+        subdiv, patch_coords + start, num_chunk_coords, r_P + start, dPdu, dPdv);
+    for (int i = 0; i < num_chunk_coords; i++) {
+      cross_v3_v3v3(r_N[start + i], dPdu[i], dPdv[i]);
+      normalize_v3(r_N[start + i]);
+    }
+  }
+}
+
+void BKE_subdiv_eval_final_points(Subdiv *subdiv,
+                                  const OpenSubdiv_PatchCoord *patch_coords,
+                                  const int num_patch_coords,
+                                  float (*r_P)[3])
+{
+  if (subdiv->displacement_evaluator == NULL) {
+    BKE_subdiv_eval_limit_points(subdiv, patch_coords, num_patch_coords, r_P);
+    return;
+  }
+  float dPdu[EVAL_CHUNK_SIZE][3], dPdv[EVAL_CHUNK_SIZE][3];
+  for (int start = 0; start < num_patch_coords; start += EVAL_CHUNK_SIZE) {
+    const int num_chunk_coords = min_ii(EVAL_CHUNK_SIZE, num_patch_coords - start);
+    BKE_subdiv_eval_limit_points_and_derivatives(
+        subdiv, patch_coords + start, num_chunk_coords, r_P + start, dPdu, dPdv);
+    for (int i = 0; i < num_chunk_coords; i++) {
+      const OpenSubdiv_PatchCoord *patch_coord = &patch_coords[start + i];
+      float D[3];
+      BKE_subdiv_eval_displacement(
+          subdiv, patch_coord->ptex_face, patch_coord->u, patch_coord->v, dPdu[i], dPdv[i], D);
+      add_v3_v3(r_P[start + i], D);
+    }
+  }
+}
+
+void BKE_subdiv_eval_face_varying_points(Subdiv *subdiv,
+                                         const int face_varying_channel,
+                                         const OpenSubdiv_PatchCoord *patch_coords,
+                                         const int num_patch_coords,
+                                         float (*r_face_varying)[2])
+{
+  subdiv->evaluator->evaluatePatchesFaceVarying(subdiv->evaluator,
+                                                face_varying_channel,
+                                                patch_coords,
+                                                num_patch_coords,
+                                                (float *)r_face_varying);
+}
+
 /* ===================  Patch queries at given resolution =================== */
 
 /* Move buffer forward by a given number of bytes. */
@@ -294,6 +399,24 @@ static void buffer_write_short_value(void **buffer, const short *values_buffer,
   memcpy(*buffer, values_buffer, sizeof(short) * num_values);
 }
 
+/* Fill in patch coordinates of the grid samples starting at the given sample index, samples are
+ * ordered row by row. Returns number of filled in coordinates. */
+static int patch_resolution_coords_fill(OpenSubdiv_PatchCoord patch_coords[EVAL_CHUNK_SIZE],
+                                        const int ptex_face_index,
+                                        const int resolution,
+                                        const int start_index)
+{
+  const float inv_resolution_1 = 1.0f / (float)(resolution - 1);
+  const int num_patch_coords = min_ii(EVAL_CHUNK_SIZE, resolution * resolution - start_index);
+  for (int i = 0; i < num_patch_coords; i++) {
+    const int index = start_index + i;
+    patch_coords[i].ptex_face = ptex_face_index;
+    patch_coords[i].u = (index % resolution) * inv_resolution_1;
+    patch_coords[i].v = (index / resolution) * inv_resolution_1;
+  }
+  return num_patch_coords;
+}
+
 void BKE_subdiv_eval_limit_patch_resolution_point(Subdiv *subdiv,
                                                   const int ptex_face_index,
                                                   const int resolution,
@@ -302,12 +425,14 @@ void BKE_subdiv_eval_limit_patch_resolution_point(Subdiv *subdiv,
                                                   const int stride)
 {
   buffer_apply_offset(&buffer, offset);
-  const float inv_resolution_1 = 1.0f / (float)(resolution - 1);
-  for (int y = 0; y < resolution; y++) {
-    const float v = y * inv_resolution_1;
-    for (int x = 0; x < resolution; x++) {
-      const float u = x * inv_resolution_1;
-      BKE_subdiv_eval_limit_point(subdiv, ptex_face_index, u, v, buffer);
+  OpenSubdiv_PatchCoord patch_coords[EVAL_CHUNK_SIZE];
+  float P[EVAL_CHUNK_SIZE][3];
+  for (int start = 0; start < resolution * resolution; start += EVAL_CHUNK_SIZE) {
+    const int num_patch_coords = patch_resolution_coords_fill(
+        patch_coords, ptex_face_index, resolution, start);
+    BKE_subdiv_eval_limit_points(subdiv, patch_coords, num_patch_coords, P);
+    for (int i = 0; i < num_patch_coords; i++) {
+      buffer_write_float_value(&buffer, P[i], 3);
       buffer_apply_offset(&buffer, stride);
     }
   }
@@ -329,13 +454,17 @@ void BKE_subdiv_eval_limit_patch_resolution_point_and_derivatives(Subdiv *subdiv
   buffer_apply_offset(&point_buffer, point_offset);
   buffer_apply_offset(&du_buffer, du_offset);
   buffer_apply_offset(&dv_buffer, dv_offset);
-  const float inv_resolution_1 = 1.0f / (float)(resolution - 1);
-  for (int y = 0; y < resolution; y++) {
-    const float v = y * inv_resolution_1;
-    for (int x = 0; x < resolution; x++) {
-      const float u = x * inv_resolution_1;
-      BKE_subdiv_eval_limit_point_and_derivatives(
-          subdiv, ptex_face_index, u, v, point_buffer, du_buffer, dv_buffer);
+  OpenSubdiv_PatchCoord patch_coords[EVAL_CHUNK_SIZE];
+  float P[EVAL_CHUNK_SIZE][3], dPdu[EVAL_CHUNK_SIZE][3], dPdv[EVAL_CHUNK_SIZE][3];
+  for (int start = 0; start < resolution * resolution; start += EVAL_CHUNK_SIZE) {
+    const int num_patch_coords = patch_resolution_coords_fill(
+        patch_coords, ptex_face_index, resolution, start);
+    BKE_subdiv_eval_limit_points_and_derivatives(
+        subdiv, patch_coords, num_patch_coords, P, dPdu, dPdv);
+    for (int i = 0; i < num_patch_coords; i++) {
+      buffer_write_float_value(&point_buffer, P[i], 3);
+      buffer_write_float_value(&du_buffer, dPdu[i], 3);
+      buffer_write_float_value(&dv_buffer, dPdv[i], 3);
       buffer_apply_offset(&point_buffer, point_stride);
       buffer_apply_offset(&du_buffer, du_stride);
       buffer_apply_offset(&dv_buffer, dv_stride);
@@ -355,14 +484,15 @@ void BKE_subdiv_eval_limit_patch_resolution_point_and_normal(Subdiv *subdiv,
 {
   buffer_apply_offset(&point_buffer, point_offset);
   buffer_apply_offset(&normal_buffer, normal_offset);
-  const float inv_resolution_1 = 1.0f / (float)(resolution - 1);
-  for (int y = 0; y < resolution; y++) {
-    const float v = y * inv_resolution_1;
-    for (int x = 0; x < resolution; x++) {
-      const float u = x * inv_resolution_1;
-      float normal[3];
-      BKE_subdiv_eval_limit_point_and_normal(subdiv, ptex_face_index, u, v, point_buffer, normal);
-      buffer_write_float_value(&normal_buffer, normal, 3);
+  OpenSubdiv_PatchCoord patch_coords[EVAL_CHUNK_SIZE];
+  float P[EVAL_CHUNK_SIZE][3], N[EVAL_CHUNK_SIZE][3];
+  for (int start = 0; start < resolution * resolution; start += EVAL_CHUNK_SIZE) {
+    const int num_patch_coords = patch_resolution_coords_fill(
+        patch_coords, ptex_face_index, resolution, start);
+    BKE_subdiv_eval_limit_points_and_normals(subdiv, patch_coords, num_patch_coords, P, N);
+    for (int i = 0; i < num_patch_coords; i++) {
+      buffer_write_float_value(&point_buffer, P[i], 3);
+      buffer_write_float_value(&normal_buffer, N[i], 3);
       buffer_apply_offset(&point_buffer, point_stride);
       buffer_apply_offset(&normal_buffer, normal_stride);
     }
@@ -381,14 +511,16 @@ void BKE_subdiv_eval_limit_patch_resolution_point_and_short_normal(Subdiv *subdi
 {
   buffer_apply_offset(&point_buffer, point_offset);
   buffer_apply_offset(&normal_buffer, normal_offset);
-  const float inv_resolution_1 = 1.0f / (float)(resolution - 1);
-  for (int y = 0; y < resolution; y++) {
-    const float v = y * inv_resolution_1;
-    for (int x = 0; x < resolution; x++) {
-      const float u = x * inv_resolution_1;
+  OpenSubdiv_PatchCoord patch_coords[EVAL_CHUNK_SIZE];
+  float P[EVAL_CHUNK_SIZE][3], N[EVAL_CHUNK_SIZE][3];
+  for (int start = 0; start < resolution * resolution; start += EVAL_CHUNK_SIZE) {
+    const int num_patch_coords = patch_resolution_coords_fill(
+        patch_coords, ptex_face_index, resolution, start);
+    BKE_subdiv_eval_limit_points_and_normals(subdiv, patch_coords, num_patch_coords, P, N);
+    for (int i = 0; i < num_patch_coords; i++) {
       short normal[3];
-      BKE_subdiv_eval_limit_point_and_short_normal(
-          subdiv, ptex_face_index, u, v, point_buffer, normal);
+      normal_float_to_short_v3(normal, N[i]);
+      buffer_write_float_value(&point_buffer, P[i], 3);
       buffer_write_short_value(&normal_buffer, normal, 3);
       buffer_apply_offset(&point_buffer, point_stride);
       buffer_apply_offset(&normal_buffer, normal_stride);
@@ -0,0 +1,223 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <vector>
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_subdiv.h"
+#include "BKE_subdiv_eval.h"
+
+#include "BLI_math.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "opensubdiv_capi_type.h"
+#include "opensubdiv_evaluator_capi.h"
+
+#ifdef WITH_OPENSUBDIV
+
+namespace blender::bke::tests {
+
+static const float cube_coords[8][3] = {
+    {-1.0f, -1.0f, -1.0f},
+    {-1.0f, -1.0f, 1.0f},
+    {-1.0f, 1.0f, -1.0f},
+    {-1.0f, 1.0f, 1.0f},
+    {1.0f, -1.0f, -1.0f},
+    {1.0f, -1.0f, 1.0f},
+    {1.0f, 1.0f, -1.0f},
+    {1.0f, 1.0f, 1.0f},
+};
+static const int cube_quads[6][4] = {
+    {0, 1, 3, 2},
+    {2, 3, 7, 6},
+    {6, 7, 5, 4},
+    {4, 5, 1, 0},
+    {2, 6, 4, 0},
+    {7, 3, 1, 5},
+};
+
+/* Quad with its first two corners at the same position, derivatives along its first edge are
+ * zero. */
+static const float collapsed_quad_coords[4][3] = {
+    {0.0f, 0.0f, 0.0f},
+    {0.0f, 0.0f, 0.0f},
+    {1.0f, 1.0f, 0.0f},
+    {0.0f, 1.0f, 0.0f},
+};
+static const int collapsed_quad_quads[1][4] = {{0, 1, 2, 3}};
+
+class SubdivEvalTest : public testing::Test {
+ protected:
+  Mesh *mesh = nullptr;
+  Subdiv *subdiv = nullptr;
+
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+
+  void TearDown() override
+  {
+    if (subdiv != nullptr) {
+      BKE_subdiv_free(subdiv);
+    }
+    if (mesh != nullptr) {
+      BKE_id_free(nullptr, mesh);
+    }
+  }
+
+  /* Mesh of quads, every quad is its own UV island. */
+  void mesh_create(const float (*coords)[3],
+                   const int num_verts,
+                   const int (*quads)[4],
+                   const int num_quads)
+  {
+    mesh = BKE_mesh_new_nomain(num_verts, 0, 0, num_quads * 4, num_quads);
+    MLoopUV *mloopuv = static_cast<MLoopUV *>(
+        CustomData_add_layer(&mesh->ldata, CD_MLOOPUV, CD_CALLOC, nullptr, num_quads * 4));
+    for (int i = 0; i < num_verts; i++) {
+      copy_v3_v3(mesh->mvert[i].co, coords[i]);
+    }
+    for (int i = 0; i < num_quads; i++) {
+      mesh->mpoly[i].loopstart = i * 4;
+      mesh->mpoly[i].totloop = 4;
+      for (int j = 0; j < 4; j++) {
+        mesh->mloop[i * 4 + j].v = quads[i][j];
+        mloopuv[i * 4 + j].uv[0] = i * 1.5f + ((j == 1 || j == 2) ? 1.0f : 0.0f);
+        mloopuv[i * 4 + j].uv[1] = (j >= 2) ? 1.0f : 0.0f;
+      }
+    }
+    BKE_mesh_calc_edges(mesh, false, false);
+  }
+
+  void subdiv_create(const bool is_simple)
+  {
+    SubdivSettings settings = {0};
+    settings.is_simple = is_simple;
+    settings.is_adaptive = true;
+    settings.level = 2;
+    settings.use_creases = true;
+    settings.vtx_boundary_interpolation = SUBDIV_VTX_BOUNDARY_EDGE_AND_CORNER;
+    settings.fvar_linear_interpolation = SUBDIV_FVAR_LINEAR_INTERPOLATION_BOUNDARIES;
+    subdiv = BKE_subdiv_new_from_mesh(&settings, mesh);
+    ASSERT_NE(subdiv, nullptr);
+    ASSERT_TRUE(BKE_subdiv_eval_begin_from_mesh(subdiv, mesh, nullptr));
+  }
+
+  /* Grid of coordinates on every ptex face, including the patch boundaries and corners. */
+  static std::vector<OpenSubdiv_PatchCoord> patch_coords_create(const int num_ptex_faces)
+  {
+    const int resolution = 5;
+    std::vector<OpenSubdiv_PatchCoord> patch_coords;
+    for (int ptex_face_index = 0; ptex_face_index < num_ptex_faces; ptex_face_index++) {
+      for (int y = 0; y < resolution; y++) {
+        for (int x = 0; x < resolution; x++) {
+          OpenSubdiv_PatchCoord patch_coord;
+          patch_coord.ptex_face = ptex_face_index;
+          patch_coord.u = (float)x / (resolution - 1);
+          patch_coord.v = (float)y / (resolution - 1);
+          patch_coords.push_back(patch_coord);
+        }
+      }
+    }
+    return patch_coords;
+  }
+
+  /* Batched evaluation must give the same results as evaluating one point at a time. */
+  void expect_batched_equals_single(const std::vector<OpenSubdiv_PatchCoord> &patch_coords)
+  {
+    const int num_coords = patch_coords.size();
+    std::vector<float> P(num_coords * 3), dPdu(num_coords * 3), dPdv(num_coords * 3);
+    std::vector<float> N(num_coords * 3), uv(num_coords * 2);
+
+    BKE_subdiv_eval_limit_points_and_derivatives(subdiv,
+                                                 patch_coords.data(),
+                                                 num_coords,
+                                                 (float(*)[3])P.data(),
+                                                 (float(*)[3])dPdu.data(),
+                                                 (float(*)[3])dPdv.data());
+    for (int i = 0; i < num_coords; i++) {
+      const OpenSubdiv_PatchCoord &coord = patch_coords[i];
+      float single_P[3], single_dPdu[3], single_dPdv[3];
+      BKE_subdiv_eval_limit_point_and_derivatives(
+          subdiv, coord.ptex_face, coord.u, coord.v, single_P, single_dPdu, single_dPdv);
+      const float *batched_P = &P[i * 3], *batched_dPdu = &dPdu[i * 3],
+                  *batched_dPdv = &dPdv[i * 3];
+      EXPECT_V3_NEAR(batched_P, single_P, 1e-6f);
+      EXPECT_V3_NEAR(batched_dPdu, single_dPdu, 1e-6f);
+      EXPECT_V3_NEAR(batched_dPdv, single_dPdv, 1e-6f);
+      /* Degenerate derivatives are replaced in both cases. */
+      EXPECT_FALSE(is_zero_v3(batched_dPdu));
+      EXPECT_FALSE(is_zero_v3(batched_dPdv));
+    }
+
+    BKE_subdiv_eval_limit_points_and_normals(
+        subdiv, patch_coords.data(), num_coords, (float(*)[3])P.data(), (float(*)[3])N.data());
+    for (int i = 0; i < num_coords; i++) {
+      const OpenSubdiv_PatchCoord &coord = patch_coords[i];
+      float single_P[3], single_N[3];
+      BKE_subdiv_eval_limit_point_and_normal(
+          subdiv, coord.ptex_face, coord.u, coord.v, single_P, single_N);
+      const float *batched_P = &P[i * 3], *batched_N = &N[i * 3];
+      EXPECT_V3_NEAR(batched_P, single_P, 1e-6f);
+      EXPECT_V3_NEAR(batched_N, single_N, 1e-6f);
+    }
+
+    BKE_subdiv_eval_face_varying_points(
+        subdiv, 0, patch_coords.data(), num_coords, (float(*)[2])uv.data());
+    for (int i = 0; i < num_coords; i++) {
+      const OpenSubdiv_PatchCoord &coord = patch_coords[i];
+      float single_uv[2];
+      BKE_subdiv_eval_face_varying(subdiv, 0, coord.ptex_face, coord.u, coord.v, single_uv);
+      EXPECT_NEAR(uv[i * 2], single_uv[0], 1e-6f);
+      EXPECT_NEAR(uv[i * 2 + 1], single_uv[1], 1e-6f);
+    }
+  }
+};
+
+TEST_F(SubdivEvalTest, BatchedMatchesSingle)
+{
+  mesh_create(cube_coords, 8, cube_quads, 6);
+  subdiv_create(false);
+  /* One ptex face per quad. */
+  expect_batched_equals_single(patch_coords_create(6));
+}
+
+TEST_F(SubdivEvalTest, BatchedDegenerateDerivatives)
+{
+  mesh_create(collapsed_quad_coords, 4, collapsed_quad_quads, 1);
+  subdiv_create(true);
+
+  /* The evaluator gives unusable derivatives on the collapsed edge, they are replaced by
+   * derivatives of a point slightly inside of the face. */
+  float P[3], dPdu[3], dPdv[3];
+  subdiv->evaluator->evaluateLimit(subdiv->evaluator, 0, 0.5f, 0.0f, P, dPdu, dPdv);
+  EXPECT_TRUE(is_zero_v3(dPdu));
+
+  expect_batched_equals_single(patch_coords_create(1));
+}
+
+}  // namespace blender::bke::tests
+
+#endif /* WITH_OPENSUBDIV */
@@ -38,6 +38,8 @@
 #include "BKE_subdiv.h"
 #include "BKE_subdiv_mesh.h"
 
+#include "opensubdiv_capi_type.h"
+
 #include "MEM_guardedalloc.h"
 
 /* -------------------------------------------------------------------- */
@@ -625,6 +627,64 @@ static void subdiv_foreach_every_edge_vertices(SubdivForeachTaskContext *ctx, vo
 
 /* Traversal of inner vertices, they are coming from ptex patches. */
 
+/* Inner vertices which are collected for the batched callback. */
+typedef struct InnerVerticesChunk {
+  OpenSubdiv_PatchCoord patch_coords[SUBDIV_FOREACH_VERTICES_INNER_CHUNK_SIZE];
+  int num_vertices;
+  int start_subdiv_vertex_index;
+} InnerVerticesChunk;
+
+static void subdiv_foreach_inner_vertices_chunk_flush(SubdivForeachTaskContext *ctx,
+                                                      void *tls,
+                                                      const int coarse_poly_index,
+                                                      InnerVerticesChunk *chunk)
+{
+  if (chunk->num_vertices == 0) {
+    return;
+  }
+  ctx->foreach_context->vertices_inner(ctx->foreach_context,
+                                       tls,
+                                       coarse_poly_index,
+                                       chunk->patch_coords,
+                                       chunk->num_vertices,
+                                       chunk->start_subdiv_vertex_index);
+  chunk->start_subdiv_vertex_index += chunk->num_vertices;
+  chunk->num_vertices = 0;
+}
+
+static void subdiv_foreach_inner_vertex(SubdivForeachTaskContext *ctx,
+                                        void *tls,
+                                        InnerVerticesChunk *chunk,
+                                        const int ptex_face_index,
+                                        const float u,
+                                        const float v,
+                                        const int coarse_poly_index,
+                                        const int coarse_corner,
+                                        const int subdiv_vertex_index)
+{
+  if (ctx->foreach_context->vertex_inner != NULL) {
+    ctx->foreach_context->vertex_inner(ctx->foreach_context,
+                                       tls,
+                                       ptex_face_index,
+                                       u,
+                                       v,
+                                       coarse_poly_index,
+                                       coarse_corner,
+                                       subdiv_vertex_index);
+  }
+  if (ctx->foreach_context->vertices_inner != NULL) {
+    /* Inner vertices of a polygon have consecutive indices. */
+    BLI_assert(subdiv_vertex_index == chunk->start_subdiv_vertex_index + chunk->num_vertices);
+    OpenSubdiv_PatchCoord *patch_coord = &chunk->patch_coords[chunk->num_vertices++];
+    patch_coord->ptex_face = ptex_face_index;
+    patch_coord->u = u;
+    patch_coord->v = v;
+    if (chunk->num_vertices == SUBDIV_FOREACH_VERTICES_INNER_CHUNK_SIZE) {
+      subdiv_foreach_inner_vertices_chunk_flush(ctx, tls, coarse_poly_index, chunk);
+    }
+  }
+}
+
 static void subdiv_foreach_inner_vertices_regular(SubdivForeachTaskContext *ctx,
                                                   void *tls,
                                                   const MPoly *coarse_poly)
@@ -636,20 +696,20 @@ static void subdiv_foreach_inner_vertices_regular(SubdivForeachTaskContext *ctx,
   const int ptex_face_index = ctx->face_ptex_offset[coarse_poly_index];
   const int start_vertex_index = ctx->subdiv_vertex_offset[coarse_poly_index];
   int subdiv_vertex_index = ctx->vertices_inner_offset + start_vertex_index;
+  InnerVerticesChunk chunk;
+  chunk.num_vertices = 0;
+  chunk.start_subdiv_vertex_index = subdiv_vertex_index;
   for (int y = 1; y < resolution - 1; y++) {
     const float v = y * inv_resolution_1;
     for (int x = 1; x < resolution - 1; x++, subdiv_vertex_index++) {
       const float u = x * inv_resolution_1;
-      ctx->foreach_context->vertex_inner(ctx->foreach_context,
-                                         tls,
-                                         ptex_face_index,
-                                         u,
-                                         v,
-                                         coarse_poly_index,
-                                         0,
-                                         subdiv_vertex_index);
+      subdiv_foreach_inner_vertex(
+          ctx, tls, &chunk, ptex_face_index, u, v, coarse_poly_index, 0, subdiv_vertex_index);
     }
   }
+  if (ctx->foreach_context->vertices_inner != NULL) {
+    subdiv_foreach_inner_vertices_chunk_flush(ctx, tls, coarse_poly_index, &chunk);
+  }
 }
 
 static void subdiv_foreach_inner_vertices_special(SubdivForeachTaskContext *ctx,
@@ -664,31 +724,32 @@ static void subdiv_foreach_inner_vertices_special(SubdivForeachTaskContext *ctx,
   int ptex_face_index = ctx->face_ptex_offset[coarse_poly_index];
   const int start_vertex_index = ctx->subdiv_vertex_offset[coarse_poly_index];
   int subdiv_vertex_index = ctx->vertices_inner_offset + start_vertex_index;
-  ctx->foreach_context->vertex_inner(ctx->foreach_context,
-                                     tls,
-                                     ptex_face_index,
-                                     1.0f,
-                                     1.0f,
-                                     coarse_poly_index,
-                                     0,
-                                     subdiv_vertex_index);
+  InnerVerticesChunk chunk;
+  chunk.num_vertices = 0;
+  chunk.start_subdiv_vertex_index = subdiv_vertex_index;
+  subdiv_foreach_inner_vertex(
+      ctx, tls, &chunk, ptex_face_index, 1.0f, 1.0f, coarse_poly_index, 0, subdiv_vertex_index);
   subdiv_vertex_index++;
   for (int corner = 0; corner < coarse_poly->totloop; corner++, ptex_face_index++) {
     for (int y = 1; y < ptex_face_resolution - 1; y++) {
       const float v = y * inv_ptex_face_resolution_1;
       for (int x = 1; x < ptex_face_resolution; x++, subdiv_vertex_index++) {
         const float u = x * inv_ptex_face_resolution_1;
-        ctx->foreach_context->vertex_inner(ctx->foreach_context,
-                                           tls,
-                                           ptex_face_index,
-                                           u,
-                                           v,
-                                           coarse_poly_index,
-                                           corner,
-                                           subdiv_vertex_index);
+        subdiv_foreach_inner_vertex(ctx,
+                                    tls,
+                                    &chunk,
+                                    ptex_face_index,
+                                    u,
+                                    v,
+                                    coarse_poly_index,
+                                    corner,
+                                    subdiv_vertex_index);
       }
     }
   }
+  if (ctx->foreach_context->vertices_inner != NULL) {
+    subdiv_foreach_inner_vertices_chunk_flush(ctx, tls, coarse_poly_index, &chunk);
+  }
 }
 
 static void subdiv_foreach_inner_vertices(SubdivForeachTaskContext *ctx,
@@ -709,7 +770,8 @@ static void subdiv_foreach_vertices(SubdivForeachTaskContext *ctx, void *tls, co
   const Mesh *coarse_mesh = ctx->coarse_mesh;
   const MPoly *coarse_mpoly = coarse_mesh->mpoly;
   const MPoly *coarse_poly = &coarse_mpoly[poly_index];
-  if (ctx->foreach_context->vertex_inner != NULL) {
+  if (ctx->foreach_context->vertex_inner != NULL ||
+      ctx->foreach_context->vertices_inner != NULL) {
     subdiv_foreach_inner_vertices(ctx, tls, coarse_poly);
   }
 }
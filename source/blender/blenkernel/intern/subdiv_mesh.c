@@ -41,6 +41,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "opensubdiv_capi_type.h"
+
 /* -------------------------------------------------------------------- */
 /** \name Subdivision Context
  * \{ */
@@ -425,6 +427,9 @@ static void loop_interpolation_end(LoopsForInterpolation *loop_interpolation)
 /** \name TLS
  * \{ */
 
+/* Number of loops which UVs are evaluated at once. */
+#define SUBDIV_MESH_UV_CHUNK_SIZE 256
+
 typedef struct SubdivMeshTLS {
   bool vertex_interpolation_initialized;
   VerticesForInterpolation vertex_interpolation;
@@ -435,11 +440,20 @@ typedef struct SubdivMeshTLS {
   LoopsForInterpolation loop_interpolation;
   const MPoly *loop_interpolation_coarse_poly;
   int loop_interpolation_coarse_corner;
+
+  /* Loops which UVs are not evaluated yet, see #subdiv_eval_uv_layers_flush. */
+  const struct SubdivMeshContext *uv_ctx;
+  OpenSubdiv_PatchCoord uv_patch_coords[SUBDIV_MESH_UV_CHUNK_SIZE];
+  int uv_loop_indices[SUBDIV_MESH_UV_CHUNK_SIZE];
+  int num_uv_loops;
 } SubdivMeshTLS;
 
+static void subdiv_eval_uv_layers_flush(SubdivMeshTLS *tls);
+
 static void subdiv_mesh_tls_free(void *tls_v)
 {
   SubdivMeshTLS *tls = tls_v;
+  subdiv_eval_uv_layers_flush(tls);
   if (tls->vertex_interpolation_initialized) {
     vertex_interpolation_end(&tls->vertex_interpolation);
   }
@@ -454,18 +468,27 @@ static void subdiv_mesh_tls_free(void *tls_v)
 /** \name Evaluation helper functions
  * \{ */
 
-static void eval_final_point_and_vertex_normal(Subdiv *subdiv,
-                                               const int ptex_face_index,
-                                               const float u,
-                                               const float v,
-                                               float r_P[3],
-                                               short r_N[3])
+/* Evaluate positions and normals of consecutive vertices. */
+static void eval_final_points_and_vertex_normals(Subdiv *subdiv,
+                                                 const struct OpenSubdiv_PatchCoord *patch_coords,
+                                                 const int num_vertices,
+                                                 MVert *subdiv_mvert)
 {
+  BLI_assert(num_vertices <= SUBDIV_FOREACH_VERTICES_INNER_CHUNK_SIZE);
+  float P[SUBDIV_FOREACH_VERTICES_INNER_CHUNK_SIZE][3];
   if (subdiv->displacement_evaluator == NULL) {
-    BKE_subdiv_eval_limit_point_and_short_normal(subdiv, ptex_face_index, u, v, r_P, r_N);
+    float N[SUBDIV_FOREACH_VERTICES_INNER_CHUNK_SIZE][3];
+    BKE_subdiv_eval_limit_points_and_normals(subdiv, patch_coords, num_vertices, P, N);
+    for (int i = 0; i < num_vertices; i++) {
+      copy_v3_v3(subdiv_mvert[i].co, P[i]);
+      normal_float_to_short_v3(subdiv_mvert[i].no, N[i]);
+    }
   }
   else {
-    BKE_subdiv_eval_final_point(subdiv, ptex_face_index, u, v, r_P);
+    BKE_subdiv_eval_final_points(subdiv, patch_coords, num_vertices, P);
+    for (int i = 0; i < num_vertices; i++) {
+      copy_v3_v3(subdiv_mvert[i].co, P[i]);
+    }
   }
 }
 
@@ -774,7 +797,7 @@ static void subdiv_mesh_tag_center_vertex(const MPoly *coarse_poly,
 
 static void subdiv_mesh_vertex_inner(const SubdivForeachContext *foreach_context,
                                      void *tls_v,
-                                     const int ptex_face_index,
+                                     const int UNUSED(ptex_face_index),
                                      const float u,
                                      const float v,
                                      const int coarse_poly_index,
@@ -783,7 +806,6 @@ static void subdiv_mesh_vertex_inner(const SubdivForeachContext *foreach_context
 {
   SubdivMeshContext *ctx = foreach_context->user_data;
   SubdivMeshTLS *tls = tls_v;
-  Subdiv *subdiv = ctx->subdiv;
   const Mesh *coarse_mesh = ctx->coarse_mesh;
   const MPoly *coarse_mpoly = coarse_mesh->mpoly;
   const MPoly *coarse_poly = &coarse_mpoly[coarse_poly_index];
@@ -792,11 +814,25 @@ static void subdiv_mesh_vertex_inner(const SubdivForeachContext *foreach_context
   MVert *subdiv_vert = &subdiv_mvert[subdiv_vertex_index];
   subdiv_mesh_ensure_vertex_interpolation(ctx, tls, coarse_poly, coarse_corner);
   subdiv_vertex_data_interpolate(ctx, subdiv_vert, &tls->vertex_interpolation, u, v);
-  eval_final_point_and_vertex_normal(
-      subdiv, ptex_face_index, u, v, subdiv_vert->co, subdiv_vert->no);
   subdiv_mesh_tag_center_vertex(coarse_poly, subdiv_vert, u, v);
 }
 
+/* Positions and normals of inner vertices are evaluated in batches, see vertex_inner for the
+ * rest of the vertex data. */
+static void subdiv_mesh_vertices_inner(const SubdivForeachContext *foreach_context,
+                                       void *UNUSED(tls),
+                                       const int UNUSED(coarse_poly_index),
+                                       const struct OpenSubdiv_PatchCoord *patch_coords,
+                                       const int num_vertices,
+                                       const int start_subdiv_vertex_index)
+{
+  SubdivMeshContext *ctx = foreach_context->user_data;
+  eval_final_points_and_vertex_normals(ctx->subdiv,
+                                       patch_coords,
+                                       num_vertices,
+                                       &ctx->subdiv_mesh->mvert[start_subdiv_vertex_index]);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -872,7 +908,29 @@ static void subdiv_interpolate_loop_data(const SubdivMeshContext *ctx,
   /* TODO(sergey): Set ORIGINDEX. */
 }
 
+/* Evaluate UVs of the queued loops, all UV layers at once. */
+static void subdiv_eval_uv_layers_flush(SubdivMeshTLS *tls)
+{
+  if (tls->num_uv_loops == 0) {
+    return;
+  }
+  const SubdivMeshContext *ctx = tls->uv_ctx;
+  float uv[SUBDIV_MESH_UV_CHUNK_SIZE][2];
+  for (int layer_index = 0; layer_index < ctx->num_uv_layers; layer_index++) {
+    BKE_subdiv_eval_face_varying_points(
+        ctx->subdiv, layer_index, tls->uv_patch_coords, tls->num_uv_loops, uv);
+    MLoopUV *subdiv_loopuv = ctx->uv_layers[layer_index];
+    for (int i = 0; i < tls->num_uv_loops; i++) {
+      copy_v2_v2(subdiv_loopuv[tls->uv_loop_indices[i]].uv, uv[i]);
+    }
+  }
+  tls->num_uv_loops = 0;
+}
+
+/* Queue the loop for UV evaluation. Loops are evaluated in batches when the queue is full and
+ * when the TLS is freed at the end of the traversal. */
 static void subdiv_eval_uv_layer(SubdivMeshContext *ctx,
+                                 SubdivMeshTLS *tls,
                                  MLoop *subdiv_loop,
                                  const int ptex_face_index,
                                  const float u,
@@ -881,12 +939,16 @@ static void subdiv_eval_uv_layer(SubdivMeshContext *ctx,
   if (ctx->num_uv_layers == 0) {
     return;
   }
-  Subdiv *subdiv = ctx->subdiv;
-  const int mloop_index = subdiv_loop - ctx->subdiv_mesh->mloop;
-  for (int layer_index = 0; layer_index < ctx->num_uv_layers; layer_index++) {
-    MLoopUV *subdiv_loopuv = &ctx->uv_layers[layer_index][mloop_index];
-    BKE_subdiv_eval_face_varying(subdiv, layer_index, ptex_face_index, u, v, subdiv_loopuv->uv);
+  if (tls->num_uv_loops == SUBDIV_MESH_UV_CHUNK_SIZE) {
+    subdiv_eval_uv_layers_flush(tls);
   }
+  tls->uv_ctx = ctx;
+  OpenSubdiv_PatchCoord *patch_coord = &tls->uv_patch_coords[tls->num_uv_loops];
+  patch_coord->ptex_face = ptex_face_index;
+  patch_coord->u = u;
+  patch_coord->v = v;
+  tls->uv_loop_indices[tls->num_uv_loops] = subdiv_loop - ctx->subdiv_mesh->mloop;
+  tls->num_uv_loops++;
 }
 
 static void subdiv_mesh_ensure_loop_interpolation(SubdivMeshContext *ctx,
@@ -939,7 +1001,7 @@ static void subdiv_mesh_loop(const SubdivForeachContext *foreach_context,
   MLoop *subdiv_loop = &subdiv_mloop[subdiv_loop_index];
   subdiv_mesh_ensure_loop_interpolation(ctx, tls, coarse_poly, coarse_corner);
   subdiv_interpolate_loop_data(ctx, subdiv_loop, &tls->loop_interpolation, u, v);
-  subdiv_eval_uv_layer(ctx, subdiv_loop, ptex_face_index, u, v);
+  subdiv_eval_uv_layer(ctx, tls, subdiv_loop, ptex_face_index, u, v);
   subdiv_loop->v = subdiv_vertex_index;
   subdiv_loop->e = subdiv_edge_index;
 }
@@ -1156,6 +1218,192 @@ static void subdiv_mesh_vertex_of_loose_edge(const struct SubdivForeachContext *
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Topology cache
+ *
+ * Edges, loops and polygons of the subdivided mesh (together with their custom
+ * data) only depend on the coarse edges, loops and polygons and on the mesh
+ * settings. They are kept on the #Subdiv and copied as-is while those don't
+ * change, so animated meshes only evaluate the subdivided vertices again.
+ *
+ * The cache holds a second copy of this data, so it's only kept for meshes up to
+ * #SUBDIV_MESH_TOPOLOGY_CACHE_MAX_LOOPS subdivided loops.
+ * \{ */
+
+/* Around 64 MB for a mesh with a single UV map. */
+#define SUBDIV_MESH_TOPOLOGY_CACHE_MAX_LOOPS (1 << 21)
+
+typedef struct SubdivMeshTopologyCache {
+  SubdivToMeshSettings settings;
+  /* Coarse data the cache was created from. */
+  int coarse_totvert;
+  int coarse_totedge;
+  int coarse_totloop;
+  int coarse_totpoly;
+  CustomData coarse_edata;
+  CustomData coarse_ldata;
+  CustomData coarse_pdata;
+  /* Subdivided geometry. */
+  int num_vertices;
+  int num_edges;
+  int num_loops;
+  int num_polygons;
+  CustomData edata;
+  CustomData ldata;
+  CustomData pdata;
+} SubdivMeshTopologyCache;
+
+static bool subdiv_mesh_custom_data_equal(const CustomData *data_a,
+                                          const CustomData *data_b,
+                                          const int num_elements)
+{
+  if (data_a->totlayer != data_b->totlayer) {
+    return false;
+  }
+  for (int layer_index = 0; layer_index < data_a->totlayer; layer_index++) {
+    const CustomDataLayer *layer_a = &data_a->layers[layer_index];
+    const CustomDataLayer *layer_b = &data_b->layers[layer_index];
+    if (layer_a->type != layer_b->type || !STREQ(layer_a->name, layer_b->name)) {
+      return false;
+    }
+    if (layer_a->data == NULL || layer_b->data == NULL) {
+      if (layer_a->data != layer_b->data) {
+        return false;
+      }
+      continue;
+    }
+    const size_t size = (size_t)CustomData_sizeof(layer_a->type) * num_elements;
+    if (memcmp(layer_a->data, layer_b->data, size) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Multi-resolution grids store pointers, comparing them would never match. */
+static bool subdiv_mesh_topology_cache_supported(const Mesh *coarse_mesh)
+{
+  return !CustomData_has_layer(&coarse_mesh->ldata, CD_MDISPS) &&
+         !CustomData_has_layer(&coarse_mesh->ldata, CD_GRID_PAINT_MASK);
+}
+
+static bool subdiv_mesh_topology_cache_is_valid(const Subdiv *subdiv,
+                                                const SubdivToMeshSettings *settings,
+                                                const Mesh *coarse_mesh)
+{
+  const SubdivMeshTopologyCache *cache = subdiv->cache_.mesh_topology;
+  if (cache == NULL) {
+    return false;
+  }
+  if (cache->settings.resolution != settings->resolution ||
+      cache->settings.use_optimal_display != settings->use_optimal_display) {
+    return false;
+  }
+  if (cache->coarse_totvert != coarse_mesh->totvert ||
+      cache->coarse_totedge != coarse_mesh->totedge ||
+      cache->coarse_totloop != coarse_mesh->totloop ||
+      cache->coarse_totpoly != coarse_mesh->totpoly) {
+    return false;
+  }
+  return subdiv_mesh_custom_data_equal(
+             &cache->coarse_edata, &coarse_mesh->edata, coarse_mesh->totedge) &&
+         subdiv_mesh_custom_data_equal(
+             &cache->coarse_ldata, &coarse_mesh->ldata, coarse_mesh->totloop) &&
+         subdiv_mesh_custom_data_equal(
+             &cache->coarse_pdata, &coarse_mesh->pdata, coarse_mesh->totpoly);
+}
+
+static void subdiv_mesh_topology_cache_store(Subdiv *subdiv,
+                                             const SubdivToMeshSettings *settings,
+                                             const Mesh *coarse_mesh,
+                                             const Mesh *subdiv_mesh)
+{
+  BKE_subdiv_mesh_topology_cache_free(subdiv);
+  if (subdiv_mesh->totloop > SUBDIV_MESH_TOPOLOGY_CACHE_MAX_LOOPS) {
+    return;
+  }
+  SubdivMeshTopologyCache *cache = MEM_callocN(sizeof(*cache), "subdiv mesh topology cache");
+  cache->settings = *settings;
+  cache->coarse_totvert = coarse_mesh->totvert;
+  cache->coarse_totedge = coarse_mesh->totedge;
+  cache->coarse_totloop = coarse_mesh->totloop;
+  cache->coarse_totpoly = coarse_mesh->totpoly;
+  CustomData_copy(&coarse_mesh->edata,
+                  &cache->coarse_edata,
+                  CD_MASK_EVERYTHING.emask,
+                  CD_DUPLICATE,
+                  coarse_mesh->totedge);
+  CustomData_copy(&coarse_mesh->ldata,
+                  &cache->coarse_ldata,
+                  CD_MASK_EVERYTHING.lmask,
+                  CD_DUPLICATE,
+                  coarse_mesh->totloop);
+  CustomData_copy(&coarse_mesh->pdata,
+                  &cache->coarse_pdata,
+                  CD_MASK_EVERYTHING.pmask,
+                  CD_DUPLICATE,
+                  coarse_mesh->totpoly);
+  cache->num_vertices = subdiv_mesh->totvert;
+  cache->num_edges = subdiv_mesh->totedge;
+  cache->num_loops = subdiv_mesh->totloop;
+  cache->num_polygons = subdiv_mesh->totpoly;
+  CustomData_copy(&subdiv_mesh->edata,
+                  &cache->edata,
+                  CD_MASK_EVERYTHING.emask,
+                  CD_DUPLICATE,
+                  subdiv_mesh->totedge);
+  CustomData_copy(&subdiv_mesh->ldata,
+                  &cache->ldata,
+                  CD_MASK_EVERYTHING.lmask,
+                  CD_DUPLICATE,
+                  subdiv_mesh->totloop);
+  CustomData_copy(&subdiv_mesh->pdata,
+                  &cache->pdata,
+                  CD_MASK_EVERYTHING.pmask,
+                  CD_DUPLICATE,
+                  subdiv_mesh->totpoly);
+  subdiv->cache_.mesh_topology = cache;
+}
+
+void BKE_subdiv_mesh_topology_cache_free(Subdiv *subdiv)
+{
+  SubdivMeshTopologyCache *cache = subdiv->cache_.mesh_topology;
+  if (cache == NULL) {
+    return;
+  }
+  CustomData_free(&cache->coarse_edata, cache->coarse_totedge);
+  CustomData_free(&cache->coarse_ldata, cache->coarse_totloop);
+  CustomData_free(&cache->coarse_pdata, cache->coarse_totpoly);
+  CustomData_free(&cache->edata, cache->num_edges);
+  CustomData_free(&cache->ldata, cache->num_loops);
+  CustomData_free(&cache->pdata, cache->num_polygons);
+  MEM_freeN(cache);
+  subdiv->cache_.mesh_topology = NULL;
+}
+
+static bool subdiv_mesh_topology_info_from_cache(const SubdivForeachContext *foreach_context,
+                                                 const int num_vertices,
+                                                 const int num_edges,
+                                                 const int num_loops,
+                                                 const int num_polygons)
+{
+  SubdivMeshContext *subdiv_context = foreach_context->user_data;
+  const SubdivMeshTopologyCache *cache = subdiv_context->subdiv->cache_.mesh_topology;
+  BLI_assert(num_vertices == cache->num_vertices && num_edges == cache->num_edges &&
+             num_loops == cache->num_loops && num_polygons == cache->num_polygons);
+  if (!subdiv_mesh_topology_info(
+          foreach_context, num_vertices, num_edges, num_loops, num_polygons)) {
+    return false;
+  }
+  Mesh *subdiv_mesh = subdiv_context->subdiv_mesh;
+  CustomData_copy_data(&cache->edata, &subdiv_mesh->edata, 0, 0, num_edges);
+  CustomData_copy_data(&cache->ldata, &subdiv_mesh->ldata, 0, 0, num_loops);
+  CustomData_copy_data(&cache->pdata, &subdiv_mesh->pdata, 0, 0, num_polygons);
+  return true;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Initialization
  * \{ */
@@ -1178,6 +1426,7 @@ static void setup_foreach_callbacks(const SubdivMeshContext *subdiv_context,
   foreach_context->vertex_corner = subdiv_mesh_vertex_corner;
   foreach_context->vertex_edge = subdiv_mesh_vertex_edge;
   foreach_context->vertex_inner = subdiv_mesh_vertex_inner;
+  foreach_context->vertices_inner = subdiv_mesh_vertices_inner;
   foreach_context->edge = subdiv_mesh_edge;
   foreach_context->loop = subdiv_mesh_loop;
   foreach_context->poly = subdiv_mesh_poly;
@@ -1186,6 +1435,17 @@ static void setup_foreach_callbacks(const SubdivMeshContext *subdiv_context,
   foreach_context->user_data_tls_free = subdiv_mesh_tls_free;
 }
 
+/* Only vertices are evaluated, the rest of the geometry is copied from the topology cache. */
+static void setup_foreach_callbacks_from_topology_cache(const SubdivMeshContext *subdiv_context,
+                                                        SubdivForeachContext *foreach_context)
+{
+  setup_foreach_callbacks(subdiv_context, foreach_context);
+  foreach_context->topology_info = subdiv_mesh_topology_info_from_cache;
+  foreach_context->edge = NULL;
+  foreach_context->loop = NULL;
+  foreach_context->poly = NULL;
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -1218,10 +1478,19 @@ Mesh *BKE_subdiv_to_mesh(Subdiv *subdiv,
   subdiv_context.have_displacement = (subdiv->displacement_evaluator != NULL);
   subdiv_context.can_evaluate_normals = !subdiv_context.have_displacement &&
                                         subdiv_context.subdiv->settings.is_adaptive;
+  const bool use_topology_cache = subdiv_mesh_topology_cache_supported(coarse_mesh);
+  const bool is_topology_cached = use_topology_cache &&
+                                  subdiv_mesh_topology_cache_is_valid(
+                                      subdiv, settings, coarse_mesh);
   /* Multi-threaded traversal/evaluation. */
   BKE_subdiv_stats_begin(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH_GEOMETRY);
   SubdivForeachContext foreach_context;
-  setup_foreach_callbacks(&subdiv_context, &foreach_context);
+  if (is_topology_cached) {
+    setup_foreach_callbacks_from_topology_cache(&subdiv_context, &foreach_context);
+  }
+  else {
+    setup_foreach_callbacks(&subdiv_context, &foreach_context);
+  }
   SubdivMeshTLS tls = {0};
   foreach_context.user_data = &subdiv_context;
   foreach_context.user_data_tls_size = sizeof(SubdivMeshTLS);
@@ -1229,6 +1498,9 @@ Mesh *BKE_subdiv_to_mesh(Subdiv *subdiv,
   BKE_subdiv_foreach_subdiv_geometry(subdiv, &foreach_context, settings, coarse_mesh);
   BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH_GEOMETRY);
   Mesh *result = subdiv_context.subdiv_mesh;
+  if (use_topology_cache && !is_topology_cached) {
+    subdiv_mesh_topology_cache_store(subdiv, settings, coarse_mesh, result);
+  }
   // BKE_mesh_validate(result, true, true);
   BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH);
   if (!subdiv_context.can_evaluate_normals) {
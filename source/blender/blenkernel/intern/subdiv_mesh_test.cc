@@ -0,0 +1,240 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_subdiv.h"
+#include "BKE_subdiv_mesh.h"
+
+#include "BLI_assert.h"
+#include "BLI_math.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#ifdef WITH_OPENSUBDIV
+
+namespace blender::bke::tests {
+
+static const float cube_coords[8][3] = {
+    {-1.0f, -1.0f, -1.0f},
+    {-1.0f, -1.0f, 1.0f},
+    {-1.0f, 1.0f, -1.0f},
+    {-1.0f, 1.0f, 1.0f},
+    {1.0f, -1.0f, -1.0f},
+    {1.0f, -1.0f, 1.0f},
+    {1.0f, 1.0f, -1.0f},
+    {1.0f, 1.0f, 1.0f},
+};
+static const int cube_quads[6][4] = {
+    {0, 1, 3, 2},
+    {2, 3, 7, 6},
+    {6, 7, 5, 4},
+    {4, 5, 1, 0},
+    {2, 6, 4, 0},
+    {7, 3, 1, 5},
+};
+
+class SubdivMeshTest : public testing::Test {
+ protected:
+  SubdivSettings settings = {0};
+  SubdivToMeshSettings mesh_settings = {0};
+
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+
+  void SetUp() override
+  {
+    settings.is_simple = false;
+    settings.is_adaptive = true;
+    settings.level = 2;
+    settings.use_creases = true;
+    settings.vtx_boundary_interpolation = SUBDIV_VTX_BOUNDARY_EDGE_ONLY;
+    settings.fvar_linear_interpolation = SUBDIV_FVAR_LINEAR_INTERPOLATION_BOUNDARIES;
+    mesh_settings.resolution = (1 << settings.level) + 1;
+    mesh_settings.use_optimal_display = false;
+  }
+
+  /* Cube made of the first `num_quads` quads, every quad is its own UV island. */
+  static Mesh *cube_mesh_create(const int num_quads)
+  {
+    const int num_loops = num_quads * 4;
+    MEdge medges[12];
+    int totedge = 0;
+    Mesh *mesh = BKE_mesh_new_nomain(8, 12, 0, num_loops, num_quads);
+    MLoopUV *mloopuv = static_cast<MLoopUV *>(
+        CustomData_add_layer(&mesh->ldata, CD_MLOOPUV, CD_CALLOC, nullptr, num_loops));
+
+    for (int i = 0; i < 8; i++) {
+      copy_v3_v3(mesh->mvert[i].co, cube_coords[i]);
+    }
+    for (int i = 0; i < num_quads; i++) {
+      mesh->mpoly[i].loopstart = i * 4;
+      mesh->mpoly[i].totloop = 4;
+      for (int j = 0; j < 4; j++) {
+        const uint v1 = cube_quads[i][j];
+        const uint v2 = cube_quads[i][(j + 1) % 4];
+        int e = 0;
+        while (e < totedge && !((medges[e].v1 == v1 && medges[e].v2 == v2) ||
+                                (medges[e].v1 == v2 && medges[e].v2 == v1))) {
+          e++;
+        }
+        if (e == totedge) {
+          medges[e].v1 = v1;
+          medges[e].v2 = v2;
+          totedge++;
+        }
+        mesh->mloop[i * 4 + j].v = v1;
+        mesh->mloop[i * 4 + j].e = e;
+        mloopuv[i * 4 + j].uv[0] = i * 1.5f + ((j == 1 || j == 2) ? 1.0f : 0.0f);
+        mloopuv[i * 4 + j].uv[1] = (j >= 2) ? 1.0f : 0.0f;
+      }
+    }
+
+    BLI_assert(totedge == mesh->totedge);
+    for (int e = 0; e < totedge; e++) {
+      mesh->medge[e].v1 = medges[e].v1;
+      mesh->medge[e].v2 = medges[e].v2;
+      mesh->medge[e].flag = ME_EDGEDRAW | ME_EDGERENDER;
+    }
+    return mesh;
+  }
+
+  /* Subdivide with a new descriptor, so nothing is taken from the topology cache. */
+  Mesh *subdiv_mesh_uncached(const Mesh *coarse_mesh)
+  {
+    Subdiv *subdiv = BKE_subdiv_new_from_mesh(&settings, coarse_mesh);
+    Mesh *result = BKE_subdiv_to_mesh(subdiv, &mesh_settings, coarse_mesh);
+    BKE_subdiv_free(subdiv);
+    return result;
+  }
+
+  /* Subdivide like the modifier does, re-using the descriptor when the topology allows it. */
+  Mesh *subdiv_mesh_update(Subdiv **subdiv, const Mesh *coarse_mesh)
+  {
+    *subdiv = BKE_subdiv_update_from_mesh(*subdiv, &settings, coarse_mesh);
+    return BKE_subdiv_to_mesh(*subdiv, &mesh_settings, coarse_mesh);
+  }
+
+  static void expect_mesh_equal(const Mesh *a, const Mesh *b)
+  {
+    ASSERT_EQ(a->totvert, b->totvert);
+    ASSERT_EQ(a->totedge, b->totedge);
+    ASSERT_EQ(a->totloop, b->totloop);
+    ASSERT_EQ(a->totpoly, b->totpoly);
+    for (int i = 0; i < a->totvert; i++) {
+      EXPECT_V3_NEAR(a->mvert[i].co, b->mvert[i].co, 1e-6f);
+    }
+    for (int i = 0; i < a->totedge; i++) {
+      EXPECT_EQ(a->medge[i].v1, b->medge[i].v1);
+      EXPECT_EQ(a->medge[i].v2, b->medge[i].v2);
+      EXPECT_EQ(a->medge[i].flag, b->medge[i].flag);
+    }
+    for (int i = 0; i < a->totloop; i++) {
+      EXPECT_EQ(a->mloop[i].v, b->mloop[i].v);
+      EXPECT_EQ(a->mloop[i].e, b->mloop[i].e);
+    }
+    for (int i = 0; i < a->totpoly; i++) {
+      EXPECT_EQ(a->mpoly[i].loopstart, b->mpoly[i].loopstart);
+      EXPECT_EQ(a->mpoly[i].totloop, b->mpoly[i].totloop);
+    }
+    const MLoopUV *uv_a = static_cast<const MLoopUV *>(
+        CustomData_get_layer(&a->ldata, CD_MLOOPUV));
+    const MLoopUV *uv_b = static_cast<const MLoopUV *>(
+        CustomData_get_layer(&b->ldata, CD_MLOOPUV));
+    ASSERT_NE(uv_a, nullptr);
+    ASSERT_NE(uv_b, nullptr);
+    for (int i = 0; i < a->totloop; i++) {
+      EXPECT_NEAR(uv_a[i].uv[0], uv_b[i].uv[0], 1e-6f);
+      EXPECT_NEAR(uv_a[i].uv[1], uv_b[i].uv[1], 1e-6f);
+    }
+  }
+};
+
+TEST_F(SubdivMeshTest, TopologyCacheMovedVertices)
+{
+  Mesh *coarse_mesh = cube_mesh_create(6);
+  Subdiv *subdiv = nullptr;
+
+  Mesh *first = subdiv_mesh_update(&subdiv, coarse_mesh);
+  ASSERT_NE(first, nullptr);
+  EXPECT_NE(subdiv->cache_.mesh_topology, nullptr);
+
+  coarse_mesh->mvert[7].co[2] += 0.5f;
+  coarse_mesh->mvert[0].co[0] -= 0.25f;
+
+  Subdiv *subdiv_before = subdiv;
+  Mesh *cached = subdiv_mesh_update(&subdiv, coarse_mesh);
+  EXPECT_EQ(subdiv, subdiv_before);
+  Mesh *uncached = subdiv_mesh_uncached(coarse_mesh);
+  expect_mesh_equal(cached, uncached);
+
+  BKE_id_free(nullptr, first);
+  BKE_id_free(nullptr, cached);
+  BKE_id_free(nullptr, uncached);
+  BKE_subdiv_free(subdiv);
+  BKE_id_free(nullptr, coarse_mesh);
+}
+
+TEST_F(SubdivMeshTest, TopologyCacheInvalidation)
+{
+  Mesh *coarse_mesh = cube_mesh_create(6);
+  Subdiv *subdiv = nullptr;
+  BKE_id_free(nullptr, subdiv_mesh_update(&subdiv, coarse_mesh));
+
+  /* Moved UVs, islands stay the same. */
+  MLoopUV *mloopuv = static_cast<MLoopUV *>(
+      CustomData_get_layer(&coarse_mesh->ldata, CD_MLOOPUV));
+  for (int i = 0; i < 4; i++) {
+    mloopuv[i].uv[1] += 0.5f;
+  }
+  Mesh *cached = subdiv_mesh_update(&subdiv, coarse_mesh);
+  Mesh *uncached = subdiv_mesh_uncached(coarse_mesh);
+  expect_mesh_equal(cached, uncached);
+  BKE_id_free(nullptr, cached);
+  BKE_id_free(nullptr, uncached);
+
+  /* Seam, the flag is passed on to the subdivided edges. */
+  coarse_mesh->medge[0].flag |= ME_SEAM;
+  cached = subdiv_mesh_update(&subdiv, coarse_mesh);
+  uncached = subdiv_mesh_uncached(coarse_mesh);
+  expect_mesh_equal(cached, uncached);
+  BKE_id_free(nullptr, cached);
+  BKE_id_free(nullptr, uncached);
+
+  /* Topology, one of the quads is removed. */
+  Mesh *open_mesh = cube_mesh_create(5);
+  cached = subdiv_mesh_update(&subdiv, open_mesh);
+  uncached = subdiv_mesh_uncached(open_mesh);
+  expect_mesh_equal(cached, uncached);
+  BKE_id_free(nullptr, cached);
+  BKE_id_free(nullptr, uncached);
+
+  BKE_subdiv_free(subdiv);
+  BKE_id_free(nullptr, open_mesh);
+  BKE_id_free(nullptr, coarse_mesh);
+}
+
+}  // namespace blender::bke::tests
+
+#endif /* WITH_OPENSUBDIV */
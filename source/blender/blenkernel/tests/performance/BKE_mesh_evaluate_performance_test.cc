@@ -0,0 +1,74 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <math.h>
+#include <vector>
+
+#include "BKE_mesh.h"
+
+#include "DNA_meshdata_types.h"
+
+#include "PIL_time.h"
+
+#define NUM_RUN_AVERAGED 10
+
+/* Grid of quads with a wave displacement, so that vertex normals differ. */
+static void grid_create(const int size,
+                        std::vector<MVert> &mverts,
+                        std::vector<MLoop> &mloop,
+                        std::vector<MPoly> &mpolys)
+{
+  mverts.resize(size * size, MVert{{0}});
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      MVert &mv = mverts[y * size + x];
+      mv.co[0] = (float)x;
+      mv.co[1] = (float)y;
+      mv.co[2] = sinf((float)x * 0.3f) * cosf((float)y * 0.2f);
+    }
+  }
+  for (int y = 0; y < size - 1; y++) {
+    for (int x = 0; x < size - 1; x++) {
+      MPoly mp = {0};
+      mp.loopstart = (int)mloop.size();
+      mp.totloop = 4;
+      mpolys.push_back(mp);
+      const int quad[4] = {
+          y * size + x, y * size + x + 1, (y + 1) * size + x + 1, (y + 1) * size + x};
+      for (int j = 0; j < 4; j++) {
+        MLoop ml = {0};
+        ml.v = (uint)quad[j];
+        mloop.push_back(ml);
+      }
+    }
+  }
+}
+
+TEST(mesh_calc_normals_poly, Grid1024)
+{
+  std::vector<MVert> mverts;
+  std::vector<MLoop> mloop;
+  std::vector<MPoly> mpolys;
+  grid_create(1024, mverts, mloop, mpolys);
+
+  std::vector<float> vert_normals(mverts.size() * 3);
+  std::vector<float> poly_normals(mpolys.size() * 3);
+
+  const double start_time = PIL_check_seconds_timer();
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    BKE_mesh_calc_normals_poly(mverts.data(),
+                               (float(*)[3])vert_normals.data(),
+                               (int)mverts.size(),
+                               mloop.data(),
+                               mpolys.data(),
+                               (int)mloop.size(),
+                               (int)mpolys.size(),
+                               (float(*)[3])poly_normals.data(),
+                               false);
+  }
+  printf("Vertex normals of %d vertices: %fs on average over %d runs\n",
+         (int)mverts.size(),
+         (PIL_check_seconds_timer() - start_time) / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED);
+}
@@ -44,12 +44,19 @@
 #include "BLI_heap_simple.h"
 #include "BLI_kdopbvh.h"
 #include "BLI_math.h"
+#include "BLI_math_bits.h"
 #include "BLI_stack.h"
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BLI_strict_flags.h"
 
+#include "atomic_ops.h"
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 /* used for iterative_raycast */
 // #define USE_SKIP_LINKS
 
@@ -70,6 +77,14 @@
 #  define KDOPBVH_THREAD_LEAF_THRESHOLD 1024
 #endif
 
+/* Number of bins the SAH build sorts the leafs of a branch into to find the best split. */
+#define BVH_SAH_BINS 16
+/* Beyond this depth the SAH build splits in the middle, so degenerate input can't recurse deep. */
+#define BVH_SAH_MAX_DEPTH 64
+
+/* Number of children of the flattened nodes, checked at once with SIMD. */
+#define BVH_WIDE_NODE_WIDTH 4
+
 /* -------------------------------------------------------------------- */
 /** \name Struct Definitions
  * \{ */
@@ -88,6 +103,20 @@ typedef struct BVHNode {
   char main_axis; /* Axis used to split this node */
 } BVHNode;
 
+/**
+ * Flattened copy of the tree, built by #BVH_BALANCE_WIDE_NODES.
+ * Bounds are stored per axis so ray casts, nearest searches and overlap tests check all
+ * children at once.
+ */
+typedef struct BVHWideNode {
+  /* X, Y and Z minimum and maximum of the children, one lane per child. */
+  float bounds[6][BVH_WIDE_NODE_WIDTH];
+  BVHNode *children[BVH_WIDE_NODE_WIDTH];
+  /* Index of the wide node of each child branch, -1 for leafs. */
+  int wide[BVH_WIDE_NODE_WIDTH];
+  int totnode;
+} BVHWideNode;
+
 /* keep under 26 bytes for speed purposes */
 struct BVHTree {
   BVHNode **nodes;
@@ -100,17 +129,21 @@ struct BVHTree {
   axis_t start_axis, stop_axis; /* bvhtree_kdop_axes array indices according to axis */
   axis_t axis;                  /* kdop type (6 => OBB, 7 => AABB, ...) */
   char tree_type;               /* type of tree (4 => quadtree) */
+  BVHWideNode *wide_nodes;      /* optional, root first */
+  int totwide;
 };
 
 /* optimization, ensure we stay small */
-BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 48) ||
-                      (sizeof(void *) == 4 && sizeof(BVHTree) <= 32),
+BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 64) ||
+                      (sizeof(void *) == 4 && sizeof(BVHTree) <= 40),
                   "over sized")
 
 /* avoid duplicating vars in BVHOverlapData_Thread */
 typedef struct BVHOverlapData_Shared {
   const BVHTree *tree1, *tree2;
   axis_t start_axis, stop_axis;
+  /* use the wide nodes of tree2 for leafs of tree1 */
+  bool use_wide2;
 
   /* use for callbacks */
   BVHTree_OverlapCallback callback;
@@ -863,6 +896,504 @@ static void non_recursive_bvh_div_nodes(const BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name SAH Build
+ *
+ * Alternative to the implicit tree, for trees that are queried many times.
+ * A binary tree is built with binned SAH (surface area heuristic) splits, sorting the leafs
+ * by their centroid along the axis where the centroids spread the most.
+ * Subtrees with many leafs are built in parallel.
+ *
+ * The binary tree is then collapsed to the tree type, by opening the largest child branches
+ * until a branch has enough children. Branches are stored in depth first order, so all the
+ * children have an index greater than the parent, as #BLI_bvhtree_update_tree expects.
+ * \{ */
+
+typedef struct BVHSAHNode {
+  /* Indices of the child build nodes, -1 for leafs. */
+  int children[2];
+  /* Index of the leaf in the node array. */
+  int leaf;
+  /* Half the surface area of the bounds. */
+  float area;
+  char axis;
+} BVHSAHNode;
+
+typedef struct BVHSAHBuilder {
+  const BVHTree *tree;
+  BVHSAHNode *nodes;
+  uint nodes_len;
+  /* Node array indices of the leafs, partitioned in place. */
+  int *leafs;
+  TaskPool *pool;
+} BVHSAHBuilder;
+
+typedef struct BVHSAHBuildTask {
+  int node_index;
+  int begin, end;
+  int depth;
+} BVHSAHBuildTask;
+
+typedef struct BVHSAHBin {
+  float bounds[6];
+  int count;
+} BVHSAHBin;
+
+static void bvh_sah_bounds_init(float bounds[6])
+{
+  for (int i = 0; i < 6; i += 2) {
+    bounds[i] = FLT_MAX;
+    bounds[i + 1] = -FLT_MAX;
+  }
+}
+
+static void bvh_sah_bounds_expand(float bounds[6], const float bv[6])
+{
+  for (int i = 0; i < 6; i += 2) {
+    bounds[i] = min_ff(bounds[i], bv[i]);
+    bounds[i + 1] = max_ff(bounds[i + 1], bv[i + 1]);
+  }
+}
+
+static float bvh_sah_bounds_area(const float bounds[6])
+{
+  const float x = bounds[1] - bounds[0];
+  const float y = bounds[3] - bounds[2];
+  const float z = bounds[5] - bounds[4];
+  return x * y + y * z + z * x;
+}
+
+/* Twice the centroid of the leaf along an axis, only compared between leafs. */
+BLI_INLINE float bvh_sah_centroid(const BVHSAHBuilder *builder, int leaf, int axis)
+{
+  const float *bv = builder->tree->nodearray[leaf].bv;
+  return bv[2 * axis] + bv[2 * axis + 1];
+}
+
+/* Clamped in float, casting NaN or out of range values to int is undefined. NaN centroids go to
+ * the first bin. */
+BLI_INLINE int bvh_sah_bin(float centroid, float min, float scale)
+{
+  const float bin = (centroid - min) * scale;
+  if (!(bin > 0.0f)) {
+    return 0;
+  }
+  if (bin >= (float)(BVH_SAH_BINS - 1)) {
+    return BVH_SAH_BINS - 1;
+  }
+  return (int)bin;
+}
+
+/**
+ * Find the split of the leafs in [begin, end) with the lowest cost and partition them.
+ * Returns the first leaf of the second half.
+ */
+static int bvh_sah_split(BVHSAHBuilder *builder, int begin, int end, int depth, char *r_axis)
+{
+  float centroid_bounds[6];
+  bvh_sah_bounds_init(centroid_bounds);
+  for (int i = begin; i < end; i++) {
+    for (int axis = 0; axis < 3; axis++) {
+      const float centroid = bvh_sah_centroid(builder, builder->leafs[i], axis);
+      centroid_bounds[2 * axis] = min_ff(centroid_bounds[2 * axis], centroid);
+      centroid_bounds[2 * axis + 1] = max_ff(centroid_bounds[2 * axis + 1], centroid);
+    }
+  }
+
+  const int axis = get_largest_axis(centroid_bounds) / 2;
+  const float min = centroid_bounds[2 * axis];
+  const float extent = centroid_bounds[2 * axis + 1] - min;
+  *r_axis = (char)axis;
+
+  /* All centroids at the same position, or a degenerate distribution. */
+  if (!(extent > 0.0f) || depth >= BVH_SAH_MAX_DEPTH) {
+    return (begin + end) / 2;
+  }
+
+  BVHSAHBin bins[BVH_SAH_BINS];
+  for (int i = 0; i < BVH_SAH_BINS; i++) {
+    bvh_sah_bounds_init(bins[i].bounds);
+    bins[i].count = 0;
+  }
+
+  const float scale = (float)BVH_SAH_BINS / extent;
+  for (int i = begin; i < end; i++) {
+    const int leaf = builder->leafs[i];
+    BVHSAHBin *bin = &bins[bvh_sah_bin(bvh_sah_centroid(builder, leaf, axis), min, scale)];
+    bvh_sah_bounds_expand(bin->bounds, builder->tree->nodearray[leaf].bv);
+    bin->count++;
+  }
+
+  /* Sweep from the right to get the cost of everything after each bin. */
+  float right_area[BVH_SAH_BINS];
+  int right_count[BVH_SAH_BINS];
+  float bounds[6];
+  int count = 0;
+  bvh_sah_bounds_init(bounds);
+  for (int i = BVH_SAH_BINS - 1; i > 0; i--) {
+    bvh_sah_bounds_expand(bounds, bins[i].bounds);
+    count += bins[i].count;
+    right_area[i] = count ? bvh_sah_bounds_area(bounds) : 0.0f;
+    right_count[i] = count;
+  }
+
+  /* Sweep from the left to find the cheapest split, after bin `split`. */
+  int split = -1;
+  float split_cost = FLT_MAX;
+  count = 0;
+  bvh_sah_bounds_init(bounds);
+  for (int i = 0; i < BVH_SAH_BINS - 1; i++) {
+    bvh_sah_bounds_expand(bounds, bins[i].bounds);
+    count += bins[i].count;
+    if (count == 0 || right_count[i + 1] == 0) {
+      continue;
+    }
+    const float cost = bvh_sah_bounds_area(bounds) * (float)count +
+                       right_area[i + 1] * (float)right_count[i + 1];
+    if (cost < split_cost) {
+      split_cost = cost;
+      split = i;
+    }
+  }
+
+  if (split == -1) {
+    return (begin + end) / 2;
+  }
+
+  int *leafs = builder->leafs;
+  int i = begin, j = end - 1;
+  while (i <= j) {
+    if (bvh_sah_bin(bvh_sah_centroid(builder, leafs[i], axis), min, scale) <= split) {
+      i++;
+    }
+    else {
+      SWAP(int, leafs[i], leafs[j]);
+      j--;
+    }
+  }
+  return i;
+}
+
+static void bvh_sah_build_task_cb(TaskPool *__restrict pool, void *taskdata);
+
+static void bvh_sah_build_recursive(
+    BVHSAHBuilder *builder, int node_index, int begin, int end, int depth)
+{
+  BVHSAHNode *node = &builder->nodes[node_index];
+  const BVHNode *nodearray = builder->tree->nodearray;
+
+  float bounds[6];
+  bvh_sah_bounds_init(bounds);
+  for (int i = begin; i < end; i++) {
+    bvh_sah_bounds_expand(bounds, nodearray[builder->leafs[i]].bv);
+  }
+  node->area = bvh_sah_bounds_area(bounds);
+
+  if (end - begin == 1) {
+    node->children[0] = node->children[1] = -1;
+    node->leaf = builder->leafs[begin];
+    node->axis = 0;
+    return;
+  }
+
+  const int mid = bvh_sah_split(builder, begin, end, depth, &node->axis);
+  const int first = (int)atomic_fetch_and_add_uint32(&builder->nodes_len, 2);
+  node->children[0] = first;
+  node->children[1] = first + 1;
+  node->leaf = -1;
+
+  if (builder->pool && mid - begin > KDOPBVH_THREAD_LEAF_THRESHOLD) {
+    BVHSAHBuildTask *task = MEM_mallocN(sizeof(*task), __func__);
+    task->node_index = first;
+    task->begin = begin;
+    task->end = mid;
+    task->depth = depth + 1;
+    BLI_task_pool_push(builder->pool, bvh_sah_build_task_cb, task, true, NULL);
+  }
+  else {
+    bvh_sah_build_recursive(builder, first, begin, mid, depth + 1);
+  }
+  bvh_sah_build_recursive(builder, first + 1, mid, end, depth + 1);
+}
+
+static void bvh_sah_build_task_cb(TaskPool *__restrict pool, void *taskdata)
+{
+  BVHSAHBuilder *builder = BLI_task_pool_user_data(pool);
+  const BVHSAHBuildTask *task = taskdata;
+  bvh_sah_build_recursive(builder, task->node_index, task->begin, task->end, task->depth);
+}
+
+/**
+ * Gather the children of a branch of the tree type, opening the child branch with the
+ * largest surface area until there are enough children, or only leafs are left.
+ */
+static int bvh_sah_collapse(const BVHSAHBuilder *builder,
+                            const BVHSAHNode *node,
+                            int r_children[MAX_TREETYPE])
+{
+  const int tree_type = builder->tree->tree_type;
+  int len = 2;
+  r_children[0] = node->children[0];
+  r_children[1] = node->children[1];
+
+  while (len < tree_type) {
+    int best = -1;
+    float best_area = -FLT_MAX;
+    for (int i = 0; i < len; i++) {
+      const BVHSAHNode *child = &builder->nodes[r_children[i]];
+      if (child->leaf == -1 && child->area > best_area) {
+        best = i;
+        best_area = child->area;
+      }
+    }
+    if (best == -1) {
+      break;
+    }
+
+    const BVHSAHNode *child = &builder->nodes[r_children[best]];
+    memmove(&r_children[best + 2], &r_children[best + 1], sizeof(int) * (size_t)(len - best - 1));
+    r_children[best] = child->children[0];
+    r_children[best + 1] = child->children[1];
+    len++;
+  }
+  return len;
+}
+
+static int bvh_sah_count_branches(const BVHSAHBuilder *builder, int node_index)
+{
+  const BVHSAHNode *node = &builder->nodes[node_index];
+  if (node->leaf != -1) {
+    return 0;
+  }
+
+  int children[MAX_TREETYPE];
+  const int len = bvh_sah_collapse(builder, node, children);
+  int count = 1;
+  for (int i = 0; i < len; i++) {
+    count += bvh_sah_count_branches(builder, children[i]);
+  }
+  return count;
+}
+
+static BVHNode *bvh_sah_emit(BVHTree *tree,
+                             const BVHSAHBuilder *builder,
+                             int node_index,
+                             BVHNode *parent,
+                             int *r_leafs_len)
+{
+  const BVHSAHNode *node = &builder->nodes[node_index];
+  if (node->leaf != -1) {
+    BVHNode *leaf = &tree->nodearray[node->leaf];
+    leaf->parent = parent;
+    tree->nodes[(*r_leafs_len)++] = leaf;
+    return leaf;
+  }
+
+  /* The branch is added before its children, so they get a greater index. */
+  BVHNode *branch = &tree->nodearray[tree->totleaf + tree->totbranch];
+  tree->nodes[tree->totleaf + tree->totbranch] = branch;
+  tree->totbranch++;
+
+  int children[MAX_TREETYPE];
+  const int len = bvh_sah_collapse(builder, node, children);
+  branch->parent = parent;
+  branch->main_axis = node->axis;
+  branch->totnode = (char)len;
+  for (int i = 0; i < tree->tree_type; i++) {
+    branch->children[i] = NULL;
+  }
+  for (int i = 0; i < len; i++) {
+    branch->children[i] = bvh_sah_emit(tree, builder, children[i], branch, r_leafs_len);
+  }
+  return branch;
+}
+
+/**
+ * Reallocate the nodes for a larger number of branches, only leafs have been inserted.
+ */
+static void bvh_sah_nodes_resize(BVHTree *tree, int numnodes)
+{
+  const int axis = tree->axis;
+  const int tree_type = tree->tree_type;
+
+  BVHNode *nodearray = MEM_callocN(sizeof(BVHNode) * (size_t)numnodes, "BVHNodeArray");
+  float *nodebv = MEM_callocN(sizeof(float) * (size_t)(axis * numnodes), "BVHNodeBV");
+  BVHNode **nodechild = MEM_callocN(sizeof(BVHNode *) * (size_t)(tree_type * numnodes),
+                                    "BVHNodeBV");
+
+  memcpy(nodebv, tree->nodebv, sizeof(float) * (size_t)(axis * tree->totleaf));
+  for (int i = 0; i < numnodes; i++) {
+    nodearray[i].bv = &nodebv[i * axis];
+    nodearray[i].children = &nodechild[i * tree_type];
+  }
+  for (int i = 0; i < tree->totleaf; i++) {
+    nodearray[i].index = tree->nodearray[i].index;
+  }
+
+  MEM_freeN(tree->nodes);
+  MEM_freeN(tree->nodearray);
+  MEM_freeN(tree->nodebv);
+  MEM_freeN(tree->nodechild);
+  tree->nodes = MEM_callocN(sizeof(BVHNode *) * (size_t)numnodes, "BVHNodes");
+  tree->nodearray = nodearray;
+  tree->nodebv = nodebv;
+  tree->nodechild = nodechild;
+}
+
+/**
+ * Build the branches of the tree with SAH splits, only supports trees with x, y and z axes.
+ */
+static void bvh_sah_build(BVHTree *tree)
+{
+  const int totleaf = tree->totleaf;
+  BLI_assert(totleaf > 1 && tree->start_axis == 0);
+
+  BVHSAHBuilder builder = {
+      .tree = tree,
+      .nodes = MEM_mallocN(sizeof(BVHSAHNode) * (size_t)(2 * totleaf - 1), __func__),
+      .nodes_len = 1,
+      .leafs = MEM_mallocN(sizeof(int) * (size_t)totleaf, __func__),
+      .pool = NULL,
+  };
+  for (int i = 0; i < totleaf; i++) {
+    builder.leafs[i] = i;
+  }
+
+  if (totleaf > KDOPBVH_THREAD_LEAF_THRESHOLD) {
+    builder.pool = BLI_task_pool_create(&builder, TASK_PRIORITY_HIGH);
+    bvh_sah_build_recursive(&builder, 0, 0, totleaf, 0);
+    BLI_task_pool_work_and_wait(builder.pool);
+    BLI_task_pool_free(builder.pool);
+  }
+  else {
+    bvh_sah_build_recursive(&builder, 0, 0, totleaf, 0);
+  }
+
+  /* Collapsing may need more branches than the implicit tree. */
+  const int totbranch = bvh_sah_count_branches(&builder, 0);
+  if ((size_t)(totleaf + totbranch) > MEM_allocN_len(tree->nodes) / sizeof(*tree->nodes)) {
+    bvh_sah_nodes_resize(tree, totleaf + totbranch);
+  }
+
+  int leafs_len = 0;
+  tree->totbranch = 0;
+  bvh_sah_emit(tree, &builder, 0, NULL, &leafs_len);
+  BLI_assert(leafs_len == totleaf && tree->totbranch == totbranch);
+
+  MEM_freeN(builder.nodes);
+  MEM_freeN(builder.leafs);
+
+  /* Children come after their parent, so this joins them bottom up. */
+  for (int i = totleaf + totbranch - 1; i >= totleaf; i--) {
+    node_join(tree, &tree->nodearray[i]);
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Wide Nodes
+ *
+ * The tree flattened to nodes with #BVH_WIDE_NODE_WIDTH children.
+ * Bounds of the children are stored per axis, so they are tested at once with SIMD.
+ * Leafs are still tested against all axes of the k-DOP where the queries require it.
+ * \{ */
+
+static void bvh_wide_node_refit(BVHWideNode *wide)
+{
+  for (int i = 0; i < BVH_WIDE_NODE_WIDTH; i++) {
+    const float *bv = (i < wide->totnode) ? wide->children[i]->bv : NULL;
+    for (int j = 0; j < 6; j += 2) {
+      /* Empty bounds for unused lanes. */
+      wide->bounds[j][i] = bv ? bv[j] : FLT_MAX;
+      wide->bounds[j + 1][i] = bv ? bv[j + 1] : -FLT_MAX;
+    }
+  }
+}
+
+static int bvh_wide_node_build(BVHTree *tree, BVHNode *node)
+{
+  const int wide_index = tree->totwide++;
+  BVHWideNode *wide = &tree->wide_nodes[wide_index];
+
+  BVHNode *children[BVH_WIDE_NODE_WIDTH];
+  int len = node->totnode;
+  memcpy(children, node->children, sizeof(*children) * (size_t)len);
+
+  /* Open the largest child branches while their children fit, for trees of lower degree. */
+  while (true) {
+    int best = -1;
+    float best_area = -FLT_MAX;
+    for (int i = 0; i < len; i++) {
+      const BVHNode *child = children[i];
+      if (child->totnode && len - 1 + child->totnode <= BVH_WIDE_NODE_WIDTH) {
+        const float area = bvh_sah_bounds_area(child->bv);
+        if (area > best_area) {
+          best = i;
+          best_area = area;
+        }
+      }
+    }
+    if (best == -1) {
+      break;
+    }
+
+    BVHNode *child = children[best];
+    memmove(&children[best + child->totnode],
+            &children[best + 1],
+            sizeof(*children) * (size_t)(len - best - 1));
+    memcpy(&children[best], child->children, sizeof(*children) * (size_t)child->totnode);
+    len += child->totnode - 1;
+  }
+
+  wide->totnode = len;
+  for (int i = 0; i < len; i++) {
+    wide->children[i] = children[i];
+    wide->wide[i] = children[i]->totnode ? bvh_wide_node_build(tree, children[i]) : -1;
+  }
+  bvh_wide_node_refit(wide);
+
+  return wide_index;
+}
+
+/**
+ * Lanes with a value below `limit`, in increasing order of the value.
+ */
+static int bvh_wide_lanes_sort(const float value[BVH_WIDE_NODE_WIDTH],
+                               const int totnode,
+                               const float limit,
+                               int r_lanes[BVH_WIDE_NODE_WIDTH])
+{
+  int len = 0;
+  for (int i = 0; i < totnode; i++) {
+    if (value[i] < limit) {
+      int j = len++;
+      for (; j > 0 && value[r_lanes[j - 1]] > value[i]; j--) {
+        r_lanes[j] = r_lanes[j - 1];
+      }
+      r_lanes[j] = i;
+    }
+  }
+  return len;
+}
+
+/**
+ * Only trees with x, y and z axes and up to #BVH_WIDE_NODE_WIDTH children are supported,
+ * the others keep using the regular nodes.
+ */
+static void bvh_wide_nodes_build(BVHTree *tree)
+{
+  if (tree->start_axis != 0 || tree->tree_type > BVH_WIDE_NODE_WIDTH || tree->totleaf == 0) {
+    return;
+  }
+
+  tree->wide_nodes = MEM_mallocN(sizeof(BVHWideNode) * (size_t)tree->totbranch, __func__);
+  tree->totwide = 0;
+  bvh_wide_node_build(tree, tree->nodes[tree->totleaf]);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree API
  * \{ */
@@ -949,11 +1480,16 @@ void BLI_bvhtree_free(BVHTree *tree)
     MEM_SAFE_FREE(tree->nodearray);
     MEM_SAFE_FREE(tree->nodebv);
     MEM_SAFE_FREE(tree->nodechild);
+    MEM_SAFE_FREE(tree->wide_nodes);
     MEM_freeN(tree);
   }
 }
 
-void BLI_bvhtree_balance(BVHTree *tree)
+/**
+ * \param flag: #BVH_BALANCE_SAH to split with the surface area heuristic,
+ * #BVH_BALANCE_WIDE_NODES to store the wide nodes that queries test with SIMD.
+ */
+void BLI_bvhtree_balance_ex(BVHTree *tree, const int flag)
 {
   BVHNode **leafs_array = tree->nodes;
 
@@ -961,15 +1497,24 @@ void BLI_bvhtree_balance(BVHTree *tree)
    * (some big bug goes here if its being called more than once per tree) */
   BLI_assert(tree->totbranch == 0);
 
-  /* Build the implicit tree */
-  non_recursive_bvh_div_nodes(
-      tree, tree->nodearray + (tree->totleaf - 1), leafs_array, tree->totleaf);
+  if ((flag & BVH_BALANCE_SAH) && tree->totleaf > 1 && tree->start_axis == 0) {
+    bvh_sah_build(tree);
+  }
+  else {
+    /* Build the implicit tree */
+    non_recursive_bvh_div_nodes(
+        tree, tree->nodearray + (tree->totleaf - 1), leafs_array, tree->totleaf);
 
-  /* current code expects the branches to be linked to the nodes array
-   * we perform that linkage here */
-  tree->totbranch = implicit_needed_branches(tree->tree_type, tree->totleaf);
-  for (int i = 0; i < tree->totbranch; i++) {
-    tree->nodes[tree->totleaf + i] = &tree->nodearray[tree->totleaf + i];
+    /* current code expects the branches to be linked to the nodes array
+     * we perform that linkage here */
+    tree->totbranch = implicit_needed_branches(tree->tree_type, tree->totleaf);
+    for (int i = 0; i < tree->totbranch; i++) {
+      tree->nodes[tree->totleaf + i] = &tree->nodearray[tree->totleaf + i];
+    }
+  }
+
+  if (flag & BVH_BALANCE_WIDE_NODES) {
+    bvh_wide_nodes_build(tree);
   }
 
 #ifdef USE_SKIP_LINKS
@@ -985,6 +1530,11 @@ void BLI_bvhtree_balance(BVHTree *tree)
 #endif
 }
 
+void BLI_bvhtree_balance(BVHTree *tree)
+{
+  BLI_bvhtree_balance_ex(tree, 0);
+}
+
 static void bvhtree_node_inflate(const BVHTree *tree, BVHNode *node, const float dist)
 {
   axis_t axis_iter;
@@ -1053,6 +1603,10 @@ void BLI_bvhtree_update_tree(BVHTree *tree)
   for (; index >= root; index--) {
     node_join(tree, *index);
   }
+
+  for (int i = 0; i < tree->totwide; i++) {
+    bvh_wide_node_refit(&tree->wide_nodes[i]);
+  }
 }
 /**
  * Number of times #BLI_bvhtree_insert has been called.
@@ -1076,6 +1630,28 @@ float BLI_bvhtree_get_epsilon(const BVHTree *tree)
   return tree->epsilon;
 }
 
+/**
+ * Estimated cost of queries, the surface area of all branches relative to the root.
+ * Only uses the x, y and z axes, trees without them have no cost.
+ *
+ * Refitting after the leafs moved increases the cost, balancing a new tree is better when it
+ * grew a lot.
+ */
+float BLI_bvhtree_get_cost(const BVHTree *tree)
+{
+  if (tree->start_axis != 0 || tree->totbranch == 0) {
+    return 0.0f;
+  }
+
+  float area = 0.0f;
+  for (int i = 0; i < tree->totbranch; i++) {
+    area += bvh_sah_bounds_area(tree->nodes[tree->totleaf + i]->bv);
+  }
+
+  const float root_area = bvh_sah_bounds_area(tree->nodes[tree->totleaf]->bv);
+  return (root_area > 0.0f) ? area / root_area : (float)tree->totbranch;
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -1104,6 +1680,87 @@ static bool tree_overlap_test(const BVHNode *node1,
   return 1;
 }
 
+/**
+ * Bit mask of the lanes of the wide node that overlap the x, y and z axes of `bv`.
+ */
+static int tree_overlap_wide_mask(const BVHWideNode *wide, const float bv[6])
+{
+#ifdef __SSE2__
+  __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+  for (int i = 0; i < 6; i += 2) {
+    const __m128 min = _mm_loadu_ps(wide->bounds[i]);
+    const __m128 max = _mm_loadu_ps(wide->bounds[i + 1]);
+    mask = _mm_and_ps(mask, _mm_cmple_ps(min, _mm_set1_ps(bv[i + 1])));
+    mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_set1_ps(bv[i]), max));
+  }
+  return _mm_movemask_ps(mask) & ((1 << wide->totnode) - 1);
+#else
+  int mask = 0;
+  for (int lane = 0; lane < wide->totnode; lane++) {
+    bool overlap = true;
+    for (int i = 0; i < 6; i += 2) {
+      if (bv[i] > wide->bounds[i + 1][lane] || wide->bounds[i][lane] > bv[i + 1]) {
+        overlap = false;
+        break;
+      }
+    }
+    if (overlap) {
+      mask |= 1 << lane;
+    }
+  }
+  return mask;
+#endif
+}
+
+/**
+ * Traverse the wide nodes of tree2 for a leaf of tree1,
+ * combines #tree_overlap_traverse, #tree_overlap_traverse_cb and #tree_overlap_traverse_num.
+ */
+static bool tree_overlap_traverse_wide(BVHOverlapData_Thread *data_thread,
+                                       const BVHNode *node1,
+                                       const BVHWideNode *wide)
+{
+  BVHOverlapData_Shared *data = data_thread->shared;
+  int mask = tree_overlap_wide_mask(wide, node1->bv);
+
+  for (int i = 0; mask; i++, mask >>= 1) {
+    if (!(mask & 1)) {
+      continue;
+    }
+    /* The axes after x, y and z. */
+    const BVHNode *node2 = wide->children[i];
+    if (!tree_overlap_test(node1, node2, 3, data->stop_axis)) {
+      continue;
+    }
+
+    if (wide->wide[i] != -1) {
+      if (tree_overlap_traverse_wide(
+              data_thread, node1, &data->tree2->wide_nodes[wide->wide[i]])) {
+        return true;
+      }
+      continue;
+    }
+
+    if (UNLIKELY(node1 == node2)) {
+      continue;
+    }
+    if (data->callback &&
+        !data->callback(data->userdata, node1->index, node2->index, data_thread->thread)) {
+      continue;
+    }
+    /* both leafs, insert overlap! */
+    if (data_thread->overlap) {
+      BVHTreeOverlap *overlap = BLI_stack_push_r(data_thread->overlap);
+      overlap->indexA = node1->index;
+      overlap->indexB = node2->index;
+    }
+    if (data_thread->max_interactions && (--data_thread->max_interactions) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
 static void tree_overlap_traverse(BVHOverlapData_Thread *data_thread,
                                   const BVHNode *node1,
                                   const BVHNode *node2)
@@ -1127,6 +1784,10 @@ static void tree_overlap_traverse(BVHOverlapData_Thread *data_thread,
         overlap->indexA = node1->index;
         overlap->indexB = node2->index;
       }
+      else if (data->use_wide2) {
+        /* tree1 is traversed first, so node2 is the root. */
+        tree_overlap_traverse_wide(data_thread, node1, data->tree2->wide_nodes);
+      }
       else {
         for (j = 0; j < data->tree2->tree_type; j++) {
           if (node2->children[j]) {
@@ -1174,6 +1835,9 @@ static void tree_overlap_traverse_cb(BVHOverlapData_Thread *data_thread,
           overlap->indexB = node2->index;
         }
       }
+      else if (data->use_wide2) {
+        tree_overlap_traverse_wide(data_thread, node1, data->tree2->wide_nodes);
+      }
       else {
         for (j = 0; j < data->tree2->tree_type; j++) {
           if (node2->children[j]) {
@@ -1225,6 +1889,9 @@ static bool tree_overlap_traverse_num(BVHOverlapData_Thread *data_thread,
           return (--data_thread->max_interactions) == 0;
         }
       }
+      else if (data->use_wide2) {
+        return tree_overlap_traverse_wide(data_thread, node1, data->tree2->wide_nodes);
+      }
       else {
         for (j = 0; j < node2->totnode; j++) {
           if (tree_overlap_traverse_num(data_thread, node1, node2->children[j])) {
@@ -1327,6 +1994,7 @@ BVHTreeOverlap *BLI_bvhtree_overlap_ex(
   data_shared.tree2 = tree2;
   data_shared.start_axis = start_axis;
   data_shared.stop_axis = stop_axis;
+  data_shared.use_wide2 = tree2->wide_nodes && tree1->start_axis == 0;
 
   /* can be NULL */
   data_shared.callback = callback;
@@ -1528,6 +2196,61 @@ static void dfs_find_nearest_dfs(BVHNearestData *data, BVHNode *node)
   }
 }
 
+/* Squared distance to the x, y and z bounds of each lane, like #calc_nearest_point_squared. */
+static void wide_nearest_dist_squared(const float proj[3],
+                                      const BVHWideNode *wide,
+                                      float r_dist_sq[BVH_WIDE_NODE_WIDTH])
+{
+#ifdef __SSE2__
+  __m128 dist_sq = _mm_setzero_ps();
+  for (int i = 0; i < 3; i++) {
+    const __m128 co = _mm_set1_ps(proj[i]);
+    const __m128 nearest = _mm_min_ps(_mm_max_ps(co, _mm_loadu_ps(wide->bounds[2 * i])),
+                                      _mm_loadu_ps(wide->bounds[2 * i + 1]));
+    const __m128 d = _mm_sub_ps(co, nearest);
+    dist_sq = _mm_add_ps(dist_sq, _mm_mul_ps(d, d));
+  }
+  _mm_storeu_ps(r_dist_sq, dist_sq);
+#else
+  for (int lane = 0; lane < BVH_WIDE_NODE_WIDTH; lane++) {
+    r_dist_sq[lane] = 0.0f;
+    for (int i = 0; i < 3; i++) {
+      const float nearest = min_ff(max_ff(proj[i], wide->bounds[2 * i][lane]),
+                                   wide->bounds[2 * i + 1][lane]);
+      r_dist_sq[lane] += (proj[i] - nearest) * (proj[i] - nearest);
+    }
+  }
+#endif
+}
+
+/* Depth first search on the wide nodes, visiting the nearest children first */
+static void wide_find_nearest_dfs(BVHNearestData *data, const BVHWideNode *wide)
+{
+  float dist_sq[BVH_WIDE_NODE_WIDTH];
+  int lanes[BVH_WIDE_NODE_WIDTH];
+  wide_nearest_dist_squared(data->proj, wide, dist_sq);
+  const int len = bvh_wide_lanes_sort(dist_sq, wide->totnode, data->nearest.dist_sq, lanes);
+
+  for (int k = 0; k < len; k++) {
+    const int i = lanes[k];
+    if (dist_sq[i] >= data->nearest.dist_sq) {
+      break;
+    }
+
+    if (wide->wide[i] != -1) {
+      wide_find_nearest_dfs(data, &data->tree->wide_nodes[wide->wide[i]]);
+    }
+    else if (data->callback) {
+      data->callback(data->userdata, wide->children[i]->index, data->co, &data->nearest);
+    }
+    else {
+      data->nearest.index = wide->children[i]->index;
+      data->nearest.dist_sq = calc_nearest_point_squared(
+          data->proj, wide->children[i], data->nearest.co);
+    }
+  }
+}
+
 static void dfs_find_nearest_begin(BVHNearestData *data, BVHNode *node)
 {
   float nearest[3], dist_sq;
@@ -1619,6 +2342,12 @@ int BLI_bvhtree_find_nearest_ex(BVHTree *tree,
     if (flag & BVH_NEAREST_OPTIMAL_ORDER) {
       heap_find_nearest_begin(&data, root);
     }
+    else if (tree->wide_nodes) {
+      float nearest_co[3];
+      if (calc_nearest_point_squared(data.proj, root, nearest_co) < data.nearest.dist_sq) {
+        wide_find_nearest_dfs(&data, tree->wide_nodes);
+      }
+    }
     else {
       dfs_find_nearest_begin(&data, root);
     }
@@ -1806,6 +2535,73 @@ static float fast_ray_nearest_hit(const BVHRayCastData *data, const BVHNode *nod
   return max_fff(t1x, t1y, t1z);
 }
 
+/**
+ * Distance to the x, y and z bounds of each lane like #fast_ray_nearest_hit,
+ * FLT_MAX for the lanes the ray misses.
+ */
+static void wide_ray_nearest_hit(const BVHRayCastData *data,
+                                 const BVHWideNode *wide,
+                                 float r_dist[BVH_WIDE_NODE_WIDTH])
+{
+#ifdef __SSE2__
+  __m128 tmin = _mm_setzero_ps(), tmax = _mm_setzero_ps();
+  for (int i = 0; i < 3; i++) {
+    const __m128 origin = _mm_set1_ps(data->ray.origin[i]);
+    const __m128 idot = _mm_set1_ps(data->idot_axis[i]);
+    const __m128 bound1 = _mm_loadu_ps(wide->bounds[data->index[2 * i]]);
+    const __m128 bound2 = _mm_loadu_ps(wide->bounds[data->index[2 * i + 1]]);
+    const __m128 t1 = _mm_mul_ps(_mm_sub_ps(bound1, origin), idot);
+    const __m128 t2 = _mm_mul_ps(_mm_sub_ps(bound2, origin), idot);
+    tmin = i ? _mm_max_ps(tmin, t1) : t1;
+    tmax = i ? _mm_min_ps(tmax, t2) : t2;
+  }
+  const __m128 hit = _mm_and_ps(_mm_cmple_ps(tmin, tmax), _mm_cmpge_ps(tmax, _mm_setzero_ps()));
+  _mm_storeu_ps(r_dist,
+                _mm_or_ps(_mm_and_ps(hit, tmin), _mm_andnot_ps(hit, _mm_set1_ps(FLT_MAX))));
+#else
+  for (int lane = 0; lane < BVH_WIDE_NODE_WIDTH; lane++) {
+    float tmin = -FLT_MAX, tmax = FLT_MAX;
+    for (int i = 0; i < 3; i++) {
+      const float t1 = (wide->bounds[data->index[2 * i]][lane] - data->ray.origin[i]) *
+                       data->idot_axis[i];
+      const float t2 = (wide->bounds[data->index[2 * i + 1]][lane] - data->ray.origin[i]) *
+                       data->idot_axis[i];
+      tmin = max_ff(tmin, t1);
+      tmax = min_ff(tmax, t2);
+    }
+    r_dist[lane] = (tmin <= tmax && tmax >= 0.0f) ? tmin : FLT_MAX;
+  }
+#endif
+}
+
+/* Version of #dfs_raycast on the wide nodes, visiting the nearest children first. */
+static void wide_raycast(BVHRayCastData *data, const BVHWideNode *wide)
+{
+  float dist[BVH_WIDE_NODE_WIDTH];
+  int lanes[BVH_WIDE_NODE_WIDTH];
+  wide_ray_nearest_hit(data, wide, dist);
+  const int len = bvh_wide_lanes_sort(dist, wide->totnode, data->hit.dist, lanes);
+
+  for (int k = 0; k < len; k++) {
+    const int i = lanes[k];
+    if (dist[i] >= data->hit.dist) {
+      break;
+    }
+
+    if (wide->wide[i] != -1) {
+      wide_raycast(data, &data->tree->wide_nodes[wide->wide[i]]);
+    }
+    else if (data->callback) {
+      data->callback(data->userdata, wide->children[i]->index, &data->ray, &data->hit);
+    }
+    else {
+      data->hit.index = wide->children[i]->index;
+      data->hit.dist = dist[i];
+      madd_v3_v3v3fl(data->hit.co, data->ray.origin, data->ray.direction, dist[i]);
+    }
+  }
+}
+
 static void dfs_raycast(BVHRayCastData *data, BVHNode *node)
 {
   int i;
@@ -1951,7 +2747,14 @@ int BLI_bvhtree_ray_cast_ex(BVHTree *tree,
   }
 
   if (root) {
-    dfs_raycast(&data, root);
+    if (tree->wide_nodes && radius == 0.0f) {
+      if (fast_ray_nearest_hit(&data, root) < data.hit.dist) {
+        wide_raycast(&data, tree->wide_nodes);
+      }
+    }
+    else {
+      dfs_raycast(&data, root);
+    }
     //      iterative_raycast(&data, root);
   }
 
@@ -2058,6 +2861,362 @@ void BLI_bvhtree_ray_cast_all(BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name BLI_bvhtree_find_nearest_batch / BLI_bvhtree_ray_cast_batch
+ *
+ * Queries close to each other visit mostly the same nodes. They're sorted along a Morton curve
+ * and traversed in packets, so each node is tested once for all queries of a packet that reach
+ * it, instead of walking down from the root for every query.
+ *
+ * \{ */
+
+/* Number of queries traversed together, bits of the mask of active queries. */
+#define BVH_BATCH_PACKET_SIZE 32
+/* Don't use threads for less queries than this. */
+#define BVH_BATCH_THREAD_THRESHOLD 1024
+
+typedef struct BVHBatchOrder {
+  uint code;
+  int index;
+} BVHBatchOrder;
+
+typedef struct BVHNearestBatchData {
+  BVHNode *root;
+  const float (*co)[3];
+  BVHTreeNearest *nearest;
+  const int *order;
+  int co_len;
+  BVHTree_NearestPointCallback callback;
+  void *userdata;
+} BVHNearestBatchData;
+
+typedef struct BVHNearestPacket {
+  const BVHNearestBatchData *batch;
+  int len;
+  const float *co[BVH_BATCH_PACKET_SIZE];
+  BVHTreeNearest nearest[BVH_BATCH_PACKET_SIZE];
+  /* Center of the packet, to pick the children to visit first. */
+  float center[3];
+} BVHNearestPacket;
+
+typedef struct BVHRayCastBatchData {
+  BVHNode *root;
+  const BVHTreeRay *rays;
+  BVHTreeRayHit *hits;
+  const int *order;
+  int rays_len;
+  BVHTree_RayCastCallback callback;
+  void *userdata;
+  int flag;
+} BVHRayCastBatchData;
+
+typedef struct BVHRayCastPacket {
+  int len;
+  BVHRayCastData data[BVH_BATCH_PACKET_SIZE];
+  /* Sum of the directions of the packet, to pick the children to visit first. */
+  float direction[3];
+} BVHRayCastPacket;
+
+/* Spread the lower 10 bits of \a v, two zero bits between each. */
+static uint bvh_batch_morton_expand(uint v)
+{
+  v = (v * 0x00010001u) & 0xFF0000FFu;
+  v = (v * 0x00000101u) & 0x0F00F00Fu;
+  v = (v * 0x00000011u) & 0xC30C30C3u;
+  v = (v * 0x00000005u) & 0x49249249u;
+  return v;
+}
+
+static int bvh_batch_order_cmp(const void *a_v, const void *b_v)
+{
+  const BVHBatchOrder *a = a_v, *b = b_v;
+  if (a->code != b->code) {
+    return (a->code < b->code) ? -1 : 1;
+  }
+  return (a->index < b->index) ? -1 : (a->index > b->index);
+}
+
+/**
+ * Order of the points along a Morton curve through their bounds,
+ * with \a co_stride bytes between the points.
+ */
+static int *bvh_batch_order_create(const float *co, const size_t co_stride, const int co_len)
+{
+  float min[3], max[3], scale[3];
+  INIT_MINMAX(min, max);
+  for (int i = 0; i < co_len; i++) {
+    minmax_v3v3_v3(min, max, POINTER_OFFSET(co, co_stride * (size_t)i));
+  }
+  for (int axis = 0; axis < 3; axis++) {
+    scale[axis] = (max[axis] > min[axis]) ? 1023.0f / (max[axis] - min[axis]) : 0.0f;
+  }
+
+  BVHBatchOrder *order = MEM_malloc_arrayN((size_t)co_len, sizeof(*order), __func__);
+  for (int i = 0; i < co_len; i++) {
+    const float *p = POINTER_OFFSET(co, co_stride * (size_t)i);
+    uint code = 0;
+    for (int axis = 0; axis < 3; axis++) {
+      /* Written so NaN ends up in the first cell. */
+      const float cell = (p[axis] - min[axis]) * scale[axis];
+      code |= bvh_batch_morton_expand((cell > 0.0f) ? (uint)min_ff(cell, 1023.0f) : 0u) << axis;
+    }
+    order[i].code = code;
+    order[i].index = i;
+  }
+  qsort(order, (size_t)co_len, sizeof(*order), bvh_batch_order_cmp);
+
+  int *indices = MEM_malloc_arrayN((size_t)co_len, sizeof(*indices), __func__);
+  for (int i = 0; i < co_len; i++) {
+    indices[i] = order[i].index;
+  }
+  MEM_freeN(order);
+  return indices;
+}
+
+static uint bvh_batch_packet_mask(const int len)
+{
+  return (len == BVH_BATCH_PACKET_SIZE) ? ~0u : (1u << len) - 1u;
+}
+
+/* Version of #dfs_find_nearest_dfs for all queries of the packet set in \a mask. */
+static void batch_find_nearest_dfs(BVHNearestPacket *packet, BVHNode *node, uint mask)
+{
+  float nearest[3];
+
+  for (uint m = mask; m; m &= m - 1u) {
+    const uint q = bitscan_forward_uint(m);
+    if (calc_nearest_point_squared(packet->co[q], node, nearest) >= packet->nearest[q].dist_sq) {
+      mask &= ~(1u << q);
+    }
+  }
+  if (mask == 0) {
+    return;
+  }
+
+  if (node->totnode == 0) {
+    const BVHNearestBatchData *batch = packet->batch;
+    for (uint m = mask; m; m &= m - 1u) {
+      const uint q = bitscan_forward_uint(m);
+      BVHTreeNearest *nearest_q = &packet->nearest[q];
+      if (batch->callback) {
+        batch->callback(batch->userdata, node->index, packet->co[q], nearest_q);
+      }
+      else {
+        nearest_q->index = node->index;
+        nearest_q->dist_sq = calc_nearest_point_squared(packet->co[q], node, nearest_q->co);
+      }
+    }
+  }
+  else if (packet->center[node->main_axis] <=
+           node->children[0]->bv[node->main_axis * 2 + 1]) {
+    for (int i = 0; i != node->totnode; i++) {
+      batch_find_nearest_dfs(packet, node->children[i], mask);
+    }
+  }
+  else {
+    for (int i = node->totnode - 1; i >= 0; i--) {
+      batch_find_nearest_dfs(packet, node->children[i], mask);
+    }
+  }
+}
+
+static void bvhtree_find_nearest_batch_cb(void *__restrict userdata,
+                                          const int packet_index,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHNearestBatchData *batch = userdata;
+  const int *order = &batch->order[packet_index * BVH_BATCH_PACKET_SIZE];
+  BVHNearestPacket packet;
+
+  packet.batch = batch;
+  packet.len = min_ii(BVH_BATCH_PACKET_SIZE,
+                      batch->co_len - packet_index * BVH_BATCH_PACKET_SIZE);
+  zero_v3(packet.center);
+  for (int q = 0; q < packet.len; q++) {
+    packet.co[q] = batch->co[order[q]];
+    packet.nearest[q] = batch->nearest[order[q]];
+    add_v3_v3(packet.center, packet.co[q]);
+  }
+  mul_v3_fl(packet.center, 1.0f / (float)packet.len);
+
+  batch_find_nearest_dfs(&packet, batch->root, bvh_batch_packet_mask(packet.len));
+
+  for (int q = 0; q < packet.len; q++) {
+    batch->nearest[order[q]] = packet.nearest[q];
+  }
+}
+
+/**
+ * Find the nearest node to each of \a co, the same as #BLI_bvhtree_find_nearest for each of
+ * them. The \a r_nearest index and distance must be initialized, only nodes closer than the
+ * distance are searched.
+ *
+ * Faster than separate queries for coherent coordinates, like the vertices of a mesh.
+ * The \a callback must be thread-safe when #BVH_NEAREST_USE_THREADING is used.
+ */
+void BLI_bvhtree_find_nearest_batch(BVHTree *tree,
+                                    const float (*co)[3],
+                                    const int co_len,
+                                    BVHTreeNearest *r_nearest,
+                                    BVHTree_NearestPointCallback callback,
+                                    void *userdata,
+                                    const int flag)
+{
+  BVHNode *root = tree->nodes[tree->totleaf];
+  if (root == NULL || co_len == 0) {
+    return;
+  }
+
+  int *order = bvh_batch_order_create(co[0], sizeof(*co), co_len);
+  BVHNearestBatchData batch = {
+      .root = root,
+      .co = co,
+      .nearest = r_nearest,
+      .order = order,
+      .co_len = co_len,
+      .callback = callback,
+      .userdata = userdata,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (flag & BVH_NEAREST_USE_THREADING) &&
+                           (co_len > BVH_BATCH_THREAD_THRESHOLD);
+  BLI_task_parallel_range(0,
+                          (co_len + BVH_BATCH_PACKET_SIZE - 1) / BVH_BATCH_PACKET_SIZE,
+                          &batch,
+                          bvhtree_find_nearest_batch_cb,
+                          &settings);
+
+  MEM_freeN(order);
+}
+
+/* Version of #dfs_raycast for all rays of the packet set in \a mask. */
+static void batch_raycast_dfs(BVHRayCastPacket *packet, BVHNode *node, uint mask)
+{
+  float dist[BVH_BATCH_PACKET_SIZE];
+
+  for (uint m = mask; m; m &= m - 1u) {
+    const uint q = bitscan_forward_uint(m);
+    const BVHRayCastData *data = &packet->data[q];
+    dist[q] = (data->ray.radius == 0.0f) ? fast_ray_nearest_hit(data, node) :
+                                           ray_nearest_hit(data, node->bv);
+    if (dist[q] >= data->hit.dist) {
+      mask &= ~(1u << q);
+    }
+  }
+  if (mask == 0) {
+    return;
+  }
+
+  if (node->totnode == 0) {
+    for (uint m = mask; m; m &= m - 1u) {
+      const uint q = bitscan_forward_uint(m);
+      BVHRayCastData *data = &packet->data[q];
+      if (data->callback) {
+        data->callback(data->userdata, node->index, &data->ray, &data->hit);
+      }
+      else {
+        data->hit.index = node->index;
+        data->hit.dist = dist[q];
+        madd_v3_v3v3fl(data->hit.co, data->ray.origin, data->ray.direction, dist[q]);
+      }
+    }
+  }
+  else if (packet->direction[node->main_axis] > 0.0f) {
+    for (int i = 0; i != node->totnode; i++) {
+      batch_raycast_dfs(packet, node->children[i], mask);
+    }
+  }
+  else {
+    for (int i = node->totnode - 1; i >= 0; i--) {
+      batch_raycast_dfs(packet, node->children[i], mask);
+    }
+  }
+}
+
+static void bvhtree_ray_cast_batch_cb(void *__restrict userdata,
+                                      const int packet_index,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHRayCastBatchData *batch = userdata;
+  const int *order = &batch->order[packet_index * BVH_BATCH_PACKET_SIZE];
+  BVHRayCastPacket packet;
+
+  packet.len = min_ii(BVH_BATCH_PACKET_SIZE,
+                      batch->rays_len - packet_index * BVH_BATCH_PACKET_SIZE);
+  zero_v3(packet.direction);
+  for (int q = 0; q < packet.len; q++) {
+    const BVHTreeRay *ray = &batch->rays[order[q]];
+    BVHRayCastData *data = &packet.data[q];
+
+    BLI_ASSERT_UNIT_V3(ray->direction);
+
+    data->callback = batch->callback;
+    data->userdata = batch->userdata;
+    copy_v3_v3(data->ray.origin, ray->origin);
+    copy_v3_v3(data->ray.direction, ray->direction);
+    data->ray.radius = ray->radius;
+    bvhtree_ray_cast_data_precalc(data, batch->flag);
+    data->hit = batch->hits[order[q]];
+
+    add_v3_v3(packet.direction, ray->direction);
+  }
+
+  batch_raycast_dfs(&packet, batch->root, bvh_batch_packet_mask(packet.len));
+
+  for (int q = 0; q < packet.len; q++) {
+    batch->hits[order[q]] = packet.data[q].hit;
+  }
+}
+
+/**
+ * Cast each of \a rays, the same as #BLI_bvhtree_ray_cast_ex for each of them. The \a r_hits
+ * index and distance must be initialized, only hits closer than the distance are found.
+ *
+ * Faster than separate ray casts for rays starting close to each other.
+ * The \a callback must be thread-safe when #BVH_RAYCAST_USE_THREADING is used.
+ */
+void BLI_bvhtree_ray_cast_batch(BVHTree *tree,
+                                const BVHTreeRay *rays,
+                                const int rays_len,
+                                BVHTreeRayHit *r_hits,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                const int flag)
+{
+  BVHNode *root = tree->nodes[tree->totleaf];
+  if (root == NULL || rays_len == 0) {
+    return;
+  }
+
+  int *order = bvh_batch_order_create(rays[0].origin, sizeof(*rays), rays_len);
+  BVHRayCastBatchData batch = {
+      .root = root,
+      .rays = rays,
+      .hits = r_hits,
+      .order = order,
+      .rays_len = rays_len,
+      .callback = callback,
+      .userdata = userdata,
+      .flag = flag,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (flag & BVH_RAYCAST_USE_THREADING) &&
+                           (rays_len > BVH_BATCH_THREAD_THRESHOLD);
+  BLI_task_parallel_range(0,
+                          (rays_len + BVH_BATCH_PACKET_SIZE - 1) / BVH_BATCH_PACKET_SIZE,
+                          &batch,
+                          bvhtree_ray_cast_batch_cb,
+                          &settings);
+
+  MEM_freeN(order);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree_range_query
  *
@@ -10,6 +10,7 @@
 #include "BLI_kdopbvh.h"
 #include "BLI_math_vector.h"
 #include "BLI_rand.h"
+#include "BLI_utildefines.h"
 
 /* -------------------------------------------------------------------- */
 /* Helper Functions */
@@ -66,11 +67,15 @@ static void optimal_check_callback(void *userdata,
  * Note that a small epsilon is added to the BVH nodes bounds, even if we pass in zero.
  * Use rounding to ensure very close nodes don't cause the wrong node to be found as nearest.
  */
-static void find_nearest_points_test(
-    int points_len, float scale, int round, int random_seed, bool optimal = false)
+static void find_nearest_points_test(int points_len,
+                                     float scale,
+                                     int round,
+                                     int random_seed,
+                                     bool optimal = false,
+                                     int balance_flag = 0)
 {
   struct RNG *rng = BLI_rng_new(random_seed);
-  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 8, 8);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, balance_flag ? 4 : 8, 8);
 
   void *mem = MEM_mallocN(sizeof(float[3]) * points_len, __func__);
   float(*points)[3] = (float(*)[3])mem;
@@ -79,7 +84,7 @@ static void find_nearest_points_test(
     rng_v3_round(points[i], 3, rng, round, scale);
     BLI_bvhtree_insert(tree, i, points[i], 1);
   }
-  BLI_bvhtree_balance(tree);
+  BLI_bvhtree_balance_ex(tree, balance_flag);
 
   /* first find each point */
   BVHTree_NearestPointCallback callback = optimal ? optimal_check_callback : NULL;
@@ -132,3 +137,283 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+TEST(kdopbvh, FindNearestSAH_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, false, BVH_BALANCE_SAH | BVH_BALANCE_WIDE_NODES);
+}
+TEST(kdopbvh, OptimalFindNearestSAH_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, true, BVH_BALANCE_SAH);
+}
+
+/**
+ * Compare the trees built with the median and SAH splits, with and without wide nodes.
+ * All must give the same ray cast and nearest results.
+ */
+static void compare_balance_test(int points_len, int queries_len, int random_seed)
+{
+  const int balance_flags[] = {0, BVH_BALANCE_SAH, BVH_BALANCE_SAH | BVH_BALANCE_WIDE_NODES};
+  const int balance_len = ARRAY_SIZE(balance_flags);
+
+  struct RNG *rng = BLI_rng_new(random_seed);
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  float(*origins)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * queries_len, __func__);
+  float(*directions)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * queries_len, __func__);
+  float *ray_dists = (float *)MEM_mallocN(sizeof(float) * queries_len, __func__);
+  float *nearest_dists = (float *)MEM_mallocN(sizeof(float) * queries_len, __func__);
+
+  /* Clusters of points of different sizes, where the median split is bad. */
+  for (int i = 0; i < points_len; i++) {
+    const float scale = (i % 4 == 0) ? 1.0f : 0.05f;
+    rng_v3_round(points[i], 3, rng, 100000, scale);
+  }
+  for (int i = 0; i < queries_len; i++) {
+    rng_v3_round(origins[i], 3, rng, 100000, 1.5f);
+    BLI_rng_get_float_unit_v3(rng, directions[i]);
+  }
+
+  for (int b = 0; b < balance_len; b++) {
+    BVHTree *tree = BLI_bvhtree_new(points_len, 0.001f, 4, 8);
+    for (int i = 0; i < points_len; i++) {
+      BLI_bvhtree_insert(tree, i, points[i], 1);
+    }
+    BLI_bvhtree_balance_ex(tree, balance_flags[b]);
+
+    for (int i = 0; i < queries_len; i++) {
+      BVHTreeRayHit hit;
+      hit.index = -1;
+      hit.dist = BVH_RAYCAST_DIST_MAX;
+      BLI_bvhtree_ray_cast_ex(tree, origins[i], directions[i], 0.0f, &hit, NULL, NULL, 0);
+      if (b == 0) {
+        ray_dists[i] = hit.dist;
+      }
+      else {
+        EXPECT_EQ(hit.dist, ray_dists[i]);
+      }
+    }
+
+    for (int i = 0; i < queries_len; i++) {
+      BVHTreeNearest nearest;
+      nearest.index = -1;
+      nearest.dist_sq = FLT_MAX;
+      BLI_bvhtree_find_nearest_ex(tree, origins[i], &nearest, NULL, NULL, 0);
+      if (b == 0) {
+        nearest_dists[i] = nearest.dist_sq;
+      }
+      else {
+        EXPECT_EQ(nearest.dist_sq, nearest_dists[i]);
+      }
+    }
+
+    BLI_bvhtree_free(tree);
+  }
+
+  BLI_rng_free(rng);
+  MEM_freeN(points);
+  MEM_freeN(origins);
+  MEM_freeN(directions);
+  MEM_freeN(ray_dists);
+  MEM_freeN(nearest_dists);
+}
+
+TEST(kdopbvh, CompareBalance_5000)
+{
+  compare_balance_test(5000, 500, 1234);
+}
+
+/* Leafs with NaN coordinates must not be binned out of bounds by the SAH build. */
+TEST(kdopbvh, BalanceSAH_NaN)
+{
+  const int points_len = 500;
+  struct RNG *rng = BLI_rng_new(1234);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0f, 4, 8);
+
+  for (int i = 0; i < points_len; i++) {
+    float co[3];
+    rng_v3_round(co, 3, rng, 1000, 1.0f);
+    if (i % 7 == 0) {
+      co[i % 3] = NAN;
+    }
+    BLI_bvhtree_insert(tree, i, co, 1);
+  }
+  BLI_bvhtree_balance_ex(tree, BVH_BALANCE_SAH);
+  EXPECT_EQ(BLI_bvhtree_get_len(tree), points_len);
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+}
+
+static void overlap_count_test(int points_len, int random_seed)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.01f, 4, 6);
+  BVHTree *tree_wide = BLI_bvhtree_new(points_len, 0.01f, 4, 6);
+
+  for (int i = 0; i < points_len; i++) {
+    float co[3];
+    rng_v3_round(co, 3, rng, 1000, 1.0f);
+    BLI_bvhtree_insert(tree, i, co, 1);
+    BLI_bvhtree_insert(tree_wide, i, co, 1);
+  }
+  BLI_bvhtree_balance(tree);
+  BLI_bvhtree_balance_ex(tree_wide, BVH_BALANCE_SAH | BVH_BALANCE_WIDE_NODES);
+
+  uint overlap_len, overlap_wide_len;
+  BVHTreeOverlap *overlap = BLI_bvhtree_overlap(tree, tree, &overlap_len, NULL, NULL);
+  BVHTreeOverlap *overlap_wide = BLI_bvhtree_overlap(
+      tree_wide, tree_wide, &overlap_wide_len, NULL, NULL);
+  EXPECT_GT(overlap_len, 0u);
+  EXPECT_EQ(overlap_len, overlap_wide_len);
+
+  MEM_SAFE_FREE(overlap);
+  MEM_SAFE_FREE(overlap_wide);
+  BLI_bvhtree_free(tree);
+  BLI_bvhtree_free(tree_wide);
+  BLI_rng_free(rng);
+}
+
+TEST(kdopbvh, OverlapSAH_5000)
+{
+  overlap_count_test(5000, 123);
+}
+
+static float refit_cost_get(BVHTree *tree, float (*points)[3], int points_len)
+{
+  for (int i = 0; i < points_len; i++) {
+    BLI_bvhtree_update_node(tree, i, points[i], NULL, 1);
+  }
+  BLI_bvhtree_update_tree(tree);
+  return BLI_bvhtree_get_cost(tree);
+}
+
+TEST(kdopbvh, RefitCost)
+{
+  const int points_len = 1000;
+  struct RNG *rng = BLI_rng_new(1234);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 4, 6);
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 1.0f);
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  BLI_bvhtree_balance(tree);
+  const float balanced_cost = BLI_bvhtree_get_cost(tree);
+  EXPECT_GT(balanced_cost, 1.0f);
+
+  /* Scaling keeps the tree as good as it was. */
+  for (int i = 0; i < points_len; i++) {
+    mul_v3_fl(points[i], 2.0f);
+  }
+  EXPECT_NEAR(refit_cost_get(tree, points, points_len), balanced_cost, balanced_cost * 1e-3f);
+
+  /* Moving points to random places doesn't. */
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 1.0f);
+  }
+  EXPECT_GT(refit_cost_get(tree, points, points_len), balanced_cost * 2.0f);
+
+  MEM_freeN(points);
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+}
+
+static void find_nearest_batch_test(int points_len, int random_seed)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 4, 6);
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  BVHTreeNearest *nearest = (BVHTreeNearest *)MEM_mallocN(sizeof(*nearest) * points_len,
+                                                          __func__);
+
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 1.0f);
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  BLI_bvhtree_balance(tree);
+
+  /* Search for other points near the inserted ones, in random order. */
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 1.0f);
+    nearest[i].index = -1;
+    nearest[i].dist_sq = FLT_MAX;
+  }
+  BLI_bvhtree_find_nearest_batch(
+      tree, points, points_len, nearest, NULL, NULL, BVH_NEAREST_USE_THREADING);
+
+  for (int i = 0; i < points_len; i++) {
+    BVHTreeNearest expected;
+    expected.index = -1;
+    expected.dist_sq = FLT_MAX;
+    BLI_bvhtree_find_nearest(tree, points[i], &expected, NULL, NULL);
+    EXPECT_EQ(nearest[i].dist_sq, expected.dist_sq);
+  }
+
+  MEM_freeN(points);
+  MEM_freeN(nearest);
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+}
+
+TEST(kdopbvh, FindNearestBatch_1)
+{
+  find_nearest_batch_test(1, 1234);
+}
+
+TEST(kdopbvh, FindNearestBatch_5000)
+{
+  find_nearest_batch_test(5000, 1234);
+}
+
+static void ray_cast_batch_test(int points_len, int random_seed)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.01f, 4, 6);
+  BVHTreeRay *rays = (BVHTreeRay *)MEM_mallocN(sizeof(*rays) * points_len, __func__);
+  BVHTreeRayHit *hits = (BVHTreeRayHit *)MEM_mallocN(sizeof(*hits) * points_len, __func__);
+
+  for (int i = 0; i < points_len; i++) {
+    float co[3];
+    rng_v3_round(co, 3, rng, 1000, 1.0f);
+    BLI_bvhtree_insert(tree, i, co, 1);
+  }
+  BLI_bvhtree_balance(tree);
+
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(rays[i].origin, 3, rng, 1000, 1.0f);
+    BLI_rng_get_float_unit_v3(rng, rays[i].direction);
+    rays[i].radius = (i % 2) ? 0.0f : 0.01f;
+    hits[i].index = -1;
+    hits[i].dist = BVH_RAYCAST_DIST_MAX;
+  }
+  BLI_bvhtree_ray_cast_batch(tree,
+                             rays,
+                             points_len,
+                             hits,
+                             NULL,
+                             NULL,
+                             BVH_RAYCAST_DEFAULT | BVH_RAYCAST_USE_THREADING);
+
+  int hits_len = 0;
+  for (int i = 0; i < points_len; i++) {
+    BVHTreeRayHit expected;
+    expected.index = -1;
+    expected.dist = BVH_RAYCAST_DIST_MAX;
+    BLI_bvhtree_ray_cast(
+        tree, rays[i].origin, rays[i].direction, rays[i].radius, &expected, NULL, NULL);
+    EXPECT_EQ(hits[i].dist, expected.dist);
+    hits_len += (hits[i].index != -1);
+  }
+  EXPECT_GT(hits_len, 0);
+
+  MEM_freeN(rays);
+  MEM_freeN(hits);
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+}
+
+TEST(kdopbvh, RayCastBatch_5000)
+{
+  ray_cast_batch_test(5000, 1234);
+}
@@ -0,0 +1,97 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_kdopbvh.h"
+#include "BLI_math_vector.h"
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time.h"
+
+static void rng_v3_round(float *coords, int coords_len, struct RNG *rng, int round, float scale)
+{
+  for (int i = 0; i < coords_len; i++) {
+    float f = BLI_rng_get_float(rng) * 2.0f - 1.0f;
+    coords[i] = ((float)((int)(f * round)) / (float)round) * scale;
+  }
+}
+
+/* Time balancing and queries of trees built with the median and SAH splits, with and without
+ * wide nodes. */
+static void balance_test(int points_len, int queries_len, int random_seed)
+{
+  const int balance_flags[] = {0, BVH_BALANCE_SAH, BVH_BALANCE_SAH | BVH_BALANCE_WIDE_NODES};
+  const char *balance_names[] = {"Median", "SAH", "SAH wide"};
+  const int balance_len = ARRAY_SIZE(balance_flags);
+
+  struct RNG *rng = BLI_rng_new(random_seed);
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  float(*origins)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * queries_len, __func__);
+  float(*directions)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * queries_len, __func__);
+
+  /* Clusters of points of different sizes, where the median split is bad. */
+  for (int i = 0; i < points_len; i++) {
+    const float scale = (i % 4 == 0) ? 1.0f : 0.05f;
+    rng_v3_round(points[i], 3, rng, 100000, scale);
+  }
+  for (int i = 0; i < queries_len; i++) {
+    rng_v3_round(origins[i], 3, rng, 100000, 1.5f);
+    BLI_rng_get_float_unit_v3(rng, directions[i]);
+  }
+
+  printf("Trees of %d points, %d queries:\n", points_len, queries_len);
+
+  for (int b = 0; b < balance_len; b++) {
+    BVHTree *tree = BLI_bvhtree_new(points_len, 0.001f, 4, 8);
+    for (int i = 0; i < points_len; i++) {
+      BLI_bvhtree_insert(tree, i, points[i], 1);
+    }
+    double start_time = PIL_check_seconds_timer();
+    BLI_bvhtree_balance_ex(tree, balance_flags[b]);
+    const double balance_time = PIL_check_seconds_timer() - start_time;
+
+    start_time = PIL_check_seconds_timer();
+    for (int i = 0; i < queries_len; i++) {
+      BVHTreeRayHit hit;
+      hit.index = -1;
+      hit.dist = BVH_RAYCAST_DIST_MAX;
+      BLI_bvhtree_ray_cast_ex(tree, origins[i], directions[i], 0.0f, &hit, NULL, NULL, 0);
+    }
+    const double ray_cast_time = PIL_check_seconds_timer() - start_time;
+
+    start_time = PIL_check_seconds_timer();
+    for (int i = 0; i < queries_len; i++) {
+      BVHTreeNearest nearest;
+      nearest.index = -1;
+      nearest.dist_sq = FLT_MAX;
+      BLI_bvhtree_find_nearest_ex(tree, origins[i], &nearest, NULL, NULL, 0);
+    }
+    const double nearest_time = PIL_check_seconds_timer() - start_time;
+
+    printf("\t%s: balance %fs, ray casts %fs, nearest %fs\n",
+           balance_names[b],
+           balance_time,
+           ray_cast_time,
+           nearest_time);
+
+    BLI_bvhtree_free(tree);
+  }
+
+  BLI_rng_free(rng);
+  MEM_freeN(points);
+  MEM_freeN(origins);
+  MEM_freeN(directions);
+}
+
+TEST(kdopbvh, Balance_100000)
+{
+  balance_test(100000, 10000, 1234);
+}
+
+TEST(kdopbvh, Balance_1000000)
+{
+  balance_test(1000000, 100000, 1234);
+}
@@ -24,6 +24,10 @@
  * \ingroup blenloader
  */
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct GHash;
 struct Scene;
 
@@ -32,7 +36,8 @@ typedef struct {
   const char *buf;
   /** Size in bytes. */
   size_t size;
-  /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
+  /** When true, this chunk is identical to the matching one in the previous step (its buffer is
+   * shared with it). Buffers are reference counted and may also be shared with other chunks. */
   bool is_identical;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
@@ -45,7 +50,13 @@ typedef struct {
 
 typedef struct MemFile {
   ListBase chunks;
+  /** Size of the chunk buffers newly allocated for this memfile. */
   size_t size;
+  /** Size of the chunks that were found by content in the storage of other memfiles,
+   * instead of matching the previous step in write order. */
+  size_t size_deduplicated;
+  /** Size of all chunks (the size of the file when written to disk). */
+  size_t size_total;
 } MemFile;
 
 typedef struct MemFileWriteData {
@@ -78,9 +89,20 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
 extern void BLO_memfile_free(MemFile *memfile);
 extern void BLO_memfile_merge(MemFile *first, MemFile *second);
 extern void BLO_memfile_clear_future(MemFile *memfile);
+extern void BLO_memfile_copy_shared(MemFile *dst, const MemFile *src);
+extern size_t BLO_memfile_storage_size(void);
 
 /* utilities */
 extern struct Main *BLO_memfile_main_get(struct MemFile *memfile,
                                          struct Main *bmain,
                                          struct Scene **r_scene);
 extern bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename);
+extern bool BLO_memfile_write_file_ex(struct MemFile *memfile,
+                                      const char *filename,
+                                      const short *stop,
+                                      short *do_update,
+                                      float *progress);
+
+#ifdef __cplusplus
+}
+#endif
@@ -107,8 +107,12 @@
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
+#include "PIL_time.h"
+
 #include "BLT_translation.h"
 
 #include "BKE_action.h"
@@ -240,8 +244,9 @@
  * Delay reading blocks we might not use (especially applies to library linking).
  * which keeps large arrays in memory from data-blocks we may not even use.
  *
- * \note This is disabled when using compression,
+ * \note This is disabled when reading single-stream compressed files (written by older versions),
  * while zlib supports seek it's unusably slow, see: T61880.
+ * Chunked compressed files support it, see #BLEND_GZIP_CHUNK_SIZE.
  */
 #define USE_BHEAD_READ_ON_DEMAND
 
@@ -1004,6 +1009,11 @@ static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
   bool success = true;
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
   BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+  if (fd->mmap_file != NULL) {
+    /* Read without touching the file position, so this can run from multiple threads. */
+    return BLI_mmap_read(
+        fd->mmap_file, buf, (size_t)new_bhead->file_offset, (size_t)new_bhead->bhead.len);
+  }
   off64_t offset_backup = fd->file_offset;
   if (UNLIKELY(fd->seek(fd, new_bhead->file_offset, SEEK_SET) == -1)) {
     success = false;
@@ -1226,6 +1236,263 @@ static ssize_t fd_read_gzip_from_file(FileData *filedata,
   return readsize;
 }
 
+/* Chunked GZip file reading.
+ * Each chunk is decompressed on demand, which also supports seeking. */
+
+typedef struct FileDataGzipChunk {
+  /** Offset of the raw deflate data in the file. */
+  off64_t compressed_offset;
+  /** Offset of this chunk's data in the uncompressed stream. */
+  off64_t uncompressed_offset;
+  uint compressed_len;
+  uint uncompressed_len;
+  uint crc;
+} FileDataGzipChunk;
+
+typedef struct FileDataGzipChunks {
+  FileDataGzipChunk *chunks;
+  int chunks_len;
+  /** Index of the chunk currently decompressed into #buffer, -1 when none. */
+  int chunk_loaded;
+  /** Uncompressed data of #chunk_loaded. */
+  uchar *buffer;
+  uchar *compressed_buffer;
+  uint compressed_buffer_len;
+  z_stream strm;
+} FileDataGzipChunks;
+
+static uint gzip_chunk_read_uint32_le(const uchar *src)
+{
+  return (uint)src[0] | ((uint)src[1] << 8) | ((uint)src[2] << 16) | ((uint)src[3] << 24);
+}
+
+static bool gzip_chunk_header_is_valid(const uchar header[BLEND_GZIP_CHUNK_HEADER_SIZE])
+{
+  return (header[0] == 0x1f && header[1] == 0x8b && header[2] == Z_DEFLATED &&
+          header[3] == 0x04 && header[10] == BLEND_GZIP_CHUNK_XLEN && header[11] == 0 &&
+          header[12] == BLEND_GZIP_CHUNK_SI1 && header[13] == BLEND_GZIP_CHUNK_SI2 &&
+          header[14] == 4 && header[15] == 0);
+}
+
+static void gzip_chunks_free(FileDataGzipChunks *gz)
+{
+  inflateEnd(&gz->strm);
+  MEM_SAFE_FREE(gz->chunks);
+  MEM_SAFE_FREE(gz->buffer);
+  MEM_SAFE_FREE(gz->compressed_buffer);
+  MEM_freeN(gz);
+}
+
+/**
+ * Build the chunk index by reading the header and trailer of every gzip member.
+ * \return NULL when the file is not a chunked file (a regular gzip stream for e.g.).
+ */
+static FileDataGzipChunks *gzip_chunks_create(int file, size_t *r_uncompressed_size)
+{
+  FileDataGzipChunks *gz = MEM_callocN(sizeof(*gz), __func__);
+  gz->chunk_loaded = -1;
+  if (inflateInit2(&gz->strm, -MAX_WBITS) != Z_OK) {
+    MEM_freeN(gz);
+    return NULL;
+  }
+
+  const off64_t file_len = BLI_lseek(file, 0, SEEK_END);
+  off64_t offset = 0;
+  off64_t uncompressed_offset = 0;
+  int chunks_alloc = 0;
+  bool is_valid = (file_len > 0);
+
+  while (is_valid && offset < file_len) {
+    uchar header[BLEND_GZIP_CHUNK_HEADER_SIZE];
+    uchar trailer[BLEND_GZIP_CHUNK_TRAILER_SIZE];
+
+    if ((BLI_lseek(file, offset, SEEK_SET) != offset) ||
+        (read(file, header, sizeof(header)) != sizeof(header)) ||
+        !gzip_chunk_header_is_valid(header)) {
+      is_valid = false;
+      break;
+    }
+    const uint member_len = gzip_chunk_read_uint32_le(&header[16]);
+    if ((member_len < BLEND_GZIP_CHUNK_HEADER_SIZE + BLEND_GZIP_CHUNK_TRAILER_SIZE) ||
+        (offset + member_len > file_len)) {
+      is_valid = false;
+      break;
+    }
+    const off64_t trailer_offset = offset + member_len - BLEND_GZIP_CHUNK_TRAILER_SIZE;
+    if ((BLI_lseek(file, trailer_offset, SEEK_SET) != trailer_offset) ||
+        (read(file, trailer, sizeof(trailer)) != sizeof(trailer))) {
+      is_valid = false;
+      break;
+    }
+    const uint uncompressed_len = gzip_chunk_read_uint32_le(&trailer[4]);
+    if (uncompressed_len > BLEND_GZIP_CHUNK_SIZE) {
+      is_valid = false;
+      break;
+    }
+
+    if (gz->chunks_len == chunks_alloc) {
+      chunks_alloc = chunks_alloc ? chunks_alloc * 2 : 64;
+      gz->chunks = MEM_reallocN(gz->chunks, sizeof(*gz->chunks) * (size_t)chunks_alloc);
+    }
+    FileDataGzipChunk *chunk = &gz->chunks[gz->chunks_len++];
+    chunk->compressed_offset = offset + BLEND_GZIP_CHUNK_HEADER_SIZE;
+    chunk->compressed_len = member_len - BLEND_GZIP_CHUNK_HEADER_SIZE -
+                            BLEND_GZIP_CHUNK_TRAILER_SIZE;
+    chunk->uncompressed_offset = uncompressed_offset;
+    chunk->uncompressed_len = uncompressed_len;
+    chunk->crc = gzip_chunk_read_uint32_le(&trailer[0]);
+
+    offset += member_len;
+    uncompressed_offset += uncompressed_len;
+  }
+
+  BLI_lseek(file, 0, SEEK_SET);
+
+  if (!is_valid || gz->chunks_len == 0) {
+    gzip_chunks_free(gz);
+    return NULL;
+  }
+
+  gz->buffer = MEM_mallocN(BLEND_GZIP_CHUNK_SIZE, __func__);
+  *r_uncompressed_size = (size_t)uncompressed_offset;
+  return gz;
+}
+
+static int gzip_chunks_find(const FileDataGzipChunks *gz, const off64_t offset)
+{
+  if (gz->chunk_loaded != -1) {
+    const FileDataGzipChunk *chunk = &gz->chunks[gz->chunk_loaded];
+    if (offset >= chunk->uncompressed_offset &&
+        offset < chunk->uncompressed_offset + chunk->uncompressed_len) {
+      return gz->chunk_loaded;
+    }
+  }
+
+  /* Binary search for the last chunk starting at or before the offset. */
+  int low = 0, high = gz->chunks_len - 1;
+  while (low < high) {
+    const int mid = (low + high + 1) / 2;
+    if (gz->chunks[mid].uncompressed_offset <= offset) {
+      low = mid;
+    }
+    else {
+      high = mid - 1;
+    }
+  }
+  return low;
+}
+
+static bool gzip_chunk_load(FileData *filedata, const int index)
+{
+  FileDataGzipChunks *gz = filedata->gz_chunks;
+  if (gz->chunk_loaded == index) {
+    return true;
+  }
+  gz->chunk_loaded = -1;
+
+  const FileDataGzipChunk *chunk = &gz->chunks[index];
+  if (chunk->compressed_len > gz->compressed_buffer_len) {
+    MEM_SAFE_FREE(gz->compressed_buffer);
+    gz->compressed_buffer = MEM_mallocN(chunk->compressed_len, __func__);
+    gz->compressed_buffer_len = chunk->compressed_len;
+  }
+
+  if ((BLI_lseek(filedata->filedes, chunk->compressed_offset, SEEK_SET) !=
+       chunk->compressed_offset) ||
+      (read(filedata->filedes, gz->compressed_buffer, chunk->compressed_len) !=
+       (ssize_t)chunk->compressed_len)) {
+    return false;
+  }
+
+  if (inflateReset(&gz->strm) != Z_OK) {
+    return false;
+  }
+  gz->strm.next_in = gz->compressed_buffer;
+  gz->strm.avail_in = chunk->compressed_len;
+  gz->strm.next_out = gz->buffer;
+  gz->strm.avail_out = chunk->uncompressed_len;
+  if ((inflate(&gz->strm, Z_FINISH) != Z_STREAM_END) ||
+      (gz->strm.total_out != chunk->uncompressed_len) ||
+      (crc32(crc32(0, NULL, 0), gz->buffer, chunk->uncompressed_len) != chunk->crc)) {
+    printf("%s: zlib error in chunk %d\n", __func__, index);
+    return false;
+  }
+
+  gz->chunk_loaded = index;
+  return true;
+}
+
+static ssize_t fd_read_gzip_chunked_from_file(FileData *filedata,
+                                              void *buffer,
+                                              size_t size,
+                                              bool *UNUSED(r_is_memchunck_identical))
+{
+  FileDataGzipChunks *gz = filedata->gz_chunks;
+  size_t readsize = 0;
+
+  while (readsize < size && (size_t)filedata->file_offset < filedata->buffersize) {
+    const int index = gzip_chunks_find(gz, filedata->file_offset);
+    if (!gzip_chunk_load(filedata, index)) {
+      return 0;
+    }
+
+    const FileDataGzipChunk *chunk = &gz->chunks[index];
+    const size_t chunk_offset = (size_t)(filedata->file_offset - chunk->uncompressed_offset);
+    const size_t copy_len = MIN2(size - readsize, chunk->uncompressed_len - chunk_offset);
+    memcpy(POINTER_OFFSET(buffer, readsize), gz->buffer + chunk_offset, copy_len);
+    readsize += copy_len;
+    filedata->file_offset += copy_len;
+  }
+
+  return (ssize_t)readsize;
+}
+
+/* Memory-mapped file reading.
+ * By using mmap(), it is possible to skip reading data that is not needed,
+ * and data blocks can be read concurrently (see #read_data_into_datamap). */
+
+static ssize_t fd_read_from_mmap(FileData *filedata,
+                                 void *buffer,
+                                 size_t size,
+                                 bool *UNUSED(r_is_memchunck_identical))
+{
+  /* Don't read more bytes than there are available in the buffer. */
+  size_t readsize = MIN2(size, (size_t)(filedata->buffersize - filedata->file_offset));
+
+  if (!BLI_mmap_read(filedata->mmap_file, buffer, filedata->file_offset, readsize)) {
+    return 0;
+  }
+
+  filedata->file_offset += readsize;
+
+  return (ssize_t)readsize;
+}
+
+/* Seeking for readers that know the (uncompressed) file size up-front in #FileData.buffersize. */
+static off64_t fd_seek_within_size(FileData *filedata, off64_t offset, int whence)
+{
+  off64_t new_pos;
+  if (whence == SEEK_CUR) {
+    new_pos = filedata->file_offset + offset;
+  }
+  else if (whence == SEEK_SET) {
+    new_pos = offset;
+  }
+  else if (whence == SEEK_END) {
+    new_pos = (off64_t)filedata->buffersize + offset;
+  }
+  else {
+    return -1;
+  }
+
+  if (new_pos < 0 || new_pos > (off64_t)filedata->buffersize) {
+    return -1;
+  }
+
+  filedata->file_offset = new_pos;
+  return filedata->file_offset;
+}
+
 /* Memory reading. */
 
 static ssize_t fd_read_from_memory(FileData *filedata,
@@ -1371,6 +1638,9 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   FileDataSeekFn *seek_fn = NULL; /* Optional. */
 
   gzFile gzfile = (gzFile)Z_NULL;
+  BLI_mmap_file *mmap_file = NULL;
+  FileDataGzipChunks *gz_chunks = NULL;
+  size_t gz_chunks_size = 0;
 
   char header[7];
 
@@ -1391,6 +1661,26 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   if (memcmp(header, "BLENDER", sizeof(header)) == 0) {
     read_fn = fd_read_data_from_file;
     seek_fn = fd_seek_data_from_file;
+
+    /* Prefer memory-mapped reading when the platform supports it,
+     * falling back to regular reads otherwise. */
+    mmap_file = BLI_mmap_open(file);
+    if (mmap_file != NULL) {
+      read_fn = fd_read_from_mmap;
+      seek_fn = fd_seek_within_size;
+    }
+    BLI_lseek(file, 0, SEEK_SET);
+  }
+
+  /* Chunked gzip file, written by Blender. */
+  if ((read_fn == NULL) &&
+      /* Check header magic. */
+      (header[0] == 0x1f && header[1] == 0x8b)) {
+    gz_chunks = gzip_chunks_create(file, &gz_chunks_size);
+    if (gz_chunks != NULL) {
+      read_fn = fd_read_gzip_chunked_from_file;
+      seek_fn = fd_seek_within_size;
+    }
   }
 
   /* Gzip file. */
@@ -1408,7 +1698,7 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
       return NULL;
     }
 
-    /* 'seek_fn' is too slow for gzip, don't set it. */
+    /* 'seek_fn' is too slow for single-stream gzip, don't set it. */
     read_fn = fd_read_gzip_from_file;
     /* Caller must close. */
     file = -1;
@@ -1427,6 +1717,15 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   fd->read = read_fn;
   fd->seek = seek_fn;
 
+  if (mmap_file != NULL) {
+    fd->mmap_file = mmap_file;
+    fd->buffersize = BLI_mmap_get_length(mmap_file);
+  }
+  else if (gz_chunks != NULL) {
+    fd->gz_chunks = gz_chunks;
+    fd->buffersize = gz_chunks_size;
+  }
+
   return fd;
 }
 
@@ -1583,6 +1882,10 @@ void blo_filedata_free(FileData *fd)
       gzclose(fd->gzfiledes);
     }
 
+    if (fd->gz_chunks != NULL) {
+      gzip_chunks_free(fd->gz_chunks);
+    }
+
     if (fd->strm.next_in) {
       if (inflateEnd(&fd->strm) != Z_OK) {
         printf("close gzip stream error\n");
@@ -1594,6 +1897,13 @@ void blo_filedata_free(FileData *fd)
       fd->buffer = NULL;
     }
 
+    if (fd->mmap_file) {
+      BLI_mmap_free(fd->mmap_file);
+      fd->mmap_file = NULL;
+    }
+
+    MEM_SAFE_FREE(fd->timings);
+
     /* Free all BHeadN data blocks */
 #ifndef NDEBUG
     BLI_freelistN(&fd->bhead_list);
@@ -2149,7 +2459,11 @@ static void switch_endian_structs(const struct SDNA *filesdna, BHead *bhead)
   }
 }
 
-static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+/**
+ * Like #read_struct, but reports read errors in \a r_read_error instead of modifying \a fd.
+ * This makes it safe to call concurrently for different blocks when \a fd is memory-mapped.
+ */
+static void *read_struct_ex(FileData *fd, BHead *bh, const char *blockname, bool *r_read_error)
 {
   void *temp = NULL;
 
@@ -2164,7 +2478,7 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
       if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
         bh = blo_bhead_read_full(fd, bh);
         if (UNLIKELY(bh == NULL)) {
-          fd->flags &= ~FD_FLAGS_FILE_OK;
+          *r_read_error = true;
           return NULL;
         }
       }
@@ -2178,7 +2492,7 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
         if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
           bh = blo_bhead_read_full(fd, bh);
           if (UNLIKELY(bh == NULL)) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
+            *r_read_error = true;
             return NULL;
           }
         }
@@ -2196,7 +2510,7 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
           /* Instead of allocating the bhead, then copying it,
            * read the data from the file directly into the memory. */
           if (UNLIKELY(!blo_bhead_read_data(fd, bh, temp))) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
+            *r_read_error = true;
             MEM_freeN(temp);
             temp = NULL;
           }
@@ -2217,6 +2531,16 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
   return temp;
 }
 
+static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+{
+  bool read_error = false;
+  void *temp = read_struct_ex(fd, bh, blockname, &read_error);
+  if (UNLIKELY(read_error)) {
+    fd->flags &= ~FD_FLAGS_FILE_OK;
+  }
+  return temp;
+}
+
 /* Like read_struct, but gets a pointer without allocating. Only works for
  * undo since DNA must match. */
 static const void *peek_struct_undo(FileData *fd, BHead *bhead)
@@ -6232,6 +6556,80 @@ static void fix_relpaths_library(const char *basepath, Main *main)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Read Timings
+ *
+ * Statistics on where the time is spent while loading a file, broken down by ID type.
+ * Gathered and printed when running with `--debug-io`.
+ * \{ */
+
+typedef struct BLOReadTimings {
+  struct {
+    int count;
+    size_t data_size;
+    /** Time spent decoding the data blocks of the ID (reading and DNA reconstruction). */
+    double time_read_data;
+    /** Time spent in #direct_link_id. */
+    double time_direct_link;
+  } id_types[INDEX_ID_MAX];
+
+  double time_versioning;
+  double time_lib_link;
+  double time_total;
+} BLOReadTimings;
+
+static void read_timings_add_id(BLOReadTimings *timings,
+                                const short idcode,
+                                const size_t data_size,
+                                const double time_read_data,
+                                const double time_direct_link)
+{
+  const int index = BKE_idtype_idcode_to_index(idcode);
+  if (index < 0 || index >= INDEX_ID_MAX) {
+    return;
+  }
+  timings->id_types[index].count++;
+  timings->id_types[index].data_size += data_size;
+  timings->id_types[index].time_read_data += time_read_data;
+  timings->id_types[index].time_direct_link += time_direct_link;
+}
+
+static void read_timings_print(const FileData *fd, const char *filepath)
+{
+  const BLOReadTimings *timings = fd->timings;
+  double time_read_data = 0.0, time_direct_link = 0.0;
+
+  printf("Read timings for '%s'%s:\n", filepath, fd->mmap_file ? " (memory-mapped)" : "");
+  printf("  %-20s %8s %12s %14s %14s\n",
+         "ID Type",
+         "Count",
+         "Size (MiB)",
+         "Read (ms)",
+         "Link (ms)");
+  for (int index = 0; index < INDEX_ID_MAX; index++) {
+    if (timings->id_types[index].count == 0) {
+      continue;
+    }
+    const short idcode = BKE_idtype_idcode_from_index(index);
+    printf("  %-20s %8d %12.2f %14.2f %14.2f\n",
+           BKE_idtype_idcode_to_name(idcode),
+           timings->id_types[index].count,
+           (double)timings->id_types[index].data_size / (1024.0 * 1024.0),
+           timings->id_types[index].time_read_data * 1000.0,
+           timings->id_types[index].time_direct_link * 1000.0);
+    time_read_data += timings->id_types[index].time_read_data;
+    time_direct_link += timings->id_types[index].time_direct_link;
+  }
+  printf("  Read data: %.2f ms, direct link: %.2f ms, versioning: %.2f ms, lib link: %.2f ms\n",
+         time_read_data * 1000.0,
+         time_direct_link * 1000.0,
+         timings->time_versioning * 1000.0,
+         timings->time_lib_link * 1000.0);
+  printf("  Total: %.2f ms\n", timings->time_total * 1000.0);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Read Library Data Block
  * \{ */
@@ -6450,11 +6848,99 @@ static bool direct_link_id(FileData *fd, Main *main, const int tag, ID *id, ID *
   return success;
 }
 
+/**
+ * Minimum amount of data (in bytes) associated with a single ID for its blocks to be decoded
+ * in parallel, below this the threading overhead outweighs the gains.
+ */
+#define READ_DATA_PARALLEL_MIN_SIZE (1 << 20)
+
+typedef struct ReadDataTaskData {
+  FileData *fd;
+  BHead **bheads;
+  void **data;
+  bool *read_errors;
+  const char *allocname;
+} ReadDataTaskData;
+
+static void read_data_into_datamap_task(void *__restrict userdata,
+                                        const int index,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ReadDataTaskData *task_data = userdata;
+  task_data->data[index] = read_struct_ex(task_data->fd,
+                                          task_data->bheads[index],
+                                          task_data->allocname,
+                                          &task_data->read_errors[index]);
+}
+
+/**
+ * Decode the data blocks of one ID concurrently, only used for memory-mapped files
+ * since reading needs no shared file position then.
+ * Inserting into the datamap stays serial, so the resulting map is identical to serial reading.
+ */
+static BHead *read_data_into_datamap_parallel(FileData *fd,
+                                              BHead *bhead_first,
+                                              const int bheads_len,
+                                              const char *allocname)
+{
+  ReadDataTaskData task_data = {
+      .fd = fd,
+      .bheads = MEM_malloc_arrayN((size_t)bheads_len, sizeof(BHead *), __func__),
+      .data = MEM_malloc_arrayN((size_t)bheads_len, sizeof(void *), __func__),
+      .read_errors = MEM_calloc_arrayN((size_t)bheads_len, sizeof(bool), __func__),
+      .allocname = allocname,
+  };
+
+  BHead *bhead = bhead_first;
+  for (int i = 0; i < bheads_len; i++, bhead = blo_bhead_next(fd, bhead)) {
+    task_data.bheads[i] = bhead;
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, bheads_len, &task_data, read_data_into_datamap_task, &settings);
+
+  for (int i = 0; i < bheads_len; i++) {
+    if (UNLIKELY(task_data.read_errors[i])) {
+      fd->flags &= ~FD_FLAGS_FILE_OK;
+    }
+    if (task_data.data[i]) {
+      oldnewmap_insert(fd->datamap, task_data.bheads[i]->old, task_data.data[i], 0);
+    }
+  }
+
+  MEM_freeN(task_data.bheads);
+  MEM_freeN(task_data.data);
+  MEM_freeN(task_data.read_errors);
+
+  return bhead;
+}
+
 /* Read all data associated with a datablock into datamap. */
-static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *allocname)
+static BHead *read_data_into_datamap(FileData *fd,
+                                     BHead *bhead,
+                                     const char *allocname,
+                                     size_t *r_data_size)
 {
   bhead = blo_bhead_next(fd, bhead);
 
+  /* Gather the data blocks first, so large IDs (meshes with big custom-data layers for e.g.)
+   * can have their blocks decoded in parallel. */
+  BHead *bhead_first = bhead;
+  int bheads_len = 0;
+  size_t data_size = 0;
+  for (; bhead && bhead->code == DATA; bhead = blo_bhead_next(fd, bhead)) {
+    bheads_len++;
+    data_size += (size_t)bhead->len;
+  }
+  *r_data_size = data_size;
+
+  if (fd->mmap_file != NULL && bheads_len > 1 && data_size >= READ_DATA_PARALLEL_MIN_SIZE) {
+    return read_data_into_datamap_parallel(fd, bhead_first, bheads_len, allocname);
+  }
+
+  bhead = bhead_first;
   while (bhead && bhead->code == DATA) {
     /* The code below is useful for debugging leaks in data read from the blend file.
      * Without this the messages only tell us what ID-type the memory came from,
@@ -6810,10 +7296,21 @@ static BHead *read_libblock(FileData *fd,
   /* Read datablock contents.
    * Use convenient malloc name for debugging and better memory link prints. */
   const char *allocname = dataname(idcode);
-  bhead = read_data_into_datamap(fd, bhead, allocname);
+  const double time_read_start = fd->timings ? PIL_check_seconds_timer() : 0.0;
+  size_t data_size;
+  bhead = read_data_into_datamap(fd, bhead, allocname, &data_size);
+  const double time_link_start = fd->timings ? PIL_check_seconds_timer() : 0.0;
   const bool success = direct_link_id(fd, main, id_tag, id, id_old);
   oldnewmap_clear(fd->datamap);
 
+  if (fd->timings) {
+    read_timings_add_id(fd->timings,
+                        idcode,
+                        data_size,
+                        time_link_start - time_read_start,
+                        PIL_check_seconds_timer() - time_link_start);
+  }
+
   if (!success) {
     /* XXX This is probably working OK currently given the very limited scope of that flag.
      * However, it is absolutely **not** handled correctly: it is freeing an ID pointer that has
@@ -7136,7 +7633,8 @@ static BHead *read_userdef(BlendFileData *bfd, FileData *fd, BHead *bhead)
   user->subversionfile = bfd->main->subversionfile;
 
   /* read all data into fd->datamap */
-  bhead = read_data_into_datamap(fd, bhead, "user def");
+  size_t data_size;
+  bhead = read_data_into_datamap(fd, bhead, "user def", &data_size);
 
   BlendDataReader reader_ = {fd};
   BlendDataReader *reader = &reader_;
@@ -7235,6 +7733,11 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 
   bfd->type = BLENFILETYPE_BLEND;
 
+  const double time_start = PIL_check_seconds_timer();
+  if ((G.debug & G_DEBUG_IO) && fd->memfile == NULL && fd->timings == NULL) {
+    fd->timings = MEM_callocN(sizeof(*fd->timings), __func__);
+  }
+
   if ((fd->skip_flags & BLO_READ_SKIP_DATA) == 0) {
     BLI_addtail(&mainlist, bfd->main);
     fd->mainlist = &mainlist;
@@ -7315,6 +7818,7 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
   }
 
   /* do before read_libraries, but skip undo case */
+  const double time_versioning_start = PIL_check_seconds_timer();
   if (fd->memfile == NULL) {
     if ((fd->skip_flags & BLO_READ_SKIP_DATA) == 0) {
       do_versions(fd, NULL, bfd->main);
@@ -7324,13 +7828,20 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
       do_versions_userdef(fd, bfd);
     }
   }
+  if (fd->timings) {
+    fd->timings->time_versioning += PIL_check_seconds_timer() - time_versioning_start;
+  }
 
   if ((fd->skip_flags & BLO_READ_SKIP_DATA) == 0) {
     read_libraries(fd, &mainlist);
 
     blo_join_main(&mainlist);
 
+    const double time_lib_link_start = PIL_check_seconds_timer();
     lib_link_all(fd, bfd->main);
+    if (fd->timings) {
+      fd->timings->time_lib_link += PIL_check_seconds_timer() - time_lib_link_start;
+    }
 
     /* Skip in undo case. */
     if (fd->memfile == NULL) {
@@ -7381,6 +7892,12 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 
   fd->mainlist = NULL; /* Safety, this is local variable, shall not be used afterward. */
 
+  if (fd->timings) {
+    fd->timings->time_total = PIL_check_seconds_timer() - time_start;
+    read_timings_print(fd, filepath);
+    MEM_SAFE_FREE(fd->timings);
+  }
+
   return bfd;
 }
 
@@ -34,6 +34,9 @@
 #include "zlib.h"
 
 struct BLOCacheStorage;
+struct BLOReadTimings;
+struct BLI_mmap_file;
+struct FileDataGzipChunks;
 struct GSet;
 struct IDNameLib_Map;
 struct Key;
@@ -57,6 +60,33 @@ enum eFileDataFlag {
   FD_FLAGS_NOT_MY_LIBMAP = 1 << 5,
 };
 
+/**
+ * Compressed files are written as a sequence of independently compressed gzip members,
+ * each holding #BLEND_GZIP_CHUNK_SIZE bytes of uncompressed data (the last one may be smaller).
+ * A concatenation of gzip members is still a regular gzip file,
+ * so these files can be read by anything that reads compressed blend files.
+ *
+ * Each member header stores its total size in an extra field,
+ * this allows building an index of all chunks by only reading the headers and trailers,
+ * so the file can be seeked without decompressing the data in front of the requested offset.
+ *
+ * Member layout (all values little endian):
+ * - 10 bytes: gzip header with the `FEXTRA` flag set.
+ * - 2 bytes: size of the extra field (#BLEND_GZIP_CHUNK_XLEN).
+ * - 2 bytes: subfield identifier (#BLEND_GZIP_CHUNK_SI1, #BLEND_GZIP_CHUNK_SI2).
+ * - 2 bytes: subfield data size (4).
+ * - 4 bytes: total size of the member, including header and trailer.
+ * - Raw deflate data.
+ * - 4 bytes: CRC32 of the uncompressed data.
+ * - 4 bytes: size of the uncompressed data.
+ */
+#define BLEND_GZIP_CHUNK_SIZE (1 << 20)
+#define BLEND_GZIP_CHUNK_HEADER_SIZE 20
+#define BLEND_GZIP_CHUNK_TRAILER_SIZE 8
+#define BLEND_GZIP_CHUNK_XLEN 8
+#define BLEND_GZIP_CHUNK_SI1 'B'
+#define BLEND_GZIP_CHUNK_SI2 'L'
+
 /* Disallow since it's 32bit on ms-windows. */
 #ifdef __GNUC__
 #  pragma GCC poison off_t
@@ -86,8 +116,9 @@ typedef struct FileData {
   /** Regular file reading. */
   int filedes;
 
-  /** Variables needed for reading from memory / stream. */
+  /** Variables needed for reading from memory / stream / memory-mapped files. */
   const char *buffer;
+  struct BLI_mmap_file *mmap_file;
   /** Variables needed for reading from memfile (undo). */
   struct MemFile *memfile;
   /** Whether we are undoing (< 0) or redoing (> 0), used to choose which 'unchanged' flag to use
@@ -96,6 +127,8 @@ typedef struct FileData {
 
   /** Variables needed for reading from file. */
   gzFile gzfiledes;
+  /** Seekable reading of chunked compressed files, see #BLEND_GZIP_CHUNK_SIZE. */
+  struct FileDataGzipChunks *gz_chunks;
   /** Gzip stream for memory decompression. */
   z_stream strm;
 
@@ -136,6 +169,9 @@ typedef struct FileData {
   struct IDNameLib_Map *old_idmap;
 
   struct ReportList *reports;
+
+  /** Per ID type timing statistics, only allocated when running with `--debug-io`. */
+  struct BLOReadTimings *timings;
 } FileData;
 
 #define SIZEOFBLENDERHEADER 12
@@ -42,6 +42,8 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_threads.h"
 
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
@@ -54,53 +56,177 @@
 
 /* **************** support for memory-write, for undo buffers *************** */
 
+/* -------------------------------------------------------------------- */
+/** \name Shared Chunk Buffers
+ *
+ * Chunk buffers are reference counted and looked up by their content,
+ * so identical chunks are shared between all undo steps. Comparing with the matching chunk of
+ * the previous step alone misses data that moved, e.g. when an earlier chunk of the same ID
+ * changed size or a new custom-data layer was inserted.
+ * \{ */
+
+/** Only de-duplicate chunks by content from this size, smaller ones are not worth hashing. */
+#define MEMFILE_CHUNK_DEDUPLICATE_MIN_SIZE 1024
+
+typedef struct MemFileChunkBuffer {
+  /** The data, directly following this header (or the data to look up for lookup keys). */
+  const char *data;
+  size_t size;
+  uint hash;
+  /** Number of #MemFileChunk using this buffer, in any #MemFile. */
+  uint users;
+} MemFileChunkBuffer;
+
+#define MEMFILE_CHUNK_BUFFER_FROM_BUF(buf) (((MemFileChunkBuffer *)(buf)) - 1)
+
+/** Storage of all de-duplicated chunk buffers, shared between all memfiles. */
+static struct {
+  GSet *buffers;
+  /** Total size of all chunk buffers, in all memfiles. */
+  size_t size;
+  /** Allow memfiles to be read from other threads while new undo steps are written. */
+  ThreadMutex mutex;
+} memfile_chunk_storage = {NULL, 0, BLI_MUTEX_INITIALIZER};
+
+static uint memfile_chunk_buffer_hash(const void *key)
+{
+  return ((const MemFileChunkBuffer *)key)->hash;
+}
+
+static bool memfile_chunk_buffer_cmp(const void *a, const void *b)
+{
+  const MemFileChunkBuffer *buffer_a = a;
+  const MemFileChunkBuffer *buffer_b = b;
+  /* Returns false when equal, as all #GHash compare functions. */
+  return !((buffer_a->hash == buffer_b->hash) && (buffer_a->size == buffer_b->size) &&
+           (memcmp(buffer_a->data, buffer_b->data, buffer_a->size) == 0));
+}
+
+/**
+ * Return a buffer holding a copy of \a buf, shared with existing chunks when possible.
+ * \param r_is_new: Set when no buffer with the same content existed.
+ */
+static const char *memfile_chunk_buffer_ensure(const char *buf, size_t size, bool *r_is_new)
+{
+  MemFileChunkBuffer key = {buf, size, 0, 0};
+  const bool use_deduplicate = (size >= MEMFILE_CHUNK_DEDUPLICATE_MIN_SIZE);
+
+  if (use_deduplicate) {
+    key.hash = BLI_hash_mm2((const uchar *)buf, size, 0);
+  }
+
+  BLI_mutex_lock(&memfile_chunk_storage.mutex);
+
+  if (use_deduplicate && memfile_chunk_storage.buffers != NULL) {
+    MemFileChunkBuffer *buffer = BLI_gset_lookup(memfile_chunk_storage.buffers, &key);
+    if (buffer != NULL) {
+      buffer->users++;
+      BLI_mutex_unlock(&memfile_chunk_storage.mutex);
+      *r_is_new = false;
+      return buffer->data;
+    }
+  }
+
+  MemFileChunkBuffer *buffer = MEM_mallocN(sizeof(*buffer) + size, "Chunk buffer");
+  char *data = (char *)(buffer + 1);
+  memcpy(data, buf, size);
+  *buffer = key;
+  buffer->data = data;
+  buffer->users = 1;
+
+  if (use_deduplicate) {
+    if (memfile_chunk_storage.buffers == NULL) {
+      memfile_chunk_storage.buffers = BLI_gset_new(
+          memfile_chunk_buffer_hash, memfile_chunk_buffer_cmp, __func__);
+    }
+    BLI_gset_insert(memfile_chunk_storage.buffers, buffer);
+  }
+  memfile_chunk_storage.size += size;
+
+  BLI_mutex_unlock(&memfile_chunk_storage.mutex);
+
+  *r_is_new = true;
+  return data;
+}
+
+static void memfile_chunk_buffer_user_add(const char *buf)
+{
+  BLI_mutex_lock(&memfile_chunk_storage.mutex);
+  MEMFILE_CHUNK_BUFFER_FROM_BUF(buf)->users++;
+  BLI_mutex_unlock(&memfile_chunk_storage.mutex);
+}
+
+static void memfile_chunk_buffer_release(const char *buf)
+{
+  MemFileChunkBuffer *buffer = MEMFILE_CHUNK_BUFFER_FROM_BUF(buf);
+
+  BLI_mutex_lock(&memfile_chunk_storage.mutex);
+
+  BLI_assert(buffer->users > 0);
+  if (--buffer->users == 0) {
+    if (buffer->size >= MEMFILE_CHUNK_DEDUPLICATE_MIN_SIZE) {
+      BLI_gset_remove(memfile_chunk_storage.buffers, buffer, NULL);
+      if (BLI_gset_len(memfile_chunk_storage.buffers) == 0) {
+        BLI_gset_free(memfile_chunk_storage.buffers, NULL);
+        memfile_chunk_storage.buffers = NULL;
+      }
+    }
+    memfile_chunk_storage.size -= buffer->size;
+    MEM_freeN(buffer);
+  }
+
+  BLI_mutex_unlock(&memfile_chunk_storage.mutex);
+}
+
+/**
+ * Total size of the chunk buffers of all memfiles, data shared between memfiles is counted once.
+ */
+size_t BLO_memfile_storage_size(void)
+{
+  return memfile_chunk_storage.size;
+}
+
+/** \} */
+
 /* not memfile itself */
 void BLO_memfile_free(MemFile *memfile)
 {
   MemFileChunk *chunk;
 
   while ((chunk = BLI_pophead(&memfile->chunks))) {
-    if (chunk->is_identical == false) {
-      MEM_freeN((void *)chunk->buf);
-    }
+    memfile_chunk_buffer_release(chunk->buf);
     MEM_freeN(chunk);
   }
   memfile->size = 0;
+  memfile->size_deduplicated = 0;
+  memfile->size_total = 0;
 }
 
 /* to keep list of memfiles consistent, 'first' is always first in list */
 /* result is that 'first' is being freed */
 void BLO_memfile_merge(MemFile *first, MemFile *second)
 {
-  /* We use this mapping to store the memory buffers from second memfile chunks which are not owned
-   * by it (i.e. shared with some previous memory steps). */
-  GHash *buffer_to_second_memchunk = BLI_ghash_new(
-      BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, __func__);
-
-  /* First, detect all memchunks in second memfile that are not owned by it. */
-  for (MemFileChunk *sc = second->chunks.first; sc != NULL; sc = sc->next) {
-    if (sc->is_identical) {
-      BLI_ghash_insert(buffer_to_second_memchunk, (void *)sc->buf, sc);
+  /* Chunk buffers are reference counted, the ones also used by the second memfile are kept alive
+   * by it. A chunk of the second memfile that was identical to the first one now refers to the
+   * step before the first one, it only remains identical when the first one's chunk was
+   * identical to that step as well. Buffers are shared by content, so a buffer used by several
+   * chunks of the first memfile only counts as unchanged when all of them were. */
+  GHash *buffer_is_identical = BLI_ghash_ptr_new(__func__);
+  LISTBASE_FOREACH (MemFileChunk *, fc, &first->chunks) {
+    void **val_p;
+    if (!BLI_ghash_ensure_p(buffer_is_identical, (void *)fc->buf, &val_p)) {
+      *val_p = POINTER_FROM_INT(fc->is_identical);
+    }
+    else if (!fc->is_identical) {
+      *val_p = POINTER_FROM_INT(false);
     }
   }
-
-  /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
-   * it is also used by the second memfile, transfer the ownership. */
-  for (MemFileChunk *fc = first->chunks.first; fc != NULL; fc = fc->next) {
-    if (!fc->is_identical) {
-      MemFileChunk *sc = BLI_ghash_lookup(buffer_to_second_memchunk, fc->buf);
-      if (sc != NULL) {
-        BLI_assert(sc->is_identical);
-        sc->is_identical = false;
-        fc->is_identical = true;
-      }
-      /* Note that if the second memfile does not use that chunk, we assume that the first one
-       * fully owns it without sharing it with any other memfile, and hence it should be freed with
-       * it. */
+  LISTBASE_FOREACH (MemFileChunk *, sc, &second->chunks) {
+    if (sc->is_identical) {
+      sc->is_identical = POINTER_AS_INT(BLI_ghash_lookup(buffer_is_identical, sc->buf)) != 0;
     }
   }
-
-  BLI_ghash_free(buffer_to_second_memchunk, NULL, NULL);
+  BLI_ghash_free(buffer_is_identical, NULL, NULL);
 
   BLO_memfile_free(first);
 }
@@ -169,6 +295,7 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
   curchunk->is_identical_future = true;
   curchunk->id_session_uuid = mem_data->current_id_session_uuid;
   BLI_addtail(&memfile->chunks, curchunk);
+  memfile->size_total += size;
 
   /* we compare compchunk with buf */
   if (*compchunk_step != NULL) {
@@ -178,17 +305,22 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
         curchunk->buf = compchunk->buf;
         curchunk->is_identical = true;
         compchunk->is_identical_future = true;
+        memfile_chunk_buffer_user_add(curchunk->buf);
       }
     }
     *compchunk_step = compchunk->next;
   }
 
-  /* not equal... */
+  /* not equal to the matching chunk of the previous step, look it up by content... */
   if (curchunk->buf == NULL) {
-    char *buf_new = MEM_mallocN(size, "Chunk buffer");
-    memcpy(buf_new, buf, size);
-    curchunk->buf = buf_new;
-    memfile->size += size;
+    bool is_new;
+    curchunk->buf = memfile_chunk_buffer_ensure(buf, size, &is_new);
+    if (is_new) {
+      memfile->size += size;
+    }
+    else {
+      memfile->size_deduplicated += size;
+    }
   }
 }
 
@@ -215,15 +347,62 @@ struct Main *BLO_memfile_main_get(struct MemFile *memfile,
   return bmain_undo;
 }
 
+/**
+ * Make \a dst use the chunk buffers of \a src, without copying their data.
+ *
+ * Buffers are reference counted, so \a dst stays valid when \a src is freed (e.g. when its undo
+ * step is removed), this allows writing it from another thread while the undo stack changes.
+ * Free with #BLO_memfile_free.
+ */
+void BLO_memfile_copy_shared(MemFile *dst, const MemFile *src)
+{
+  BLI_listbase_clear(&dst->chunks);
+
+  LISTBASE_FOREACH (const MemFileChunk *, src_chunk, &src->chunks) {
+    MemFileChunk *chunk = MEM_mallocN(sizeof(MemFileChunk), "MemFileChunk");
+    *chunk = *src_chunk;
+    chunk->is_identical = true;
+    chunk->is_identical_future = false;
+    memfile_chunk_buffer_user_add(chunk->buf);
+    BLI_addtail(&dst->chunks, chunk);
+  }
+
+  dst->size = 0;
+  dst->size_deduplicated = 0;
+  dst->size_total = src->size_total;
+}
+
 /**
  * Saves .blend using undo buffer.
  *
  * \return success.
  */
 bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename)
+{
+  return BLO_memfile_write_file_ex(memfile, filename, NULL, NULL, NULL);
+}
+
+/**
+ * Saves .blend using undo buffer, usable from a job thread.
+ *
+ * The file is written to a temporary file next to \a filename which replaces it on success,
+ * so a cancelled or failed write never leaves a truncated file behind.
+ *
+ * \param stop: Optional, writing is cancelled when set (checked between chunks).
+ * \param do_update, progress: Optional, set as chunks are written.
+ * \return success (false when cancelled).
+ */
+bool BLO_memfile_write_file_ex(struct MemFile *memfile,
+                               const char *filename,
+                               const short *stop,
+                               short *do_update,
+                               float *progress)
 {
   MemFileChunk *chunk;
+  char tempname[FILE_MAX + 1];
   int file, oflags;
+  size_t size_written = 0;
+  bool is_cancelled = false;
 
   /* note: This is currently used for autosave and 'quit.blend',
    * where _not_ following symlinks is OK,
@@ -241,7 +420,8 @@ bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename)
 #    warning "Symbolic links will be followed on undo save, possibly causing CVE-2008-1103"
 #  endif
 #endif
-  file = BLI_open(filename, oflags, 0666);
+  BLI_snprintf(tempname, sizeof(tempname), "%s@", filename);
+  file = BLI_open(tempname, oflags, 0666);
 
   if (file == -1) {
     fprintf(stderr,
@@ -252,6 +432,10 @@ bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename)
   }
 
   for (chunk = memfile->chunks.first; chunk; chunk = chunk->next) {
+    if (stop && *stop) {
+      is_cancelled = true;
+      break;
+    }
 #ifdef _WIN32
     if ((size_t)write(file, chunk->buf, (uint)chunk->size) != chunk->size)
 #else
@@ -260,15 +444,31 @@ bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename)
     {
       break;
     }
+
+    size_written += chunk->size;
+    if (progress && memfile->size_total != 0) {
+      *progress = (float)((double)size_written / (double)memfile->size_total);
+    }
+    if (do_update) {
+      *do_update = true;
+    }
   }
 
   close(file);
 
   if (chunk) {
-    fprintf(stderr,
-            "Unable to save '%s': %s\n",
-            filename,
-            errno ? strerror(errno) : "Unknown error writing file");
+    if (!is_cancelled) {
+      fprintf(stderr,
+              "Unable to save '%s': %s\n",
+              filename,
+              errno ? strerror(errno) : "Unknown error writing file");
+    }
+    BLI_delete(tempname, false, false);
+    return false;
+  }
+
+  if (BLI_rename(tempname, filename) != 0) {
+    fprintf(stderr, "Unable to save '%s': can't change old file (file saved with @)\n", filename);
     return false;
   }
   return true;
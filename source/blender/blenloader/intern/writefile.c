@@ -124,7 +124,10 @@
 
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
+#include "BLI_endian_switch.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "MEM_guardedalloc.h" /* MEM_freeN */
 
 #include "BKE_action.h"
@@ -193,6 +196,7 @@ typedef enum {
 } eWriteWrapType;
 
 typedef struct WriteWrap WriteWrap;
+typedef struct WriteWrapGzipChunked WriteWrapGzipChunked;
 struct WriteWrap {
   /* callbacks */
   bool (*open)(WriteWrap *ww, const char *filepath);
@@ -205,7 +209,7 @@ struct WriteWrap {
   /* internal */
   union {
     int file_handle;
-    gzFile gz_handle;
+    WriteWrapGzipChunked *gz_chunked;
   } _user_data;
 };
 
@@ -235,31 +239,192 @@ static size_t ww_write_none(WriteWrap *ww, const char *buf, size_t buf_len)
 }
 #undef FILE_HANDLE
 
-/* zlib */
-#define FILE_HANDLE(ww) (ww)->_user_data.gz_handle
+/* zlib, written as independently compressed chunks, see #BLEND_GZIP_CHUNK_SIZE. */
+
+typedef struct GzipChunk {
+  /** Uncompressed input, #BLEND_GZIP_CHUNK_SIZE bytes. */
+  uchar *data;
+  size_t data_len;
+  /** The complete gzip member (header, compressed data and trailer). */
+  uchar *member;
+  size_t member_len;
+  bool error;
+} GzipChunk;
+
+struct WriteWrapGzipChunked {
+  int file_handle;
+  /** Compresses filled chunks while the next ones are being filled. */
+  TaskPool *task_pool;
+  /** Chunks are compressed in batches and written to the file in order once done. */
+  GzipChunk *chunks;
+  int chunks_len;
+  /** The chunk currently being filled. */
+  int chunk_active;
+  bool error;
+};
+
+#define GZ_CHUNKED(ww) (ww)->_user_data.gz_chunked
+
+static void gzip_chunk_write_uint32_le(uchar *dst, uint value)
+{
+#ifdef __BIG_ENDIAN__
+  BLI_endian_switch_uint32(&value);
+#endif
+  memcpy(dst, &value, sizeof(value));
+}
+
+static void gzip_chunk_compress_task(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  GzipChunk *chunk = taskdata;
+
+  z_stream strm = {NULL};
+  /* Use the fastest compression level, matching the previous single-stream `gzopen(.., "wb1")`.
+   * Negative window bits write raw deflate data, the gzip wrapper is written here. */
+  if (deflateInit2(&strm, 1, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    chunk->error = true;
+    return;
+  }
+
+  /* Size the buffer for a full chunk, so it can be reused for all chunks. */
+  const size_t member_len_max = BLEND_GZIP_CHUNK_HEADER_SIZE +
+                                deflateBound(&strm, BLEND_GZIP_CHUNK_SIZE) +
+                                BLEND_GZIP_CHUNK_TRAILER_SIZE;
+  if (chunk->member == NULL) {
+    chunk->member = MEM_mallocN(member_len_max, __func__);
+  }
+  uchar *member = chunk->member;
+
+  strm.next_in = chunk->data;
+  strm.avail_in = (uInt)chunk->data_len;
+  strm.next_out = member + BLEND_GZIP_CHUNK_HEADER_SIZE;
+  strm.avail_out = (uInt)(member_len_max - BLEND_GZIP_CHUNK_HEADER_SIZE -
+                          BLEND_GZIP_CHUNK_TRAILER_SIZE);
+  const int ret = deflate(&strm, Z_FINISH);
+  const size_t compressed_len = strm.total_out;
+  deflateEnd(&strm);
+
+  if (ret != Z_STREAM_END) {
+    chunk->error = true;
+    return;
+  }
+
+  chunk->member_len = BLEND_GZIP_CHUNK_HEADER_SIZE + compressed_len +
+                      BLEND_GZIP_CHUNK_TRAILER_SIZE;
+
+  /* Header: magic, deflate method, `FEXTRA` flag, no time-stamp, unknown OS. */
+  const uchar header[12] = {
+      0x1f, 0x8b, Z_DEFLATED, 0x04, 0, 0, 0, 0, 0, 0xff, BLEND_GZIP_CHUNK_XLEN, 0};
+  memcpy(member, header, sizeof(header));
+  member[12] = BLEND_GZIP_CHUNK_SI1;
+  member[13] = BLEND_GZIP_CHUNK_SI2;
+  member[14] = 4;
+  member[15] = 0;
+  gzip_chunk_write_uint32_le(&member[16], (uint)chunk->member_len);
+
+  /* Trailer. */
+  uchar *trailer = member + BLEND_GZIP_CHUNK_HEADER_SIZE + compressed_len;
+  gzip_chunk_write_uint32_le(&trailer[0],
+                             (uint)crc32(crc32(0, NULL, 0), chunk->data, (uInt)chunk->data_len));
+  gzip_chunk_write_uint32_le(&trailer[4], (uint)chunk->data_len);
+}
+
+/**
+ * Wait for all chunks that were filled to be compressed, then write them in order.
+ */
+static void ww_gz_chunked_flush(WriteWrapGzipChunked *gz)
+{
+  BLI_task_pool_work_and_wait(gz->task_pool);
+
+  for (int i = 0; i < gz->chunks_len; i++) {
+    GzipChunk *chunk = &gz->chunks[i];
+    if (chunk->data_len == 0) {
+      continue;
+    }
+    if (!gz->error) {
+      if (chunk->error ||
+          write(gz->file_handle, chunk->member, chunk->member_len) != (ssize_t)chunk->member_len) {
+        gz->error = true;
+      }
+    }
+    chunk->data_len = 0;
+    chunk->member_len = 0;
+    chunk->error = false;
+  }
+  gz->chunk_active = 0;
+}
 
 static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
 {
-  gzFile file;
+  int file = BLI_open(filepath, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
 
-  file = BLI_gzopen(filepath, "wb1");
+  if (file == -1) {
+    return false;
+  }
 
-  if (file != Z_NULL) {
-    FILE_HANDLE(ww) = file;
-    return true;
+  WriteWrapGzipChunked *gz = MEM_callocN(sizeof(*gz), __func__);
+  gz->file_handle = file;
+  gz->task_pool = BLI_task_pool_create(gz, TASK_PRIORITY_HIGH);
+  gz->chunks_len = MAX2(BLI_system_thread_count(), 1);
+  gz->chunks = MEM_calloc_arrayN((size_t)gz->chunks_len, sizeof(*gz->chunks), __func__);
+  for (int i = 0; i < gz->chunks_len; i++) {
+    gz->chunks[i].data = MEM_mallocN(BLEND_GZIP_CHUNK_SIZE, __func__);
   }
 
-  return false;
+  GZ_CHUNKED(ww) = gz;
+  return true;
 }
 static bool ww_close_zlib(WriteWrap *ww)
 {
-  return (gzclose(FILE_HANDLE(ww)) == Z_OK);
+  WriteWrapGzipChunked *gz = GZ_CHUNKED(ww);
+
+  /* Compress and write the last, partially filled chunk. */
+  GzipChunk *chunk = &gz->chunks[gz->chunk_active];
+  if (chunk->data_len != 0) {
+    BLI_task_pool_push(gz->task_pool, gzip_chunk_compress_task, chunk, false, NULL);
+  }
+  ww_gz_chunked_flush(gz);
+
+  bool ok = !gz->error;
+  if (close(gz->file_handle) == -1) {
+    ok = false;
+  }
+
+  BLI_task_pool_free(gz->task_pool);
+  for (int i = 0; i < gz->chunks_len; i++) {
+    MEM_freeN(gz->chunks[i].data);
+    MEM_SAFE_FREE(gz->chunks[i].member);
+  }
+  MEM_freeN(gz->chunks);
+  MEM_freeN(gz);
+  GZ_CHUNKED(ww) = NULL;
+
+  return ok;
 }
 static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 {
-  return gzwrite(FILE_HANDLE(ww), buf, buf_len);
+  WriteWrapGzipChunked *gz = GZ_CHUNKED(ww);
+  size_t buf_written = 0;
+
+  while (buf_written < buf_len) {
+    GzipChunk *chunk = &gz->chunks[gz->chunk_active];
+    const size_t copy_len = MIN2(buf_len - buf_written, BLEND_GZIP_CHUNK_SIZE - chunk->data_len);
+    memcpy(chunk->data + chunk->data_len, buf + buf_written, copy_len);
+    chunk->data_len += copy_len;
+    buf_written += copy_len;
+
+    if (chunk->data_len == BLEND_GZIP_CHUNK_SIZE) {
+      /* Start compressing this chunk while the next one is being filled. */
+      BLI_task_pool_push(gz->task_pool, gzip_chunk_compress_task, chunk, false, NULL);
+      gz->chunk_active++;
+      if (gz->chunk_active == gz->chunks_len) {
+        ww_gz_chunked_flush(gz);
+      }
+    }
+  }
+
+  return gz->error ? 0 : buf_len;
 }
-#undef FILE_HANDLE
+#undef GZ_CHUNKED
 
 /* --- end compression types --- */
 
@@ -2593,9 +2758,11 @@ bool BLO_write_file(Main *mainvar,
   }
 
   /* actual file writing */
-  const bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, use_userdef, thumb);
+  bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, use_userdef, thumb);
 
-  ww.close(&ww);
+  if (ww.close(&ww) == false) {
+    err = true;
+  }
 
   if (UNLIKELY(path_list_backup)) {
     BKE_bpath_list_restore(mainvar, path_list_flag, path_list_backup);
@@ -0,0 +1,135 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_listBase.h"
+
+#include "BLO_undofile.h"
+
+/* Write the given chunks into a new memfile, using the previous one as reference. */
+static void memfile_write_chunks(MemFile *memfile,
+                                 MemFile *reference,
+                                 const char *const *chunks,
+                                 const size_t *chunks_size,
+                                 const int chunks_len)
+{
+  MemFileWriteData mem_data = {nullptr};
+  BLO_memfile_write_init(&mem_data, memfile, reference);
+  for (int i = 0; i < chunks_len; i++) {
+    BLO_memfile_chunk_add(&mem_data, chunks[i], chunks_size[i]);
+  }
+  BLO_memfile_write_finalize(&mem_data);
+}
+
+TEST(memfile_undo, DeduplicateShiftedChunks)
+{
+  const size_t chunk_size = 4096;
+  char *data_a = static_cast<char *>(MEM_mallocN(chunk_size, __func__));
+  char *data_b = static_cast<char *>(MEM_mallocN(chunk_size, __func__));
+  char *data_c = static_cast<char *>(MEM_mallocN(chunk_size, __func__));
+  memset(data_a, 'a', chunk_size);
+  memset(data_b, 'b', chunk_size);
+  memset(data_c, 'c', chunk_size);
+
+  MemFile memfile_1 = {{nullptr}};
+  MemFile memfile_2 = {{nullptr}};
+
+  {
+    const char *chunks[] = {data_a, data_b};
+    const size_t sizes[] = {chunk_size, chunk_size};
+    memfile_write_chunks(&memfile_1, nullptr, chunks, sizes, ARRAY_SIZE(chunks));
+  }
+  EXPECT_EQ(memfile_1.size, chunk_size * 2);
+  EXPECT_EQ(memfile_1.size_deduplicated, size_t(0));
+  EXPECT_EQ(memfile_1.size_total, chunk_size * 2);
+  EXPECT_EQ(BLO_memfile_storage_size(), chunk_size * 2);
+
+  /* Inserting a chunk in front shifts the others, which are still shared by content. */
+  {
+    const char *chunks[] = {data_c, data_a, data_b};
+    const size_t sizes[] = {chunk_size, chunk_size, chunk_size};
+    memfile_write_chunks(&memfile_2, &memfile_1, chunks, sizes, ARRAY_SIZE(chunks));
+  }
+  EXPECT_EQ(memfile_2.size, chunk_size);
+  EXPECT_EQ(memfile_2.size_deduplicated, chunk_size * 2);
+  EXPECT_EQ(memfile_2.size_total, chunk_size * 3);
+  EXPECT_EQ(BLO_memfile_storage_size(), chunk_size * 3);
+
+  const MemFileChunk *chunk_1 = static_cast<const MemFileChunk *>(memfile_1.chunks.first);
+  const MemFileChunk *chunk_2 = static_cast<const MemFileChunk *>(
+      BLI_findlink(&memfile_2.chunks, 1));
+  EXPECT_EQ(chunk_1->buf, chunk_2->buf);
+  EXPECT_FALSE(chunk_2->is_identical);
+
+  /* Freeing the first step keeps the buffers still used by the second one. */
+  BLO_memfile_merge(&memfile_1, &memfile_2);
+  EXPECT_EQ(BLO_memfile_storage_size(), chunk_size * 3);
+  EXPECT_EQ(memcmp(chunk_2->buf, data_a, chunk_size), 0);
+
+  BLO_memfile_free(&memfile_2);
+  EXPECT_EQ(BLO_memfile_storage_size(), size_t(0));
+
+  MEM_freeN(data_a);
+  MEM_freeN(data_b);
+  MEM_freeN(data_c);
+}
+
+TEST(memfile_undo, MergeKeepsIdenticalChunks)
+{
+  const size_t chunk_size = 4096;
+  char *data_a = static_cast<char *>(MEM_mallocN(chunk_size, __func__));
+  char *data_b = static_cast<char *>(MEM_mallocN(chunk_size, __func__));
+  char *data_c = static_cast<char *>(MEM_mallocN(chunk_size, __func__));
+  memset(data_a, 'a', chunk_size);
+  memset(data_b, 'b', chunk_size);
+  memset(data_c, 'c', chunk_size);
+
+  MemFile memfile_1 = {{nullptr}};
+  MemFile memfile_2 = {{nullptr}};
+  MemFile memfile_3 = {{nullptr}};
+
+  const size_t sizes[] = {chunk_size, chunk_size};
+  {
+    const char *chunks[] = {data_a, data_b};
+    memfile_write_chunks(&memfile_1, nullptr, chunks, sizes, ARRAY_SIZE(chunks));
+  }
+  /* Second chunk changes. */
+  {
+    const char *chunks[] = {data_a, data_c};
+    memfile_write_chunks(&memfile_2, &memfile_1, chunks, sizes, ARRAY_SIZE(chunks));
+  }
+  /* Nothing changes. */
+  {
+    const char *chunks[] = {data_a, data_c};
+    memfile_write_chunks(&memfile_3, &memfile_2, chunks, sizes, ARRAY_SIZE(chunks));
+  }
+
+  const MemFileChunk *chunk_3_a = static_cast<const MemFileChunk *>(memfile_3.chunks.first);
+  const MemFileChunk *chunk_3_c = static_cast<const MemFileChunk *>(chunk_3_a->next);
+  EXPECT_TRUE(chunk_3_a->is_identical);
+  EXPECT_TRUE(chunk_3_c->is_identical);
+
+  /* Removing the middle step, the third one now follows the first one directly. */
+  BLO_memfile_merge(&memfile_2, &memfile_3);
+  EXPECT_TRUE(chunk_3_a->is_identical);
+  EXPECT_FALSE(chunk_3_c->is_identical);
+
+  /* Without a previous step, nothing is identical. */
+  BLO_memfile_merge(&memfile_1, &memfile_3);
+  EXPECT_FALSE(chunk_3_a->is_identical);
+  EXPECT_FALSE(chunk_3_c->is_identical);
+
+  BLO_memfile_free(&memfile_3);
+  EXPECT_EQ(BLO_memfile_storage_size(), size_t(0));
+
+  MEM_freeN(data_a);
+  MEM_freeN(data_b);
+  MEM_freeN(data_c);
+}
@@ -236,6 +236,8 @@ typedef struct BMesh {
   struct BLI_mempool *vtoolflagpool, *etoolflagpool, *ftoolflagpool;
 
   uint use_toolflags : 1;
+  /** See #BMeshCreateParams.use_eval_only. */
+  uint use_eval_only : 1;
 
   int toolflag_index;
   struct BMOperator *currentop;
@@ -164,6 +164,7 @@ BMesh *BM_mesh_create(const BMAllocTemplate *allocsize, const struct BMeshCreate
 
   /* allocate one flag pool that we don't get rid of. */
   bm->use_toolflags = params->use_toolflags;
+  bm->use_eval_only = params->use_eval_only && !(G.debug & G_DEBUG_BMESH_NO_EVAL_ONLY);
   bm->toolflag_index = 0;
   bm->totflags = 0;
 
@@ -281,6 +282,7 @@ void BM_mesh_data_free(BMesh *bm)
 void BM_mesh_clear(BMesh *bm)
 {
   const bool use_toolflags = bm->use_toolflags;
+  const bool use_eval_only = bm->use_eval_only;
 
   /* free old mesh */
   BM_mesh_data_free(bm);
@@ -290,6 +292,7 @@ void BM_mesh_clear(BMesh *bm)
   bm_mempool_init(bm, &bm_mesh_allocsize_default, use_toolflags);
 
   bm->use_toolflags = use_toolflags;
+  bm->use_eval_only = use_eval_only;
   bm->toolflag_index = 0;
   bm->totflags = 0;
 
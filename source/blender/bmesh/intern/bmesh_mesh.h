@@ -31,6 +31,14 @@ void BM_mesh_elem_toolflags_clear(BMesh *bm);
 
 struct BMeshCreateParams {
   uint use_toolflags : 1;
+  /**
+   * The BMesh only exists to evaluate a modifier, it's converted back with
+   * #BM_mesh_bm_to_me_for_eval once and freed right after. Custom-data which needs
+   * freeing (deform-weights, multi-res displacements) is moved into the result
+   * instead of duplicated, so freeing the BMesh doesn't loop over its elements.
+   * Ignored with #G_DEBUG_BMESH_NO_EVAL_ONLY, to compare timings.
+   */
+  uint use_eval_only : 1;
 };
 
 BMesh *BM_mesh_create(const struct BMAllocTemplate *allocsize,
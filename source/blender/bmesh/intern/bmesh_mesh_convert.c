@@ -81,6 +81,7 @@
 #include "BLI_alloca.h"
 #include "BLI_listbase.h"
 #include "BLI_math_vector.h"
+#include "BLI_task.h"
 
 #include "BKE_customdata.h"
 #include "BKE_mesh.h"
@@ -176,6 +177,120 @@ static BMFace *bm_face_create_from_mpoly(
   return BM_face_create(bm, verts, edges, mp->totloop, NULL, BM_CREATE_SKIP_CD);
 }
 
+/* Custom-data is copied in parallel after the elements are created,
+ * the blocks are allocated while creating them since the memory pools aren't thread safe. */
+typedef struct BMFromMeshData {
+  BMesh *bm;
+  const Mesh *me;
+
+  BMVert **vtable;
+  BMEdge **etable;
+  BMFace **ftable;
+  /* Loops by #MLoop index, NULL for loops of skipped faces. */
+  BMLoop **ltable;
+
+  const float (**shape_key_table)[3];
+  int tot_shape_keys;
+
+  int cd_vert_bweight_offset;
+  int cd_edge_bweight_offset;
+  int cd_edge_crease_offset;
+  int cd_shape_key_offset;
+  int cd_shape_keyindex_offset;
+
+  bool calc_face_normal;
+} BMFromMeshData;
+
+static void bm_from_mesh_verts_cb(void *__restrict userdata,
+                                  const int i,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMFromMeshData *data = userdata;
+  const Mesh *me = data->me;
+  BMVert *v = data->vtable[i];
+
+  /* Copy Custom Data */
+  CustomData_to_bmesh_block(&me->vdata, &data->bm->vdata, i, &v->head.data, true);
+
+  if (data->cd_vert_bweight_offset != -1) {
+    BM_ELEM_CD_SET_FLOAT(v, data->cd_vert_bweight_offset, (float)me->mvert[i].bweight / 255.0f);
+  }
+
+  /* Set shape key original index. */
+  if (data->cd_shape_keyindex_offset != -1) {
+    BM_ELEM_CD_SET_INT(v, data->cd_shape_keyindex_offset, i);
+  }
+
+  /* Set shape-key data. */
+  if (data->tot_shape_keys) {
+    float(*co_dst)[3] = BM_ELEM_CD_GET_VOID_P(v, data->cd_shape_key_offset);
+    for (int j = 0; j < data->tot_shape_keys; j++, co_dst++) {
+      copy_v3_v3(*co_dst, data->shape_key_table[j][i]);
+    }
+  }
+}
+
+static void bm_from_mesh_edges_cb(void *__restrict userdata,
+                                  const int i,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMFromMeshData *data = userdata;
+  const Mesh *me = data->me;
+  const MEdge *medge = &me->medge[i];
+  BMEdge *e = data->etable[i];
+
+  /* Copy Custom Data */
+  CustomData_to_bmesh_block(&me->edata, &data->bm->edata, i, &e->head.data, true);
+
+  if (data->cd_edge_bweight_offset != -1) {
+    BM_ELEM_CD_SET_FLOAT(e, data->cd_edge_bweight_offset, (float)medge->bweight / 255.0f);
+  }
+  if (data->cd_edge_crease_offset != -1) {
+    BM_ELEM_CD_SET_FLOAT(e, data->cd_edge_crease_offset, (float)medge->crease / 255.0f);
+  }
+}
+
+static void bm_from_mesh_loops_cb(void *__restrict userdata,
+                                  const int i,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMFromMeshData *data = userdata;
+  BMLoop *l = data->ltable[i];
+
+  if (l != NULL) {
+    CustomData_to_bmesh_block(&data->me->ldata, &data->bm->ldata, i, &l->head.data, true);
+  }
+}
+
+static void bm_from_mesh_faces_cb(void *__restrict userdata,
+                                  const int i,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMFromMeshData *data = userdata;
+  BMFace *f = data->ftable[i];
+
+  if (f == NULL) {
+    return;
+  }
+
+  /* Copy Custom Data */
+  CustomData_to_bmesh_block(&data->me->pdata, &data->bm->pdata, i, &f->head.data, true);
+
+  if (data->calc_face_normal) {
+    BM_face_normal_update(f);
+  }
+}
+
+static void bm_from_mesh_parallel_range(BMFromMeshData *data,
+                                        const int tot,
+                                        TaskParallelRangeFunc func)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (tot >= BM_OMP_LIMIT);
+  BLI_task_parallel_range(0, tot, data, func, &settings);
+}
+
 /**
  * \brief Mesh -> BMesh
  * \param bm: The mesh to write into, while this is typically a newly created BMesh,
@@ -198,6 +313,7 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
   BMVert *v, **vtable = NULL;
   BMEdge *e, **etable = NULL;
   BMFace *f, **ftable = NULL;
+  BMLoop **ltable = NULL;
   float(*keyco)[3] = NULL;
   int totloops, i;
   CustomData_MeshMasks mask = CD_MASK_BMESH;
@@ -328,25 +444,7 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
 
     normal_short_to_float_v3(v->no, mvert->no);
 
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->vdata, &bm->vdata, i, &v->head.data, true);
-
-    if (cd_vert_bweight_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(v, cd_vert_bweight_offset, (float)mvert->bweight / 255.0f);
-    }
-
-    /* Set shape key original index. */
-    if (cd_shape_keyindex_offset != -1) {
-      BM_ELEM_CD_SET_INT(v, cd_shape_keyindex_offset, i);
-    }
-
-    /* Set shape-key data. */
-    if (tot_shape_keys) {
-      float(*co_dst)[3] = BM_ELEM_CD_GET_VOID_P(v, cd_shape_key_offset);
-      for (int j = 0; j < tot_shape_keys; j++, co_dst++) {
-        copy_v3_v3(*co_dst, shape_key_table[j][i]);
-      }
-    }
+    CustomData_bmesh_alloc_block(&bm->vdata, &v->head.data);
   }
   if (is_new) {
     bm->elem_index_dirty &= ~BM_VERT; /* Added in order, clear dirty flag. */
@@ -368,24 +466,14 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
       BM_edge_select_set(bm, e, true);
     }
 
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->edata, &bm->edata, i, &e->head.data, true);
-
-    if (cd_edge_bweight_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(e, cd_edge_bweight_offset, (float)medge->bweight / 255.0f);
-    }
-    if (cd_edge_crease_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(e, cd_edge_crease_offset, (float)medge->crease / 255.0f);
-    }
+    CustomData_bmesh_alloc_block(&bm->edata, &e->head.data);
   }
   if (is_new) {
     bm->elem_index_dirty &= ~BM_EDGE; /* Added in order, clear dirty flag. */
   }
 
-  /* Only needed for selection. */
-  if (me->mselect && me->totselect != 0) {
-    ftable = MEM_mallocN(sizeof(BMFace **) * me->totpoly, __func__);
-  }
+  ftable = MEM_mallocN(sizeof(BMFace **) * me->totpoly, __func__);
+  ltable = MEM_callocN(sizeof(BMLoop **) * me->totloop, __func__);
 
   mloop = me->mloop;
   mp = me->mpoly;
@@ -393,10 +481,7 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
     BMLoop *l_iter;
     BMLoop *l_first;
 
-    f = bm_face_create_from_mpoly(mp, mloop + mp->loopstart, bm, vtable, etable);
-    if (ftable != NULL) {
-      ftable[i] = f;
-    }
+    f = ftable[i] = bm_face_create_from_mpoly(mp, mloop + mp->loopstart, bm, vtable, etable);
 
     if (UNLIKELY(f == NULL)) {
       printf(
@@ -431,20 +516,42 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
       BM_elem_index_set(l_iter, totloops++); /* set_ok */
 
       /* Save index of corresponding #MLoop. */
-      CustomData_to_bmesh_block(&me->ldata, &bm->ldata, j++, &l_iter->head.data, true);
+      ltable[j++] = l_iter;
+      CustomData_bmesh_alloc_block(&bm->ldata, &l_iter->head.data);
     } while ((l_iter = l_iter->next) != l_first);
 
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->pdata, &bm->pdata, i, &f->head.data, true);
-
-    if (params->calc_face_normal) {
-      BM_face_normal_update(f);
-    }
+    CustomData_bmesh_alloc_block(&bm->pdata, &f->head.data);
   }
   if (is_new) {
     bm->elem_index_dirty &= ~(BM_FACE | BM_LOOP); /* Added in order, clear dirty flag. */
   }
 
+  /* -------------------------------------------------------------------- */
+  /* Custom-data, copied in parallel. */
+
+  BMFromMeshData data = {
+      .bm = bm,
+      .me = me,
+      .vtable = vtable,
+      .etable = etable,
+      .ftable = ftable,
+      .ltable = ltable,
+      .shape_key_table = shape_key_table,
+      .tot_shape_keys = tot_shape_keys,
+      .cd_vert_bweight_offset = cd_vert_bweight_offset,
+      .cd_edge_bweight_offset = cd_edge_bweight_offset,
+      .cd_edge_crease_offset = cd_edge_crease_offset,
+      .cd_shape_key_offset = cd_shape_key_offset,
+      .cd_shape_keyindex_offset = cd_shape_keyindex_offset,
+      .calc_face_normal = params->calc_face_normal,
+  };
+  bm_from_mesh_parallel_range(&data, me->totvert, bm_from_mesh_verts_cb);
+  bm_from_mesh_parallel_range(&data, me->totedge, bm_from_mesh_edges_cb);
+  bm_from_mesh_parallel_range(&data, me->totloop, bm_from_mesh_loops_cb);
+  bm_from_mesh_parallel_range(&data, me->totpoly, bm_from_mesh_faces_cb);
+
+  MEM_freeN(ltable);
+
   /* -------------------------------------------------------------------- */
   /* MSelect clears the array elements (avoid adding multiple times).
    *
@@ -481,9 +588,7 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
 
   MEM_freeN(vtable);
   MEM_freeN(etable);
-  if (ftable) {
-    MEM_freeN(ftable);
-  }
+  MEM_freeN(ftable);
 }
 
 /**
@@ -568,12 +673,174 @@ BLI_INLINE void bmesh_quick_edgedraw_flag(MEdge *med, BMEdge *e)
  *
  * \param bmain: May be NULL in case \a calc_object_remap parameter option is not set.
  */
-void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMeshParams *params)
+/* Elements are written in parallel, using the element indices as the mesh indices.
+ * Face and loop indices are assigned by #bm_to_mesh_poly_loopstart_calc first. */
+typedef struct BMToMeshData {
+  BMesh *bm;
+  Mesh *me;
+
+  /* Only for evaluated meshes, NULL otherwise. */
+  int *vert_origindex;
+  int *edge_origindex;
+  int *poly_origindex;
+
+  int cd_vert_bweight_offset;
+  int cd_edge_bweight_offset;
+  int cd_edge_crease_offset;
+
+  /* Move custom-data out of the BMesh instead of copying it, see #BMesh.use_eval_only. */
+  bool use_cd_move;
+} BMToMeshData;
+
+static void bm_to_mesh_verts_cb(void *userdata, MempoolIterData *mp_v)
+{
+  BMToMeshData *data = userdata;
+  BMVert *v = (BMVert *)mp_v;
+  const int i = BM_elem_index_get(v);
+  MVert *mv = &data->me->mvert[i];
+
+  copy_v3_v3(mv->co, v->co);
+  normal_float_to_short_v3(mv->no, v->no);
+
+  mv->flag = BM_vert_flag_to_mflag(v);
+
+  if (data->vert_origindex) {
+    data->vert_origindex[i] = i;
+  }
+
+  /* Copy over custom-data. */
+  CustomData_from_bmesh_block_ex(
+      &data->bm->vdata, &data->me->vdata, v->head.data, i, data->use_cd_move);
+
+  if (data->cd_vert_bweight_offset != -1) {
+    mv->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, data->cd_vert_bweight_offset);
+  }
+
+  BM_CHECK_ELEMENT(v);
+}
+
+static void bm_to_mesh_edge(BMToMeshData *data, BMEdge *e, MEdge *med, const int i)
 {
-  MEdge *med;
-  BMVert *v, *eve;
-  BMEdge *e;
+  med->v1 = BM_elem_index_get(e->v1);
+  med->v2 = BM_elem_index_get(e->v2);
+
+  /* Copy over custom-data. */
+  CustomData_from_bmesh_block_ex(
+      &data->bm->edata, &data->me->edata, e->head.data, i, data->use_cd_move);
+
+  if (data->cd_edge_crease_offset != -1) {
+    med->crease = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, data->cd_edge_crease_offset);
+  }
+  if (data->cd_edge_bweight_offset != -1) {
+    med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, data->cd_edge_bweight_offset);
+  }
+
+  BM_CHECK_ELEMENT(e);
+}
+
+static void bm_to_mesh_edges_cb(void *userdata, MempoolIterData *mp_e)
+{
+  BMToMeshData *data = userdata;
+  BMEdge *e = (BMEdge *)mp_e;
+  const int i = BM_elem_index_get(e);
+  MEdge *med = &data->me->medge[i];
+
+  med->flag = BM_edge_flag_to_mflag(e);
+  bmesh_quick_edgedraw_flag(med, e);
+
+  bm_to_mesh_edge(data, e, med, i);
+}
+
+static void bm_to_mesh_for_eval_edges_cb(void *userdata, MempoolIterData *mp_e)
+{
+  BMToMeshData *data = userdata;
+  BMEdge *e = (BMEdge *)mp_e;
+  const int i = BM_elem_index_get(e);
+  MEdge *med = &data->me->medge[i];
+
+  med->flag = BM_edge_flag_to_mflag(e);
+
+  /* Handle this differently to editmode switching,
+   * only enable draw for single user edges rather then calculating angle. */
+  if ((med->flag & ME_EDGEDRAW) == 0) {
+    if (e->l && e->l == e->l->radial_next) {
+      med->flag |= ME_EDGEDRAW;
+    }
+  }
+
+  bm_to_mesh_edge(data, e, med, i);
+
+  if (data->edge_origindex) {
+    data->edge_origindex[i] = i;
+  }
+}
+
+/**
+ * Assign face indices and the start of every face in the loop array, a prefix sum over the face
+ * sizes. This is the only part of writing faces that can't run in parallel, the loop indices
+ * are assigned while writing the loops of each face.
+ */
+static void bm_to_mesh_poly_loopstart_calc(BMesh *bm, MPoly *mpoly)
+{
+  BMIter iter;
   BMFace *f;
+  int i, j = 0;
+
+  BM_ITER_MESH_INDEX (f, &iter, bm, BM_FACES_OF_MESH, i) {
+    BM_elem_index_set(f, i); /* set_inline */
+    mpoly[i].loopstart = j;
+    mpoly[i].totloop = f->len;
+    j += f->len;
+  }
+  BLI_assert(j == bm->totloop);
+  bm->elem_index_dirty &= ~(BM_FACE | BM_LOOP);
+}
+
+static void bm_to_mesh_faces_cb(void *userdata, MempoolIterData *mp_f)
+{
+  BMToMeshData *data = userdata;
+  BMFace *f = (BMFace *)mp_f;
+  const int i = BM_elem_index_get(f);
+  MPoly *mp = &data->me->mpoly[i];
+  BMLoop *l_iter, *l_first;
+
+  l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+  int j = mp->loopstart;
+  BLI_assert(mp->totloop == f->len && j + f->len <= data->me->totloop);
+
+  mp->mat_nr = f->mat_nr;
+  mp->flag = BM_face_flag_to_mflag(f);
+
+  do {
+    MLoop *ml = &data->me->mloop[j];
+    BM_elem_index_set(l_iter, j); /* set_inline */
+    ml->e = BM_elem_index_get(l_iter->e);
+    ml->v = BM_elem_index_get(l_iter->v);
+
+    /* Copy over custom-data. */
+    CustomData_from_bmesh_block_ex(
+        &data->bm->ldata, &data->me->ldata, l_iter->head.data, j, data->use_cd_move);
+
+    j++;
+    BM_CHECK_ELEMENT(l_iter);
+    BM_CHECK_ELEMENT(l_iter->e);
+    BM_CHECK_ELEMENT(l_iter->v);
+  } while ((l_iter = l_iter->next) != l_first);
+
+  /* Copy over custom-data. */
+  CustomData_from_bmesh_block_ex(
+      &data->bm->pdata, &data->me->pdata, f->head.data, i, data->use_cd_move);
+
+  if (data->poly_origindex) {
+    data->poly_origindex[i] = i;
+  }
+
+  BM_CHECK_ELEMENT(f);
+}
+
+void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMeshParams *params)
+{
+  BMVert *eve;
   BMIter iter;
   int i, j;
 
@@ -640,91 +907,25 @@ void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMesh
   /* This is called again, 'dotess' arg is used there. */
   BKE_mesh_update_customdata_pointers(me, 0);
 
-  i = 0;
-  BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
-    copy_v3_v3(mvert->co, v->co);
-    normal_float_to_short_v3(mvert->no, v->no);
-
-    mvert->flag = BM_vert_flag_to_mflag(v);
-
-    BM_elem_index_set(v, i); /* set_inline */
-
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->vdata, &me->vdata, v->head.data, i);
-
-    if (cd_vert_bweight_offset != -1) {
-      mvert->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, cd_vert_bweight_offset);
-    }
-
-    i++;
-    mvert++;
-
-    BM_CHECK_ELEMENT(v);
-  }
-  bm->elem_index_dirty &= ~BM_VERT;
-
-  med = medge;
-  i = 0;
-  BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
-    med->v1 = BM_elem_index_get(e->v1);
-    med->v2 = BM_elem_index_get(e->v2);
-
-    med->flag = BM_edge_flag_to_mflag(e);
-
-    BM_elem_index_set(e, i); /* set_inline */
-
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->edata, &me->edata, e->head.data, i);
-
-    bmesh_quick_edgedraw_flag(med, e);
-
-    if (cd_edge_crease_offset != -1) {
-      med->crease = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_crease_offset);
-    }
-    if (cd_edge_bweight_offset != -1) {
-      med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_bweight_offset);
-    }
-
-    i++;
-    med++;
-    BM_CHECK_ELEMENT(e);
-  }
-  bm->elem_index_dirty &= ~BM_EDGE;
-
-  i = 0;
-  j = 0;
-  BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
-    BMLoop *l_iter, *l_first;
-    mpoly->loopstart = j;
-    mpoly->totloop = f->len;
-    mpoly->mat_nr = f->mat_nr;
-    mpoly->flag = BM_face_flag_to_mflag(f);
-
-    l_iter = l_first = BM_FACE_FIRST_LOOP(f);
-    do {
-      mloop->e = BM_elem_index_get(l_iter->e);
-      mloop->v = BM_elem_index_get(l_iter->v);
-
-      /* Copy over custom-data. */
-      CustomData_from_bmesh_block(&bm->ldata, &me->ldata, l_iter->head.data, j);
-
-      j++;
-      mloop++;
-      BM_CHECK_ELEMENT(l_iter);
-      BM_CHECK_ELEMENT(l_iter->e);
-      BM_CHECK_ELEMENT(l_iter->v);
-    } while ((l_iter = l_iter->next) != l_first);
-
-    if (f == bm->act_face) {
-      me->act_face = i;
-    }
-
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->pdata, &me->pdata, f->head.data, i);
-
-    i++;
-    mpoly++;
-    BM_CHECK_ELEMENT(f);
+  BM_mesh_elem_index_ensure(bm, BM_VERT | BM_EDGE);
+  bm_to_mesh_poly_loopstart_calc(bm, mpoly);
+
+  BMToMeshData data = {
+      .bm = bm,
+      .me = me,
+      .cd_vert_bweight_offset = cd_vert_bweight_offset,
+      .cd_edge_bweight_offset = cd_edge_bweight_offset,
+      .cd_edge_crease_offset = cd_edge_crease_offset,
+  };
+  BM_iter_parallel(
+      bm, BM_VERTS_OF_MESH, bm_to_mesh_verts_cb, &data, bm->totvert >= BM_OMP_LIMIT);
+  BM_iter_parallel(
+      bm, BM_EDGES_OF_MESH, bm_to_mesh_edges_cb, &data, bm->totedge >= BM_OMP_LIMIT);
+  BM_iter_parallel(
+      bm, BM_FACES_OF_MESH, bm_to_mesh_faces_cb, &data, bm->totface >= BM_OMP_LIMIT);
+
+  if (bm->act_face) {
+    me->act_face = BM_elem_index_get(bm->act_face);
   }
 
   /* Patch hook indices and vertex parents. */
@@ -1039,117 +1240,39 @@ void BM_mesh_bm_to_me_for_eval(BMesh *bm, Mesh *me, const CustomData_MeshMasks *
 
   BKE_mesh_update_customdata_pointers(me, false);
 
-  BMIter iter;
-  BMVert *eve;
-  BMEdge *eed;
-  BMFace *efa;
-  MVert *mvert = me->mvert;
-  MEdge *medge = me->medge;
-  MLoop *mloop = me->mloop;
-  MPoly *mpoly = me->mpoly;
-  int *index, add_orig;
-  unsigned int i, j;
-
-  const int cd_vert_bweight_offset = CustomData_get_offset(&bm->vdata, CD_BWEIGHT);
-  const int cd_edge_bweight_offset = CustomData_get_offset(&bm->edata, CD_BWEIGHT);
-  const int cd_edge_crease_offset = CustomData_get_offset(&bm->edata, CD_CREASE);
-
   me->runtime.deformed_only = true;
 
   /* Don't add origindex layer if one already exists. */
-  add_orig = !CustomData_has_layer(&bm->pdata, CD_ORIGINDEX);
-
-  index = CustomData_get_layer(&me->vdata, CD_ORIGINDEX);
-
-  BM_ITER_MESH_INDEX (eve, &iter, bm, BM_VERTS_OF_MESH, i) {
-    MVert *mv = &mvert[i];
-
-    copy_v3_v3(mv->co, eve->co);
-
-    BM_elem_index_set(eve, i); /* set_inline */
-
-    normal_float_to_short_v3(mv->no, eve->no);
-
-    mv->flag = BM_vert_flag_to_mflag(eve);
-
-    if (cd_vert_bweight_offset != -1) {
-      mv->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(eve, cd_vert_bweight_offset);
-    }
-
-    if (add_orig) {
-      *index++ = i;
-    }
-
-    CustomData_from_bmesh_block(&bm->vdata, &me->vdata, eve->head.data, i);
+  const bool add_orig = !CustomData_has_layer(&bm->pdata, CD_ORIGINDEX);
+
+  BM_mesh_elem_index_ensure(bm, BM_VERT | BM_EDGE);
+  bm_to_mesh_poly_loopstart_calc(bm, me->mpoly);
+
+  BMToMeshData data = {
+      .bm = bm,
+      .me = me,
+      .vert_origindex = add_orig ? CustomData_get_layer(&me->vdata, CD_ORIGINDEX) : NULL,
+      .edge_origindex = add_orig ? CustomData_get_layer(&me->edata, CD_ORIGINDEX) : NULL,
+      .poly_origindex = add_orig ? CustomData_get_layer(&me->pdata, CD_ORIGINDEX) : NULL,
+      .cd_vert_bweight_offset = CustomData_get_offset(&bm->vdata, CD_BWEIGHT),
+      .cd_edge_bweight_offset = CustomData_get_offset(&bm->edata, CD_BWEIGHT),
+      .cd_edge_crease_offset = CustomData_get_offset(&bm->edata, CD_CREASE),
+      .use_cd_move = bm->use_eval_only,
+  };
+  BM_iter_parallel(
+      bm, BM_VERTS_OF_MESH, bm_to_mesh_verts_cb, &data, bm->totvert >= BM_OMP_LIMIT);
+  BM_iter_parallel(
+      bm, BM_EDGES_OF_MESH, bm_to_mesh_for_eval_edges_cb, &data, bm->totedge >= BM_OMP_LIMIT);
+  BM_iter_parallel(
+      bm, BM_FACES_OF_MESH, bm_to_mesh_faces_cb, &data, bm->totface >= BM_OMP_LIMIT);
+
+  if (bm->use_eval_only) {
+    /* The mesh owns the moved data now, freeing the BMesh doesn't need to visit elements. */
+    CustomData_bmesh_moved_layers_nofree(&bm->vdata, &me->vdata);
+    CustomData_bmesh_moved_layers_nofree(&bm->edata, &me->edata);
+    CustomData_bmesh_moved_layers_nofree(&bm->ldata, &me->ldata);
+    CustomData_bmesh_moved_layers_nofree(&bm->pdata, &me->pdata);
   }
-  bm->elem_index_dirty &= ~BM_VERT;
-
-  index = CustomData_get_layer(&me->edata, CD_ORIGINDEX);
-  BM_ITER_MESH_INDEX (eed, &iter, bm, BM_EDGES_OF_MESH, i) {
-    MEdge *med = &medge[i];
-
-    BM_elem_index_set(eed, i); /* set_inline */
-
-    med->v1 = BM_elem_index_get(eed->v1);
-    med->v2 = BM_elem_index_get(eed->v2);
-
-    med->flag = BM_edge_flag_to_mflag(eed);
-
-    /* Handle this differently to editmode switching,
-     * only enable draw for single user edges rather then calculating angle. */
-    if ((med->flag & ME_EDGEDRAW) == 0) {
-      if (eed->l && eed->l == eed->l->radial_next) {
-        med->flag |= ME_EDGEDRAW;
-      }
-    }
-
-    if (cd_edge_crease_offset != -1) {
-      med->crease = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(eed, cd_edge_crease_offset);
-    }
-    if (cd_edge_bweight_offset != -1) {
-      med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(eed, cd_edge_bweight_offset);
-    }
-
-    CustomData_from_bmesh_block(&bm->edata, &me->edata, eed->head.data, i);
-    if (add_orig) {
-      *index++ = i;
-    }
-  }
-  bm->elem_index_dirty &= ~BM_EDGE;
-
-  index = CustomData_get_layer(&me->pdata, CD_ORIGINDEX);
-  j = 0;
-  BM_ITER_MESH_INDEX (efa, &iter, bm, BM_FACES_OF_MESH, i) {
-    BMLoop *l_iter;
-    BMLoop *l_first;
-    MPoly *mp = &mpoly[i];
-
-    BM_elem_index_set(efa, i); /* set_inline */
-
-    mp->totloop = efa->len;
-    mp->flag = BM_face_flag_to_mflag(efa);
-    mp->loopstart = j;
-    mp->mat_nr = efa->mat_nr;
-
-    l_iter = l_first = BM_FACE_FIRST_LOOP(efa);
-    do {
-      mloop->v = BM_elem_index_get(l_iter->v);
-      mloop->e = BM_elem_index_get(l_iter->e);
-      CustomData_from_bmesh_block(&bm->ldata, &me->ldata, l_iter->head.data, j);
-
-      BM_elem_index_set(l_iter, j); /* set_inline */
-
-      j++;
-      mloop++;
-    } while ((l_iter = l_iter->next) != l_first);
-
-    CustomData_from_bmesh_block(&bm->pdata, &me->pdata, efa->head.data, i);
-
-    if (add_orig) {
-      *index++ = i;
-    }
-  }
-  bm->elem_index_dirty &= ~(BM_FACE | BM_LOOP);
 
   me->cd_flag = BM_mesh_cd_flag_from_bmesh(bm);
 }
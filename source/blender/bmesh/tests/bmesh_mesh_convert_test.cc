@@ -0,0 +1,212 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_customdata.h"
+#include "BKE_deform.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "bmesh.h"
+
+#define GRID_SIZE 50
+/* Large enough for the elements to be written in parallel, see #BM_OMP_LIMIT. */
+#define GRID_SIZE_THREADED 150
+#define NUM_GROUPS 4
+
+class BMeshMeshConvertTest : public testing::Test {
+ protected:
+  Mesh *mesh = nullptr;
+
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+
+  void TearDown() override
+  {
+    if (mesh != nullptr) {
+      BKE_id_free(nullptr, mesh);
+      mesh = nullptr;
+    }
+  }
+
+  /* Grid of quads where every vertex is in a few vertex groups, like a rigged character. */
+  void mesh_create(const int size)
+  {
+    const int verts_len = (size + 1) * (size + 1);
+    const int edges_len = 2 * size * (size + 1);
+    const int polys_len = size * size;
+    mesh = BKE_mesh_new_nomain(verts_len, edges_len, 0, polys_len * 4, polys_len);
+
+    for (int y = 0; y <= size; y++) {
+      for (int x = 0; x <= size; x++) {
+        MVert *mv = &mesh->mvert[y * (size + 1) + x];
+        mv->co[0] = (float)x / size;
+        mv->co[1] = (float)y / size;
+      }
+    }
+
+    /* Edges along x first, then along y. */
+    const int edges_y_start = size * (size + 1);
+    for (int y = 0; y <= size; y++) {
+      for (int x = 0; x < size; x++) {
+        MEdge *med = &mesh->medge[y * size + x];
+        med->v1 = y * (size + 1) + x;
+        med->v2 = med->v1 + 1;
+      }
+    }
+    for (int x = 0; x <= size; x++) {
+      for (int y = 0; y < size; y++) {
+        MEdge *med = &mesh->medge[edges_y_start + x * size + y];
+        med->v1 = y * (size + 1) + x;
+        med->v2 = med->v1 + (size + 1);
+      }
+    }
+
+    for (int y = 0; y < size; y++) {
+      for (int x = 0; x < size; x++) {
+        const int i = y * size + x;
+        const int v = y * (size + 1) + x;
+        MPoly *mp = &mesh->mpoly[i];
+        mp->loopstart = i * 4;
+        mp->totloop = 4;
+        MLoop *ml = &mesh->mloop[i * 4];
+        ml[0].v = v;
+        ml[0].e = y * size + x;
+        ml[1].v = v + 1;
+        ml[1].e = edges_y_start + (x + 1) * size + y;
+        ml[2].v = v + size + 2;
+        ml[2].e = (y + 1) * size + x;
+        ml[3].v = v + size + 1;
+        ml[3].e = edges_y_start + x * size + y;
+      }
+    }
+
+    MDeformVert *dvert = static_cast<MDeformVert *>(
+        CustomData_add_layer(&mesh->vdata, CD_MDEFORMVERT, CD_CALLOC, nullptr, verts_len));
+    for (int i = 0; i < verts_len; i++) {
+      for (int group = 0; group < NUM_GROUPS; group++) {
+        BKE_defvert_add_index_notest(&dvert[i], group, (float)(i % (group + 2)) / (group + 1));
+      }
+    }
+    BKE_mesh_update_customdata_pointers(mesh, false);
+  }
+
+  /* Conversion a BMesh based modifier does around its actual operation. */
+  Mesh *round_trip(const bool use_eval_only)
+  {
+    BMeshCreateParams create_params = {0};
+    create_params.use_eval_only = use_eval_only;
+    BMeshFromMeshParams convert_params = {0};
+    convert_params.calc_face_normal = true;
+
+    BMesh *bm = BKE_mesh_to_bmesh_ex(mesh, &create_params, &convert_params);
+    Mesh *result = BKE_mesh_from_bmesh_for_eval_nomain(bm, nullptr, mesh);
+    BM_mesh_free(bm);
+    return result;
+  }
+
+  /* Vertex group weights of the result must be the same as the weights of the mesh, also after
+   * the BMesh is freed. */
+  void expect_weights_equal(const Mesh *result)
+  {
+    ASSERT_EQ(mesh->totvert, result->totvert);
+    ASSERT_NE(nullptr, result->dvert);
+    for (int i = 0; i < mesh->totvert; i++) {
+      ASSERT_EQ(mesh->dvert[i].totweight, result->dvert[i].totweight);
+      for (int j = 0; j < mesh->dvert[i].totweight; j++) {
+        EXPECT_EQ(mesh->dvert[i].dw[j].def_nr, result->dvert[i].dw[j].def_nr);
+        EXPECT_EQ(mesh->dvert[i].dw[j].weight, result->dvert[i].dw[j].weight);
+      }
+    }
+  }
+
+  /* Elements are added to the BMesh in the order of the mesh, converting back must give the
+   * same elements in the same order, which is what writing them one by one would give. */
+  void expect_topology_equal(const Mesh *result)
+  {
+    ASSERT_EQ(mesh->totvert, result->totvert);
+    ASSERT_EQ(mesh->totedge, result->totedge);
+    ASSERT_EQ(mesh->totloop, result->totloop);
+    ASSERT_EQ(mesh->totpoly, result->totpoly);
+    for (int i = 0; i < mesh->totvert; i++) {
+      EXPECT_EQ(mesh->mvert[i].co[0], result->mvert[i].co[0]);
+      EXPECT_EQ(mesh->mvert[i].co[1], result->mvert[i].co[1]);
+    }
+    for (int i = 0; i < mesh->totedge; i++) {
+      EXPECT_EQ(mesh->medge[i].v1, result->medge[i].v1);
+      EXPECT_EQ(mesh->medge[i].v2, result->medge[i].v2);
+    }
+    for (int i = 0; i < mesh->totpoly; i++) {
+      EXPECT_EQ(mesh->mpoly[i].loopstart, result->mpoly[i].loopstart);
+      EXPECT_EQ(mesh->mpoly[i].totloop, result->mpoly[i].totloop);
+    }
+    for (int i = 0; i < mesh->totloop; i++) {
+      EXPECT_EQ(mesh->mloop[i].v, result->mloop[i].v);
+      EXPECT_EQ(mesh->mloop[i].e, result->mloop[i].e);
+    }
+  }
+};
+
+TEST_F(BMeshMeshConvertTest, RoundTripWeights)
+{
+  mesh_create(GRID_SIZE);
+
+  Mesh *result = round_trip(false);
+  expect_weights_equal(result);
+  BKE_id_free(nullptr, result);
+}
+
+TEST_F(BMeshMeshConvertTest, RoundTripEvalOnlyWeights)
+{
+  mesh_create(GRID_SIZE);
+
+  /* The weights are moved instead of copied in eval-only mode. */
+  Mesh *result = round_trip(true);
+  expect_weights_equal(result);
+  BKE_id_free(nullptr, result);
+}
+
+TEST_F(BMeshMeshConvertTest, RoundTripThreaded)
+{
+  mesh_create(GRID_SIZE_THREADED);
+  ASSERT_GE(mesh->totpoly, BM_OMP_LIMIT);
+
+  Mesh *result = round_trip(false);
+  expect_topology_equal(result);
+  expect_weights_equal(result);
+  BKE_id_free(nullptr, result);
+}
+
+TEST_F(BMeshMeshConvertTest, RoundTripEvalOnlyThreaded)
+{
+  mesh_create(GRID_SIZE_THREADED);
+  ASSERT_GE(mesh->totpoly, BM_OMP_LIMIT);
+
+  Mesh *result = round_trip(true);
+  expect_topology_equal(result);
+  expect_weights_equal(result);
+  BKE_id_free(nullptr, result);
+}
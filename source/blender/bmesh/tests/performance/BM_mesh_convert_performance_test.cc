@@ -0,0 +1,98 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BKE_customdata.h"
+#include "BKE_deform.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "bmesh.h"
+
+#include "PIL_time.h"
+
+#define GRID_SIZE 500
+#define NUM_GROUPS 4
+#define NUM_RUN_AVERAGED 3
+
+/* Grid of quads where every vertex is in a few vertex groups, like a rigged character. */
+static Mesh *mesh_create(const int size)
+{
+  const int verts_len = (size + 1) * (size + 1);
+  const int polys_len = size * size;
+  Mesh *mesh = BKE_mesh_new_nomain(verts_len, 0, 0, polys_len * 4, polys_len);
+
+  for (int y = 0; y <= size; y++) {
+    for (int x = 0; x <= size; x++) {
+      MVert *mv = &mesh->mvert[y * (size + 1) + x];
+      mv->co[0] = (float)x / size;
+      mv->co[1] = (float)y / size;
+    }
+  }
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const int i = y * size + x;
+      const int v = y * (size + 1) + x;
+      mesh->mpoly[i].loopstart = i * 4;
+      mesh->mpoly[i].totloop = 4;
+      MLoop *ml = &mesh->mloop[i * 4];
+      ml[0].v = v;
+      ml[1].v = v + 1;
+      ml[2].v = v + size + 2;
+      ml[3].v = v + size + 1;
+    }
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+
+  MDeformVert *dvert = (MDeformVert *)CustomData_add_layer(
+      &mesh->vdata, CD_MDEFORMVERT, CD_CALLOC, nullptr, verts_len);
+  for (int i = 0; i < verts_len; i++) {
+    for (int group = 0; group < NUM_GROUPS; group++) {
+      BKE_defvert_add_index_notest(&dvert[i], group, (float)(i % (group + 2)) / (group + 1));
+    }
+  }
+  BKE_mesh_update_customdata_pointers(mesh, false);
+  return mesh;
+}
+
+/* Conversion a BMesh based modifier does around its actual operation. */
+static double round_trip_time_average(Mesh *mesh, const bool use_eval_only)
+{
+  BMeshCreateParams create_params = {0};
+  create_params.use_eval_only = use_eval_only;
+  BMeshFromMeshParams convert_params = {0};
+  convert_params.calc_face_normal = true;
+
+  double time = 0.0;
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    const double start_time = PIL_check_seconds_timer();
+    BMesh *bm = BKE_mesh_to_bmesh_ex(mesh, &create_params, &convert_params);
+    Mesh *result = BKE_mesh_from_bmesh_for_eval_nomain(bm, nullptr, mesh);
+    BM_mesh_free(bm);
+    time += PIL_check_seconds_timer() - start_time;
+    BKE_id_free(nullptr, result);
+  }
+  return time / NUM_RUN_AVERAGED;
+}
+
+TEST(bmesh_mesh_convert, RoundTrip)
+{
+  BKE_idtype_init();
+  Mesh *mesh = mesh_create(GRID_SIZE);
+
+  const double full_time = round_trip_time_average(mesh, false);
+  const double eval_only_time = round_trip_time_average(mesh, true);
+
+  printf("Mesh to BMesh and back for a %dx%d grid with %d vertex groups:\n",
+         GRID_SIZE,
+         GRID_SIZE,
+         NUM_GROUPS);
+  printf("\tFull: %fs on average over %d runs\n", full_time, NUM_RUN_AVERAGED);
+  printf("\tEval only: %fs on average over %d runs\n", eval_only_time, NUM_RUN_AVERAGED);
+
+  BKE_id_free(nullptr, mesh);
+}
@@ -58,10 +58,28 @@ typedef enum CompositorPriority {
   COM_PRIORITY_LOW = 0,
 } CompositorPriority;
 
+/**
+ * \brief Possible execution models
+ * \see CompositorContext.getExecutionModel
+ * \ingroup Execution
+ */
+typedef enum CompositorExecutionModel {
+  /** \brief Operations are executed in chunks, reading input pixels one at a time */
+  COM_EM_TILED = 0,
+  /** \brief Every operation renders the whole area that is needed of it in one go */
+  COM_EM_FULL_FRAME = 1,
+} CompositorExecutionModel;
+
 // configurable items
 
 // chunk size determination
 #define COM_PREVIEW_SIZE 140.0f
+
+/**
+ * \brief Memory in bytes the result cache is trimmed to, buffers in use are never evicted.
+ * \see ResultCache
+ */
+#define COM_RESULT_CACHE_LIMIT (1024LL * 1024LL * 1024LL)
 #define COM_OPENCL_ENABLED
 //#define COM_DEBUG
 
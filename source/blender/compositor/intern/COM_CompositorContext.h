@@ -265,6 +265,19 @@ class CompositorContext {
   }
   bool isGroupnodeBufferEnabled() const
   {
-    return (this->getbNodeTree()->flag & NTREE_COM_GROUPNODE_BUFFER) != 0;
+    /* Every operation is buffered in the full frame execution model. */
+    return (this->getbNodeTree()->flag & NTREE_COM_GROUPNODE_BUFFER) != 0 &&
+           getExecutionModel() == COM_EM_TILED;
+  }
+
+  /**
+   * \brief get the execution model of the compositor, full frame execution doesn't use OpenCL
+   */
+  CompositorExecutionModel getExecutionModel() const
+  {
+    if (this->getbNodeTree()->execution_mode == NTREE_EXECUTION_MODE_FULL_FRAME) {
+      return COM_EM_FULL_FRAME;
+    }
+    return COM_EM_TILED;
   }
 };
@@ -28,6 +28,7 @@
 #include "COM_Converter.h"
 #include "COM_Debug.h"
 #include "COM_ExecutionGroup.h"
+#include "COM_FullFrameExecutionModel.h"
 #include "COM_NodeOperation.h"
 #include "COM_NodeOperationBuilder.h"
 #include "COM_ReadBufferOperation.h"
@@ -59,8 +60,10 @@ ExecutionSystem::ExecutionSystem(RenderData *rd,
     this->m_context.setQuality((CompositorQuality)editingtree->edit_quality);
   }
   this->m_context.setRendering(rendering);
-  this->m_context.setHasActiveOpenCLDevices(WorkScheduler::hasGPUDevices() &&
-                                            (editingtree->flag & NTREE_COM_OPENCL));
+  /* OpenCL devices are only used by the tiled execution model. */
+  this->m_context.setHasActiveOpenCLDevices(
+      WorkScheduler::hasGPUDevices() && (editingtree->flag & NTREE_COM_OPENCL) &&
+      this->m_context.getExecutionModel() == COM_EM_TILED);
 
   this->m_context.setRenderData(rd);
   this->m_context.setViewSettings(viewSettings);
@@ -134,6 +137,12 @@ void ExecutionSystem::execute()
 
   DebugInfo::execute_started(this);
 
+  if (this->m_context.getExecutionModel() == COM_EM_FULL_FRAME) {
+    FullFrameExecutionModel execution_model(this->m_context, this->m_operations);
+    execution_model.execute();
+    return;
+  }
+
   unsigned int order = 0;
   for (vector<NodeOperation *>::iterator iter = this->m_operations.begin();
        iter != this->m_operations.end();
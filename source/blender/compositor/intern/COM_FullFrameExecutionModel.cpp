@@ -0,0 +1,621 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <typeinfo>
+
+#include "COM_FullFrameExecutionModel.h"
+#include "COM_ReadBufferOperation.h"
+#include "COM_ResultCache.h"
+#include "COM_WriteBufferOperation.h"
+
+#include "BLI_math.h"
+#include "BLI_rect.h"
+#include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLT_translation.h"
+
+#include "DNA_scene_types.h"
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#  include "MEM_guardedalloc.h"
+#endif
+
+/* Number of stripes per thread an area is split in, so threads that finish early can help. */
+#define COM_FULL_FRAME_STRIPES_PER_THREAD 4
+
+FullFrameExecutionModel::FullFrameExecutionModel(const CompositorContext &context,
+                                                 const Operations &operations)
+    : m_context(context),
+      m_operations(operations),
+      m_num_rendered(0),
+      m_use_cache(!context.isRendering())
+{
+}
+
+FullFrameExecutionModel::~FullFrameExecutionModel()
+{
+  for (std::map<NodeOperation *, OperationState>::iterator it = m_states.begin();
+       it != m_states.end();
+       ++it) {
+    OperationState &state = it->second;
+    free_buffer(state);
+    if (state.reader) {
+      delete state.reader;
+    }
+  }
+  m_states.clear();
+
+  if (m_use_cache) {
+    ResultCache::trim();
+  }
+}
+
+void FullFrameExecutionModel::execute()
+{
+  determine_outputs(COM_PRIORITY_HIGH);
+  if (!m_context.isFastCalculation()) {
+    determine_outputs(COM_PRIORITY_MEDIUM);
+    determine_outputs(COM_PRIORITY_LOW);
+  }
+
+  for (Operations::const_iterator it = m_outputs.begin(); it != m_outputs.end(); ++it) {
+    sort_operations_recursive(*it);
+  }
+
+  link_readers();
+  init_operations();
+  determine_areas();
+  if (m_use_cache) {
+    determine_cache_keys();
+  }
+
+  for (Operations::const_iterator it = m_outputs.begin(); it != m_outputs.end(); ++it) {
+    render_operation(*it);
+  }
+
+  const bNodeTree *bTree = m_context.getbNodeTree();
+  bTree->stats_draw(bTree->sdh, TIP_("Compositing | De-initializing execution"));
+
+  deinit_operations();
+  unlink_readers();
+}
+
+void FullFrameExecutionModel::determine_outputs(CompositorPriority priority)
+{
+  const bool rendering = m_context.isRendering();
+  for (Operations::const_iterator it = m_operations.begin(); it != m_operations.end(); ++it) {
+    NodeOperation *op = *it;
+    if (op->isOutputOperation(rendering) && op->getRenderPriority() == priority) {
+      m_outputs.push_back(op);
+    }
+  }
+}
+
+void FullFrameExecutionModel::sort_operations_recursive(NodeOperation *op)
+{
+  if (m_states.find(op) != m_states.end()) {
+    return;
+  }
+
+  OperationState &state = m_states[op];
+  state.inputs.resize(op->getNumberOfInputSockets(), NULL);
+  state.proxy_input = NULL;
+  BLI_rcti_init_minmax(&state.area);
+  state.buffer = NULL;
+  state.reader = NULL;
+  state.num_readers = 0;
+  state.is_single_elem = op->getWidth() == 0 || op->getHeight() == 0 || op->isSetOperation();
+  state.is_rendered = false;
+  state.cache_key = 0;
+  state.is_cacheable = false;
+  state.is_cached = false;
+
+  for (unsigned int index = 0; index < op->getNumberOfInputSockets(); index++) {
+    NodeOperationInput *input = op->getInputSocket(index);
+    if (input->isConnected()) {
+      NodeOperation *input_op = &input->getLink()->getOperation();
+      state.inputs[index] = input_op;
+      sort_operations_recursive(input_op);
+    }
+  }
+
+  /* Read buffers created by nodes (like the wrapping of the translate node) read the result of
+   * a write buffer operation. The write buffer itself isn't executed, its input is rendered
+   * instead and its buffer is read directly. */
+  if (op->isReadBufferOperation()) {
+    MemoryProxy *proxy = ((ReadBufferOperation *)op)->getMemoryProxy();
+    if (proxy) {
+      WriteBufferOperation *write_op = proxy->getWriteBufferOperation();
+      NodeOperationInput *input = write_op->getInputSocket(0);
+      if (input->isConnected()) {
+        state.proxy_input = &input->getLink()->getOperation();
+        sort_operations_recursive(state.proxy_input);
+      }
+    }
+  }
+
+  m_sorted_operations.push_back(op);
+}
+
+ReadBufferOperation *FullFrameExecutionModel::get_reader(NodeOperation *op)
+{
+  OperationState &state = m_states[op];
+  if (state.reader == NULL) {
+    unsigned int resolution[2] = {op->getWidth(), op->getHeight()};
+    state.reader = new ReadBufferOperation(op->getOutputSocket()->getDataType());
+    state.reader->setResolution(resolution);
+    state.reader->setbNodeTree(m_context.getbNodeTree());
+  }
+  return state.reader;
+}
+
+void FullFrameExecutionModel::link_readers()
+{
+  for (Operations::const_iterator it = m_sorted_operations.begin();
+       it != m_sorted_operations.end();
+       ++it) {
+    NodeOperation *op = *it;
+    OperationState &state = m_states[op];
+    for (unsigned int index = 0; index < state.inputs.size(); index++) {
+      NodeOperation *input_op = state.inputs[index];
+      if (input_op == NULL) {
+        continue;
+      }
+      NodeOperationInput *input = op->getInputSocket(index);
+      m_input_links.push_back(std::make_pair(input, input->getLink()));
+      input->setLink(get_reader(input_op)->getOutputSocket());
+    }
+  }
+}
+
+void FullFrameExecutionModel::unlink_readers()
+{
+  for (unsigned int index = 0; index < m_input_links.size(); index++) {
+    m_input_links[index].first->setLink(m_input_links[index].second);
+  }
+  m_input_links.clear();
+}
+
+void FullFrameExecutionModel::init_operations()
+{
+  for (Operations::const_iterator it = m_sorted_operations.begin();
+       it != m_sorted_operations.end();
+       ++it) {
+    NodeOperation *op = *it;
+    op->setbNodeTree(m_context.getbNodeTree());
+    op->initExecution();
+  }
+}
+
+void FullFrameExecutionModel::deinit_operations()
+{
+  for (Operations::const_iterator it = m_sorted_operations.begin();
+       it != m_sorted_operations.end();
+       ++it) {
+    NodeOperation *op = *it;
+    if (op->isReadBufferOperation()) {
+      ((ReadBufferOperation *)op)->setMemoryBuffer(NULL);
+    }
+    op->deinitExecution();
+  }
+}
+
+void FullFrameExecutionModel::determine_output_area(NodeOperation *output, rcti *r_area)
+{
+  const int width = output->getWidth();
+  const int height = output->getHeight();
+  BLI_rcti_init(r_area, 0, width, 0, height);
+
+  /* Same borders as ExecutionGroup.setViewerBorder and ExecutionGroup.setRenderBorder. */
+  const bNodeTree *bTree = m_context.getbNodeTree();
+  const rctf *viewer_border = &bTree->viewer_border;
+  const bool use_viewer_border = (bTree->flag & NTREE_VIEWER_BORDER) &&
+                                 viewer_border->xmin < viewer_border->xmax &&
+                                 viewer_border->ymin < viewer_border->ymax;
+  const bool is_viewer = output->isViewerOperation() || output->isPreviewOperation();
+
+  if (use_viewer_border && is_viewer) {
+    BLI_rcti_init(r_area,
+                  viewer_border->xmin * width,
+                  viewer_border->xmax * width,
+                  viewer_border->ymin * height,
+                  viewer_border->ymax * height);
+  }
+
+  const RenderData *rd = m_context.getRenderData();
+  if (m_context.isRendering() && rd && (rd->mode & R_BORDER) && !(rd->mode & R_CROP) &&
+      output->isOutputOperation(true) && !is_viewer && !output->isFileOutputOperation()) {
+    BLI_rcti_init(r_area,
+                  rd->border.xmin * width,
+                  rd->border.xmax * width,
+                  rd->border.ymin * height,
+                  rd->border.ymax * height);
+  }
+}
+
+void FullFrameExecutionModel::determine_areas()
+{
+  for (Operations::const_iterator it = m_outputs.begin(); it != m_outputs.end(); ++it) {
+    determine_output_area(*it, &m_states[*it].area);
+  }
+
+  /* Operations reading a buffer come after it in the sorted operations, so all readers have
+   * their area determined when going backwards. */
+  for (Operations::const_reverse_iterator it = m_sorted_operations.rbegin();
+       it != m_sorted_operations.rend();
+       ++it) {
+    NodeOperation *op = *it;
+    OperationState &state = m_states[op];
+    const bool has_area = !BLI_rcti_is_empty(&state.area);
+
+    for (unsigned int index = 0; index < state.inputs.size(); index++) {
+      NodeOperation *input_op = state.inputs[index];
+      if (input_op == NULL ||
+          std::find(state.inputs.begin(), state.inputs.begin() + index, input_op) !=
+              state.inputs.begin() + index) {
+        continue;
+      }
+      OperationState &input_state = m_states[input_op];
+      input_state.num_readers++;
+      if (op->isComplex()) {
+        /* Complex operations access the input buffer directly. */
+        input_state.is_single_elem = input_op->getWidth() == 0 || input_op->getHeight() == 0;
+      }
+
+      rcti input_area;
+      if (has_area &&
+          op->determineDependingAreaOfInterest(&state.area, input_state.reader, &input_area)) {
+        rcti bounds;
+        BLI_rcti_init(&bounds, 0, input_op->getWidth(), 0, input_op->getHeight());
+        if (BLI_rcti_isect(&input_area, &bounds, &input_area)) {
+          BLI_rcti_union(&input_state.area, &input_area);
+        }
+      }
+    }
+
+    if (state.proxy_input) {
+      NodeOperation *input_op = state.proxy_input;
+      OperationState &input_state = m_states[input_op];
+      input_state.num_readers++;
+      input_state.is_single_elem = input_op->getWidth() == 0 || input_op->getHeight() == 0;
+      if (has_area) {
+        rcti input_area;
+        BLI_rcti_init(&input_area, 0, input_op->getWidth(), 0, input_op->getHeight());
+        BLI_rcti_union(&input_state.area, &input_area);
+      }
+    }
+  }
+}
+
+uint64_t FullFrameExecutionModel::context_hash() const
+{
+  uint64_t hash = ResultCache::hashCombine(0, m_context.getQuality());
+  hash = ResultCache::hashCombine(hash, m_context.getFramenumber());
+  hash = ResultCache::hashCombine(hash, m_context.isFastCalculation());
+
+  const RenderData *rd = m_context.getRenderData();
+  if (rd) {
+    hash = ResultCache::hashCombine(hash, rd->xsch);
+    hash = ResultCache::hashCombine(hash, rd->ysch);
+    hash = ResultCache::hashCombine(hash, rd->size);
+  }
+
+  const char *view_name = m_context.getViewName();
+  if (view_name) {
+    hash = ResultCache::hashBytes(hash, view_name, strlen(view_name));
+  }
+  return hash;
+}
+
+void FullFrameExecutionModel::determine_cache_keys()
+{
+  const uint64_t context_key = context_hash();
+
+  /* Inputs come first in the sorted operations, so their keys are known. */
+  for (Operations::const_iterator it = m_sorted_operations.begin();
+       it != m_sorted_operations.end();
+       ++it) {
+    NodeOperation *op = *it;
+    OperationState &state = m_states[op];
+
+    const char *type_name = typeid(*op).name();
+    uint64_t key = ResultCache::hashBytes(context_key, type_name, strlen(type_name));
+    key = ResultCache::hashCombine(key, op->getNodeHash());
+    key = ResultCache::hashCombine(key, op->getWidth());
+    key = ResultCache::hashCombine(key, op->getHeight());
+    if (op->getNumberOfOutputSockets() > 0) {
+      key = ResultCache::hashCombine(key, op->getOutputSocket()->getDataType());
+    }
+
+    bool cacheable = op->isNodeCacheable();
+    for (unsigned int index = 0; index < state.inputs.size(); index++) {
+      NodeOperation *input_op = state.inputs[index];
+      if (input_op == NULL) {
+        key = ResultCache::hashCombine(key, 0);
+        continue;
+      }
+      const OperationState &input_state = m_states[input_op];
+      key = ResultCache::hashCombine(key, input_state.cache_key);
+      cacheable = cacheable && input_state.is_cacheable;
+    }
+    if (state.proxy_input) {
+      const OperationState &input_state = m_states[state.proxy_input];
+      key = ResultCache::hashCombine(key, input_state.cache_key);
+      cacheable = cacheable && input_state.is_cacheable;
+    }
+
+    state.is_cacheable = cacheable && op->hashExecutionData(&key);
+    state.cache_key = key;
+  }
+}
+
+void FullFrameExecutionModel::render_operation(NodeOperation *op)
+{
+  OperationState &state = m_states[op];
+  if (state.is_rendered) {
+    return;
+  }
+  state.is_rendered = true;
+
+  const bool has_output = op->getNumberOfOutputSockets() > 0;
+  const bool use_cache = has_output && state.is_cacheable && !state.is_single_elem &&
+                         !BLI_rcti_is_empty(&state.area);
+  if (use_cache) {
+    state.buffer = ResultCache::acquire(state.cache_key, &state.area);
+    if (state.buffer) {
+      /* The inputs aren't rendered, unless other operations need them. */
+      state.is_cached = true;
+      if (state.reader) {
+        state.reader->setMemoryBuffer(state.buffer);
+      }
+      if (state.num_readers == 0) {
+        free_buffer(state);
+      }
+      release_inputs(op);
+      m_num_rendered++;
+      update_progress_bar();
+      return;
+    }
+  }
+
+  std::vector<MemoryBuffer *> inputs(state.inputs.size(), NULL);
+  for (unsigned int index = 0; index < state.inputs.size(); index++) {
+    if (state.inputs[index]) {
+      render_operation(state.inputs[index]);
+      inputs[index] = m_states[state.inputs[index]].buffer;
+    }
+  }
+  if (state.proxy_input) {
+    render_operation(state.proxy_input);
+    ((ReadBufferOperation *)op)->setMemoryBuffer(m_states[state.proxy_input].buffer);
+  }
+
+  const bool breaked = is_breaked();
+  if (!has_output) {
+    if (!breaked) {
+      execute_area(op, NULL, &state.area, inputs.data());
+    }
+  }
+  else {
+    /* Readers still get a buffer when the execution is cancelled. */
+    state.buffer = create_buffer(op, state);
+    if (!breaked) {
+      execute_area(op, state.buffer, &state.area, inputs.data());
+      if (use_cache && ResultCache::add(state.cache_key, state.buffer, &state.area)) {
+        state.is_cached = true;
+      }
+    }
+    if (state.reader) {
+      state.reader->setMemoryBuffer(state.buffer);
+    }
+    if (state.num_readers == 0) {
+      free_buffer(state);
+    }
+  }
+
+  if (state.proxy_input) {
+    ((ReadBufferOperation *)op)->setMemoryBuffer(NULL);
+  }
+  release_inputs(op);
+
+  m_num_rendered++;
+  update_progress_bar();
+}
+
+MemoryBuffer *FullFrameExecutionModel::create_buffer(NodeOperation *op, OperationState &state)
+{
+  const DataType datatype = op->getOutputSocket()->getDataType();
+  rcti rect;
+  if (state.is_single_elem) {
+    BLI_rcti_init(&rect, 0, 1, 0, 1);
+    state.area = rect;
+    return new MemoryBuffer(datatype, &rect, true);
+  }
+
+  BLI_rcti_init(&rect, 0, op->getWidth(), 0, op->getHeight());
+  MemoryBuffer *buffer = new MemoryBuffer(datatype, &rect);
+  /* Readers may sample outside of the area they need, when interpolating. */
+  if (BLI_rcti_is_empty(&state.area) || !BLI_rcti_compare(&rect, &state.area)) {
+    buffer->clear();
+  }
+  return buffer;
+}
+
+void FullFrameExecutionModel::release_input(NodeOperation *input)
+{
+  OperationState &state = m_states[input];
+  state.num_readers--;
+  if (state.num_readers > 0) {
+    return;
+  }
+  if (!state.is_rendered) {
+    /* All readers were taken from the cache, the inputs aren't needed either. */
+    state.is_rendered = true;
+    release_inputs(input);
+    return;
+  }
+  if (state.reader) {
+    state.reader->setMemoryBuffer(NULL);
+  }
+  free_buffer(state);
+}
+
+void FullFrameExecutionModel::release_inputs(NodeOperation *op)
+{
+  OperationState &state = m_states[op];
+  if (state.proxy_input) {
+    release_input(state.proxy_input);
+  }
+  for (unsigned int index = 0; index < state.inputs.size(); index++) {
+    NodeOperation *input_op = state.inputs[index];
+    if (input_op &&
+        std::find(state.inputs.begin(), state.inputs.begin() + index, input_op) ==
+            state.inputs.begin() + index) {
+      release_input(input_op);
+    }
+  }
+}
+
+void FullFrameExecutionModel::free_buffer(OperationState &state)
+{
+  if (state.buffer == NULL) {
+    return;
+  }
+  if (state.is_cached) {
+    ResultCache::release(state.cache_key);
+    state.is_cached = false;
+  }
+  else {
+    delete state.buffer;
+  }
+  state.buffer = NULL;
+}
+
+typedef struct FullFrameExecuteData {
+  NodeOperation *op;
+  MemoryBuffer *output;
+  MemoryBuffer **inputs;
+  rcti *area;
+  int stripe_height;
+} FullFrameExecuteData;
+
+/* Executes an operation pixel by pixel, like WriteBufferOperation.executeRegion. */
+static void execute_pixels(NodeOperation *op, MemoryBuffer *output, rcti *rect)
+{
+  const int stride = output->getElemStride();
+  if (op->isComplex()) {
+    void *data = op->initializeTileData(rect);
+    for (int y = rect->ymin; y < rect->ymax; y++) {
+      float *out = output->getElem(rect->xmin, y);
+      for (int x = rect->xmin; x < rect->xmax; x++) {
+        op->read(out, x, y, data);
+        out += stride;
+      }
+    }
+    if (data) {
+      op->deinitializeTileData(rect, data);
+    }
+  }
+  else {
+    for (int y = rect->ymin; y < rect->ymax; y++) {
+      float *out = output->getElem(rect->xmin, y);
+      for (int x = rect->xmin; x < rect->xmax; x++) {
+        op->readSampled(out, x, y, COM_PS_NEAREST);
+        out += stride;
+      }
+    }
+  }
+}
+
+static void execute_stripe_cb(void *__restrict userdata,
+                              const int stripe,
+                              const TaskParallelTLS *__restrict /*tls*/)
+{
+  FullFrameExecuteData *data = (FullFrameExecuteData *)userdata;
+  NodeOperation *op = data->op;
+
+  rcti rect = *data->area;
+  rect.ymin = data->area->ymin + stripe * data->stripe_height;
+  rect.ymax = min_ii(rect.ymin + data->stripe_height, data->area->ymax);
+  if (BLI_rcti_is_empty(&rect)) {
+    return;
+  }
+
+  if (data->output == NULL) {
+    op->executeRegion(&rect, stripe);
+  }
+  else if (op->isFullFrame()) {
+    op->executeFullFrame(data->output, &rect, data->inputs);
+  }
+  else {
+    execute_pixels(op, data->output, &rect);
+  }
+}
+
+void FullFrameExecutionModel::execute_area(NodeOperation *op,
+                                           MemoryBuffer *output,
+                                           rcti *area,
+                                           MemoryBuffer **inputs)
+{
+  if (BLI_rcti_is_empty(area)) {
+    return;
+  }
+
+  const int height = BLI_rcti_size_y(area);
+  int num_stripes = 1;
+  if (!op->isSingleThreaded()) {
+    num_stripes = min_ii(height,
+                         BLI_task_scheduler_num_threads() * COM_FULL_FRAME_STRIPES_PER_THREAD);
+  }
+
+  FullFrameExecuteData data;
+  data.op = op;
+  data.output = output;
+  data.inputs = inputs;
+  data.area = area;
+  data.stripe_height = (height + num_stripes - 1) / num_stripes;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = num_stripes > 1;
+  BLI_task_parallel_range(0, num_stripes, &data, execute_stripe_cb, &settings);
+}
+
+bool FullFrameExecutionModel::is_breaked() const
+{
+  const bNodeTree *bTree = m_context.getbNodeTree();
+  return bTree->test_break && bTree->test_break(bTree->tbh);
+}
+
+void FullFrameExecutionModel::update_progress_bar()
+{
+  const bNodeTree *bTree = m_context.getbNodeTree();
+  float progress = m_num_rendered;
+  progress /= m_sorted_operations.size();
+  bTree->progress(bTree->prh, progress);
+
+  char buf[128];
+  BLI_snprintf(buf,
+               sizeof(buf),
+               TIP_("Compositing | Operation %u-%u"),
+               m_num_rendered,
+               (unsigned int)m_sorted_operations.size());
+  bTree->stats_draw(bTree->sdh, buf);
+}
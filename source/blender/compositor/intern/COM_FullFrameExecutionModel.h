@@ -0,0 +1,131 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#pragma once
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "COM_CompositorContext.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_NodeOperation.h"
+
+class ReadBufferOperation;
+
+/**
+ * \brief Executes the operations of an ExecutionSystem one after another, every operation
+ * renders the whole area that is needed of it into a buffer.
+ *
+ * First the area that is needed of every operation is determined, starting at the output
+ * operations. Then the operations are rendered depth first from the outputs: the inputs of an
+ * operation are rendered before the operation itself. A buffer is freed as soon as all
+ * operations reading it are rendered.
+ *
+ * Inputs of the operations are linked to ReadBufferOperations that read the rendered buffers, so
+ * operations that don't implement NodeOperation.executeFullFrame are executed pixel by pixel the
+ * same way as in the tiled execution model.
+ *
+ * Compared to the tiled execution model more memory is used, but work isn't repeated for
+ * overlapping areas of neighbor chunks and operations can work on whole rows of pixels.
+ *
+ * When editing, rendered buffers are kept in the ResultCache. Operations whose settings and
+ * inputs didn't change since the last execution aren't rendered again.
+ * \see COM_EM_FULL_FRAME
+ * \ingroup Execution
+ */
+class FullFrameExecutionModel {
+ public:
+  typedef std::vector<NodeOperation *> Operations;
+
+ private:
+  struct OperationState {
+    /** Operations linked to the input sockets, NULL for unconnected sockets. */
+    Operations inputs;
+    /** Input of the write buffer operation of a memory proxy, that a read buffer reads. */
+    NodeOperation *proxy_input;
+    /** Union of the areas that the readers of this operation need. */
+    rcti area;
+    /** Rendered result, NULL when not rendered yet or when not needed anymore. */
+    MemoryBuffer *buffer;
+    /** Reads the buffer for the operations that use this operation as input. */
+    ReadBufferOperation *reader;
+    /** Number of operations reading the buffer, that still have to be rendered. */
+    int num_readers;
+    /** The result is constant and stored in a single element. */
+    bool is_single_elem;
+    bool is_rendered;
+    /** Key of the result in the ResultCache, depends on the keys of the inputs. */
+    uint64_t cache_key;
+    /** The result and the results of all inputs can be cached. */
+    bool is_cacheable;
+    /** The buffer is owned by the ResultCache, it's released instead of freed. */
+    bool is_cached;
+  };
+
+  const CompositorContext &m_context;
+  const Operations &m_operations;
+
+  /** Output operations that are executed. */
+  Operations m_outputs;
+  /** Operations needed by the outputs, inputs come before the operations reading them. */
+  Operations m_sorted_operations;
+  std::map<NodeOperation *, OperationState> m_states;
+
+  /** Original links of the input sockets, that are linked to readers during execution. */
+  std::vector<std::pair<NodeOperationInput *, NodeOperationOutput *>> m_input_links;
+
+  unsigned int m_num_rendered;
+
+  /** Results are taken from and added to the ResultCache, when editing. */
+  bool m_use_cache;
+
+ public:
+  FullFrameExecutionModel(const CompositorContext &context, const Operations &operations);
+  ~FullFrameExecutionModel();
+
+  void execute();
+
+ private:
+  void determine_outputs(CompositorPriority priority);
+  void sort_operations_recursive(NodeOperation *op);
+  ReadBufferOperation *get_reader(NodeOperation *op);
+  void link_readers();
+  void unlink_readers();
+  void init_operations();
+  void deinit_operations();
+
+  void determine_output_area(NodeOperation *output, rcti *r_area);
+  void determine_areas();
+  void determine_cache_keys();
+  uint64_t context_hash() const;
+
+  void render_operation(NodeOperation *op);
+  MemoryBuffer *create_buffer(NodeOperation *op, OperationState &state);
+  void execute_area(NodeOperation *op, MemoryBuffer *output, rcti *area, MemoryBuffer **inputs);
+  void release_input(NodeOperation *input);
+  void release_inputs(NodeOperation *op);
+  void free_buffer(OperationState &state);
+
+  bool is_breaked() const;
+  void update_progress_bar();
+
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("COM:FullFrameExecutionModel")
+#endif
+};
@@ -94,6 +94,11 @@ class MemoryBuffer {
   int m_width;
   int m_height;
 
+  /**
+   * \brief the buffer holds one element, that is used for every position
+   */
+  bool m_is_single_elem;
+
  public:
   /**
    * \brief construct new MemoryBuffer for a chunk
@@ -107,8 +112,9 @@ class MemoryBuffer {
 
   /**
    * \brief construct new temporarily MemoryBuffer for an area
+   * \param is_single_elem: rect has to be a single pixel, that is read for every position
    */
-  MemoryBuffer(DataType datatype, rcti *rect);
+  MemoryBuffer(DataType datatype, rcti *rect, bool is_single_elem = false);
 
   /**
    * \brief destructor
@@ -137,6 +143,32 @@ class MemoryBuffer {
     return this->m_buffer;
   }
 
+  bool isSingleElem() const
+  {
+    return this->m_is_single_elem;
+  }
+
+  /**
+   * \brief get the element at a position inside of the rect of this buffer
+   * \note single element buffers return the same element for every position
+   */
+  inline float *getElem(int x, int y)
+  {
+    if (this->m_is_single_elem) {
+      return this->m_buffer;
+    }
+    return &this->m_buffer[((y - this->m_rect.ymin) * this->m_width + (x - this->m_rect.xmin)) *
+                           this->m_num_channels];
+  }
+
+  /**
+   * \brief number of floats between neighbor elements in a row, 0 for single element buffers
+   */
+  inline int getElemStride() const
+  {
+    return this->m_is_single_elem ? 0 : this->m_num_channels;
+  }
+
   /**
    * \brief after execution the state will be set to available by calling this method
    */
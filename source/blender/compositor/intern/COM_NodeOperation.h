@@ -102,6 +102,25 @@ class NodeOperation : public SocketReader {
    */
   bool m_openCL;
 
+  /**
+   * \brief does this operation implement executeFullFrame.
+   *
+   * Other operations are executed pixel by pixel when the full frame execution model is used.
+   * \see FullFrameExecutionModel
+   */
+  bool m_fullFrame;
+
+  /**
+   * \brief hash of the settings of the node this operation was created for
+   * \see ResultCache
+   */
+  uint64_t m_nodeHash;
+
+  /**
+   * \brief does the result only depend on the node settings and the inputs
+   */
+  bool m_nodeCacheable;
+
   /**
    * \brief mutex reference for very special node initializations
    * \note only use when you really know what you are doing.
@@ -200,6 +219,20 @@ class NodeOperation : public SocketReader {
   {
   }
 
+  /**
+   * \brief render an area of this operation, called by the full frame execution model
+   * \note only called when isFullFrame() is set, may be called from several threads at once
+   * \param output: buffer with the resolution of this operation to write the area to
+   * \param area: the area to render
+   * \param inputs: rendered buffers of all input sockets, contain at least the area of interest
+   * of this operation. Buffers of constant inputs hold a single element.
+   */
+  virtual void executeFullFrame(MemoryBuffer * /*output*/,
+                                rcti * /*area*/,
+                                MemoryBuffer ** /*inputs*/)
+  {
+  }
+
   /**
    * \brief when a chunk is executed by an OpenCLDevice, this method is called
    * \ingroup execution
@@ -276,6 +309,44 @@ class NodeOperation : public SocketReader {
     return this->m_complex;
   }
 
+  /**
+   * \brief does this operation implement executeFullFrame
+   * \see FullFrameExecutionModel
+   */
+  bool isFullFrame() const
+  {
+    return this->m_fullFrame;
+  }
+
+  /**
+   * \brief set the hash of the node settings, called when converting nodes to operations
+   * \param cacheable: false when the node uses data that isn't part of the node tree
+   */
+  void setNodeHash(uint64_t hash, bool cacheable)
+  {
+    this->m_nodeHash = hash;
+    this->m_nodeCacheable = cacheable;
+  }
+  uint64_t getNodeHash() const
+  {
+    return this->m_nodeHash;
+  }
+  bool isNodeCacheable() const
+  {
+    return this->m_nodeCacheable;
+  }
+
+  /**
+   * \brief add data the result depends on, that isn't part of the node settings, to the hash
+   * \note called after initExecution
+   * \return false when the result can't be cached
+   * \see ResultCache
+   */
+  virtual bool hashExecutionData(uint64_t * /*r_hash*/)
+  {
+    return true;
+  }
+
   virtual bool isSetOperation() const
   {
     return false;
@@ -420,6 +491,14 @@ class NodeOperation : public SocketReader {
     this->m_openCL = openCL;
   }
 
+  /**
+   * \brief set if this NodeOperation implements executeFullFrame
+   */
+  void setFullFrame(bool fullFrame)
+  {
+    this->m_fullFrame = fullFrame;
+  }
+
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
 
@@ -18,6 +18,13 @@
 
 #include "BLI_utildefines.h"
 
+#include "BKE_node.h"
+
+#include "DNA_genfile.h"
+#include "DNA_sdna_types.h"
+
+#include "MEM_guardedalloc.h"
+
 #include "COM_Converter.h"
 #include "COM_Debug.h"
 #include "COM_ExecutionSystem.h"
@@ -28,6 +35,7 @@
 #include "COM_NodeOperation.h"
 #include "COM_PreviewOperation.h"
 #include "COM_ReadBufferOperation.h"
+#include "COM_ResultCache.h"
 #include "COM_SetColorOperation.h"
 #include "COM_SetValueOperation.h"
 #include "COM_SetVectorOperation.h"
@@ -47,6 +55,132 @@ NodeOperationBuilder::~NodeOperationBuilder()
 {
 }
 
+static uint64_t hash_socket_values(uint64_t hash, const ListBase *sockets)
+{
+  for (const bNodeSocket *sock = (const bNodeSocket *)sockets->first; sock; sock = sock->next) {
+    if (sock->default_value) {
+      const size_t size = MEM_allocN_len(sock->default_value);
+      hash = ResultCache::hashBytes(hash, sock->default_value, size);
+    }
+  }
+  return hash;
+}
+
+/* Pointers in node storage are followed up to this depth. */
+#define DNA_HASH_MAX_DEPTH 4
+
+static uint64_t hash_dna_struct(
+    uint64_t hash, const SDNA *sdna, int struct_nr, const char *data, int depth);
+
+static bool dna_struct_is_id(const SDNA *sdna, int struct_nr)
+{
+  const SDNA_Struct *struct_info = sdna->structs[struct_nr];
+  return struct_info->members_len > 0 && STREQ(sdna->types[struct_info->members[0].type], "ID");
+}
+
+/* Hash the data a struct member points to. Data of node storage is allocated per block, as it is
+ * written to files that way, so the length of the allocation tells the length of an array. */
+static uint64_t hash_dna_pointer(
+    uint64_t hash, const SDNA *sdna, const SDNA_StructMember *member, const void *ptr, int depth)
+{
+  const char *name = sdna->names[member->name];
+  if (ptr == NULL || name[1] == '*') {
+    return ResultCache::hashCombine(hash, ptr != NULL);
+  }
+  const int struct_nr = DNA_struct_find_nr(sdna, sdna->types[member->type]);
+  if (struct_nr == -1) {
+    /* Basic types behind pointers are runtime data, or have a length stored elsewhere. */
+    return hash;
+  }
+  if (dna_struct_is_id(sdna, struct_nr)) {
+    /* Changes of IDs are checked by the operations, see #node_is_cacheable. */
+    return ResultCache::hashCombine(hash, ((const ID *)ptr)->session_uuid);
+  }
+  if (depth >= DNA_HASH_MAX_DEPTH) {
+    return hash;
+  }
+  const size_t struct_size = sdna->types_size[member->type];
+  const size_t len = MEM_allocN_len(ptr) / struct_size;
+  for (size_t index = 0; index < len; index++) {
+    hash = hash_dna_struct(hash, sdna, struct_nr, (const char *)ptr + index * struct_size, depth + 1);
+  }
+  return hash;
+}
+
+/* Hash the members of a DNA struct one by one. Padding isn't initialized everywhere and is
+ * skipped, pointers are followed since their addresses change without the data changing. */
+static uint64_t hash_dna_struct(
+    uint64_t hash, const SDNA *sdna, int struct_nr, const char *data, int depth)
+{
+  const SDNA_Struct *struct_info = sdna->structs[struct_nr];
+  for (int index = 0; index < struct_info->members_len; index++) {
+    const SDNA_StructMember *member = &struct_info->members[index];
+    const char *name = sdna->names[member->name];
+    const int array_len = sdna->names_array_len[member->name];
+    const int size = DNA_elem_size_nr(sdna, member->type, member->name);
+
+    if (name[0] == '(' || STRPREFIX(name, "_pad")) {
+      /* Function pointers and padding. */
+    }
+    else if (name[0] == '*') {
+      const void *const *pointers = (const void *const *)data;
+      for (int elem = 0; elem < array_len; elem++) {
+        hash = hash_dna_pointer(hash, sdna, member, pointers[elem], depth);
+      }
+    }
+    else {
+      const int member_struct_nr = DNA_struct_find_nr(sdna, sdna->types[member->type]);
+      if (member_struct_nr == -1) {
+        hash = ResultCache::hashBytes(hash, data, size);
+      }
+      else {
+        const int struct_size = sdna->types_size[member->type];
+        for (int elem = 0; elem < array_len; elem++) {
+          hash = hash_dna_struct(hash, sdna, member_struct_nr, data + elem * struct_size, depth);
+        }
+      }
+    }
+    data += size;
+  }
+  return hash;
+}
+
+static uint64_t hash_node_storage(uint64_t hash, const bNode *bnode)
+{
+  const SDNA *sdna = DNA_sdna_current_get();
+  const int struct_nr = bnode->typeinfo->storagename[0] ?
+                            DNA_struct_find_nr(sdna, bnode->typeinfo->storagename) :
+                            -1;
+  if (struct_nr == -1) {
+    return ResultCache::hashBytes(hash, bnode->storage, MEM_allocN_len(bnode->storage));
+  }
+  return hash_dna_struct(hash, sdna, struct_nr, (const char *)bnode->storage, 0);
+}
+
+/* Hash of everything in the node that changes the result of its operations. */
+static uint64_t node_hash(const bNode *bnode)
+{
+  uint64_t hash = ResultCache::hashCombine(0, bnode->type);
+  hash = ResultCache::hashBytes(hash, &bnode->custom1, sizeof(bnode->custom1));
+  hash = ResultCache::hashBytes(hash, &bnode->custom2, sizeof(bnode->custom2));
+  hash = ResultCache::hashBytes(hash, &bnode->custom3, sizeof(bnode->custom3));
+  hash = ResultCache::hashBytes(hash, &bnode->custom4, sizeof(bnode->custom4));
+  hash = ResultCache::hashCombine(hash, bnode->id ? bnode->id->session_uuid : 0);
+  if (bnode->storage) {
+    hash = hash_node_storage(hash, bnode);
+  }
+  hash = hash_socket_values(hash, &bnode->inputs);
+  hash = hash_socket_values(hash, &bnode->outputs);
+  return hash;
+}
+
+/* Changes of the data of other ID types don't tag the node tree, images and render results are
+ * checked by their operations. */
+static bool node_is_cacheable(const bNode *bnode)
+{
+  return bnode->id == NULL || GS(bnode->id->name) == ID_IM || bnode->type == CMP_NODE_R_LAYERS;
+}
+
 void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 {
   /* interface handle for nodes */
@@ -57,8 +191,20 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 
     m_current_node = node;
 
+    const size_t first_operation = m_operations.size();
+
     DebugInfo::node_to_operations(node);
     node->convertToOperations(converter, *m_context);
+
+    const bNode *bnode = node->getbNode();
+    if (bnode) {
+      const uint64_t hash = node_hash(bnode);
+      const bool cacheable = node_is_cacheable(bnode);
+      for (size_t op_index = first_operation; op_index < m_operations.size(); op_index++) {
+        m_operations[op_index]->setNodeHash(
+            ResultCache::hashCombine(hash, op_index - first_operation), cacheable);
+      }
+    }
   }
 
   m_current_node = NULL;
@@ -104,8 +250,13 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
 
   determineResolutions();
 
+  /* Full frame execution model renders every operation into its own buffer. */
+  const bool use_buffer_operations = m_context->getExecutionModel() == COM_EM_TILED;
+
   /* surround complex ops with read/write buffer */
-  add_complex_operation_buffers();
+  if (use_buffer_operations) {
+    add_complex_operation_buffers();
+  }
 
   /* links not available from here on */
   /* XXX make m_links a local variable to avoid confusion! */
@@ -117,7 +268,9 @@ void NodeOperationBuilder::convertToOperations(ExecutionSystem *system)
   /*sort_operations();*/ /* not needed yet */
 
   /* create execution groups */
-  group_operations();
+  if (use_buffer_operations) {
+    group_operations();
+  }
 
   /* transfer resulting operations to the system */
   system->set_operations(m_operations, m_groups);
@@ -0,0 +1,164 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#include <list>
+#include <map>
+
+#include "COM_ResultCache.h"
+#include "COM_defines.h"
+
+#include "BLI_assert.h"
+
+typedef std::list<uint64_t> LRUList;
+
+struct ResultCacheEntry {
+  MemoryBuffer *buffer;
+  /** Area of the buffer that is rendered. */
+  rcti area;
+  size_t size;
+  /** Number of executions using the buffer, it's not evicted when in use. */
+  int users;
+  /** Position in the least recently used list. */
+  LRUList::iterator lru_position;
+};
+
+typedef std::map<uint64_t, ResultCacheEntry> ResultCacheMap;
+
+/** \brief cached buffers by key */
+static ResultCacheMap g_entries;
+/** \brief keys of the cached buffers, most recently used first */
+static LRUList g_lru;
+/** \brief total size of the cached buffers in bytes */
+static size_t g_size = 0;
+/** \brief statistics since the last clear */
+static unsigned int g_hit_count = 0;
+static unsigned int g_add_count = 0;
+
+static void entry_touch(uint64_t key, ResultCacheEntry &entry)
+{
+  g_lru.erase(entry.lru_position);
+  g_lru.push_front(key);
+  entry.lru_position = g_lru.begin();
+}
+
+static void entry_remove(ResultCacheMap::iterator it)
+{
+  ResultCacheEntry &entry = it->second;
+  BLI_assert(entry.users == 0);
+  g_size -= entry.size;
+  g_lru.erase(entry.lru_position);
+  delete entry.buffer;
+  g_entries.erase(it);
+}
+
+MemoryBuffer *ResultCache::acquire(uint64_t key, const rcti *area)
+{
+  ResultCacheMap::iterator it = g_entries.find(key);
+  if (it == g_entries.end()) {
+    return NULL;
+  }
+  ResultCacheEntry &entry = it->second;
+  if (!BLI_rcti_is_empty(area) && !BLI_rcti_inside_rcti(&entry.area, area)) {
+    return NULL;
+  }
+  entry.users++;
+  entry_touch(key, entry);
+  g_hit_count++;
+  return entry.buffer;
+}
+
+bool ResultCache::add(uint64_t key, MemoryBuffer *buffer, const rcti *area)
+{
+  ResultCacheMap::iterator it = g_entries.find(key);
+  if (it != g_entries.end()) {
+    if (it->second.users > 0) {
+      return false;
+    }
+    /* Cached buffer doesn't contain the area that is needed now. */
+    entry_remove(it);
+  }
+
+  g_lru.push_front(key);
+
+  ResultCacheEntry &entry = g_entries[key];
+  entry.buffer = buffer;
+  entry.area = *area;
+  entry.size = (size_t)buffer->getWidth() * buffer->getHeight() * buffer->get_num_channels() *
+               sizeof(float);
+  entry.users = 1;
+  entry.lru_position = g_lru.begin();
+  g_size += entry.size;
+  g_add_count++;
+
+  trim();
+  return true;
+}
+
+void ResultCache::release(uint64_t key)
+{
+  ResultCacheMap::iterator it = g_entries.find(key);
+  BLI_assert(it != g_entries.end() && it->second.users > 0);
+  if (it != g_entries.end()) {
+    it->second.users--;
+  }
+}
+
+void ResultCache::trim()
+{
+  LRUList::iterator lru_it = g_lru.end();
+  while (g_size > COM_RESULT_CACHE_LIMIT && lru_it != g_lru.begin()) {
+    --lru_it;
+    ResultCacheMap::iterator it = g_entries.find(*lru_it);
+    if (it->second.users == 0) {
+      /* Erasing the entry invalidates the list position, continue from the next one. */
+      LRUList::iterator next_it = lru_it;
+      ++next_it;
+      entry_remove(it);
+      lru_it = next_it;
+    }
+  }
+}
+
+void ResultCache::clear()
+{
+  while (!g_entries.empty()) {
+    entry_remove(g_entries.begin());
+  }
+  g_hit_count = 0;
+  g_add_count = 0;
+}
+
+unsigned int ResultCache::getHitCount()
+{
+  return g_hit_count;
+}
+
+unsigned int ResultCache::getAddCount()
+{
+  return g_add_count;
+}
+
+uint64_t ResultCache::hashBytes(uint64_t hash, const void *data, size_t size)
+{
+  const unsigned char *bytes = (const unsigned char *)data;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
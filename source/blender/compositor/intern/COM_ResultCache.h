@@ -0,0 +1,92 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#pragma once
+
+#include "BLI_rect.h"
+#include "BLI_sys_types.h"
+
+#include "COM_MemoryBuffer.h"
+
+/**
+ * \brief Keeps rendered buffers of operations between executions of the compositor.
+ *
+ * Buffers are identified by a key, that is a hash of the settings of the operation and the keys
+ * of its inputs. When nothing upstream of an operation changed, its buffer is taken from the
+ * cache instead of rendering the operation and all its inputs again.
+ *
+ * Buffers in use by an execution are never evicted. The least recently used buffers are evicted
+ * when the cache grows over COM_RESULT_CACHE_LIMIT.
+ *
+ * Used by the full frame execution model when editing, all calls happen while the compositor
+ * mutex is locked.
+ * \see FullFrameExecutionModel
+ * \ingroup Memory
+ */
+class ResultCache {
+ public:
+  /**
+   * \brief get the cached buffer of a key and mark it in use
+   * \param area: area that has to be rendered in the buffer
+   * \return NULL when there is no buffer for the key, or the area isn't rendered
+   */
+  static MemoryBuffer *acquire(uint64_t key, const rcti *area);
+
+  /**
+   * \brief add a buffer to the cache, the buffer is marked in use
+   * \param area: area that is rendered in the buffer
+   * \return false when the key is in use already, the buffer isn't added then
+   */
+  static bool add(uint64_t key, MemoryBuffer *buffer, const rcti *area);
+
+  /**
+   * \brief mark a buffer of acquire or add as not in use anymore
+   */
+  static void release(uint64_t key);
+
+  /**
+   * \brief evict least recently used buffers that are not in use, until the cache fits the limit
+   */
+  static void trim();
+
+  /**
+   * \brief free all buffers, none of them may be in use
+   */
+  static void clear();
+
+  /**
+   * \brief number of buffers taken from the cache since the last clear
+   */
+  static unsigned int getHitCount();
+
+  /**
+   * \brief number of buffers added to the cache since the last clear
+   */
+  static unsigned int getAddCount();
+
+  static uint64_t hashCombine(uint64_t hash, uint64_t value)
+  {
+    return hash ^ (value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2));
+  }
+
+  /**
+   * \brief FNV-1a hash of a block of memory
+   * \param hash: hash of the data before this block
+   */
+  static uint64_t hashBytes(uint64_t hash, const void *data, size_t size);
+};
@@ -367,5 +367,9 @@ void WorkScheduler::deinitialize()
 int WorkScheduler::current_thread_id()
 {
   CPUDevice *device = (CPUDevice *)BLI_thread_local_get(g_thread_device);
+  /* The full frame execution model runs operations in task threads, without a device. */
+  if (device == NULL) {
+    return 0;
+  }
   return device->thread_id();
 }
@@ -23,19 +23,11 @@ AlphaOverMixedOperation::AlphaOverMixedOperation() : MixBaseOperation()
   this->m_x = 0.0f;
 }
 
-void AlphaOverMixedOperation::executePixelSampled(float output[4],
-                                                  float x,
-                                                  float y,
-                                                  PixelSampler sampler)
+void AlphaOverMixedOperation::mixPixel(float output[4],
+                                       const float value[4],
+                                       const float inputColor1[4],
+                                       const float inputOverColor[4])
 {
-  float inputColor1[4];
-  float inputOverColor[4];
-  float value[4];
-
-  this->m_inputValueOperation->readSampled(value, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputOverColor, x, y, sampler);
-
   if (inputOverColor[3] <= 0.0f) {
     copy_v4_v4(output, inputColor1);
   }
@@ -26,6 +26,7 @@ BrightnessOperation::BrightnessOperation() : NodeOperation()
   this->addOutputSocket(COM_DT_COLOR);
   this->m_inputProgram = NULL;
   this->m_use_premultiply = false;
+  this->setFullFrame(true);
 }
 
 void BrightnessOperation::setUsePremultiply(bool use_premultiply)
@@ -46,12 +47,43 @@ void BrightnessOperation::executePixelSampled(float output[4],
                                               PixelSampler sampler)
 {
   float inputValue[4];
-  float a, b;
   float inputBrightness[4];
   float inputContrast[4];
   this->m_inputProgram->readSampled(inputValue, x, y, sampler);
   this->m_inputBrightnessProgram->readSampled(inputBrightness, x, y, sampler);
   this->m_inputContrastProgram->readSampled(inputContrast, x, y, sampler);
+
+  brightnessPixel(output, inputValue, inputBrightness, inputContrast);
+}
+
+void BrightnessOperation::executeFullFrame(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs)
+{
+  const int color_stride = inputs[0]->getElemStride();
+  const int brightness_stride = inputs[1]->getElemStride();
+  const int contrast_stride = inputs[2]->getElemStride();
+  const int output_stride = output->getElemStride();
+
+  for (int y = area->ymin; y < area->ymax; y++) {
+    const float *inputValue = inputs[0]->getElem(area->xmin, y);
+    const float *inputBrightness = inputs[1]->getElem(area->xmin, y);
+    const float *inputContrast = inputs[2]->getElem(area->xmin, y);
+    float *out = output->getElem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      brightnessPixel(out, inputValue, inputBrightness, inputContrast);
+      inputValue += color_stride;
+      inputBrightness += brightness_stride;
+      inputContrast += contrast_stride;
+      out += output_stride;
+    }
+  }
+}
+
+void BrightnessOperation::brightnessPixel(float output[4],
+                                          const float inputValue[4],
+                                          const float inputBrightness[4],
+                                          const float inputContrast[4])
+{
+  float a, b;
   float brightness = inputBrightness[0];
   float contrast = inputContrast[0];
   brightness /= 100.0f;
@@ -71,13 +103,15 @@ void BrightnessOperation::executePixelSampled(float output[4],
     a = max_ff(1.0f - delta * 2.0f, 0.0f);
     b = a * brightness + delta;
   }
+  float color[4];
+  copy_v4_v4(color, inputValue);
   if (this->m_use_premultiply) {
-    premul_to_straight_v4(inputValue);
+    premul_to_straight_v4(color);
   }
-  output[0] = a * inputValue[0] + b;
-  output[1] = a * inputValue[1] + b;
-  output[2] = a * inputValue[2] + b;
-  output[3] = inputValue[3];
+  output[0] = a * color[0] + b;
+  output[1] = a * color[1] + b;
+  output[2] = a * color[2] + b;
+  output[3] = color[3];
   if (this->m_use_premultiply) {
     straight_to_premul_v4(output);
   }
@@ -31,6 +31,14 @@ class BrightnessOperation : public NodeOperation {
 
   bool m_use_premultiply;
 
+  /**
+   * \brief the pixel math, shared by executePixelSampled and executeFullFrame
+   */
+  void brightnessPixel(float output[4],
+                       const float inputValue[4],
+                       const float inputBrightness[4],
+                       const float inputContrast[4]);
+
  public:
   BrightnessOperation();
 
@@ -39,6 +47,8 @@ class BrightnessOperation : public NodeOperation {
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 
+  void executeFullFrame(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs);
+
   /**
    * Initialize the execution
    */
@@ -39,6 +39,7 @@ ColorBalanceASCCDLOperation::ColorBalanceASCCDLOperation() : NodeOperation()
   this->m_inputValueOperation = NULL;
   this->m_inputColorOperation = NULL;
   this->setResolutionInputSocketIndex(1);
+  this->setFullFrame(true);
 }
 
 void ColorBalanceASCCDLOperation::initExecution()
@@ -58,6 +59,34 @@ void ColorBalanceASCCDLOperation::executePixelSampled(float output[4],
   this->m_inputValueOperation->readSampled(value, x, y, sampler);
   this->m_inputColorOperation->readSampled(inputColor, x, y, sampler);
 
+  balancePixel(output, value, inputColor);
+}
+
+void ColorBalanceASCCDLOperation::executeFullFrame(MemoryBuffer *output,
+                                                   rcti *area,
+                                                   MemoryBuffer **inputs)
+{
+  const int value_stride = inputs[0]->getElemStride();
+  const int color_stride = inputs[1]->getElemStride();
+  const int output_stride = output->getElemStride();
+
+  for (int y = area->ymin; y < area->ymax; y++) {
+    const float *value = inputs[0]->getElem(area->xmin, y);
+    const float *inputColor = inputs[1]->getElem(area->xmin, y);
+    float *out = output->getElem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      balancePixel(out, value, inputColor);
+      value += value_stride;
+      inputColor += color_stride;
+      out += output_stride;
+    }
+  }
+}
+
+void ColorBalanceASCCDLOperation::balancePixel(float output[4],
+                                               const float value[4],
+                                               const float inputColor[4])
+{
   float fac = value[0];
   fac = min(1.0f, fac);
   const float mfac = 1.0f - fac;
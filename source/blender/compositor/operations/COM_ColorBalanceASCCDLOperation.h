@@ -36,6 +36,11 @@ class ColorBalanceASCCDLOperation : public NodeOperation {
   float m_power[3];
   float m_slope[3];
 
+  /**
+   * \brief the pixel math, shared by executePixelSampled and executeFullFrame
+   */
+  void balancePixel(float output[4], const float value[4], const float inputColor[4]);
+
  public:
   /**
    * Default constructor
@@ -47,6 +52,8 @@ class ColorBalanceASCCDLOperation : public NodeOperation {
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 
+  void executeFullFrame(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs);
+
   /**
    * Initialize the execution
    */
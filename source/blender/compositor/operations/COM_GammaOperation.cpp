@@ -26,6 +26,7 @@ GammaOperation::GammaOperation() : NodeOperation()
   this->addOutputSocket(COM_DT_COLOR);
   this->m_inputProgram = NULL;
   this->m_inputGammaProgram = NULL;
+  this->setFullFrame(true);
 }
 void GammaOperation::initExecution()
 {
@@ -40,6 +41,33 @@ void GammaOperation::executePixelSampled(float output[4], float x, float y, Pixe
 
   this->m_inputProgram->readSampled(inputValue, x, y, sampler);
   this->m_inputGammaProgram->readSampled(inputGamma, x, y, sampler);
+
+  gammaPixel(output, inputValue, inputGamma);
+}
+
+void GammaOperation::executeFullFrame(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs)
+{
+  const int color_stride = inputs[0]->getElemStride();
+  const int gamma_stride = inputs[1]->getElemStride();
+  const int output_stride = output->getElemStride();
+
+  for (int y = area->ymin; y < area->ymax; y++) {
+    const float *inputValue = inputs[0]->getElem(area->xmin, y);
+    const float *inputGamma = inputs[1]->getElem(area->xmin, y);
+    float *out = output->getElem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      gammaPixel(out, inputValue, inputGamma);
+      inputValue += color_stride;
+      inputGamma += gamma_stride;
+      out += output_stride;
+    }
+  }
+}
+
+void GammaOperation::gammaPixel(float output[4],
+                                const float inputValue[4],
+                                const float inputGamma[4])
+{
   const float gamma = inputGamma[0];
   /* check for negative to avoid nan's */
   output[0] = inputValue[0] > 0.0f ? powf(inputValue[0], gamma) : inputValue[0];
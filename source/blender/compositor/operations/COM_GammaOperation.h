@@ -28,6 +28,11 @@ class GammaOperation : public NodeOperation {
   SocketReader *m_inputProgram;
   SocketReader *m_inputGammaProgram;
 
+  /**
+   * \brief the pixel math, shared by executePixelSampled and executeFullFrame
+   */
+  void gammaPixel(float output[4], const float inputValue[4], const float inputGamma[4]);
+
  public:
   GammaOperation();
 
@@ -36,6 +41,8 @@ class GammaOperation : public NodeOperation {
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 
+  void executeFullFrame(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs);
+
   /**
    * Initialize the execution
    */
@@ -30,6 +30,7 @@ GaussianXBlurOperation::GaussianXBlurOperation() : BlurBaseOperation(COM_DT_COLO
   this->m_gausstab_sse = NULL;
 #endif
   this->m_filtersize = 0;
+  this->setFullFrame(true);
 }
 
 void *GaussianXBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -117,6 +118,67 @@ void GaussianXBlurOperation::executePixel(float output[4], int x, int y, void *d
   mul_v4_v4fl(output, color_accum, 1.0f / multiplier_accum);
 }
 
+void GaussianXBlurOperation::executeFullFrame(MemoryBuffer *output,
+                                              rcti *area,
+                                              MemoryBuffer **inputs)
+{
+  lockMutex();
+  if (!this->m_sizeavailable) {
+    updateGauss();
+  }
+  unlockMutex();
+
+  MemoryBuffer *input = inputs[0];
+  const int output_stride = output->getElemStride();
+  if (input->isSingleElem()) {
+    /* Blurring a constant gives the same constant. */
+    for (int y = area->ymin; y < area->ymax; y++) {
+      float *out = output->getElem(area->xmin, y);
+      for (int x = area->xmin; x < area->xmax; x++) {
+        copy_v4_v4(out, input->getElem(x, y));
+        out += output_stride;
+      }
+    }
+    return;
+  }
+
+  const rcti &rect = *input->getRect();
+  const int step = getStep();
+
+  /* Pixels whose filter lies inside of the input all use the same normalized weights. */
+  float multiplier_accum = 0.0f;
+  for (int index = 0; index <= 2 * this->m_filtersize; index += step) {
+    multiplier_accum += this->m_gausstab[index];
+  }
+  const float multiplier_inv = 1.0f / multiplier_accum;
+
+  const int inner_xmin = max_ii(area->xmin, rect.xmin + this->m_filtersize);
+  const int inner_xmax = max_ii(inner_xmin, min_ii(area->xmax, rect.xmax - this->m_filtersize));
+
+  for (int y = area->ymin; y < area->ymax; y++) {
+    /* Filter the inner part of the row one tap at a time, over all of its pixels. */
+    float *out = output->getElem(inner_xmin, y);
+    const float *in = input->getElem(inner_xmin - this->m_filtersize, y);
+    const int inner_width = inner_xmax - inner_xmin;
+    memset(out, 0, sizeof(float[4]) * inner_width);
+    for (int index = 0; index <= 2 * this->m_filtersize; index += step) {
+      const float multiplier = this->m_gausstab[index] * multiplier_inv;
+      const float *in_tap = in + index * 4;
+      for (int i = 0; i < inner_width; i++) {
+        madd_v4_v4fl(&out[i * 4], &in_tap[i * 4], multiplier);
+      }
+    }
+
+    /* Pixels near the borders of the input only use the part of the filter inside of it. */
+    for (int x = area->xmin; x < min_ii(inner_xmin, area->xmax); x++) {
+      GaussianXBlurOperation::executePixel(output->getElem(x, y), x, y, input);
+    }
+    for (int x = max_ii(inner_xmax, area->xmin); x < area->xmax; x++) {
+      GaussianXBlurOperation::executePixel(output->getElem(x, y), x, y, input);
+    }
+  }
+}
+
 void GaussianXBlurOperation::executeOpenCL(OpenCLDevice *device,
                                            MemoryBuffer *outputMemoryBuffer,
                                            cl_mem clOutputBuffer,
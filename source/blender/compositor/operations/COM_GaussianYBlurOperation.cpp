@@ -30,6 +30,7 @@ GaussianYBlurOperation::GaussianYBlurOperation() : BlurBaseOperation(COM_DT_COLO
   this->m_gausstab_sse = NULL;
 #endif
   this->m_filtersize = 0;
+  this->setFullFrame(true);
 }
 
 void *GaussianYBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -117,6 +118,58 @@ void GaussianYBlurOperation::executePixel(float output[4], int x, int y, void *d
   mul_v4_v4fl(output, color_accum, 1.0f / multiplier_accum);
 }
 
+void GaussianYBlurOperation::executeFullFrame(MemoryBuffer *output,
+                                              rcti *area,
+                                              MemoryBuffer **inputs)
+{
+  lockMutex();
+  if (!this->m_sizeavailable) {
+    updateGauss();
+  }
+  unlockMutex();
+
+  MemoryBuffer *input = inputs[0];
+  const int output_stride = output->getElemStride();
+  if (input->isSingleElem()) {
+    /* Blurring a constant gives the same constant. */
+    for (int y = area->ymin; y < area->ymax; y++) {
+      float *out = output->getElem(area->xmin, y);
+      for (int x = area->xmin; x < area->xmax; x++) {
+        copy_v4_v4(out, input->getElem(x, y));
+        out += output_stride;
+      }
+    }
+    return;
+  }
+
+  const rcti &rect = *input->getRect();
+  const int step = getStep();
+  const int width = BLI_rcti_size_x(area);
+
+  for (int y = area->ymin; y < area->ymax; y++) {
+    /* Filter the column of every pixel of the row at once, by adding the input rows one tap
+     * at a time. All pixels of a row use the same part of the filter. */
+    const int ymin = max_ii(y - this->m_filtersize, rect.ymin);
+    const int ymax = min_ii(y + this->m_filtersize + 1, rect.ymax);
+
+    float multiplier_accum = 0.0f;
+    for (int ny = ymin; ny < ymax; ny += step) {
+      multiplier_accum += this->m_gausstab[(ny - y) + this->m_filtersize];
+    }
+    const float multiplier_inv = 1.0f / multiplier_accum;
+
+    float *out = output->getElem(area->xmin, y);
+    memset(out, 0, sizeof(float[4]) * width);
+    for (int ny = ymin; ny < ymax; ny += step) {
+      const float multiplier = this->m_gausstab[(ny - y) + this->m_filtersize] * multiplier_inv;
+      const float *in = input->getElem(area->xmin, ny);
+      for (int i = 0; i < width; i++) {
+        madd_v4_v4fl(&out[i * 4], &in[i * 4], multiplier);
+      }
+    }
+  }
+}
+
 void GaussianYBlurOperation::executeOpenCL(OpenCLDevice *device,
                                            MemoryBuffer *outputMemoryBuffer,
                                            cl_mem clOutputBuffer,
@@ -17,6 +17,7 @@
  */
 
 #include "COM_ImageOperation.h"
+#include "COM_ResultCache.h"
 
 #include "BKE_image.h"
 #include "BKE_scene.h"
@@ -102,6 +103,30 @@ void BaseImageOperation::deinitExecution()
   BKE_image_release_ibuf(this->m_image, this->m_buffer, NULL);
 }
 
+bool BaseImageOperation::hashExecutionData(uint64_t *r_hash)
+{
+  if (this->m_buffer == NULL) {
+    return true;
+  }
+  /* Render results and viewers change without a new image buffer, painted pixels are changed in
+   * place until the image is saved. */
+  if (ELEM(this->m_image->type, IMA_TYPE_R_RESULT, IMA_TYPE_COMPOSITE) ||
+      (this->m_buffer->userflags & IB_BITMAPDIRTY)) {
+    return false;
+  }
+  /* Freed buffers may be allocated again at the same address, so the buffers are identified by
+   * the counters of the image and the image buffer instead. */
+  *r_hash = ResultCache::hashCombine(*r_hash, this->m_image->id.session_uuid);
+  *r_hash = ResultCache::hashCombine(*r_hash, (uint64_t)this->m_image->reload_counter);
+  *r_hash = ResultCache::hashCombine(*r_hash, (uint64_t)this->m_buffer->change_counter);
+  *r_hash = ResultCache::hashCombine(*r_hash, this->m_imageFloatBuffer != NULL);
+  *r_hash = ResultCache::hashCombine(*r_hash, this->m_imageByteBuffer != NULL);
+  *r_hash = ResultCache::hashCombine(*r_hash, this->m_imagewidth);
+  *r_hash = ResultCache::hashCombine(*r_hash, this->m_imageheight);
+  *r_hash = ResultCache::hashCombine(*r_hash, this->m_framenumber);
+  return true;
+}
+
 void BaseImageOperation::determineResolution(unsigned int resolution[2],
                                              unsigned int /*preferredResolution*/[2])
 {
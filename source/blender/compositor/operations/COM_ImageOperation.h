@@ -57,6 +57,7 @@ class BaseImageOperation : public NodeOperation {
  public:
   void initExecution();
   void deinitExecution();
+  bool hashExecutionData(uint64_t *r_hash);
   void setImage(Image *image)
   {
     this->m_image = image;
@@ -33,6 +33,7 @@ MixBaseOperation::MixBaseOperation() : NodeOperation()
   this->m_inputColor2Operation = NULL;
   this->setUseValueAlphaMultiply(false);
   this->setUseClamp(false);
+  this->setFullFrame(true);
 }
 
 void MixBaseOperation::initExecution()
@@ -52,6 +53,36 @@ void MixBaseOperation::executePixelSampled(float output[4], float x, float y, Pi
   this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
   this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
 
+  mixPixel(output, inputValue, inputColor1, inputColor2);
+}
+
+void MixBaseOperation::executeFullFrame(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs)
+{
+  const int value_stride = inputs[0]->getElemStride();
+  const int color1_stride = inputs[1]->getElemStride();
+  const int color2_stride = inputs[2]->getElemStride();
+  const int output_stride = output->getElemStride();
+
+  for (int y = area->ymin; y < area->ymax; y++) {
+    const float *inputValue = inputs[0]->getElem(area->xmin, y);
+    const float *inputColor1 = inputs[1]->getElem(area->xmin, y);
+    const float *inputColor2 = inputs[2]->getElem(area->xmin, y);
+    float *out = output->getElem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      mixPixel(out, inputValue, inputColor1, inputColor2);
+      inputValue += value_stride;
+      inputColor1 += color1_stride;
+      inputColor2 += color2_stride;
+      out += output_stride;
+    }
+  }
+}
+
+void MixBaseOperation::mixPixel(float output[4],
+                                const float inputValue[4],
+                                const float inputColor1[4],
+                                const float inputColor2[4])
+{
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -102,16 +133,11 @@ MixAddOperation::MixAddOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixAddOperation::mixPixel(float output[4],
+                               const float inputValue[4],
+                               const float inputColor1[4],
+                               const float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -131,19 +157,12 @@ MixBlendOperation::MixBlendOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixBlendOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MixBlendOperation::mixPixel(float output[4],
+                                 const float inputValue[4],
+                                 const float inputColor1[4],
+                                 const float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
   float value;
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
   value = inputValue[0];
 
   if (this->useValueAlphaMultiply()) {
@@ -165,20 +184,13 @@ MixColorBurnOperation::MixColorBurnOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixColorBurnOperation::executePixelSampled(float output[4],
-                                                float x,
-                                                float y,
-                                                PixelSampler sampler)
+void MixColorBurnOperation::mixPixel(float output[4],
+                                     const float inputValue[4],
+                                     const float inputColor1[4],
+                                     const float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
   float tmp;
 
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -248,19 +260,11 @@ MixColorOperation::MixColorOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixColorOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MixColorOperation::mixPixel(float output[4],
+                                 const float inputValue[4],
+                                 const float inputColor1[4],
+                                 const float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -293,19 +297,11 @@ MixDarkenOperation::MixDarkenOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixDarkenOperation::executePixelSampled(float output[4],
-                                             float x,
-                                             float y,
-                                             PixelSampler sampler)
+void MixDarkenOperation::mixPixel(float output[4],
+                                  const float inputValue[4],
+                                  const float inputColor1[4],
+                                  const float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -326,19 +322,11 @@ MixDifferenceOperation::MixDifferenceOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixDifferenceOperation::executePixelSampled(float output[4],
-                                                 float x,
-                                                 float y,
-                                                 PixelSampler sampler)
+void MixDifferenceOperation::mixPixel(float output[4],
+                                      const float inputValue[4],
+                                      const float inputColor1[4],
+                                      const float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -359,19 +347,11 @@ MixDivideOperation::MixDivideOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixDivideOperation::executePixelSampled(float output[4],
-                                             float x,
-                                             float y,
-                                             PixelSampler sampler)
+void MixDivideOperation::mixPixel(float output[4],
+                                  const float inputValue[4],
+                                  const float inputColor1[4],
+                                  const float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -409,20 +389,13 @@ MixDodgeOperation::MixDodgeOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixDodgeOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MixDodgeOperation::mixPixel(float output[4],
+                                 const float inputValue[4],
+                                 const float inputColor1[4],
+                                 const float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
   float tmp;
 
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -497,19 +470,15 @@ MixGlareOperation::MixGlareOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixGlareOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MixGlareOperation::mixPixel(float output[4],
+                                 const float inputValue[4],
+                                 const float inputSource[4],
+                                 const float inputColor2[4])
 {
   float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-  float value;
+  copy_v4_v4(inputColor1, inputSource);
 
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
+  float value;
   value = inputValue[0];
   float mf = 2.0f - 2.0f * fabsf(value - 0.5f);
 
@@ -538,16 +507,11 @@ MixHueOperation::MixHueOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixHueOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+void MixHueOperation::mixPixel(float output[4],
+                               const float inputValue[4],
+                               const float inputColor1[4],
+                               const float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -580,19 +544,11 @@ MixLightenOperation::MixLightenOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixLightenOperation::executePixelSampled(float output[4],
-                                              float x,
-                                              float y,
-                                              PixelSampler sampler)
+void MixLightenOperation::mixPixel(float output[4],
+                                   const float inputValue[4],
+                                   const float inputColor1[4],
+                                   const float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -631,19 +587,11 @@ MixLinearLightOperation::MixLinearLightOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixLinearLightOperation::executePixelSampled(float output[4],
-                                                  float x,
-                                                  float y,
-                                                  PixelSampler sampler)
+void MixLinearLightOperation::mixPixel(float output[4],
+                                       const float inputValue[4],
+                                       const float inputColor1[4],
+                                       const float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -679,19 +627,11 @@ MixMultiplyOperation::MixMultiplyOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixMultiplyOperation::executePixelSampled(float output[4],
-                                               float x,
-                                               float y,
-                                               PixelSampler sampler)
+void MixMultiplyOperation::mixPixel(float output[4],
+                                    const float inputValue[4],
+                                    const float inputColor1[4],
+                                    const float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -712,19 +652,11 @@ MixOverlayOperation::MixOverlayOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixOverlayOperation::executePixelSampled(float output[4],
-                                              float x,
-                                              float y,
-                                              PixelSampler sampler)
+void MixOverlayOperation::mixPixel(float output[4],
+                                   const float inputValue[4],
+                                   const float inputColor1[4],
+                                   const float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -762,19 +694,11 @@ MixSaturationOperation::MixSaturationOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixSaturationOperation::executePixelSampled(float output[4],
-                                                 float x,
-                                                 float y,
-                                                 PixelSampler sampler)
+void MixSaturationOperation::mixPixel(float output[4],
+                                      const float inputValue[4],
+                                      const float inputColor1[4],
+                                      const float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -804,19 +728,11 @@ MixScreenOperation::MixScreenOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixScreenOperation::executePixelSampled(float output[4],
-                                             float x,
-                                             float y,
-                                             PixelSampler sampler)
+void MixScreenOperation::mixPixel(float output[4],
+                                  const float inputValue[4],
+                                  const float inputColor1[4],
+                                  const float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -838,19 +754,11 @@ MixSoftLightOperation::MixSoftLightOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixSoftLightOperation::executePixelSampled(float output[4],
-                                                float x,
-                                                float y,
-                                                PixelSampler sampler)
+void MixSoftLightOperation::mixPixel(float output[4],
+                                     const float inputValue[4],
+                                     const float inputColor1[4],
+                                     const float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -884,19 +792,11 @@ MixSubtractOperation::MixSubtractOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixSubtractOperation::executePixelSampled(float output[4],
-                                               float x,
-                                               float y,
-                                               PixelSampler sampler)
+void MixSubtractOperation::mixPixel(float output[4],
+                                    const float inputValue[4],
+                                    const float inputColor1[4],
+                                    const float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -916,19 +816,11 @@ MixValueOperation::MixValueOperation() : MixBaseOperation()
   /* pass */
 }
 
-void MixValueOperation::executePixelSampled(float output[4],
-                                            float x,
-                                            float y,
-                                            PixelSampler sampler)
+void MixValueOperation::mixPixel(float output[4],
+                                 const float inputValue[4],
+                                 const float inputColor1[4],
+                                 const float inputColor2[4])
 {
-  float inputColor1[4];
-  float inputColor2[4];
-  float inputValue[4];
-
-  this->m_inputValueOperation->readSampled(inputValue, x, y, sampler);
-  this->m_inputColor1Operation->readSampled(inputColor1, x, y, sampler);
-  this->m_inputColor2Operation->readSampled(inputColor2, x, y, sampler);
-
   float value = inputValue[0];
   if (this->useValueAlphaMultiply()) {
     value *= inputColor2[3];
@@ -23,6 +23,7 @@
 ReadBufferOperation::ReadBufferOperation(DataType datatype) : NodeOperation()
 {
   this->addOutputSocket(datatype);
+  this->m_memoryProxy = NULL;
   this->m_single_value = false;
   this->m_offset = 0;
   this->m_buffer = NULL;
@@ -71,4 +71,14 @@ class ReadBufferOperation : public NodeOperation {
   }
   void readResolutionFromWriteBuffer();
   void updateMemoryBuffer();
+
+  /**
+   * \brief read from a buffer that doesn't belong to a memory proxy
+   * \note used by the full frame execution model
+   */
+  void setMemoryBuffer(MemoryBuffer *buffer)
+  {
+    this->m_buffer = buffer;
+    this->m_single_value = buffer && buffer->isSingleElem();
+  }
 };
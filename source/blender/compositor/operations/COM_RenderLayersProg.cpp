@@ -17,6 +17,7 @@
  */
 
 #include "COM_RenderLayersProg.h"
+#include "COM_ResultCache.h"
 
 #include "BKE_scene.h"
 #include "BLI_listbase.h"
@@ -180,6 +181,13 @@ void RenderLayersProg::deinitExecution()
   this->m_inputBuffer = NULL;
 }
 
+bool RenderLayersProg::hashExecutionData(uint64_t *r_hash)
+{
+  /* The cache is cleared when a new render result is tagged, see COM_clearCaches. */
+  *r_hash = ResultCache::hashCombine(*r_hash, (uint64_t)(uintptr_t)this->m_inputBuffer);
+  return true;
+}
+
 void RenderLayersProg::determineResolution(unsigned int resolution[2],
                                            unsigned int /*preferredResolution*/[2])
 {
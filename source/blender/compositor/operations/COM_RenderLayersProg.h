@@ -120,6 +120,7 @@ class RenderLayersProg : public NodeOperation {
   }
   void initExecution();
   void deinitExecution();
+  bool hashExecutionData(uint64_t *r_hash);
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 };
 
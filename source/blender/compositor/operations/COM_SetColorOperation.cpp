@@ -17,6 +17,7 @@
  */
 
 #include "COM_SetColorOperation.h"
+#include "COM_ResultCache.h"
 
 SetColorOperation::SetColorOperation() : NodeOperation()
 {
@@ -37,3 +38,9 @@ void SetColorOperation::determineResolution(unsigned int resolution[2],
   resolution[0] = preferredResolution[0];
   resolution[1] = preferredResolution[1];
 }
+
+bool SetColorOperation::hashExecutionData(uint64_t *r_hash)
+{
+  *r_hash = ResultCache::hashBytes(*r_hash, this->m_color, sizeof(this->m_color));
+  return true;
+}
@@ -81,4 +81,6 @@ class SetColorOperation : public NodeOperation {
   {
     return true;
   }
+
+  bool hashExecutionData(uint64_t *r_hash);
 };
@@ -17,6 +17,7 @@
  */
 
 #include "COM_SetValueOperation.h"
+#include "COM_ResultCache.h"
 
 SetValueOperation::SetValueOperation() : NodeOperation()
 {
@@ -37,3 +38,9 @@ void SetValueOperation::determineResolution(unsigned int resolution[2],
   resolution[0] = preferredResolution[0];
   resolution[1] = preferredResolution[1];
 }
+
+bool SetValueOperation::hashExecutionData(uint64_t *r_hash)
+{
+  *r_hash = ResultCache::hashBytes(*r_hash, &this->m_value, sizeof(this->m_value));
+  return true;
+}
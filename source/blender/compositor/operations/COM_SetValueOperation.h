@@ -53,4 +53,6 @@ class SetValueOperation : public NodeOperation {
   {
     return true;
   }
+
+  bool hashExecutionData(uint64_t *r_hash);
 };
@@ -17,6 +17,7 @@
  */
 
 #include "COM_SetVectorOperation.h"
+#include "COM_ResultCache.h"
 #include "COM_defines.h"
 
 SetVectorOperation::SetVectorOperation() : NodeOperation()
@@ -40,3 +41,10 @@ void SetVectorOperation::determineResolution(unsigned int resolution[2],
   resolution[0] = preferredResolution[0];
   resolution[1] = preferredResolution[1];
 }
+
+bool SetVectorOperation::hashExecutionData(uint64_t *r_hash)
+{
+  const float vector[4] = {this->m_x, this->m_y, this->m_z, this->m_w};
+  *r_hash = ResultCache::hashBytes(*r_hash, vector, sizeof(vector));
+  return true;
+}
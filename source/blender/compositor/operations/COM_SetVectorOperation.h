@@ -81,6 +81,8 @@ class SetVectorOperation : public NodeOperation {
     return true;
   }
 
+  bool hashExecutionData(uint64_t *r_hash);
+
   void setVector(const float vector[3])
   {
     setX(vector[0]);
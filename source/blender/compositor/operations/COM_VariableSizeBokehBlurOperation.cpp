@@ -34,6 +34,7 @@ VariableSizeBokehBlurOperation::VariableSizeBokehBlurOperation() : NodeOperation
   this->addOutputSocket(COM_DT_COLOR);
   this->setComplex(true);
   this->setOpenCL(true);
+  this->setFullFrame(true);
 
   this->m_inputProgram = NULL;
   this->m_inputBokehProgram = NULL;
@@ -69,7 +70,12 @@ void *VariableSizeBokehBlurOperation::initializeTileData(rcti *rect)
   data->color = (MemoryBuffer *)this->m_inputProgram->initializeTileData(rect);
   data->bokeh = (MemoryBuffer *)this->m_inputBokehProgram->initializeTileData(rect);
   data->size = (MemoryBuffer *)this->m_inputSizeProgram->initializeTileData(rect);
+  data->maxBlurScalar = determineMaxBlurScalar(rect, data->size);
+  return data;
+}
 
+int VariableSizeBokehBlurOperation::determineMaxBlurScalar(rcti *rect, MemoryBuffer *size)
+{
   rcti rect2;
   this->determineDependingAreaOfInterest(
       rect, (ReadBufferOperation *)this->m_inputSizeProgram, &rect2);
@@ -77,9 +83,9 @@ void *VariableSizeBokehBlurOperation::initializeTileData(rcti *rect)
   const float max_dim = max(m_width, m_height);
   const float scalar = this->m_do_size_scale ? (max_dim / 100.0f) : 1.0f;
 
-  data->maxBlurScalar = (int)(data->size->getMaximumValue(&rect2) * scalar);
-  CLAMP(data->maxBlurScalar, 1.0f, this->m_maxBlur);
-  return data;
+  int maxBlurScalar = (int)(size->getMaximumValue(&rect2) * scalar);
+  CLAMP(maxBlurScalar, 1.0f, this->m_maxBlur);
+  return maxBlurScalar;
 }
 
 void VariableSizeBokehBlurOperation::deinitializeTileData(rcti * /*rect*/, void *data)
@@ -181,6 +187,97 @@ void VariableSizeBokehBlurOperation::executePixel(float output[4], int x, int y,
   }
 }
 
+/* First position of a lattice of positions with the given step starting at start, that isn't
+ * smaller than min. */
+static int lattice_ceil(int start, int step, int min)
+{
+  return (min <= start) ? start : start + ((min - start + step - 1) / step) * step;
+}
+
+void VariableSizeBokehBlurOperation::executeFullFrame(MemoryBuffer *output,
+                                                      rcti *area,
+                                                      MemoryBuffer **inputs)
+{
+  MemoryBuffer *color = inputs[0];
+  MemoryBuffer *bokeh = inputs[1];
+  MemoryBuffer *size = inputs[2];
+
+  BLI_assert(bokeh->getWidth() == COM_BLUR_BOKEH_PIXELS);
+  BLI_assert(bokeh->getHeight() == COM_BLUR_BOKEH_PIXELS);
+
+  const int maxBlurScalar = determineMaxBlurScalar(area, size);
+  const float max_dim = max(m_width, m_height);
+  const float scalar = this->m_do_size_scale ? (max_dim / 100.0f) : 1.0f;
+  const int step = QualityStepHelper::getStep();
+  const int color_stride = color->getElemStride();
+  const int size_stride = size->getElemStride();
+  const int output_stride = output->getElemStride();
+
+  for (int y = area->ymin; y < area->ymax; y++) {
+    const int miny = max(y - maxBlurScalar, 0);
+    const int maxy = min(y + maxBlurScalar, (int)m_height);
+    float *out = output->getElem(area->xmin, y);
+
+    for (int x = area->xmin; x < area->xmax; x++, out += output_stride) {
+      const int minx = max(x - maxBlurScalar, 0);
+      const int maxx = min(x + maxBlurScalar, (int)m_width);
+      const float *center_color = color->getElem(x, y);
+      const float size_center = size->getElem(x, y)[0] * scalar;
+
+      float color_accum[4];
+      float multiplier_accum[4];
+      copy_v4_v4(color_accum, center_color);
+      copy_v4_fl(multiplier_accum, 1.0f);
+
+      if (size_center > this->m_threshold) {
+        /* The size used for a neighbor is at most the size of this pixel, so only neighbors
+         * closer than that can contribute. Keep the positions the tiled execution samples. */
+        const float radius = min_ff(size_center, (float)maxBlurScalar);
+        const int search_ymin = lattice_ceil(miny, step, (int)floorf(y - radius) + 1);
+        const int search_ymax = min(maxy, (int)ceilf(y + radius));
+        const int search_xmin = lattice_ceil(minx, step, (int)floorf(x - radius) + 1);
+        const int search_xmax = min(maxx, (int)ceilf(x + radius));
+
+        for (int ny = search_ymin; ny < search_ymax; ny += step) {
+          const float dy = ny - y;
+          const float *size_elem = size->getElem(search_xmin, ny);
+          const float *color_elem = color->getElem(search_xmin, ny);
+          for (int nx = search_xmin; nx < search_xmax; nx += step) {
+            if (nx != x || ny != y) {
+              const float size_elem_scaled = min(size_elem[0] * scalar, size_center);
+              const float dx = nx - x;
+              if (size_elem_scaled > this->m_threshold && size_elem_scaled > fabsf(dx) &&
+                  size_elem_scaled > fabsf(dy)) {
+                const float u = (float)(COM_BLUR_BOKEH_PIXELS / 2) +
+                                (dx / size_elem_scaled) * (float)((COM_BLUR_BOKEH_PIXELS / 2) - 1);
+                const float v = (float)(COM_BLUR_BOKEH_PIXELS / 2) +
+                                (dy / size_elem_scaled) * (float)((COM_BLUR_BOKEH_PIXELS / 2) - 1);
+                float bokeh_weight[4];
+                bokeh->read(bokeh_weight, u, v);
+                madd_v4_v4v4(color_accum, bokeh_weight, color_elem);
+                add_v4_v4(multiplier_accum, bokeh_weight);
+              }
+            }
+            size_elem += size_stride * step;
+            color_elem += color_stride * step;
+          }
+        }
+      }
+
+      out[0] = color_accum[0] / multiplier_accum[0];
+      out[1] = color_accum[1] / multiplier_accum[1];
+      out[2] = color_accum[2] / multiplier_accum[2];
+      out[3] = color_accum[3] / multiplier_accum[3];
+
+      /* Blend in out values over the threshold, same as executePixel. */
+      if ((size_center > this->m_threshold) && (size_center < this->m_threshold * 2.0f)) {
+        const float fac = (size_center - this->m_threshold) / this->m_threshold;
+        interp_v4_v4v4(out, center_color, out, fac);
+      }
+    }
+  }
+}
+
 void VariableSizeBokehBlurOperation::executeOpenCL(OpenCLDevice *device,
                                                    MemoryBuffer *outputMemoryBuffer,
                                                    cl_mem clOutputBuffer,
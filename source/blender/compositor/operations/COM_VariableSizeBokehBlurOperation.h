@@ -35,6 +35,11 @@ class VariableSizeBokehBlurOperation : public NodeOperation, public QualityStepH
   SocketReader *m_inputSearchProgram;
 #endif
 
+  /**
+   * Largest blur radius in pixels, of the size input around the rect.
+   */
+  int determineMaxBlurScalar(rcti *rect, MemoryBuffer *size);
+
  public:
   VariableSizeBokehBlurOperation();
 
@@ -43,6 +48,8 @@ class VariableSizeBokehBlurOperation : public NodeOperation, public QualityStepH
    */
   void executePixel(float output[4], int x, int y, void *data);
 
+  void executeFullFrame(MemoryBuffer *output, rcti *area, MemoryBuffer **inputs);
+
   /**
    * Initialize the execution
    */
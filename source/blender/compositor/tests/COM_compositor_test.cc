@@ -0,0 +1,249 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_appdir.h"
+#include "BKE_idtype.h"
+#include "BKE_image.h"
+#include "BKE_main.h"
+#include "BKE_node.h"
+#include "BKE_scene.h"
+
+#include "DNA_genfile.h"
+#include "DNA_image_types.h"
+#include "DNA_node_types.h"
+#include "DNA_scene_types.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "RNA_define.h"
+
+#include "COM_ResultCache.h"
+#include "COM_compositor.h"
+
+class CompositorTest : public testing::Test {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  bNodeTree *ntree = nullptr;
+  bNode *gamma = nullptr;
+  Image *viewer_image = nullptr;
+
+  static void SetUpTestCase()
+  {
+    DNA_sdna_current_init();
+    BKE_idtype_init();
+    BKE_appdir_init();
+    IMB_init();
+    BKE_images_init();
+    RNA_init();
+    init_nodesystem();
+  }
+
+  static void TearDownTestCase()
+  {
+    free_nodesystem();
+    RNA_exit();
+    BKE_images_exit();
+    IMB_exit();
+    DNA_sdna_current_free();
+  }
+
+  void TearDown() override
+  {
+    COM_deinitialize();
+    if (bmain != nullptr) {
+      BKE_main_free(bmain);
+      bmain = nullptr;
+    }
+  }
+
+  static void stats_draw(void * /*sdh*/, const char * /*str*/)
+  {
+  }
+  static int test_break(void * /*tbh*/)
+  {
+    return 0;
+  }
+  static void progress(void * /*prh*/, float /*progress*/)
+  {
+  }
+  static void update_draw(void * /*udh*/)
+  {
+  }
+
+  bNode *node_add(int type)
+  {
+    return nodeAddStaticNode(nullptr, ntree, type);
+  }
+
+  void link_add(bNode *from, const char *from_socket, bNode *to, const char *to_socket)
+  {
+    nodeAddLink(ntree,
+                from,
+                nodeFindSocket(from, SOCK_OUT, from_socket),
+                to,
+                nodeFindSocket(to, SOCK_IN, to_socket));
+  }
+
+  /* Image that is blurred, defocused and color corrected, then mixed with the original image. */
+  void tree_create(const int width, const int height)
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    scene->r.xsch = width;
+    scene->r.ysch = height;
+    scene->r.size = 100;
+
+    ntree = ntreeAddTree(bmain, "Compositing", "CompositorNodeTree");
+    ntree->stats_draw = stats_draw;
+    ntree->test_break = test_break;
+    ntree->progress = progress;
+    ntree->update_draw = update_draw;
+
+    const float color[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    Image *source = BKE_image_add_generated(bmain,
+                                            width,
+                                            height,
+                                            "Source",
+                                            32,
+                                            true,
+                                            IMA_GENTYPE_GRID_COLOR,
+                                            color,
+                                            false,
+                                            false,
+                                            false);
+    bNode *image = node_add(CMP_NODE_IMAGE);
+    image->id = &source->id;
+
+    bNode *blur = node_add(CMP_NODE_BLUR);
+    NodeBlurData *blur_data = static_cast<NodeBlurData *>(blur->storage);
+    blur_data->sizex = 20;
+    blur_data->sizey = 20;
+
+    bNode *defocus = node_add(CMP_NODE_DEFOCUS);
+    NodeDefocus *defocus_data = static_cast<NodeDefocus *>(defocus->storage);
+    defocus_data->maxblur = 8;
+    bNodeSocket *z = nodeFindSocket(defocus, SOCK_IN, "Z");
+    static_cast<bNodeSocketValueFloat *>(z->default_value)->value = 4.0f;
+
+    bNode *bright_contrast = node_add(CMP_NODE_BRIGHTCONTRAST);
+    gamma = node_add(CMP_NODE_GAMMA);
+    bNode *color_balance = node_add(CMP_NODE_COLORBALANCE);
+    bNode *mix = node_add(CMP_NODE_MIX_RGB);
+
+    bNode *viewer = node_add(CMP_NODE_VIEWER);
+    viewer_image = BKE_image_ensure_viewer(bmain, IMA_TYPE_COMPOSITE, "Viewer Node");
+    viewer->id = &viewer_image->id;
+
+    link_add(image, "Image", blur, "Image");
+    link_add(blur, "Image", defocus, "Image");
+    link_add(defocus, "Image", bright_contrast, "Image");
+    link_add(bright_contrast, "Image", gamma, "Image");
+    link_add(gamma, "Image", color_balance, "Image");
+    link_add(image, "Image", mix, "Image");
+    link_add(color_balance, "Image", mix, "Image_001");
+    link_add(mix, "Image", viewer, "Image");
+
+    ntreeUpdateTree(bmain, ntree);
+  }
+
+  void execute()
+  {
+    COM_execute(
+        &scene->r, scene, ntree, false, &scene->view_settings, &scene->display_settings, "");
+  }
+
+  void gamma_set(const float value)
+  {
+    bNodeSocket *socket = nodeFindSocket(gamma, SOCK_IN, "Gamma");
+    static_cast<bNodeSocketValueFloat *>(socket->default_value)->value = value;
+  }
+
+  std::vector<float> viewer_pixels()
+  {
+    void *lock;
+    ImBuf *ibuf = BKE_image_acquire_ibuf(viewer_image, nullptr, &lock);
+    std::vector<float> pixels;
+    if (ibuf != nullptr && ibuf->rect_float != nullptr) {
+      pixels.assign(ibuf->rect_float, ibuf->rect_float + (size_t)4 * ibuf->x * ibuf->y);
+    }
+    BKE_image_release_ibuf(viewer_image, ibuf, lock);
+    return pixels;
+  }
+};
+
+TEST_F(CompositorTest, FullFrameMatchesTiled)
+{
+  tree_create(160, 90);
+
+  ntree->execution_mode = NTREE_EXECUTION_MODE_TILED;
+  execute();
+  const std::vector<float> tiled = viewer_pixels();
+
+  COM_clearCaches();
+  ntree->execution_mode = NTREE_EXECUTION_MODE_FULL_FRAME;
+  execute();
+  const std::vector<float> full_frame = viewer_pixels();
+
+  ASSERT_EQ(tiled.size(), (size_t)4 * 160 * 90);
+  ASSERT_EQ(tiled.size(), full_frame.size());
+
+  /* The blur passes normalize their weights before adding them up, which only differs in
+   * rounding. */
+  float max_difference = 0.0f;
+  for (size_t i = 0; i < tiled.size(); i++) {
+    max_difference = std::max(max_difference, fabsf(tiled[i] - full_frame[i]));
+  }
+  EXPECT_LT(max_difference, 1e-4f);
+}
+
+TEST_F(CompositorTest, ReexecuteAfterGammaChange)
+{
+  tree_create(160, 90);
+  ntree->execution_mode = NTREE_EXECUTION_MODE_FULL_FRAME;
+
+  COM_clearCaches();
+  gamma_set(1.0f);
+  execute();
+  const unsigned int first_add_count = ResultCache::getAddCount();
+  EXPECT_GT(first_add_count, 0u);
+  EXPECT_EQ(ResultCache::getHitCount(), 0u);
+
+  /* Nothing changed, no operation is executed again. */
+  execute();
+  EXPECT_EQ(ResultCache::getAddCount(), first_add_count);
+  EXPECT_GT(ResultCache::getHitCount(), 0u);
+
+  /* The blur and defocus results are taken from the cache, only the operations after the gamma
+   * node are executed. */
+  const unsigned int hit_count = ResultCache::getHitCount();
+  gamma_set(1.5f);
+  execute();
+  const unsigned int reexecute_add_count = ResultCache::getAddCount() - first_add_count;
+  EXPECT_GT(reexecute_add_count, 0u);
+  EXPECT_LT(reexecute_add_count, first_add_count);
+  EXPECT_GT(ResultCache::getHitCount(), hit_count);
+}
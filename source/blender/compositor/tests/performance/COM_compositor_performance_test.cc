@@ -0,0 +1,161 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BKE_appdir.h"
+#include "BKE_idtype.h"
+#include "BKE_image.h"
+#include "BKE_main.h"
+#include "BKE_node.h"
+#include "BKE_scene.h"
+
+#include "DNA_genfile.h"
+#include "DNA_image_types.h"
+#include "DNA_node_types.h"
+#include "DNA_scene_types.h"
+
+#include "IMB_imbuf.h"
+
+#include "RNA_define.h"
+
+#include "COM_compositor.h"
+
+#include "PIL_time.h"
+
+#define NUM_RUN_AVERAGED 3
+
+static void stats_draw(void * /*sdh*/, const char * /*str*/)
+{
+}
+static int test_break(void * /*tbh*/)
+{
+  return 0;
+}
+static void progress(void * /*prh*/, float /*progress*/)
+{
+}
+static void update_draw(void * /*udh*/)
+{
+}
+
+static void link_add(
+    bNodeTree *ntree, bNode *from, const char *from_socket, bNode *to, const char *to_socket)
+{
+  nodeAddLink(ntree,
+              from,
+              nodeFindSocket(from, SOCK_OUT, from_socket),
+              to,
+              nodeFindSocket(to, SOCK_IN, to_socket));
+}
+
+/* Image that is blurred, defocused and color corrected, then mixed with the original image.
+ * Returns the gamma node, which is changed between executions. */
+static bNode *tree_create(Main *bmain, Scene *scene, bNodeTree *ntree)
+{
+  const float color[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+  Image *source = BKE_image_add_generated(bmain,
+                                          scene->r.xsch,
+                                          scene->r.ysch,
+                                          "Source",
+                                          32,
+                                          true,
+                                          IMA_GENTYPE_GRID_COLOR,
+                                          color,
+                                          false,
+                                          false,
+                                          false);
+  bNode *image = nodeAddStaticNode(nullptr, ntree, CMP_NODE_IMAGE);
+  image->id = &source->id;
+
+  bNode *blur = nodeAddStaticNode(nullptr, ntree, CMP_NODE_BLUR);
+  NodeBlurData *blur_data = (NodeBlurData *)blur->storage;
+  blur_data->sizex = 20;
+  blur_data->sizey = 20;
+
+  bNode *defocus = nodeAddStaticNode(nullptr, ntree, CMP_NODE_DEFOCUS);
+  NodeDefocus *defocus_data = (NodeDefocus *)defocus->storage;
+  defocus_data->maxblur = 8;
+  bNodeSocket *z = nodeFindSocket(defocus, SOCK_IN, "Z");
+  ((bNodeSocketValueFloat *)z->default_value)->value = 4.0f;
+
+  bNode *bright_contrast = nodeAddStaticNode(nullptr, ntree, CMP_NODE_BRIGHTCONTRAST);
+  bNode *gamma = nodeAddStaticNode(nullptr, ntree, CMP_NODE_GAMMA);
+  bNode *color_balance = nodeAddStaticNode(nullptr, ntree, CMP_NODE_COLORBALANCE);
+  bNode *mix = nodeAddStaticNode(nullptr, ntree, CMP_NODE_MIX_RGB);
+
+  bNode *viewer = nodeAddStaticNode(nullptr, ntree, CMP_NODE_VIEWER);
+  viewer->id = &BKE_image_ensure_viewer(bmain, IMA_TYPE_COMPOSITE, "Viewer Node")->id;
+
+  link_add(ntree, image, "Image", blur, "Image");
+  link_add(ntree, blur, "Image", defocus, "Image");
+  link_add(ntree, defocus, "Image", bright_contrast, "Image");
+  link_add(ntree, bright_contrast, "Image", gamma, "Image");
+  link_add(ntree, gamma, "Image", color_balance, "Image");
+  link_add(ntree, image, "Image", mix, "Image");
+  link_add(ntree, color_balance, "Image", mix, "Image_001");
+  link_add(ntree, mix, "Image", viewer, "Image");
+
+  ntreeUpdateTree(bmain, ntree);
+  return gamma;
+}
+
+static double execute_time_average(Scene *scene,
+                                   bNodeTree *ntree,
+                                   bNode *gamma,
+                                   const short execution_mode)
+{
+  bNodeSocket *gamma_socket = nodeFindSocket(gamma, SOCK_IN, "Gamma");
+  ntree->execution_mode = execution_mode;
+  COM_clearCaches();
+
+  const double start_time = PIL_check_seconds_timer();
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    /* Changes every execution, so results after the gamma node aren't cached. */
+    ((bNodeSocketValueFloat *)gamma_socket->default_value)->value = 1.0f + 0.1f * i;
+    COM_execute(
+        &scene->r, scene, ntree, false, &scene->view_settings, &scene->display_settings, "");
+  }
+  return (PIL_check_seconds_timer() - start_time) / NUM_RUN_AVERAGED;
+}
+
+TEST(compositor, BlurDefocusColorMix)
+{
+  DNA_sdna_current_init();
+  BKE_idtype_init();
+  BKE_appdir_init();
+  IMB_init();
+  BKE_images_init();
+  RNA_init();
+  init_nodesystem();
+
+  Main *bmain = BKE_main_new();
+  Scene *scene = BKE_scene_add(bmain, "Scene");
+  scene->r.xsch = 1920;
+  scene->r.ysch = 1080;
+  scene->r.size = 100;
+
+  bNodeTree *ntree = ntreeAddTree(bmain, "Compositing", "CompositorNodeTree");
+  ntree->stats_draw = stats_draw;
+  ntree->test_break = test_break;
+  ntree->progress = progress;
+  ntree->update_draw = update_draw;
+  bNode *gamma = tree_create(bmain, scene, ntree);
+
+  const double tiled_time = execute_time_average(scene, ntree, gamma, NTREE_EXECUTION_MODE_TILED);
+  const double full_frame_time = execute_time_average(
+      scene, ntree, gamma, NTREE_EXECUTION_MODE_FULL_FRAME);
+
+  printf("Blur, defocus, color correction and mix of a %dx%d image:\n",
+         scene->r.xsch,
+         scene->r.ysch);
+  printf("\tTiled: %fs on average over %d runs\n", tiled_time, NUM_RUN_AVERAGED);
+  printf("\tFull frame: %fs on average over %d runs\n", full_frame_time, NUM_RUN_AVERAGED);
+
+  COM_deinitialize();
+  BKE_main_free(bmain);
+  free_nodesystem();
+  RNA_exit();
+  BKE_images_exit();
+  IMB_exit();
+  DNA_sdna_current_free();
+}
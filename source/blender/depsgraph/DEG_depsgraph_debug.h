@@ -62,6 +62,11 @@ void DEG_debug_stats_gnuplot(const struct Depsgraph *graph,
                              const char *label,
                              const char *output_filename);
 
+/* Record the operations evaluated by the graph, per thread, until the trace is written in the
+ * Chrome trace event format. Every evaluation (i.e. every frame during playback) is added. */
+void DEG_debug_eval_trace_begin(struct Depsgraph *depsgraph);
+void DEG_debug_eval_trace_end(struct Depsgraph *depsgraph, FILE *fp);
+
 /* ************************************************ */
 
 /* Compare two dependency graphs. */
@@ -25,8 +25,12 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "DNA_action_types.h"
 #include "DNA_anim_types.h"
+#include "DNA_armature_types.h"
+#include "DNA_object_types.h"
 
+#include "BLI_listbase.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_animsys.h"
@@ -106,14 +110,91 @@ void animated_property_cb(ID * /*id*/, FCurve *fcurve, void *data_v)
   if (pointer_rna.owner_id != data->pointer_rna.owner_id) {
     animated_property_storage = data->builder_cache->ensureAnimatedPropertyStorage(
         pointer_rna.owner_id);
+    animated_property_storage->has_foreign_properties = true;
+    data->animated_property_storage->has_foreign_properties = true;
   }
   /* Set the property as animated. */
   animated_property_storage->tagPropertyAsAnimated(&pointer_rna, property_rna);
 }
 
+/* Hashing of the data which affects the result of the queries to the storage. */
+
+void hash_combine(uint64_t &hash, uint64_t value)
+{
+  /* FNV-1a over 64 bit words. */
+  hash = (hash ^ value) * 1099511628211ULL;
+}
+
+void hash_combine_pointer(uint64_t &hash, const void *pointer)
+{
+  hash_combine(hash, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pointer)));
+}
+
+void hash_combine_string(uint64_t &hash, const char *string)
+{
+  for (const char *c = string; *c != '\0'; c++) {
+    hash_combine(hash, static_cast<uint64_t>(*c));
+  }
+}
+
+void animated_property_hash_cb(ID * /*id*/, FCurve *fcurve, void *data_v)
+{
+  uint64_t &hash = *static_cast<uint64_t *>(data_v);
+  hash_combine_pointer(hash, fcurve);
+  hash_combine(hash, static_cast<uint64_t>(fcurve->array_index));
+  if (fcurve->rna_path != nullptr) {
+    hash_combine_string(hash, fcurve->rna_path);
+  }
+}
+
+void animated_property_hash_bones(uint64_t &hash, const ListBase *bones)
+{
+  LISTBASE_FOREACH (const Bone *, bone, bones) {
+    hash_combine_pointer(hash, bone);
+    hash_combine_string(hash, bone->name);
+    animated_property_hash_bones(hash, &bone->childbase);
+  }
+}
+
+/* Hash of everything the animated properties of the ID are resolved from: its F-Curves and the
+ * addresses of the sub-data which is queried by the builders (pose channels and bones).
+ *
+ * Paths can also resolve to other sub-data (modifiers, constraints...), stale entries for those
+ * never match a query since the property would be of a different RNA type. Paths resolving to
+ * other IDs make the storage foreign, and those are not kept between builds. */
+uint64_t animated_property_storage_hash(ID *id)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  hash_combine(hash, static_cast<uint64_t>(id->session_uuid));
+  BKE_fcurves_id_cb(id, animated_property_hash_cb, &hash);
+  switch (GS(id->name)) {
+    case ID_OB: {
+      const Object *object = reinterpret_cast<const Object *>(id);
+      hash_combine_pointer(hash, object->data);
+      if (object->pose != nullptr) {
+        LISTBASE_FOREACH (const bPoseChannel *, pchan, &object->pose->chanbase) {
+          hash_combine_pointer(hash, pchan);
+          hash_combine_pointer(hash, pchan->bone);
+          hash_combine_string(hash, pchan->name);
+        }
+      }
+      break;
+    }
+    case ID_AR: {
+      const bArmature *armature = reinterpret_cast<const bArmature *>(id);
+      animated_property_hash_bones(hash, &armature->bonebase);
+      break;
+    }
+    default:
+      break;
+  }
+  return hash;
+}
+
 }  // namespace
 
-AnimatedPropertyStorage::AnimatedPropertyStorage() : is_fully_initialized(false)
+AnimatedPropertyStorage::AnimatedPropertyStorage()
+    : is_fully_initialized(false), has_foreign_properties(false), hash(0)
 {
 }
 
@@ -155,15 +236,56 @@ DepsgraphBuilderCache::DepsgraphBuilderCache()
 }
 
 DepsgraphBuilderCache::~DepsgraphBuilderCache()
+{
+  clear();
+}
+
+void DepsgraphBuilderCache::begin_build()
+{
+  validated_ids_.clear();
+}
+
+void DepsgraphBuilderCache::end_build()
+{
+  /* Only keep storages which are self-contained and were used by this build, others might belong
+   * to IDs which are freed before the next build, or depend on data of other IDs. */
+  Vector<ID *> ids_to_remove;
+  for (const auto &item : animated_property_storage_map_.items()) {
+    const AnimatedPropertyStorage *animated_property_storage = item.value;
+    if (!validated_ids_.contains(item.key) || !animated_property_storage->is_fully_initialized ||
+        animated_property_storage->has_foreign_properties) {
+      ids_to_remove.append(item.key);
+    }
+  }
+  for (ID *id : ids_to_remove) {
+    delete animated_property_storage_map_.pop(id);
+  }
+  validated_ids_.clear();
+}
+
+void DepsgraphBuilderCache::clear()
 {
   for (AnimatedPropertyStorage *animated_property_storage :
        animated_property_storage_map_.values()) {
     delete animated_property_storage;
   }
+  animated_property_storage_map_.clear();
+  validated_ids_.clear();
 }
 
 AnimatedPropertyStorage *DepsgraphBuilderCache::ensureAnimatedPropertyStorage(ID *id)
 {
+  if (validated_ids_.add(id)) {
+    /* First access to the ID during this build, the storage kept from a previous build is only
+     * re-used when nothing it was initialized from has changed. */
+    AnimatedPropertyStorage *animated_property_storage =
+        animated_property_storage_map_.lookup_default(id, nullptr);
+    if (animated_property_storage != nullptr &&
+        animated_property_storage->hash != animated_property_storage_hash(id)) {
+      animated_property_storage_map_.remove(id);
+      delete animated_property_storage;
+    }
+  }
   return animated_property_storage_map_.lookup_or_add_cb(
       id, []() { return new AnimatedPropertyStorage(); });
 }
@@ -174,6 +296,7 @@ AnimatedPropertyStorage *DepsgraphBuilderCache::ensureInitializedAnimatedPropert
   if (!animated_property_storage->is_fully_initialized) {
     animated_property_storage->initializeFromID(this, id);
     animated_property_storage->is_fully_initialized = true;
+    animated_property_storage->hash = animated_property_storage_hash(id);
   }
   return animated_property_storage;
 }
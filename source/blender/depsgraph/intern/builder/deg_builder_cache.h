@@ -72,6 +72,13 @@ class AnimatedPropertyStorage {
   /* The storage is fully initialized from all F-Curves from corresponding ID. */
   bool is_fully_initialized;
 
+  /* Properties of another ID were tagged from F-Curves of this ID, or properties of this ID were
+   * tagged from F-Curves of another one. Such storages are not kept between builds. */
+  bool has_foreign_properties;
+
+  /* Hash of the data the storage was initialized from, see animated_property_storage_hash(). */
+  uint64_t hash;
+
   /* indexed by PointerRNA.data. */
   Set<AnimatedPropertyID> animated_properties_set;
 
@@ -84,6 +91,14 @@ class DepsgraphBuilderCache {
   DepsgraphBuilderCache();
   ~DepsgraphBuilderCache();
 
+  /* The cache is owned by the dependency graph and kept between its rebuilds, so only storages of
+   * IDs which changed since the previous build are initialized again.
+   * Must be called before and after every build of the graph. */
+  void begin_build();
+  void end_build();
+
+  void clear();
+
   /* Makes sure storage for animated properties exists and initialized for the given ID. */
   AnimatedPropertyStorage *ensureAnimatedPropertyStorage(ID *id);
   AnimatedPropertyStorage *ensureInitializedAnimatedPropertyStorage(ID *id);
@@ -105,6 +120,10 @@ class DepsgraphBuilderCache {
 
   Map<ID *, AnimatedPropertyStorage *> animated_property_storage_map_;
 
+  /* IDs for which the storage was checked to be up to date (or created) during current build.
+   * Keys of storages which are not in this set might be freed IDs, and are never dereferenced. */
+  Set<ID *> validated_ids_;
+
   MEM_CXX_CLASS_ALLOC_FUNCS("DepsgraphBuilderCache");
 };
 
@@ -0,0 +1,222 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/builder/deg_builder_cache.h"
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_anim_types.h"
+#include "DNA_object_types.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+
+#include "BKE_anim_data.h"
+#include "BKE_fcurve.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+
+#include "DEG_depsgraph.h"
+
+#include "RNA_access.h"
+#include "RNA_define.h"
+
+namespace blender {
+namespace deg {
+namespace tests {
+
+class DepsgraphBuilderCacheTest : public testing::Test {
+ protected:
+  Main *bmain = nullptr;
+  Object *object = nullptr;
+
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+    RNA_init();
+    DEG_register_node_types();
+  }
+
+  static void TearDownTestCase()
+  {
+    DEG_free_node_types();
+    RNA_exit();
+  }
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    object = BKE_object_add_only_object(bmain, OB_EMPTY, "Object");
+  }
+
+  void TearDown() override
+  {
+    BKE_main_free(bmain);
+  }
+
+  FCurve *fcurve_add(ListBase *fcurves, const char *rna_path)
+  {
+    FCurve *fcu = BKE_fcurve_create();
+    fcu->rna_path = BLI_strdup(rna_path);
+    BLI_addtail(fcurves, fcu);
+    return fcu;
+  }
+
+  bool is_animated(DepsgraphBuilderCache &cache, const char *property_name)
+  {
+    return cache.isPropertyAnimated(&object->id,
+                                    AnimatedPropertyID(&object->id, &RNA_Object, property_name));
+  }
+
+  /* Mark a property which is not animated in the storage kept from the previous build. It is only
+   * reported as animated by the next build when the storage was re-used. */
+  void tag_marker(DepsgraphBuilderCache &cache)
+  {
+    AnimatedPropertyStorage *storage = cache.ensureInitializedAnimatedPropertyStorage(&object->id);
+    storage->tagPropertyAsAnimated(
+        AnimatedPropertyID(&object->id, &RNA_Object, "empty_display_size"));
+  }
+
+  bool has_marker(DepsgraphBuilderCache &cache)
+  {
+    return is_animated(cache, "empty_display_size");
+  }
+};
+
+TEST_F(DepsgraphBuilderCacheTest, KeepUnchanged)
+{
+  DepsgraphBuilderCache cache;
+  AnimData *adt = BKE_animdata_add_id(&object->id);
+  fcurve_add(&adt->drivers, "location");
+
+  cache.begin_build();
+  EXPECT_TRUE(is_animated(cache, "location"));
+  EXPECT_FALSE(is_animated(cache, "scale"));
+  tag_marker(cache);
+  cache.end_build();
+
+  cache.begin_build();
+  EXPECT_TRUE(has_marker(cache));
+  EXPECT_TRUE(is_animated(cache, "location"));
+  cache.end_build();
+}
+
+TEST_F(DepsgraphBuilderCacheTest, InvalidateOnPathChange)
+{
+  DepsgraphBuilderCache cache;
+  AnimData *adt = BKE_animdata_add_id(&object->id);
+  FCurve *fcu = fcurve_add(&adt->drivers, "location");
+
+  cache.begin_build();
+  EXPECT_TRUE(is_animated(cache, "location"));
+  tag_marker(cache);
+  cache.end_build();
+
+  MEM_freeN(fcu->rna_path);
+  fcu->rna_path = BLI_strdup("scale");
+
+  cache.begin_build();
+  EXPECT_FALSE(has_marker(cache));
+  EXPECT_FALSE(is_animated(cache, "location"));
+  EXPECT_TRUE(is_animated(cache, "scale"));
+  cache.end_build();
+}
+
+TEST_F(DepsgraphBuilderCacheTest, InvalidateOnDriverChange)
+{
+  DepsgraphBuilderCache cache;
+  AnimData *adt = BKE_animdata_add_id(&object->id);
+  fcurve_add(&adt->drivers, "location");
+
+  cache.begin_build();
+  EXPECT_FALSE(is_animated(cache, "scale"));
+  tag_marker(cache);
+  cache.end_build();
+
+  /* Add a driver. */
+  FCurve *fcu = fcurve_add(&adt->drivers, "scale");
+  cache.begin_build();
+  EXPECT_FALSE(has_marker(cache));
+  EXPECT_TRUE(is_animated(cache, "scale"));
+  tag_marker(cache);
+  cache.end_build();
+
+  /* Remove it again. */
+  BLI_remlink(&adt->drivers, fcu);
+  BKE_fcurve_free(fcu);
+  cache.begin_build();
+  EXPECT_FALSE(has_marker(cache));
+  EXPECT_FALSE(is_animated(cache, "scale"));
+  EXPECT_TRUE(is_animated(cache, "location"));
+  cache.end_build();
+}
+
+TEST_F(DepsgraphBuilderCacheTest, InvalidateOnAnimationChange)
+{
+  DepsgraphBuilderCache cache;
+
+  cache.begin_build();
+  EXPECT_FALSE(is_animated(cache, "location"));
+  tag_marker(cache);
+  cache.end_build();
+
+  /* Assign an action. */
+  AnimData *adt = BKE_animdata_add_id(&object->id);
+  adt->action = static_cast<bAction *>(BKE_id_new(bmain, ID_AC, "Action"));
+  fcurve_add(&adt->action->curves, "location");
+  cache.begin_build();
+  EXPECT_FALSE(has_marker(cache));
+  EXPECT_TRUE(is_animated(cache, "location"));
+  tag_marker(cache);
+  cache.end_build();
+
+  /* Remove the animation data. */
+  BKE_animdata_free(&object->id, true);
+  cache.begin_build();
+  EXPECT_FALSE(has_marker(cache));
+  EXPECT_FALSE(is_animated(cache, "location"));
+  cache.end_build();
+}
+
+TEST_F(DepsgraphBuilderCacheTest, DropUnused)
+{
+  DepsgraphBuilderCache cache;
+
+  cache.begin_build();
+  cache.ensureInitializedAnimatedPropertyStorage(&object->id);
+  cache.end_build();
+  EXPECT_EQ(cache.animated_property_storage_map_.size(), 1);
+
+  /* Storages not used by a build are dropped, the ID might have been freed. */
+  cache.begin_build();
+  cache.end_build();
+  EXPECT_EQ(cache.animated_property_storage_map_.size(), 0);
+}
+
+}  // namespace tests
+}  // namespace deg
+}  // namespace blender
@@ -38,7 +38,7 @@ AbstractBuilderPipeline::AbstractBuilderPipeline(::Depsgraph *graph)
       bmain_(deg_graph_->bmain),
       scene_(deg_graph_->scene),
       view_layer_(deg_graph_->view_layer),
-      builder_cache_()
+      builder_cache_(*deg_graph_->builder_cache)
 {
 }
 
@@ -54,8 +54,10 @@ void AbstractBuilderPipeline::build()
   }
 
   build_step_sanity_check();
+  builder_cache_.begin_build();
   build_step_nodes();
   build_step_relations();
+  builder_cache_.end_build();
   build_step_finalize();
 
   if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
@@ -22,6 +22,7 @@
  */
 
 #include "intern/debug/deg_debug.h"
+#include "intern/debug/deg_debug_trace.h"
 
 #include "BLI_console.h"
 #include "BLI_hash.h"
@@ -36,10 +37,18 @@ namespace blender {
 namespace deg {
 
 DepsgraphDebug::DepsgraphDebug()
-    : flags(G.debug), is_ever_evaluated(false), graph_evaluation_start_time_(0)
+    : flags(G.debug),
+      is_ever_evaluated(false),
+      eval_trace(nullptr),
+      graph_evaluation_start_time_(0)
 {
 }
 
+DepsgraphDebug::~DepsgraphDebug()
+{
+  delete eval_trace;
+}
+
 bool DepsgraphDebug::do_time_debug() const
 {
   return ((G.debug & G_DEBUG_DEPSGRAPH_TIME) != 0);
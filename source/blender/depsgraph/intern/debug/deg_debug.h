@@ -33,9 +33,12 @@
 namespace blender {
 namespace deg {
 
+class DepsgraphEvalTrace;
+
 class DepsgraphDebug {
  public:
   DepsgraphDebug();
+  ~DepsgraphDebug();
 
   bool do_time_debug() const;
 
@@ -53,6 +56,9 @@ class DepsgraphDebug {
    * This is NOT an indication that depsgraph is at its evaluated state. */
   bool is_ever_evaluated;
 
+  /* Trace of the evaluated operations, only recorded while tracing is enabled. */
+  DepsgraphEvalTrace *eval_trace;
+
  protected:
   /* Maximum number of counters used to calculate frame rate of depsgraph update. */
   static const constexpr int MAX_FPS_COUNTERS = 64;
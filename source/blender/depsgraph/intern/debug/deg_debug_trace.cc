@@ -0,0 +1,126 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/debug/deg_debug_trace.h"
+
+#include <thread>
+
+#include "BLI_map.hh"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time.h"
+
+#include "intern/node/deg_node_operation.h"
+
+namespace blender {
+namespace deg {
+
+DepsgraphEvalTrace::DepsgraphEvalTrace()
+    : start_time_(PIL_check_seconds_timer()), evaluation_start_time_(0.0), evaluation_ctime_(0.0f)
+{
+  BLI_spin_init(&lock_);
+}
+
+DepsgraphEvalTrace::~DepsgraphEvalTrace()
+{
+  BLI_spin_end(&lock_);
+}
+
+void DepsgraphEvalTrace::begin_graph_evaluation(float ctime)
+{
+  evaluation_start_time_ = PIL_check_seconds_timer();
+  evaluation_ctime_ = ctime;
+}
+
+void DepsgraphEvalTrace::end_graph_evaluation()
+{
+  char name[64];
+  BLI_snprintf(name, sizeof(name), "Evaluation (frame %.2f)", evaluation_ctime_);
+  Event event = {name, 0, evaluation_start_time_, PIL_check_seconds_timer()};
+  BLI_spin_lock(&lock_);
+  events_.append(std::move(event));
+  BLI_spin_unlock(&lock_);
+}
+
+void DepsgraphEvalTrace::add_operation(const OperationNode *operation_node,
+                                       double start_time,
+                                       double end_time)
+{
+  Event event = {operation_node->full_identifier(),
+                 std::hash<std::thread::id>()(std::this_thread::get_id()),
+                 start_time,
+                 end_time};
+  BLI_spin_lock(&lock_);
+  events_.append(std::move(event));
+  BLI_spin_unlock(&lock_);
+}
+
+static void trace_write_string(FILE *fp, const string &str)
+{
+  fputc('"', fp);
+  for (const char c : str) {
+    if (ELEM(c, '"', '\\')) {
+      fputc('\\', fp);
+    }
+    fputc(c, fp);
+  }
+  fputc('"', fp);
+}
+
+void DepsgraphEvalTrace::write(FILE *fp) const
+{
+  /* Map thread identifiers to small numbers, in order of their first event. */
+  Map<uint64_t, int> thread_index_map;
+  thread_index_map.add(0, 0);
+
+  fprintf(fp, "{\"traceEvents\": [\n");
+  bool is_first = true;
+  for (const Event &event : events_) {
+    const int thread_index = thread_index_map.lookup_or_add(event.thread,
+                                                            thread_index_map.size());
+    fprintf(fp, "%s  {\"name\": ", is_first ? "" : ",\n");
+    trace_write_string(fp, event.name);
+    fprintf(fp,
+            ", \"ph\": \"X\", \"pid\": 0, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+            thread_index,
+            (event.start_time - start_time_) * 1e6,
+            (event.end_time - event.start_time) * 1e6);
+    is_first = false;
+  }
+  /* Name the tracks, so the evaluation is not mistaken for a thread. */
+  for (const auto &item : thread_index_map.items()) {
+    fprintf(fp,
+            "%s  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": %d, "
+            "\"args\": {\"name\": \"%s %d\"}}",
+            is_first ? "" : ",\n",
+            item.value,
+            item.value == 0 ? "Evaluation" : "Thread",
+            item.value);
+    is_first = false;
+  }
+  fprintf(fp, "\n]}\n");
+}
+
+}  // namespace deg
+}  // namespace blender
@@ -0,0 +1,73 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#pragma once
+
+#include <cstdio>
+
+#include "BLI_threads.h"
+
+#include "intern/depsgraph_type.h"
+
+namespace blender {
+namespace deg {
+
+struct OperationNode;
+
+/* Recorder of the operations evaluated by the depsgraph, written in the Chrome trace event format
+ * (can be opened in chrome://tracing or Perfetto), showing the occupancy of every thread. */
+class DepsgraphEvalTrace {
+ public:
+  DepsgraphEvalTrace();
+  ~DepsgraphEvalTrace();
+
+  /* Brackets a graph evaluation, recorded as an event of its own. */
+  void begin_graph_evaluation(float ctime);
+  void end_graph_evaluation();
+
+  /* Thread-safe. */
+  void add_operation(const OperationNode *operation_node, double start_time, double end_time);
+
+  void write(FILE *fp) const;
+
+ protected:
+  struct Event {
+    string name;
+    /* Hash of the evaluating thread identifier, the evaluation itself uses 0. */
+    uint64_t thread;
+    double start_time;
+    double end_time;
+  };
+
+  /* Time of the trace start, all event times are relative to it. */
+  double start_time_;
+
+  double evaluation_start_time_;
+  float evaluation_ctime_;
+
+  Vector<Event> events_;
+  SpinLock lock_;
+};
+
+}  // namespace deg
+}  // namespace blender
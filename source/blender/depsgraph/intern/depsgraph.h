@@ -52,6 +52,7 @@ struct ViewLayer;
 namespace blender {
 namespace deg {
 
+class DepsgraphBuilderCache;
 struct IDNode;
 struct Node;
 struct OperationNode;
@@ -164,6 +165,9 @@ struct Depsgraph {
    * does not need any bases. */
   bool is_render_pipeline_depsgraph;
 
+  /* Data cached by the builders, kept between rebuilds of the relations. */
+  DepsgraphBuilderCache *builder_cache;
+
   /* Cached list of colliders/effectors for collections and the scene
    * created along with relations, for fast lookup during evaluation. */
   Map<const ID *, ListBase *> *physics_relations[DEG_PHYSICS_RELATIONS_NUM];
@@ -35,6 +35,7 @@
 #include "DEG_depsgraph_query.h"
 
 #include "intern/debug/deg_debug.h"
+#include "intern/debug/deg_debug_trace.h"
 #include "intern/depsgraph.h"
 #include "intern/depsgraph_relation.h"
 #include "intern/depsgraph_type.h"
@@ -68,6 +69,26 @@ const char *DEG_debug_name_get(struct Depsgraph *depsgraph)
   return deg_graph->debug.name.c_str();
 }
 
+void DEG_debug_eval_trace_begin(Depsgraph *depsgraph)
+{
+  deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(depsgraph);
+  delete deg_graph->debug.eval_trace;
+  deg_graph->debug.eval_trace = new deg::DepsgraphEvalTrace();
+}
+
+void DEG_debug_eval_trace_end(Depsgraph *depsgraph, FILE *fp)
+{
+  deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(depsgraph);
+  if (deg_graph->debug.eval_trace == nullptr) {
+    return;
+  }
+  if (fp != nullptr) {
+    deg_graph->debug.eval_trace->write(fp);
+  }
+  delete deg_graph->debug.eval_trace;
+  deg_graph->debug.eval_trace = nullptr;
+}
+
 bool DEG_debug_compare(const struct Depsgraph *graph1, const struct Depsgraph *graph2)
 {
   BLI_assert(graph1 != nullptr);
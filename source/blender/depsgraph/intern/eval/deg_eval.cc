@@ -29,6 +29,8 @@
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_gsqueue.h"
+#include "BLI_heap.h"
+#include "BLI_math_base.h"
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
 
@@ -43,6 +45,7 @@
 
 #include "atomic_ops.h"
 
+#include "intern/debug/deg_debug_trace.h"
 #include "intern/depsgraph.h"
 #include "intern/depsgraph_relation.h"
 #include "intern/eval/deg_eval_copy_on_write.h"
@@ -62,6 +65,7 @@ namespace {
 struct DepsgraphEvalState;
 
 void deg_task_run_func(TaskPool *pool, void *taskdata);
+void deg_task_run_priority_func(TaskPool *pool, void *taskdata);
 
 template<typename ScheduleFunction, typename... ScheduleFunctionArgs>
 void schedule_children(DepsgraphEvalState *state,
@@ -74,6 +78,10 @@ void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), Tas
   BLI_task_pool_push(pool, deg_task_run_func, node, false, NULL);
 }
 
+void schedule_node_to_priority_pool(OperationNode *node,
+                                    const int UNUSED(thread_id),
+                                    TaskPool *pool);
+
 /* Denotes which part of dependency graph is being evaluated. */
 enum class EvaluationStage {
   /* Stage 1: Only  Copy-on-Write operations are to be evaluated, prior to anything else.
@@ -94,8 +102,20 @@ enum class EvaluationStage {
 struct DepsgraphEvalState {
   Depsgraph *graph;
   bool do_stats;
+  /* Schedule operations in order of their critical path cost. */
+  bool do_priority;
+  /* Measure the time every operation takes to evaluate. */
+  bool do_timing;
   EvaluationStage stage;
   bool need_single_thread_pass;
+
+  /* Trace of evaluated operations, only when tracing is enabled for the graph. */
+  DepsgraphEvalTrace *eval_trace;
+
+  /* Operations which are ready to be evaluated, ordered by their critical path cost.
+   * Only used for the priority scheduling. */
+  Heap *ready_heap;
+  SpinLock ready_heap_lock;
 };
 
 void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
@@ -105,10 +125,17 @@ void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_nod
   /* Sanity checks. */
   BLI_assert(!operation_node->is_noop() && "NOOP nodes should not actually be scheduled");
   /* Perform operation. */
-  if (state->do_stats) {
+  if (state->do_timing) {
     const double start_time = PIL_check_seconds_timer();
     operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
+    const double end_time = PIL_check_seconds_timer();
+    operation_node->eval_cost = end_time - start_time;
+    if (state->do_stats) {
+      operation_node->stats.current_time += end_time - start_time;
+    }
+    if (state->eval_trace != nullptr) {
+      state->eval_trace->add_operation(operation_node, start_time, end_time);
+    }
   }
   else {
     operation_node->evaluate(depsgraph);
@@ -128,6 +155,39 @@ void deg_task_run_func(TaskPool *pool, void *taskdata)
   schedule_children(state, operation_node, schedule_node_to_pool, pool);
 }
 
+/* Unlike deg_task_run_func() the task does not get an operation to evaluate: it evaluates the
+ * ready operation with the highest critical path cost at the time it runs. One task is pushed
+ * for every operation which becomes ready. */
+void deg_task_run_priority_func(TaskPool *pool, void *UNUSED(taskdata))
+{
+  void *userdata_v = BLI_task_pool_user_data(pool);
+  DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
+
+  BLI_spin_lock(&state->ready_heap_lock);
+  OperationNode *operation_node = reinterpret_cast<OperationNode *>(
+      BLI_heap_pop_min(state->ready_heap));
+  BLI_spin_unlock(&state->ready_heap_lock);
+
+  evaluate_node(state, operation_node);
+
+  schedule_children(state, operation_node, schedule_node_to_priority_pool, pool);
+}
+
+void schedule_node_to_priority_pool(OperationNode *node,
+                                    const int UNUSED(thread_id),
+                                    TaskPool *pool)
+{
+  void *userdata_v = BLI_task_pool_user_data(pool);
+  DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
+
+  /* Heap is sorted from the smallest value. */
+  BLI_spin_lock(&state->ready_heap_lock);
+  BLI_heap_insert(state->ready_heap, (float)-node->critical_path_cost, node);
+  BLI_spin_unlock(&state->ready_heap_lock);
+
+  BLI_task_pool_push(pool, deg_task_run_priority_func, NULL, false, NULL);
+}
+
 bool check_operation_node_visible(OperationNode *op_node)
 {
   const ComponentNode *comp_node = op_node->owner;
@@ -178,9 +238,57 @@ void calculate_pending_parents(Depsgraph *graph)
   }
 }
 
+/* Calculate the critical path cost of all operations: their own cost from the previous
+ * evaluation plus the largest critical path cost of the operations which depend on them.
+ *
+ * Operations are handled after all operations depending on them, num_links_pending is used to
+ * count the ones which are not handled yet (it is calculated again for the evaluation after). */
+void calculate_critical_path_costs(Depsgraph *graph)
+{
+  /* Operations which were never timed still count, so longer chains are preferred. */
+  const double min_eval_cost = 1e-7;
+
+  Vector<OperationNode *> ready_nodes;
+  for (OperationNode *node : graph->operations) {
+    node->num_links_pending = 0;
+    for (Relation *rel : node->outlinks) {
+      if ((rel->flag & RELATION_FLAG_CYCLIC) == 0) {
+        ++node->num_links_pending;
+      }
+    }
+    if (node->num_links_pending == 0) {
+      ready_nodes.append(node);
+    }
+  }
+
+  while (!ready_nodes.is_empty()) {
+    OperationNode *node = ready_nodes.pop_last();
+    double children_cost = 0.0;
+    for (Relation *rel : node->outlinks) {
+      if ((rel->flag & RELATION_FLAG_CYCLIC) == 0) {
+        const OperationNode *child = (OperationNode *)rel->to;
+        children_cost = max_dd(children_cost, child->critical_path_cost);
+      }
+    }
+    node->critical_path_cost = max_dd(node->eval_cost, min_eval_cost) + children_cost;
+
+    for (Relation *rel : node->inlinks) {
+      if (rel->from->type == NodeType::OPERATION && (rel->flag & RELATION_FLAG_CYCLIC) == 0) {
+        OperationNode *parent = (OperationNode *)rel->from;
+        if (--parent->num_links_pending == 0) {
+          ready_nodes.append(parent);
+        }
+      }
+    }
+  }
+}
+
 void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
 {
   const bool do_stats = state->do_stats;
+  if (state->do_priority) {
+    calculate_critical_path_costs(graph);
+  }
   calculate_pending_parents(graph);
   /* Clear tags and other things which needs to be clear. */
   for (OperationNode *node : graph->operations) {
@@ -379,7 +487,14 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   DepsgraphEvalState state;
   state.graph = graph;
   state.do_stats = graph->debug.do_time_debug();
+  state.do_priority = (G.debug & G_DEBUG_DEPSGRAPH_PRIORITY) != 0;
+  state.eval_trace = graph->debug.eval_trace;
+  state.do_timing = state.do_stats || state.do_priority || state.eval_trace != nullptr;
   state.need_single_thread_pass = false;
+  state.ready_heap = nullptr;
+  if (state.eval_trace != nullptr) {
+    state.eval_trace->begin_graph_evaluation(graph->ctime);
+  }
   /* Prepare all nodes for evaluation. */
   initialize_execution(&state, graph);
 
@@ -394,8 +509,19 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   /* After that, process all other nodes. */
   state.stage = EvaluationStage::THREADED_EVALUATION;
   task_pool = deg_evaluate_task_pool_create(&state);
-  schedule_graph(&state, schedule_node_to_pool, task_pool);
-  BLI_task_pool_work_and_wait(task_pool);
+  if (state.do_priority) {
+    state.ready_heap = BLI_heap_new();
+    BLI_spin_init(&state.ready_heap_lock);
+    schedule_graph(&state, schedule_node_to_priority_pool, task_pool);
+    BLI_task_pool_work_and_wait(task_pool);
+    BLI_spin_end(&state.ready_heap_lock);
+    BLI_heap_free(state.ready_heap, NULL);
+    state.ready_heap = nullptr;
+  }
+  else {
+    schedule_graph(&state, schedule_node_to_pool, task_pool);
+    BLI_task_pool_work_and_wait(task_pool);
+  }
   BLI_task_pool_free(task_pool);
 
   if (state.need_single_thread_pass) {
@@ -413,6 +539,10 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   deg_graph_clear_tags(graph);
   graph->is_evaluating = false;
 
+  if (state.eval_trace != nullptr) {
+    state.eval_trace->end_graph_evaluation();
+  }
+
   graph->debug.end_graph_evaluation();
 }
 
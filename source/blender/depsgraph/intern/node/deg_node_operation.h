@@ -273,6 +273,14 @@ struct OperationNode : public Node {
   /* (OperationFlag) extra settings affecting evaluation. */
   int flag;
 
+  /* Time the last evaluation of this operation took, in seconds.
+   * Only measured when priority scheduling or time statistics are enabled. */
+  double eval_cost;
+
+  /* Largest sum of evaluation costs along a path from this operation to the end of the graph,
+   * operations on the critical path are scheduled first. */
+  double critical_path_cost;
+
   DEG_DEPSNODE_DECLARE;
 };
 
@@ -0,0 +1,107 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_anim_types.h"
+#include "DNA_armature_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+
+#include "BKE_anim_data.h"
+#include "BKE_armature.h"
+#include "BKE_collection.h"
+#include "BKE_fcurve.h"
+#include "BKE_fcurve_driver.h"
+#include "BKE_idtype.h"
+#include "BKE_layer.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "RNA_define.h"
+
+#include "PIL_time.h"
+
+#define NUM_BONES 2000
+#define NUM_RUN_AVERAGED 10
+
+/* Chain of bones where every bone has its location driven by the previous one, similar to a
+ * character rig with lots of drivers. */
+static AnimData *rig_create(Main *bmain, Scene *scene)
+{
+  bArmature *armature = BKE_armature_add(bmain, "Armature");
+  for (int i = 0; i < NUM_BONES; i++) {
+    Bone *bone = (Bone *)MEM_callocN(sizeof(Bone), __func__);
+    BLI_snprintf(bone->name, sizeof(bone->name), "Bone.%d", i);
+    bone->tail[1] = 1.0f;
+    bone->length = 1.0f;
+    bone->segments = 1;
+    BLI_addtail(&armature->bonebase, bone);
+  }
+  Object *rig = BKE_object_add_only_object(bmain, OB_ARMATURE, "Rig");
+  rig->data = armature;
+  BKE_pose_rebuild(bmain, rig, armature, true);
+  BKE_collection_object_add(bmain, scene->master_collection, rig);
+
+  AnimData *adt = BKE_animdata_add_id(&rig->id);
+  for (int i = 1; i < NUM_BONES; i++) {
+    FCurve *fcu = BKE_fcurve_create();
+    fcu->rna_path = BLI_sprintfN("pose.bones[\"Bone.%d\"].location", i);
+    BLI_addtail(&adt->drivers, fcu);
+    fcu->driver = (ChannelDriver *)MEM_callocN(sizeof(ChannelDriver), __func__);
+    fcu->driver->type = DRIVER_TYPE_AVERAGE;
+    DriverVar *dvar = driver_add_new_variable(fcu->driver);
+    dvar->targets[0].id = &rig->id;
+    dvar->targets[0].rna_path = BLI_sprintfN("pose.bones[\"Bone.%d\"].location[0]", i - 1);
+  }
+  return adt;
+}
+
+TEST(deg_builder_cache, DriverRigRebuild)
+{
+  BKE_idtype_init();
+  RNA_init();
+  DEG_register_node_types();
+
+  Main *bmain = BKE_main_new();
+  Scene *scene = BKE_scene_add(bmain, "Scene");
+  AnimData *adt = rig_create(bmain, scene);
+
+  double start_time = PIL_check_seconds_timer();
+  Depsgraph *depsgraph = DEG_graph_new(
+      bmain, scene, BKE_view_layer_default_view(scene), DAG_EVAL_VIEWPORT);
+  DEG_graph_build_from_view_layer(depsgraph);
+  const double build_time = PIL_check_seconds_timer() - start_time;
+
+  start_time = PIL_check_seconds_timer();
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    DEG_graph_tag_relations_update(depsgraph);
+    DEG_graph_relations_update(depsgraph);
+  }
+  const double rebuild_time = (PIL_check_seconds_timer() - start_time) / NUM_RUN_AVERAGED;
+
+  /* Change one driver, the cached data of the rig is initialized again. */
+  ((FCurve *)adt->drivers.last)->array_index = 1;
+  start_time = PIL_check_seconds_timer();
+  DEG_graph_tag_relations_update(depsgraph);
+  DEG_graph_relations_update(depsgraph);
+  const double changed_rebuild_time = PIL_check_seconds_timer() - start_time;
+
+  printf("Rig with %d bones and drivers:\n", NUM_BONES);
+  printf("\tInitial build: %fs\n", build_time);
+  printf("\tRebuild (unchanged): %fs on average over %d runs\n", rebuild_time, NUM_RUN_AVERAGED);
+  printf("\tRebuild (changed driver): %fs\n", changed_rebuild_time);
+
+  DEG_graph_free(depsgraph);
+  BKE_main_free(bmain);
+  DEG_free_node_types();
+  RNA_exit();
+}
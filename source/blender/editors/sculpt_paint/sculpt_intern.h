@@ -612,6 +612,9 @@ typedef struct SculptUndoNode {
   /* Sculpt Face Sets */
   int *face_sets;
 
+  /* Arrays of the node compressed while the undo step is not in use, see sculpt_undo.c. */
+  struct SculptUndoCompressedArray *compressed;
+
   size_t undo_size;
 } SculptUndoNode;
 
@@ -1079,6 +1082,16 @@ void SCULPT_undo_push_begin(const char *name);
 void SCULPT_undo_push_end(void);
 void SCULPT_undo_push_end_ex(const bool use_nested_undo);
 
+/* Encoding of undo node arrays of 4 byte values before compression. */
+void SCULPT_undo_array_encode(const unsigned char *raw,
+                              const size_t num_values,
+                              const int stride,
+                              unsigned char *r_encoded);
+void SCULPT_undo_array_decode(const unsigned char *encoded,
+                              const size_t num_values,
+                              const int stride,
+                              unsigned char *r_raw);
+
 void SCULPT_vertcos_to_key(Object *ob, KeyBlock *kb, const float (*vertCos)[3]);
 
 void SCULPT_update_object_bounding_box(struct Object *ob);
@@ -26,9 +26,11 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_fileops.h"
 #include "BLI_ghash.h"
 #include "BLI_listbase.h"
 #include "BLI_math.h"
+#include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_task.h"
 #include "BLI_threads.h"
@@ -40,6 +42,7 @@
 #include "DNA_scene_types.h"
 #include "DNA_screen_types.h"
 
+#include "BKE_appdir.h"
 #include "BKE_ccg.h"
 #include "BKE_context.h"
 #include "BKE_customdata.h"
@@ -70,6 +73,15 @@
 #include "bmesh.h"
 #include "sculpt_intern.h"
 
+#ifdef WITH_LZO
+#  ifdef WITH_SYSTEM_LZO
+#    include <lzo/lzo1x.h>
+#  else
+#    include "minilzo.h"
+#  endif
+#  define LZO_OUT_LEN(size) ((size) + (size) / 16 + 64 + 3)
+#endif
+
 /* Implementation of undo system for objects in sculpt mode.
  *
  * Each undo step in sculpt mode consists of list of nodes, each node contains:
@@ -89,6 +101,17 @@
  * The COORDS, HIDDEN or MASK type of nodes contains arrays of the corresponding
  * values.
  *
+ * Once a step is pushed, these arrays are only needed again when the step is
+ * undone or redone, so they are compressed in a background task pool. Values are
+ * XOR'ed with the same component of the previous vertex of the node, bytes of the
+ * same significance are grouped together and the result is LZO compressed. The
+ * arrays are decompressed in parallel right before the step is restored, and
+ * compressed again afterwards.
+ *
+ * When the sculpt steps use more than #SCULPT_UNDO_MEMORY_BUDGET, the compressed
+ * arrays of the oldest steps are written to a file in the temporary directory of
+ * the session, and read back before the step is decompressed.
+ *
  * Operations like Symmetrize are using GEOMETRY type of nodes which pushes the
  * entire state of the mesh to the undo stack. This node contains all CustomData
  * layers.
@@ -113,9 +136,18 @@ typedef struct UndoSculpt {
   ListBase nodes;
 
   size_t undo_size;
+
+  /* Compression of the node arrays which runs in background, see #sculpt_undo_compress_begin.
+   * NULL when there is no compression in progress. */
+  TaskPool *compress_pool;
+  /* Node arrays are compressed or being compressed, and must be decompressed before use. */
+  bool is_compressed;
+  /* File holding the compressed node arrays, NULL when they are in memory. */
+  char *spill_filepath;
 } UndoSculpt;
 
 static UndoSculpt *sculpt_undo_get_nodes(void);
+static void sculpt_undosys_compress_finish_all(UndoStack *ustack);
 
 static void update_cb(PBVHNode *node, void *rebuild)
 {
@@ -823,11 +855,368 @@ static void sculpt_undo_restore_list(bContext *C, Depsgraph *depsgraph, ListBase
   MEM_SAFE_FREE(undo_modified_grids);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Compression
+ * \{ */
+
+/* Number of node arrays which are compressed, see #sculpt_undo_node_array_get. */
+#define SCULPT_UNDO_COMPRESSED_ARRAYS_NUM 6
+
+/* Memory the newest sculpt steps may use before older steps are written to disk. */
+#define SCULPT_UNDO_MEMORY_BUDGET ((size_t)512 * 1024 * 1024)
+
+typedef struct SculptUndoCompressedArray {
+  /* LZO compressed data, or the encoded data as is when it did not compress.
+   * NULL while the step is written to disk, see #sculpt_undo_spill. */
+  void *data;
+  size_t size;
+  size_t size_raw;
+} SculptUndoCompressedArray;
+
+/* Get node array by its index and number of 4 byte values per vertex. */
+static void **sculpt_undo_node_array_get(SculptUndoNode *unode,
+                                         const int array_index,
+                                         int *r_stride)
+{
+  switch (array_index) {
+    case 0:
+      *r_stride = 3;
+      return (void **)&unode->co;
+    case 1:
+      *r_stride = 3;
+      return (void **)&unode->orig_co;
+    case 2:
+      *r_stride = 4;
+      return (void **)&unode->col;
+    case 3:
+      *r_stride = 1;
+      return (void **)&unode->mask;
+    case 4:
+      *r_stride = 1;
+      return (void **)&unode->index;
+    case 5:
+      *r_stride = 1;
+      return (void **)&unode->face_sets;
+  }
+  BLI_assert(0);
+  return NULL;
+}
+
+/* XOR every 4 byte value with the same component of the previous vertex and group bytes of the
+ * same significance together. Neighboring vertices of a node have close values, so this gives
+ * long runs of equal bytes to the compressor. */
+void SCULPT_undo_array_encode(const unsigned char *raw,
+                              const size_t num_values,
+                              const int stride,
+                              unsigned char *r_encoded)
+{
+  for (size_t i = 0; i < num_values; i++) {
+    for (int b = 0; b < 4; b++) {
+      unsigned char value = raw[i * 4 + b];
+      if (i >= (size_t)stride) {
+        value ^= raw[(i - stride) * 4 + b];
+      }
+      r_encoded[b * num_values + i] = value;
+    }
+  }
+}
+
+/* Inverse of #SCULPT_undo_array_encode. */
+void SCULPT_undo_array_decode(const unsigned char *encoded,
+                              const size_t num_values,
+                              const int stride,
+                              unsigned char *r_raw)
+{
+  for (size_t i = 0; i < num_values; i++) {
+    for (int b = 0; b < 4; b++) {
+      unsigned char value = encoded[b * num_values + i];
+      if (i >= (size_t)stride) {
+        value ^= r_raw[(i - stride) * 4 + b];
+      }
+      r_raw[i * 4 + b] = value;
+    }
+  }
+}
+
+#ifdef WITH_LZO
+static void sculpt_undo_node_compress_task_run(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  SculptUndoNode *unode = taskdata;
+  void *wrkmem = NULL;
+
+  for (int i = 0; i < SCULPT_UNDO_COMPRESSED_ARRAYS_NUM; i++) {
+    int stride;
+    void **array_p = sculpt_undo_node_array_get(unode, i, &stride);
+    if (*array_p == NULL) {
+      continue;
+    }
+    const size_t size_raw = MEM_allocN_len(*array_p);
+    if (size_raw == 0) {
+      continue;
+    }
+    BLI_assert(size_raw % 4 == 0);
+
+    if (unode->compressed == NULL) {
+      unode->compressed = MEM_callocN(
+          sizeof(SculptUndoCompressedArray) * SCULPT_UNDO_COMPRESSED_ARRAYS_NUM, __func__);
+      wrkmem = MEM_mallocN(LZO1X_MEM_COMPRESS, "SculptUndoNode wrkmem");
+    }
+    SculptUndoCompressedArray *carray = &unode->compressed[i];
+    carray->size_raw = size_raw;
+
+    unsigned char *encoded = MEM_mallocN(size_raw, "SculptUndoNode encoded");
+    SCULPT_undo_array_encode(*array_p, size_raw / 4, stride, encoded);
+    MEM_freeN(*array_p);
+    *array_p = NULL;
+
+    lzo_uint out_len = LZO_OUT_LEN(size_raw);
+    unsigned char *out = MEM_mallocN(out_len, "SculptUndoNode compressed");
+    int r = lzo1x_1_compress(encoded, (lzo_uint)size_raw, out, &out_len, wrkmem);
+    if (r == LZO_E_OK && out_len < size_raw) {
+      MEM_freeN(encoded);
+      carray->data = MEM_reallocN(out, out_len);
+      carray->size = out_len;
+    }
+    else {
+      /* Store incompressible data as is. */
+      MEM_freeN(out);
+      carray->data = encoded;
+      carray->size = size_raw;
+    }
+  }
+
+  if (wrkmem != NULL) {
+    MEM_freeN(wrkmem);
+  }
+}
+#endif
+
+static void sculpt_undo_node_decompress_cb(void *__restrict UNUSED(userdata),
+                                           void *item,
+                                           int UNUSED(index),
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SculptUndoNode *unode = item;
+  if (unode->compressed == NULL) {
+    return;
+  }
+
+  for (int i = 0; i < SCULPT_UNDO_COMPRESSED_ARRAYS_NUM; i++) {
+    SculptUndoCompressedArray *carray = &unode->compressed[i];
+    if (carray->data == NULL) {
+      continue;
+    }
+    int stride;
+    void **array_p = sculpt_undo_node_array_get(unode, i, &stride);
+
+    unsigned char *encoded = carray->data;
+    if (carray->size != carray->size_raw) {
+      encoded = MEM_mallocN(carray->size_raw, "SculptUndoNode encoded");
+#ifdef WITH_LZO
+      lzo_uint r_len = carray->size_raw;
+      int r = lzo1x_decompress_safe(carray->data, (lzo_uint)carray->size, encoded, &r_len, NULL);
+      BLI_assert(r == LZO_E_OK && r_len == carray->size_raw);
+      UNUSED_VARS_NDEBUG(r);
+#endif
+      MEM_freeN(carray->data);
+    }
+
+    *array_p = MEM_mallocN(carray->size_raw, "SculptUndoNode array");
+    SCULPT_undo_array_decode(encoded, carray->size_raw / 4, stride, *array_p);
+    MEM_freeN(encoded);
+  }
+
+  MEM_freeN(unode->compressed);
+  unode->compressed = NULL;
+}
+
+/* Start compressing node arrays in background, they are not used until the step is restored. */
+static void sculpt_undo_compress_begin(UndoSculpt *usculpt)
+{
+#ifdef WITH_LZO
+  BLI_assert(usculpt->compress_pool == NULL && !usculpt->is_compressed);
+  usculpt->compress_pool = BLI_task_pool_create_background(usculpt, TASK_PRIORITY_LOW);
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt->nodes) {
+    BLI_task_pool_push(
+        usculpt->compress_pool, sculpt_undo_node_compress_task_run, unode, false, NULL);
+  }
+  usculpt->is_compressed = true;
+#else
+  UNUSED_VARS(usculpt);
+#endif
+}
+
+/* Wait for background compression to finish. */
+static void sculpt_undo_compress_wait(UndoSculpt *usculpt)
+{
+  if (usculpt->compress_pool != NULL) {
+    BLI_task_pool_work_and_wait(usculpt->compress_pool);
+    BLI_task_pool_free(usculpt->compress_pool);
+    usculpt->compress_pool = NULL;
+  }
+}
+
+static void sculpt_undo_unspill(UndoSculpt *usculpt);
+
+/* Make node arrays available for reading and writing. */
+static void sculpt_undo_decompress(UndoSculpt *usculpt)
+{
+  sculpt_undo_compress_wait(usculpt);
+  if (!usculpt->is_compressed) {
+    return;
+  }
+  sculpt_undo_unspill(usculpt);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_listbase(&usculpt->nodes, NULL, sculpt_undo_node_decompress_cb, &settings);
+  usculpt->is_compressed = false;
+}
+
+/* Memory used by the step, with compressed arrays taking their compressed size, or nothing
+ * when they are on disk. */
+static size_t sculpt_undo_data_size(const UndoSculpt *usculpt)
+{
+  BLI_assert(usculpt->compress_pool == NULL);
+  size_t size_raw = 0, size = 0;
+  LISTBASE_FOREACH (const SculptUndoNode *, unode, &usculpt->nodes) {
+    if (unode->compressed == NULL) {
+      continue;
+    }
+    for (int i = 0; i < SCULPT_UNDO_COMPRESSED_ARRAYS_NUM; i++) {
+      size_raw += unode->compressed[i].size_raw;
+      if (unode->compressed[i].data != NULL) {
+        size += unode->compressed[i].size;
+      }
+    }
+  }
+  return MAX2(usculpt->undo_size, size_raw) - size_raw + size;
+}
+
+static void sculpt_undo_node_compressed_free(SculptUndoNode *unode)
+{
+  if (unode->compressed == NULL) {
+    return;
+  }
+  for (int i = 0; i < SCULPT_UNDO_COMPRESSED_ARRAYS_NUM; i++) {
+    MEM_SAFE_FREE(unode->compressed[i].data);
+  }
+  MEM_freeN(unode->compressed);
+  unode->compressed = NULL;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Disk Storage
+ *
+ * Compressed node arrays of a step are written one after the other to a file of their own, in
+ * the order of the nodes. Reading the file back is a single sequential read, done right before
+ * the step is decompressed.
+ * \{ */
+
+/* Write the compressed node arrays of the step to disk and free them. The arrays stay in memory
+ * when the file can't be written. */
+static bool sculpt_undo_spill(UndoSculpt *usculpt)
+{
+  BLI_assert(usculpt->compress_pool == NULL && usculpt->is_compressed);
+  BLI_assert(usculpt->spill_filepath == NULL);
+  static int spill_index = 0;
+
+  char filename[FILE_MAXFILE], filepath[FILE_MAX];
+  BLI_snprintf(filename, sizeof(filename), "sculpt_undo_%d.bin", spill_index++);
+  BLI_join_dirfile(filepath, sizeof(filepath), BKE_tempdir_session(), filename);
+
+  FILE *file = BLI_fopen(filepath, "wb");
+  if (file == NULL) {
+    return false;
+  }
+  bool ok = true;
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt->nodes) {
+    if (unode->compressed == NULL) {
+      continue;
+    }
+    for (int i = 0; i < SCULPT_UNDO_COMPRESSED_ARRAYS_NUM && ok; i++) {
+      const SculptUndoCompressedArray *carray = &unode->compressed[i];
+      if (carray->data != NULL) {
+        ok = fwrite(carray->data, 1, carray->size, file) == carray->size;
+      }
+    }
+  }
+  if (fclose(file) != 0) {
+    ok = false;
+  }
+  if (!ok) {
+    BLI_delete(filepath, false, false);
+    return false;
+  }
+
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt->nodes) {
+    if (unode->compressed == NULL) {
+      continue;
+    }
+    for (int i = 0; i < SCULPT_UNDO_COMPRESSED_ARRAYS_NUM; i++) {
+      MEM_SAFE_FREE(unode->compressed[i].data);
+    }
+  }
+  usculpt->spill_filepath = BLI_strdup(filepath);
+  return true;
+}
+
+static void sculpt_undo_spill_free(UndoSculpt *usculpt)
+{
+  if (usculpt->spill_filepath == NULL) {
+    return;
+  }
+  BLI_delete(usculpt->spill_filepath, false, false);
+  MEM_freeN(usculpt->spill_filepath);
+  usculpt->spill_filepath = NULL;
+}
+
+/* Read the compressed node arrays back from disk. */
+static void sculpt_undo_unspill(UndoSculpt *usculpt)
+{
+  if (usculpt->spill_filepath == NULL) {
+    return;
+  }
+
+  FILE *file = BLI_fopen(usculpt->spill_filepath, "rb");
+  if (file == NULL) {
+    printf("%s: can't open '%s'\n", __func__, usculpt->spill_filepath);
+  }
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt->nodes) {
+    if (unode->compressed == NULL) {
+      continue;
+    }
+    for (int i = 0; i < SCULPT_UNDO_COMPRESSED_ARRAYS_NUM; i++) {
+      SculptUndoCompressedArray *carray = &unode->compressed[i];
+      if (carray->size_raw == 0) {
+        continue;
+      }
+      carray->data = MEM_mallocN(carray->size, "SculptUndoNode compressed");
+      if (file == NULL || fread(carray->data, 1, carray->size, file) != carray->size) {
+        /* Restore zeros rather than reading garbage, stored as is so they decode to zeros. */
+        MEM_freeN(carray->data);
+        carray->data = MEM_callocN(carray->size_raw, "SculptUndoNode compressed");
+        carray->size = carray->size_raw;
+      }
+    }
+  }
+  if (file != NULL) {
+    fclose(file);
+  }
+
+  sculpt_undo_spill_free(usculpt);
+}
+
+/** \} */
+
 static void sculpt_undo_free_list(ListBase *lb)
 {
   SculptUndoNode *unode = lb->first;
   while (unode != NULL) {
     SculptUndoNode *unode_next = unode->next;
+    sculpt_undo_node_compressed_free(unode);
     if (unode->co) {
       MEM_freeN(unode->co);
     }
@@ -1366,6 +1755,9 @@ void SCULPT_undo_push_end_ex(const bool use_nested_undo)
   wmWindowManager *wm = G_MAIN->wm.first;
   if (wm->op_undo_depth == 0 || use_nested_undo) {
     UndoStack *ustack = ED_undo_stack_get();
+    /* Steps which were compressed during the stroke are limited by their compressed size, the
+     * oldest ones are written to disk. */
+    sculpt_undosys_compress_finish_all(ustack);
     BKE_undosys_step_push(ustack, NULL, NULL);
     if (wm->op_undo_depth == 0) {
       BKE_undosys_stack_limit_steps_and_memory_defaults(ustack);
@@ -1399,6 +1791,7 @@ static bool sculpt_undosys_step_encode(struct bContext *UNUSED(C),
    * to the current 'SculptUndoStep' added by encode_init. */
   SculptUndoStep *us = (SculptUndoStep *)us_p;
   us->step.data_size = us->data.undo_size;
+  sculpt_undo_compress_begin(&us->data);
 
   SculptUndoNode *unode = us->data.nodes.last;
   if (unode && unode->type == SCULPT_UNDO_DYNTOPO_END) {
@@ -1418,7 +1811,9 @@ static void sculpt_undosys_step_decode_undo_impl(struct bContext *C,
                                                  SculptUndoStep *us)
 {
   BLI_assert(us->step.is_applied == true);
+  sculpt_undo_decompress(&us->data);
   sculpt_undo_restore_list(C, depsgraph, &us->data.nodes);
+  sculpt_undo_compress_begin(&us->data);
   us->step.is_applied = false;
 }
 
@@ -1427,7 +1822,9 @@ static void sculpt_undosys_step_decode_redo_impl(struct bContext *C,
                                                  SculptUndoStep *us)
 {
   BLI_assert(us->step.is_applied == false);
+  sculpt_undo_decompress(&us->data);
   sculpt_undo_restore_list(C, depsgraph, &us->data.nodes);
+  sculpt_undo_compress_begin(&us->data);
   us->step.is_applied = true;
 }
 
@@ -1516,7 +1913,44 @@ static void sculpt_undosys_step_decode(
 static void sculpt_undosys_step_free(UndoStep *us_p)
 {
   SculptUndoStep *us = (SculptUndoStep *)us_p;
+  sculpt_undo_compress_wait(&us->data);
   sculpt_undo_free_list(&us->data.nodes);
+  sculpt_undo_spill_free(&us->data);
+}
+
+static void sculpt_undosys_compress_finish_all(UndoStack *ustack)
+{
+  LISTBASE_FOREACH (UndoStep *, us_p, &ustack->steps) {
+    if (us_p->type != BKE_UNDOSYS_TYPE_SCULPT) {
+      continue;
+    }
+    SculptUndoStep *us = (SculptUndoStep *)us_p;
+    if (us->data.compress_pool != NULL) {
+      sculpt_undo_compress_wait(&us->data);
+      us->step.data_size = sculpt_undo_data_size(&us->data);
+    }
+    else if (!us->data.is_compressed) {
+      /* Decompressed by #sculpt_undo_get_nodes, its size is accounted for when it's done. */
+      sculpt_undo_compress_begin(&us->data);
+    }
+  }
+
+  /* Keep the newest steps in memory up to the budget, older ones go to disk. */
+  size_t data_size_all = 0;
+  LISTBASE_FOREACH_BACKWARD (UndoStep *, us_p, &ustack->steps) {
+    if (us_p->type != BKE_UNDOSYS_TYPE_SCULPT) {
+      continue;
+    }
+    SculptUndoStep *us = (SculptUndoStep *)us_p;
+    data_size_all += us->step.data_size;
+    if (data_size_all <= SCULPT_UNDO_MEMORY_BUDGET || us->data.compress_pool != NULL ||
+        !us->data.is_compressed || us->data.spill_filepath != NULL) {
+      continue;
+    }
+    if (sculpt_undo_spill(&us->data)) {
+      us->step.data_size = sculpt_undo_data_size(&us->data);
+    }
+  }
 }
 
 void ED_sculpt_undo_geometry_begin(struct Object *ob, const char *name)
@@ -1561,7 +1995,18 @@ static UndoSculpt *sculpt_undo_get_nodes(void)
 {
   UndoStack *ustack = ED_undo_stack_get();
   UndoStep *us = BKE_undosys_stack_init_or_active_with_type(ustack, BKE_UNDOSYS_TYPE_SCULPT);
-  return sculpt_undosys_step_get_nodes(us);
+  UndoSculpt *usculpt = sculpt_undosys_step_get_nodes(us);
+  if (us != NULL && (usculpt->is_compressed || usculpt->compress_pool != NULL)) {
+    /* Only reached when nodes are requested while no step is being pushed, the step being pushed
+     * is never compressed. The callers in sculpt mode (#SCULPT_undo_push_node and the other
+     * push functions, #SCULPT_undo_get_node from original coordinate ray-casts and
+     * #SCULPT_undo_get_first_node from restoring anchored strokes) all run between
+     * #SCULPT_undo_push_begin and #SCULPT_undo_push_end, so this is a fallback. The nodes stay
+     * decompressed until the next push, which compresses them again. */
+    sculpt_undo_decompress(usculpt);
+    us->data_size = usculpt->undo_size;
+  }
+  return usculpt;
 }
 
 /** \} */
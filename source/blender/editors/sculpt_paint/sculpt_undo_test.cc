@@ -0,0 +1,98 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <string.h>
+
+#include "BLI_array.hh"
+#include "BLI_rand.h"
+
+/* Declared in sculpt_intern.h, which can't be included from C++. */
+extern "C" {
+void SCULPT_undo_array_encode(const unsigned char *raw,
+                              const size_t num_values,
+                              const int stride,
+                              unsigned char *r_encoded);
+void SCULPT_undo_array_decode(const unsigned char *encoded,
+                              const size_t num_values,
+                              const int stride,
+                              unsigned char *r_raw);
+}
+
+/* Encode and decode an array of 4 byte values, the result must match the input. */
+static void test_array_round_trip(const int num_values, const int stride, const bool is_smooth)
+{
+  blender::Array<unsigned char> raw(num_values * 4);
+  blender::Array<unsigned char> encoded(num_values * 4);
+  blender::Array<unsigned char> decoded(num_values * 4);
+
+  RNG *rng = BLI_rng_new(num_values * 4 + stride);
+  for (int i = 0; i < num_values; i++) {
+    if (is_smooth) {
+      /* Close values like neighboring vertex coordinates. */
+      const float value = 1.0f + i * 0.001f;
+      memcpy(&raw[i * 4], &value, sizeof(value));
+    }
+    else {
+      for (int b = 0; b < 4; b++) {
+        raw[i * 4 + b] = (unsigned char)BLI_rng_get_uint(rng);
+      }
+    }
+  }
+  BLI_rng_free(rng);
+
+  SCULPT_undo_array_encode(raw.data(), num_values, stride, encoded.data());
+  SCULPT_undo_array_decode(encoded.data(), num_values, stride, decoded.data());
+  EXPECT_EQ(memcmp(raw.data(), decoded.data(), raw.size()), 0)
+      << num_values << " values with stride " << stride;
+}
+
+TEST(sculpt_undo, ArrayEncodeRoundTrip)
+{
+  const int strides[] = {1, 3, 4};
+  /* Includes arrays shorter than the stride and arrays which are no multiple of it. */
+  const int sizes[] = {1, 2, 3, 4, 5, 7, 64, 1000};
+  for (const int stride : strides) {
+    for (const int num_values : sizes) {
+      test_array_round_trip(num_values, stride, false);
+      test_array_round_trip(num_values, stride, true);
+    }
+  }
+}
+
+TEST(sculpt_undo, ArrayEncodeGroupsBytes)
+{
+  /* Equal vertices XOR to zero, only the first vertex remains. */
+  const int stride = 3;
+  const int num_values = stride * 4;
+  const float co[3] = {1.0f, -2.0f, 0.5f};
+  float raw[num_values];
+  for (int i = 0; i < num_values; i++) {
+    raw[i] = co[i % stride];
+  }
+
+  unsigned char encoded[num_values * 4];
+  SCULPT_undo_array_encode((const unsigned char *)raw, num_values, stride, encoded);
+
+  for (int b = 0; b < 4; b++) {
+    for (int i = 0; i < num_values; i++) {
+      const unsigned char expected = (i < stride) ? ((const unsigned char *)&co[i])[b] : 0;
+      EXPECT_EQ(encoded[b * num_values + i], expected);
+    }
+  }
+}
@@ -78,6 +78,8 @@
 
 #include "BLF_api.h"
 
+#include "BLT_translation.h"
+
 #include "MEM_guardedalloc.h"
 
 /* Own include. */
@@ -1455,6 +1457,34 @@ void sequencer_draw_maskedit(const bContext *C, Scene *scene, ARegion *region, S
 }
 #endif
 
+/* Frame rate sustained by prefetch, drawn like the playback frame rate. */
+void sequencer_draw_prefetch_fps(Scene *scene, int xoffset, int *yoffset)
+{
+  const float fps = BKE_sequencer_prefetch_fps_get(scene);
+  if (fps == 0.0f) {
+    return;
+  }
+
+  char printable[32];
+  BLI_snprintf(printable, sizeof(printable), IFACE_("prefetch fps: %.2f"), fps);
+
+  const int font_id = BLF_default();
+  UI_FontThemeColor(font_id, TH_TEXT_HI);
+  BLF_enable(font_id, BLF_SHADOW);
+  BLF_shadow(font_id, 5, (const float[4]){0.0f, 0.0f, 0.0f, 1.0f});
+  BLF_shadow_offset(font_id, 1, -1);
+
+  *yoffset -= (int)(1.1f * BLF_default_height_max());
+
+#ifdef WITH_INTERNATIONAL
+  BLF_draw_default(xoffset, *yoffset, 0.0f, printable, sizeof(printable));
+#else
+  BLF_draw_default_ascii(xoffset, *yoffset, 0.0f, printable, sizeof(printable));
+#endif
+
+  BLF_disable(font_id, BLF_SHADOW);
+}
+
 /* Force redraw, when prefetching and using cache view. */
 static void seq_prefetch_wm_notify(const bContext *C, Scene *scene)
 {
@@ -52,6 +52,7 @@ void sequencer_draw_preview(const struct bContext *C,
                             bool draw_overlay,
                             bool draw_backdrop);
 void color3ubv_from_seq(struct Scene *curscene, struct Sequence *seq, unsigned char col[3]);
+void sequencer_draw_prefetch_fps(struct Scene *scene, int xoffset, int *yoffset);
 
 void sequencer_special_update_set(Sequence *seq);
 float sequence_handle_size_get_clamped(struct Sequence *seq, const float pixelx);
@@ -740,6 +740,12 @@ static void sequencer_preview_region_draw(const bContext *C, ARegion *region)
     int yoffset = rect->ymax;
     ED_scene_draw_fps(scene, xoffset, &yoffset);
   }
+  else if ((U.uiflag & USER_SHOW_FPS) && BKE_sequencer_prefetch_job_is_running(scene)) {
+    const rcti *rect = ED_region_visible_rect(region);
+    int xoffset = rect->xmin + U.widget_unit;
+    int yoffset = rect->ymax;
+    sequencer_draw_prefetch_fps(scene, xoffset, &yoffset);
+  }
 }
 
 static void sequencer_preview_region_listener(wmWindow *UNUSED(win),
@@ -20,6 +20,8 @@
  * Wrapper between 'ED_undo.h' and 'BKE_undo_system.h' API's.
  */
 
+#include "CLG_log.h"
+
 #include "BLI_sys_types.h"
 #include "BLI_utildefines.h"
 
@@ -52,6 +54,8 @@
 
 #include "undo_intern.h"
 
+static CLG_LogRef LOG = {"ed.undo.memfile"};
+
 /* -------------------------------------------------------------------- */
 /** \name Implements ED Undo System
  * \{ */
@@ -96,6 +100,17 @@ static bool memfile_undosys_step_encode(struct bContext *UNUSED(C),
   us->data = BKE_memfile_undo_encode(bmain, us_prev ? us_prev->data : NULL);
   us->step.data_size = us->data->undo_size;
 
+  if (CLOG_CHECK(&LOG, 1)) {
+    const MemFile *memfile = &us->data->memfile;
+    CLOG_INFO(&LOG,
+              1,
+              "step size: %zu new, %zu de-duplicated, %zu total; all steps: %zu",
+              memfile->size,
+              memfile->size_deduplicated,
+              memfile->size_total,
+              BLO_memfile_storage_size());
+  }
+
   /* Store the fact that we should not re-use old data with that undo step, and reset the Main
    * flag. */
   us->step.use_old_bmain_data = !bmain->use_memfile_full_barrier;
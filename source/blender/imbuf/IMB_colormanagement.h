@@ -297,6 +297,13 @@ void IMB_partial_display_buffer_update_delayed(
 struct ColormanageProcessor *IMB_colormanagement_display_processor_new(
     const struct ColorManagedViewSettings *view_settings,
     const struct ColorManagedDisplaySettings *display_settings);
+/* Same as IMB_colormanagement_display_processor_new, but buffers are transformed with a baked
+ * lookup table when the transform allows it. Faster, but only accurate enough for display. */
+struct ColormanageProcessor *IMB_colormanagement_display_processor_new_baked(
+    const struct ColorManagedViewSettings *view_settings,
+    const struct ColorManagedDisplaySettings *display_settings);
+/* False when the transform couldn't be baked, buffers are transformed with OCIO then. */
+bool IMB_colormanagement_processor_is_baked(const struct ColormanageProcessor *cm_processor);
 struct ColormanageProcessor *IMB_colormanagement_colorspace_processor_new(
     const char *from_colorspace, const char *to_colorspace);
 void IMB_colormanagement_processor_apply_v4(struct ColormanageProcessor *cm_processor,
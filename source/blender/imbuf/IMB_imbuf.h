@@ -383,6 +383,14 @@ int ismovie(const char *filepath);
 void IMB_anim_set_preseek(struct anim *anim, int preseek);
 int IMB_anim_get_preseek(struct anim *anim);
 
+/**
+ * Keep recently decoded frames and decode ahead while playing forward. Only use for movies that
+ * are played back, the memory of all frame rings is limited together.
+ */
+void IMB_anim_use_frame_ring(struct anim *anim);
+void IMB_anim_frame_ring_set_memory_limit(size_t limit);
+size_t IMB_anim_frame_ring_get_memory_limit(void);
+
 /**
  *
  * \attention Defined in anim_movie.c
@@ -450,6 +458,26 @@ struct ImBuf *IMB_onehalf(struct ImBuf *ibuf1);
  */
 bool IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy);
 
+typedef enum IMB_ScaleFilter {
+  /** Area of the source pixels, sharp when shrinking. */
+  IMB_SCALE_FILTER_BOX = 0,
+  IMB_SCALE_FILTER_BILINEAR = 1,
+  /** Bicubic with little ringing, good for enlarging. */
+  IMB_SCALE_FILTER_MITCHELL = 2,
+  /** Sharpest, may ring around high contrast edges. */
+  IMB_SCALE_FILTER_LANCZOS = 3,
+} IMB_ScaleFilter;
+
+/**
+ * Scale with a filter for both axes, a size of zero keeps the axis.
+ *
+ * \attention Defined in scaling.c
+ */
+bool IMB_scaleImBuf_filter(struct ImBuf *ibuf,
+                           unsigned int newx,
+                           unsigned int newy,
+                           IMB_ScaleFilter filter);
+
 /**
  *
  * \attention Defined in scaling.c
@@ -256,6 +256,8 @@ typedef struct ImBuf {
   struct MEM_CacheLimiterHandle_s *c_handle;
   /** reference counter for multiple users */
   int refcounter;
+  /** incremented when the pixels are changed in place, see BKE_image_mark_dirty */
+  int change_counter;
 
   /* some parameters to pass along for packing images */
   /** Compressed image only used with png and exr currently */
@@ -80,6 +80,7 @@
 
 #define MAXNUMSTREAMS 50
 
+struct FFmpegFrameRing;
 struct IDProperty;
 struct _AviMovie;
 struct anim_index;
@@ -136,6 +137,11 @@ struct anim {
   int64_t last_pts;
   int64_t next_pts;
   AVPacket next_packet;
+  /* Position of last_frame, frames fetched from the frame ring don't change it. */
+  int last_position;
+  struct FFmpegFrameRing *frame_ring;
+  /* Keep decoded frames and decode ahead, only for movies played back sequentially. */
+  int use_frame_ring;
 #endif
 
   char index_dir[768];
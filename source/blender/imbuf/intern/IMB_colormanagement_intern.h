@@ -126,6 +126,22 @@ void colorspace_set_default_role(char *colorspace, int size, int role);
 void colormanage_imbuf_set_default_spaces(struct ImBuf *ibuf);
 void colormanage_imbuf_make_linear(struct ImBuf *ibuf, const char *from_colorspace);
 
+/* ** Display transform lookup tables ** */
+
+typedef struct DisplayLUT DisplayLUT;
+
+/* Bake a display transform, NULL when it can't be baked accurately enough. */
+DisplayLUT *colormanage_display_lut_create(struct OCIO_ConstProcessorRcPtr *processor);
+void colormanage_display_lut_free(DisplayLUT *lut);
+/* Colors outside of the table are transformed by the processor the table was baked from. */
+void colormanage_display_lut_apply(const DisplayLUT *lut,
+                                   struct OCIO_ConstProcessorRcPtr *processor,
+                                   float *buffer,
+                                   int width,
+                                   int height,
+                                   int channels,
+                                   bool predivide);
+
 #ifdef __cplusplus
 }
 #endif
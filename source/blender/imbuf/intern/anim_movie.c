@@ -53,8 +53,11 @@
 #  include <io.h>
 #endif
 
+#include "BLI_math_base.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "MEM_guardedalloc.h"
@@ -505,6 +508,176 @@ BLI_INLINE bool need_aligned_ffmpeg_buffer(struct anim *anim)
   return (anim->x & 31) != 0;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Decoded Frame Ring
+ *
+ * Frames are kept in decoder format after decoding, so scrubbing and reverse playback within
+ * the recently decoded frames only need a color conversion instead of seeking back to a
+ * key-frame and decoding the whole GOP again.
+ *
+ * While playing forward, a background task decodes the frames after the requested one into the
+ * ring. The task and the fetching of frames never use the decoder at the same time, fetching
+ * cancels the task first.
+ * \{ */
+
+/* Memory used for decoded frames of all movies, until it's set from the cache limit. */
+#  define FFMPEG_FRAME_RING_MEMORY (256 * 1024 * 1024)
+#  define FFMPEG_FRAME_RING_MIN_FRAMES 16
+#  define FFMPEG_FRAME_RING_MAX_FRAMES 256
+/* Frames decoded in the background after the requested frame, when playing forward. */
+#  define FFMPEG_DECODE_AHEAD_FRAMES 8
+
+typedef struct FFmpegRingFrame {
+  AVFrame *frame;
+  int64_t pts;
+  /* PTS of the frame decoded after this one, AV_NOPTS_VALUE when not known. The frame is shown
+   * until that PTS. */
+  int64_t next_pts;
+} FFmpegRingFrame;
+
+typedef struct FFmpegFrameRing {
+  FFmpegRingFrame *frames;
+  int size;
+  /* Next slot to fill, the oldest frame is overwritten. */
+  int head;
+  /* Slot of the previously decoded frame, -1 after seeking. */
+  int prev;
+  /* Memory taken from the global budget of all rings. */
+  size_t memory;
+
+  TaskPool *decode_pool;
+  /* Last requested position. */
+  int position;
+} FFmpegFrameRing;
+
+/* Budget shared by the rings of all movies, rings take their memory from it when created. */
+static ThreadMutex frame_ring_memory_mutex = BLI_MUTEX_INITIALIZER;
+static size_t frame_ring_memory_limit = FFMPEG_FRAME_RING_MEMORY;
+static size_t frame_ring_memory_used = 0;
+
+static void ffmpeg_frame_ring_create(struct anim *anim)
+{
+  const size_t frame_size = max_ii(
+      avpicture_get_size(anim->pCodecCtx->pix_fmt, anim->x, anim->y), 1);
+
+  /* Take half of what is left of the budget so other movies get a ring too, but at least the
+   * minimum number of frames. Once the budget can't hold the minimum, take what is left. */
+  BLI_mutex_lock(&frame_ring_memory_mutex);
+  const size_t memory_free = (frame_ring_memory_limit > frame_ring_memory_used) ?
+                                 frame_ring_memory_limit - frame_ring_memory_used :
+                                 0;
+  int size = (int)min_zz(memory_free / frame_size, FFMPEG_FRAME_RING_MAX_FRAMES);
+  if (size > FFMPEG_FRAME_RING_MIN_FRAMES) {
+    size = max_ii(FFMPEG_FRAME_RING_MIN_FRAMES,
+                  (int)min_zz(memory_free / 2 / frame_size, FFMPEG_FRAME_RING_MAX_FRAMES));
+  }
+  /* A ring of one frame only repeats what last_frame holds already. */
+  if (size < 2) {
+    BLI_mutex_unlock(&frame_ring_memory_mutex);
+    return;
+  }
+  frame_ring_memory_used += frame_size * size;
+  BLI_mutex_unlock(&frame_ring_memory_mutex);
+
+  FFmpegFrameRing *ring = MEM_callocN(sizeof(FFmpegFrameRing), "ffmpeg frame ring");
+  ring->size = size;
+  ring->memory = frame_size * size;
+  ring->frames = MEM_callocN(sizeof(FFmpegRingFrame) * ring->size, "ffmpeg ring frames");
+  ring->prev = -1;
+  ring->decode_pool = BLI_task_pool_create_background(anim, TASK_PRIORITY_LOW);
+  ring->position = -1;
+
+  anim->frame_ring = ring;
+}
+
+static void ffmpeg_frame_ring_free(struct anim *anim)
+{
+  FFmpegFrameRing *ring = anim->frame_ring;
+  if (ring == NULL) {
+    return;
+  }
+
+  BLI_task_pool_free(ring->decode_pool);
+  for (int i = 0; i < ring->size; i++) {
+    av_frame_free(&ring->frames[i].frame);
+  }
+
+  BLI_mutex_lock(&frame_ring_memory_mutex);
+  frame_ring_memory_used -= ring->memory;
+  BLI_mutex_unlock(&frame_ring_memory_mutex);
+
+  MEM_freeN(ring->frames);
+  MEM_freeN(ring);
+  anim->frame_ring = NULL;
+}
+
+/* Add the frame that was just decoded into anim->pFrame. */
+static void ffmpeg_frame_ring_push(struct anim *anim)
+{
+  FFmpegFrameRing *ring = anim->frame_ring;
+  if (ring == NULL) {
+    return;
+  }
+
+  const int64_t pts = anim->next_pts;
+  if (ring->prev != -1) {
+    ring->frames[ring->prev].next_pts = pts;
+  }
+
+  /* Frames decoded again after seeking are already in the ring. */
+  for (int i = 0; i < ring->size; i++) {
+    if (ring->frames[i].frame && ring->frames[i].pts == pts) {
+      ring->prev = i;
+      return;
+    }
+  }
+
+  AVFrame *frame = av_frame_clone(anim->pFrame);
+  if (frame == NULL) {
+    ring->prev = -1;
+    return;
+  }
+
+  FFmpegRingFrame *ring_frame = &ring->frames[ring->head];
+  av_frame_free(&ring_frame->frame);
+  ring_frame->frame = frame;
+  ring_frame->pts = pts;
+  ring_frame->next_pts = AV_NOPTS_VALUE;
+
+  ring->prev = ring->head;
+  ring->head = (ring->head + 1) % ring->size;
+}
+
+/* Frames decoded after seeking don't follow the previously decoded frame. */
+static void ffmpeg_frame_ring_seek(struct anim *anim)
+{
+  if (anim->frame_ring) {
+    anim->frame_ring->prev = -1;
+  }
+}
+
+static const FFmpegRingFrame *ffmpeg_frame_ring_find(struct anim *anim, int64_t pts)
+{
+  FFmpegFrameRing *ring = anim->frame_ring;
+  if (ring == NULL) {
+    return NULL;
+  }
+
+  for (int i = 0; i < ring->size; i++) {
+    const FFmpegRingFrame *ring_frame = &ring->frames[i];
+    if (ring_frame->frame == NULL || ring_frame->pts > pts) {
+      continue;
+    }
+    if (ring_frame->pts == pts ||
+        (ring_frame->next_pts != AV_NOPTS_VALUE && pts < ring_frame->next_pts)) {
+      return ring_frame;
+    }
+  }
+  return NULL;
+}
+
+/** \} */
+
 static int startffmpeg(struct anim *anim)
 {
   int i, video_stream_index;
@@ -636,6 +809,7 @@ static int startffmpeg(struct anim *anim)
   anim->framesize = anim->x * anim->y * 4;
 
   anim->curposition = -1;
+  anim->last_position = -1;
   anim->last_frame = 0;
   anim->last_pts = -1;
   anim->next_pts = -1;
@@ -743,25 +917,23 @@ static int startffmpeg(struct anim *anim)
   }
 #  endif
 
+  if (anim->use_frame_ring) {
+    ffmpeg_frame_ring_create(anim);
+  }
+
   return 0;
 }
 
-/* postprocess the image in anim->pFrame and do color conversion
+/* postprocess the decoded image in input and do color conversion
  * and deinterlacing stuff.
  *
- * Output is anim->last_frame
+ * Output is ibuf
  */
 
-static void ffmpeg_postprocess(struct anim *anim)
+static void ffmpeg_postprocess(struct anim *anim, AVFrame *input, ImBuf *ibuf)
 {
-  AVFrame *input = anim->pFrame;
-  ImBuf *ibuf = anim->last_frame;
   int filter_y = 0;
 
-  if (!anim->pFrameComplete) {
-    return;
-  }
-
   /* This means the data wasn't read properly,
    * this check stops crashing */
   if (input->data[0] == 0 && input->data[1] == 0 && input->data[2] == 0 && input->data[3] == 0) {
@@ -773,7 +945,7 @@ static void ffmpeg_postprocess(struct anim *anim)
 
   av_log(anim->pFormatCtx,
          AV_LOG_DEBUG,
-         "  POSTPROC: anim->pFrame planes: %p %p %p %p\n",
+         "  POSTPROC: input planes: %p %p %p %p\n",
          input->data[0],
          input->data[1],
          input->data[2],
@@ -781,7 +953,7 @@ static void ffmpeg_postprocess(struct anim *anim)
 
   if (anim->ib_flags & IB_animdeinterlace) {
     if (avpicture_deinterlace((AVPicture *)anim->pFrameDeinterlaced,
-                              (const AVPicture *)anim->pFrame,
+                              (const AVPicture *)input,
                               anim->pCodecCtx->pix_fmt,
                               anim->pCodecCtx->width,
                               anim->pCodecCtx->height) < 0) {
@@ -908,6 +1080,7 @@ static int ffmpeg_decode_video_frame(struct anim *anim)
 
       if (anim->pFrameComplete) {
         anim->next_pts = av_get_pts_from_frame(anim->pFormatCtx, anim->pFrame);
+        ffmpeg_frame_ring_push(anim);
 
         av_log(anim->pFormatCtx,
                AV_LOG_DEBUG,
@@ -943,6 +1116,7 @@ static int ffmpeg_decode_video_frame(struct anim *anim)
 
     if (anim->pFrameComplete) {
       anim->next_pts = av_get_pts_from_frame(anim->pFormatCtx, anim->pFrame);
+      ffmpeg_frame_ring_push(anim);
 
       av_log(anim->pFormatCtx,
              AV_LOG_DEBUG,
@@ -1048,6 +1222,80 @@ static int ffmpeg_seek_by_byte(AVFormatContext *pFormatCtx)
   return false;
 }
 
+static ImBuf *ffmpeg_frame_ibuf_alloc(struct anim *anim)
+{
+  /* Certain versions of FFmpeg have a bug in libswscale which ends up in crash
+   * when destination buffer is not properly aligned. For example, this happens
+   * in FFmpeg 4.3.1. It got fixed later on, but for compatibility reasons is
+   * still best to avoid crash.
+   *
+   * This is achieved by using own allocation call rather than relying on
+   * IMB_allocImBuf() to do so since the IMB_allocImBuf() is not guaranteed
+   * to perform aligned allocation.
+   *
+   * In theory this could give better performance, since SIMD operations on
+   * aligned data are usually faster.
+   *
+   * Note that even though sometimes vertical flip is required it does not
+   * affect on alignment of data passed to sws_scale because if the X dimension
+   * is not 32 byte aligned special intermediate buffer is allocated.
+   *
+   * The issue was reported to FFmpeg under ticket #8747 in the FFmpeg tracker
+   * and is fixed in the newer versions than 4.3.1. */
+  ImBuf *ibuf = IMB_allocImBuf(anim->x, anim->y, 32, 0);
+  ibuf->rect = MEM_mallocN_aligned((size_t)4 * anim->x * anim->y, 32, "ffmpeg ibuf");
+  ibuf->mall |= IB_rect;
+
+  ibuf->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
+
+  return ibuf;
+}
+
+/* Decode the frames after the last fetched one into the frame ring, the same way fetching them
+ * one after the other would. */
+static void ffmpeg_decode_ahead_task(TaskPool *__restrict pool, void *UNUSED(taskdata))
+{
+  struct anim *anim = BLI_task_pool_user_data(pool);
+  /* Don't overwrite the frame that was just fetched with the ones after it. */
+  const int end_position = anim->frame_ring->position +
+                           min_ii(FFMPEG_DECODE_AHEAD_FRAMES, anim->frame_ring->size - 1);
+
+  while (anim->last_position < end_position && anim->pFrameComplete &&
+         !BLI_task_pool_canceled(pool)) {
+    /* The frame in anim->pFrame is in the ring already, it's converted when it's fetched. */
+    IMB_freeImBuf(anim->last_frame);
+    anim->last_frame = NULL;
+    anim->last_pts = anim->next_pts;
+    anim->last_position++;
+
+    if (!ffmpeg_decode_video_frame(anim)) {
+      break;
+    }
+  }
+}
+
+static void ffmpeg_decode_ahead_start(struct anim *anim, int position)
+{
+  FFmpegFrameRing *ring = anim->frame_ring;
+  if (ring == NULL) {
+    return;
+  }
+
+  const bool is_playing_forward = (position == ring->position + 1);
+  ring->position = position;
+  if (is_playing_forward) {
+    BLI_task_pool_push(ring->decode_pool, ffmpeg_decode_ahead_task, NULL, false, NULL);
+  }
+}
+
+/* Stop decoding ahead, so the decoder can be used. */
+static void ffmpeg_decode_ahead_cancel(struct anim *anim)
+{
+  if (anim->frame_ring) {
+    BLI_task_pool_cancel(anim->frame_ring->decode_pool);
+  }
+}
+
 static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Type tc)
 {
   int64_t pts_to_search = 0;
@@ -1065,6 +1313,8 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
 
   av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: pos=%d\n", position);
 
+  ffmpeg_decode_ahead_cancel(anim);
+
   if (tc != IMB_TC_NONE) {
     tc_index = IMB_anim_open_index(anim, tc);
   }
@@ -1078,7 +1328,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
 
   if (tc_index) {
     new_frame_index = IMB_indexer_get_frame_index(tc_index, position);
-    old_frame_index = IMB_indexer_get_frame_index(tc_index, anim->curposition);
+    old_frame_index = IMB_indexer_get_frame_index(tc_index, anim->last_position);
     pts_to_search = IMB_indexer_get_pts(tc_index, new_frame_index);
   }
   else {
@@ -1105,12 +1355,25 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
            (long long int)anim->last_pts,
            (long long int)anim->next_pts);
     IMB_refImBuf(anim->last_frame);
-    anim->curposition = position;
+    anim->last_position = position;
+    ffmpeg_decode_ahead_start(anim, position);
     return anim->last_frame;
   }
 
-  if (position > anim->curposition + 1 && anim->preseek && !tc_index &&
-      position - (anim->curposition + 1) < anim->preseek) {
+  const FFmpegRingFrame *ring_frame = ffmpeg_frame_ring_find(anim, pts_to_search);
+  if (ring_frame) {
+    av_log(anim->pFormatCtx,
+           AV_LOG_DEBUG,
+           "FETCH: decoded frame ring: pts: %lld\n",
+           (long long int)ring_frame->pts);
+    ImBuf *ibuf = ffmpeg_frame_ibuf_alloc(anim);
+    ffmpeg_postprocess(anim, ring_frame->frame, ibuf);
+    ffmpeg_decode_ahead_start(anim, position);
+    return ibuf;
+  }
+
+  if (position > anim->last_position + 1 && anim->preseek && !tc_index &&
+      position - (anim->last_position + 1) < anim->preseek) {
     av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: within preseek interval (no index)\n");
 
     ffmpeg_decode_video_frame_scan(anim, pts_to_search);
@@ -1123,7 +1386,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
 
     ffmpeg_decode_video_frame_scan(anim, pts_to_search);
   }
-  else if (position != anim->curposition + 1) {
+  else if (position != anim->last_position + 1) {
     long long pos;
     int ret;
 
@@ -1182,6 +1445,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
     }
 
     avcodec_flush_buffers(anim->pCodecCtx);
+    ffmpeg_frame_ring_seek(anim);
 
     anim->next_pts = -1;
 
@@ -1196,7 +1460,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
       ffmpeg_decode_video_frame_scan(anim, pts_to_search);
     }
   }
-  else if (position == 0 && anim->curposition == -1) {
+  else if (position == 0 && anim->last_position == -1) {
     /* first frame without seeking special case... */
     ffmpeg_decode_video_frame(anim);
   }
@@ -1205,41 +1469,22 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
   }
 
   IMB_freeImBuf(anim->last_frame);
+  anim->last_frame = ffmpeg_frame_ibuf_alloc(anim);
 
-  /* Certain versions of FFmpeg have a bug in libswscale which ends up in crash
-   * when destination buffer is not properly aligned. For example, this happens
-   * in FFmpeg 4.3.1. It got fixed later on, but for compatibility reasons is
-   * still best to avoid crash.
-   *
-   * This is achieved by using own allocation call rather than relying on
-   * IMB_allocImBuf() to do so since the IMB_allocImBuf() is not guaranteed
-   * to perform aligned allocation.
-   *
-   * In theory this could give better performance, since SIMD operations on
-   * aligned data are usually faster.
-   *
-   * Note that even though sometimes vertical flip is required it does not
-   * affect on alignment of data passed to sws_scale because if the X dimension
-   * is not 32 byte aligned special intermediate buffer is allocated.
-   *
-   * The issue was reported to FFmpeg under ticket #8747 in the FFmpeg tracker
-   * and is fixed in the newer versions than 4.3.1. */
-  anim->last_frame = IMB_allocImBuf(anim->x, anim->y, 32, 0);
-  anim->last_frame->rect = MEM_mallocN_aligned((size_t)4 * anim->x * anim->y, 32, "ffmpeg ibuf");
-  anim->last_frame->mall |= IB_rect;
-
-  anim->last_frame->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
-
-  ffmpeg_postprocess(anim);
+  if (anim->pFrameComplete) {
+    ffmpeg_postprocess(anim, anim->pFrame, anim->last_frame);
+  }
 
   anim->last_pts = anim->next_pts;
 
   ffmpeg_decode_video_frame(anim);
 
-  anim->curposition = position;
+  anim->last_position = position;
 
   IMB_refImBuf(anim->last_frame);
 
+  ffmpeg_decode_ahead_start(anim, position);
+
   return anim->last_frame;
 }
 
@@ -1250,6 +1495,9 @@ static void free_anim_ffmpeg(struct anim *anim)
   }
 
   if (anim->pCodecCtx) {
+    ffmpeg_decode_ahead_cancel(anim);
+    ffmpeg_frame_ring_free(anim);
+
     avcodec_close(anim->pCodecCtx);
     avformat_close_input(&anim->pFormatCtx);
 
@@ -1506,3 +1754,39 @@ int IMB_anim_get_preseek(struct anim *anim)
 {
   return anim->preseek;
 }
+
+void IMB_anim_use_frame_ring(struct anim *anim)
+{
+#ifdef WITH_FFMPEG
+  if (anim->use_frame_ring) {
+    return;
+  }
+  anim->use_frame_ring = 1;
+  /* The movie may be open already. */
+  if (anim->pCodecCtx) {
+    ffmpeg_frame_ring_create(anim);
+  }
+#else
+  UNUSED_VARS(anim);
+#endif
+}
+
+void IMB_anim_frame_ring_set_memory_limit(size_t limit)
+{
+#ifdef WITH_FFMPEG
+  BLI_mutex_lock(&frame_ring_memory_mutex);
+  frame_ring_memory_limit = limit;
+  BLI_mutex_unlock(&frame_ring_memory_mutex);
+#else
+  UNUSED_VARS(limit);
+#endif
+}
+
+size_t IMB_anim_frame_ring_get_memory_limit(void)
+{
+#ifdef WITH_FFMPEG
+  return frame_ring_memory_limit;
+#else
+  return 0;
+#endif
+}
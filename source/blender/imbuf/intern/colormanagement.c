@@ -103,6 +103,8 @@ typedef struct ColormanageProcessor {
   OCIO_ConstProcessorRcPtr *processor;
   CurveMapping *curve_mapping;
   bool is_data_result;
+  /* Baked display transform, used instead of the OCIO processor for buffers. */
+  struct DisplayLUTCacheEntry *display_lut;
 } ColormanageProcessor;
 
 static struct global_glsl_state {
@@ -139,6 +141,117 @@ static struct global_color_picking_state {
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Display Transform Lookup Tables
+ * \{ */
+
+/* Number of baked display transforms that are kept, so switching views doesn't bake again. */
+#define DISPLAY_LUT_CACHE_SIZE 4
+
+typedef struct DisplayLUTCacheEntry {
+  struct DisplayLUTCacheEntry *next, *prev;
+
+  /* Settings the table is baked for. */
+  char look[MAX_COLORSPACE_NAME];
+  char view[MAX_COLORSPACE_NAME];
+  char display[MAX_COLORSPACE_NAME];
+  float exposure, gamma;
+
+  /* NULL when the transform can't be baked, the OCIO processor is used then. */
+  DisplayLUT *lut;
+  /* Number of processors using the table, it's not freed while in use. */
+  int users;
+} DisplayLUTCacheEntry;
+
+/* Most recently used first, protected by processor_lock. */
+static ListBase global_display_luts = {NULL, NULL};
+
+static void display_lut_cache_entry_free(DisplayLUTCacheEntry *entry)
+{
+  BLI_remlink(&global_display_luts, entry);
+  if (entry->lut) {
+    colormanage_display_lut_free(entry->lut);
+  }
+  MEM_freeN(entry);
+}
+
+static void display_lut_cache_trim(void)
+{
+  int num_entries = BLI_listbase_count(&global_display_luts);
+  DisplayLUTCacheEntry *entry = global_display_luts.last;
+  while (entry && num_entries > DISPLAY_LUT_CACHE_SIZE) {
+    DisplayLUTCacheEntry *prev = entry->prev;
+    if (entry->users == 0) {
+      display_lut_cache_entry_free(entry);
+      num_entries--;
+    }
+    entry = prev;
+  }
+}
+
+static void display_lut_cache_free(void)
+{
+  while (global_display_luts.first) {
+    display_lut_cache_entry_free(global_display_luts.first);
+  }
+}
+
+/* Table for the processor of the settings, baked on first use. */
+static DisplayLUTCacheEntry *display_lut_acquire(
+    OCIO_ConstProcessorRcPtr *processor,
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings)
+{
+  DisplayLUTCacheEntry *entry;
+
+  BLI_mutex_lock(&processor_lock);
+
+  for (entry = global_display_luts.first; entry; entry = entry->next) {
+    if (STREQ(entry->look, view_settings->look) &&
+        STREQ(entry->view, view_settings->view_transform) &&
+        STREQ(entry->display, display_settings->display_device) &&
+        entry->exposure == view_settings->exposure && entry->gamma == view_settings->gamma) {
+      break;
+    }
+  }
+
+  if (entry) {
+    BLI_remlink(&global_display_luts, entry);
+  }
+  else {
+    entry = MEM_callocN(sizeof(DisplayLUTCacheEntry), "display lut cache entry");
+    STRNCPY(entry->look, view_settings->look);
+    STRNCPY(entry->view, view_settings->view_transform);
+    STRNCPY(entry->display, display_settings->display_device);
+    entry->exposure = view_settings->exposure;
+    entry->gamma = view_settings->gamma;
+    entry->lut = colormanage_display_lut_create((struct OCIO_ConstProcessorRcPtr *)processor);
+  }
+  BLI_addhead(&global_display_luts, entry);
+
+  if (entry->lut) {
+    entry->users++;
+  }
+  else {
+    entry = NULL;
+  }
+
+  display_lut_cache_trim();
+
+  BLI_mutex_unlock(&processor_lock);
+
+  return entry;
+}
+
+static void display_lut_release(DisplayLUTCacheEntry *entry)
+{
+  BLI_mutex_lock(&processor_lock);
+  entry->users--;
+  BLI_mutex_unlock(&processor_lock);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Color Managed Cache
  * \{ */
@@ -757,6 +870,8 @@ void colormanagement_exit(void)
   memset(&global_glsl_state, 0, sizeof(global_glsl_state));
   memset(&global_color_picking_state, 0, sizeof(global_color_picking_state));
 
+  display_lut_cache_free();
+
   colormanage_free_config();
 }
 
@@ -1811,7 +1926,8 @@ static void colormanage_display_buffer_process_ex(
     float *display_buffer,
     unsigned char *display_buffer_byte,
     const ColorManagedViewSettings *view_settings,
-    const ColorManagedDisplaySettings *display_settings)
+    const ColorManagedDisplaySettings *display_settings,
+    bool use_display_lut)
 {
   ColormanageProcessor *cm_processor = NULL;
   bool skip_transform = false;
@@ -1826,7 +1942,13 @@ static void colormanage_display_buffer_process_ex(
   }
 
   if (skip_transform == false) {
-    cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
+    if (use_display_lut) {
+      cm_processor = IMB_colormanagement_display_processor_new_baked(view_settings,
+                                                                     display_settings);
+    }
+    else {
+      cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
+    }
   }
 
   display_buffer_apply_threaded(ibuf,
@@ -1847,7 +1969,7 @@ static void colormanage_display_buffer_process(ImBuf *ibuf,
                                                const ColorManagedDisplaySettings *display_settings)
 {
   colormanage_display_buffer_process_ex(
-      ibuf, NULL, display_buffer, view_settings, display_settings);
+      ibuf, NULL, display_buffer, view_settings, display_settings, true);
 }
 
 /** \} */
@@ -2516,8 +2638,12 @@ static void colormanagement_imbuf_make_display_space(
     imb_addrectImBuf(ibuf);
   }
 
-  colormanage_display_buffer_process_ex(
-      ibuf, ibuf->rect_float, (unsigned char *)ibuf->rect, view_settings, display_settings);
+  colormanage_display_buffer_process_ex(ibuf,
+                                        ibuf->rect_float,
+                                        (unsigned char *)ibuf->rect,
+                                        view_settings,
+                                        display_settings,
+                                        false);
 }
 
 void IMB_colormanagement_imbuf_make_display_space(
@@ -3855,6 +3981,26 @@ ColormanageProcessor *IMB_colormanagement_display_processor_new(
   return cm_processor;
 }
 
+ColormanageProcessor *IMB_colormanagement_display_processor_new_baked(
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings)
+{
+  ColormanageProcessor *cm_processor = IMB_colormanagement_display_processor_new(
+      view_settings, display_settings);
+
+  if (view_settings && cm_processor->processor) {
+    cm_processor->display_lut = display_lut_acquire(
+        cm_processor->processor, view_settings, display_settings);
+  }
+
+  return cm_processor;
+}
+
+bool IMB_colormanagement_processor_is_baked(const ColormanageProcessor *cm_processor)
+{
+  return cm_processor->display_lut != NULL;
+}
+
 ColormanageProcessor *IMB_colormanagement_colorspace_processor_new(const char *from_colorspace,
                                                                    const char *to_colorspace)
 {
@@ -3946,7 +4092,16 @@ void IMB_colormanagement_processor_apply(ColormanageProcessor *cm_processor,
     }
   }
 
-  if (cm_processor->processor && channels >= 3) {
+  if (cm_processor->display_lut && channels >= 3) {
+    colormanage_display_lut_apply(cm_processor->display_lut->lut,
+                                  (struct OCIO_ConstProcessorRcPtr *)cm_processor->processor,
+                                  buffer,
+                                  width,
+                                  height,
+                                  channels,
+                                  predivide);
+  }
+  else if (cm_processor->processor && channels >= 3) {
     OCIO_PackedImageDesc *img;
 
     /* apply OCIO processor */
@@ -3995,6 +4150,9 @@ void IMB_colormanagement_processor_free(ColormanageProcessor *cm_processor)
   if (cm_processor->processor) {
     OCIO_processorRelease(cm_processor->processor);
   }
+  if (cm_processor->display_lut) {
+    display_lut_release(cm_processor->display_lut);
+  }
 
   MEM_freeN(cm_processor);
 }
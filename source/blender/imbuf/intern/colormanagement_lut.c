@@ -0,0 +1,618 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup imbuf
+ *
+ * Display transforms baked into lookup tables.
+ *
+ * Evaluating the OCIO processor for every pixel of a display buffer is slow. Instead the
+ * transform is evaluated once for a table of input colors, which is interpolated afterwards.
+ * Transforms that work on every channel separately (like the standard sRGB view) are baked into
+ * a 1D table per channel, other transforms (like Filmic) into a 3D table.
+ *
+ * Scene linear inputs cover a large range, so a shaper maps them to table positions first. The
+ * shaper is indexed by the bits of the float values, which are a piecewise linear approximation
+ * of log2, over the range of inputs the view transform actually distinguishes. Above that range
+ * the transform is saturated and values are clamped. For 3D tables the shaper also spreads the
+ * entries evenly over the display response of the view, so the 64 entries aren't spent on
+ * octaves that all map to black or white.
+ *
+ * Values outside of the table (negative or NaN) are still passed to OCIO.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math_base.h"
+#include "BLI_math_vector.h"
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+
+#include "IMB_colormanagement_intern.h"
+
+#include <ocio_capi.h>
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+/* Inputs the range of the view transform is searched in, in octaves. */
+#define LUT_RANGE_MIN_EXP -24
+#define LUT_RANGE_MAX_EXP 24
+#define LUT_RANGE_OCTAVE_STEPS 4
+
+/* 1D tables have 2^7 entries per octave, so entries are at exact float bit boundaries. */
+#define LUT1D_OCTAVE_BITS 7
+
+/* Same size as the 3D LUT of the GLSL display transform. */
+#define LUT3D_SIZE 64
+/* Resolution of the shaper of 3D tables, in entries per octave. */
+#define LUT3D_SHAPER_OCTAVE_BITS 5
+/* Part of the 3D table entries that is spread evenly over the octaves of the range, instead of
+ * over the display response. */
+#define LUT3D_UNIFORM_WEIGHT 0.5f
+
+/* Colors the baked table is compared with OCIO for. */
+#define LUT_NUM_PROBES 4096
+/* Largest difference with OCIO that is allowed, in display space. */
+#define LUT_TOLERANCE (1.0f / 255.0f)
+
+typedef struct DisplayLUTShaper {
+  /* Values below min are interpolated linearly between zero and min. */
+  float min, inv_min;
+  /* Values above max are clamped when clamp_max is set, otherwise they're outside of the table. */
+  float max;
+  bool clamp_max;
+  int min_bits;
+  /* Entries per float bit, above min. */
+  float inv_step_bits;
+  int size;
+  /* 3D tables: table coordinate of every shaper entry, NULL for 1D tables. */
+  float *grid;
+} DisplayLUTShaper;
+
+typedef enum eDisplayLUTType {
+  DISPLAY_LUT_1D = 0,
+  DISPLAY_LUT_3D = 1,
+} eDisplayLUTType;
+
+struct DisplayLUT {
+  eDisplayLUTType type;
+  DisplayLUTShaper shaper;
+  /* 1D: shaper.size entries for each RGB channel.
+   * 3D: LUT3D_SIZE^3 RGBA entries, red changes fastest, alpha is padding for SIMD loads. */
+  float *table;
+};
+
+/* -------------------------------------------------------------------- */
+/** \name Shaper
+ * \{ */
+
+BLI_INLINE int float_bits(float value)
+{
+  union {
+    float f;
+    int i;
+  } u;
+  u.f = value;
+  return u.i;
+}
+
+BLI_INLINE float bits_float(int bits)
+{
+  union {
+    float f;
+    int i;
+  } u;
+  u.i = bits;
+  return u.f;
+}
+
+static void shaper_init(
+    DisplayLUTShaper *shaper, int min_exp, int max_exp, bool clamp_max, int octave_bits)
+{
+  shaper->min = ldexpf(1.0f, min_exp);
+  shaper->inv_min = 1.0f / shaper->min;
+  shaper->max = ldexpf(1.0f, max_exp);
+  shaper->clamp_max = clamp_max;
+  shaper->min_bits = float_bits(shaper->min);
+  shaper->size = ((max_exp - min_exp) << octave_bits) + 2;
+  /* Entry 0 is zero and entry 1 is min, the other entries are spread evenly over the float bits
+   * up to max. */
+  shaper->inv_step_bits = (float)(shaper->size - 2) /
+                          (float)(float_bits(shaper->max) - shaper->min_bits);
+  shaper->grid = NULL;
+}
+
+/* Input value at a table position, in entries. */
+static float shaper_value(const DisplayLUTShaper *shaper, float position)
+{
+  if (position <= 1.0f) {
+    return position * shaper->min;
+  }
+  const double step_bits = 1.0 / (double)shaper->inv_step_bits;
+  return bits_float(shaper->min_bits + (int)((position - 1.0f) * step_bits + 0.5));
+}
+
+BLI_INLINE bool shaper_contains(const DisplayLUTShaper *shaper, const float rgb[3])
+{
+  /* Written so NaN is outside. */
+  if (shaper->clamp_max) {
+    return rgb[0] >= 0.0f && rgb[1] >= 0.0f && rgb[2] >= 0.0f;
+  }
+  return (rgb[0] >= 0.0f && rgb[0] <= shaper->max) && (rgb[1] >= 0.0f && rgb[1] <= shaper->max) &&
+         (rgb[2] >= 0.0f && rgb[2] <= shaper->max);
+}
+
+/* Table positions of values, in entries. The positions of values outside of the table are
+ * undefined. */
+static void shaper_positions(const DisplayLUTShaper *shaper,
+                             const float *values,
+                             float *r_positions,
+                             size_t num_values)
+{
+  size_t i = 0;
+#ifdef __SSE2__
+  const __m128 min = _mm_set1_ps(shaper->min);
+  const __m128 max = _mm_set1_ps(shaper->max);
+  const __m128 inv_min = _mm_set1_ps(shaper->inv_min);
+  const __m128i min_bits = _mm_set1_epi32(shaper->min_bits);
+  const __m128 inv_step_bits = _mm_set1_ps(shaper->inv_step_bits);
+  for (; i + 4 <= num_values; i += 4) {
+    const __m128 value = _mm_min_ps(_mm_loadu_ps(values + i), max);
+    const __m128 linear = _mm_mul_ps(value, inv_min);
+    const __m128i bits = _mm_sub_epi32(_mm_castps_si128(value), min_bits);
+    const __m128 log = _mm_add_ps(_mm_set1_ps(1.0f),
+                                  _mm_mul_ps(_mm_cvtepi32_ps(bits), inv_step_bits));
+    const __m128 is_linear = _mm_cmplt_ps(value, min);
+    _mm_storeu_ps(r_positions + i,
+                  _mm_or_ps(_mm_and_ps(is_linear, linear), _mm_andnot_ps(is_linear, log)));
+  }
+#endif
+  for (; i < num_values; i++) {
+    const float value = min_ff(values[i], shaper->max);
+    if (value < shaper->min) {
+      r_positions[i] = value * shaper->inv_min;
+    }
+    else {
+      r_positions[i] = 1.0f + (float)(float_bits(value) - shaper->min_bits) *
+                                  shaper->inv_step_bits;
+    }
+  }
+}
+
+/* Entries to interpolate between for each RGB channel. */
+BLI_INLINE void shaper_indices(const DisplayLUTShaper *shaper,
+                               const float position[3],
+                               int r_index[3],
+                               float r_fac[3])
+{
+  for (int i = 0; i < 3; i++) {
+    const int index = min_ii((int)position[i], shaper->size - 2);
+    const float fac = position[i] - (float)index;
+    if (shaper->grid) {
+      const float grid_position = interpf(shaper->grid[index + 1], shaper->grid[index], fac);
+      r_index[i] = min_ii((int)grid_position, LUT3D_SIZE - 2);
+      r_fac[i] = grid_position - (float)r_index[i];
+    }
+    else {
+      r_index[i] = index;
+      r_fac[i] = fac;
+    }
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Evaluation
+ * \{ */
+
+BLI_INLINE void lut1d_interpolate(const DisplayLUT *lut,
+                                  const int index[3],
+                                  const float fac[3],
+                                  float rgb[3])
+{
+  const int size = lut->shaper.size;
+  for (int i = 0; i < 3; i++) {
+    const float *table = lut->table + (size_t)i * size + index[i];
+    rgb[i] = interpf(table[1], table[0], fac[i]);
+  }
+}
+
+BLI_INLINE void lut3d_interpolate(const DisplayLUT *lut,
+                                  const int index[3],
+                                  const float fac[3],
+                                  float rgb[3])
+{
+  const size_t size = LUT3D_SIZE;
+  const size_t dx = 4, dy = 4 * size, dz = 4 * size * size;
+  const float *p = lut->table + 4 * ((index[2] * size + index[1]) * size + index[0]);
+
+#ifdef __SSE2__
+  const __m128 fx = _mm_set1_ps(fac[0]);
+  const __m128 fy = _mm_set1_ps(fac[1]);
+  const __m128 fz = _mm_set1_ps(fac[2]);
+#  define LERP(a, b, f) _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), f))
+  const __m128 c00 = LERP(_mm_loadu_ps(p), _mm_loadu_ps(p + dx), fx);
+  const __m128 c10 = LERP(_mm_loadu_ps(p + dy), _mm_loadu_ps(p + dy + dx), fx);
+  const __m128 c01 = LERP(_mm_loadu_ps(p + dz), _mm_loadu_ps(p + dz + dx), fx);
+  const __m128 c11 = LERP(_mm_loadu_ps(p + dz + dy), _mm_loadu_ps(p + dz + dy + dx), fx);
+  const __m128 c = LERP(LERP(c00, c10, fy), LERP(c01, c11, fy), fz);
+#  undef LERP
+  float result[4];
+  _mm_storeu_ps(result, c);
+  copy_v3_v3(rgb, result);
+#else
+  for (int i = 0; i < 3; i++) {
+    const float c00 = interpf(p[dx + i], p[i], fac[0]);
+    const float c10 = interpf(p[dy + dx + i], p[dy + i], fac[0]);
+    const float c01 = interpf(p[dz + dx + i], p[dz + i], fac[0]);
+    const float c11 = interpf(p[dz + dy + dx + i], p[dz + dy + i], fac[0]);
+    rgb[i] = interpf(interpf(c11, c01, fac[1]), interpf(c10, c00, fac[1]), fac[2]);
+  }
+#endif
+}
+
+/* Transform packed RGB colors with the table. Colors outside of the table are left unchanged,
+ * their indices are returned in r_outside.
+ *
+ * \param positions: Scratch memory for num_colors RGB colors.
+ * \return The number of colors outside of the table. */
+static int display_lut_apply_rgb(const DisplayLUT *lut,
+                                 float *rgb,
+                                 float *positions,
+                                 int num_colors,
+                                 int *r_outside)
+{
+  shaper_positions(&lut->shaper, rgb, positions, 3 * (size_t)num_colors);
+
+  int num_outside = 0;
+  for (int i = 0; i < num_colors; i++) {
+    float *color = rgb + 3 * (size_t)i;
+    if (!shaper_contains(&lut->shaper, color)) {
+      r_outside[num_outside++] = i;
+      continue;
+    }
+
+    int index[3];
+    float fac[3];
+    shaper_indices(&lut->shaper, positions + 3 * (size_t)i, index, fac);
+
+    if (lut->type == DISPLAY_LUT_1D) {
+      lut1d_interpolate(lut, index, fac, color);
+    }
+    else {
+      lut3d_interpolate(lut, index, fac, color);
+    }
+  }
+  return num_outside;
+}
+
+static void processor_apply_rgb(OCIO_ConstProcessorRcPtr *processor, float *rgb, int num_colors)
+{
+  OCIO_PackedImageDesc *img = OCIO_createOCIO_PackedImageDesc(rgb,
+                                                              num_colors,
+                                                              1,
+                                                              3,
+                                                              sizeof(float),
+                                                              3 * sizeof(float),
+                                                              3 * sizeof(float) * num_colors);
+  OCIO_processorApply(processor, img);
+  OCIO_PackedImageDescRelease(img);
+}
+
+void colormanage_display_lut_apply(const DisplayLUT *lut,
+                                   struct OCIO_ConstProcessorRcPtr *processor_v,
+                                   float *buffer,
+                                   int width,
+                                   int height,
+                                   int channels,
+                                   bool predivide)
+{
+  OCIO_ConstProcessorRcPtr *processor = (OCIO_ConstProcessorRcPtr *)processor_v;
+  BLI_assert(channels >= 3);
+
+  /* Scanlines are transformed at once, colors outside of the table are passed to OCIO together
+   * afterwards. */
+  float *rgb = MEM_mallocN(sizeof(float[3]) * width, "display lut scanline");
+  float *positions = MEM_mallocN(sizeof(float[3]) * width, "display lut positions");
+  int *outside = MEM_mallocN(sizeof(int) * width, "display lut outside");
+
+  for (int y = 0; y < height; y++) {
+    float *scanline = buffer + (size_t)channels * width * y;
+
+    /* Same as OCIO_processorApplyRGBA_predivide. */
+    float *pixel = scanline;
+    for (int x = 0; x < width; x++, pixel += channels) {
+      if (predivide && channels == 4 && pixel[3] != 1.0f && pixel[3] != 0.0f) {
+        mul_v3_v3fl(rgb + 3 * x, pixel, 1.0f / pixel[3]);
+      }
+      else {
+        copy_v3_v3(rgb + 3 * x, pixel);
+      }
+    }
+
+    const int num_outside = display_lut_apply_rgb(lut, rgb, positions, width, outside);
+
+    if (num_outside > 0) {
+      /* The positions aren't needed anymore, pack the colors in there. */
+      for (int i = 0; i < num_outside; i++) {
+        copy_v3_v3(positions + 3 * i, rgb + 3 * outside[i]);
+      }
+      processor_apply_rgb(processor, positions, num_outside);
+      for (int i = 0; i < num_outside; i++) {
+        copy_v3_v3(rgb + 3 * outside[i], positions + 3 * i);
+      }
+    }
+
+    pixel = scanline;
+    for (int x = 0; x < width; x++, pixel += channels) {
+      if (predivide && channels == 4 && pixel[3] != 1.0f && pixel[3] != 0.0f) {
+        mul_v3_v3fl(pixel, rgb + 3 * x, pixel[3]);
+      }
+      else {
+        copy_v3_v3(pixel, rgb + 3 * x);
+      }
+    }
+  }
+
+  MEM_freeN(outside);
+  MEM_freeN(positions);
+  MEM_freeN(rgb);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Baking
+ * \{ */
+
+/* Octaves of gray the view transform distinguishes from black and from its brightest output.
+ * Above the range the output is saturated, so values can be clamped when clamp_max is set. */
+static void display_lut_input_range(OCIO_ConstProcessorRcPtr *processor,
+                                    int *r_min_exp,
+                                    int *r_max_exp,
+                                    bool *r_clamp_max)
+{
+  const int num_steps = (LUT_RANGE_MAX_EXP - LUT_RANGE_MIN_EXP) * LUT_RANGE_OCTAVE_STEPS + 1;
+  float *rgb = MEM_mallocN(sizeof(float[3]) * (num_steps + 1), "display lut range");
+  /* First color is black, the others are octave steps. */
+  zero_v3(rgb);
+  for (int i = 0; i < num_steps; i++) {
+    copy_v3_fl(rgb + 3 * (i + 1), exp2f(LUT_RANGE_MIN_EXP + (float)i / LUT_RANGE_OCTAVE_STEPS));
+  }
+  processor_apply_rgb(processor, rgb, num_steps + 1);
+
+  /* Much smaller than the tolerance, the range is extended by an octave on both sides too. */
+  const float threshold = LUT_TOLERANCE / 16.0f;
+  const float *black = rgb;
+  const float *white = rgb + 3 * num_steps;
+  int first_step = num_steps - 1, last_step = 0;
+  for (int i = num_steps - 1; i >= 0; i--) {
+    const float *color = rgb + 3 * (i + 1);
+    if (!compare_v3v3(color, black, threshold)) {
+      first_step = i;
+    }
+  }
+  for (int i = 0; i < num_steps; i++) {
+    const float *color = rgb + 3 * (i + 1);
+    if (!compare_v3v3(color, white, threshold)) {
+      last_step = i;
+    }
+  }
+  MEM_freeN(rgb);
+
+  const int min_exp = (int)floorf(LUT_RANGE_MIN_EXP + (float)first_step / LUT_RANGE_OCTAVE_STEPS);
+  const int max_exp = (int)ceilf(LUT_RANGE_MIN_EXP +
+                                 (float)(last_step + 1) / LUT_RANGE_OCTAVE_STEPS);
+  *r_min_exp = max_ii(min_exp - 1, LUT_RANGE_MIN_EXP);
+  *r_max_exp = min_ii(max_ii(max_exp + 1, *r_min_exp + 1), LUT_RANGE_MAX_EXP);
+  *r_clamp_max = *r_max_exp < LUT_RANGE_MAX_EXP;
+}
+
+static DisplayLUT *lut1d_create(OCIO_ConstProcessorRcPtr *processor,
+                                int min_exp,
+                                int max_exp,
+                                bool clamp_max)
+{
+  DisplayLUT *lut = MEM_callocN(sizeof(DisplayLUT), "display lut");
+  lut->type = DISPLAY_LUT_1D;
+  shaper_init(&lut->shaper, min_exp, max_exp, clamp_max, LUT1D_OCTAVE_BITS);
+
+  const int size = lut->shaper.size;
+  float *rgb = MEM_mallocN(sizeof(float[3]) * size, "display lut colors");
+  for (int i = 0; i < size; i++) {
+    copy_v3_fl(rgb + 3 * i, shaper_value(&lut->shaper, (float)i));
+  }
+  processor_apply_rgb(processor, rgb, size);
+
+  lut->table = MEM_mallocN(sizeof(float[3]) * size, "display lut table");
+  for (int i = 0; i < size; i++) {
+    lut->table[i] = rgb[3 * i];
+    lut->table[size + i] = rgb[3 * i + 1];
+    lut->table[2 * size + i] = rgb[3 * i + 2];
+  }
+
+  MEM_freeN(rgb);
+  return lut;
+}
+
+/* Table coordinates of the shaper entries, spread over the display response of gray. Returns the
+ * input values of the table entries in r_values. */
+static void lut3d_grid_create(OCIO_ConstProcessorRcPtr *processor,
+                              DisplayLUTShaper *shaper,
+                              float r_values[LUT3D_SIZE])
+{
+  const int size = shaper->size;
+  float *rgb = MEM_mallocN(sizeof(float[3]) * size, "display lut shaper colors");
+  for (int i = 0; i < size; i++) {
+    copy_v3_fl(rgb + 3 * i, shaper_value(shaper, (float)i));
+  }
+  processor_apply_rgb(processor, rgb, size);
+
+  /* Cumulative change of the display response. */
+  float *grid = MEM_mallocN(sizeof(float) * size, "display lut shaper grid");
+  grid[0] = 0.0f;
+  for (int i = 1; i < size; i++) {
+    const float *color = rgb + 3 * i;
+    const float *prev_color = color - 3;
+    grid[i] = grid[i - 1] + fabsf(color[0] - prev_color[0]) + fabsf(color[1] - prev_color[1]) +
+              fabsf(color[2] - prev_color[2]);
+  }
+  MEM_freeN(rgb);
+
+  /* Part of the entries is spread evenly, so there are entries where the response is flat. */
+  const float total = grid[size - 1];
+  const bool has_response = isfinite(total) && total > 0.0f;
+  const float uniform_step = has_response ? total * LUT3D_UNIFORM_WEIGHT /
+                                                (1.0f - LUT3D_UNIFORM_WEIGHT) / (size - 1) :
+                                            1.0f;
+  for (int i = 1; i < size; i++) {
+    grid[i] = (has_response ? grid[i] : 0.0f) + uniform_step * i;
+  }
+  const float scale = (float)(LUT3D_SIZE - 1) / grid[size - 1];
+  for (int i = 0; i < size; i++) {
+    grid[i] *= scale;
+  }
+  grid[size - 1] = (float)(LUT3D_SIZE - 1);
+
+  /* Invert the grid to find the input value of every table entry. */
+  int index = 0;
+  for (int entry = 0; entry < LUT3D_SIZE; entry++) {
+    while (index < size - 2 && grid[index + 1] < (float)entry) {
+      index++;
+    }
+    const float fac = ((float)entry - grid[index]) / (grid[index + 1] - grid[index]);
+    r_values[entry] = shaper_value(shaper, (float)index + clamp_f(fac, 0.0f, 1.0f));
+  }
+
+  shaper->grid = grid;
+}
+
+static DisplayLUT *lut3d_create(OCIO_ConstProcessorRcPtr *processor,
+                                int min_exp,
+                                int max_exp,
+                                bool clamp_max)
+{
+  DisplayLUT *lut = MEM_callocN(sizeof(DisplayLUT), "display lut");
+  lut->type = DISPLAY_LUT_3D;
+  shaper_init(&lut->shaper, min_exp, max_exp, clamp_max, LUT3D_SHAPER_OCTAVE_BITS);
+
+  float values[LUT3D_SIZE];
+  lut3d_grid_create(processor, &lut->shaper, values);
+
+  const int size = LUT3D_SIZE;
+  const int num_colors = size * size * size;
+  float *rgb = MEM_mallocN(sizeof(float[3]) * num_colors, "display lut colors");
+  float *color = rgb;
+  for (int z = 0; z < size; z++) {
+    for (int y = 0; y < size; y++) {
+      for (int x = 0; x < size; x++, color += 3) {
+        color[0] = values[x];
+        color[1] = values[y];
+        color[2] = values[z];
+      }
+    }
+  }
+  processor_apply_rgb(processor, rgb, num_colors);
+
+  lut->table = MEM_mallocN(sizeof(float[4]) * num_colors, "display lut table");
+  for (int i = 0; i < num_colors; i++) {
+    copy_v3_v3(lut->table + 4 * i, rgb + 3 * i);
+    lut->table[4 * i + 3] = 0.0f;
+  }
+
+  MEM_freeN(rgb);
+  return lut;
+}
+
+/* Compare the table with OCIO for random colors, which checks both the resolution of the table
+ * and (for 1D tables) that the channels are independent. Colors above the range are included
+ * when they are clamped. */
+static bool display_lut_verify(const DisplayLUT *lut, OCIO_ConstProcessorRcPtr *processor)
+{
+  const float min_exp = log2f(lut->shaper.min) - 2.0f;
+  const float max_exp = log2f(lut->shaper.max) + (lut->shaper.clamp_max ? 2.0f : 0.0f);
+
+  float *probes = MEM_mallocN(sizeof(float[3]) * LUT_NUM_PROBES, "display lut probes");
+  RNG *rng = BLI_rng_new(0);
+  for (int i = 0; i < 3 * LUT_NUM_PROBES; i++) {
+    /* Cover all octaves evenly, including the linear part below min and zero. */
+    const float exp = min_exp + (max_exp - min_exp) * BLI_rng_get_float(rng);
+    const float value = (BLI_rng_get_float(rng) < 0.02f) ? 0.0f : exp2f(exp);
+    probes[i] = lut->shaper.clamp_max ? value : min_ff(value, lut->shaper.max);
+  }
+  BLI_rng_free(rng);
+
+  float *expected = MEM_dupallocN(probes);
+  processor_apply_rgb(processor, expected, LUT_NUM_PROBES);
+
+  float *positions = MEM_mallocN(sizeof(float[3]) * LUT_NUM_PROBES, "display lut positions");
+  int *outside = MEM_mallocN(sizeof(int) * LUT_NUM_PROBES, "display lut outside");
+  bool is_valid = display_lut_apply_rgb(lut, probes, positions, LUT_NUM_PROBES, outside) == 0;
+  MEM_freeN(outside);
+  MEM_freeN(positions);
+
+  for (int i = 0; i < 3 * LUT_NUM_PROBES && is_valid; i++) {
+    /* Written so NaN fails. */
+    if (!(fabsf(probes[i] - expected[i]) <= LUT_TOLERANCE)) {
+      is_valid = false;
+    }
+  }
+
+  MEM_freeN(expected);
+  MEM_freeN(probes);
+  return is_valid;
+}
+
+DisplayLUT *colormanage_display_lut_create(struct OCIO_ConstProcessorRcPtr *processor_v)
+{
+  OCIO_ConstProcessorRcPtr *processor = (OCIO_ConstProcessorRcPtr *)processor_v;
+
+  int min_exp, max_exp;
+  bool clamp_max;
+  display_lut_input_range(processor, &min_exp, &max_exp, &clamp_max);
+
+  DisplayLUT *lut = lut1d_create(processor, min_exp, max_exp, clamp_max);
+  if (display_lut_verify(lut, processor)) {
+    return lut;
+  }
+  colormanage_display_lut_free(lut);
+
+  lut = lut3d_create(processor, min_exp, max_exp, clamp_max);
+  if (display_lut_verify(lut, processor)) {
+    return lut;
+  }
+  colormanage_display_lut_free(lut);
+
+  return NULL;
+}
+
+void colormanage_display_lut_free(DisplayLUT *lut)
+{
+  MEM_SAFE_FREE(lut->shaper.grid);
+  MEM_freeN(lut->table);
+  MEM_freeN(lut);
+}
+
+/** \} */
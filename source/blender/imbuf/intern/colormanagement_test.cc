@@ -0,0 +1,165 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_appdir.h"
+#include "BKE_colortools.h"
+
+#include "DNA_color_types.h"
+
+#include "IMB_colormanagement.h"
+#include "IMB_imbuf.h"
+
+class ColormanagementTest : public testing::Test {
+ protected:
+  int width = 0;
+  int height = 0;
+  float *source = nullptr;
+  float *buffer = nullptr;
+
+  static void SetUpTestCase()
+  {
+    BKE_appdir_init();
+    IMB_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    IMB_exit();
+  }
+
+  void TearDown() override
+  {
+    MEM_SAFE_FREE(source);
+    MEM_SAFE_FREE(buffer);
+  }
+
+  size_t buffer_size() const
+  {
+    return sizeof(float[4]) * width * height;
+  }
+
+  /* Scene linear colors from dark to over exposed, with different hues per row. The first column
+   * is negative, which is outside of any baked table. */
+  void buffer_create(const int buffer_width, const int buffer_height)
+  {
+    width = buffer_width;
+    height = buffer_height;
+    source = static_cast<float *>(MEM_mallocN(buffer_size(), __func__));
+    buffer = static_cast<float *>(MEM_mallocN(buffer_size(), __func__));
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        float *pixel = source + 4 * ((size_t)y * width + x);
+        const float value = (x == 0) ? -0.5f : exp2f(-10.0f + 14.0f * x / width);
+        pixel[0] = value;
+        pixel[1] = value * y / height;
+        pixel[2] = value * (height - y) / height;
+        pixel[3] = 1.0f;
+      }
+    }
+    memcpy(buffer, source, buffer_size());
+  }
+
+  bool view_settings_init(const char *view_transform,
+                          ColorManagedViewSettings *view_settings,
+                          ColorManagedDisplaySettings *display_settings)
+  {
+    if (IMB_colormanagement_view_get_named_index(view_transform) == 0) {
+      printf("%s view transform not in the configuration, skipped\n", view_transform);
+      return false;
+    }
+    BKE_color_managed_display_settings_init(display_settings);
+    BKE_color_managed_view_settings_init_render(view_settings, display_settings, view_transform);
+    return true;
+  }
+
+  /* Apply the display transform to the source, with and without baked table. */
+  void apply(const char *view_transform, float **r_expected, bool *r_is_baked)
+  {
+    ColorManagedViewSettings view_settings;
+    ColorManagedDisplaySettings display_settings;
+    *r_expected = nullptr;
+    *r_is_baked = false;
+    if (!view_settings_init(view_transform, &view_settings, &display_settings)) {
+      return;
+    }
+
+    ColormanageProcessor *ocio_processor = IMB_colormanagement_display_processor_new(
+        &view_settings, &display_settings);
+    memcpy(buffer, source, buffer_size());
+    IMB_colormanagement_processor_apply(ocio_processor, buffer, width, height, 4, false);
+    *r_expected = static_cast<float *>(MEM_dupallocN(buffer));
+    IMB_colormanagement_processor_free(ocio_processor);
+
+    ColormanageProcessor *baked_processor = IMB_colormanagement_display_processor_new_baked(
+        &view_settings, &display_settings);
+    *r_is_baked = IMB_colormanagement_processor_is_baked(baked_processor);
+    memcpy(buffer, source, buffer_size());
+    IMB_colormanagement_processor_apply(baked_processor, buffer, width, height, 4, false);
+    IMB_colormanagement_processor_free(baked_processor);
+  }
+
+  void compare_view_transform(const char *view_transform)
+  {
+    float *expected;
+    bool is_baked;
+    apply(view_transform, &expected, &is_baked);
+    if (expected == nullptr) {
+      return;
+    }
+
+    /* The transform is accurate enough to be baked, so the table must be used. */
+    EXPECT_TRUE(is_baked) << view_transform;
+
+    float max_difference = 0.0f;
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        const size_t index = 4 * ((size_t)y * width + x);
+        for (int i = 0; i < 4; i++) {
+          const float difference = fabsf(buffer[index + i] - expected[index + i]);
+          if (x == 0) {
+            /* Colors outside of the table are transformed by OCIO. */
+            EXPECT_EQ(difference, 0.0f) << view_transform;
+          }
+          max_difference = std::max(max_difference, difference);
+        }
+      }
+    }
+    MEM_freeN(expected);
+
+    /* Interpolated colors never match OCIO exactly, identical results mean the table wasn't
+     * used. Tables are only used when they're within one 8-bit step of OCIO for random colors,
+     * allow some margin for the colors that weren't compared. */
+    EXPECT_GT(max_difference, 0.0f) << view_transform;
+    EXPECT_LE(max_difference, 2.0f / 255.0f) << view_transform;
+  }
+};
+
+TEST_F(ColormanagementTest, DisplayTransformBaked)
+{
+  buffer_create(256, 32);
+
+  compare_view_transform("Standard");
+  compare_view_transform("Filmic");
+}
@@ -27,8 +27,10 @@
 #include "BLI_endian_switch.h"
 #include "BLI_fileops.h"
 #include "BLI_ghash.h"
+#include "BLI_listbase.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 #ifdef _WIN32
 #  include "BLI_winstuff.h"
@@ -455,8 +457,18 @@ struct proxy_output_ctx {
   int proxy_size;
   int orig_height;
   struct anim *anim;
+  /* Decoded frames waiting to be scaled and encoded by the thread of this proxy size. */
+  ThreadQueue *frames;
+  /* Number of frames in the queue that weren't encoded yet, the decoder waits on the condition
+   * while it is at the limit. */
+  int frames_pending;
+  ThreadMutex frames_lock;
+  ThreadCondition frames_cond;
 };
 
+/* Frames the decoder may be ahead of the encoding of a proxy size. */
+#define PROXY_QUEUE_MAX_FRAMES 16
+
 // work around stupid swscaler 16 bytes alignment bug...
 
 static int round_up(int x, int mod)
@@ -680,6 +692,23 @@ static void free_proxy_output_ffmpeg(struct proxy_output_ctx *ctx, int rollback)
   MEM_freeN(ctx);
 }
 
+static void *proxy_output_thread_ffmpeg(void *ctx_v)
+{
+  struct proxy_output_ctx *ctx = ctx_v;
+  AVFrame *frame;
+
+  while ((frame = BLI_thread_queue_pop(ctx->frames))) {
+    add_to_proxy_output_ffmpeg(ctx, frame);
+    av_frame_free(&frame);
+
+    BLI_mutex_lock(&ctx->frames_lock);
+    ctx->frames_pending--;
+    BLI_condition_notify_one(&ctx->frames_cond);
+    BLI_mutex_unlock(&ctx->frames_lock);
+  }
+  return NULL;
+}
+
 typedef struct FFmpegIndexBuilderContext {
   int anim_type;
 
@@ -694,6 +723,8 @@ typedef struct FFmpegIndexBuilderContext {
 
   struct proxy_output_ctx *proxy_ctx[IMB_PROXY_MAX_SLOT];
   anim_index_builder *indexer[IMB_TC_MAX_SLOT];
+  /* Every proxy size is scaled and encoded in its own thread, while decoding continues. */
+  ListBase proxy_threads;
 
   IMB_Timecode_Type tcs_in_use;
   IMB_Proxy_Size proxy_sizes_in_use;
@@ -773,6 +804,10 @@ static IndexBuildContext *index_ffmpeg_create_context(struct anim *anim,
   }
 
   context->iCodecCtx->workaround_bugs = 1;
+  /* Frame threading delays decoded frames, which would store them with the seek position of a
+   * later key-frame in the index. Slices are decoded in parallel without delay. */
+  context->iCodecCtx->thread_count = BLI_system_thread_count();
+  context->iCodecCtx->thread_type = FF_THREAD_SLICE;
 
   if (avcodec_open2(context->iCodecCtx, context->iCodec, NULL) < 0) {
     avformat_close_input(&context->iFormatCtx);
@@ -833,6 +868,102 @@ static void index_rebuild_ffmpeg_finish(FFmpegIndexBuilderContext *context, int
   MEM_freeN(context);
 }
 
+static void proxy_outputs_start_ffmpeg(FFmpegIndexBuilderContext *context)
+{
+  int num_threads = 0;
+  for (int i = 0; i < context->num_proxy_sizes; i++) {
+    if (context->proxy_ctx[i]) {
+      num_threads++;
+    }
+  }
+  if (num_threads == 0) {
+    return;
+  }
+
+  BLI_threadpool_init(&context->proxy_threads, proxy_output_thread_ffmpeg, num_threads);
+  for (int i = 0; i < context->num_proxy_sizes; i++) {
+    struct proxy_output_ctx *ctx = context->proxy_ctx[i];
+    if (ctx) {
+      ctx->frames = BLI_thread_queue_init();
+      ctx->frames_pending = 0;
+      BLI_mutex_init(&ctx->frames_lock);
+      BLI_condition_init(&ctx->frames_cond);
+      BLI_threadpool_insert(&context->proxy_threads, ctx);
+    }
+  }
+}
+
+/**
+ * Wait for all queued frames to be encoded, frames that weren't encoded yet are dropped when
+ * stopped. Encoders are flushed afterwards by #free_proxy_output_ffmpeg.
+ */
+static void proxy_outputs_end_ffmpeg(FFmpegIndexBuilderContext *context, bool stop)
+{
+  if (BLI_listbase_is_empty(&context->proxy_threads)) {
+    return;
+  }
+
+  for (int i = 0; i < context->num_proxy_sizes; i++) {
+    struct proxy_output_ctx *ctx = context->proxy_ctx[i];
+    if (ctx) {
+      BLI_thread_queue_nowait(ctx->frames);
+      if (stop) {
+        AVFrame *frame;
+        while ((frame = BLI_thread_queue_pop(ctx->frames))) {
+          av_frame_free(&frame);
+        }
+      }
+    }
+  }
+  BLI_threadpool_end(&context->proxy_threads);
+
+  for (int i = 0; i < context->num_proxy_sizes; i++) {
+    struct proxy_output_ctx *ctx = context->proxy_ctx[i];
+    if (ctx) {
+      BLI_thread_queue_free(ctx->frames);
+      ctx->frames = NULL;
+      BLI_condition_end(&ctx->frames_cond);
+      BLI_mutex_end(&ctx->frames_lock);
+    }
+  }
+}
+
+/* Queue a decoded frame for all proxy sizes. */
+static void proxy_outputs_push_ffmpeg(FFmpegIndexBuilderContext *context, AVFrame *in_frame)
+{
+  /* The decoder reuses its frame, so the data is copied once, then shared by reference. */
+  AVFrame *frame = NULL;
+
+  for (int i = 0; i < context->num_proxy_sizes; i++) {
+    struct proxy_output_ctx *ctx = context->proxy_ctx[i];
+    if (ctx == NULL) {
+      continue;
+    }
+    if (frame == NULL) {
+      frame = av_frame_clone(in_frame);
+      if (frame == NULL) {
+        return;
+      }
+    }
+    AVFrame *frame_ref = av_frame_clone(frame);
+    if (frame_ref == NULL) {
+      continue;
+    }
+    /* Only wait until there is room for one more frame, so the encoder never runs dry. */
+    BLI_mutex_lock(&ctx->frames_lock);
+    while (ctx->frames_pending >= PROXY_QUEUE_MAX_FRAMES) {
+      BLI_condition_wait(&ctx->frames_cond, &ctx->frames_lock);
+    }
+    ctx->frames_pending++;
+    BLI_mutex_unlock(&ctx->frames_lock);
+    BLI_thread_queue_push(ctx->frames, frame_ref);
+  }
+
+  if (frame) {
+    av_frame_free(&frame);
+  }
+}
+
 static void index_rebuild_ffmpeg_proc_decoded_frame(FFmpegIndexBuilderContext *context,
                                                     AVPacket *curr_packet,
                                                     AVFrame *in_frame)
@@ -842,9 +973,7 @@ static void index_rebuild_ffmpeg_proc_decoded_frame(FFmpegIndexBuilderContext *c
   unsigned long long s_dts = context->seek_pos_dts;
   unsigned long long pts = av_get_pts_from_frame(context->iFormatCtx, in_frame);
 
-  for (i = 0; i < context->num_proxy_sizes; i++) {
-    add_to_proxy_output_ffmpeg(context->proxy_ctx[i], in_frame);
-  }
+  proxy_outputs_push_ffmpeg(context, in_frame);
 
   if (!context->start_pts_set) {
     context->start_pts = pts;
@@ -905,6 +1034,8 @@ static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
   context->frame_rate = av_q2d(av_guess_frame_rate(context->iFormatCtx, context->iStream, NULL));
   context->pts_time_base = av_q2d(context->iStream->time_base);
 
+  proxy_outputs_start_ffmpeg(context);
+
   while (av_read_frame(context->iFormatCtx, &next_packet) >= 0) {
     int frame_finished = 0;
     float next_progress =
@@ -960,6 +1091,8 @@ static int index_rebuild_ffmpeg(FFmpegIndexBuilderContext *context,
     } while (frame_finished);
   }
 
+  proxy_outputs_end_ffmpeg(context, *stop);
+
   av_free(in_frame);
 
   return 1;
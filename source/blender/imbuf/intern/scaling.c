@@ -23,9 +23,12 @@
  */
 
 #include <math.h>
+#include <string.h>
 
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
-#include "BLI_math_interp.h"
+#include "BLI_math_vector.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "MEM_guardedalloc.h"
 
@@ -37,6 +40,13 @@
 
 #include "BLI_sys_types.h" /* for intptr_t support */
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+/* Buffers are resampled in a single thread below this number of pixels. */
+#define RESAMPLE_THREADING_MIN_PIXELS (256 * 256)
+
 static void imb_half_x_no_alloc(struct ImBuf *ibuf2, struct ImBuf *ibuf1)
 {
   uchar *p1, *_p1, *dest;
@@ -478,1078 +488,335 @@ ImBuf *IMB_onehalf(struct ImBuf *ibuf1)
   return ibuf2;
 }
 
-/* q_scale_linear_interpolation helper functions */
-
-static void enlarge_picture_byte(unsigned char *src,
-                                 unsigned char *dst,
-                                 int src_width,
-                                 int src_height,
-                                 int dst_width,
-                                 int dst_height)
+/* -------------------------------------------------------------------- */
+/** \name Separable Resampling
+ *
+ * Buffers are scaled in two passes, first every row is resampled horizontally, then the result
+ * is resampled vertically. The weights of the source pixels of every destination pixel only
+ * depend on the position along the axis, so they are computed once per axis and shared by all
+ * rows or columns.
+ * \{ */
+
+typedef struct ResampleFilter {
+  /* Weight of a source pixel at a distance, NULL for the box filter which uses the coverage of
+   * the source pixel. */
+  float (*kernel)(float x);
+  /* Distance outside of which the kernel is zero, when not scaling down. */
+  float support;
+} ResampleFilter;
+
+static float filter_bilinear(float x)
 {
-  double ratiox = (double)(dst_width - 1.0) / (double)(src_width - 1.001);
-  double ratioy = (double)(dst_height - 1.0) / (double)(src_height - 1.001);
-  uintptr_t x_src, dx_src, x_dst;
-  uintptr_t y_src, dy_src, y_dst;
-
-  dx_src = 65536.0 / ratiox;
-  dy_src = 65536.0 / ratioy;
-
-  y_src = 0;
-  for (y_dst = 0; y_dst < dst_height; y_dst++) {
-    unsigned char *line1 = src + (y_src >> 16) * 4 * src_width;
-    unsigned char *line2 = line1 + 4 * src_width;
-    uintptr_t weight1y = 65536 - (y_src & 0xffff);
-    uintptr_t weight2y = 65536 - weight1y;
-
-    if ((y_src >> 16) == src_height - 1) {
-      line2 = line1;
-    }
-
-    x_src = 0;
-    for (x_dst = 0; x_dst < dst_width; x_dst++) {
-      uintptr_t weight1x = 65536 - (x_src & 0xffff);
-      uintptr_t weight2x = 65536 - weight1x;
-
-      unsigned long x = (x_src >> 16) * 4;
-
-      *dst++ = ((((line1[x] * weight1y) >> 16) * weight1x) >> 16) +
-               ((((line2[x] * weight2y) >> 16) * weight1x) >> 16) +
-               ((((line1[4 + x] * weight1y) >> 16) * weight2x) >> 16) +
-               ((((line2[4 + x] * weight2y) >> 16) * weight2x) >> 16);
-
-      *dst++ = ((((line1[x + 1] * weight1y) >> 16) * weight1x) >> 16) +
-               ((((line2[x + 1] * weight2y) >> 16) * weight1x) >> 16) +
-               ((((line1[4 + x + 1] * weight1y) >> 16) * weight2x) >> 16) +
-               ((((line2[4 + x + 1] * weight2y) >> 16) * weight2x) >> 16);
-
-      *dst++ = ((((line1[x + 2] * weight1y) >> 16) * weight1x) >> 16) +
-               ((((line2[x + 2] * weight2y) >> 16) * weight1x) >> 16) +
-               ((((line1[4 + x + 2] * weight1y) >> 16) * weight2x) >> 16) +
-               ((((line2[4 + x + 2] * weight2y) >> 16) * weight2x) >> 16);
-
-      *dst++ = ((((line1[x + 3] * weight1y) >> 16) * weight1x) >> 16) +
-               ((((line2[x + 3] * weight2y) >> 16) * weight1x) >> 16) +
-               ((((line1[4 + x + 3] * weight1y) >> 16) * weight2x) >> 16) +
-               ((((line2[4 + x + 3] * weight2y) >> 16) * weight2x) >> 16);
-
-      x_src += dx_src;
-    }
-    y_src += dy_src;
-  }
+  x = fabsf(x);
+  return (x < 1.0f) ? 1.0f - x : 0.0f;
 }
 
-struct scale_outpix_byte {
-  uintptr_t r;
-  uintptr_t g;
-  uintptr_t b;
-  uintptr_t a;
-
-  uintptr_t weight;
-};
-
-static void shrink_picture_byte(unsigned char *src,
-                                unsigned char *dst,
-                                int src_width,
-                                int src_height,
-                                int dst_width,
-                                int dst_height)
+/* Mitchell-Netravali with B = C = 1/3. */
+static float filter_mitchell(float x)
 {
-  double ratiox = (double)(dst_width) / (double)(src_width);
-  double ratioy = (double)(dst_height) / (double)(src_height);
-  uintptr_t x_src, dx_dst, x_dst;
-  uintptr_t y_src, dy_dst, y_dst;
-  intptr_t y_counter;
-  unsigned char *dst_begin = dst;
-
-  struct scale_outpix_byte *dst_line1 = NULL;
-  struct scale_outpix_byte *dst_line2 = NULL;
-
-  dst_line1 = (struct scale_outpix_byte *)MEM_callocN(
-      (dst_width + 1) * sizeof(struct scale_outpix_byte), "shrink_picture_byte 1");
-  dst_line2 = (struct scale_outpix_byte *)MEM_callocN(
-      (dst_width + 1) * sizeof(struct scale_outpix_byte), "shrink_picture_byte 2");
-
-  dx_dst = 65536.0 * ratiox;
-  dy_dst = 65536.0 * ratioy;
-
-  y_dst = 0;
-  y_counter = 65536;
-  for (y_src = 0; y_src < src_height; y_src++) {
-    unsigned char *line = src + y_src * 4 * src_width;
-    uintptr_t weight1y = 65535 - (y_dst & 0xffff);
-    uintptr_t weight2y = 65535 - weight1y;
-    x_dst = 0;
-    for (x_src = 0; x_src < src_width; x_src++) {
-      uintptr_t weight1x = 65535 - (x_dst & 0xffff);
-      uintptr_t weight2x = 65535 - weight1x;
-
-      uintptr_t x = x_dst >> 16;
-
-      uintptr_t w;
-
-      w = (weight1y * weight1x) >> 16;
-
-      /* Ensure correct rounding, without this you get ugly banding,
-       * or too low color values (ton). */
-      dst_line1[x].r += (line[0] * w + 32767) >> 16;
-      dst_line1[x].g += (line[1] * w + 32767) >> 16;
-      dst_line1[x].b += (line[2] * w + 32767) >> 16;
-      dst_line1[x].a += (line[3] * w + 32767) >> 16;
-      dst_line1[x].weight += w;
-
-      w = (weight2y * weight1x) >> 16;
-
-      dst_line2[x].r += (line[0] * w + 32767) >> 16;
-      dst_line2[x].g += (line[1] * w + 32767) >> 16;
-      dst_line2[x].b += (line[2] * w + 32767) >> 16;
-      dst_line2[x].a += (line[3] * w + 32767) >> 16;
-      dst_line2[x].weight += w;
-
-      w = (weight1y * weight2x) >> 16;
-
-      dst_line1[x + 1].r += (line[0] * w + 32767) >> 16;
-      dst_line1[x + 1].g += (line[1] * w + 32767) >> 16;
-      dst_line1[x + 1].b += (line[2] * w + 32767) >> 16;
-      dst_line1[x + 1].a += (line[3] * w + 32767) >> 16;
-      dst_line1[x + 1].weight += w;
-
-      w = (weight2y * weight2x) >> 16;
-
-      dst_line2[x + 1].r += (line[0] * w + 32767) >> 16;
-      dst_line2[x + 1].g += (line[1] * w + 32767) >> 16;
-      dst_line2[x + 1].b += (line[2] * w + 32767) >> 16;
-      dst_line2[x + 1].a += (line[3] * w + 32767) >> 16;
-      dst_line2[x + 1].weight += w;
-
-      x_dst += dx_dst;
-      line += 4;
-    }
-
-    y_dst += dy_dst;
-    y_counter -= dy_dst;
-    if (y_counter < 0) {
-      int val;
-      uintptr_t x;
-      struct scale_outpix_byte *temp;
-
-      y_counter += 65536;
-
-      for (x = 0; x < dst_width; x++) {
-        uintptr_t f = 0x80000000UL / dst_line1[x].weight;
-        *dst++ = (val = (dst_line1[x].r * f) >> 15) > 255 ? 255 : val;
-        *dst++ = (val = (dst_line1[x].g * f) >> 15) > 255 ? 255 : val;
-        *dst++ = (val = (dst_line1[x].b * f) >> 15) > 255 ? 255 : val;
-        *dst++ = (val = (dst_line1[x].a * f) >> 15) > 255 ? 255 : val;
-      }
-      memset(dst_line1, 0, dst_width * sizeof(struct scale_outpix_byte));
-      temp = dst_line1;
-      dst_line1 = dst_line2;
-      dst_line2 = temp;
-    }
-  }
-  if (dst - dst_begin < dst_width * dst_height * 4) {
-    int val;
-    uintptr_t x;
-    for (x = 0; x < dst_width; x++) {
-      uintptr_t f = 0x80000000UL / dst_line1[x].weight;
-      *dst++ = (val = (dst_line1[x].r * f) >> 15) > 255 ? 255 : val;
-      *dst++ = (val = (dst_line1[x].g * f) >> 15) > 255 ? 255 : val;
-      *dst++ = (val = (dst_line1[x].b * f) >> 15) > 255 ? 255 : val;
-      *dst++ = (val = (dst_line1[x].a * f) >> 15) > 255 ? 255 : val;
-    }
-  }
-  MEM_freeN(dst_line1);
-  MEM_freeN(dst_line2);
+  const float b = 1.0f / 3.0f, c = 1.0f / 3.0f;
+  x = fabsf(x);
+  if (x < 1.0f) {
+    return ((12.0f - 9.0f * b - 6.0f * c) * x * x * x + (-18.0f + 12.0f * b + 6.0f * c) * x * x +
+            (6.0f - 2.0f * b)) /
+           6.0f;
+  }
+  if (x < 2.0f) {
+    return ((-b - 6.0f * c) * x * x * x + (6.0f * b + 30.0f * c) * x * x +
+            (-12.0f * b - 48.0f * c) * x + (8.0f * b + 24.0f * c)) /
+           6.0f;
+  }
+  return 0.0f;
 }
 
-static void q_scale_byte(unsigned char *in,
-                         unsigned char *out,
-                         int in_width,
-                         int in_height,
-                         int dst_width,
-                         int dst_height)
+static float sinc(float x)
 {
-  if (dst_width > in_width && dst_height > in_height) {
-    enlarge_picture_byte(in, out, in_width, in_height, dst_width, dst_height);
-  }
-  else if (dst_width < in_width && dst_height < in_height) {
-    shrink_picture_byte(in, out, in_width, in_height, dst_width, dst_height);
+  if (x == 0.0f) {
+    return 1.0f;
   }
+  x *= (float)M_PI;
+  return sinf(x) / x;
 }
 
-static void enlarge_picture_float(
-    float *src, float *dst, int src_width, int src_height, int dst_width, int dst_height)
+static float filter_lanczos(float x)
 {
-  double ratiox = (double)(dst_width - 1.0) / (double)(src_width - 1.001);
-  double ratioy = (double)(dst_height - 1.0) / (double)(src_height - 1.001);
-  uintptr_t x_dst;
-  uintptr_t y_dst;
-  double x_src, dx_src;
-  double y_src, dy_src;
-
-  dx_src = 1.0 / ratiox;
-  dy_src = 1.0 / ratioy;
-
-  y_src = 0;
-  for (y_dst = 0; y_dst < dst_height; y_dst++) {
-    float *line1 = src + ((int)y_src) * 4 * src_width;
-    const float *line2 = line1 + 4 * src_width;
-    const float weight1y = (float)(1.0 - (y_src - (int)y_src));
-    const float weight2y = 1.0f - weight1y;
-
-    if ((int)y_src == src_height - 1) {
-      line2 = line1;
-    }
-
-    x_src = 0;
-    for (x_dst = 0; x_dst < dst_width; x_dst++) {
-      const float weight1x = (float)(1.0 - (x_src - (int)x_src));
-      const float weight2x = (float)(1.0f - weight1x);
-
-      const float w11 = weight1y * weight1x;
-      const float w21 = weight2y * weight1x;
-      const float w12 = weight1y * weight2x;
-      const float w22 = weight2y * weight2x;
-
-      uintptr_t x = ((int)x_src) * 4;
-
-      *dst++ = line1[x] * w11 + line2[x] * w21 + line1[4 + x] * w12 + line2[4 + x] * w22;
-
-      *dst++ = line1[x + 1] * w11 + line2[x + 1] * w21 + line1[4 + x + 1] * w12 +
-               line2[4 + x + 1] * w22;
-
-      *dst++ = line1[x + 2] * w11 + line2[x + 2] * w21 + line1[4 + x + 2] * w12 +
-               line2[4 + x + 2] * w22;
-
-      *dst++ = line1[x + 3] * w11 + line2[x + 3] * w21 + line1[4 + x + 3] * w12 +
-               line2[4 + x + 3] * w22;
-
-      x_src += dx_src;
-    }
-    y_src += dy_src;
-  }
+  return (fabsf(x) < 3.0f) ? sinc(x) * sinc(x / 3.0f) : 0.0f;
 }
 
-struct scale_outpix_float {
-  float r;
-  float g;
-  float b;
-  float a;
-
-  float weight;
+/* Indexed by IMB_ScaleFilter. */
+static const ResampleFilter resample_filters[] = {
+    {NULL, 0.5f},
+    {filter_bilinear, 1.0f},
+    {filter_mitchell, 2.0f},
+    {filter_lanczos, 3.0f},
 };
 
-static void shrink_picture_float(
-    const float *src, float *dst, int src_width, int src_height, int dst_width, int dst_height)
+typedef struct ResampleWeights {
+  /* First source pixel and number of source pixels of every destination pixel. */
+  int *first;
+  int *num;
+  /* Weights of the source pixels, max_num for every destination pixel. */
+  float *weights;
+  int max_num;
+} ResampleWeights;
+
+static void resample_weights_init(ResampleWeights *r_weights,
+                                  int src_size,
+                                  int dst_size,
+                                  IMB_ScaleFilter filter)
 {
-  double ratiox = (double)(dst_width) / (double)(src_width);
-  double ratioy = (double)(dst_height) / (double)(src_height);
-  uintptr_t x_src;
-  uintptr_t y_src;
-  float dx_dst, x_dst;
-  float dy_dst, y_dst;
-  float y_counter;
-  const float *dst_begin = dst;
-
-  struct scale_outpix_float *dst_line1;
-  struct scale_outpix_float *dst_line2;
-
-  dst_line1 = (struct scale_outpix_float *)MEM_callocN(
-      (dst_width + 1) * sizeof(struct scale_outpix_float), "shrink_picture_float 1");
-  dst_line2 = (struct scale_outpix_float *)MEM_callocN(
-      (dst_width + 1) * sizeof(struct scale_outpix_float), "shrink_picture_float 2");
-
-  dx_dst = ratiox;
-  dy_dst = ratioy;
-
-  y_dst = 0;
-  y_counter = 1.0;
-  for (y_src = 0; y_src < src_height; y_src++) {
-    const float *line = src + y_src * 4 * src_width;
-    uintptr_t weight1y = 1.0f - (y_dst - (int)y_dst);
-    uintptr_t weight2y = 1.0f - weight1y;
-    x_dst = 0;
-    for (x_src = 0; x_src < src_width; x_src++) {
-      uintptr_t weight1x = 1.0f - (x_dst - (int)x_dst);
-      uintptr_t weight2x = 1.0f - weight1x;
-
-      uintptr_t x = (int)x_dst;
-
-      float w;
-
-      w = weight1y * weight1x;
-
-      dst_line1[x].r += line[0] * w;
-      dst_line1[x].g += line[1] * w;
-      dst_line1[x].b += line[2] * w;
-      dst_line1[x].a += line[3] * w;
-      dst_line1[x].weight += w;
-
-      w = weight2y * weight1x;
-
-      dst_line2[x].r += line[0] * w;
-      dst_line2[x].g += line[1] * w;
-      dst_line2[x].b += line[2] * w;
-      dst_line2[x].a += line[3] * w;
-      dst_line2[x].weight += w;
-
-      w = weight1y * weight2x;
-
-      dst_line1[x + 1].r += line[0] * w;
-      dst_line1[x + 1].g += line[1] * w;
-      dst_line1[x + 1].b += line[2] * w;
-      dst_line1[x + 1].a += line[3] * w;
-      dst_line1[x + 1].weight += w;
-
-      w = weight2y * weight2x;
-
-      dst_line2[x + 1].r += line[0] * w;
-      dst_line2[x + 1].g += line[1] * w;
-      dst_line2[x + 1].b += line[2] * w;
-      dst_line2[x + 1].a += line[3] * w;
-      dst_line2[x + 1].weight += w;
-
-      x_dst += dx_dst;
-      line += 4;
-    }
-
-    y_dst += dy_dst;
-    y_counter -= dy_dst;
-    if (y_counter < 0) {
-      uintptr_t x;
-      struct scale_outpix_float *temp;
-
-      y_counter += 1.0f;
-
-      for (x = 0; x < dst_width; x++) {
-        float f = 1.0f / dst_line1[x].weight;
-        *dst++ = dst_line1[x].r * f;
-        *dst++ = dst_line1[x].g * f;
-        *dst++ = dst_line1[x].b * f;
-        *dst++ = dst_line1[x].a * f;
+  const ResampleFilter *resample_filter = &resample_filters[filter];
+  const float scale = (float)src_size / (float)dst_size;
+  /* Kernels are stretched when scaling down, so all source pixels contribute. */
+  const float filter_scale = max_ff(scale, 1.0f);
+  const float support = resample_filter->support * filter_scale;
+
+  r_weights->max_num = 2 * (int)ceilf(support) + 2;
+  r_weights->first = MEM_mallocN(sizeof(int) * dst_size, "resample weights first");
+  r_weights->num = MEM_mallocN(sizeof(int) * dst_size, "resample weights num");
+  r_weights->weights = MEM_mallocN(sizeof(float) * dst_size * r_weights->max_num,
+                                   "resample weights");
+
+  for (int i = 0; i < dst_size; i++) {
+    /* Source pixel x covers [x, x + 1). */
+    const float center = (i + 0.5f) * scale;
+    const int first = max_ii((int)floorf(center - support), 0);
+    const int last = min_ii((int)ceilf(center + support), src_size);
+    float *weights = r_weights->weights + (size_t)i * r_weights->max_num;
+    float sum = 0.0f;
+    int num = 0;
+    int skip = 0;
+
+    for (int x = first; x < last && num < r_weights->max_num; x++) {
+      float weight;
+      if (resample_filter->kernel) {
+        weight = resample_filter->kernel((x + 0.5f - center) / filter_scale);
+      }
+      else {
+        const float min = center - 0.5f * scale, max = center + 0.5f * scale;
+        weight = max_ff(min_ff(x + 1.0f, max) - max_ff((float)x, min), 0.0f);
       }
-      memset(dst_line1, 0, dst_width * sizeof(struct scale_outpix_float));
-      temp = dst_line1;
-      dst_line1 = dst_line2;
-      dst_line2 = temp;
+      /* Leading zero weights are skipped. */
+      if (num == 0 && weight == 0.0f) {
+        skip++;
+        continue;
+      }
+      weights[num++] = weight;
+      sum += weight;
     }
-  }
-  if (dst - dst_begin < dst_width * dst_height * 4) {
-    uintptr_t x;
-    for (x = 0; x < dst_width; x++) {
-      float f = 1.0f / dst_line1[x].weight;
-      *dst++ = dst_line1[x].r * f;
-      *dst++ = dst_line1[x].g * f;
-      *dst++ = dst_line1[x].b * f;
-      *dst++ = dst_line1[x].a * f;
+    while (num > 0 && weights[num - 1] == 0.0f) {
+      num--;
     }
-  }
-  MEM_freeN(dst_line1);
-  MEM_freeN(dst_line2);
-}
 
-static void q_scale_float(
-    float *in, float *out, int in_width, int in_height, int dst_width, int dst_height)
-{
-  if (dst_width > in_width && dst_height > in_height) {
-    enlarge_picture_float(in, out, in_width, in_height, dst_width, dst_height);
-  }
-  else if (dst_width < in_width && dst_height < in_height) {
-    shrink_picture_float(in, out, in_width, in_height, dst_width, dst_height);
+    if (num == 0 || sum == 0.0f) {
+      /* Nearest source pixel. */
+      r_weights->first[i] = min_ii((int)center, src_size - 1);
+      r_weights->num[i] = 1;
+      weights[0] = 1.0f;
+      continue;
+    }
+
+    r_weights->first[i] = first + skip;
+    r_weights->num[i] = num;
+    for (int j = 0; j < num; j++) {
+      weights[j] /= sum;
+    }
   }
 }
 
-/**
- * q_scale_linear_interpolation (derived from ppmqscale, http://libdv.sf.net)
- *
- * q stands for quick _and_ quality :)
- *
- * only handles common cases when we either
- *
- * scale  both, x and y or
- * shrink both, x and y
- *
- * but that is pretty fast:
- * - does only blit once instead of two passes like the old code
- *   (fewer cache misses)
- * - uses fixed point integer arithmetic for byte buffers
- * - doesn't branch in tight loops
- *
- * Should be comparable in speed to the ImBuf ..._fast functions at least
- * for byte-buffers.
- *
- * NOTE: disabled, due to unacceptable inaccuracy and quality loss, see bug T18609 (ton)
- */
-static bool q_scale_linear_interpolation(struct ImBuf *ibuf, int newx, int newy)
+static void resample_weights_free(ResampleWeights *weights)
 {
-  if ((newx >= ibuf->x && newy <= ibuf->y) || (newx <= ibuf->x && newy >= ibuf->y)) {
-    return false;
-  }
-
-  if (ibuf->rect) {
-    unsigned char *newrect = MEM_mallocN(sizeof(int) * newx * newy, "q_scale rect");
-    q_scale_byte((unsigned char *)ibuf->rect, newrect, ibuf->x, ibuf->y, newx, newy);
-
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)newrect;
-  }
-  if (ibuf->rect_float) {
-    float *newrect = MEM_mallocN(sizeof(float[4]) * newx * newy, "q_scale rectfloat");
-    q_scale_float(ibuf->rect_float, newrect, ibuf->x, ibuf->y, newx, newy);
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = newrect;
-  }
-  ibuf->x = newx;
-  ibuf->y = newy;
-
-  return true;
+  MEM_freeN(weights->first);
+  MEM_freeN(weights->num);
+  MEM_freeN(weights->weights);
 }
 
-static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
+typedef struct ResampleData {
+  const ResampleWeights *weights;
+  /* Only one of the source and one of the destination buffers is set. */
+  const unsigned char *src_byte;
+  const float *src_float;
+  unsigned char *dst_byte;
+  float *dst_float;
+  int channels;
+  int src_width;
+  int dst_width;
+} ResampleData;
+
+/* Horizontal pass, from a source row to a float row. */
+static void resample_x_cb(void *__restrict userdata,
+                          const int y,
+                          const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  const int do_rect = (ibuf->rect != NULL);
-  const int do_float = (ibuf->rect_float != NULL);
-  const size_t rect_size = ibuf->x * ibuf->y * 4;
-
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y;
-
-  rectf = _newrectf = newrectf = NULL;
-  rect = _newrect = newrect = NULL;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
-
-  if (!do_rect && !do_float) {
-    return ibuf;
-  }
-
-  if (do_rect) {
-    _newrect = MEM_mallocN(sizeof(uchar[4]) * newx * ibuf->y, "scaledownx");
-    if (_newrect == NULL) {
-      return ibuf;
-    }
-  }
-  if (do_float) {
-    _newrectf = MEM_mallocN(sizeof(float[4]) * newx * ibuf->y, "scaledownxf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
+  const ResampleData *data = userdata;
+  const ResampleWeights *resample_weights = data->weights;
+  const int channels = data->channels;
+  float *dst = data->dst_float + (size_t)y * data->dst_width * channels;
+
+  for (int x = 0; x < data->dst_width; x++, dst += channels) {
+    const float *weights = resample_weights->weights + (size_t)x * resample_weights->max_num;
+    const int num = resample_weights->num[x];
+    const size_t offset = ((size_t)y * data->src_width + resample_weights->first[x]) * channels;
+
+    if (data->src_byte) {
+      const unsigned char *src = data->src_byte + offset;
+#ifdef __SSE2__
+      const __m128i zero = _mm_setzero_si128();
+      __m128 sum = _mm_setzero_ps();
+      for (int i = 0; i < num; i++, src += 4) {
+        int pixel;
+        memcpy(&pixel, src, sizeof(pixel));
+        const __m128i pixel_i = _mm_unpacklo_epi16(
+            _mm_unpacklo_epi8(_mm_cvtsi32_si128(pixel), zero), zero);
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_cvtepi32_ps(pixel_i), _mm_set1_ps(weights[i])));
       }
-      return ibuf;
-    }
-  }
-
-  add = (ibuf->x - 0.01) / newx;
-
-  if (do_rect) {
-    rect = (uchar *)ibuf->rect;
-    newrect = _newrect;
-  }
-  if (do_float) {
-    rectf = ibuf->rect_float;
-    newrectf = _newrectf;
-  }
-
-  for (y = ibuf->y; y > 0; y--) {
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-    for (x = newx; x > 0; x--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
-
-      sample += add;
-
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += 4;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += 4;
-        }
-      }
-
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += 4;
-
-        newrect[0] = roundf((nval[0] + sample * val[0]) / add);
-        newrect[1] = roundf((nval[1] + sample * val[1]) / add);
-        newrect[2] = roundf((nval[2] + sample * val[2]) / add);
-        newrect[3] = roundf((nval[3] + sample * val[3]) / add);
-
-        newrect += 4;
-      }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += 4;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-
-        newrectf += 4;
+      _mm_storeu_ps(dst, sum);
+#else
+      zero_v4(dst);
+      for (int i = 0; i < num; i++, src += 4) {
+        dst[0] += weights[i] * src[0];
+        dst[1] += weights[i] * src[1];
+        dst[2] += weights[i] * src[2];
+        dst[3] += weights[i] * src[3];
       }
-
-      sample -= 1.0f;
-    }
-  }
-
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-    BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug T26502. */
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-    BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug T26502. */
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = _newrectf;
-  }
-  (void)rect_size; /* UNUSED in release builds */
-
-  ibuf->x = newx;
-  return ibuf;
-}
-
-static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
-{
-  const int do_rect = (ibuf->rect != NULL);
-  const int do_float = (ibuf->rect_float != NULL);
-  const size_t rect_size = ibuf->x * ibuf->y * 4;
-
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y, skipx;
-
-  rectf = _newrectf = newrectf = NULL;
-  rect = _newrect = newrect = NULL;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
-
-  if (!do_rect && !do_float) {
-    return ibuf;
-  }
-
-  if (do_rect) {
-    _newrect = MEM_mallocN(sizeof(uchar[4]) * newy * ibuf->x, "scaledowny");
-    if (_newrect == NULL) {
-      return ibuf;
+#endif
     }
-  }
-  if (do_float) {
-    _newrectf = MEM_mallocN(sizeof(float[4]) * newy * ibuf->x, "scaledownyf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
+    else if (channels == 4) {
+      const float *src = data->src_float + offset;
+#ifdef __SSE2__
+      __m128 sum = _mm_setzero_ps();
+      for (int i = 0; i < num; i++, src += 4) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(src), _mm_set1_ps(weights[i])));
       }
-      return ibuf;
-    }
-  }
-
-  add = (ibuf->y - 0.01) / newy;
-  skipx = 4 * ibuf->x;
-
-  for (x = skipx - 4; x >= 0; x -= 4) {
-    if (do_rect) {
-      rect = ((uchar *)ibuf->rect) + x;
-      newrect = _newrect + x;
-    }
-    if (do_float) {
-      rectf = ibuf->rect_float + x;
-      newrectf = _newrectf + x;
-    }
-
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-    for (y = newy; y > 0; y--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
+      _mm_storeu_ps(dst, sum);
+#else
+      zero_v4(dst);
+      for (int i = 0; i < num; i++, src += 4) {
+        madd_v4_v4fl(dst, src, weights[i]);
       }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
+#endif
+    }
+    else {
+      const float *src = data->src_float + offset;
+      for (int c = 0; c < channels; c++) {
+        dst[c] = 0.0f;
       }
-
-      sample += add;
-
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += skipx;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += skipx;
+      for (int i = 0; i < num; i++, src += channels) {
+        for (int c = 0; c < channels; c++) {
+          dst[c] += weights[i] * src[c];
         }
       }
-
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += skipx;
-
-        newrect[0] = roundf((nval[0] + sample * val[0]) / add);
-        newrect[1] = roundf((nval[1] + sample * val[1]) / add);
-        newrect[2] = roundf((nval[2] + sample * val[2]) / add);
-        newrect[3] = roundf((nval[3] + sample * val[3]) / add);
-
-        newrect += skipx;
-      }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += skipx;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-
-        newrectf += skipx;
-      }
-
-      sample -= 1.0f;
     }
   }
-
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-    BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug T26502. */
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-    BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug T26502. */
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
-  }
-  (void)rect_size; /* UNUSED in release builds */
-
-  ibuf->y = newy;
-  return ibuf;
 }
 
-static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
+/* Vertical pass, from float rows to a destination row. Rows are weighted as a whole, so the
+ * inner loop runs over consecutive floats independent of the number of channels. */
+static void resample_y_cb(void *__restrict userdata,
+                          const int y,
+                          const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  uchar *rect, *_newrect = NULL, *newrect;
-  float *rectf, *_newrectf = NULL, *newrectf;
-  float sample, add;
-  float val_a, nval_a, diff_a;
-  float val_b, nval_b, diff_b;
-  float val_g, nval_g, diff_g;
-  float val_r, nval_r, diff_r;
-  float val_af, nval_af, diff_af;
-  float val_bf, nval_bf, diff_bf;
-  float val_gf, nval_gf, diff_gf;
-  float val_rf, nval_rf, diff_rf;
-  int x, y;
-  bool do_rect = false, do_float = false;
-
-  val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-  val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-  val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-  val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-  if (ibuf == NULL) {
-    return NULL;
-  }
-  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
-    return ibuf;
-  }
-
-  if (ibuf->rect) {
-    do_rect = true;
-    _newrect = MEM_mallocN(newx * ibuf->y * sizeof(int), "scaleupx");
-    if (_newrect == NULL) {
-      return ibuf;
+  const ResampleData *data = userdata;
+  const ResampleWeights *resample_weights = data->weights;
+  const float *weights = resample_weights->weights + (size_t)y * resample_weights->max_num;
+  const int num = resample_weights->num[y];
+  const size_t row_size = (size_t)data->dst_width * data->channels;
+  const float *src = data->src_float + resample_weights->first[y] * row_size;
+  size_t i = 0;
+
+#ifdef __SSE2__
+  for (; i + 4 <= row_size; i += 4) {
+    __m128 sum = _mm_setzero_ps();
+    for (int j = 0; j < num; j++) {
+      const __m128 value = _mm_loadu_ps(src + j * row_size + i);
+      sum = _mm_add_ps(sum, _mm_mul_ps(value, _mm_set1_ps(weights[j])));
     }
-  }
-  if (ibuf->rect_float) {
-    do_float = true;
-    _newrectf = MEM_mallocN(sizeof(float[4]) * newx * ibuf->y, "scaleupxf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
+    if (data->dst_byte) {
+      /* Rounded and clamped to bytes, four floats are one pixel. */
+      __m128i pixel = _mm_cvtps_epi32(sum);
+      pixel = _mm_packs_epi32(pixel, pixel);
+      pixel = _mm_packus_epi16(pixel, pixel);
+      const int value = _mm_cvtsi128_si32(pixel);
+      memcpy(data->dst_byte + y * row_size + i, &value, sizeof(value));
+    }
+    else {
+      _mm_storeu_ps(data->dst_float + y * row_size + i, sum);
     }
   }
+#endif
 
-  add = (ibuf->x - 1.001) / (newx - 1.0);
-
-  rect = (uchar *)ibuf->rect;
-  rectf = (float *)ibuf->rect_float;
-  newrect = _newrect;
-  newrectf = _newrectf;
-
-  for (y = ibuf->y; y > 0; y--) {
-
-    sample = 0;
-
-    if (do_rect) {
-      val_a = rect[0];
-      nval_a = rect[4];
-      diff_a = nval_a - val_a;
-      val_a += 0.5f;
-
-      val_b = rect[1];
-      nval_b = rect[5];
-      diff_b = nval_b - val_b;
-      val_b += 0.5f;
-
-      val_g = rect[2];
-      nval_g = rect[6];
-      diff_g = nval_g - val_g;
-      val_g += 0.5f;
-
-      val_r = rect[3];
-      nval_r = rect[7];
-      diff_r = nval_r - val_r;
-      val_r += 0.5f;
-
-      rect += 8;
+  for (; i < row_size; i++) {
+    float sum = 0.0f;
+    for (int j = 0; j < num; j++) {
+      sum += weights[j] * src[j * row_size + i];
     }
-    if (do_float) {
-      val_af = rectf[0];
-      nval_af = rectf[4];
-      diff_af = nval_af - val_af;
-
-      val_bf = rectf[1];
-      nval_bf = rectf[5];
-      diff_bf = nval_bf - val_bf;
-
-      val_gf = rectf[2];
-      nval_gf = rectf[6];
-      diff_gf = nval_gf - val_gf;
-
-      val_rf = rectf[3];
-      nval_rf = rectf[7];
-      diff_rf = nval_rf - val_rf;
-
-      rectf += 8;
+    if (data->dst_byte) {
+      data->dst_byte[y * row_size + i] = (uchar)(clamp_f(sum, 0.0f, 255.0f) + 0.5f);
     }
-    for (x = newx; x > 0; x--) {
-      if (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          val_a = nval_a;
-          nval_a = rect[0];
-          diff_a = nval_a - val_a;
-          val_a += 0.5f;
-
-          val_b = nval_b;
-          nval_b = rect[1];
-          diff_b = nval_b - val_b;
-          val_b += 0.5f;
-
-          val_g = nval_g;
-          nval_g = rect[2];
-          diff_g = nval_g - val_g;
-          val_g += 0.5f;
-
-          val_r = nval_r;
-          nval_r = rect[3];
-          diff_r = nval_r - val_r;
-          val_r += 0.5f;
-          rect += 4;
-        }
-        if (do_float) {
-          val_af = nval_af;
-          nval_af = rectf[0];
-          diff_af = nval_af - val_af;
-
-          val_bf = nval_bf;
-          nval_bf = rectf[1];
-          diff_bf = nval_bf - val_bf;
-
-          val_gf = nval_gf;
-          nval_gf = rectf[2];
-          diff_gf = nval_gf - val_gf;
-
-          val_rf = nval_rf;
-          nval_rf = rectf[3];
-          diff_rf = nval_rf - val_rf;
-          rectf += 4;
-        }
-      }
-      if (do_rect) {
-        newrect[0] = val_a + sample * diff_a;
-        newrect[1] = val_b + sample * diff_b;
-        newrect[2] = val_g + sample * diff_g;
-        newrect[3] = val_r + sample * diff_r;
-        newrect += 4;
-      }
-      if (do_float) {
-        newrectf[0] = val_af + sample * diff_af;
-        newrectf[1] = val_bf + sample * diff_bf;
-        newrectf[2] = val_gf + sample * diff_gf;
-        newrectf[3] = val_rf + sample * diff_rf;
-        newrectf += 4;
-      }
-      sample += add;
+    else {
+      data->dst_float[y * row_size + i] = sum;
     }
   }
-
-  if (do_rect) {
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
-  }
-
-  ibuf->x = newx;
-  return ibuf;
 }
 
-static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
+/* Returns a newly allocated buffer, src_byte or src_float is given and the result is of the same
+ * type. Byte buffers have four channels. */
+static void *resample_buffer(const unsigned char *src_byte,
+                             const float *src_float,
+                             int channels,
+                             int src_width,
+                             int src_height,
+                             int dst_width,
+                             int dst_height,
+                             IMB_ScaleFilter filter_x,
+                             IMB_ScaleFilter filter_y)
 {
-  uchar *rect, *_newrect = NULL, *newrect;
-  float *rectf, *_newrectf = NULL, *newrectf;
-  float sample, add;
-  float val_a, nval_a, diff_a;
-  float val_b, nval_b, diff_b;
-  float val_g, nval_g, diff_g;
-  float val_r, nval_r, diff_r;
-  float val_af, nval_af, diff_af;
-  float val_bf, nval_bf, diff_bf;
-  float val_gf, nval_gf, diff_gf;
-  float val_rf, nval_rf, diff_rf;
-  int x, y, skipx;
-  bool do_rect = false, do_float = false;
-
-  val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-  val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-  val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-  val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-  if (ibuf == NULL) {
-    return NULL;
-  }
-  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
-    return ibuf;
-  }
-
-  if (ibuf->rect) {
-    do_rect = true;
-    _newrect = MEM_mallocN(ibuf->x * newy * sizeof(int), "scaleupy");
-    if (_newrect == NULL) {
-      return ibuf;
-    }
-  }
-  if (ibuf->rect_float) {
-    do_float = true;
-    _newrectf = MEM_mallocN(sizeof(float[4]) * ibuf->x * newy, "scaleupyf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
-    }
-  }
-
-  add = (ibuf->y - 1.001) / (newy - 1.0);
-  skipx = 4 * ibuf->x;
-
-  rect = (uchar *)ibuf->rect;
-  rectf = (float *)ibuf->rect_float;
-  newrect = _newrect;
-  newrectf = _newrectf;
+  ResampleWeights weights_x, weights_y;
+  resample_weights_init(&weights_x, src_width, dst_width, filter_x);
+  resample_weights_init(&weights_y, src_height, dst_height, filter_y);
 
-  for (x = ibuf->x; x > 0; x--) {
-
-    sample = 0;
-    if (do_rect) {
-      rect = ((uchar *)ibuf->rect) + 4 * (x - 1);
-      newrect = _newrect + 4 * (x - 1);
-
-      val_a = rect[0];
-      nval_a = rect[skipx];
-      diff_a = nval_a - val_a;
-      val_a += 0.5f;
-
-      val_b = rect[1];
-      nval_b = rect[skipx + 1];
-      diff_b = nval_b - val_b;
-      val_b += 0.5f;
-
-      val_g = rect[2];
-      nval_g = rect[skipx + 2];
-      diff_g = nval_g - val_g;
-      val_g += 0.5f;
-
-      val_r = rect[3];
-      nval_r = rect[skipx + 3];
-      diff_r = nval_r - val_r;
-      val_r += 0.5f;
-
-      rect += 2 * skipx;
-    }
-    if (do_float) {
-      rectf = ibuf->rect_float + 4 * (x - 1);
-      newrectf = _newrectf + 4 * (x - 1);
-
-      val_af = rectf[0];
-      nval_af = rectf[skipx];
-      diff_af = nval_af - val_af;
-
-      val_bf = rectf[1];
-      nval_bf = rectf[skipx + 1];
-      diff_bf = nval_bf - val_bf;
-
-      val_gf = rectf[2];
-      nval_gf = rectf[skipx + 2];
-      diff_gf = nval_gf - val_gf;
-
-      val_rf = rectf[3];
-      nval_rf = rectf[skipx + 3];
-      diff_rf = nval_rf - val_rf;
-
-      rectf += 2 * skipx;
-    }
-
-    for (y = newy; y > 0; y--) {
-      if (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          val_a = nval_a;
-          nval_a = rect[0];
-          diff_a = nval_a - val_a;
-          val_a += 0.5f;
-
-          val_b = nval_b;
-          nval_b = rect[1];
-          diff_b = nval_b - val_b;
-          val_b += 0.5f;
-
-          val_g = nval_g;
-          nval_g = rect[2];
-          diff_g = nval_g - val_g;
-          val_g += 0.5f;
-
-          val_r = nval_r;
-          nval_r = rect[3];
-          diff_r = nval_r - val_r;
-          val_r += 0.5f;
-          rect += skipx;
-        }
-        if (do_float) {
-          val_af = nval_af;
-          nval_af = rectf[0];
-          diff_af = nval_af - val_af;
-
-          val_bf = nval_bf;
-          nval_bf = rectf[1];
-          diff_bf = nval_bf - val_bf;
-
-          val_gf = nval_gf;
-          nval_gf = rectf[2];
-          diff_gf = nval_gf - val_gf;
-
-          val_rf = nval_rf;
-          nval_rf = rectf[3];
-          diff_rf = nval_rf - val_rf;
-          rectf += skipx;
-        }
-      }
-      if (do_rect) {
-        newrect[0] = val_a + sample * diff_a;
-        newrect[1] = val_b + sample * diff_b;
-        newrect[2] = val_g + sample * diff_g;
-        newrect[3] = val_r + sample * diff_r;
-        newrect += skipx;
-      }
-      if (do_float) {
-        newrectf[0] = val_af + sample * diff_af;
-        newrectf[1] = val_bf + sample * diff_bf;
-        newrectf[2] = val_gf + sample * diff_gf;
-        newrectf[3] = val_rf + sample * diff_rf;
-        newrectf += skipx;
-      }
-      sample += add;
-    }
-  }
-
-  if (do_rect) {
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
+  float *rows = MEM_mallocN(sizeof(float) * channels * dst_width * src_height, "resample rows");
+  void *dst;
+  if (src_byte) {
+    dst = MEM_mallocN(sizeof(uchar) * channels * dst_width * dst_height, "resample byte");
   }
-
-  ibuf->y = newy;
-  return ibuf;
+  else {
+    dst = MEM_mallocN(sizeof(float) * channels * dst_width * dst_height, "resample float");
+  }
+
+  ResampleData data = {NULL};
+  data.channels = channels;
+  data.src_width = src_width;
+  data.dst_width = dst_width;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = ((size_t)dst_width * max_ii(src_height, dst_height) >=
+                            RESAMPLE_THREADING_MIN_PIXELS);
+  settings.min_iter_per_thread = 8;
+
+  data.weights = &weights_x;
+  data.src_byte = src_byte;
+  data.src_float = src_float;
+  data.dst_float = rows;
+  BLI_task_parallel_range(0, src_height, &data, resample_x_cb, &settings);
+
+  data.weights = &weights_y;
+  data.src_byte = NULL;
+  data.src_float = rows;
+  data.dst_byte = src_byte ? dst : NULL;
+  data.dst_float = src_byte ? NULL : dst;
+  BLI_task_parallel_range(0, dst_height, &data, resample_y_cb, &settings);
+
+  MEM_freeN(rows);
+  resample_weights_free(&weights_x);
+  resample_weights_free(&weights_y);
+
+  return dst;
 }
 
+/** \} */
+
 static void scalefast_Z_ImBuf(ImBuf *ibuf, int newx, int newy)
 {
   int *zbuf, *newzbuf, *_newzbuf = NULL;
@@ -1615,10 +882,11 @@ static void scalefast_Z_ImBuf(ImBuf *ibuf, int newx, int newy)
   }
 }
 
-/**
- * Return true if \a ibuf is modified.
- */
-bool IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy)
+static bool imb_scale_filter(ImBuf *ibuf,
+                             unsigned int newx,
+                             unsigned int newy,
+                             IMB_ScaleFilter filter_x,
+                             IMB_ScaleFilter filter_y)
 {
   if (ibuf == NULL) {
     return false;
@@ -1627,36 +895,83 @@ bool IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy)
     return false;
   }
 
+  /* Zero keeps the size of an axis. */
+  if (newx == 0) {
+    newx = ibuf->x;
+  }
+  if (newy == 0) {
+    newy = ibuf->y;
+  }
   if (newx == ibuf->x && newy == ibuf->y) {
     return false;
   }
 
-  /* Scale-up / scale-down functions below change ibuf->x and ibuf->y
-   * so we first scale the Z-buffer (if any). */
   scalefast_Z_ImBuf(ibuf, newx, newy);
 
-  /* try to scale common cases in a fast way */
-  /* disabled, quality loss is unacceptable, see report T18609  (ton) */
-  if (0 && q_scale_linear_interpolation(ibuf, newx, newy)) {
-    return true;
+  if (ibuf->rect) {
+    uchar *rect = resample_buffer((const uchar *)ibuf->rect,
+                                  NULL,
+                                  4,
+                                  ibuf->x,
+                                  ibuf->y,
+                                  newx,
+                                  newy,
+                                  filter_x,
+                                  filter_y);
+    imb_freerectImBuf(ibuf);
+    ibuf->mall |= IB_rect;
+    ibuf->rect = (unsigned int *)rect;
   }
 
-  if (newx && (newx < ibuf->x)) {
-    scaledownx(ibuf, newx);
-  }
-  if (newy && (newy < ibuf->y)) {
-    scaledowny(ibuf, newy);
-  }
-  if (newx && (newx > ibuf->x)) {
-    scaleupx(ibuf, newx);
-  }
-  if (newy && (newy > ibuf->y)) {
-    scaleupy(ibuf, newy);
+  if (ibuf->rect_float) {
+    float *rect_float = resample_buffer(NULL,
+                                        ibuf->rect_float,
+                                        ibuf->channels,
+                                        ibuf->x,
+                                        ibuf->y,
+                                        newx,
+                                        newy,
+                                        filter_x,
+                                        filter_y);
+    imb_freerectfloatImBuf(ibuf);
+    ibuf->mall |= IB_rectfloat;
+    ibuf->rect_float = rect_float;
   }
 
+  ibuf->x = newx;
+  ibuf->y = newy;
   return true;
 }
 
+/**
+ * Return true if \a ibuf is modified.
+ */
+bool IMB_scaleImBuf_filter(struct ImBuf *ibuf,
+                           unsigned int newx,
+                           unsigned int newy,
+                           IMB_ScaleFilter filter)
+{
+  return imb_scale_filter(ibuf, newx, newy, filter, filter);
+}
+
+/**
+ * Return true if \a ibuf is modified.
+ *
+ * Shrinking axes are filtered by the area of the source pixels, enlarging axes are interpolated
+ * bilinearly.
+ */
+bool IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy)
+{
+  if (ibuf == NULL) {
+    return false;
+  }
+  const IMB_ScaleFilter filter_x = (newx < ibuf->x) ? IMB_SCALE_FILTER_BOX :
+                                                      IMB_SCALE_FILTER_BILINEAR;
+  const IMB_ScaleFilter filter_y = (newy < ibuf->y) ? IMB_SCALE_FILTER_BOX :
+                                                      IMB_SCALE_FILTER_BILINEAR;
+  return imb_scale_filter(ibuf, newx, newy, filter_x, filter_y);
+}
+
 struct imbufRGBA {
   float r, g, b, a;
 };
@@ -1760,119 +1075,10 @@ bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy
   return true;
 }
 
-/* ******** threaded scaling ******** */
-
-typedef struct ScaleTreadInitData {
-  ImBuf *ibuf;
-
-  unsigned int newx;
-  unsigned int newy;
-
-  unsigned char *byte_buffer;
-  float *float_buffer;
-} ScaleTreadInitData;
-
-typedef struct ScaleThreadData {
-  ImBuf *ibuf;
-
-  unsigned int newx;
-  unsigned int newy;
-
-  int start_line;
-  int tot_line;
-
-  unsigned char *byte_buffer;
-  float *float_buffer;
-} ScaleThreadData;
-
-static void scale_thread_init(void *data_v, int start_line, int tot_line, void *init_data_v)
-{
-  ScaleThreadData *data = (ScaleThreadData *)data_v;
-  ScaleTreadInitData *init_data = (ScaleTreadInitData *)init_data_v;
-
-  data->ibuf = init_data->ibuf;
-
-  data->newx = init_data->newx;
-  data->newy = init_data->newy;
-
-  data->start_line = start_line;
-  data->tot_line = tot_line;
-
-  data->byte_buffer = init_data->byte_buffer;
-  data->float_buffer = init_data->float_buffer;
-}
-
-static void *do_scale_thread(void *data_v)
-{
-  ScaleThreadData *data = (ScaleThreadData *)data_v;
-  ImBuf *ibuf = data->ibuf;
-  int i;
-  float factor_x = (float)ibuf->x / data->newx;
-  float factor_y = (float)ibuf->y / data->newy;
-
-  for (i = 0; i < data->tot_line; i++) {
-    int y = data->start_line + i;
-    int x;
-
-    for (x = 0; x < data->newx; x++) {
-      float u = (float)x * factor_x;
-      float v = (float)y * factor_y;
-      int offset = y * data->newx + x;
-
-      if (data->byte_buffer) {
-        unsigned char *pixel = data->byte_buffer + 4 * offset;
-        BLI_bilinear_interpolation_char(
-            (unsigned char *)ibuf->rect, pixel, ibuf->x, ibuf->y, 4, u, v);
-      }
-
-      if (data->float_buffer) {
-        float *pixel = data->float_buffer + ibuf->channels * offset;
-        BLI_bilinear_interpolation_fl(
-            ibuf->rect_float, pixel, ibuf->x, ibuf->y, ibuf->channels, u, v);
-      }
-    }
-  }
-
-  return NULL;
-}
-
+/**
+ * Resampling is always threaded, kept for existing callers.
+ */
 void IMB_scaleImBuf_threaded(ImBuf *ibuf, unsigned int newx, unsigned int newy)
 {
-  ScaleTreadInitData init_data = {NULL};
-
-  /* prepare initialization data */
-  init_data.ibuf = ibuf;
-
-  init_data.newx = newx;
-  init_data.newy = newy;
-
-  if (ibuf->rect) {
-    init_data.byte_buffer = MEM_mallocN(4 * newx * newy * sizeof(char),
-                                        "threaded scale byte buffer");
-  }
-
-  if (ibuf->rect_float) {
-    init_data.float_buffer = MEM_mallocN(ibuf->channels * newx * newy * sizeof(float),
-                                         "threaded scale float buffer");
-  }
-
-  /* actual scaling threads */
-  IMB_processor_apply_threaded(
-      newy, sizeof(ScaleThreadData), &init_data, scale_thread_init, do_scale_thread);
-
-  /* alter image buffer */
-  ibuf->x = newx;
-  ibuf->y = newy;
-
-  if (ibuf->rect) {
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)init_data.byte_buffer;
-  }
-
-  if (ibuf->rect_float) {
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = init_data.float_buffer;
-  }
+  IMB_scaleImBuf(ibuf, newx, newy);
 }
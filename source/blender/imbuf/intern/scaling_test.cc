@@ -0,0 +1,134 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <math.h>
+
+#include "BLI_utildefines.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+static const char *filter_names[] = {"Box", "Bilinear", "Mitchell", "Lanczos"};
+
+/* Every pixel gets the color of the callback. */
+template<typename Fn> static ImBuf *image_create(int width, int height, int flags, Fn color_fn)
+{
+  ImBuf *ibuf = IMB_allocImBuf(width, height, 32, flags);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      const size_t offset = 4 * ((size_t)y * width + x);
+      for (int c = 0; c < 4; c++) {
+        const unsigned char value = color_fn(x, y, c);
+        if (ibuf->rect) {
+          ((unsigned char *)ibuf->rect)[offset + c] = value;
+        }
+        if (ibuf->rect_float) {
+          ibuf->rect_float[offset + c] = value / 255.0f;
+        }
+      }
+    }
+  }
+  return ibuf;
+}
+
+static ImBuf *image_create_constant(int width, int height, int flags)
+{
+  return image_create(
+      width, height, flags, [](int, int, int c) { return (unsigned char)(40 + 50 * c); });
+}
+
+/* Checker pattern, so the filters have edges to work on. */
+static ImBuf *image_create_checker(int width, int height, int flags)
+{
+  return image_create(width, height, flags, [](int x, int y, int c) {
+    const bool is_white = ((x / 16) + (y / 16)) % 2;
+    return (unsigned char)((is_white || c == 3) ? 255 : 0);
+  });
+}
+
+static ImBuf *image_create_noise(int width, int height, int flags)
+{
+  return image_create(width, height, flags, [](int x, int y, int c) {
+    return (unsigned char)((x * 37 + y * 101 + c * 59 + ((x * y) % 7) * 13) % 256);
+  });
+}
+
+/* Weights are normalized, so every filter keeps a constant image constant, when shrinking and
+ * when enlarging. */
+TEST(imbuf_scaling, ConstantStaysConstant)
+{
+  const int sizes[][2] = {{31, 23}, {200, 150}};
+  for (int filter = IMB_SCALE_FILTER_BOX; filter <= IMB_SCALE_FILTER_LANCZOS; filter++) {
+    for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+      ImBuf *ibuf = image_create_constant(97, 71, IB_rect | IB_rectfloat);
+      EXPECT_TRUE(IMB_scaleImBuf_filter(ibuf, sizes[i][0], sizes[i][1], (IMB_ScaleFilter)filter));
+      ASSERT_EQ(ibuf->x, sizes[i][0]);
+      ASSERT_EQ(ibuf->y, sizes[i][1]);
+
+      const unsigned char *rect = (const unsigned char *)ibuf->rect;
+      for (size_t p = 0; p < (size_t)ibuf->x * ibuf->y; p++) {
+        for (int c = 0; c < 4; c++) {
+          const unsigned char expected = 40 + 50 * c;
+          ASSERT_EQ(rect[4 * p + c], expected) << filter_names[filter];
+          ASSERT_NEAR(ibuf->rect_float[4 * p + c], expected / 255.0f, 1e-5f)
+              << filter_names[filter];
+        }
+      }
+      IMB_freeImBuf(ibuf);
+    }
+  }
+}
+
+/* Shrinking by two with the box filter averages blocks of 2x2 pixels. */
+TEST(imbuf_scaling, BoxHalfIsAverage)
+{
+  const int width = 64, height = 48;
+  ImBuf *source = image_create_noise(width, height, IB_rect | IB_rectfloat);
+  ImBuf *ibuf = IMB_dupImBuf(source);
+  EXPECT_TRUE(IMB_scaleImBuf_filter(ibuf, width / 2, height / 2, IMB_SCALE_FILTER_BOX));
+  ASSERT_EQ(ibuf->x, width / 2);
+  ASSERT_EQ(ibuf->y, height / 2);
+
+  const unsigned char *src_rect = (const unsigned char *)source->rect;
+  const unsigned char *rect = (const unsigned char *)ibuf->rect;
+  for (int y = 0; y < height / 2; y++) {
+    for (int x = 0; x < width / 2; x++) {
+      for (int c = 0; c < 4; c++) {
+        const size_t s00 = 4 * ((size_t)(2 * y) * width + 2 * x) + c;
+        const size_t s10 = s00 + 4, s01 = s00 + 4 * width, s11 = s01 + 4;
+        const size_t d = 4 * ((size_t)y * (width / 2) + x) + c;
+
+        const float byte_average = (src_rect[s00] + src_rect[s10] + src_rect[s01] +
+                                    src_rect[s11]) /
+                                   4.0f;
+        /* Halves may round either way. */
+        EXPECT_LE(fabsf(rect[d] - byte_average), 0.5f);
+
+        const float *src_float = source->rect_float;
+        const float float_average = (src_float[s00] + src_float[s10] + src_float[s01] +
+                                     src_float[s11]) /
+                                    4.0f;
+        EXPECT_NEAR(ibuf->rect_float[d], float_average, 1e-6f);
+      }
+    }
+  }
+
+  IMB_freeImBuf(ibuf);
+  IMB_freeImBuf(source);
+}
@@ -0,0 +1,102 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_appdir.h"
+#include "BKE_colortools.h"
+
+#include "DNA_color_types.h"
+
+#include "IMB_colormanagement.h"
+#include "IMB_imbuf.h"
+
+#include "PIL_time.h"
+
+#define NUM_RUN_AVERAGED 3
+
+/* Scene linear colors from dark to over exposed, with different hues per row. */
+static float *buffer_create(const int width, const int height)
+{
+  float *buffer = (float *)MEM_mallocN(sizeof(float[4]) * width * height, __func__);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      float *pixel = buffer + 4 * ((size_t)y * width + x);
+      const float value = exp2f(-10.0f + 14.0f * x / width);
+      pixel[0] = value;
+      pixel[1] = value * y / height;
+      pixel[2] = value * (height - y) / height;
+      pixel[3] = 1.0f;
+    }
+  }
+  return buffer;
+}
+
+static double apply_time_average(ColormanageProcessor *cm_processor,
+                                 const float *source,
+                                 float *buffer,
+                                 const int width,
+                                 const int height)
+{
+  double time = 0.0;
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    memcpy(buffer, source, sizeof(float[4]) * width * height);
+    const double start_time = PIL_check_seconds_timer();
+    IMB_colormanagement_processor_apply(cm_processor, buffer, width, height, 4, false);
+    time += PIL_check_seconds_timer() - start_time;
+  }
+  return time / NUM_RUN_AVERAGED;
+}
+
+static void time_view_transform(const char *view_transform, const int width, const int height)
+{
+  if (IMB_colormanagement_view_get_named_index(view_transform) == 0) {
+    printf("%s view transform not in the configuration, skipped\n", view_transform);
+    return;
+  }
+  ColorManagedViewSettings view_settings;
+  ColorManagedDisplaySettings display_settings;
+  BKE_color_managed_display_settings_init(&display_settings);
+  BKE_color_managed_view_settings_init_render(&view_settings, &display_settings, view_transform);
+
+  float *source = buffer_create(width, height);
+  float *buffer = (float *)MEM_mallocN(sizeof(float[4]) * width * height, __func__);
+
+  ColormanageProcessor *ocio_processor = IMB_colormanagement_display_processor_new(
+      &view_settings, &display_settings);
+  const double ocio_time = apply_time_average(ocio_processor, source, buffer, width, height);
+  IMB_colormanagement_processor_free(ocio_processor);
+
+  /* The first baked processor bakes the lookup table. */
+  const double bake_start_time = PIL_check_seconds_timer();
+  ColormanageProcessor *baked_processor = IMB_colormanagement_display_processor_new_baked(
+      &view_settings, &display_settings);
+  const double bake_time = PIL_check_seconds_timer() - bake_start_time;
+  const double baked_time = apply_time_average(baked_processor, source, buffer, width, height);
+  IMB_colormanagement_processor_free(baked_processor);
+
+  printf("%s display transform of a %dx%d image:\n", view_transform, width, height);
+  printf("\tOCIO: %fs on average over %d runs\n", ocio_time, NUM_RUN_AVERAGED);
+  printf("\tBaked: %fs on average over %d runs, %fs to bake\n",
+         baked_time,
+         NUM_RUN_AVERAGED,
+         bake_time);
+
+  MEM_freeN(source);
+  MEM_freeN(buffer);
+}
+
+TEST(colormanagement, DisplayTransform)
+{
+  BKE_appdir_init();
+  IMB_init();
+
+  time_view_transform("Standard", 1920, 1080);
+  time_view_transform("Filmic", 1920, 1080);
+
+  IMB_exit();
+}
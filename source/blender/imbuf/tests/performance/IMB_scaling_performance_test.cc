@@ -0,0 +1,69 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_utildefines.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "PIL_time.h"
+
+#define NUM_RUN_AVERAGED 3
+
+static const char *filter_names[] = {"Box", "Bilinear", "Mitchell", "Lanczos"};
+
+/* Checker pattern, so the filters have edges to work on. */
+static ImBuf *image_create_checker(int width, int height, int flags)
+{
+  ImBuf *ibuf = IMB_allocImBuf(width, height, 32, flags);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      const size_t offset = 4 * ((size_t)y * width + x);
+      const bool is_white = ((x / 16) + (y / 16)) % 2;
+      for (int c = 0; c < 4; c++) {
+        const unsigned char value = (is_white || c == 3) ? 255 : 0;
+        if (ibuf->rect) {
+          ((unsigned char *)ibuf->rect)[offset + c] = value;
+        }
+        if (ibuf->rect_float) {
+          ibuf->rect_float[offset + c] = value / 255.0f;
+        }
+      }
+    }
+  }
+  return ibuf;
+}
+
+static double scale_time_average(
+    int flags, int width, int height, int new_width, int new_height, IMB_ScaleFilter filter)
+{
+  double time = 0.0;
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    ImBuf *ibuf = image_create_checker(width, height, flags);
+    const double start_time = PIL_check_seconds_timer();
+    IMB_scaleImBuf_filter(ibuf, new_width, new_height, filter);
+    time += PIL_check_seconds_timer() - start_time;
+    IMB_freeImBuf(ibuf);
+  }
+  return time / NUM_RUN_AVERAGED;
+}
+
+static void time_filters(const char *name, int flags, int new_width, int new_height)
+{
+  const int width = 3840, height = 2160;
+  printf("%s %dx%d image scaled to %dx%d:\n", name, width, height, new_width, new_height);
+  for (int filter = IMB_SCALE_FILTER_BOX; filter <= IMB_SCALE_FILTER_LANCZOS; filter++) {
+    const double time = scale_time_average(
+        flags, width, height, new_width, new_height, (IMB_ScaleFilter)filter);
+    printf("\t%s: %fs on average over %d runs\n", filter_names[filter], time, NUM_RUN_AVERAGED);
+  }
+}
+
+TEST(imbuf_scaling, Filters)
+{
+  time_filters("Byte", IB_rect, 3840 / 4, 2160 / 4);
+  time_filters("Byte", IB_rect, 3840 * 5 / 4, 2160 * 5 / 4);
+  time_filters("Float", IB_rectfloat, 3840 / 4, 2160 / 4);
+  time_filters("Float", IB_rectfloat, 3840 * 5 / 4, 2160 * 5 / 4);
+}
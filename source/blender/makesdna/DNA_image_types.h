@@ -152,7 +152,8 @@ typedef struct Image {
   short gpu_pass;
   short gpu_layer;
   short gpu_slot;
-  char _pad2[4];
+  /** Incremented every time the image buffers are freed, for example on reload. */
+  int reload_counter;
 
   /** Deprecated. */
   struct PackedFile *packedfile DNA_DEPRECATED;
@@ -106,6 +106,9 @@ typedef struct Mesh_Runtime {
   /** Non-manifold boundary data for Shrinkwrap Target Project. */
   struct ShrinkwrapBoundaryData *shrinkwrap_data;
 
+  /** Topology data of split normals, kept across evaluations (see 'mesh_evaluate.c'). */
+  struct MLoopSplitCache *loop_split_cache;
+
   /** Set by modifier stack if only deformed from original. */
   char deformed_only;
   /**
@@ -125,7 +128,16 @@ typedef struct Mesh_Runtime {
    */
   char wrapper_type_finalize;
 
-  char _pad[4];
+  /**
+   * Vertex normals are known to match the current vertex coordinates.
+   *
+   * Unlike `cd_dirty_vert` this is conservative: it's only set when the normals are calculated
+   * and cleared on copy and whenever coordinates are written, so modifiers that depend on normals
+   * can skip calculating them when a previous one in the stack already did.
+   */
+  char vert_normals_valid;
+
+  char _pad[3];
 
   /** Needed in case we need to lazily initialize the mesh. */
   CustomData_MeshMasks cd_mask_extra;
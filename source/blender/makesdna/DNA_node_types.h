@@ -403,6 +403,10 @@ typedef struct bNodeLink {
 #define NTREE_QUALITY_MEDIUM 1
 #define NTREE_QUALITY_LOW 2
 
+/* tree->execution_mode */
+#define NTREE_EXECUTION_MODE_TILED 0
+#define NTREE_EXECUTION_MODE_FULL_FRAME 1
+
 /* tree->chunksize */
 #define NTREE_CHUNKSIZE_32 32
 #define NTREE_CHUNKSIZE_64 64
@@ -448,7 +452,9 @@ typedef struct bNodeTree {
   short is_updating;
   /** Generic temporary flag for recursion check (DFS/BFS). */
   short done;
-  char _pad2[4];
+  /** Execution mode of the compositor, see #NTREE_EXECUTION_MODE_TILED. */
+  short execution_mode;
+  char _pad2[2];
 
   /** Specific node type this tree is used for. */
   int nodetype DNA_DEPRECATED;
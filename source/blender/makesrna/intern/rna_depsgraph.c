@@ -252,6 +252,20 @@ static void rna_Depsgraph_debug_stats_gnuplot(Depsgraph *depsgraph,
   fclose(f);
 }
 
+static void rna_Depsgraph_debug_eval_trace_begin(Depsgraph *depsgraph)
+{
+  DEG_debug_eval_trace_begin(depsgraph);
+}
+
+static void rna_Depsgraph_debug_eval_trace_end(Depsgraph *depsgraph, const char *filename)
+{
+  FILE *f = fopen(filename, "w");
+  DEG_debug_eval_trace_end(depsgraph, f);
+  if (f != NULL) {
+    fclose(f);
+  }
+}
+
 static void rna_Depsgraph_debug_tag_update(Depsgraph *depsgraph)
 {
   DEG_graph_tag_relations_update(depsgraph);
@@ -667,6 +681,18 @@ static void rna_def_depsgraph(BlenderRNA *brna)
                                   "File name where gnuplot script will save the result");
   RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
 
+  func = RNA_def_function(
+      srna, "debug_eval_trace_begin", "rna_Depsgraph_debug_eval_trace_begin");
+  RNA_def_function_ui_description(
+      func, "Start recording the evaluated operations of every following evaluation");
+
+  func = RNA_def_function(srna, "debug_eval_trace_end", "rna_Depsgraph_debug_eval_trace_end");
+  RNA_def_function_ui_description(
+      func, "Stop recording evaluated operations and save them in the Chrome trace format");
+  parm = RNA_def_string_file_path(
+      func, "filename", NULL, FILE_MAX, "File Name", "Output path for the trace file");
+  RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
+
   func = RNA_def_function(srna, "debug_tag_update", "rna_Depsgraph_debug_tag_update");
 
   func = RNA_def_function(srna, "debug_stats", "rna_Depsgraph_debug_stats");
@@ -121,6 +121,20 @@ static const EnumPropertyItem node_quality_items[] = {
     {0, NULL, 0, NULL, NULL},
 };
 
+static const EnumPropertyItem node_execution_mode_items[] = {
+    {NTREE_EXECUTION_MODE_TILED,
+     "TILED",
+     0,
+     "Tiled",
+     "Compose the image in tiles, reading input pixels one at a time"},
+    {NTREE_EXECUTION_MODE_FULL_FRAME,
+     "FULL_FRAME",
+     0,
+     "Full Frame",
+     "Compose whole images one operation at a time, uses more memory"},
+    {0, NULL, 0, NULL, NULL},
+};
+
 static const EnumPropertyItem node_chunksize_items[] = {
     {NTREE_CHUNKSIZE_32, "32", 0, "32x32", "Chunksize of 32x32"},
     {NTREE_CHUNKSIZE_64, "64", 0, "64x64", "Chunksize of 64x64"},
@@ -9902,6 +9916,11 @@ static void rna_def_composite_nodetree(BlenderRNA *brna)
   RNA_def_property_enum_items(prop, node_quality_items);
   RNA_def_property_ui_text(prop, "Edit Quality", "Quality when editing");
 
+  prop = RNA_def_property(srna, "execution_mode", PROP_ENUM, PROP_NONE);
+  RNA_def_property_enum_sdna(prop, NULL, "execution_mode");
+  RNA_def_property_enum_items(prop, node_execution_mode_items);
+  RNA_def_property_ui_text(prop, "Execution Mode", "Set how compositing is executed");
+
   prop = RNA_def_property(srna, "chunk_size", PROP_ENUM, PROP_NONE);
   RNA_def_property_enum_sdna(prop, NULL, "chunksize");
   RNA_def_property_enum_items(prop, node_chunksize_items);
@@ -196,6 +196,8 @@ static const EnumPropertyItem rna_enum_userdef_viewport_aa_items[] = {
 
 #  include "BLI_path_util.h"
 
+#  include "IMB_imbuf.h"
+
 #  include "MEM_CacheLimiterC-Api.h"
 #  include "MEM_guardedalloc.h"
 
@@ -551,6 +553,8 @@ static void rna_Userdef_memcache_update(Main *UNUSED(bmain),
                                         PointerRNA *UNUSED(ptr))
 {
   MEM_CacheLimiter_set_maximum(((size_t)U.memcachelimit) * 1024 * 1024);
+  /* Decoded movie frames are kept in addition to the cache, use a quarter of its limit. */
+  IMB_anim_frame_ring_set_memory_limit(((size_t)U.memcachelimit) * 1024 * 1024 / 4);
   USERDEF_TAG_DIRTY;
 }
 
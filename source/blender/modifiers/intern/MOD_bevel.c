@@ -123,7 +123,9 @@ static Mesh *modifyMesh(ModifierData *md, const ModifierEvalContext *ctx, Mesh *
   const bool invert_vgroup = (bmd->flags & MOD_BEVEL_INVERT_VGROUP) != 0;
 
   bm = BKE_mesh_to_bmesh_ex(mesh,
-                            &(struct BMeshCreateParams){0},
+                            &(struct BMeshCreateParams){
+                                .use_eval_only = true,
+                            },
                             &(struct BMeshFromMeshParams){
                                 .calc_face_normal = true,
                                 .add_key_index = false,
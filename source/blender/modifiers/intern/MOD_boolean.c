@@ -248,6 +248,7 @@ static BMesh *BMD_mesh_bm_create(
   bm = BM_mesh_create(&allocsize,
                       &((struct BMeshCreateParams){
                           .use_toolflags = false,
+                          .use_eval_only = true,
                       }));
 
   BM_mesh_bm_from_me(bm,
@@ -452,6 +453,7 @@ static Mesh *collection_boolean_exact(BooleanModifierData *bmd,
   BMesh *bm = BM_mesh_create(&bat,
                              &((struct BMeshCreateParams){
                                  .use_toolflags = false,
+                                 .use_eval_only = true,
                              }));
   for (i = 0; i < num_shapes; i++) {
     Mesh *me = meshes[i];
@@ -172,7 +172,9 @@ static Mesh *modifyMesh(ModifierData *md, const ModifierEvalContext *ctx, Mesh *
   }
 
   bm = BKE_mesh_to_bmesh_ex(mesh,
-                            &(struct BMeshCreateParams){0},
+                            &(struct BMeshCreateParams){
+                                .use_eval_only = true,
+                            },
                             &(struct BMeshFromMeshParams){
                                 .calc_face_normal = calc_face_normal,
                                 .cd_mask_extra = {.vmask = CD_MASK_ORIGINDEX,
@@ -66,7 +66,9 @@ static Mesh *doEdgeSplit(Mesh *mesh, EdgeSplitModifierData *emd)
   const bool calc_face_normals = do_split_angle && !do_split_all;
 
   bm = BKE_mesh_to_bmesh_ex(mesh,
-                            &(struct BMeshCreateParams){0},
+                            &(struct BMeshCreateParams){
+                                .use_eval_only = true,
+                            },
                             &(struct BMeshFromMeshParams){
                                 .calc_face_normal = calc_face_normals,
                                 .add_key_index = false,
@@ -85,6 +85,8 @@ typedef struct SDefBindCalcData {
   const MLoop *const mloop;
   float (*const targetCos)[3];
   float (*const vertexCos)[3];
+  /* Nearest target triangle of each vertex. */
+  int *nearest_looptri;
   float imat[4][4];
   const float falloff;
   int success;
@@ -334,26 +336,18 @@ BLI_INLINE void sortPolyVertsTri(uint *indices,
   }
 }
 
-BLI_INLINE uint nearestVert(SDefBindCalcData *const data, const float point_co[3])
+BLI_INLINE uint nearestVert(SDefBindCalcData *const data,
+                            const float point_co[3],
+                            const int looptri_index)
 {
-  BVHTreeNearest nearest = {
-      .dist_sq = FLT_MAX,
-      .index = -1,
-  };
   const MPoly *poly;
   const MEdge *edge;
   const MLoop *loop;
-  float t_point[3];
   float max_dist = FLT_MAX;
   float dist;
   uint index = 0;
 
-  mul_v3_m4v3(t_point, data->imat, point_co);
-
-  BLI_bvhtree_find_nearest(
-      data->treeData->tree, t_point, &nearest, data->treeData->nearest_callback, data->treeData);
-
-  poly = &data->mpoly[data->looptri[nearest.index].poly];
+  poly = &data->mpoly[data->looptri[looptri_index].poly];
   loop = &data->mloop[poly->loopstart];
 
   for (int i = 0; i < poly->totloop; i++, loop++) {
@@ -436,9 +430,10 @@ BLI_INLINE float computeAngularWeight(const float point_angle, const float edgem
 }
 
 BLI_INLINE SDefBindWeightData *computeBindWeights(SDefBindCalcData *const data,
-                                                  const float point_co[3])
+                                                  const float point_co[3],
+                                                  const int index)
 {
-  const uint nearest = nearestVert(data, point_co);
+  const uint nearest = nearestVert(data, point_co, data->nearest_looptri[index]);
   const SDefAdjacency *const vert_edges = data->vert_edges[nearest].first;
   const SDefEdgePolys *const edge_polys = data->edge_polys;
 
@@ -844,7 +839,7 @@ static void bindVert(void *__restrict userdata,
   }
 
   copy_v3_v3(point_co, data->vertexCos[index]);
-  bwdata = computeBindWeights(data, point_co);
+  bwdata = computeBindWeights(data, point_co, index);
 
   if (bwdata == NULL) {
     sdvert->binds = NULL;
@@ -1111,8 +1106,32 @@ static bool surfacedeformBind(SurfaceDeformModifierData *smd_orig,
   TaskParallelSettings settings;
   BLI_parallel_range_settings_defaults(&settings);
   settings.use_threading = (numverts > 10000);
+
+  /* Search the nearest triangles of all vertices together, it's faster than one by one. */
+  float(*t_points)[3] = MEM_malloc_arrayN(numverts, sizeof(*t_points), __func__);
+  BVHTreeNearest *nearest = MEM_malloc_arrayN(numverts, sizeof(*nearest), __func__);
+  data.nearest_looptri = MEM_malloc_arrayN(numverts, sizeof(*data.nearest_looptri), __func__);
+  for (int i = 0; i < numverts; i++) {
+    mul_v3_m4v3(t_points[i], data.imat, vertexCos[i]);
+    nearest[i].index = -1;
+    nearest[i].dist_sq = FLT_MAX;
+  }
+  BLI_bvhtree_find_nearest_batch(treeData.tree,
+                                 (const float(*)[3])t_points,
+                                 (int)numverts,
+                                 nearest,
+                                 treeData.nearest_callback,
+                                 &treeData,
+                                 settings.use_threading ? BVH_NEAREST_USE_THREADING : 0);
+  for (int i = 0; i < numverts; i++) {
+    data.nearest_looptri[i] = nearest[i].index;
+  }
+  MEM_freeN(t_points);
+  MEM_freeN(nearest);
+
   BLI_task_parallel_range(0, numverts, &data, bindVert, &settings);
 
+  MEM_freeN(data.nearest_looptri);
   MEM_freeN(data.targetCos);
 
   if (data.success == MOD_SDEF_BIND_RESULT_MEM_ERR) {
@@ -71,7 +71,9 @@ static Mesh *triangulate_mesh(Mesh *mesh,
   }
 
   bm = BKE_mesh_to_bmesh_ex(mesh,
-                            &((struct BMeshCreateParams){0}),
+                            &((struct BMeshCreateParams){
+                                .use_eval_only = true,
+                            }),
                             &((struct BMeshFromMeshParams){
                                 .calc_face_normal = true,
                                 .cd_mask_extra = cd_mask_extra,
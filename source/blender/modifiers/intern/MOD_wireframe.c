@@ -79,7 +79,9 @@ static Mesh *WireframeModifier_do(WireframeModifierData *wmd, Object *ob, Mesh *
   const int defgrp_index = BKE_object_defgroup_name_index(ob, wmd->defgrp_name);
 
   bm = BKE_mesh_to_bmesh_ex(mesh,
-                            &(struct BMeshCreateParams){0},
+                            &(struct BMeshCreateParams){
+                                .use_eval_only = true,
+                            },
                             &(struct BMeshFromMeshParams){
                                 .calc_face_normal = true,
                                 .add_key_index = false,
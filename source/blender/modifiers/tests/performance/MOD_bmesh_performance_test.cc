@@ -0,0 +1,238 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+
+#include "BKE_collection.h"
+#include "BKE_customdata.h"
+#include "BKE_deform.h"
+#include "BKE_global.h"
+#include "BKE_idtype.h"
+#include "BKE_layer.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "BKE_object_deform.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "RNA_define.h"
+
+#include "PIL_time.h"
+
+#define GRID_SIZE 200
+#define NUM_GROUPS 4
+#define NUM_FRAMES 10
+
+static Mesh *mesh_add(Main *bmain, const char *name, const int verts_len, const int polys_len)
+{
+  Mesh *mesh = BKE_mesh_add(bmain, name);
+  mesh->totvert = verts_len;
+  mesh->totloop = polys_len * 4;
+  mesh->totpoly = polys_len;
+  CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, mesh->totvert);
+  CustomData_add_layer(&mesh->ldata, CD_MLOOP, CD_CALLOC, nullptr, mesh->totloop);
+  CustomData_add_layer(&mesh->pdata, CD_MPOLY, CD_CALLOC, nullptr, mesh->totpoly);
+  BKE_mesh_update_customdata_pointers(mesh, false);
+  for (int i = 0; i < polys_len; i++) {
+    mesh->mpoly[i].loopstart = i * 4;
+    mesh->mpoly[i].totloop = 4;
+  }
+  return mesh;
+}
+
+/* Grid of quads where every vertex is in a few vertex groups, like a rigged character. */
+static Mesh *grid_add(Main *bmain)
+{
+  const int verts_len = (GRID_SIZE + 1) * (GRID_SIZE + 1);
+  Mesh *mesh = mesh_add(bmain, "Grid", verts_len, GRID_SIZE * GRID_SIZE);
+
+  for (int y = 0; y <= GRID_SIZE; y++) {
+    for (int x = 0; x <= GRID_SIZE; x++) {
+      MVert *mv = &mesh->mvert[y * (GRID_SIZE + 1) + x];
+      mv->co[0] = x * 0.1f;
+      mv->co[1] = y * 0.1f;
+    }
+  }
+  for (int y = 0; y < GRID_SIZE; y++) {
+    for (int x = 0; x < GRID_SIZE; x++) {
+      const int v = y * (GRID_SIZE + 1) + x;
+      MLoop *ml = &mesh->mloop[(y * GRID_SIZE + x) * 4];
+      ml[0].v = v;
+      ml[1].v = v + 1;
+      ml[2].v = v + GRID_SIZE + 2;
+      ml[3].v = v + GRID_SIZE + 1;
+    }
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+
+  MDeformVert *dvert = (MDeformVert *)CustomData_add_layer(
+      &mesh->vdata, CD_MDEFORMVERT, CD_CALLOC, nullptr, verts_len);
+  for (int i = 0; i < verts_len; i++) {
+    for (int group = 0; group < NUM_GROUPS; group++) {
+      BKE_defvert_add_index_notest(&dvert[i], group, (float)(i % (group + 2)) / (group + 1));
+    }
+  }
+  BKE_mesh_update_customdata_pointers(mesh, false);
+  return mesh;
+}
+
+/* Cube in the middle of the grid, the operand of the boolean modifier. */
+static Mesh *cube_add(Main *bmain)
+{
+  static const int quads[6][4] = {
+      {0, 1, 3, 2}, {4, 6, 7, 5}, {0, 4, 5, 1}, {2, 3, 7, 6}, {0, 2, 6, 4}, {1, 5, 7, 3}};
+  Mesh *mesh = mesh_add(bmain, "Cube", 8, 6);
+
+  for (int i = 0; i < 8; i++) {
+    mesh->mvert[i].co[0] = GRID_SIZE * 0.05f + ((i & 1) ? 2.0f : -2.0f);
+    mesh->mvert[i].co[1] = GRID_SIZE * 0.05f + ((i & 2) ? 2.0f : -2.0f);
+    mesh->mvert[i].co[2] = (i & 4) ? 2.0f : -2.0f;
+  }
+  for (int i = 0; i < 6; i++) {
+    for (int j = 0; j < 4; j++) {
+      mesh->mloop[i * 4 + j].v = quads[i][j];
+    }
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+  return mesh;
+}
+
+static Object *object_add(Main *bmain, Scene *scene, Mesh *mesh)
+{
+  Object *ob = BKE_object_add_only_object(bmain, OB_MESH, mesh->id.name + 2);
+  ob->data = mesh;
+  BKE_collection_object_add(bmain, scene->master_collection, ob);
+  return ob;
+}
+
+static ModifierData *modifier_add(Object *ob, const ModifierType type)
+{
+  ModifierData *md = BKE_modifier_new(type);
+  BLI_addtail(&ob->modifiers, md);
+  return md;
+}
+
+/* The grid is animated by a wave modifier in front of the BMesh based modifier, the wave
+ * modifier behind it uses a vertex group, so the weights go through the BMesh as well. */
+static double frame_time_average(const ModifierType type, const bool use_eval_only)
+{
+  Main *bmain = BKE_main_new();
+  Scene *scene = BKE_scene_add(bmain, "Scene");
+  Object *ob = object_add(bmain, scene, grid_add(bmain));
+  for (int group = 0; group < NUM_GROUPS; group++) {
+    char name[MAX_VGROUP_NAME];
+    BLI_snprintf(name, sizeof(name), "Group.%d", group);
+    BKE_object_defgroup_add_name(ob, name);
+  }
+
+  modifier_add(ob, eModifierType_Wave);
+  ModifierData *md = modifier_add(ob, type);
+  WaveModifierData *wmd = (WaveModifierData *)modifier_add(ob, eModifierType_Wave);
+  STRNCPY(wmd->defgrp_name, ((bDeformGroup *)ob->defbase.first)->name);
+
+  switch (type) {
+    case eModifierType_Bevel:
+      ((BevelModifierData *)md)->lim_flags = 0;
+      break;
+    case eModifierType_Decimate:
+      ((DecimateModifierData *)md)->percent = 0.5f;
+      break;
+    case eModifierType_Boolean: {
+      BooleanModifierData *bmd = (BooleanModifierData *)md;
+      bmd->object = object_add(bmain, scene, cube_add(bmain));
+      /* The exact solver depends on GMP. */
+      bmd->solver = eBooleanModifierSolver_Fast;
+      break;
+    }
+    default:
+      break;
+  }
+
+  if (use_eval_only) {
+    G.debug &= ~G_DEBUG_BMESH_NO_EVAL_ONLY;
+  }
+  else {
+    G.debug |= G_DEBUG_BMESH_NO_EVAL_ONLY;
+  }
+
+  Depsgraph *depsgraph = DEG_graph_new(
+      bmain, scene, BKE_view_layer_default_view(scene), DAG_EVAL_VIEWPORT);
+  DEG_graph_build_from_view_layer(depsgraph);
+  /* The first evaluation also copies every data-block, don't count it. */
+  DEG_evaluate_on_refresh(depsgraph);
+
+  const double start_time = PIL_check_seconds_timer();
+  for (int frame = 2; frame < NUM_FRAMES + 2; frame++) {
+    BKE_scene_frame_set(scene, frame);
+    DEG_evaluate_on_framechange(depsgraph, BKE_scene_frame_get(scene));
+  }
+  const double time = (PIL_check_seconds_timer() - start_time) / NUM_FRAMES;
+
+  G.debug &= ~G_DEBUG_BMESH_NO_EVAL_ONLY;
+  DEG_graph_free(depsgraph);
+  BKE_main_free(bmain);
+  return time;
+}
+
+static void frame_time_print(const char *name, const ModifierType type)
+{
+  const double full_time = frame_time_average(type, false);
+  const double eval_only_time = frame_time_average(type, true);
+
+  printf("%s modifier on an animated %dx%d grid with %d vertex groups:\n",
+         name,
+         GRID_SIZE,
+         GRID_SIZE,
+         NUM_GROUPS);
+  printf("\tFull: %fs per frame on average over %d frames\n", full_time, NUM_FRAMES);
+  printf("\tEval only: %fs per frame on average over %d frames\n", eval_only_time, NUM_FRAMES);
+}
+
+class ModifierBMeshTest : public testing::Test {
+ public:
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+    BKE_modifier_init();
+    RNA_init();
+    DEG_register_node_types();
+  }
+
+  static void TearDownTestCase()
+  {
+    DEG_free_node_types();
+    RNA_exit();
+  }
+};
+
+TEST_F(ModifierBMeshTest, Bevel)
+{
+  frame_time_print("Bevel", eModifierType_Bevel);
+}
+
+TEST_F(ModifierBMeshTest, Triangulate)
+{
+  frame_time_print("Triangulate", eModifierType_Triangulate);
+}
+
+TEST_F(ModifierBMeshTest, Decimate)
+{
+  frame_time_print("Decimate", eModifierType_Decimate);
+}
+
+TEST_F(ModifierBMeshTest, Boolean)
+{
+  frame_time_print("Boolean", eModifierType_Boolean);
+}
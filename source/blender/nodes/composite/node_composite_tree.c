@@ -322,6 +322,17 @@ void ntreeCompositTagRender(Scene *scene)
       }
     }
   }
+
+  /* Cached results may depend on the previous render result. */
+  ntreeCompositClearCaches();
+}
+
+/* Free results of previous executions that are kept for re-execution. */
+void ntreeCompositClearCaches(void)
+{
+#ifdef WITH_COMPOSITOR
+  COM_clearCaches();
+#endif
 }
 
 /* XXX after render animation system gets a refresh, this call allows composite to end clean */
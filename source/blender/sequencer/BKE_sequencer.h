@@ -90,9 +90,14 @@ void BKE_sequence_iterator_end(SeqIterator *iter);
 
 #define SEQ_CURRENT_END SEQ_ALL_END
 
+/* Maximum number of frames rendered by prefetch at once. */
+#define SEQ_PREFETCH_LANES_MAX 8
+
 typedef enum eSeqTaskId {
   SEQ_TASK_MAIN_RENDER,
+  /* Each prefetch lane uses its own ID, starting with this one. */
   SEQ_TASK_PREFETCH_RENDER,
+  SEQ_TASK_PREFETCH_RENDER_LAST = SEQ_TASK_PREFETCH_RENDER + SEQ_PREFETCH_LANES_MAX - 1,
 } eSeqTaskId;
 
 typedef struct SeqRenderData {
@@ -331,6 +336,20 @@ void BKE_sequencer_proxy_set(struct Sequence *seq, bool value);
 
 #define SEQ_CACHE_COST_MAX 10.0f
 
+/* Cache lookup statistics. Lookup falls through tiers in order raw, compressed, disk.
+ * Disk cache lookups are only counted when disk cache is enabled. */
+typedef struct SeqCacheStats {
+  uint64_t raw_hits;
+  uint64_t raw_misses;
+  uint64_t compressed_hits;
+  uint64_t compressed_misses;
+  uint64_t disk_hits;
+  uint64_t disk_misses;
+  /* Memory used by all cached images and by compressed images only, in bytes. */
+  size_t memory_used;
+  size_t memory_compressed;
+} SeqCacheStats;
+
 struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context,
                                       struct Sequence *seq,
                                       float cfra,
@@ -369,6 +388,8 @@ void BKE_sequencer_cache_iterate(struct Scene *scene,
                                                     int cache_type,
                                                     float cost));
 bool BKE_sequencer_cache_is_full(struct Scene *scene);
+void BKE_sequencer_cache_stats_get(struct Scene *scene, SeqCacheStats *r_stats);
+void BKE_sequencer_cache_stats_reset(struct Scene *scene);
 
 /* **********************************************************************
  * seqprefetch.c
@@ -383,6 +404,7 @@ void BKE_sequencer_prefetch_free(struct Scene *scene);
 bool BKE_sequencer_prefetch_need_redraw(struct Main *bmain, struct Scene *scene);
 bool BKE_sequencer_prefetch_job_is_running(struct Scene *scene);
 void BKE_sequencer_prefetch_get_time_range(struct Scene *scene, int *start, int *end);
+float BKE_sequencer_prefetch_fps_get(struct Scene *scene);
 SeqRenderData *BKE_sequencer_prefetch_get_original_context(const SeqRenderData *context);
 struct Sequence *BKE_sequencer_prefetch_get_original_sequence(struct Sequence *seq,
                                                               struct Scene *scene);
@@ -20,10 +20,17 @@
  * \ingroup bke
  */
 
+#include <fcntl.h> /* for open flags (O_BINARY, O_RDONLY). */
 #include <memory.h>
 #include <stddef.h>
 #include <time.h>
 
+#ifndef WIN32
+#  include <unistd.h> /* for close */
+#else
+#  include <io.h> /* for close */
+#endif
+
 #include "MEM_guardedalloc.h"
 
 #include "DNA_scene_types.h"
@@ -41,7 +48,9 @@
 #include "BLI_ghash.h"
 #include "BLI_listbase.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
 #include "BLI_path_util.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BKE_global.h"
@@ -49,6 +58,17 @@
 #include "BKE_scene.h"
 #include "BKE_sequencer.h"
 
+#ifdef WITH_LZO
+#  ifdef WITH_SYSTEM_LZO
+#    include <lzo/lzo1x.h>
+#  else
+#    include "minilzo.h"
+#  endif
+#  define LZO_OUT_LEN(size) ((size) + (size) / 16 + 64 + 3)
+#endif
+
+#include "zlib.h"
+
 /**
  * Sequencer Cache Design Notes
  * ============================
@@ -73,6 +93,12 @@
  *
  * User can exclude caching of some images. Such entries will have is_temp_cache set.
  *
+ * Tiers: When the cache is full, the frame chosen for recycling is first compressed in RAM
+ * (#SEQ_CACHE_TIER_COMPRESSED) and only freed when it is chosen again. Compressed images are
+ * split into #SEQ_CACHE_CHUNK_SIZE blocks, which are compressed and decompressed in parallel.
+ * Lookups of compressed images return a new decompressed #ImBuf, the item stays compressed.
+ * Hits and misses of each tier, including the disk cache, are counted in #SeqCacheStats.
+ *
  *
  * Disk Cache Design Notes
  * =======================
@@ -81,7 +107,11 @@
  * For each cached non-temp image, image data and supplementary info are written to HDD.
  * Multiple(DCACHE_IMAGES_PER_FILE) images share the same file.
  * Each of these files contains header DiskCacheHeader followed by image data.
- * Zlib compression with user definable level can be used to compress image data(per image)
+ * Image data is stored as a table of chunk sizes followed by the chunks, in the same format
+ * as images in the compressed RAM tier. Depending on the compression level in user preferences,
+ * chunks are stored as is, LZO compressed (low) or zlib compressed (high). The codec is stored in
+ * the header entry of each image.
+ * Files are written by a background task pool and read through memory-mapped IO.
  * Images are written in order in which they are rendered.
  * Overwriting of individual entry is not possible.
  * Stored images are deleted by invalidation, or when size of all files exceeds maximum
@@ -94,11 +124,16 @@
 /* <cache type>-<resolution X>x<resolution Y>-<rendersize>%(<view_id>)-<frame no>.dcf */
 #define DCACHE_FNAME_FORMAT "%d-%dx%d-%d%%(%d)-%d.dcf"
 #define DCACHE_IMAGES_PER_FILE 100
-#define DCACHE_CURRENT_VERSION 1
+#define DCACHE_CURRENT_VERSION 3
 #define COLORSPACE_NAME_MAX 64 /* XXX: defined in imb intern */
 
+/* Image data is compressed in blocks of this size, so single frame can be split between
+ * threads. */
+#define SEQ_CACHE_CHUNK_SIZE (256 * 1024)
+
 typedef struct DiskCacheHeaderEntry {
   unsigned char encoding;
+  unsigned char codec; /* eSeqCacheCodec */
   uint64_t frameno;
   uint64_t size_compressed;
   uint64_t size_raw;
@@ -116,6 +151,8 @@ typedef struct SeqDiskCache {
   ListBase files;
   ThreadMutex read_write_mutex;
   size_t size_total;
+  /* Files are written in background, so rendering doesn't wait for compression and IO. */
+  TaskPool *write_pool;
 } SeqDiskCache;
 
 typedef struct DiskCacheFile {
@@ -140,12 +177,51 @@ typedef struct SeqCache {
   struct BLI_mempool *items_pool;
   struct SeqCacheKey *last_key;
   size_t memory_used;
+  /* Part of memory_used taken by compressed images. */
+  size_t memory_compressed;
   SeqDiskCache *disk_cache;
+  SeqCacheStats stats;
 } SeqCache;
 
+typedef enum eSeqCacheTier {
+  /* Image is stored as it was rendered. */
+  SEQ_CACHE_TIER_RAW = 0,
+  /* Image was chosen for recycling and is stored compressed. */
+  SEQ_CACHE_TIER_COMPRESSED = 1,
+} eSeqCacheTier;
+
+typedef enum eSeqCacheCodec {
+  /* Chunks are stored as is. */
+  SEQ_CACHE_CODEC_NONE = 0,
+  /* Fast compression, used by the RAM tier and low disk cache compression. */
+  SEQ_CACHE_CODEC_LZO = 1,
+  /* Better ratio at higher CPU cost, used by high disk cache compression. */
+  SEQ_CACHE_CODEC_ZLIB = 2,
+} eSeqCacheCodec;
+
+typedef struct SeqCacheChunk {
+  void *data;
+  /* Equal to raw size of chunk if data is not compressed. */
+  size_t size;
+} SeqCacheChunk;
+
+typedef struct SeqCacheCompressedImBuf {
+  int x, y;
+  unsigned char planes;
+  bool is_float;
+  char colorspace_name[COLORSPACE_NAME_MAX];
+  size_t size_raw;
+  size_t size_compressed;
+  int chunks_num;
+  SeqCacheChunk *chunks;
+} SeqCacheCompressedImBuf;
+
 typedef struct SeqCacheItem {
   struct SeqCache *cache_owner;
   struct ImBuf *ibuf;
+  /* Used instead of ibuf when image data could be compressed. */
+  struct SeqCacheCompressedImBuf *cbuf;
+  eSeqCacheTier tier;
 } SeqCacheItem;
 
 typedef struct SeqCacheKey {
@@ -167,23 +243,291 @@ static ThreadMutex cache_create_lock = BLI_MUTEX_INITIALIZER;
 static float seq_cache_cfra_to_frame_index(Sequence *seq, float cfra);
 static float seq_cache_frame_index_to_cfra(Sequence *seq, float nfra);
 
+/* ************************* Compressed Storage **************************** */
+
+typedef struct SeqCacheChunkData {
+  SeqCacheChunk *chunks;
+  unsigned char *raw;
+  size_t size_raw;
+  eSeqCacheCodec codec;
+  bool error;
+} SeqCacheChunkData;
+
+typedef struct SeqCacheChunkTLS {
+  void *wrkmem;
+} SeqCacheChunkTLS;
+
+static int seq_cache_chunks_num(size_t size_raw)
+{
+  return (int)((size_raw + SEQ_CACHE_CHUNK_SIZE - 1) / SEQ_CACHE_CHUNK_SIZE);
+}
+
+static size_t seq_cache_chunk_size_raw(size_t size_raw, int chunk_index)
+{
+  const size_t offset = (size_t)chunk_index * SEQ_CACHE_CHUNK_SIZE;
+  return MIN2(size_raw - offset, SEQ_CACHE_CHUNK_SIZE);
+}
+
+static void seq_cache_chunk_compress_cb(void *__restrict userdata,
+                                        const int chunk_index,
+                                        const TaskParallelTLS *__restrict tls)
+{
+  SeqCacheChunkData *data = userdata;
+  SeqCacheChunk *chunk = &data->chunks[chunk_index];
+  const unsigned char *in = data->raw + (size_t)chunk_index * SEQ_CACHE_CHUNK_SIZE;
+  const size_t in_len = seq_cache_chunk_size_raw(data->size_raw, chunk_index);
+
+  if (data->codec == SEQ_CACHE_CODEC_ZLIB) {
+    uLongf out_len = compressBound((uLong)in_len);
+    unsigned char *out = MEM_mallocN(out_len, "SeqCacheChunk");
+    int r = compress2(out, &out_len, in, (uLong)in_len, Z_BEST_COMPRESSION);
+
+    if (r == Z_OK && out_len < in_len) {
+      chunk->data = MEM_reallocN(out, out_len);
+      chunk->size = out_len;
+      return;
+    }
+    MEM_freeN(out);
+  }
+
+#ifdef WITH_LZO
+  if (data->codec == SEQ_CACHE_CODEC_LZO) {
+    SeqCacheChunkTLS *tls_data = tls->userdata_chunk;
+    if (tls_data->wrkmem == NULL) {
+      tls_data->wrkmem = MEM_mallocN(LZO1X_MEM_COMPRESS, "SeqCacheChunk wrkmem");
+    }
+
+    lzo_uint out_len = LZO_OUT_LEN(in_len);
+    unsigned char *out = MEM_mallocN(out_len, "SeqCacheChunk");
+    int r = lzo1x_1_compress(in, (lzo_uint)in_len, out, &out_len, tls_data->wrkmem);
+
+    if (r == LZO_E_OK && out_len < in_len) {
+      chunk->data = MEM_reallocN(out, out_len);
+      chunk->size = out_len;
+      return;
+    }
+    MEM_freeN(out);
+  }
+#else
+  UNUSED_VARS(tls);
+#endif
+
+  /* Store incompressible data as is. */
+  chunk->data = MEM_mallocN(in_len, "SeqCacheChunk");
+  chunk->size = in_len;
+  memcpy(chunk->data, in, in_len);
+}
+
+static void seq_cache_chunk_compress_free(const void *__restrict UNUSED(userdata),
+                                          void *__restrict chunk)
+{
+  SeqCacheChunkTLS *tls_data = chunk;
+  if (tls_data->wrkmem) {
+    MEM_freeN(tls_data->wrkmem);
+  }
+}
+
+static void seq_cache_chunk_decompress_cb(void *__restrict userdata,
+                                          const int chunk_index,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SeqCacheChunkData *data = userdata;
+  const SeqCacheChunk *chunk = &data->chunks[chunk_index];
+  unsigned char *out = data->raw + (size_t)chunk_index * SEQ_CACHE_CHUNK_SIZE;
+  const size_t out_len = seq_cache_chunk_size_raw(data->size_raw, chunk_index);
+
+  if (chunk->size == out_len) {
+    memcpy(out, chunk->data, out_len);
+    return;
+  }
+
+  if (data->codec == SEQ_CACHE_CODEC_ZLIB) {
+    uLongf r_len = out_len;
+    int r = uncompress(out, &r_len, chunk->data, (uLong)chunk->size);
+    if (r == Z_OK && r_len == out_len) {
+      return;
+    }
+  }
+
+#ifdef WITH_LZO
+  if (data->codec == SEQ_CACHE_CODEC_LZO) {
+    lzo_uint r_len = out_len;
+    int r = lzo1x_decompress_safe(chunk->data, (lzo_uint)chunk->size, out, &r_len, NULL);
+    if (r == LZO_E_OK && r_len == out_len) {
+      return;
+    }
+  }
+#endif
+
+  data->error = true;
+}
+
+/* Split raw data to chunks and compress them in parallel.
+ * Returns array of seq_cache_chunks_num(size_raw) chunks. */
+static SeqCacheChunk *seq_cache_chunks_compress(const void *raw,
+                                                size_t size_raw,
+                                                eSeqCacheCodec codec,
+                                                size_t *r_size_compressed)
+{
+  const int chunks_num = seq_cache_chunks_num(size_raw);
+  SeqCacheChunkData data = {
+      .chunks = MEM_mallocN(sizeof(SeqCacheChunk) * chunks_num, "SeqCacheChunks"),
+      .raw = (unsigned char *)raw,
+      .size_raw = size_raw,
+      .codec = codec,
+  };
+  SeqCacheChunkTLS tls_data = {NULL};
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  settings.userdata_chunk = &tls_data;
+  settings.userdata_chunk_size = sizeof(tls_data);
+  settings.func_free = seq_cache_chunk_compress_free;
+  BLI_task_parallel_range(0, chunks_num, &data, seq_cache_chunk_compress_cb, &settings);
+
+  size_t size_compressed = 0;
+  for (int i = 0; i < chunks_num; i++) {
+    size_compressed += data.chunks[i].size;
+  }
+  *r_size_compressed = size_compressed;
+
+  return data.chunks;
+}
+
+/* Decompress chunks in parallel, returns false if data is corrupted. */
+static bool seq_cache_chunks_decompress(SeqCacheChunk *chunks,
+                                        void *raw,
+                                        size_t size_raw,
+                                        eSeqCacheCodec codec)
+{
+  SeqCacheChunkData data = {
+      .chunks = chunks,
+      .raw = raw,
+      .size_raw = size_raw,
+      .codec = codec,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(
+      0, seq_cache_chunks_num(size_raw), &data, seq_cache_chunk_decompress_cb, &settings);
+
+  return !data.error;
+}
+
+static void seq_cache_chunks_free(SeqCacheChunk *chunks, int chunks_num)
+{
+  for (int i = 0; i < chunks_num; i++) {
+    MEM_freeN(chunks[i].data);
+  }
+  MEM_freeN(chunks);
+}
+
+/* Images with both buffers are stored as float, the byte buffer is only derived from it (e.g.
+ * for display) and can be created again from the float one. */
+static bool seq_cache_imbuf_is_float(const ImBuf *ibuf)
+{
+  return ibuf->rect_float != NULL;
+}
+
+/* Size of image data, that is compressed. Only byte images and 4 channel float images are
+ * supported, 0 is returned for other images. */
+static size_t seq_cache_imbuf_size_raw(const ImBuf *ibuf)
+{
+  if (seq_cache_imbuf_is_float(ibuf)) {
+    if (ibuf->channels != 4) {
+      return 0;
+    }
+    return (size_t)ibuf->x * ibuf->y * 4 * sizeof(*ibuf->rect_float);
+  }
+  if (ibuf->rect) {
+    return (size_t)ibuf->x * ibuf->y * sizeof(*ibuf->rect);
+  }
+  return 0;
+}
+
+static void *seq_cache_imbuf_data(ImBuf *ibuf)
+{
+  if (seq_cache_imbuf_is_float(ibuf)) {
+    return ibuf->rect_float;
+  }
+  return ibuf->rect;
+}
+
+static SeqCacheCompressedImBuf *seq_cache_imbuf_compress(ImBuf *ibuf)
+{
+  const size_t size_raw = seq_cache_imbuf_size_raw(ibuf);
+  if (size_raw == 0) {
+    return NULL;
+  }
+
+  SeqCacheCompressedImBuf *cbuf = MEM_callocN(sizeof(*cbuf), "SeqCacheCompressedImBuf");
+  cbuf->x = ibuf->x;
+  cbuf->y = ibuf->y;
+  cbuf->planes = ibuf->planes;
+  cbuf->is_float = seq_cache_imbuf_is_float(ibuf);
+  cbuf->size_raw = size_raw;
+  cbuf->chunks_num = seq_cache_chunks_num(size_raw);
+  cbuf->chunks = seq_cache_chunks_compress(
+      seq_cache_imbuf_data(ibuf), size_raw, SEQ_CACHE_CODEC_LZO, &cbuf->size_compressed);
+
+  const char *colorspace_name;
+  if (cbuf->is_float) {
+    colorspace_name = IMB_colormanagement_get_float_colorspace(ibuf);
+  }
+  else {
+    colorspace_name = IMB_colormanagement_get_rect_colorspace(ibuf);
+  }
+  BLI_strncpy(cbuf->colorspace_name, colorspace_name, sizeof(cbuf->colorspace_name));
+
+  return cbuf;
+}
+
+static ImBuf *seq_cache_imbuf_decompress(SeqCacheCompressedImBuf *cbuf)
+{
+  ImBuf *ibuf = IMB_allocImBuf(
+      cbuf->x, cbuf->y, cbuf->planes, cbuf->is_float ? IB_rectfloat : IB_rect);
+
+  if (!seq_cache_chunks_decompress(
+          cbuf->chunks, seq_cache_imbuf_data(ibuf), cbuf->size_raw, SEQ_CACHE_CODEC_LZO)) {
+    IMB_freeImBuf(ibuf);
+    return NULL;
+  }
+
+  if (cbuf->is_float) {
+    IMB_colormanagement_assign_float_colorspace(ibuf, cbuf->colorspace_name);
+  }
+  else {
+    IMB_colormanagement_assign_rect_colorspace(ibuf, cbuf->colorspace_name);
+  }
+
+  return ibuf;
+}
+
+static void seq_cache_compressed_imbuf_free(SeqCacheCompressedImBuf *cbuf)
+{
+  seq_cache_chunks_free(cbuf->chunks, cbuf->chunks_num);
+  MEM_freeN(cbuf);
+}
+
+/* ***************************** Disk Cache ******************************* */
+
 static char *seq_disk_cache_base_dir(void)
 {
   return U.sequencer_disk_cache_dir;
 }
 
-static int seq_disk_cache_compression_level(void)
+static eSeqCacheCodec seq_disk_cache_codec(void)
 {
   switch (U.sequencer_disk_cache_compression) {
-    case USER_SEQ_DISK_CACHE_COMPRESSION_NONE:
-      return 0;
     case USER_SEQ_DISK_CACHE_COMPRESSION_LOW:
-      return 1;
+      return SEQ_CACHE_CODEC_LZO;
     case USER_SEQ_DISK_CACHE_COMPRESSION_HIGH:
-      return 9;
+      return SEQ_CACHE_CODEC_ZLIB;
   }
-
-  return U.sequencer_disk_cache_compression;
+  return SEQ_CACHE_CODEC_NONE;
 }
 
 static size_t seq_disk_cache_size_limit(void)
@@ -455,55 +799,8 @@ static void seq_disk_cache_delete_invalid_files(SeqDiskCache *disk_cache,
   }
 }
 
-static void seq_disk_cache_invalidate(Scene *scene,
-                                      Sequence *seq,
-                                      Sequence *seq_changed,
-                                      int invalidate_types)
-{
-  int start;
-  int end;
-  SeqDiskCache *disk_cache = scene->ed->cache->disk_cache;
-
-  BLI_mutex_lock(&disk_cache->read_write_mutex);
-
-  start = seq_changed->startdisp - DCACHE_IMAGES_PER_FILE;
-  end = seq_changed->enddisp;
-
-  seq_disk_cache_delete_invalid_files(disk_cache, scene, seq, invalidate_types, start, end);
-
-  BLI_mutex_unlock(&disk_cache->read_write_mutex);
-}
-
-static size_t deflate_imbuf_to_file(ImBuf *ibuf,
-                                    FILE *file,
-                                    int level,
-                                    DiskCacheHeaderEntry *header_entry)
+static void seq_disk_cache_header_endian_switch(DiskCacheHeader *header)
 {
-  if (ibuf->rect) {
-    return BLI_gzip_mem_to_file_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset, level);
-  }
-
-  return BLI_gzip_mem_to_file_at_pos(
-      ibuf->rect_float, header_entry->size_raw, file, header_entry->offset, level);
-}
-
-static size_t inflate_file_to_imbuf(ImBuf *ibuf, FILE *file, DiskCacheHeaderEntry *header_entry)
-{
-  if (ibuf->rect) {
-    return BLI_ungzip_file_to_mem_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset);
-  }
-
-  return BLI_ungzip_file_to_mem_at_pos(
-      ibuf->rect_float, header_entry->size_raw, file, header_entry->offset);
-}
-
-static void seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
-{
-  fseek(file, 0, 0);
-  fread(header, sizeof(*header), 1, file);
-
   for (int i = 0; i < DCACHE_IMAGES_PER_FILE; i++) {
     if ((ENDIAN_ORDER == B_ENDIAN) && header->entry[i].encoding == 0) {
       BLI_endian_switch_uint64(&header->entry[i].frameno);
@@ -514,6 +811,13 @@ static void seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
   }
 }
 
+static void seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
+{
+  fseek(file, 0, 0);
+  fread(header, sizeof(*header), 1, file);
+  seq_disk_cache_header_endian_switch(header);
+}
+
 static size_t seq_disk_cache_write_header(FILE *file, DiskCacheHeader *header)
 {
   fseek(file, 0, 0);
@@ -554,16 +858,15 @@ static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCa
 
   header->entry[i].offset = offset;
   header->entry[i].frameno = key->nfra;
+  header->entry[i].size_raw = seq_cache_imbuf_size_raw(ibuf);
 
   /* Store colorspace name of ibuf. */
   const char *colorspace_name;
-  if (ibuf->rect) {
-    header->entry[i].size_raw = ibuf->x * ibuf->y * ibuf->channels;
-    colorspace_name = IMB_colormanagement_get_rect_colorspace(ibuf);
+  if (seq_cache_imbuf_is_float(ibuf)) {
+    colorspace_name = IMB_colormanagement_get_float_colorspace(ibuf);
   }
   else {
-    header->entry[i].size_raw = ibuf->x * ibuf->y * ibuf->channels * 4;
-    colorspace_name = IMB_colormanagement_get_float_colorspace(ibuf);
+    colorspace_name = IMB_colormanagement_get_rect_colorspace(ibuf);
   }
   BLI_strncpy(
       header->entry[i].colorspace_name, colorspace_name, sizeof(header->entry[i].colorspace_name));
@@ -582,11 +885,43 @@ static int seq_disk_cache_get_header_entry(SeqCacheKey *key, DiskCacheHeader *he
   return -1;
 }
 
-static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
+/* Write table of chunk sizes followed by chunk data. Returns number of bytes written. */
+static size_t seq_disk_cache_write_chunks(FILE *file,
+                                          DiskCacheHeaderEntry *header_entry,
+                                          SeqCacheChunk *chunks,
+                                          int chunks_num)
 {
-  char path[FILE_MAX];
+  uint64_t *chunk_sizes = MEM_mallocN(sizeof(*chunk_sizes) * chunks_num, __func__);
+  for (int i = 0; i < chunks_num; i++) {
+    chunk_sizes[i] = chunks[i].size;
+  }
 
-  seq_disk_cache_get_file_path(disk_cache, key, path, sizeof(path));
+  size_t bytes_written = 0;
+  if (fseek(file, header_entry->offset, 0) == 0 &&
+      fwrite(chunk_sizes, sizeof(*chunk_sizes), chunks_num, file) == chunks_num) {
+    bytes_written = sizeof(*chunk_sizes) * chunks_num;
+
+    for (int i = 0; i < chunks_num; i++) {
+      if (fwrite(chunks[i].data, 1, chunks[i].size, file) != chunks[i].size) {
+        bytes_written = 0;
+        break;
+      }
+      bytes_written += chunks[i].size;
+    }
+  }
+
+  MEM_freeN(chunk_sizes);
+  return bytes_written;
+}
+
+static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache,
+                                      SeqCacheKey *key,
+                                      char *path,
+                                      ImBuf *ibuf,
+                                      SeqCacheChunk *chunks,
+                                      int chunks_num,
+                                      eSeqCacheCodec codec)
+{
   BLI_make_existing_file(path);
 
   FILE *file = BLI_fopen(path, "rb+");
@@ -602,8 +937,9 @@ static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key
   memset(&header, 0, sizeof(header));
   seq_disk_cache_read_header(file, &header);
   int entry_index = seq_disk_cache_add_header_entry(key, ibuf, &header);
-  size_t bytes_written = deflate_imbuf_to_file(
-      ibuf, file, seq_disk_cache_compression_level(), &header.entry[entry_index]);
+  header.entry[entry_index].codec = codec;
+  size_t bytes_written = seq_disk_cache_write_chunks(
+      file, &header.entry[entry_index], chunks, chunks_num);
 
   if (bytes_written != 0) {
     /* Last step is writing header, as image data can be overwritten,
@@ -611,15 +947,184 @@ static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key
      */
     header.entry[entry_index].size_compressed = bytes_written;
     seq_disk_cache_write_header(file, &header);
-    seq_disk_cache_update_file(disk_cache, path);
     fclose(file);
+    seq_disk_cache_update_file(disk_cache, path);
 
     return true;
   }
 
+  fclose(file);
   return false;
 }
 
+typedef struct DiskCacheWriteTask {
+  SeqCacheKey key;
+  char path[FILE_MAX];
+  ImBuf *ibuf;
+} DiskCacheWriteTask;
+
+static void seq_disk_cache_write_task_run(TaskPool *__restrict pool, void *taskdata)
+{
+  SeqDiskCache *disk_cache = BLI_task_pool_user_data(pool);
+  DiskCacheWriteTask *task = taskdata;
+  const size_t size_raw = seq_cache_imbuf_size_raw(task->ibuf);
+  const int chunks_num = seq_cache_chunks_num(size_raw);
+  const eSeqCacheCodec codec = seq_disk_cache_codec();
+  size_t size_compressed;
+
+  /* Compress before locking, so reading from disk cache is not blocked. */
+  SeqCacheChunk *chunks = seq_cache_chunks_compress(
+      seq_cache_imbuf_data(task->ibuf), size_raw, codec, &size_compressed);
+
+  BLI_mutex_lock(&disk_cache->read_write_mutex);
+  seq_disk_cache_write_file(
+      disk_cache, &task->key, task->path, task->ibuf, chunks, chunks_num, codec);
+  BLI_mutex_unlock(&disk_cache->read_write_mutex);
+  seq_disk_cache_enforce_limits(disk_cache);
+
+  seq_cache_chunks_free(chunks, chunks_num);
+}
+
+static void seq_disk_cache_write_task_free(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  DiskCacheWriteTask *task = taskdata;
+  IMB_freeImBuf(task->ibuf);
+  MEM_freeN(task);
+}
+
+/* Schedule writing of image to disk cache. File path is resolved immediately, because
+ * sequence may be renamed or freed before image is written. */
+static void seq_disk_cache_write_file_async(SeqDiskCache *disk_cache,
+                                            SeqCacheKey *key,
+                                            ImBuf *ibuf)
+{
+  if (seq_cache_imbuf_size_raw(ibuf) == 0) {
+    return;
+  }
+
+  DiskCacheWriteTask *task = MEM_mallocN(sizeof(*task), "DiskCacheWriteTask");
+  task->key = *key;
+  task->key.seq = NULL;
+  task->key.link_prev = NULL;
+  task->key.link_next = NULL;
+  seq_disk_cache_get_file_path(disk_cache, key, task->path, sizeof(task->path));
+  IMB_refImBuf(ibuf);
+  task->ibuf = ibuf;
+
+  BLI_task_pool_push(disk_cache->write_pool,
+                     seq_disk_cache_write_task_run,
+                     task,
+                     true,
+                     seq_disk_cache_write_task_free);
+}
+
+/* Wait until all scheduled images are written. */
+static void seq_disk_cache_write_wait(SeqDiskCache *disk_cache)
+{
+  BLI_task_pool_work_and_wait(disk_cache->write_pool);
+}
+
+static void seq_disk_cache_invalidate(Scene *scene,
+                                      Sequence *seq,
+                                      Sequence *seq_changed,
+                                      int invalidate_types)
+{
+  int start;
+  int end;
+  SeqDiskCache *disk_cache = scene->ed->cache->disk_cache;
+
+  /* Images scheduled for writing may be invalid, they must be written before deleting files. */
+  seq_disk_cache_write_wait(disk_cache);
+  BLI_mutex_lock(&disk_cache->read_write_mutex);
+
+  start = seq_changed->startdisp - DCACHE_IMAGES_PER_FILE;
+  end = seq_changed->enddisp;
+
+  seq_disk_cache_delete_invalid_files(disk_cache, scene, seq, invalidate_types, start, end);
+
+  BLI_mutex_unlock(&disk_cache->read_write_mutex);
+}
+
+static ImBuf *seq_disk_cache_read_entry(BLI_mmap_file *mmap_file,
+                                        SeqCacheKey *key,
+                                        DiskCacheHeaderEntry *header_entry)
+{
+  const uint64_t size_char = (uint64_t)key->context.rectx * key->context.recty * 4;
+  const uint64_t size_float = (uint64_t)key->context.rectx * key->context.recty * 16;
+  const uint64_t size_raw = header_entry->size_raw;
+  const uint64_t entry_end = header_entry->offset + header_entry->size_compressed;
+
+  if (size_raw != size_char && size_raw != size_float) {
+    return NULL;
+  }
+
+  if (header_entry->codec > SEQ_CACHE_CODEC_ZLIB) {
+    return NULL;
+  }
+
+  const int chunks_num = seq_cache_chunks_num(size_raw);
+  const size_t table_size = sizeof(uint64_t) * chunks_num;
+
+  if (header_entry->size_compressed < table_size || entry_end > BLI_mmap_get_length(mmap_file)) {
+    return NULL;
+  }
+
+  uint64_t *chunk_sizes = MEM_mallocN(table_size, __func__);
+  if (!BLI_mmap_read(mmap_file, chunk_sizes, header_entry->offset, table_size)) {
+    MEM_freeN(chunk_sizes);
+    return NULL;
+  }
+
+  /* Chunks point directly to mapped memory. */
+  SeqCacheChunk *chunks = MEM_mallocN(sizeof(*chunks) * chunks_num, __func__);
+  unsigned char *mapped_data = BLI_mmap_get_pointer(mmap_file);
+  uint64_t chunk_offset = header_entry->offset + table_size;
+  bool is_valid = true;
+
+  for (int i = 0; i < chunks_num; i++) {
+    if ((ENDIAN_ORDER == B_ENDIAN) && header_entry->encoding == 0) {
+      BLI_endian_switch_uint64(&chunk_sizes[i]);
+    }
+
+    if (chunk_sizes[i] == 0 || chunk_sizes[i] > seq_cache_chunk_size_raw(size_raw, i) ||
+        chunk_offset + chunk_sizes[i] > entry_end) {
+      is_valid = false;
+      break;
+    }
+
+    chunks[i].data = mapped_data + chunk_offset;
+    chunks[i].size = chunk_sizes[i];
+    chunk_offset += chunk_sizes[i];
+  }
+
+  ImBuf *ibuf = NULL;
+
+  if (is_valid) {
+    const bool is_float = size_raw == size_float;
+    ibuf = IMB_allocImBuf(
+        key->context.rectx, key->context.recty, 32, is_float ? IB_rectfloat : IB_rect);
+
+    /* IO errors in mapped memory are only reported by reading from the file. */
+    if (!seq_cache_chunks_decompress(
+            chunks, seq_cache_imbuf_data(ibuf), size_raw, header_entry->codec) ||
+        !BLI_mmap_read(mmap_file, chunk_sizes, header_entry->offset, table_size)) {
+      IMB_freeImBuf(ibuf);
+      ibuf = NULL;
+    }
+    else if (is_float) {
+      IMB_colormanagement_assign_float_colorspace(ibuf, header_entry->colorspace_name);
+    }
+    else {
+      IMB_colormanagement_assign_rect_colorspace(ibuf, header_entry->colorspace_name);
+    }
+  }
+
+  MEM_freeN(chunks);
+  MEM_freeN(chunk_sizes);
+
+  return ibuf;
+}
+
 static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *key)
 {
   char path[FILE_MAX];
@@ -628,51 +1133,35 @@ static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *ke
   seq_disk_cache_get_file_path(disk_cache, key, path, sizeof(path));
   BLI_make_existing_file(path);
 
-  FILE *file = BLI_fopen(path, "rb");
-  if (!file) {
+  const int file = BLI_open(path, O_BINARY | O_RDONLY, 0);
+  if (file == -1) {
     return NULL;
   }
 
-  seq_disk_cache_read_header(file, &header);
-  int entry_index = seq_disk_cache_get_header_entry(key, &header);
-
-  /* Item not found. */
-  if (entry_index < 0) {
-    fclose(file);
+  BLI_mmap_file *mmap_file = BLI_mmap_open(file);
+  if (mmap_file == NULL) {
+    close(file);
     return NULL;
   }
 
-  ImBuf *ibuf;
-  uint64_t size_char = (uint64_t)key->context.rectx * key->context.recty * 4;
-  uint64_t size_float = (uint64_t)key->context.rectx * key->context.recty * 16;
-  size_t expected_size;
+  ImBuf *ibuf = NULL;
 
-  if (header.entry[entry_index].size_raw == size_char) {
-    expected_size = size_char;
-    ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rect);
-    IMB_colormanagement_assign_rect_colorspace(ibuf, header.entry[entry_index].colorspace_name);
-  }
-  else if (header.entry[entry_index].size_raw == size_float) {
-    expected_size = size_float;
-    ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rectfloat);
-    IMB_colormanagement_assign_float_colorspace(ibuf, header.entry[entry_index].colorspace_name);
-  }
-  else {
-    fclose(file);
-    return NULL;
+  if (BLI_mmap_read(mmap_file, &header, 0, sizeof(header))) {
+    seq_disk_cache_header_endian_switch(&header);
+    int entry_index = seq_disk_cache_get_header_entry(key, &header);
+
+    if (entry_index >= 0) {
+      ibuf = seq_disk_cache_read_entry(mmap_file, key, &header.entry[entry_index]);
+    }
   }
 
-  size_t bytes_read = inflate_file_to_imbuf(ibuf, file, &header.entry[entry_index]);
+  BLI_mmap_free(mmap_file);
+  close(file);
 
-  /* Sanity check. */
-  if (bytes_read != expected_size) {
-    fclose(file);
-    IMB_freeImBuf(ibuf);
-    return NULL;
+  if (ibuf) {
+    BLI_file_touch(path);
+    seq_disk_cache_update_file(disk_cache, path);
   }
-  BLI_file_touch(path);
-  seq_disk_cache_update_file(disk_cache, path);
-  fclose(file);
 
   return ibuf;
 }
@@ -784,6 +1273,12 @@ static void seq_cache_valfree(void *val)
     IMB_freeImBuf(item->ibuf);
   }
 
+  if (item->cbuf) {
+    cache->memory_used -= item->cbuf->size_compressed;
+    cache->memory_compressed -= item->cbuf->size_compressed;
+    seq_cache_compressed_imbuf_free(item->cbuf);
+  }
+
   BLI_mempool_free(item->cache_owner->items_pool, item);
 }
 
@@ -793,6 +1288,8 @@ static void seq_cache_put(SeqCache *cache, SeqCacheKey *key, ImBuf *ibuf)
   item = BLI_mempool_alloc(cache->items_pool);
   item->cache_owner = cache;
   item->ibuf = ibuf;
+  item->cbuf = NULL;
+  item->tier = SEQ_CACHE_TIER_RAW;
 
   if (BLI_ghash_reinsert(cache->hash, key, item, seq_cache_keyfree, seq_cache_valfree)) {
     IMB_refImBuf(ibuf);
@@ -807,13 +1304,49 @@ static ImBuf *seq_cache_get(SeqCache *cache, SeqCacheKey *key)
 
   if (item && item->ibuf) {
     IMB_refImBuf(item->ibuf);
+    cache->stats.raw_hits++;
 
     return item->ibuf;
   }
+  cache->stats.raw_misses++;
+
+  /* Compressed item is not promoted back to raw tier, this would cause it to be compressed
+   * again during playback. */
+  if (item && item->cbuf) {
+    ImBuf *ibuf = seq_cache_imbuf_decompress(item->cbuf);
+    if (ibuf) {
+      cache->stats.compressed_hits++;
+      return ibuf;
+    }
+  }
+  cache->stats.compressed_misses++;
 
   return NULL;
 }
 
+/* Move item to compressed tier. Images that can't be compressed are only marked, so they are
+ * freed on next recycling. */
+static void seq_cache_item_compress(SeqCacheItem *item)
+{
+  SeqCache *cache = item->cache_owner;
+  item->tier = SEQ_CACHE_TIER_COMPRESSED;
+
+  if (item->ibuf == NULL) {
+    return;
+  }
+
+  item->cbuf = seq_cache_imbuf_compress(item->ibuf);
+  if (item->cbuf == NULL) {
+    return;
+  }
+
+  cache->memory_used -= IMB_get_size_in_memory(item->ibuf);
+  cache->memory_used += item->cbuf->size_compressed;
+  cache->memory_compressed += item->cbuf->size_compressed;
+  IMB_freeImBuf(item->ibuf);
+  item->ibuf = NULL;
+}
+
 static void seq_cache_relink_keys(SeqCacheKey *link_next, SeqCacheKey *link_prev)
 {
   if (link_next) {
@@ -916,7 +1449,38 @@ static void seq_cache_recycle_linked(Scene *scene, SeqCacheKey *base)
   }
 }
 
-static SeqCacheKey *seq_cache_get_item_for_removal(Scene *scene)
+/* Compress all items linked to base. Items are compressed one at a time, each image is split
+ * between threads. */
+static void seq_cache_compress_linked(Scene *scene, SeqCacheKey *base)
+{
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+  if (!cache) {
+    return;
+  }
+
+  SeqCacheKey *next = base->link_next;
+
+  while (base) {
+    SeqCacheKey *prev = base->link_prev;
+    SeqCacheItem *item = BLI_ghash_lookup(cache->hash, base);
+    if (item) {
+      seq_cache_item_compress(item);
+    }
+    base = prev;
+  }
+
+  base = next;
+  while (base) {
+    next = base->link_next;
+    SeqCacheItem *item = BLI_ghash_lookup(cache->hash, base);
+    if (item) {
+      seq_cache_item_compress(item);
+    }
+    base = next;
+  }
+}
+
+static SeqCacheKey *seq_cache_get_item_for_removal(Scene *scene, eSeqCacheTier tier)
 {
   SeqCache *cache = seq_cache_get_from_scene(scene);
   SeqCacheKey *finalkey = NULL;
@@ -937,14 +1501,14 @@ static SeqCacheKey *seq_cache_get_item_for_removal(Scene *scene)
     BLI_ghashIterator_step(&gh_iter);
 
     /* This shouldn't happen, but better be safe than sorry. */
-    if (!item->ibuf) {
+    if (!item->ibuf && !item->cbuf) {
       seq_cache_recycle_linked(scene, key);
       /* Can not continue iterating after linked remove. */
       BLI_ghashIterator_init(&gh_iter, cache->hash);
       continue;
     }
 
-    if (key->is_temp_cache || key->link_next != NULL) {
+    if (key->is_temp_cache || key->link_next != NULL || item->tier != tier) {
       continue;
     }
 
@@ -980,6 +1544,8 @@ static SeqCacheKey *seq_cache_get_item_for_removal(Scene *scene)
 
 /* Find only "base" keys.
  * Sources(other types) for a frame must be freed all at once.
+ * Raw frames are compressed first, compressed frames are freed only when there are no raw
+ * frames to recycle.
  */
 bool BKE_sequencer_cache_recycle_item(Scene *scene)
 {
@@ -992,7 +1558,14 @@ bool BKE_sequencer_cache_recycle_item(Scene *scene)
   seq_cache_lock(scene);
 
   while (cache->memory_used > memory_total) {
-    SeqCacheKey *finalkey = seq_cache_get_item_for_removal(scene);
+    SeqCacheKey *finalkey = seq_cache_get_item_for_removal(scene, SEQ_CACHE_TIER_RAW);
+
+    if (finalkey) {
+      seq_cache_compress_linked(scene, finalkey);
+      continue;
+    }
+
+    finalkey = seq_cache_get_item_for_removal(scene, SEQ_CACHE_TIER_COMPRESSED);
 
     if (finalkey) {
       seq_cache_recycle_linked(scene, finalkey);
@@ -1046,6 +1619,8 @@ static void seq_disk_cache_create(Main *bmain, Scene *scene)
   cache->disk_cache = MEM_callocN(sizeof(SeqDiskCache), "SeqDiskCache");
   cache->disk_cache->bmain = bmain;
   BLI_mutex_init(&cache->disk_cache->read_write_mutex);
+  cache->disk_cache->write_pool = BLI_task_pool_create_background_serial(cache->disk_cache,
+                                                                         TASK_PRIORITY_LOW);
   seq_disk_cache_handle_versioning(cache->disk_cache);
   seq_disk_cache_get_files(cache->disk_cache, seq_disk_cache_base_dir());
   cache->disk_cache->timestamp = scene->ed->disk_cache_timestamp;
@@ -1110,6 +1685,8 @@ void BKE_sequencer_cache_destruct(Scene *scene)
   BLI_mutex_end(&cache->iterator_mutex);
 
   if (cache->disk_cache != NULL) {
+    seq_disk_cache_write_wait(cache->disk_cache);
+    BLI_task_pool_free(cache->disk_cache->write_pool);
     BLI_freelistN(&cache->disk_cache->files);
     BLI_mutex_end(&cache->disk_cache->read_write_mutex);
     MEM_freeN(cache->disk_cache);
@@ -1264,6 +1841,12 @@ struct ImBuf *BKE_sequencer_cache_get(
 
     BLI_mutex_lock(&cache->disk_cache->read_write_mutex);
     ibuf = seq_disk_cache_read_file(cache->disk_cache, &key);
+    if (ibuf) {
+      cache->stats.disk_hits++;
+    }
+    else {
+      cache->stats.disk_misses++;
+    }
     BLI_mutex_unlock(&cache->disk_cache->read_write_mutex);
     if (ibuf) {
       if (key.type == SEQ_CACHE_STORE_FINAL_OUT) {
@@ -1321,6 +1904,8 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
   }
 
   Scene *scene = context->scene;
+  /* Keep ID of prefetch lane, temp cache entries belong to it. */
+  const eSeqTaskId task_id = context->task_id;
 
   if (context->is_prefetch_render) {
     context = BKE_sequencer_prefetch_get_original_context(context);
@@ -1329,13 +1914,6 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
     BLI_assert(seq != NULL);
   }
 
-  /* Prevent reinserting, it breaks cache key linking. */
-  ImBuf *test = BKE_sequencer_cache_get(context, seq, cfra, type, true);
-  if (test) {
-    IMB_freeImBuf(test);
-    return;
-  }
-
   if (!scene->ed->cache) {
     seq_cache_create(context->bmain, scene);
   }
@@ -1345,6 +1923,18 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
   SeqCache *cache = seq_cache_get_from_scene(scene);
   int flag;
 
+  /* Prevent reinserting, it breaks cache key linking.
+   * Only lookup key, so compressed image is not decompressed needlessly. */
+  SeqCacheKey test_key;
+  test_key.seq = seq;
+  test_key.context = *context;
+  test_key.nfra = seq_cache_cfra_to_frame_index(seq, cfra);
+  test_key.type = type;
+  if (BLI_ghash_haskey(cache->hash, &test_key)) {
+    seq_cache_unlock(scene);
+    return;
+  }
+
   if (seq->cache_flag & SEQ_CACHE_OVERRIDE) {
     flag = seq->cache_flag;
     /* Final_out is invalid in context of sequence override. */
@@ -1371,7 +1961,7 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
   key->link_prev = NULL;
   key->link_next = NULL;
   key->is_temp_cache = true;
-  key->task_id = context->task_id;
+  key->task_id = task_id;
 
   /* Item stored for later use */
   if (flag & type) {
@@ -1407,10 +1997,7 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
         seq_disk_cache_create(context->bmain, context->scene);
       }
 
-      BLI_mutex_lock(&cache->disk_cache->read_write_mutex);
-      seq_disk_cache_write_file(cache->disk_cache, key, i);
-      BLI_mutex_unlock(&cache->disk_cache->read_write_mutex);
-      seq_disk_cache_enforce_limits(cache->disk_cache);
+      seq_disk_cache_write_file_async(cache->disk_cache, key, i);
     }
   }
 }
@@ -1453,3 +2040,30 @@ bool BKE_sequencer_cache_is_full(Scene *scene)
 
   return memory_total < cache->memory_used;
 }
+
+void BKE_sequencer_cache_stats_get(Scene *scene, SeqCacheStats *r_stats)
+{
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+  if (!cache) {
+    memset(r_stats, 0, sizeof(*r_stats));
+    return;
+  }
+
+  seq_cache_lock(scene);
+  *r_stats = cache->stats;
+  r_stats->memory_used = cache->memory_used;
+  r_stats->memory_compressed = cache->memory_compressed;
+  seq_cache_unlock(scene);
+}
+
+void BKE_sequencer_cache_stats_reset(Scene *scene)
+{
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+  if (!cache) {
+    return;
+  }
+
+  seq_cache_lock(scene);
+  memset(&cache->stats, 0, sizeof(cache->stats));
+  seq_cache_unlock(scene);
+}
@@ -0,0 +1,241 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math_vector.h"
+#include "BLI_path_util.h"
+
+#include "BKE_appdir.h"
+#include "BKE_idtype.h"
+#include "BKE_main.h"
+#include "BKE_scene.h"
+#include "BKE_sequencer.h"
+
+#include "DNA_scene_types.h"
+#include "DNA_sequence_types.h"
+#include "DNA_space_types.h"
+#include "DNA_userdef_types.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#define CACHE_TEST_SIZE 256
+#define CACHE_TEST_FRAMES 4
+
+class SequencerCacheTest : public testing::Test {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  Sequence *seq = nullptr;
+  SeqRenderData context;
+  UserDef user_prefs_backup;
+
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+    BKE_appdir_init();
+    BKE_tempdir_init("");
+    IMB_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    IMB_exit();
+    BKE_tempdir_session_purge();
+  }
+
+  void SetUp() override
+  {
+    user_prefs_backup = U;
+
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    scene->r.xsch = CACHE_TEST_SIZE;
+    scene->r.ysch = CACHE_TEST_SIZE;
+
+    Editing *ed = BKE_sequencer_editing_ensure(scene);
+    seq = BKE_sequence_alloc(ed->seqbasep, 1, 1, SEQ_TYPE_COLOR);
+    seq->len = CACHE_TEST_FRAMES;
+    BKE_sequence_calc(scene, seq);
+    ed->cache_flag = SEQ_CACHE_STORE_FINAL_OUT;
+
+    BKE_sequencer_new_render_data(bmain,
+                                  nullptr,
+                                  scene,
+                                  CACHE_TEST_SIZE,
+                                  CACHE_TEST_SIZE,
+                                  SEQ_RENDER_SIZE_SCENE,
+                                  true,
+                                  &context);
+  }
+
+  void TearDown() override
+  {
+    BKE_main_free(bmain);
+    bmain = nullptr;
+    U = user_prefs_backup;
+  }
+
+  /* Smooth gradient, different for every frame, so it compresses but can't be confused with
+   * another frame. */
+  static ImBuf *frame_create(int cfra, bool is_float)
+  {
+    ImBuf *ibuf = IMB_allocImBuf(
+        CACHE_TEST_SIZE, CACHE_TEST_SIZE, 32, is_float ? IB_rectfloat : IB_rect);
+    for (int y = 0; y < CACHE_TEST_SIZE; y++) {
+      for (int x = 0; x < CACHE_TEST_SIZE; x++) {
+        const float col[4] = {
+            (float)x / CACHE_TEST_SIZE, (float)y / CACHE_TEST_SIZE, cfra * 0.1f, 1.0f};
+        const size_t index = (size_t)y * CACHE_TEST_SIZE + x;
+        if (is_float) {
+          copy_v4_v4(&ibuf->rect_float[index * 4], col);
+        }
+        else {
+          unsigned char *rect = (unsigned char *)&ibuf->rect[index];
+          for (int i = 0; i < 4; i++) {
+            rect[i] = (unsigned char)(col[i] * 255.0f);
+          }
+        }
+      }
+    }
+    return ibuf;
+  }
+
+  static bool frame_equals(const ImBuf *a, const ImBuf *b)
+  {
+    if (a->x != b->x || a->y != b->y) {
+      return false;
+    }
+    const size_t num_pixels = (size_t)a->x * a->y;
+    if (a->rect_float != nullptr) {
+      return b->rect_float != nullptr &&
+             memcmp(a->rect_float, b->rect_float, sizeof(float[4]) * num_pixels) == 0;
+    }
+    return b->rect != nullptr && memcmp(a->rect, b->rect, sizeof(*a->rect) * num_pixels) == 0;
+  }
+
+  void frames_put(ImBuf *frames[CACHE_TEST_FRAMES], bool is_float, bool skip_disk_cache)
+  {
+    for (int i = 0; i < CACHE_TEST_FRAMES; i++) {
+      frames[i] = frame_create(i + 1, is_float);
+      BKE_sequencer_cache_put(
+          &context, seq, i + 1, SEQ_CACHE_STORE_FINAL_OUT, frames[i], 0.0f, skip_disk_cache);
+    }
+  }
+
+  /* Every frame returned by the cache must match the image that was put in. */
+  void frames_check(ImBuf *frames[CACHE_TEST_FRAMES], bool skip_disk_cache)
+  {
+    for (int i = 0; i < CACHE_TEST_FRAMES; i++) {
+      ImBuf *ibuf = BKE_sequencer_cache_get(
+          &context, seq, i + 1, SEQ_CACHE_STORE_FINAL_OUT, skip_disk_cache);
+      EXPECT_NE(ibuf, nullptr) << "frame " << i + 1;
+      if (ibuf != nullptr) {
+        EXPECT_TRUE(frame_equals(frames[i], ibuf)) << "frame " << i + 1;
+        IMB_freeImBuf(ibuf);
+      }
+      IMB_freeImBuf(frames[i]);
+    }
+  }
+
+  /* Frames that don't fit the memory limit are compressed and must come back unchanged. */
+  void compressed_round_trip(bool is_float, int memcachelimit)
+  {
+    U.memcachelimit = memcachelimit;
+    U.sequencer_disk_cache_flag &= ~SEQ_CACHE_DISK_CACHE_ENABLE;
+
+    ImBuf *frames[CACHE_TEST_FRAMES];
+    frames_put(frames, is_float, true);
+    EXPECT_TRUE(BKE_sequencer_cache_recycle_item(scene));
+
+    SeqCacheStats stats;
+    BKE_sequencer_cache_stats_get(scene, &stats);
+    EXPECT_GT(stats.memory_compressed, 0);
+    EXPECT_LE(stats.memory_used, (size_t)memcachelimit * 1024 * 1024);
+
+    BKE_sequencer_cache_stats_reset(scene);
+    frames_check(frames, true);
+
+    BKE_sequencer_cache_stats_get(scene, &stats);
+    EXPECT_GT(stats.compressed_hits, 0);
+    EXPECT_EQ(stats.compressed_misses, 0);
+  }
+
+  /* Frames are written to disk in the background. Destroying the cache waits for pending
+   * writes, after that every frame must be read back from disk unchanged. */
+  void disk_round_trip(bool is_float, int compression, const char *blendfile_name)
+  {
+    U.memcachelimit = 1024;
+    BLI_join_dirfile(U.sequencer_disk_cache_dir,
+                     sizeof(U.sequencer_disk_cache_dir),
+                     BKE_tempdir_session(),
+                     "seq_cache");
+    U.sequencer_disk_cache_size_limit = 1;
+    U.sequencer_disk_cache_flag |= SEQ_CACHE_DISK_CACHE_ENABLE;
+    U.sequencer_disk_cache_compression = compression;
+    /* Each test writes to its own project directory. */
+    BLI_join_dirfile(bmain->name, sizeof(bmain->name), BKE_tempdir_session(), blendfile_name);
+
+    ImBuf *frames[CACHE_TEST_FRAMES];
+    frames_put(frames, is_float, false);
+
+    BKE_sequencer_cache_destruct(scene);
+    frames_check(frames, false);
+
+    SeqCacheStats stats;
+    BKE_sequencer_cache_stats_get(scene, &stats);
+    EXPECT_EQ(stats.disk_hits, CACHE_TEST_FRAMES);
+    EXPECT_EQ(stats.disk_misses, 0);
+  }
+};
+
+TEST_F(SequencerCacheTest, CompressedRoundTripByte)
+{
+  /* 4 frames of 256 KiB do not fit in 1 MiB. */
+  compressed_round_trip(false, 1);
+}
+
+TEST_F(SequencerCacheTest, CompressedRoundTripFloat)
+{
+  /* 4 frames of 1 MiB do not fit in 2 MiB. */
+  compressed_round_trip(true, 2);
+}
+
+TEST_F(SequencerCacheTest, DiskRoundTripByte)
+{
+  disk_round_trip(false, USER_SEQ_DISK_CACHE_COMPRESSION_LOW, "cache_test_byte.blend");
+}
+
+TEST_F(SequencerCacheTest, DiskRoundTripFloat)
+{
+  disk_round_trip(true, USER_SEQ_DISK_CACHE_COMPRESSION_LOW, "cache_test_float.blend");
+}
+
+TEST_F(SequencerCacheTest, DiskRoundTripHighCompression)
+{
+  disk_round_trip(true, USER_SEQ_DISK_CACHE_COMPRESSION_HIGH, "cache_test_high.blend");
+}
+
+TEST_F(SequencerCacheTest, DiskRoundTripNoCompression)
+{
+  disk_round_trip(false, USER_SEQ_DISK_CACHE_COMPRESSION_NONE, "cache_test_none.blend");
+}
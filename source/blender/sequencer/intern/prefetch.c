@@ -27,13 +27,18 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "DNA_anim_types.h"
 #include "DNA_scene_types.h"
 #include "DNA_screen_types.h"
 #include "DNA_sequence_types.h"
+#include "DNA_userdef_types.h"
 #include "DNA_windowmanager_types.h"
 
 #include "BLI_listbase.h"
+#include "BLI_math_base.h"
+#include "BLI_system.h"
 #include "BLI_threads.h"
 
 #include "IMB_imbuf.h"
@@ -54,15 +59,36 @@
 #include "DEG_depsgraph_debug.h"
 #include "DEG_depsgraph_query.h"
 
+#include "PIL_time.h"
+
+/* Estimate of full frame float images held by a lane while rendering a frame (strip inputs,
+ * effect and blending results), used to limit the number of lanes by memory. */
+#define SEQ_PREFETCH_LANE_IMAGES 4
+
+/* Prefetch renders several frames at once. Each lane is a thread, that renders one frame at a
+ * time using its own copy of the scene, evaluated for that frame. */
+typedef struct PrefetchLane {
+  struct PrefetchJob *pfjob;
+
+  struct Main *bmain_eval;
+  struct Scene *scene_eval;
+  struct Depsgraph *depsgraph;
+  struct SeqRenderData context_cpy;
+
+  /* Frame that is being rendered. */
+  float cfra;
+} PrefetchLane;
+
 typedef struct PrefetchJob {
   struct PrefetchJob *next, *prev;
 
   struct Main *bmain;
-  struct Main *bmain_eval;
   struct Scene *scene;
-  struct Scene *scene_eval;
-  struct Depsgraph *depsgraph;
 
+  PrefetchLane lanes[SEQ_PREFETCH_LANES_MAX];
+  int num_lanes;
+
+  /* Protects prefetch area and control variables, that are shared by lanes. */
   ThreadMutex prefetch_suspend_mutex;
   ThreadCondition prefetch_suspend_cond;
 
@@ -70,7 +96,6 @@ typedef struct PrefetchJob {
 
   /* context */
   struct SeqRenderData context;
-  struct SeqRenderData context_cpy;
   struct ListBase *seqbasep;
   struct ListBase *seqbasep_cpy;
 
@@ -78,7 +103,14 @@ typedef struct PrefetchJob {
   float cfra;
   int num_frames_prefetched;
 
+  /* statistics */
+  int num_frames_rendered;
+  double time_start;
+  double time_end;
+
   /* control */
+  int num_lanes_running;
+  int num_lanes_waiting;
   bool running;
   bool waiting;
   bool stop;
@@ -179,13 +211,14 @@ static bool seq_prefetch_is_cache_full(Scene *scene)
   return BKE_sequencer_cache_recycle_item(pfjob->scene) == false;
 }
 
+/* First frame, that is not rendered yet and is not being rendered by any lane. */
 static float seq_prefetch_cfra(PrefetchJob *pfjob)
 {
   return pfjob->cfra + pfjob->num_frames_prefetched;
 }
-static AnimationEvalContext seq_prefetch_anim_eval_context(PrefetchJob *pfjob)
+static AnimationEvalContext seq_prefetch_anim_eval_context(PrefetchLane *lane)
 {
-  return BKE_animsys_eval_context_construct(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
+  return BKE_animsys_eval_context_construct(lane->depsgraph, lane->cfra);
 }
 
 void BKE_sequencer_prefetch_get_time_range(Scene *scene, int *start, int *end)
@@ -196,37 +229,59 @@ void BKE_sequencer_prefetch_get_time_range(Scene *scene, int *start, int *end)
   *end = seq_prefetch_cfra(pfjob);
 }
 
-static void seq_prefetch_free_depsgraph(PrefetchJob *pfjob)
+/* Frames per second rendered by prefetch since it was started. Returns 0 before the first frame
+ * is rendered. */
+float BKE_sequencer_prefetch_fps_get(Scene *scene)
+{
+  PrefetchJob *pfjob = seq_prefetch_job_get(scene);
+
+  if (!pfjob || pfjob->num_frames_rendered == 0) {
+    return 0.0f;
+  }
+
+  const double time_end = pfjob->running ? PIL_check_seconds_timer() : pfjob->time_end;
+  const double time_spent = time_end - pfjob->time_start;
+
+  if (time_spent <= 0.0) {
+    return 0.0f;
+  }
+
+  return (float)(pfjob->num_frames_rendered / time_spent);
+}
+
+static void seq_prefetch_free_depsgraph(PrefetchLane *lane)
 {
-  if (pfjob->depsgraph != NULL) {
-    DEG_graph_free(pfjob->depsgraph);
+  if (lane->depsgraph != NULL) {
+    DEG_graph_free(lane->depsgraph);
   }
-  pfjob->depsgraph = NULL;
-  pfjob->scene_eval = NULL;
+  lane->depsgraph = NULL;
+  lane->scene_eval = NULL;
 }
 
-static void seq_prefetch_update_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_update_depsgraph(PrefetchLane *lane)
 {
-  DEG_evaluate_on_framechange(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
+  DEG_evaluate_on_framechange(lane->depsgraph, lane->cfra);
 }
 
-static void seq_prefetch_init_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_init_depsgraph(PrefetchLane *lane)
 {
-  Main *bmain = pfjob->bmain_eval;
+  PrefetchJob *pfjob = lane->pfjob;
+  Main *bmain = lane->bmain_eval;
   Scene *scene = pfjob->scene;
   ViewLayer *view_layer = BKE_view_layer_default_render(scene);
 
-  pfjob->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
-  DEG_debug_name_set(pfjob->depsgraph, "SEQUENCER PREFETCH");
+  lane->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+  DEG_debug_name_set(lane->depsgraph, "SEQUENCER PREFETCH");
 
   /* Make sure there is a correct evaluated scene pointer. */
-  DEG_graph_build_for_render_pipeline(pfjob->depsgraph);
+  DEG_graph_build_for_render_pipeline(lane->depsgraph);
 
   /* Update immediately so we have proper evaluated scene. */
-  seq_prefetch_update_depsgraph(pfjob);
+  lane->cfra = seq_prefetch_cfra(pfjob);
+  seq_prefetch_update_depsgraph(lane);
 
-  pfjob->scene_eval = DEG_get_evaluated_scene(pfjob->depsgraph);
-  pfjob->scene_eval->ed->cache_flag = 0;
+  lane->scene_eval = DEG_get_evaluated_scene(lane->depsgraph);
+  lane->scene_eval->ed->cache_flag = 0;
 }
 
 static void seq_prefetch_update_area(PrefetchJob *pfjob)
@@ -274,7 +329,7 @@ void BKE_sequencer_prefetch_stop(Scene *scene)
   pfjob->stop = true;
 
   while (pfjob->running) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
   }
 }
 
@@ -283,19 +338,24 @@ static void seq_prefetch_update_context(const SeqRenderData *context)
   PrefetchJob *pfjob;
   pfjob = seq_prefetch_job_get(context->scene);
 
-  BKE_sequencer_new_render_data(pfjob->bmain_eval,
-                                pfjob->depsgraph,
-                                pfjob->scene_eval,
-                                context->rectx,
-                                context->recty,
-                                context->preview_render_size,
-                                false,
-                                &pfjob->context_cpy);
-  pfjob->context_cpy.is_prefetch_render = true;
-  pfjob->context_cpy.task_id = SEQ_TASK_PREFETCH_RENDER;
+  for (int i = 0; i < pfjob->num_lanes; i++) {
+    PrefetchLane *lane = &pfjob->lanes[i];
+
+    BKE_sequencer_new_render_data(lane->bmain_eval,
+                                  lane->depsgraph,
+                                  lane->scene_eval,
+                                  context->rectx,
+                                  context->recty,
+                                  context->preview_render_size,
+                                  false,
+                                  &lane->context_cpy);
+    lane->context_cpy.is_prefetch_render = true;
+    /* Each lane has its own temp cache entries. */
+    lane->context_cpy.task_id = SEQ_TASK_PREFETCH_RENDER + i;
+  }
 
   BKE_sequencer_new_render_data(pfjob->bmain,
-                                pfjob->depsgraph,
+                                pfjob->lanes[0].depsgraph,
                                 pfjob->scene,
                                 context->rectx,
                                 context->recty,
@@ -303,11 +363,6 @@ static void seq_prefetch_update_context(const SeqRenderData *context)
                                 false,
                                 &pfjob->context);
   pfjob->context.is_prefetch_render = false;
-
-  /* Same ID as prefetch context, because context will be swapped, but we still
-   * want to assign this ID to cache entries created in this thread.
-   * This is to allow "temp cache" work correctly for both threads.
-   */
   pfjob->context.task_id = SEQ_TASK_PREFETCH_RENDER;
 }
 
@@ -319,16 +374,18 @@ static void seq_prefetch_update_scene(Scene *scene)
     return;
   }
 
-  seq_prefetch_free_depsgraph(pfjob);
-  seq_prefetch_init_depsgraph(pfjob);
+  for (int i = 0; i < pfjob->num_lanes; i++) {
+    seq_prefetch_free_depsgraph(&pfjob->lanes[i]);
+    seq_prefetch_init_depsgraph(&pfjob->lanes[i]);
+  }
 }
 
 static void seq_prefetch_resume(Scene *scene)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(scene);
 
-  if (pfjob && pfjob->waiting) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+  if (pfjob && pfjob->num_lanes_waiting > 0) {
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
   }
 }
 
@@ -341,24 +398,24 @@ void BKE_sequencer_prefetch_free(Scene *scene)
 
   BKE_sequencer_prefetch_stop(scene);
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
   BLI_threadpool_end(&pfjob->threads);
   BLI_mutex_end(&pfjob->prefetch_suspend_mutex);
   BLI_condition_end(&pfjob->prefetch_suspend_cond);
-  seq_prefetch_free_depsgraph(pfjob);
-  BKE_main_free(pfjob->bmain_eval);
+  for (int i = 0; i < pfjob->num_lanes; i++) {
+    seq_prefetch_free_depsgraph(&pfjob->lanes[i]);
+    BKE_main_free(pfjob->lanes[i].bmain_eval);
+  }
   MEM_freeN(pfjob);
   scene->ed->prefetch_job = NULL;
 }
 
-static bool seq_prefetch_do_skip_frame(Scene *scene)
+static bool seq_prefetch_do_skip_frame(PrefetchLane *lane)
 {
-  Editing *ed = scene->ed;
-  PrefetchJob *pfjob = seq_prefetch_job_get(scene);
-  float cfra = seq_prefetch_cfra(pfjob);
+  Editing *ed = lane->pfjob->scene->ed;
+  float cfra = lane->cfra;
   Sequence *seq_arr[MAXSEQ + 1];
   int count = BKE_sequencer_get_shown_sequences(ed->seqbasep, cfra, 0, seq_arr);
-  SeqRenderData *ctx = &pfjob->context_cpy;
+  SeqRenderData *ctx = &lane->context_cpy;
   ImBuf *ibuf = NULL;
 
   /* Disable prefetching 3D scene strips, but check for disk cache. */
@@ -414,78 +471,143 @@ static bool seq_prefetch_do_skip_frame(Scene *scene)
 static bool seq_prefetch_need_suspend(PrefetchJob *pfjob)
 {
   return seq_prefetch_is_cache_full(pfjob->scene) || seq_prefetch_is_scrubbing(pfjob->bmain) ||
-         (seq_prefetch_cfra(pfjob) >= pfjob->scene->r.efra);
+         (seq_prefetch_cfra(pfjob) > pfjob->scene->r.efra);
 }
 
-static void seq_prefetch_do_suspend(PrefetchJob *pfjob)
+static bool seq_prefetch_need_stop(PrefetchJob *pfjob)
 {
+  if (!(pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) || pfjob->stop) {
+    return true;
+  }
+
+  /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
+  return pfjob->num_frames_prefetched > 5 &&
+         (seq_prefetch_cfra(pfjob) - pfjob->scene->r.cfra) < 2;
+}
+
+/* Suspend lane if there is nothing to be prefetched, then take next frame to render.
+ * Returns false if lane should stop. */
+static bool seq_prefetch_lane_next_frame(PrefetchLane *lane)
+{
+  PrefetchJob *pfjob = lane->pfjob;
+  bool has_frame = false;
+
   BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
-  while (seq_prefetch_need_suspend(pfjob) &&
-         (pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop) {
-    pfjob->waiting = true;
+  seq_prefetch_update_area(pfjob);
+
+  while (seq_prefetch_need_suspend(pfjob) && !seq_prefetch_need_stop(pfjob)) {
+    pfjob->num_lanes_waiting++;
+    pfjob->waiting = pfjob->num_lanes_waiting == pfjob->num_lanes_running;
     BLI_condition_wait(&pfjob->prefetch_suspend_cond, &pfjob->prefetch_suspend_mutex);
+    pfjob->num_lanes_waiting--;
+    pfjob->waiting = false;
     seq_prefetch_update_area(pfjob);
   }
-  pfjob->waiting = false;
+
+  if (!seq_prefetch_need_stop(pfjob)) {
+    lane->cfra = seq_prefetch_cfra(pfjob);
+    pfjob->num_frames_prefetched++;
+    has_frame = true;
+  }
   BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+
+  return has_frame;
 }
 
-static void *seq_prefetch_frames(void *job)
+static void seq_prefetch_lane_render_frame(PrefetchLane *lane)
 {
-  PrefetchJob *pfjob = (PrefetchJob *)job;
-
-  while (seq_prefetch_cfra(pfjob) <= pfjob->scene->r.efra) {
-    pfjob->scene_eval->ed->prefetch_job = NULL;
+  PrefetchJob *pfjob = lane->pfjob;
 
-    seq_prefetch_update_depsgraph(pfjob);
-    AnimData *adt = BKE_animdata_from_id(&pfjob->context_cpy.scene->id);
-    AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(pfjob);
-    BKE_animsys_evaluate_animdata(
-        &pfjob->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
+  lane->scene_eval->ed->prefetch_job = NULL;
 
-    /* This is quite hacky solution:
-     * We need cross-reference original scene with copy for cache.
-     * However depsgraph must not have this data, because it will try to kill this job.
-     * Scene copy don't reference original scene. Perhaps, this could be done by depsgraph.
-     * Set to NULL before return!
-     */
-    pfjob->scene_eval->ed->prefetch_job = pfjob;
+  seq_prefetch_update_depsgraph(lane);
+  AnimData *adt = BKE_animdata_from_id(&lane->context_cpy.scene->id);
+  AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(lane);
+  BKE_animsys_evaluate_animdata(
+      &lane->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
 
-    if (seq_prefetch_do_skip_frame(pfjob->scene)) {
-      pfjob->num_frames_prefetched++;
-      continue;
-    }
+  /* This is quite hacky solution:
+   * We need cross-reference original scene with copy for cache.
+   * However depsgraph must not have this data, because it will try to kill this job.
+   * Scene copy don't reference original scene. Perhaps, this could be done by depsgraph.
+   * Set to NULL before return!
+   */
+  lane->scene_eval->ed->prefetch_job = pfjob;
 
-    ImBuf *ibuf = BKE_sequencer_give_ibuf(&pfjob->context_cpy, seq_prefetch_cfra(pfjob), 0);
-    BKE_sequencer_cache_free_temp_cache(
-        pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
-    IMB_freeImBuf(ibuf);
+  if (seq_prefetch_do_skip_frame(lane)) {
+    return;
+  }
 
-    /* Suspend thread if there is nothing to be prefetched. */
-    seq_prefetch_do_suspend(pfjob);
+  ImBuf *ibuf = BKE_sequencer_give_ibuf(&lane->context_cpy, lane->cfra, 0);
+  BKE_sequencer_cache_free_temp_cache(pfjob->scene, lane->context_cpy.task_id, lane->cfra);
+  IMB_freeImBuf(ibuf);
 
-    /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
-    if (pfjob->num_frames_prefetched > 5 &&
-        (seq_prefetch_cfra(pfjob) - pfjob->scene->r.cfra) < 2) {
-      break;
-    }
+  atomic_add_and_fetch_int32(&pfjob->num_frames_rendered, 1);
+}
 
-    if (!(pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) || pfjob->stop) {
-      break;
-    }
+static void *seq_prefetch_frames(void *lane_v)
+{
+  PrefetchLane *lane = (PrefetchLane *)lane_v;
+  PrefetchJob *pfjob = lane->pfjob;
 
-    seq_prefetch_update_area(pfjob);
-    pfjob->num_frames_prefetched++;
+  while (seq_prefetch_lane_next_frame(lane)) {
+    seq_prefetch_lane_render_frame(lane);
   }
 
-  BKE_sequencer_cache_free_temp_cache(
-      pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
-  pfjob->running = false;
-  pfjob->scene_eval->ed->prefetch_job = NULL;
+  BKE_sequencer_cache_free_temp_cache(pfjob->scene, lane->context_cpy.task_id, lane->cfra);
+  lane->scene_eval->ed->prefetch_job = NULL;
+
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+  pfjob->num_lanes_running--;
+  if (pfjob->num_lanes_running == 0) {
+    pfjob->time_end = PIL_check_seconds_timer();
+    pfjob->running = false;
+  }
+  else {
+    /* Other lanes may be waiting for this one. */
+    pfjob->waiting = pfjob->num_lanes_waiting == pfjob->num_lanes_running;
+  }
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
 
   return NULL;
 }
 
+/* Memory that prefetch lanes may use in addition to the first one: half of the system memory,
+ * which is neither in use already nor reserved for the cache and decoded movie frames. */
+static size_t seq_prefetch_lanes_memory_budget(void)
+{
+  const size_t memory_system = BLI_system_memory_max_in_megabytes() * 1024 * 1024;
+  const size_t memory_reserved = MEM_get_memory_in_use() + (size_t)U.memcachelimit * 1024 * 1024 +
+                                 IMB_anim_frame_ring_get_memory_limit();
+  if (memory_system <= memory_reserved) {
+    return 0;
+  }
+  return (memory_system - memory_reserved) / 2;
+}
+
+/* Lanes render frames in parallel and each frame is split between threads too, so use fewer
+ * lanes than threads. Each lane holds its own evaluated copy of the scene and the images of the
+ * frame it is rendering, so the number of lanes is also limited by memory.
+ * `lane_size` is the measured size of the evaluated scene of the first lane. */
+static int seq_prefetch_num_lanes(const SeqRenderData *context, size_t lane_size)
+{
+  const int num_lanes_threads = clamp_i(BLI_system_thread_count() / 4, 1, SEQ_PREFETCH_LANES_MAX);
+
+  /* Rough estimate of the images in flight, which are not counted by the cache yet. */
+  lane_size += (size_t)context->rectx * context->recty * 4 * sizeof(float) *
+               SEQ_PREFETCH_LANE_IMAGES;
+  const size_t num_lanes_memory = 1 + seq_prefetch_lanes_memory_budget() / max_zz(lane_size, 1);
+
+  return (int)min_zz((size_t)num_lanes_threads, num_lanes_memory);
+}
+
+static void seq_prefetch_init_lane(PrefetchJob *pfjob, PrefetchLane *lane)
+{
+  lane->pfjob = pfjob;
+  lane->bmain_eval = BKE_main_new();
+  seq_prefetch_init_depsgraph(lane);
+}
+
 static PrefetchJob *seq_prefetch_start(const SeqRenderData *context, float cfra)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(context->scene);
@@ -495,29 +617,48 @@ static PrefetchJob *seq_prefetch_start(const SeqRenderData *context, float cfra)
       pfjob = (PrefetchJob *)MEM_callocN(sizeof(PrefetchJob), "PrefetchJob");
       context->scene->ed->prefetch_job = pfjob;
 
-      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, 1);
       BLI_mutex_init(&pfjob->prefetch_suspend_mutex);
       BLI_condition_init(&pfjob->prefetch_suspend_cond);
 
       pfjob->bmain = context->bmain;
-      pfjob->bmain_eval = BKE_main_new();
-
       pfjob->scene = context->scene;
-      seq_prefetch_init_depsgraph(pfjob);
+      pfjob->cfra = cfra;
+      pfjob->num_frames_prefetched = 1;
+
+      /* The first lane is always created, its size decides how many more fit into memory. */
+      const size_t memory_before = MEM_get_memory_in_use();
+      seq_prefetch_init_lane(pfjob, &pfjob->lanes[0]);
+      const size_t memory_after = MEM_get_memory_in_use();
+      const size_t lane_size = (memory_after > memory_before) ? memory_after - memory_before : 0;
+
+      pfjob->num_lanes = seq_prefetch_num_lanes(context, lane_size);
+      for (int i = 1; i < pfjob->num_lanes; i++) {
+        seq_prefetch_init_lane(pfjob, &pfjob->lanes[i]);
+      }
+      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, pfjob->num_lanes);
     }
   }
-  seq_prefetch_update_scene(context->scene);
-  seq_prefetch_update_context(context);
+
+  /* Wait for lanes of previous run to finish. */
+  BLI_threadpool_clear(&pfjob->threads);
 
   pfjob->cfra = cfra;
   pfjob->num_frames_prefetched = 1;
 
+  seq_prefetch_update_scene(context->scene);
+  seq_prefetch_update_context(context);
+
+  pfjob->num_frames_rendered = 0;
+  pfjob->time_start = PIL_check_seconds_timer();
+  pfjob->num_lanes_running = pfjob->num_lanes;
+  pfjob->num_lanes_waiting = 0;
   pfjob->waiting = false;
   pfjob->stop = false;
   pfjob->running = true;
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
-  BLI_threadpool_insert(&pfjob->threads, pfjob);
+  for (int i = 0; i < pfjob->num_lanes; i++) {
+    BLI_threadpool_insert(&pfjob->threads, &pfjob->lanes[i]);
+  }
 
   return pfjob;
 }
@@ -43,6 +43,7 @@
 #include "DNA_windowmanager_types.h"
 
 #include "BLI_fileops.h"
+#include "BLI_ghash.h"
 #include "BLI_linklist.h"
 #include "BLI_listbase.h"
 #include "BLI_math.h"
@@ -50,6 +51,7 @@
 #include "BLI_session_uuid.h"
 #include "BLI_string.h"
 #include "BLI_string_utf8.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -80,6 +82,8 @@
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_query.h"
 
+#include "PIL_time.h"
+
 #include "RNA_access.h"
 
 #include "RE_pipeline.h"
@@ -114,7 +118,7 @@ static ImBuf *seq_render_preprocess_ibuf(const SeqRenderData *context,
                                          Sequence *seq,
                                          ImBuf *ibuf,
                                          float cfra,
-                                         clock_t begin,
+                                         double begin,
                                          bool use_preprocess,
                                          const bool is_proxy_image);
 static ImBuf *seq_render_strip(const SeqRenderData *context,
@@ -3126,7 +3130,7 @@ static ImBuf *seq_render_image_strip(const SeqRenderData *context,
 
       if (view_id != context->view_id) {
         ibufs_arr[view_id] = seq_render_preprocess_ibuf(
-            &localcontext, seq, ibufs_arr[view_id], cfra, clock(), true, false);
+            &localcontext, seq, ibufs_arr[view_id], cfra, PIL_check_seconds_timer(), true, false);
       }
     }
 
@@ -3190,6 +3194,11 @@ static ImBuf *seq_render_movie_strip_view(const SeqRenderData *context,
   IMB_Proxy_Size psize = seq_rendersize_to_proxysize(context->preview_render_size);
 
   IMB_anim_set_preseek(sanim->anim, seq->anim_preseek);
+  /* Prefetch lanes render frames out of order and proxy building reads each frame once, only
+   * playback benefits from keeping decoded frames. */
+  if (!context->is_prefetch_render && !context->is_proxy_render) {
+    IMB_anim_use_frame_ring(sanim->anim);
+  }
 
   if (seq_can_use_proxy(seq, psize)) {
     /* Try to get a proxy image.
@@ -3273,7 +3282,7 @@ static ImBuf *seq_render_movie_strip(
 
       if (view_id != context->view_id) {
         ibuf_arr[view_id] = seq_render_preprocess_ibuf(
-            &localcontext, seq, ibuf_arr[view_id], cfra, clock(), true, false);
+            &localcontext, seq, ibuf_arr[view_id], cfra, PIL_check_seconds_timer(), true, false);
       }
     }
 
@@ -3839,16 +3848,17 @@ static ImBuf *do_render_strip_uncached(const SeqRenderData *context,
 }
 
 /* Estimate time spent by the program rendering the strip */
-static clock_t seq_estimate_render_cost_begin(void)
+/* Wall clock time is used, processor time would count all threads that render the image. */
+static double seq_estimate_render_cost_begin(void)
 {
-  return clock();
+  return PIL_check_seconds_timer();
 }
 
-static float seq_estimate_render_cost_end(Scene *scene, clock_t begin)
+static float seq_estimate_render_cost_end(Scene *scene, double begin)
 {
-  clock_t end = clock();
+  double end = PIL_check_seconds_timer();
   float time_spent = (float)(end - begin);
-  float time_max = (1.0f / scene->r.frs_sec) * CLOCKS_PER_SEC;
+  float time_max = (1.0f / scene->r.frs_sec) * scene->r.frs_sec_base;
 
   if (time_max != 0) {
     return time_spent / time_max;
@@ -3861,7 +3871,7 @@ static ImBuf *seq_render_preprocess_ibuf(const SeqRenderData *context,
                                          Sequence *seq,
                                          ImBuf *ibuf,
                                          float cfra,
-                                         clock_t begin,
+                                         double begin,
                                          bool use_preprocess,
                                          const bool is_proxy_image)
 {
@@ -3899,7 +3909,7 @@ static ImBuf *seq_render_strip(const SeqRenderData *context,
   bool use_preprocess = false;
   bool is_proxy_image = false;
 
-  clock_t begin = seq_estimate_render_cost_begin();
+  double begin = seq_estimate_render_cost_begin();
 
   ibuf = BKE_sequencer_cache_get(context, seq, cfra, SEQ_CACHE_STORE_PREPROCESSED, false);
   if (ibuf != NULL) {
@@ -3992,6 +4002,186 @@ static ImBuf *seq_render_strip_stack_apply_effect(
   return out;
 }
 
+/* Strips that share data with other strips or threads. Text strips share fonts and scene strips
+ * use render pipeline. */
+static bool seq_render_strip_is_threadsafe(Sequence *seq)
+{
+  if (ELEM(seq->type, SEQ_TYPE_SCENE, SEQ_TYPE_TEXT)) {
+    return false;
+  }
+
+  if (seq->type == SEQ_TYPE_META) {
+    LISTBASE_FOREACH (Sequence *, seq_child, &seq->seqbase) {
+      if (!seq_render_strip_is_threadsafe(seq_child)) {
+        return false;
+      }
+    }
+  }
+
+  LISTBASE_FOREACH (SequenceModifierData *, smd, &seq->modifiers) {
+    if (smd->mask_sequence && !seq_render_strip_is_threadsafe(smd->mask_sequence)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Check whether frame can be rendered while other frames are rendered. */
+static bool seq_render_frame_is_threadsafe(ListBase *seqbasep, float cfra)
+{
+  LISTBASE_FOREACH (Sequence *, seq, seqbasep) {
+    if (seq->startdisp <= cfra && seq->enddisp > cfra && !seq_render_strip_is_threadsafe(seq)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Add seq and all strips used to render it to deps.
+ * Returns false if strip depends on strips, that are already in deps, or if it can not be
+ * rendered in parallel with other strips. Adjustment and multicam strips render other channels
+ * of the stack. */
+static bool seq_render_strip_deps_add(Sequence *seq, GSet *deps)
+{
+  if (!BLI_gset_add(deps, seq)) {
+    return false;
+  }
+
+  if (ELEM(seq->type, SEQ_TYPE_ADJUSTMENT, SEQ_TYPE_MULTICAM) ||
+      !seq_render_strip_is_threadsafe(seq)) {
+    return false;
+  }
+
+  if (seq->type == SEQ_TYPE_META) {
+    LISTBASE_FOREACH (Sequence *, seq_child, &seq->seqbase) {
+      if (!seq_render_strip_deps_add(seq_child, deps)) {
+        return false;
+      }
+    }
+  }
+
+  LISTBASE_FOREACH (SequenceModifierData *, smd, &seq->modifiers) {
+    if (smd->mask_sequence && !seq_render_strip_deps_add(smd->mask_sequence, deps)) {
+      return false;
+    }
+  }
+
+  if (seq->type & SEQ_TYPE_EFFECT) {
+    Sequence *inputs[3] = {seq->seq1, seq->seq2, seq->seq3};
+    for (int i = 0; i < ARRAY_SIZE(inputs); i++) {
+      if (inputs[i] && !seq_render_strip_deps_add(inputs[i], deps)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+typedef struct RenderStripsData {
+  const SeqRenderData *context;
+  SeqRenderState *state;
+  Sequence **seq_arr;
+  ImBuf **ibufs;
+  int *indices;
+  float cfra;
+} RenderStripsData;
+
+static void seq_render_strips_cb(void *__restrict userdata,
+                                 const int iter,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  RenderStripsData *data = userdata;
+  const int i = data->indices[iter];
+  SeqRenderState state = *data->state;
+
+  data->ibufs[i] = seq_render_strip(data->context, &state, data->seq_arr[i], data->cfra);
+}
+
+/* Render strips of the stack, that don't use the same strips, in parallel.
+ * If strips are not independent, nothing is rendered and ibufs are left empty. */
+static void seq_render_strip_stack_prerender(const SeqRenderData *context,
+                                             SeqRenderState *state,
+                                             Sequence **seq_arr,
+                                             ImBuf **ibufs,
+                                             int *indices,
+                                             int indices_num,
+                                             float cfra)
+{
+  if (indices_num < 2) {
+    return;
+  }
+
+  GSet *deps = BLI_gset_ptr_new(__func__);
+  bool is_independent = true;
+  for (int i = 0; i < indices_num && is_independent; i++) {
+    is_independent = seq_render_strip_deps_add(seq_arr[indices[i]], deps);
+  }
+  BLI_gset_free(deps, NULL);
+
+  if (!is_independent) {
+    return;
+  }
+
+  RenderStripsData data = {
+      .context = context,
+      .state = state,
+      .seq_arr = seq_arr,
+      .ibufs = ibufs,
+      .indices = indices,
+      .cfra = cfra,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, indices_num, &data, seq_render_strips_cb, &settings);
+}
+
+/* Use image rendered by #seq_render_strip_stack_prerender, or render it now. */
+static ImBuf *seq_render_strip_stack_input(const SeqRenderData *context,
+                                           SeqRenderState *state,
+                                           Sequence **seq_arr,
+                                           ImBuf **ibufs,
+                                           int i,
+                                           float cfra)
+{
+  if (ibufs[i]) {
+    ImBuf *ibuf = ibufs[i];
+    ibufs[i] = NULL;
+    return ibuf;
+  }
+  return seq_render_strip(context, state, seq_arr[i], cfra);
+}
+
+/* Render lowest strip of the stack together with effect strips above it. */
+static ImBuf *seq_render_strip_stack_bottom(const SeqRenderData *context,
+                                            SeqRenderState *state,
+                                            Sequence **seq_arr,
+                                            ImBuf **ibufs,
+                                            bool *r_prerendered,
+                                            int i,
+                                            int count,
+                                            float cfra)
+{
+  if (!*r_prerendered) {
+    int indices[MAXSEQ + 1];
+    int indices_num = 0;
+
+    indices[indices_num++] = i;
+    for (int j = i + 1; j < count; j++) {
+      if (seq_get_early_out_for_blend_mode(seq_arr[j]) == EARLY_DO_EFFECT) {
+        indices[indices_num++] = j;
+      }
+    }
+    seq_render_strip_stack_prerender(context, state, seq_arr, ibufs, indices, indices_num, cfra);
+    *r_prerendered = true;
+  }
+
+  return seq_render_strip_stack_input(context, state, seq_arr, ibufs, i, cfra);
+}
+
 static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
                                      SeqRenderState *state,
                                      ListBase *seqbasep,
@@ -3999,10 +4189,12 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
                                      int chanshown)
 {
   Sequence *seq_arr[MAXSEQ + 1];
+  ImBuf *ibufs[MAXSEQ + 1] = {NULL};
+  bool prerendered = false;
   int count;
   int i;
   ImBuf *out = NULL;
-  clock_t begin;
+  double begin;
 
   count = BKE_sequencer_get_shown_sequences(seqbasep, cfra, chanshown, (Sequence **)&seq_arr);
 
@@ -4020,7 +4212,8 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
       break;
     }
     if (seq->blend_mode == SEQ_BLEND_REPLACE) {
-      out = seq_render_strip(context, state, seq, cfra);
+      out = seq_render_strip_stack_bottom(
+          context, state, seq_arr, ibufs, &prerendered, i, count, cfra);
       break;
     }
 
@@ -4029,7 +4222,8 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
     switch (early_out) {
       case EARLY_NO_INPUT:
       case EARLY_USE_INPUT_2:
-        out = seq_render_strip(context, state, seq, cfra);
+        out = seq_render_strip_stack_bottom(
+            context, state, seq_arr, ibufs, &prerendered, i, count, cfra);
         break;
       case EARLY_USE_INPUT_1:
         if (i == 0) {
@@ -4041,7 +4235,8 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
           begin = seq_estimate_render_cost_begin();
 
           ImBuf *ibuf1 = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
-          ImBuf *ibuf2 = seq_render_strip(context, state, seq, cfra);
+          ImBuf *ibuf2 = seq_render_strip_stack_bottom(
+              context, state, seq_arr, ibufs, &prerendered, i, count, cfra);
 
           out = seq_render_strip_stack_apply_effect(context, seq, cfra, ibuf1, ibuf2);
 
@@ -4060,13 +4255,26 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
   }
 
   i++;
+
+  /* Bottom of the stack was cached, effects above it can still be rendered in parallel. */
+  if (!prerendered && i < count) {
+    int indices[MAXSEQ + 1];
+    int indices_num = 0;
+    for (int j = i; j < count; j++) {
+      if (seq_get_early_out_for_blend_mode(seq_arr[j]) == EARLY_DO_EFFECT) {
+        indices[indices_num++] = j;
+      }
+    }
+    seq_render_strip_stack_prerender(context, state, seq_arr, ibufs, indices, indices_num, cfra);
+  }
+
   for (; i < count; i++) {
     begin = seq_estimate_render_cost_begin();
     Sequence *seq = seq_arr[i];
 
     if (seq_get_early_out_for_blend_mode(seq) == EARLY_DO_EFFECT) {
       ImBuf *ibuf1 = out;
-      ImBuf *ibuf2 = seq_render_strip(context, state, seq, cfra);
+      ImBuf *ibuf2 = seq_render_strip_stack_input(context, state, seq_arr, ibufs, i, cfra);
 
       out = seq_render_strip_stack_apply_effect(context, seq, cfra, ibuf1, ibuf2);
 
@@ -4079,6 +4287,13 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
         context, seq_arr[i], cfra, SEQ_CACHE_STORE_COMPOSITE, out, cost, false);
   }
 
+  /* Images of strips, that were not used, because lower strip was found in cache. */
+  for (i = 0; i < count; i++) {
+    if (ibufs[i]) {
+      IMB_freeImBuf(ibufs[i]);
+    }
+  }
+
   return out;
 }
 
@@ -4121,11 +4336,17 @@ ImBuf *BKE_sequencer_give_ibuf(const SeqRenderData *context, float cfra, int cha
 
   BKE_sequencer_cache_free_temp_cache(context->scene, context->task_id, cfra);
 
-  clock_t begin = seq_estimate_render_cost_begin();
+  double begin = seq_estimate_render_cost_begin();
   float cost = 0;
 
   if (count && !out) {
-    BLI_mutex_lock(&seq_render_mutex);
+    /* Prefetch lanes render their own copy of the scene, frames with strips, that share data
+     * with other threads, are still rendered one at a time. */
+    const bool use_render_mutex = !context->is_prefetch_render ||
+                                  !seq_render_frame_is_threadsafe(seqbasep, cfra);
+    if (use_render_mutex) {
+      BLI_mutex_lock(&seq_render_mutex);
+    }
     out = seq_render_strip_stack(context, &state, seqbasep, cfra, chanshown);
     cost = seq_estimate_render_cost_end(context->scene, begin);
 
@@ -4137,7 +4358,9 @@ ImBuf *BKE_sequencer_give_ibuf(const SeqRenderData *context, float cfra, int cha
       BKE_sequencer_cache_put_if_possible(
           context, seq_arr[count - 1], cfra, SEQ_CACHE_STORE_FINAL_OUT, out, cost, false);
     }
-    BLI_mutex_unlock(&seq_render_mutex);
+    if (use_render_mutex) {
+      BLI_mutex_unlock(&seq_render_mutex);
+    }
   }
 
   BKE_sequencer_prefetch_start(context, cfra, cost);
@@ -0,0 +1,142 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_appdir.h"
+#include "BKE_idtype.h"
+#include "BKE_main.h"
+#include "BKE_scene.h"
+#include "BKE_sequencer.h"
+
+#include "DNA_scene_types.h"
+#include "DNA_sequence_types.h"
+#include "DNA_space_types.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#define NUM_BLUR_STRIPS 3
+
+class SequencerRenderTest : public testing::Test {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  SeqRenderData context;
+
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+    BKE_appdir_init();
+    IMB_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    IMB_exit();
+  }
+
+  void TearDown() override
+  {
+    if (bmain != nullptr) {
+      BKE_main_free(bmain);
+      bmain = nullptr;
+    }
+  }
+
+  Sequence *strip_add(int type, int channel, Sequence *input, int len)
+  {
+    Editing *ed = BKE_sequencer_editing_ensure(scene);
+    Sequence *seq = BKE_sequence_alloc(ed->seqbasep, 1, channel, type);
+    SeqEffectHandle sh = BKE_sequence_get_effect(seq);
+    sh.init(seq);
+    seq->seq1 = input;
+    seq->len = len;
+    BKE_sequence_calc(scene, seq);
+    return seq;
+  }
+
+  /* Color strip at the bottom of the stack and blurred color strips blended over it. Each blur
+   * strip is independent of the others, so they are rendered at the same time. */
+  void scene_create(const int width, const int height, const int num_frames)
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    scene->r.xsch = width;
+    scene->r.ysch = height;
+
+    Sequence *background = strip_add(SEQ_TYPE_COLOR, 1, nullptr, num_frames);
+    background->blend_mode = SEQ_TYPE_CROSS;
+
+    for (int i = 0; i < NUM_BLUR_STRIPS; i++) {
+      Sequence *color = strip_add(SEQ_TYPE_COLOR, 2 + i, nullptr, num_frames);
+      SolidColorVars *colvars = static_cast<SolidColorVars *>(color->effectdata);
+      colvars->col[i % 3] = 1.0f;
+
+      Sequence *blur = strip_add(
+          SEQ_TYPE_GAUSSIAN_BLUR, 2 + NUM_BLUR_STRIPS + i, color, num_frames);
+      GaussianBlurVars *blurvars = static_cast<GaussianBlurVars *>(blur->effectdata);
+      blurvars->size_x = 20.0f;
+      blurvars->size_y = 20.0f;
+      blur->blend_mode = SEQ_TYPE_ALPHAOVER;
+      blur->blend_opacity = 50.0f;
+    }
+    BKE_sequencer_sort(scene);
+
+    /* Every frame is rendered, nothing is taken from cache. */
+    scene->ed->cache_flag = 0;
+
+    BKE_sequencer_new_render_data(bmain,
+                                  nullptr,
+                                  scene,
+                                  scene->r.xsch,
+                                  scene->r.ysch,
+                                  SEQ_RENDER_SIZE_SCENE,
+                                  true,
+                                  &context);
+  }
+};
+
+TEST_F(SequencerRenderTest, BlurStack)
+{
+  scene_create(64, 64, 2);
+
+  ImBuf *first = BKE_sequencer_give_ibuf(&context, 1, 0);
+  ASSERT_NE(first, nullptr);
+  IMB_rect_from_float(first);
+  EXPECT_EQ(first->x, 64);
+  EXPECT_EQ(first->y, 64);
+
+  /* Strips are blended in channel order, no matter in which order they finished rendering. */
+  ImBuf *second = BKE_sequencer_give_ibuf(&context, 2, 0);
+  ASSERT_NE(second, nullptr);
+  IMB_rect_from_float(second);
+  EXPECT_EQ(memcmp(first->rect, second->rect, sizeof(unsigned int) * first->x * first->y), 0);
+
+  /* Every blurred color strip contributes to the result. */
+  const unsigned char *center = (const unsigned char *)&first->rect[32 * 64 + 32];
+  EXPECT_GT(center[0], 0);
+  EXPECT_GT(center[1], 0);
+  EXPECT_GT(center[2], 0);
+
+  IMB_freeImBuf(first);
+  IMB_freeImBuf(second);
+}
@@ -0,0 +1,145 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_appdir.h"
+#include "BKE_idtype.h"
+#include "BKE_main.h"
+#include "BKE_scene.h"
+#include "BKE_sequencer.h"
+
+#include "DNA_scene_types.h"
+#include "DNA_sequence_types.h"
+#include "DNA_space_types.h"
+#include "DNA_userdef_types.h"
+
+#include "DEG_depsgraph.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "RNA_define.h"
+
+#include "PIL_time.h"
+
+#define NUM_BLUR_STRIPS 3
+#define NUM_FRAMES 50
+
+static Sequence *strip_add(Scene *scene, int type, int channel, Sequence *input, int len)
+{
+  Editing *ed = BKE_sequencer_editing_ensure(scene);
+  Sequence *seq = BKE_sequence_alloc(ed->seqbasep, 1, channel, type);
+  SeqEffectHandle sh = BKE_sequence_get_effect(seq);
+  sh.init(seq);
+  seq->seq1 = input;
+  seq->len = len;
+  BKE_sequence_calc(scene, seq);
+  return seq;
+}
+
+/* Color strip at the bottom of the stack and blurred color strips blended over it. */
+static Scene *scene_create(Main *bmain, const int width, const int height, const int num_frames)
+{
+  Scene *scene = BKE_scene_add(bmain, "Scene");
+  scene->r.xsch = width;
+  scene->r.ysch = height;
+  scene->r.cfra = 1;
+  scene->r.sfra = 1;
+  scene->r.efra = num_frames;
+
+  Sequence *background = strip_add(scene, SEQ_TYPE_COLOR, 1, nullptr, num_frames);
+  background->blend_mode = SEQ_TYPE_CROSS;
+
+  for (int i = 0; i < NUM_BLUR_STRIPS; i++) {
+    Sequence *color = strip_add(scene, SEQ_TYPE_COLOR, 2 + i, nullptr, num_frames);
+    SolidColorVars *colvars = (SolidColorVars *)color->effectdata;
+    colvars->col[i % 3] = 1.0f;
+
+    Sequence *blur = strip_add(
+        scene, SEQ_TYPE_GAUSSIAN_BLUR, 2 + NUM_BLUR_STRIPS + i, color, num_frames);
+    GaussianBlurVars *blurvars = (GaussianBlurVars *)blur->effectdata;
+    blurvars->size_x = 20.0f;
+    blurvars->size_y = 20.0f;
+    blur->blend_mode = SEQ_TYPE_ALPHAOVER;
+    blur->blend_opacity = 50.0f;
+  }
+  BKE_sequencer_sort(scene);
+  return scene;
+}
+
+/* Render frames after the current one in the main thread, like playback without cache. */
+static double serial_fps(const SeqRenderData *context, Scene *scene)
+{
+  scene->ed->cache_flag = 0;
+
+  int num_rendered = 0;
+  const double start_time = PIL_check_seconds_timer();
+  for (int cfra = scene->r.cfra + 1; cfra <= scene->r.efra; cfra++) {
+    ImBuf *ibuf = BKE_sequencer_give_ibuf(context, cfra, 0);
+    if (ibuf != nullptr) {
+      num_rendered++;
+      IMB_freeImBuf(ibuf);
+    }
+  }
+  return num_rendered / (PIL_check_seconds_timer() - start_time);
+}
+
+/* Let the prefetch lanes render all frames after the current one into the cache. Lanes are
+ * suspended once the end of the scene is reached, the job doesn't ask for redraws after that. */
+static double prefetch_fps(const SeqRenderData *context, Main *bmain, Scene *scene)
+{
+  scene->ed->cache_flag = SEQ_CACHE_STORE_FINAL_OUT | SEQ_CACHE_PREFETCH_ENABLE |
+                          SEQ_CACHE_VIEW_ENABLE;
+  BKE_sequencer_cache_cleanup(scene);
+
+  BKE_sequencer_prefetch_start(context, scene->r.cfra, 0.0f);
+  while (BKE_sequencer_prefetch_need_redraw(bmain, scene)) {
+    PIL_sleep_ms(1);
+  }
+  const double fps = BKE_sequencer_prefetch_fps_get(scene);
+  BKE_sequencer_prefetch_stop(scene);
+  return fps;
+}
+
+TEST(sequencer_render, BlurStack)
+{
+  BKE_idtype_init();
+  BKE_appdir_init();
+  IMB_init();
+  RNA_init();
+  DEG_register_node_types();
+
+  /* All frames fit into the cache, so prefetch is never suspended by the memory limit. */
+  U.memcachelimit = 4096;
+
+  Main *bmain = BKE_main_new();
+  Scene *scene = scene_create(bmain, 1920, 1080, NUM_FRAMES);
+
+  SeqRenderData context;
+  BKE_sequencer_new_render_data(bmain,
+                                nullptr,
+                                scene,
+                                scene->r.xsch,
+                                scene->r.ysch,
+                                SEQ_RENDER_SIZE_SCENE,
+                                true,
+                                &context);
+
+  const double serial = serial_fps(&context, scene);
+  const double prefetch = prefetch_fps(&context, bmain, scene);
+
+  printf("Stack of %d blurred strips at %dx%d, %d frames:\n",
+         NUM_BLUR_STRIPS,
+         scene->r.xsch,
+         scene->r.ysch,
+         NUM_FRAMES);
+  printf("\tSerial: %.2f fps\n", serial);
+  printf("\tPrefetch: %.2f fps\n", prefetch);
+
+  BKE_main_free(bmain);
+  DEG_free_node_types();
+  RNA_exit();
+  IMB_exit();
+}
@@ -414,6 +414,8 @@ static void wm_init_userdef(Main *bmain)
   }
 
   MEM_CacheLimiter_set_maximum(((size_t)U.memcachelimit) * 1024 * 1024);
+  /* Decoded movie frames are kept in addition to the cache, use a quarter of its limit. */
+  IMB_anim_frame_ring_set_memory_limit(((size_t)U.memcachelimit) * 1024 * 1024 / 4);
   BKE_sound_init(bmain);
 
   /* Update the temporary directory from the preferences or fallback to the system default. */
@@ -1488,6 +1490,10 @@ static bool wm_file_write(bContext *C,
     BKE_packedfile_pack_all(bmain, reports, false);
   }
 
+  /* The explicit save supersedes a running autosave,
+   * cancelling removes its partially written file. */
+  WM_jobs_kill_type(CTX_wm_manager(C), NULL, WM_JOB_TYPE_AUTOSAVE);
+
   /* don't forget not to return without! */
   WM_cursor_wait(1);
 
@@ -1598,6 +1604,47 @@ void wm_autosave_location(char *filepath)
   BLI_join_dirfile(filepath, FILE_MAX, BKE_tempdir_base(), path);
 }
 
+/**
+ * Autosave from the undo memfile is written in a job, from a snapshot sharing the chunk buffers of
+ * the active undo step, so large files don't block the interface while being written to disk.
+ */
+typedef struct AutosaveJob {
+  struct MemFile memfile;
+  char filepath[FILE_MAX];
+} AutosaveJob;
+
+static void wm_autosave_job_startjob(void *customdata,
+                                     short *stop,
+                                     short *do_update,
+                                     float *progress)
+{
+  AutosaveJob *aj = customdata;
+  BLO_memfile_write_file_ex(&aj->memfile, aj->filepath, stop, do_update, progress);
+}
+
+static void wm_autosave_job_free(void *customdata)
+{
+  AutosaveJob *aj = customdata;
+  BLO_memfile_free(&aj->memfile);
+  MEM_freeN(aj);
+}
+
+static void wm_autosave_job_start(wmWindowManager *wm,
+                                  struct MemFile *memfile,
+                                  const char *filepath)
+{
+  AutosaveJob *aj = MEM_callocN(sizeof(*aj), __func__);
+  BLO_memfile_copy_shared(&aj->memfile, memfile);
+  BLI_strncpy(aj->filepath, filepath, sizeof(aj->filepath));
+
+  wmJob *wm_job = WM_jobs_get(wm, NULL, wm, "Autosave", WM_JOB_PROGRESS, WM_JOB_TYPE_AUTOSAVE);
+  WM_jobs_customdata_set(wm_job, aj, wm_autosave_job_free);
+  WM_jobs_timer(wm_job, 0.1, 0, 0);
+  WM_jobs_callbacks(wm_job, wm_autosave_job_startjob, NULL, NULL, NULL);
+
+  WM_jobs_start(wm, wm_job);
+}
+
 void WM_autosave_init(wmWindowManager *wm)
 {
   wm_autosave_timer_ended(wm);
@@ -1627,13 +1674,20 @@ void wm_autosave_timer(Main *bmain, wmWindowManager *wm, wmTimer *UNUSED(wt))
     }
   }
 
+  /* Previous autosave is still being written, try again later. */
+  if (WM_jobs_test(wm, wm, WM_JOB_TYPE_AUTOSAVE)) {
+    wm->autosavetimer = WM_event_add_timer(wm, NULL, TIMERAUTOSAVE, U.savetime * 60.0);
+    return;
+  }
+
   wm_autosave_location(filepath);
 
   if (U.uiflag & USER_GLOBALUNDO) {
     /* fast save of last undobuffer, now with UI */
     struct MemFile *memfile = ED_undosys_stack_memfile_get_active(wm->undo_stack);
     if (memfile) {
-      BLO_memfile_write_file(memfile, filepath);
+      /* Disk I/O happens in a job, only the chunk list is copied here. */
+      wm_autosave_job_start(wm, memfile, filepath);
     }
   }
   else {
@@ -596,12 +596,14 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_argsPrintArgDoc(ba, "--debug-depsgraph-build");
   BLI_argsPrintArgDoc(ba, "--debug-depsgraph-tag");
   BLI_argsPrintArgDoc(ba, "--debug-depsgraph-no-threads");
+  BLI_argsPrintArgDoc(ba, "--debug-depsgraph-priority");
   BLI_argsPrintArgDoc(ba, "--debug-depsgraph-time");
   BLI_argsPrintArgDoc(ba, "--debug-depsgraph-pretty");
   BLI_argsPrintArgDoc(ba, "--debug-gpu");
   BLI_argsPrintArgDoc(ba, "--debug-gpumem");
   BLI_argsPrintArgDoc(ba, "--debug-gpu-shaders");
   BLI_argsPrintArgDoc(ba, "--debug-gpu-force-workarounds");
+  BLI_argsPrintArgDoc(ba, "--debug-bmesh-no-eval-only");
   BLI_argsPrintArgDoc(ba, "--debug-wm");
 #  ifdef WITH_XR_OPENXR
   BLI_argsPrintArgDoc(ba, "--debug-xr");
@@ -995,9 +997,16 @@ static const char arg_handle_debug_mode_generic_set_doc_depsgraph_eval[] =
 static const char arg_handle_debug_mode_generic_set_doc_depsgraph_no_threads[] =
     "\n\t"
     "Switch dependency graph to a single threaded evaluation.";
+static const char arg_handle_debug_mode_generic_set_doc_depsgraph_priority[] =
+    "\n\t"
+    "Evaluate the longest chains of dependency graph operations first, based on the timing of "
+    "the previous evaluation.";
 static const char arg_handle_debug_mode_generic_set_doc_depsgraph_pretty[] =
     "\n\t"
     "Enable colors for dependency graph debug messages.";
+static const char arg_handle_debug_mode_generic_set_doc_bmesh_no_eval_only[] =
+    "\n\t"
+    "Copy custom-data of the BMeshes that modifiers use instead of moving it, for timing.";
 static const char arg_handle_debug_mode_generic_set_doc_gpumem[] =
     "\n\t"
     "Enable GPU memory stats in status bar.";
@@ -2122,6 +2131,12 @@ void main_args_setup(bContext *C, bArgs *ba)
               "--debug-handlers",
               CB_EX(arg_handle_debug_mode_generic_set, handlers),
               (void *)G_DEBUG_HANDLERS);
+  BLI_argsAdd(ba,
+              1,
+              NULL,
+              "--debug-bmesh-no-eval-only",
+              CB_EX(arg_handle_debug_mode_generic_set, bmesh_no_eval_only),
+              (void *)G_DEBUG_BMESH_NO_EVAL_ONLY);
   BLI_argsAdd(
       ba, 1, NULL, "--debug-wm", CB_EX(arg_handle_debug_mode_generic_set, wm), (void *)G_DEBUG_WM);
 #  ifdef WITH_XR_OPENXR
@@ -2203,6 +2218,12 @@ void main_args_setup(bContext *C, bArgs *ba)
               "--debug-depsgraph-no-threads",
               CB_EX(arg_handle_debug_mode_generic_set, depsgraph_no_threads),
               (void *)G_DEBUG_DEPSGRAPH_NO_THREADS);
+  BLI_argsAdd(ba,
+              1,
+              NULL,
+              "--debug-depsgraph-priority",
+              CB_EX(arg_handle_debug_mode_generic_set, depsgraph_priority),
+              (void *)G_DEBUG_DEPSGRAPH_PRIORITY);
   BLI_argsAdd(ba,
               1,
               NULL,